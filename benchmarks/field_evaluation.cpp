@@ -0,0 +1,223 @@
+/*
+ * OpenCMISS-Zinc Library Benchmarks
+ *
+ * Times finite element field evaluation set up per element, analytic
+ * derivatives of operator fields, and normal against compiled evaluation of
+ * an expression with repeated subexpressions, reporting throughput.
+ *
+ * Usage: ZincFieldEvaluationBenchmark [repeats]
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <opencmiss/zinc/context.hpp>
+#include <opencmiss/zinc/differentialoperator.hpp>
+#include <opencmiss/zinc/element.hpp>
+#include <opencmiss/zinc/fieldarithmeticoperators.hpp>
+#include <opencmiss/zinc/fieldcache.hpp>
+#include <opencmiss/zinc/fieldcomposite.hpp>
+#include <opencmiss/zinc/fieldconstant.hpp>
+#include <opencmiss/zinc/fieldmatrixoperators.hpp>
+#include <opencmiss/zinc/fieldmodule.hpp>
+#include <opencmiss/zinc/fieldtrigonometry.hpp>
+#include <opencmiss/zinc/fieldvectoroperators.hpp>
+#include <opencmiss/zinc/mesh.hpp>
+#include <opencmiss/zinc/region.hpp>
+#include <opencmiss/zinc/result.hpp>
+
+using namespace OpenCMISS::Zinc;
+
+namespace {
+
+double getSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *name, int count, double seconds)
+{
+	printf("%-40s %10d %12.4f %14.4g\n", name, count, seconds,
+		(seconds > 0.0) ? count/seconds : 0.0);
+}
+
+/** Read model file from the test resources into a new region.
+ * @return  Field module for region, invalid if failed. */
+Fieldmodule readModel(Context& context, const char *fileName)
+{
+	Region region = context.getDefaultRegion();
+	const std::string path = std::string(ZINC_BENCHMARK_RESOURCE_DIR) + "/" + fileName;
+	if (RESULT_OK != region.readFile(path.c_str()))
+	{
+		fprintf(stderr, "Could not read %s\n", path.c_str());
+		return Fieldmodule();
+	}
+	return region.getFieldmodule();
+}
+
+/**
+ * With zero cache budget, alternating between two tricubic Hermite elements
+ * recalculates element values on every evaluation.
+ */
+bool benchmarkElementEvaluationCalculateValues(int repeats)
+{
+	Context context("benchmark");
+	Fieldmodule fm = readModel(context, "data/two_cubes_hermite_nocross.ex2");
+	Field coordinates = fm.findFieldByName("coordinates");
+	Mesh mesh3d = fm.findMeshByDimension(3);
+	Element elements[2] = { mesh3d.findElementByIdentifier(1), mesh3d.findElementByIdentifier(2) };
+	if ((!coordinates.isValid()) || (!elements[0].isValid()) || (!elements[1].isValid()))
+		return false;
+	fm.setElementEvaluationCacheBudget(0);
+	Fieldcache fieldcache = fm.createFieldcache();
+	const double xi[3] = { 0.25, 0.5, 0.75 };
+	double x[3];
+	const int evaluationCount = 20000*repeats;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < evaluationCount; ++i)
+	{
+		fieldcache.setMeshLocation(elements[i % 2], 3, xi);
+		coordinates.evaluateReal(fieldcache, 3, x);
+	}
+	report("tricubic Hermite calculate values", evaluationCount, getSeconds(start));
+	return true;
+}
+
+/** Time first and second derivatives of operators with analytic derivatives
+ * on the tricubic deformed cube. */
+bool benchmarkAnalyticDerivatives(int repeats)
+{
+	Context context("benchmark");
+	Fieldmodule fm = readModel(context, "cube_tricubic_deformed.exfile");
+	Field coordinates = fm.findFieldByName("coordinates");
+	Field deformed = fm.findFieldByName("deformed");
+	Field temperature = fm.findFieldByName("temperature");
+	Mesh mesh3d = fm.findMeshByDimension(3);
+	Element element = mesh3d.findElementByIdentifier(1);
+	if ((!coordinates.isValid()) || (!deformed.isValid()) || (!temperature.isValid()) || (!element.isValid()))
+		return false;
+
+	std::vector<Field> fields;
+	std::vector<std::string> names;
+	const double half = 0.5;
+	Field halfField = fm.createFieldConstant(1, &half);
+	Field halfSinTemperature = fm.createFieldMultiply(halfField, fm.createFieldSin(temperature));
+	fields.push_back(fm.createFieldSin(deformed));
+	names.push_back("sin");
+	fields.push_back(fm.createFieldAsin(halfSinTemperature));
+	names.push_back("asin");
+	fields.push_back(fm.createFieldNormalise(deformed));
+	names.push_back("normalise");
+	fields.push_back(fm.createFieldCrossProduct(coordinates, deformed));
+	names.push_back("cross_product");
+	fields.push_back(fm.createFieldMagnitude(deformed));
+	names.push_back("magnitude");
+	const double diagonalValues[9] = { 3.0, 0.0, 0.0, 0.0, 4.0, 0.0, 0.0, 0.0, 5.0 };
+	Field rows[3] = { deformed, coordinates, fm.createFieldMultiply(coordinates, deformed) };
+	Field matrix = fm.createFieldAdd(fm.createFieldConcatenate(3, rows), fm.createFieldConstant(9, diagonalValues));
+	fields.push_back(fm.createFieldDeterminant(matrix));
+	names.push_back("determinant");
+	fields.push_back(fm.createFieldMatrixInvert(matrix));
+	names.push_back("matrix_invert");
+	Field symmetricMatrix = fm.createFieldMatrixMultiply(3, fm.createFieldTranspose(3, matrix), matrix);
+	FieldEigenvalues eigenvalues = fm.createFieldEigenvalues(symmetricMatrix);
+	fields.push_back(eigenvalues);
+	names.push_back("eigenvalues");
+	fields.push_back(fm.createFieldEigenvectors(eigenvalues));
+	names.push_back("eigenvectors");
+
+	Fieldcache cache = fm.createFieldcache();
+	const int evaluationCount = 2000*repeats;
+	std::vector<double> derivatives;
+	for (int order = 1; order <= 2; ++order)
+	{
+		Differentialoperator derivative = mesh3d.getChartDifferentialoperator(order, -1);
+		const int termCount = (order == 1) ? 3 : 9;
+		for (size_t f = 0; f < fields.size(); ++f)
+		{
+			Field& field = fields[f];
+			if (!field.isValid())
+				return false;
+			const int valuesCount = field.getNumberOfComponents()*termCount;
+			derivatives.resize(valuesCount);
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int i = 0; i < evaluationCount; ++i)
+			{
+				// vary location so derivatives are re-evaluated each time
+				const double xi[3] = { 0.1 + 0.8*(i % 97)/97.0, 0.5, 0.3 + 0.4*(i % 13)/13.0 };
+				cache.setMeshLocation(element, 3, xi);
+				field.evaluateDerivative(derivative, cache, valuesCount, derivatives.data());
+			}
+			const std::string name = names[f] + ((order == 1) ? " first derivatives" : " second derivatives");
+			report(name.c_str(), evaluationCount, getSeconds(start));
+		}
+	}
+	return true;
+}
+
+/** Time normal and compiled evaluation of a sum of products of distances
+ * from 3 centres, sharing 3 magnitude subexpressions. */
+bool benchmarkCompileField(int repeats)
+{
+	Context context("benchmark");
+	Fieldmodule fm = readModel(context, "cube_tricubic_deformed.exfile");
+	Field coordinates = fm.findFieldByName("deformed");
+	Mesh mesh3d = fm.findMeshByDimension(3);
+	Element element = mesh3d.findElementByIdentifier(1);
+	if ((!coordinates.isValid()) || (!element.isValid()))
+		return false;
+	const double centres[3][3] = { { 0.5, 0.25, 0.125 }, { 0.0, 1.0, 0.5 }, { 1.0, 0.0, 1.0 } };
+	Field expression;
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+		{
+			Field term = fm.createFieldMagnitude(coordinates - fm.createFieldConstant(3, centres[i]))*
+				fm.createFieldMagnitude(coordinates - fm.createFieldConstant(3, centres[j]));
+			expression = (expression.isValid()) ? expression + term : term;
+		}
+	const int evaluationCount = 20000*repeats;
+	for (int compiled = 0; compiled < 2; ++compiled)
+	{
+		Fieldcache cache = fm.createFieldcache();
+		if (compiled && (RESULT_OK != cache.compileField(expression)))
+			return false;
+		double xi[3] = { 0.0, 0.5, 0.5 };
+		double value;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int n = 0; n < evaluationCount; ++n)
+		{
+			xi[0] = static_cast<double>(n)/static_cast<double>(evaluationCount);
+			cache.setMeshLocation(element, 3, xi);
+			expression.evaluateReal(cache, 1, &value);
+		}
+		report(compiled ? "compiled expression" : "normal expression", evaluationCount, getSeconds(start));
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int repeats = (argc > 1) ? atoi(argv[1]) : 1;
+	if (repeats < 1)
+	{
+		fprintf(stderr, "Usage: %s [repeats]\n", argv[0]);
+		return 1;
+	}
+	printf("%-40s %10s %12s %14s\n", "benchmark", "count", "seconds", "per second");
+	if (!(benchmarkElementEvaluationCalculateValues(repeats) &&
+		benchmarkAnalyticDerivatives(repeats) &&
+		benchmarkCompileField(repeats)))
+	{
+		fprintf(stderr, "Benchmark failed to set up model\n");
+		return 1;
+	}
+	return 0;
+}
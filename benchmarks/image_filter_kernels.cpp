@@ -0,0 +1,190 @@
+/*
+ * OpenCMISS-Zinc Library Benchmarks
+ *
+ * Times the native image filter kernels against the ITK filters they replace
+ * on a random 3-D image, and reports the largest difference in their results.
+ *
+ * Usage: ZincImageFilterBenchmark [size [repeats]]
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "image_processing/image_filter_kernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "itkImage.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkMeanImageFilter.h"
+#include "itkRescaleIntensityImageFilter.h"
+#include "itkSigmoidImageFilter.h"
+#include "itkThresholdImageFilter.h"
+
+using namespace CMZN;
+
+namespace {
+
+typedef itk::Image<ZnReal, 3> ImageType;
+
+double getSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** @return  Fastest time in seconds to update filter on input. */
+template <class FilterType>
+double timeItkFilter(FilterType *filter, ImageType *input, int repeats)
+{
+	filter->SetInput(input);
+	double bestSeconds = 0.0;
+	for (int r = 0; r < repeats; ++r)
+	{
+		filter->Modified();
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		filter->Update();
+		const double seconds = getSeconds(start);
+		if ((0 == r) || (seconds < bestSeconds))
+			bestSeconds = seconds;
+	}
+	return bestSeconds;
+}
+
+/**
+ * @return  Fastest time in seconds to copy input into output and apply
+ * kernel to it in place, as image filter fields do.
+ */
+template <class Kernel>
+double timeNativeKernel(Kernel kernel, const std::vector<ZnReal>& input,
+	std::vector<ZnReal>& output, int repeats)
+{
+	double bestSeconds = 0.0;
+	for (int r = 0; r < repeats; ++r)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		output = input;
+		kernel(output.data());
+		const double seconds = getSeconds(start);
+		if ((0 == r) || (seconds < bestSeconds))
+			bestSeconds = seconds;
+	}
+	return bestSeconds;
+}
+
+void report(const char *name, double itkSeconds, double nativeSeconds,
+	const ImageType *itkOutput, const std::vector<ZnReal>& nativeOutput)
+{
+	const ZnReal *itkValues = itkOutput->GetBufferPointer();
+	double maximumDifference = 0.0;
+	for (size_t i = 0; i < nativeOutput.size(); ++i)
+		maximumDifference = std::max(maximumDifference, std::fabs(itkValues[i] - nativeOutput[i]));
+	printf("%-18s %12.2f %12.2f %9.2f %14.3g\n", name, 1000.0*itkSeconds,
+		1000.0*nativeSeconds, itkSeconds/nativeSeconds, maximumDifference);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int size = (argc > 1) ? atoi(argv[1]) : 128;
+	const int repeats = (argc > 2) ? atoi(argv[2]) : 3;
+	if ((size < 1) || (repeats < 1))
+	{
+		fprintf(stderr, "Usage: %s [size [repeats]]\n", argv[0]);
+		return 1;
+	}
+	const int sizes[3] = { size, size, size };
+	const size_t count = static_cast<size_t>(size)*size*size;
+
+	ImageType::Pointer input = ImageType::New();
+	ImageType::RegionType region;
+	ImageType::SizeType regionSize;
+	regionSize.Fill(size);
+	region.SetSize(regionSize);
+	input->SetRegions(region);
+	input->Allocate();
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<ZnReal> distribution(0.0, 1.0);
+	std::vector<ZnReal> values(count);
+	for (size_t i = 0; i < count; ++i)
+		values[i] = distribution(generator);
+	std::copy(values.begin(), values.end(), input->GetBufferPointer());
+
+	printf("%d x %d x %d image, best of %d\n", size, size, size, repeats);
+	printf("%-18s %12s %12s %9s %14s\n", "filter", "ITK ms", "native ms", "speedup", "max difference");
+	std::vector<ZnReal> output;
+
+	{
+		typedef itk::ThresholdImageFilter<ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		filter->SetOutsideValue(-1.0);
+		filter->ThresholdOutside(0.25, 0.75);
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([=](ZnReal *image)
+			{ image_kernel_threshold(image, count, 0.25, 0.75, -1.0); }, values, output, repeats);
+		report("threshold", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	{
+		typedef itk::BinaryThresholdImageFilter<ImageType, ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		filter->SetLowerThreshold(0.25);
+		filter->SetUpperThreshold(0.75);
+		filter->SetInsideValue(1.0);
+		filter->SetOutsideValue(0.0);
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([=](ZnReal *image)
+			{ image_kernel_binary_threshold(image, count, 0.25, 0.75, 1.0, 0.0); }, values, output, repeats);
+		report("binary_threshold", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	{
+		typedef itk::SigmoidImageFilter<ImageType, ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		filter->SetOutputMinimum(0.0);
+		filter->SetOutputMaximum(1.0);
+		filter->SetAlpha(0.1);
+		filter->SetBeta(0.5);
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([=](ZnReal *image)
+			{ image_kernel_sigmoid(image, count, 0.0, 1.0, 0.1, 0.5); }, values, output, repeats);
+		report("sigmoid", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	{
+		typedef itk::RescaleIntensityImageFilter<ImageType, ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		filter->SetOutputMinimum(0.0);
+		filter->SetOutputMaximum(255.0);
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([=](ZnReal *image)
+			{ image_kernel_rescale_intensity(image, count, 0.0, 255.0); }, values, output, repeats);
+		report("rescale_intensity", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	{
+		typedef itk::MeanImageFilter<ImageType, ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		FilterType::InputSizeType radius;
+		radius.Fill(2);
+		filter->SetRadius(radius);
+		const int radii[3] = { 2, 2, 2 };
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([&](ZnReal *image)
+			{ image_kernel_mean(image, 3, sizes, radii); }, values, output, repeats);
+		report("mean", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	{
+		typedef itk::DiscreteGaussianImageFilter<ImageType, ImageType> FilterType;
+		FilterType::Pointer filter = FilterType::New();
+		filter->SetVariance(4.0);
+		filter->SetMaximumKernelWidth(32);
+		const double itkSeconds = timeItkFilter(filter.GetPointer(), input, repeats);
+		const double nativeSeconds = timeNativeKernel([&](ZnReal *image)
+			{ image_kernel_discrete_gaussian(image, 3, sizes, 4.0, 32); }, values, output, repeats);
+		report("discrete_gaussian", itkSeconds, nativeSeconds, filter->GetOutput(), output);
+	}
+	return 0;
+}
@@ -122,6 +122,23 @@ ZINC_API int cmzn_fieldcache_set_node(cmzn_fieldcache_id cache, cmzn_node_id nod
  */
 ZINC_API int cmzn_fieldcache_set_time(cmzn_fieldcache_id cache, double time);
 
+/**
+ * Compiles an evaluation plan for the real-valued field in this cache, which
+ * is used by subsequent real evaluations of the field with the cache. The
+ * plan flattens the field's expression tree into a list of operations with
+ * structurally identical subexpressions merged so each is only evaluated
+ * once per location, and common arithmetic and vector operators evaluated
+ * directly. Worthwhile for complex expressions evaluated at many locations.
+ * The plan is automatically rebuilt if fields in the region change.
+ *
+ * @param cache  The field cache to compile the field in.
+ * @param field  The real-valued field to compile. Must be from the same
+ * region as cache.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_fieldcache_compile_field(cmzn_fieldcache_id cache,
+	cmzn_field_id field);
+
 #ifdef __cplusplus
 }
 #endif
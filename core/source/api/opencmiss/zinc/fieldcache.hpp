@@ -75,6 +75,11 @@ public:
 		return cmzn_fieldcache_clear_location(id);
 	}
 
+	int compileField(const Field& field)
+	{
+		return cmzn_fieldcache_compile_field(id, field.getId());
+	}
+
 	int setElement(const Element& element)
 	{
 		return cmzn_fieldcache_set_element(id, element.getId());
@@ -337,6 +337,158 @@ ZINC_API int cmzn_field_image_read(cmzn_field_image_id image_field,
  */
 ZINC_API int cmzn_field_image_read_file(cmzn_field_image_id image_field, const char *file_name);
 
+/**
+ * Reads image data from the file resources in the streaminformation into a
+ * new brick file, so the image is kept on disk in fixed-size bricks which are
+ * paged into memory on demand instead of being loaded in one allocation.
+ * Files are read and converted one at a time and must all have the same size
+ * and pixel format as the first, which gives the size of each depth plane.
+ * Use for image stacks too large to fit in memory.
+ * Memory resources are not supported.
+ *
+ * @see cmzn_field_image_set_brick_cache_size
+ * @param image_field  The image field.
+ * @param streaminformation_image  Stream information listing the image files
+ * in order of increasing depth, and any information needed to read them.
+ * @param brick_file_name  Name of brick file to create, overwriting any
+ * existing file. This can be reopened later with
+ * cmzn_field_image_read_brick_file.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_read_bricked(cmzn_field_image_id image_field,
+	cmzn_streaminformation_image_id streaminformation_image,
+	const char *brick_file_name);
+
+/**
+ * Makes the image use texels from an existing brick file written by
+ * cmzn_field_image_read_bricked, paging bricks into memory on demand.
+ *
+ * @param image_field  The image field.
+ * @param brick_file_name  Name of brick file to open.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_read_brick_file(cmzn_field_image_id image_field,
+	const char *brick_file_name);
+
+/**
+ * Query whether the image is kept on disk in a brick file.
+ *
+ * @param image_field  The image field.
+ * @return  Boolean true if image is bricked, false if in memory or invalid
+ * argument.
+ */
+ZINC_API bool cmzn_field_image_is_bricked(cmzn_field_image_id image_field);
+
+/**
+ * Get the maximum memory used to cache bricks of a bricked image.
+ *
+ * @param image_field  The image field.
+ * @return  Cache size in megabytes, default 256, or 0 if invalid argument.
+ */
+ZINC_API int cmzn_field_image_get_brick_cache_size(cmzn_field_image_id image_field);
+
+/**
+ * Set the maximum memory used to cache bricks of a bricked image. Least
+ * recently used bricks are discarded when this is exceeded. The size applies
+ * to bricked images subsequently read into the field, and at least one brick
+ * is always cached.
+ *
+ * @param image_field  The image field.
+ * @param megabytes  The cache size in megabytes, at least 1.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_set_brick_cache_size(cmzn_field_image_id image_field,
+	int megabytes);
+
+/**
+ * Get counts of brick cache lookups for a bricked image which found the brick
+ * in memory (hits) or had to read it from the brick file (misses), and of
+ * bricks discarded to stay within the cache size (evictions), since the image
+ * was read. Useful for tuning the cache size.
+ * @see cmzn_field_image_set_brick_cache_size
+ *
+ * @param image_field  The image field.
+ * @param hits_out  Address to return number of hits, limited to the maximum int.
+ * @param misses_out  Address to return number of misses, limited to the
+ * maximum int.
+ * @param evictions_out  Address to return number of evictions, limited to the
+ * maximum int.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT including if the
+ * image is not bricked.
+ */
+ZINC_API int cmzn_field_image_get_brick_cache_statistics(cmzn_field_image_id image_field,
+	int *hits_out, int *misses_out, int *evictions_out);
+
+/**
+ * Get the mip level sampled when evaluating the image with a mipmap filter
+ * mode.
+ *
+ * @param image_field  The image field.
+ * @return  Level of detail, or 0.0 if invalid argument.
+ */
+ZINC_API double cmzn_field_image_get_level_of_detail(cmzn_field_image_id image_field);
+
+/**
+ * Set the mip level sampled when evaluating the image with a mipmap filter
+ * mode, where 0 is the full resolution image and each level halves its
+ * resolution. Mip levels are built in memory when first needed. Fractional
+ * levels blend the two nearest levels with the LINEAR_MIPMAP_LINEAR filter
+ * mode and use the nearest level with other mipmap filter modes. If a
+ * sampling footprint is set, this is added to the level chosen from it.
+ * Has no effect with NEAREST and LINEAR filter modes.
+ *
+ * @param image_field  The image field.
+ * @param level_of_detail  The level of detail >= 0, default 0.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_set_level_of_detail(cmzn_field_image_id image_field,
+	double level_of_detail);
+
+/**
+ * Get the distance between samples used to choose the mip level sampled with
+ * mipmap filter modes.
+ *
+ * @param image_field  The image field.
+ * @return  Footprint in texture coordinates, or 0.0 if not set or invalid
+ * argument.
+ */
+ZINC_API double cmzn_field_image_get_sampling_footprint(cmzn_field_image_id image_field);
+
+/**
+ * Set the distance between samples in texture coordinates, e.g. the spacing of
+ * points the image is evaluated at, so the mip level sampled with mipmap
+ * filter modes is chosen automatically to avoid aliasing: the level at which
+ * one texel spans the footprint along the most minified direction.
+ *
+ * @param image_field  The image field.
+ * @param footprint  The footprint in texture coordinates, or 0 to not choose
+ * the level automatically, the default.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_set_sampling_footprint(cmzn_field_image_id image_field,
+	double footprint);
+
+/**
+ * Evaluate the image at many texture coordinates in one call, as for
+ * evaluating the field at the same texture coordinate field values, but
+ * without a field cache. Uses the filter and wrap modes, output range and
+ * level of detail of the field.
+ *
+ * @param image_field  The image field.
+ * @param point_count  The number of points to evaluate at.
+ * @param coordinate_count  The number of texture coordinates per point, 1 to
+ * 3. Missing coordinates are 0.
+ * @param texture_coordinates  Array of coordinate_count texture coordinates
+ * for each point in turn.
+ * @param values_count  Size of values_out array, at least point_count times
+ * the number of components of the field.
+ * @param values_out  Array to receive the field values for each point in turn.
+ * @return  Status CMZN_OK on success, any other value on failure.
+ */
+ZINC_API int cmzn_field_image_evaluate_samples(cmzn_field_image_id image_field,
+	int point_count, int coordinate_count, const double *texture_coordinates,
+	int values_count, double *values_out);
+
 /**
  * Writes a formatted representation of the image data.
  * The streaminformation is used to control the formatted output.
@@ -171,6 +171,62 @@ public:
 		return cmzn_field_image_read_file(getDerivedId(), fileName);
 	}
 
+	inline int readBricked(const StreaminformationImage& streaminformationImage,
+		const char *brickFileName);
+
+	int readBrickFile(const char *brickFileName)
+	{
+		return cmzn_field_image_read_brick_file(getDerivedId(), brickFileName);
+	}
+
+	bool isBricked()
+	{
+		return cmzn_field_image_is_bricked(getDerivedId());
+	}
+
+	int getBrickCacheSize()
+	{
+		return cmzn_field_image_get_brick_cache_size(getDerivedId());
+	}
+
+	int setBrickCacheSize(int megabytes)
+	{
+		return cmzn_field_image_set_brick_cache_size(getDerivedId(), megabytes);
+	}
+
+	int getBrickCacheStatistics(int *hitsOut, int *missesOut, int *evictionsOut)
+	{
+		return cmzn_field_image_get_brick_cache_statistics(getDerivedId(),
+			hitsOut, missesOut, evictionsOut);
+	}
+
+	double getLevelOfDetail()
+	{
+		return cmzn_field_image_get_level_of_detail(getDerivedId());
+	}
+
+	int setLevelOfDetail(double levelOfDetail)
+	{
+		return cmzn_field_image_set_level_of_detail(getDerivedId(), levelOfDetail);
+	}
+
+	double getSamplingFootprint()
+	{
+		return cmzn_field_image_get_sampling_footprint(getDerivedId());
+	}
+
+	int setSamplingFootprint(double footprint)
+	{
+		return cmzn_field_image_set_sampling_footprint(getDerivedId(), footprint);
+	}
+
+	int evaluateSamples(int pointCount, int coordinateCount,
+		const double *textureCoordinates, int valuesCount, double *valuesOut)
+	{
+		return cmzn_field_image_evaluate_samples(getDerivedId(), pointCount,
+			coordinateCount, textureCoordinates, valuesCount, valuesOut);
+	}
+
 	inline int write(const StreaminformationImage& streaminformationImage);
 
 	CombineMode getCombineMode()
@@ -130,6 +130,57 @@ ZINC_API cmzn_fieldmodulenotifier_id cmzn_fieldmodule_create_fieldmodulenotifier
  */
 ZINC_API int cmzn_fieldmodule_define_all_faces(cmzn_fieldmodule_id fieldmodule);
 
+/**
+ * Get the maximum memory in bytes used by each field cache for storing
+ * per-element field evaluation data for finite element fields in this field
+ * module, so it can be reused when evaluating again in recently used elements.
+ *
+ * @param fieldmodule  The field module to query.
+ * @return  Budget in bytes, or 0 if invalid argument.
+ */
+ZINC_API int cmzn_fieldmodule_get_element_evaluation_cache_budget(
+	cmzn_fieldmodule_id fieldmodule);
+
+/**
+ * Set the maximum memory in bytes used by each field cache for storing
+ * per-element field evaluation data for finite element fields in this field
+ * module. When exceeded, data for the least recently used elements is
+ * discarded. Default is 8 megabytes. Applies to field caches created after
+ * this call; existing field caches use the new budget on their next miss.
+ *
+ * @param fieldmodule  The field module to modify.
+ * @param budget_bytes  The budget in bytes >= 0. With 0 only data for the
+ * latest element is kept.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_fieldmodule_set_element_evaluation_cache_budget(
+	cmzn_fieldmodule_id fieldmodule, int budget_bytes);
+
+/**
+ * Get counts of per-element field evaluation cache lookups which reused
+ * existing data (hits) or which had to calculate it (misses), over all finite
+ * element fields and field caches in this field module since creation or the
+ * last reset. Useful for tuning the cache budget.
+ * @see cmzn_fieldmodule_set_element_evaluation_cache_budget
+ *
+ * @param fieldmodule  The field module to query.
+ * @param hits_out  Address to return number of hits, limited to the maximum int.
+ * @param misses_out  Address to return number of misses, limited to the
+ * maximum int.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_fieldmodule_get_element_evaluation_cache_statistics(
+	cmzn_fieldmodule_id fieldmodule, int *hits_out, int *misses_out);
+
+/**
+ * Reset the per-element field evaluation cache hit and miss counts to zero.
+ *
+ * @param fieldmodule  The field module to modify.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_fieldmodule_reset_element_evaluation_cache_statistics(
+	cmzn_fieldmodule_id fieldmodule);
+
 /**
  * Gets the region this field module can create fields for.
  *
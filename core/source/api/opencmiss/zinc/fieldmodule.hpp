@@ -183,6 +183,26 @@ public:
 		return cmzn_fieldmodule_define_all_faces(id);
 	}
 
+	int getElementEvaluationCacheBudget()
+	{
+		return cmzn_fieldmodule_get_element_evaluation_cache_budget(id);
+	}
+
+	int setElementEvaluationCacheBudget(int budgetBytes)
+	{
+		return cmzn_fieldmodule_set_element_evaluation_cache_budget(id, budgetBytes);
+	}
+
+	int getElementEvaluationCacheStatistics(int *hitsOut, int *missesOut)
+	{
+		return cmzn_fieldmodule_get_element_evaluation_cache_statistics(id, hitsOut, missesOut);
+	}
+
+	int resetElementEvaluationCacheStatistics()
+	{
+		return cmzn_fieldmodule_reset_element_evaluation_cache_statistics(id);
+	}
+
 	Field findFieldByName(const char *fieldName)
 	{
 		return Field(cmzn_fieldmodule_find_field_by_name(id, fieldName));
@@ -829,6 +829,104 @@ ZINC_API double cmzn_graphics_streamlines_get_track_length(
 ZINC_API int cmzn_graphics_streamlines_set_track_length(
 	cmzn_graphics_streamlines_id streamlines, double length);
 
+/**
+ * Gets the error tolerance for integrating streamlines.
+ *
+ * @param streamlines  The streamlines graphics to query.
+ * @return  The tolerance, or 0.0 if invalid streamlines graphics.
+ */
+ZINC_API double cmzn_graphics_streamlines_get_tolerance(
+	cmzn_graphics_streamlines_id streamlines);
+
+/**
+ * Sets the error tolerance for integrating streamlines. Streamlines are
+ * integrated with an adaptive Dormand-Prince (RK45) method, choosing each step
+ * so its estimated position error is within this tolerance multiplied by the
+ * size of the element it is in. Default value is 1.0E-4.
+ *
+ * @param streamlines  The streamlines graphics to modify.
+ * @param tolerance  The relative error tolerance > 0.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_graphics_streamlines_set_tolerance(
+	cmzn_graphics_streamlines_id streamlines, double tolerance);
+
+/**
+ * Gets the maximum number of integration steps taken along each streamline.
+ *
+ * @param streamlines  The streamlines graphics to query.
+ * @return  The maximum number of steps, or 0 if invalid streamlines graphics.
+ */
+ZINC_API int cmzn_graphics_streamlines_get_maximum_number_of_steps(
+	cmzn_graphics_streamlines_id streamlines);
+
+/**
+ * Sets the maximum number of integration steps taken along each streamline.
+ * Tracking stops when this number of steps is reached even if the track length
+ * has not been covered. Default value is 100000.
+ *
+ * @param streamlines  The streamlines graphics to modify.
+ * @param maximum_number_of_steps  The maximum number of steps > 0.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_graphics_streamlines_set_maximum_number_of_steps(
+	cmzn_graphics_streamlines_id streamlines, int maximum_number_of_steps);
+
+/**
+ * Gets how streamlines graphics trace particles through the stream vector
+ * field.
+ *
+ * @param streamlines  The streamlines graphics to query.
+ * @return  The current trace mode, or
+ * CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_INVALID on error.
+ */
+ZINC_API enum cmzn_graphics_streamlines_trace_mode
+	cmzn_graphics_streamlines_get_trace_mode(
+		cmzn_graphics_streamlines_id streamlines);
+
+/**
+ * Sets how streamlines graphics trace particles through the stream vector
+ * field. Pathlines and streaklines are traced forward in time through the
+ * time-varying stream vector field from the default timekeeper's minimum time
+ * to its current time, and are drawn as lines whatever the line shape.
+ * Particle positions are sampled at the path time step and kept while only
+ * time changes, so advancing time continues tracing from the latest sample
+ * and earlier times are drawn from samples already computed. Track direction
+ * and track length apply only to streamlines.
+ * @see cmzn_graphics_streamlines_trace_mode
+ *
+ * @param streamlines  The streamlines graphics to modify.
+ * @param trace_mode  The new trace mode.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_graphics_streamlines_set_trace_mode(
+	cmzn_graphics_streamlines_id streamlines,
+	enum cmzn_graphics_streamlines_trace_mode trace_mode);
+
+/**
+ * Gets the time interval between samples of pathlines and streaklines.
+ *
+ * @param streamlines  The streamlines graphics to query.
+ * @return  The path time step, or 0.0 if automatic or invalid streamlines
+ * graphics.
+ */
+ZINC_API double cmzn_graphics_streamlines_get_path_time_step(
+	cmzn_graphics_streamlines_id streamlines);
+
+/**
+ * Sets the time interval between samples of pathlines and streaklines,
+ * which is also the interval between releases of streakline particles.
+ * Particles are integrated adaptively between samples. Default value 0.0
+ * samples at 1/100 of the default timekeeper's time range, or at 0.01 if the
+ * range is zero.
+ *
+ * @param streamlines  The streamlines graphics to modify.
+ * @param time_step  The path time step >= 0, or 0.0 for automatic.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_graphics_streamlines_set_path_time_step(
+	cmzn_graphics_streamlines_id streamlines, double time_step);
+
 /**
  * If the graphics is of type surfaces then this function returns
  * the derived surfaces graphics handle.
@@ -863,6 +961,36 @@ ZINC_C_INLINE cmzn_graphics_id cmzn_graphics_surfaces_base_cast(cmzn_graphics_su
  */
 ZINC_API int cmzn_graphics_surfaces_destroy(cmzn_graphics_surfaces_id *surfaces_address);
 
+/**
+ * Get whether surfaces graphics share vertices along common edges of
+ * adjacent elements.
+ *
+ * @param surfaces  The surfaces graphics to query.
+ * @return  Boolean true if vertices are shared, false if not or invalid
+ * surfaces graphics.
+ */
+ZINC_API bool cmzn_graphics_surfaces_is_shared_vertices(
+	cmzn_graphics_surfaces_id surfaces);
+
+/**
+ * Set whether surfaces graphics share vertices along common edges of
+ * adjacent elements, giving an indexed triangle mesh with no duplicated
+ * vertices on internal edges. This reduces memory and upload size, and
+ * exports are welded, but assumes all fields visualised are continuous
+ * across element boundaries. Normals on shared vertices are the average of
+ * the unit normals of all elements using them, but data, texture
+ * coordinates and tangents are taken from the first element they are
+ * evaluated in. Only applies to square elements; triangles and collapsed
+ * elements are not welded.
+ * Default is false i.e. each element has its own vertices.
+ *
+ * @param surfaces  The surfaces graphics to modify.
+ * @param shared_vertices  New value: true to share vertices, false to not.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_graphics_surfaces_set_shared_vertices(
+	cmzn_graphics_surfaces_id surfaces, bool shared_vertices);
+
 /**
  * If the graphics produces lines or extrusions then returns a handle to the
  * line attribute object for specifying section profile and scaling.
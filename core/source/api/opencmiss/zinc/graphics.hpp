@@ -454,6 +454,14 @@ public:
 		TRACK_DIRECTION_REVERSE = CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE
 	};
 
+	enum TraceMode
+	{
+		TRACE_MODE_INVALID = CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_INVALID,
+		TRACE_MODE_STREAMLINE = CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE,
+		TRACE_MODE_PATHLINE = CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE,
+		TRACE_MODE_STREAKLINE = CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE
+	};
+
 	ColourDataType getColourDataType()
 	{
 		return static_cast<ColourDataType>(cmzn_graphics_streamlines_get_colour_data_type(this->getDerivedId()));
@@ -497,6 +505,48 @@ public:
 		return cmzn_graphics_streamlines_set_track_length(this->getDerivedId(), length);
 	}
 
+	double getTolerance()
+	{
+		return cmzn_graphics_streamlines_get_tolerance(this->getDerivedId());
+	}
+
+	int setTolerance(double tolerance)
+	{
+		return cmzn_graphics_streamlines_set_tolerance(this->getDerivedId(), tolerance);
+	}
+
+	int getMaximumNumberOfSteps()
+	{
+		return cmzn_graphics_streamlines_get_maximum_number_of_steps(this->getDerivedId());
+	}
+
+	int setMaximumNumberOfSteps(int maximumNumberOfSteps)
+	{
+		return cmzn_graphics_streamlines_set_maximum_number_of_steps(this->getDerivedId(), maximumNumberOfSteps);
+	}
+
+	TraceMode getTraceMode()
+	{
+		return static_cast<TraceMode>(
+			cmzn_graphics_streamlines_get_trace_mode(this->getDerivedId()));
+	}
+
+	int setTraceMode(TraceMode traceMode)
+	{
+		return cmzn_graphics_streamlines_set_trace_mode(this->getDerivedId(),
+			static_cast<cmzn_graphics_streamlines_trace_mode>(traceMode));
+	}
+
+	double getPathTimeStep()
+	{
+		return cmzn_graphics_streamlines_get_path_time_step(this->getDerivedId());
+	}
+
+	int setPathTimeStep(double timeStep)
+	{
+		return cmzn_graphics_streamlines_set_path_time_step(this->getDerivedId(), timeStep);
+	}
+
 };
 
 class GraphicsSurfaces : public Graphics
@@ -505,12 +555,28 @@ friend class Scene;
 private:
 	explicit GraphicsSurfaces(cmzn_graphics_id graphics_id) : Graphics(graphics_id) {}
 
+	inline cmzn_graphics_surfaces_id getDerivedId() const
+	{
+		return reinterpret_cast<cmzn_graphics_surfaces_id>(this->id);
+	}
+
 public:
 	GraphicsSurfaces() : Graphics(0) {}
 
 	explicit GraphicsSurfaces(cmzn_graphics_surfaces_id surfaces_id)
 		: Graphics(reinterpret_cast<cmzn_graphics_id>(surfaces_id))
 	{}
+
+	bool isSharedVertices()
+	{
+		return cmzn_graphics_surfaces_is_shared_vertices(this->getDerivedId());
+	}
+
+	int setSharedVertices(bool sharedVertices)
+	{
+		return cmzn_graphics_surfaces_set_shared_vertices(this->getDerivedId(), sharedVertices);
+	}
+
 };
 
 inline GraphicsContours Graphics::castContours()
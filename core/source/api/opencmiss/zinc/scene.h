@@ -517,6 +517,58 @@ ZINC_API int cmzn_scene_get_transformation_matrix(cmzn_scene_id scene,
 ZINC_API int cmzn_scene_set_transformation_matrix(cmzn_scene_id scene,
 	const double *valuesIn16);
 
+/**
+ * Get the maximum memory in megabytes each graphics in the scene uses to
+ * keep graphics objects built for other levels of detail i.e. tessellation
+ * divisions.
+ * @see cmzn_scene_set_level_of_detail_cache_budget
+ *
+ * @param scene  The scene to query.
+ * @return  Budget in megabytes, or 0 if invalid argument.
+ */
+ZINC_API int cmzn_scene_get_level_of_detail_cache_budget(cmzn_scene_id scene);
+
+/**
+ * Set the maximum memory in megabytes each graphics in the scene uses to
+ * keep graphics objects built for other levels of detail, so switching back
+ * to them e.g. during interactive zoom reuses them instead of rebuilding.
+ * When exceeded, least recently used levels are discarded. Default is 64
+ * megabytes. To keep no other levels of detail, set the maximum levels to 0.
+ * @see cmzn_scene_set_level_of_detail_cache_maximum_levels
+ *
+ * @param scene  The scene to modify.
+ * @param budget_megabytes  The budget in megabytes > 0. A budget of 0 or
+ * less is rejected.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_scene_set_level_of_detail_cache_budget(cmzn_scene_id scene,
+	int budget_megabytes);
+
+/**
+ * Get the maximum number of other levels of detail each graphics in the scene
+ * keeps graphics objects for.
+ * @see cmzn_scene_set_level_of_detail_cache_maximum_levels
+ *
+ * @param scene  The scene to query.
+ * @return  Maximum number of levels, or 0 if invalid argument.
+ */
+ZINC_API int cmzn_scene_get_level_of_detail_cache_maximum_levels(
+	cmzn_scene_id scene);
+
+/**
+ * Set the maximum number of other levels of detail each graphics in the scene
+ * keeps graphics objects for, irrespective of the memory budget. When
+ * exceeded, least recently used levels are discarded. Default is 4.
+ * @see cmzn_scene_set_level_of_detail_cache_budget
+ *
+ * @param scene  The scene to modify.
+ * @param maximum_levels  The maximum number of levels >= 0. With 0 no other
+ * levels of detail are kept.
+ * @return  Result OK on success, otherwise ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_scene_set_level_of_detail_cache_maximum_levels(
+	cmzn_scene_id scene, int maximum_levels);
+
 /**
  * Returns the state of the scene's visibility flag.
  *
@@ -280,6 +280,26 @@ public:
 		return cmzn_scene_set_transformation_matrix(this->getId(), valuesIn16);
 	}
 
+	int getLevelOfDetailCacheBudget()
+	{
+		return cmzn_scene_get_level_of_detail_cache_budget(id);
+	}
+
+	int setLevelOfDetailCacheBudget(int budgetMegabytes)
+	{
+		return cmzn_scene_set_level_of_detail_cache_budget(id, budgetMegabytes);
+	}
+
+	int getLevelOfDetailCacheMaximumLevels()
+	{
+		return cmzn_scene_get_level_of_detail_cache_maximum_levels(id);
+	}
+
+	int setLevelOfDetailCacheMaximumLevels(int maximumLevels)
+	{
+		return cmzn_scene_set_level_of_detail_cache_maximum_levels(id, maximumLevels);
+	}
+
 	bool getVisibilityFlag()
 	{
 		return cmzn_scene_get_visibility_flag(id);
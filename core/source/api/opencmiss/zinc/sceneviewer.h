@@ -601,6 +601,44 @@ ZINC_API int cmzn_sceneviewer_write_image_to_file(cmzn_sceneviewer_id sceneviewe
 	const char *file_name, int force_onscreen, int preferred_width,
 	int preferred_height, int preferred_antialias, int preferred_transparency_layers);
 
+/**
+ * Renders the scene viewer's scene into an RGBA image in memory with the
+ * software renderer, which rasterises graphics on the CPU and does not need an
+ * OpenGL context or display. Surfaces, lines and points are drawn in their
+ * material diffuse or spectrum colours with depth buffering; texturing,
+ * lighting models other than a simple headlight, labels and graphics in
+ * window coordinate systems other than normalised window fill are not
+ * rendered. The current view parameters and background colour are used.
+ *
+ * @param sceneviewer  The scene viewer to render.
+ * @param width  Width of the image in pixels, > 0.
+ * @param height  Height of the image in pixels, > 0.
+ * @param pixels  Caller-allocated array of at least width*height*4 bytes to
+ * receive the RGBA image, stored in rows from bottom to top.
+ * @return  Status CMZN_OK on success, CMZN_ERROR_ARGUMENT if invalid
+ * arguments, or CMZN_ERROR_GENERAL if rendering failed.
+ */
+ZINC_API int cmzn_sceneviewer_render_software_pixels(
+	cmzn_sceneviewer_id sceneviewer, int width, int height,
+	unsigned char *pixels);
+
+/**
+ * Writes the view in the scene viewer to the specified file using the software
+ * renderer, which does not require an OpenGL context or display.
+ * @see cmzn_sceneviewer_render_software_pixels
+ *
+ * @param sceneviewer  The scene viewer to render.
+ * @param file_name  Name of the image file to write. The image format is
+ * determined from the file extension.
+ * @param width  Width of the image in pixels, > 0.
+ * @param height  Height of the image in pixels, > 0.
+ * @return  Status CMZN_OK on success, CMZN_ERROR_ARGUMENT if invalid
+ * arguments, or CMZN_ERROR_GENERAL if rendering or writing failed.
+ */
+ZINC_API int cmzn_sceneviewer_write_image_to_file_software(
+	cmzn_sceneviewer_id sceneviewer, const char *file_name, int width,
+	int height);
+
 /**
  * Gets the NDC information.
  */
@@ -566,6 +566,16 @@ public:
 			preferred_height, preferred_antialias, preferred_transparency_layers);
 	}
 
+	int renderSoftwarePixels(int width, int height, unsigned char *pixels)
+	{
+		return cmzn_sceneviewer_render_software_pixels(id, width, height, pixels);
+	}
+
+	int writeImageToFileSoftware(const char *file_name, int width, int height)
+	{
+		return cmzn_sceneviewer_write_image_to_file_software(id, file_name, width, height);
+	}
+
 	int addLight(const Light& light)
 	{
 		return cmzn_sceneviewer_add_light(id, light.getId());
@@ -117,6 +117,13 @@ inline int FieldImage::read(const StreaminformationImage& streaminformationImage
   return cmzn_field_image_read(getDerivedId(), streaminformationImage.getDerivedId());
 }
 
+inline int FieldImage::readBricked(const StreaminformationImage& streaminformationImage,
+	const char *brickFileName)
+{
+  return cmzn_field_image_read_bricked(getDerivedId(), streaminformationImage.getDerivedId(),
+    brickFileName);
+}
+
 inline int FieldImage::write(const StreaminformationImage& streaminformationImage)
 {
   return cmzn_field_image_write(getDerivedId(), streaminformationImage.getDerivedId());
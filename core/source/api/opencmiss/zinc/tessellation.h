@@ -191,6 +191,37 @@ ZINC_API cmzn_tessellation_id cmzn_tessellation_access(cmzn_tessellation_id tess
  */
 ZINC_API int cmzn_tessellation_destroy(cmzn_tessellation_id *tessellation_address);
 
+/**
+ * Gets the adaptive tolerance controlling curvature-based reduction of
+ * element divisions for line and surface graphics.
+ *
+ * @see cmzn_tessellation_set_adaptive_tolerance
+ * @param tessellation  The tessellation to query.
+ * @return  The adaptive tolerance, or 0.0 if not adaptive or on error.
+ */
+ZINC_API double cmzn_tessellation_get_adaptive_tolerance(
+    cmzn_tessellation_id tessellation);
+
+/**
+ * Sets the adaptive tolerance controlling curvature-based reduction of
+ * element divisions for line and surface graphics. When positive, the
+ * number of divisions in each element direction is chosen so the estimated
+ * deviation of each chord from the curved geometry is no more than the
+ * tolerance multiplied by the chord length, between the minimum divisions
+ * and the full refined divisions otherwise used. Surface elements joined
+ * through opposite edges share the largest divisions any of them needs, so
+ * adjacent elements have the same vertices on common edges with no cracks.
+ * Other graphics types are unaffected.
+ * The default value of 0.0 disables adaptive tessellation.
+ *
+ * @param tessellation  The tessellation to modify.
+ * @param adaptiveTolerance  Relative chord deviation tolerance >= 0.0, or 0.0
+ * to disable adaptive tessellation. Typical values are 0.001 to 0.05.
+ * @return  Status CMZN_OK on success, otherwise CMZN_ERROR_ARGUMENT.
+ */
+ZINC_API int cmzn_tessellation_set_adaptive_tolerance(
+    cmzn_tessellation_id tessellation, double adaptiveTolerance);
+
 /**
  * Gets the number of line segments used to approximate circles in graphics
  * produced with this tessellation. This applies to lines with a circle profile,
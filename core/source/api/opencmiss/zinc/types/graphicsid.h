@@ -111,6 +111,29 @@ enum cmzn_graphics_streamlines_track_direction
 	/*!< the reverse of stream_vector_field is tracked */
 };
 
+/**
+ * Enumeration giving how streamlines graphics trace particles through the
+ * stream vector field.
+ *
+ * @see cmzn_graphics_streamlines_set_trace_mode
+ */
+enum cmzn_graphics_streamlines_trace_mode
+{
+	CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_INVALID = 0,
+	/*!< Unspecified trace mode */
+	CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE = 1,
+	/*!< Default: track lines tangent to the stream vector field frozen at the
+	 * current time */
+	CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE = 2,
+	/*!< Show paths of particles released from the seed points at the
+	 * timekeeper minimum time and advected forward through the time-varying
+	 * stream vector field to the current time */
+	CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE = 3
+	/*!< Show lines joining particles released from each seed point at regular
+	 * intervals from the timekeeper minimum time, advected forward through the
+	 * time-varying stream vector field to the current time */
+};
+
 /**
  * @brief Surfaces visualise 2-D elements in the model.
  *
@@ -30,6 +30,8 @@ SET( COMPUTED_FIELD_CORE_SRCS
 	source/computed_field/differential_operator.cpp
 	source/computed_field/field_cache.cpp
 	source/computed_field/field_derivative.cpp
+	source/computed_field/field_evaluation_plan.cpp
+	source/computed_field/field_expression_kernel.cpp
 	source/computed_field/field_module.cpp
 	source/computed_field/fieldassignmentprivate.cpp
 	source/computed_field/fieldparametersprivate.cpp
@@ -63,6 +65,8 @@ SET( COMPUTED_FIELD_CORE_HDRS
 	source/computed_field/differential_operator.hpp
 	source/computed_field/field_cache.hpp
 	source/computed_field/field_derivative.hpp
+	source/computed_field/field_evaluation_plan.hpp
+	source/computed_field/field_expression_kernel.hpp
 	source/computed_field/field_module.hpp
 	source/computed_field/fieldassignmentprivate.hpp
 	source/computed_field/fieldparametersprivate.hpp
@@ -69,6 +69,7 @@ SET( GENERAL_HDRS
 	source/general/mystring.h
 	source/general/object.h
 	source/general/octree.h
+	source/general/parallel.hpp
 	source/general/random.h
 	source/general/refcounted.hpp
 	source/general/refhandle.hpp
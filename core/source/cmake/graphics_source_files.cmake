@@ -33,10 +33,12 @@ SET( GRAPHICS_SRCS
 	source/graphics/import_graphics_object.cpp
 	source/graphics/iso_field_calculation.cpp
 	source/graphics/laguer.cpp
+	source/graphics/marching_cubes.cpp
 	source/graphics/material.cpp
 	source/graphics/mcubes.cpp
 	source/graphics/order_independent_transparency.cpp
 	source/graphics/render_to_finite_elements.cpp
+	source/graphics/render_software.cpp
 	source/graphics/render_stl.cpp
 	source/graphics/render_vrml.cpp
 	source/graphics/render_wavefront.cpp
@@ -52,6 +54,9 @@ SET( GRAPHICS_SRCS
 	source/graphics/spectrum_component.cpp
 	source/graphics/tessellation.cpp
 	source/graphics/texture.cpp
+	source/graphics/texture_brick_store.cpp
+	source/graphics/texture_range_tree.cpp
+	source/graphics/texture_sampler.cpp
 	source/graphics/texture_line.cpp
 	source/graphics/threejs_export.cpp
 	source/graphics/triangle_mesh.cpp
@@ -88,6 +93,7 @@ SET( GRAPHICS_HDRS
 	source/graphics/import_graphics_object.h
 	source/graphics/iso_field_calculation.h
 	source/graphics/laguer.h
+	source/graphics/marching_cubes.hpp
 	source/graphics/material.h
 	source/graphics/material.hpp
 	source/graphics/mcubes.h
@@ -95,6 +101,7 @@ SET( GRAPHICS_HDRS
 	source/graphics/quaternion.hpp
 	source/graphics/render_alias.h
 	source/graphics/render_binary_wavefront.h
+	source/graphics/render_software.hpp
 	source/graphics/render_stl.h
 	source/graphics/render_vrml.h
 	source/graphics/render_wavefront.h
@@ -113,6 +120,9 @@ SET( GRAPHICS_HDRS
 	source/graphics/tessellation.hpp
 	source/graphics/texture.h
 	source/graphics/texture.hpp
+	source/graphics/texture_brick_store.hpp
+	source/graphics/texture_range_tree.hpp
+	source/graphics/texture_sampler.hpp
 	source/graphics/texture_line.h
 	source/graphics/threejs_export.hpp
 	source/graphics/triangle_mesh.hpp
@@ -8,9 +8,11 @@
 # file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 SET( IMAGE_PROCESSING_SRCS
-	source/image_processing/computed_field_image_resample.cpp )
+	source/image_processing/computed_field_image_resample.cpp
+	source/image_processing/image_filter_kernels.cpp )
 SET( IMAGE_PROCESSING_HDRS
-	source/image_processing/computed_field_image_resample.h )
+	source/image_processing/computed_field_image_resample.h
+	source/image_processing/image_filter_kernels.hpp )
 
 IF( ZINC_USE_ITK )
 	SET( IMAGE_PROCESSING_SRCS ${IMAGE_PROCESSING_SRCS}
@@ -53,11 +53,13 @@ SET( FIELD_IO_HDRS
 
 SET( IMAGE_IO_SRCS
 	source/image_io/analyze.cpp
-	source/image_io/analyze_object_map.cpp )
+	source/image_io/analyze_object_map.cpp
+	source/image_io/volume_reader.cpp )
 SET( IMAGE_IO_HDRS
 	source/image_io/analyze.h
 	source/image_io/analyze_header.h
-	source/image_io/analyze_object_map.hpp )
+	source/image_io/analyze_object_map.hpp
+	source/image_io/volume_reader.hpp )
 
 SET( LICENSE_HDRS source/license.h )
 
@@ -1264,6 +1264,49 @@ int Computed_field_core::evaluateDerivativeFiniteDifference(cmzn_fieldcache& cac
 	return 1;
 }
 
+int Computed_field_core::evaluateDerivativeComponentFunction(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache,
+	const FieldDerivative& fieldDerivative, ComponentFunctionDerivatives componentFunctionDerivatives)
+{
+	const int totalDerivativeOrder = fieldDerivative.getTotalOrder();
+	if ((totalDerivativeOrder > 2) || ((totalDerivativeOrder == 2)
+		&& fieldDerivative.getMeshOrder() && fieldDerivative.getParameterOrder()))
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	cmzn_field *sourceField = this->getSourceField(0);
+	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(sourceField->evaluate(cache));
+	const DerivativeValueCache *sourceDerivativeCache = sourceField->evaluateDerivative(cache, fieldDerivative);
+	const DerivativeValueCache *sourceLowerDerivativeCache = (totalDerivativeOrder == 2) ?
+		sourceField->evaluateDerivative(cache, *fieldDerivative.getLowerDerivative()) : nullptr;
+	if (!((sourceCache) && (sourceDerivativeCache) && ((totalDerivativeOrder == 1) || (sourceLowerDerivativeCache))))
+		return 0;
+	DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+	FE_value *derivatives = derivativeCache->values;
+	const FE_value *sourceDerivatives = sourceDerivativeCache->values;
+	const int componentCount = this->field->number_of_components;
+	const int termCount = derivativeCache->getTermCount();
+	const int lowerTermCount = (sourceLowerDerivativeCache) ? sourceLowerDerivativeCache->getTermCount() : 0;
+	FE_value df_du, d2f_du2;
+	for (int i = 0; i < componentCount; ++i)
+	{
+		(componentFunctionDerivatives)(sourceCache->values[i], df_du, d2f_du2);
+		for (int j = 0; j < termCount; ++j)
+			derivatives[j] = df_du*sourceDerivatives[j];
+		if (sourceLowerDerivativeCache)
+		{
+			// second derivative terms cycle over lower derivative terms fastest
+			const FE_value *sourceLowerDerivatives = sourceLowerDerivativeCache->values + i*lowerTermCount;
+			for (int j = 0; j < lowerTermCount; ++j)
+			{
+				const FE_value d2f_du2_du_dxj = d2f_du2*sourceLowerDerivatives[j];
+				for (int k = 0; k < lowerTermCount; ++k)
+					derivatives[j*lowerTermCount + k] += d2f_du2_du_dxj*sourceLowerDerivatives[k];
+			}
+		}
+		derivatives += termCount;
+		sourceDerivatives += termCount;
+	}
+	return 1;
+}
+
 // default valid for most complicated or transcendental functions:
 // use the maximum source field order, maximised up to the mesh order or total order
 int Computed_field_core::getDerivativeTreeOrder(const FieldDerivative& fieldDerivative)
@@ -1468,7 +1511,12 @@ int cmzn_field_evaluate_real(cmzn_field_id field, cmzn_fieldcache_id cache,
 	if (cmzn_fieldcache_check(field, cache) && (number_of_values >= field->number_of_components) && values &&
 		field->core->has_numerical_components())
 	{
-		const FieldValueCache *valueCache = field->evaluate(*cache);
+		const FieldValueCache *valueCache = nullptr;
+		FieldEvaluationPlan *evaluationPlan = cache->getEvaluationPlan(field);
+		if (evaluationPlan)
+			valueCache = evaluationPlan->evaluate(*cache);
+		if (!valueCache)
+			valueCache = field->evaluate(*cache);
 		if (valueCache)
 		{
 			const FE_value *sourceValues = RealFieldValueCache::cast(valueCache)->values;
@@ -1552,7 +1600,12 @@ int cmzn_field_evaluate_derivative(cmzn_field_id field,
 		FieldDerivative& fieldDerivative = differential_operator->getFieldDerivative();
 		if (field->manager->owner != fieldDerivative.getRegion())
 			return CMZN_ERROR_ARGUMENT;
-		const DerivativeValueCache *derivativeValueCache = field->evaluateDerivative(*cache, fieldDerivative);
+		const DerivativeValueCache *derivativeValueCache = nullptr;
+		FieldEvaluationPlan *evaluationPlan = cache->getEvaluationPlan(field);
+		if (evaluationPlan)
+			derivativeValueCache = evaluationPlan->evaluateDerivative(*cache, fieldDerivative);
+		if (!derivativeValueCache)
+			derivativeValueCache = field->evaluateDerivative(*cache, fieldDerivative);
 		if (derivativeValueCache)
 		{
 			// with some derivatives, don't know number of terms until evaluated, so check here:
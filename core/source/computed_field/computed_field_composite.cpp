@@ -857,6 +857,21 @@ FE_value *Computed_field_constant_get_values_storage(cmzn_field *field)
 	return 0;
 }
 
+int Computed_field_composite_get_component_source(cmzn_field *field,
+	int componentIndex, int *sourceFieldIndex, int *sourceValueIndex)
+{
+	Computed_field_composite *compositeCore = (field) ?
+		dynamic_cast<Computed_field_composite*>(field->core) : nullptr;
+	if ((compositeCore) && (0 <= componentIndex) && (componentIndex < field->number_of_components)
+		&& (sourceFieldIndex) && (sourceValueIndex))
+	{
+		*sourceFieldIndex = compositeCore->source_field_numbers[componentIndex];
+		*sourceValueIndex = compositeCore->source_value_numbers[componentIndex];
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_is_constant(cmzn_field *field)
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
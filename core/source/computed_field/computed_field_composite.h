@@ -52,6 +52,19 @@ Returns true if the field is of type composite but with no source_fields, only
 source_values.
 ==============================================================================*/
 
+/**
+ * Get the source of a component of a composite, component, concatenate,
+ * identity or constant field.
+ * @param componentIndex  Index of component from 0 to number_of_components-1.
+ * @param sourceFieldIndex  On return, index of source field, or -1 if the
+ * component is one of the field's source values.
+ * @param sourceValueIndex  On return, component index from 0 in the source
+ * field, or index into the field's source values if sourceFieldIndex is -1.
+ * @return  1 on success, 0 if not a composite field or invalid arguments.
+ */
+int Computed_field_composite_get_component_source(struct Computed_field *field,
+	int componentIndex, int *sourceFieldIndex, int *sourceValueIndex);
+
 int Computed_field_is_constant_scalar(struct Computed_field *field,
 	FE_value scalar);
 /*******************************************************************************
@@ -15,14 +15,17 @@ lookup of the element.
 
 #include <stdio.h>
 #include <math.h>
+#include <vector>
 
 #include "general/debug.h"
 #include "general/matrix_vector.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_private.hpp"
+#include "computed_field/computed_field_finite_element.h"
 #include "computed_field/computed_field_find_xi.h"
 #include "computed_field/computed_field_find_xi_private.hpp"
 #include "finite_element/finite_element_discretization.h"
+#include "finite_element/finite_element_mesh.hpp"
 #include "finite_element/finite_element_region.h"
 #include "general/message.h"
 
@@ -33,7 +36,8 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 {
 	double a[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS],
 		b[MAXIMUM_ELEMENT_XI_DIMENSIONS], d, sum;
-	FE_value *derivatives, last_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], *values;
+	FE_value *derivatives, last_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS],
+		unlimited_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], *values;
 	int converged, i, indx[MAXIMUM_ELEMENT_XI_DIMENSIONS], iterations, j, k,
 		number_of_xi, number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], 
 		number_of_xi_points_created[MAXIMUM_ELEMENT_XI_DIMENSIONS], return_code;
@@ -43,6 +47,7 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 	ENTER(Computed_field_iterative_element_conditional);
 	if (element && data)
 	{
+		data->outside_face_number = -1;
 		number_of_xi = get_FE_element_dimension(element);
 		if (number_of_xi <= data->number_of_values)
 		{
@@ -102,9 +107,60 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 							last_xi[i] = 0.5;
 						}
 					}
+					if (data->find_nearest_location)
+					{
+						/* start from the nearest of a set of sample points, evaluated
+							together if field is directly a finite element field */
+						int number_of_sample_points = 0;
+						for (i = 0 ; i < number_of_xi ; i++)
+						{
+							number_in_xi[i] = 3;
+						}
+						if (FE_element_shape_get_xi_points_cell_centres(shape,
+							number_in_xi, &number_of_sample_points, &xi_points))
+						{
+							std::vector<FE_value> sample_xi(number_of_sample_points*number_of_xi);
+							for (j = 0; j < number_of_sample_points; j++)
+							{
+								for (i = 0 ; i < number_of_xi ; i++)
+								{
+									sample_xi[j*number_of_xi + i] = xi_points[j][i];
+								}
+							}
+							std::vector<FE_value> sample_values(number_of_sample_points*data->number_of_values);
+							if (cmzn_field_evaluate_real_points(data->field, data->field_cache, element,
+								/*topLevelElement*/0, number_of_sample_points, sample_xi.data(),
+								/*meshDerivativeOrder*/0, sample_values.data()))
+							{
+								double nearest_distance_squared = 0.0;
+								int nearest_sample = -1;
+								for (j = 0; j < number_of_sample_points; j++)
+								{
+									double distance_squared = 0.0;
+									for (k = 0; k < data->number_of_values; k++)
+									{
+										const double delta = (double)sample_values[j*data->number_of_values + k] - (double)data->values[k];
+										distance_squared += delta*delta;
+									}
+									if ((nearest_sample < 0) || (distance_squared < nearest_distance_squared))
+									{
+										nearest_distance_squared = distance_squared;
+										nearest_sample = j;
+									}
+								}
+								for (i = 0 ; i < number_of_xi ; i++)
+								{
+									data->xi[i] = sample_xi[nearest_sample*number_of_xi + i];
+									last_xi[i] = data->xi[i];
+								}
+							}
+							DEALLOCATE(xi_points);
+						}
+					}
 				}
 				converged = 0;
 				iterations = 0;
+				bool have_unlimited_xi = false;
 				while ((!converged) && return_code)
 				{
 					if ((CMZN_OK == data->field_cache->setMeshLocation(element, data->xi)) &&
@@ -170,6 +226,13 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 							iterations++;
 							if (!converged)
 							{
+								/* remember where the solution is heading before limiting
+									xi, to choose the neighbour to try if not found */
+								for (i = 0; i < number_of_xi; i++)
+								{
+									unlimited_xi[i] = data->xi[i];
+								}
+								have_unlimited_xi = true;
 								FE_element_shape_limit_xi_to_element(shape,
 									data->xi, data->xi_tolerance);
 								if (iterations == MAX_FIND_XI_ITERATIONS)
@@ -209,6 +272,11 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 						return_code = 0;
 					}
 				}
+				if ((!converged) && have_unlimited_xi)
+				{
+					FE_element_shape_find_face_number_outside_xi(shape, unlimited_xi,
+						data->xi_tolerance, &data->outside_face_number);
+				}
 				/* if field has more components than xi-directions, must
 					check all components have converged */
 				if (converged && (data->number_of_values > number_of_xi))
@@ -283,6 +351,48 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 
 #undef MAX_FIND_XI_ITERATIONS
 
+#define MAX_FIND_XI_WALK_STEPS 100
+
+/**
+ * Search for element xi by walking from start element to the neighbour
+ * across the face the solution lies beyond until found. Fast for coherent
+ * queries but may fail for non-convex meshes or meshes without faces.
+ * @return  Non-accessed element containing solution, or 0 if not found.
+ */
+static struct FE_element *Computed_field_walk_find_element_xi(
+	struct FE_element *start_element, cmzn_mesh_id search_mesh,
+	struct Computed_field_iterative_find_element_xi_data *data)
+{
+	struct FE_element *element = start_element;
+	for (int step = 0; step < MAX_FIND_XI_WALK_STEPS; ++step)
+	{
+		if (Computed_field_iterative_element_conditional(element, data))
+		{
+			return element;
+		}
+		if (data->outside_face_number < 0)
+		{
+			break;
+		}
+		FE_mesh *fe_mesh = element->getMesh();
+		int new_face_number;
+		const DsLabelIndex neighbour_index = (fe_mesh) ? fe_mesh->getElementFirstNeighbour(
+			element->getIndex(), data->outside_face_number, new_face_number) : DS_LABEL_INDEX_INVALID;
+		if (neighbour_index < 0)
+		{
+			break;
+		}
+		element = fe_mesh->getElement(neighbour_index);
+		if (!((element) && cmzn_mesh_contains_element(search_mesh, element)))
+		{
+			break;
+		}
+	}
+	return 0;
+}
+
+#undef MAX_FIND_XI_WALK_STEPS
+
 int Computed_field_perform_find_element_xi(struct Computed_field *field,
 	cmzn_fieldcache_id field_cache,
 	const FE_value *values, int number_of_values,
@@ -375,14 +485,25 @@ int Computed_field_perform_find_element_xi(struct Computed_field *field,
 			{
 				*element_address = (struct FE_element *)NULL;
 
-				/* Try the cached element first if it is in the mesh */
-				if ((!find_nearest) && cache->element &&
-					cmzn_mesh_contains_element(search_mesh, cache->element))
+				/* For exact search, walk from the cached element if it is in the
+					mesh, otherwise the first element, towards the solution */
+				if (!find_nearest)
 				{
-					if (Computed_field_iterative_element_conditional(
-						cache->element, &find_element_xi_data))
+					cmzn_element_id start_element = 0;
+					if (cache->element && cmzn_mesh_contains_element(search_mesh, cache->element))
+					{
+						start_element = cache->element;
+					}
+					else
+					{
+						cmzn_elementiterator_id iterator = cmzn_mesh_create_elementiterator(search_mesh);
+						start_element = cmzn_elementiterator_next_non_access(iterator);
+						cmzn_elementiterator_destroy(&iterator);
+					}
+					if (start_element)
 					{
-						*element_address = cache->element;
+						*element_address = Computed_field_walk_find_element_xi(
+							start_element, search_mesh, &find_element_xi_data);
 					}
 				}
 				/* Now try every element */
@@ -118,6 +118,8 @@ matches the <field> in this structure or one of its source fields.
 	double nearest_element_distance_squared;
 	int start_with_data_xi;
 	double time;
+	/* set by search: face the solution lies beyond if not found, or -1 */
+	int outside_face_number;
 }; /* Computed_field_iterative_find_element_xi_data */
 
 int Computed_field_iterative_element_conditional(struct FE_element *element,
@@ -128,6 +130,8 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
  * The <values> passed in the <data> structure must not be a pointer to values
  * inside a field cache otherwise they may be overwritten if the field is the
  * same as the <data> field or any of its source fields.
+ * If not found, sets data outside_face_number to the face of element the
+ * solution appears to be beyond, or -1 if unknown.
  *
  * @return  1 if a valid element xi is found.
  */
@@ -10,7 +10,8 @@
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <cmath>
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "opencmiss/zinc/fieldmodule.h"
 #include "opencmiss/zinc/fieldfiniteelement.h"
 #include "opencmiss/zinc/mesh.h"
@@ -64,16 +65,42 @@ DESCRIPTION :
 
 namespace {
 
-typedef std::map<cmzn_element *, FE_element_field_evaluation *> FE_element_field_evaluation_map;
-
-/** reference counted cache of FE_element_field_evaluation for recent elements to share between field caches */
+/**
+ * Reference counted cache of FE_element_field_evaluation for recent elements to
+ * share between field caches. Evaluations are held in a slot array and found
+ * from element index in a hash map per mesh dimension, so memory is
+ * proportional to the number cached, not to the mesh size. Total memory is
+ * limited to the budget set in the FE_region, evicting least recently used
+ * evaluations by the CLOCK algorithm: the clock hand sweeps the slots,
+ * clearing referenced flags set on each lookup and evicting the first slot not
+ * referenced since its last sweep.
+ */
 class FE_element_field_evaluation_cache
 {
-	FE_element_field_evaluation_map element_field_evaluation_map;
+	struct Slot
+	{
+		FE_element_field_evaluation *evaluation;  // accessed, or 0 if slot is free
+		size_t memorySize;
+		DsLabelIndex elementIndex;
+		int dimension;
+		bool referenced;
+	};
+
+	FE_region *fe_region;  // not accessed; owned by region accessed by field cache
+	std::vector<Slot> slots;
+	typedef std::unordered_map<DsLabelIndex, int> ElementSlotMap;
+	// for each mesh dimension, map from element index to slot number
+	ElementSlotMap elementSlots[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	std::vector<int> freeSlots;
+	size_t memorySize;  // total memory size of evaluations in slots
+	size_t clockHand;
 	FE_element_field_evaluation *element_field_evaluation;  // evalution object for latest element
 	int access_count;
 
-	FE_element_field_evaluation_cache() :
+	FE_element_field_evaluation_cache(FE_region *fe_regionIn) :
+		fe_region(fe_regionIn),
+		memorySize(0),
+		clockHand(0),
 		element_field_evaluation(0),
 		access_count(1)
 	{
@@ -84,20 +111,79 @@ class FE_element_field_evaluation_cache
 		this->clear();
 	}
 
-	void inline clear_map()
+	void evictSlot(int slotNumber)
+	{
+		Slot& slot = this->slots[slotNumber];
+		this->elementSlots[slot.dimension - 1].erase(slot.elementIndex);
+		this->memorySize -= slot.memorySize;
+		FE_element_field_evaluation::deaccess(slot.evaluation);
+		slot.memorySize = 0;
+		slot.referenced = false;
+		this->freeSlots.push_back(slotNumber);
+	}
+
+	/** Evict evaluations not recently used until memory size plus
+	 * requiredMemorySize fits in budget or no evaluations are left. */
+	void evictToBudget(size_t requiredMemorySize)
 	{
-		for (FE_element_field_evaluation_map::iterator iter = this->element_field_evaluation_map.begin();
-			iter != this->element_field_evaluation_map.end(); ++iter)
+		const size_t budget = static_cast<size_t>(this->fe_region->getElementEvaluationCacheBudget());
+		const size_t slotCount = this->slots.size();
+		while ((this->memorySize > 0) && (this->memorySize + requiredMemorySize > budget))
 		{
-			FE_element_field_evaluation::deaccess(iter->second);
+			if (this->clockHand >= slotCount)
+				this->clockHand = 0;
+			Slot& slot = this->slots[this->clockHand];
+			if (slot.evaluation)
+			{
+				if (slot.referenced)
+					slot.referenced = false;
+				else
+					this->evictSlot(static_cast<int>(this->clockHand));
+			}
+			++this->clockHand;
 		}
-		this->element_field_evaluation_map.clear();
+	}
+
+	/** Add evaluation for element to cache. Takes over access to evaluation. */
+	void addEvaluation(cmzn_element *element, FE_element_field_evaluation *evaluation)
+	{
+		const size_t evaluationMemorySize = evaluation->getMemorySize();
+		this->evictToBudget(evaluationMemorySize);
+		int slotNumber;
+		if (this->freeSlots.empty())
+		{
+			slotNumber = static_cast<int>(this->slots.size());
+			this->slots.push_back(Slot());
+		}
+		else
+		{
+			slotNumber = this->freeSlots.back();
+			this->freeSlots.pop_back();
+		}
+		Slot& slot = this->slots[slotNumber];
+		slot.evaluation = evaluation;
+		slot.memorySize = evaluationMemorySize;
+		slot.elementIndex = element->getIndex();
+		slot.dimension = element->getDimension();
+		slot.referenced = true;
+		this->elementSlots[slot.dimension - 1][slot.elementIndex] = slotNumber;
+		this->memorySize += evaluationMemorySize;
+	}
+
+	/** @return  Slot number for element or -1 if none */
+	int findSlot(cmzn_element *element) const
+	{
+		const ElementSlotMap& dimensionSlots = this->elementSlots[element->getDimension() - 1];
+		ElementSlotMap::const_iterator iter = dimensionSlots.find(element->getIndex());
+		if (iter != dimensionSlots.end())
+			return iter->second;
+		return -1;
 	}
 
 public:
-	static FE_element_field_evaluation_cache *create()
+	static FE_element_field_evaluation_cache *create(FE_region *fe_region)
 	{
-		return new FE_element_field_evaluation_cache();
+		return new FE_element_field_evaluation_cache(fe_region);
 	}
 
 	FE_element_field_evaluation_cache *access()
@@ -119,7 +205,14 @@ public:
 
 	void clear()
 	{
-		this->clear_map();
+		for (std::vector<Slot>::iterator iter = this->slots.begin(); iter != this->slots.end(); ++iter)
+			FE_element_field_evaluation::deaccess(iter->evaluation);
+		this->slots.clear();
+		for (int d = 0; d < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++d)
+			this->elementSlots[d].clear();
+		this->freeSlots.clear();
+		this->memorySize = 0;
+		this->clockHand = 0;
 		// Following was a pointer to an object just destroyed, so must clear
 		this->element_field_evaluation = 0;
 	}
@@ -138,64 +231,49 @@ public:
 		FE_field *fe_field, cmzn_element *element, FE_value time,
 		cmzn_element *top_level_element)
 	{
-		//if (!(fe_field) || (!element))
-		//{
-		//	display_message(ERROR_MESSAGE,
-		//		"FE_element_field_evaluation_cache::get_element_field_evaluation.  Invalid arguments.");
-		//	return 0;
-		//}
 		// can't trust cached element field values if between manager begin/end change
 		// and this field has been modified.
 		const bool field_changed = FE_field_has_cached_changes(fe_field);
-		// ensure we have FE_element_field_evaluation calculated for element
-		// with derivatives_calculated if requested
-		if ((!this->element_field_evaluation) || field_changed || 
-			(!this->element_field_evaluation->is_for_element_and_time(element, time, top_level_element)))
+		if ((this->element_field_evaluation) && (!field_changed) &&
+			this->element_field_evaluation->is_for_element_and_time(element, time, top_level_element))
 		{
-			bool need_update = false;
-			bool add_to_cache = false;
-
-			FE_element_field_evaluation_map::iterator iter = this->element_field_evaluation_map.find(element);
-			if (iter == this->element_field_evaluation_map.end())
+			this->fe_region->recordElementEvaluationCacheHit();
+			return this->element_field_evaluation;
+		}
+		const int slotNumber = this->findSlot(element);
+		if (slotNumber >= 0)
+		{
+			Slot& slot = this->slots[slotNumber];
+			slot.referenced = true;
+			this->element_field_evaluation = slot.evaluation;
+			if ((!field_changed) && this->element_field_evaluation->is_for_element_and_time(element, time, top_level_element))
 			{
-				this->element_field_evaluation = FE_element_field_evaluation::create();
-				add_to_cache = true;
-				need_update = true;
+				this->fe_region->recordElementEvaluationCacheHit();
+				return this->element_field_evaluation;
 			}
-			else
+			this->fe_region->recordElementEvaluationCacheMiss();
+			this->element_field_evaluation->clear();
+			if (this->element_field_evaluation->calculate_values(fe_field, element, time, top_level_element))
 			{
-				this->element_field_evaluation = iter->second;
-				if (field_changed || (!this->element_field_evaluation->is_for_element_and_time(element, time, top_level_element)))
-				{
-					need_update = true;
-					this->element_field_evaluation->clear();
-				}
+				// values may have changed size
+				const size_t evaluationMemorySize = this->element_field_evaluation->getMemorySize();
+				this->memorySize += evaluationMemorySize;
+				this->memorySize -= slot.memorySize;
+				slot.memorySize = evaluationMemorySize;
 			}
-			if ((this->element_field_evaluation) && need_update)
+			else
 			{
-				if (this->element_field_evaluation->calculate_values(fe_field, element,
-					time, top_level_element))
-				{
-					if (add_to_cache)
-					{
-						// Set a cache size limit, clearing is a simple way to only cache for recent elements
-						if (1000 < this->element_field_evaluation_map.size())
-							this->clear_map();
-						this->element_field_evaluation_map[element] = this->element_field_evaluation;
-					}
-				}
-				else if (add_to_cache)
-				{
-					FE_element_field_evaluation::deaccess(this->element_field_evaluation);
-				}
-				else
-				{
-					// clear to ensure marked as not valid
-					this->element_field_evaluation->clear();
-					this->element_field_evaluation = 0;
-				}
+				this->evictSlot(slotNumber);
+				this->element_field_evaluation = 0;
 			}
+			return this->element_field_evaluation;
 		}
+		this->fe_region->recordElementEvaluationCacheMiss();
+		this->element_field_evaluation = FE_element_field_evaluation::create();
+		if (this->element_field_evaluation->calculate_values(fe_field, element, time, top_level_element))
+			this->addEvaluation(element, this->element_field_evaluation);
+		else
+			FE_element_field_evaluation::deaccess(this->element_field_evaluation);
 		return this->element_field_evaluation;
 	}
 
@@ -240,11 +318,13 @@ class FiniteElementRealFieldValueCache : public MultiTypeRealFieldValueCache
 public:
 	FE_element_field_evaluation_cache *element_field_evaluation_cache;
 
-	/** @param parentValueCache  Optional parentValueCache to get element_field_evaluation_cache from */
-	FiniteElementRealFieldValueCache(int componentCount, FiniteElementRealFieldValueCache *parentValueCache) :
+	/** @param fe_region  Region owning field, supplying evaluation cache budget.
+	 * @param parentValueCache  Optional parentValueCache to get element_field_evaluation_cache from */
+	FiniteElementRealFieldValueCache(int componentCount, FE_region *fe_region,
+			FiniteElementRealFieldValueCache *parentValueCache) :
 		MultiTypeRealFieldValueCache(componentCount),
 		element_field_evaluation_cache((parentValueCache) ? parentValueCache->element_field_evaluation_cache->access()
-			: FE_element_field_evaluation_cache::create())
+			: FE_element_field_evaluation_cache::create(fe_region))
 	{
 	}
 
@@ -276,11 +356,13 @@ class FiniteElementStringFieldValueCache : public StringFieldValueCache
 public:
 	FE_element_field_evaluation_cache *element_field_evaluation_cache;
 
-	/** @param parentValueCache  Optional parentValueCache to get element_field_evaluation_cache from */
-	FiniteElementStringFieldValueCache(FiniteElementStringFieldValueCache *parentValueCache) :
+	/** @param fe_region  Region owning field, supplying evaluation cache budget.
+	 * @param parentValueCache  Optional parentValueCache to get element_field_evaluation_cache from */
+	FiniteElementStringFieldValueCache(FE_region *fe_region,
+			FiniteElementStringFieldValueCache *parentValueCache) :
 		StringFieldValueCache(),
 		element_field_evaluation_cache((parentValueCache) ? parentValueCache->element_field_evaluation_cache->access()
-			: FE_element_field_evaluation_cache::create())
+			: FE_element_field_evaluation_cache::create(fe_region))
 	{
 	}
 
@@ -371,14 +453,16 @@ private:
 				return new MeshLocationFieldValueCache();
 			case STRING_VALUE:
 			case URL_VALUE:
-				return new FiniteElementStringFieldValueCache(static_cast<FiniteElementStringFieldValueCache *>(parentValueCache));
+				return new FiniteElementStringFieldValueCache(this->fe_field->get_FE_region(),
+					static_cast<FiniteElementStringFieldValueCache *>(parentValueCache));
 			default:
 				break;
 		}
 		// Future: have common finite element field cache in some circumstances
 		// note they must not be shared with time lookup fields as only a single time is cached
 		// and performance will be poor.
-		return new FiniteElementRealFieldValueCache(field->number_of_components, static_cast<FiniteElementRealFieldValueCache *>(parentValueCache));
+		return new FiniteElementRealFieldValueCache(field->number_of_components, this->fe_field->get_FE_region(),
+			static_cast<FiniteElementRealFieldValueCache *>(parentValueCache));
 	}
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
@@ -4579,3 +4663,67 @@ FE_element_field_evaluation *cmzn_field_get_cache_FE_element_field_evaluation(cm
 	const FE_value* xi = element_xi_location->get_xi();
 	return feValueCache->element_field_evaluation_cache->get_element_field_evaluation(core->fe_field, element, time, top_level_element);
 }
+
+namespace {
+
+/** Get element field evaluation for real general finite element field in
+ * element from fieldcache, creating if needed. Quietly fails for other fields.
+ * @return  Non-accessed evaluation or nullptr if none. */
+FE_element_field_evaluation *cmzn_field_get_real_FE_element_field_evaluation(
+	cmzn_field *field, cmzn_fieldcache *fieldcache, cmzn_element *element,
+	cmzn_element *topLevelElement)
+{
+	Computed_field_finite_element* core;
+	if (!((field) && (fieldcache) && (element)
+		&& (core = dynamic_cast<Computed_field_finite_element*>(field->core))
+		&& (core->fe_field->get_FE_field_type() == GENERAL_FE_FIELD)
+		&& (core->fe_field->getValueType() == FE_VALUE_VALUE)
+		&& FE_field_is_defined_in_element(core->fe_field, element)))
+		return nullptr;
+	FiniteElementRealFieldValueCache *feValueCache = FiniteElementRealFieldValueCache::cast(field->getValueCache(*fieldcache));
+	if (!feValueCache)
+		return nullptr;
+	return feValueCache->element_field_evaluation_cache->get_element_field_evaluation(
+		core->fe_field, element, fieldcache->getTime(), topLevelElement);
+}
+
+} // anonymous namespace
+
+bool cmzn_field_evaluate_real_grid(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, const int *numbersOfPoints,
+	const FE_value *const *gridXi, int meshDerivativeOrder, FE_value *values)
+{
+	FE_element_field_evaluation *element_field_evaluation =
+		cmzn_field_get_real_FE_element_field_evaluation(field, fieldcache, element, topLevelElement);
+	if (!element_field_evaluation)
+		return false;
+	Standard_basis_function_evaluation basis_function_evaluation;
+	return 0 != element_field_evaluation->evaluate_real_grid(numbersOfPoints, gridXi,
+		basis_function_evaluation, meshDerivativeOrder, values);
+}
+
+bool cmzn_field_evaluate_real_points(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, int numberOfPoints,
+	const FE_value *xi, int meshDerivativeOrder, FE_value *values)
+{
+	FE_element_field_evaluation *element_field_evaluation =
+		cmzn_field_get_real_FE_element_field_evaluation(field, fieldcache, element, topLevelElement);
+	if (!element_field_evaluation)
+		return false;
+	Standard_basis_function_evaluation basis_function_evaluation;
+	return 0 != element_field_evaluation->evaluate_real_points(/*component_number*/-1,
+		numberOfPoints, xi, basis_function_evaluation, meshDerivativeOrder, values);
+}
+
+bool cmzn_field_evaluate_real_table(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, int numberOfPoints,
+	const FE_value *xi, int meshDerivativeOrder, FE_value *values)
+{
+	FE_element_field_evaluation *element_field_evaluation =
+		cmzn_field_get_real_FE_element_field_evaluation(field, fieldcache, element, topLevelElement);
+	if (!element_field_evaluation)
+		return false;
+	Standard_basis_function_evaluation basis_function_evaluation;
+	return 0 != element_field_evaluation->evaluate_real_table(/*component_number*/-1,
+		numberOfPoints, xi, basis_function_evaluation, meshDerivativeOrder, values);
+}
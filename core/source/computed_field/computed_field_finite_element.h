@@ -194,4 +194,45 @@ class FE_element_field_evaluation;
  * @return  Pointer to object or nullptr if failed. */
 FE_element_field_evaluation *cmzn_field_get_cache_FE_element_field_evaluation(cmzn_field *field, cmzn_fieldcache *fieldcache);
 
+/** Evaluate a real finite element field and optionally its first derivatives
+ * w.r.t. xi at a tensor product grid of points in element at the time in
+ * fieldcache, using sum factorisation where possible.
+ * @see FE_element_field_evaluation::evaluate_real_grid
+ * @param topLevelElement  Optional element to inherit field from, or nullptr.
+ * @param numbersOfPoints  Number of points in each xi direction of element.
+ * @param gridXi  For each xi direction, array of numbersOfPoints[d] xi.
+ * @param meshDerivativeOrder  0 for values only, 1 to also get derivatives.
+ * @param values  Caller-supplied space for values at points, xi1 fastest.
+ * @return  True on success. False without error if field is not a real
+ * general finite element field defined on element, or on failure; callers
+ * should then evaluate at each point. */
+bool cmzn_field_evaluate_real_grid(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, const int *numbersOfPoints, const FE_value *const *gridXi,
+	int meshDerivativeOrder, FE_value *values);
+
+/** Evaluate a real finite element field and optionally its first derivatives
+ * w.r.t. xi at several points in element at the time in fieldcache, using
+ * vector instructions over blocks of points where possible.
+ * @see FE_element_field_evaluation::evaluate_real_points
+ * @param topLevelElement  Optional element to inherit field from, or nullptr.
+ * @param numberOfPoints  Number of points, at least 1.
+ * @param xi  Element dimension xi coordinates for each point in turn.
+ * @param meshDerivativeOrder  0 for values only, 1 to also get derivatives.
+ * @param values  Caller-supplied space for values at each point in turn.
+ * @return  True on success. False without error if field is not a real
+ * general finite element field defined on element, or on failure; callers
+ * should then evaluate at each point. */
+bool cmzn_field_evaluate_real_points(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, int numberOfPoints,
+	const FE_value *xi, int meshDerivativeOrder, FE_value *values);
+
+/** Evaluate a real finite element field and optionally its first derivatives
+ * w.r.t. xi at a fixed set of points in element at the time in fieldcache,
+ * using basis tables shared by all elements evaluated at the same points.
+ * @see FE_element_field_evaluation::evaluate_real_table
+ * Arguments and return value as for cmzn_field_evaluate_real_points. */
+bool cmzn_field_evaluate_real_table(cmzn_field *field, cmzn_fieldcache *fieldcache,
+	cmzn_element *element, cmzn_element *topLevelElement, int numberOfPoints,
+	const FE_value *xi, int meshDerivativeOrder, FE_value *values);
+
 #endif /* !defined (COMPUTED_FIELD_FINITE_ELEMENT_H) */
@@ -30,8 +30,12 @@
 #include "computed_field/computed_field_image.h"
 #include "computed_field/computed_field_find_xi.h"
 #include "computed_field/computed_field_finite_element.h"
+#include <climits>
 #include <math.h>
+#include <vector>
 #include "general/enumerator_conversion.hpp"
+#include "graphics/texture.hpp"
+#include "graphics/texture_brick_store.hpp"
 
 class Computed_field_image_package : public Computed_field_type_package
 {
@@ -53,7 +57,13 @@ public:
 	bool need_evaluate_texture;
 	/* for image from source: indicate if resolution tracks that of source, false if independent */
 	bool use_source_resolution;
-
+	/* memory budget for bricks of out-of-core texture, in megabytes */
+	int brick_cache_size;
+	/* mip level sampled with mipmap filter modes, added to any footprint level */
+	double level_of_detail;
+	/* if positive, distance between samples in texture coordinates from which
+	   the mip level is chosen automatically */
+	double sampling_footprint;
 
 	Computed_field_image(Texture *texture_in = NULL) :
 		Computed_field_core(),
@@ -62,7 +72,10 @@ public:
 		maximum(1.0),
 		number_of_bytes_per_component(1),
 		need_evaluate_texture(false),
-		use_source_resolution(false)
+		use_source_resolution(false),
+		brick_cache_size(256),
+		level_of_detail(0.0),
+		sampling_footprint(0.0)
 	{
 	}
 
@@ -124,6 +137,7 @@ public:
 			{
 				REACCESS(Texture)(&texture, texture_in);
 				field->number_of_components = new_number_of_components;
+				this->apply_brick_cache_size();
 				this->field->setChanged();
 				return_code = 1;
 			}
@@ -164,6 +178,65 @@ public:
 		return (1);
 	}
 
+	int get_brick_cache_size() const
+	{
+		return this->brick_cache_size;
+	}
+
+	int set_brick_cache_size(int brick_cache_size_in)
+	{
+		if (brick_cache_size_in < 1)
+			return CMZN_ERROR_ARGUMENT;
+		this->brick_cache_size = brick_cache_size_in;
+		this->apply_brick_cache_size();
+		return CMZN_OK;
+	}
+
+	double get_level_of_detail() const
+	{
+		return this->level_of_detail;
+	}
+
+	int set_level_of_detail(double level_of_detail_in)
+	{
+		if (!(level_of_detail_in >= 0.0))
+			return CMZN_ERROR_ARGUMENT;
+		if (level_of_detail_in != this->level_of_detail)
+		{
+			this->level_of_detail = level_of_detail_in;
+			this->field->setChanged();
+		}
+		return CMZN_OK;
+	}
+
+	double get_sampling_footprint() const
+	{
+		return this->sampling_footprint;
+	}
+
+	int set_sampling_footprint(double sampling_footprint_in)
+	{
+		if (!(sampling_footprint_in >= 0.0))
+			return CMZN_ERROR_ARGUMENT;
+		if (sampling_footprint_in != this->sampling_footprint)
+		{
+			this->sampling_footprint = sampling_footprint_in;
+			this->field->setChanged();
+		}
+		return CMZN_OK;
+	}
+
+	int evaluate_samples(int point_count, int coordinate_count,
+		const double *texture_coordinates, double *values);
+
+	// set memory budget of out-of-core texture, if any
+	void apply_brick_cache_size()
+	{
+		TextureBrickStore *brick_store = (this->texture) ? Texture_get_brick_store(this->texture) : 0;
+		if (brick_store)
+			brick_store->setMemoryBudget(static_cast<size_t>(this->brick_cache_size)*1024*1024);
+	}
+
 	// call when texture buffer resized to force rebuild from source field, if appropriate
 	void texture_buffer_changed()
 	{
@@ -258,6 +331,9 @@ Copy the type specific data used by this type.
 	Computed_field_image* core = new Computed_field_image(texture);
 	core->set_output_range(minimum, maximum);
 	core->set_number_of_bytes_per_component(number_of_bytes_per_component);
+	core->brick_cache_size = this->brick_cache_size;
+	core->level_of_detail = this->level_of_detail;
+	core->sampling_footprint = this->sampling_footprint;
 
 	return (core);
 } /* Computed_field_image::copy */
@@ -434,61 +510,80 @@ int Computed_field_image::evaluate_texture_from_source_field()
 	return (return_code);
 }
 
-int Computed_field_image::evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache)
+/**
+ * Evaluate image values at texture coordinates for each point, scaled to the
+ * output range, sampling at the level of detail of the field.
+ * @param values  Array to receive number_of_components values for each point.
+ * @return  1 on success, 0 on failure.
+ */
+int Computed_field_image::evaluate_samples(int point_count, int coordinate_count,
+	const double *texture_coordinates, double *values)
 {
 	check_evaluate_texture();
-	if (texture)
+	if (!this->texture)
+	{
+		display_message(ERROR_MESSAGE,
+			"Computed_field_image::evaluate_samples.  No texture");
+		return 0;
+	}
+	double lod = this->level_of_detail;
+	if (this->sampling_footprint > 0.0)
+		lod += Texture_get_footprint_level_of_detail(this->texture, this->sampling_footprint);
+	const int number_of_components = field->number_of_components;
+	const int texture_number_of_components = Texture_get_number_of_components(this->texture);
+	// sample directly into values unless texture has different number of components
+	std::vector<double> texture_values;
+	if (texture_number_of_components != number_of_components)
+		texture_values.resize(point_count*texture_number_of_components);
+	if (!Texture_evaluate_pixel_values(this->texture, point_count, coordinate_count,
+			texture_coordinates, lod, (texture_values.empty()) ? values : texture_values.data()))
+		return 0;
+	if (!texture_values.empty())
 	{
-		const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluate(cache));
-		if (sourceCache)
+		for (int p = 0; p < point_count; p++)
 		{
-			RealFieldValueCache &valueCache = RealFieldValueCache::cast(inValueCache);
-			double texture_values[4];
-			FE_value texture_coordinate[3];
-			texture_coordinate[0] = 0.0;
-			texture_coordinate[1] = 0.0;
-			texture_coordinate[2] = 0.0;
-			for (int i = 0; i < field->source_fields[0]->number_of_components; i++)
+			for (int i = 0; i < number_of_components; i++)
 			{
-				texture_coordinate[i] = sourceCache->values[i];
+				values[p*number_of_components + i] = (i < texture_number_of_components) ?
+					texture_values[p*texture_number_of_components + i] : 0.0;
 			}
-			Texture_get_pixel_values(texture,
-				texture_coordinate[0], texture_coordinate[1], texture_coordinate[2],
-				texture_values);
-			int number_of_components = field->number_of_components;
-			if (minimum == 0.0)
-			{
-				if (maximum == 1.0)
-				{
-					for (int i = 0 ; i < number_of_components ; i++)
-					{
-						valueCache.values[i] =  texture_values[i];
-					}
-				}
-				else
-				{
-					for (int i = 0 ; i < number_of_components ; i++)
-					{
-						valueCache.values[i] =  texture_values[i] * maximum;
-					}
-				}
-			}
-			else
+		}
+	}
+	if ((this->minimum != 0.0) || (this->maximum != 1.0))
+	{
+		const int values_count = point_count*number_of_components;
+		const double range = this->maximum - this->minimum;
+		for (int i = 0; i < values_count; i++)
+		{
+			values[i] = this->minimum + values[i]*range;
+		}
+	}
+	return 1;
+}
+
+int Computed_field_image::evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache)
+{
+	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluate(cache));
+	if (sourceCache)
+	{
+		RealFieldValueCache &valueCache = RealFieldValueCache::cast(inValueCache);
+		const int coordinate_count = (field->source_fields[0]->number_of_components < 3) ?
+			field->source_fields[0]->number_of_components : 3;
+		double texture_coordinates[3];
+		for (int i = 0; i < coordinate_count; i++)
+		{
+			texture_coordinates[i] = sourceCache->values[i];
+		}
+		double texture_values[4];
+		if (this->evaluate_samples(1, coordinate_count, texture_coordinates, texture_values))
+		{
+			for (int i = 0; i < field->number_of_components; i++)
 			{
-				for (int i = 0 ; i < number_of_components ; i++)
-				{
-					valueCache.values[i] =  minimum +
-						texture_values[i] * (maximum - minimum);
-				}
+				valueCache.values[i] = texture_values[i];
 			}
 			return 1;
 		}
 	}
-	else
-	{
-		display_message(ERROR_MESSAGE,
-			"Computed_field_image::evaluate.  No texture");
-	}
 	return 0;
 }
 
@@ -1113,6 +1208,97 @@ int Computed_field_is_image_type(struct Computed_field *field,
 	return (return_code);
 } /* Computed_field_has_string_value_type */
 
+struct Texture *Computed_field_image_get_pixel_centre_texture(struct Computed_field *field,
+	struct Computed_field *pixel_coordinate_field, int dimension, const int *sizes,
+	int number_of_components, double *minimum, double *maximum)
+{
+	Computed_field_image *image_core = (field) ?
+		dynamic_cast<Computed_field_image*>(field->core) : 0;
+	if (!((image_core) && (pixel_coordinate_field) && (0 < dimension) &&
+		(dimension <= 3) && (sizes) && (minimum) && (maximum) &&
+		(field->number_of_components == number_of_components) &&
+		(field->source_fields[0] == pixel_coordinate_field)))
+	{
+		return 0;
+	}
+	// forces evaluation from source fields if needed
+	Texture *texture = image_core->get_texture();
+	int texture_dimension = 0;
+	int size[3], original_size[3];
+	ZnReal physical_size[3];
+	if (!((texture) &&
+		Texture_get_dimension(texture, &texture_dimension) &&
+		(texture_dimension == dimension) &&
+		Texture_get_size(texture, &size[0], &size[1], &size[2]) &&
+		Texture_get_original_size(texture, &original_size[0], &original_size[1], &original_size[2]) &&
+		Texture_get_physical_size(texture, &physical_size[0], &physical_size[1], &physical_size[2]) &&
+		(Texture_get_number_of_components(texture) == number_of_components)))
+	{
+		return 0;
+	}
+	// pixel centres only map exactly to texels without padding or scaling
+	for (int i = 0; i < dimension; ++i)
+	{
+		if ((sizes[i] != size[i]) || (original_size[i] != size[i]) || (physical_size[i] != 1.0))
+		{
+			return 0;
+		}
+	}
+	*minimum = image_core->minimum;
+	*maximum = image_core->maximum;
+	return texture;
+}
+
+int Computed_field_image_get_pixel_centre_values(struct Computed_field *field,
+	struct Computed_field *pixel_coordinate_field, int dimension, const int *sizes,
+	int number_of_components, ZnReal *values)
+{
+	double minimum, maximum;
+	Texture *texture = Computed_field_image_get_pixel_centre_texture(field,
+		pixel_coordinate_field, dimension, sizes, number_of_components, &minimum, &maximum);
+	if (!((texture) && (values)))
+	{
+		return 0;
+	}
+	return Texture_get_original_texel_values(texture, minimum, maximum, values);
+}
+
+int Computed_field_image_get_texture_coordinates_range(struct Computed_field *field,
+	int coordinate_count, const double *minimum_coordinates,
+	const double *maximum_coordinates, double *minimum_values, double *maximum_values)
+{
+	Computed_field_image *image_core = (field) ?
+		dynamic_cast<Computed_field_image*>(field->core) : 0;
+	if (!((image_core) && (minimum_values) && (maximum_values)))
+	{
+		return 0;
+	}
+	Texture *texture = image_core->get_texture();
+	if (!texture)
+	{
+		return 0;
+	}
+	const int texture_number_of_components = Texture_get_number_of_components(texture);
+	double texture_minimums[4], texture_maximums[4];
+	if (!Texture_get_coordinates_value_range(texture, coordinate_count,
+		minimum_coordinates, maximum_coordinates, texture_minimums, texture_maximums))
+	{
+		return 0;
+	}
+	// scale to output range as in evaluate_samples; a reversed range swaps bounds
+	const double range = image_core->maximum - image_core->minimum;
+	for (int i = 0; i < field->number_of_components; ++i)
+	{
+		const double texture_minimum = (i < texture_number_of_components) ? texture_minimums[i] : 0.0;
+		const double texture_maximum = (i < texture_number_of_components) ? texture_maximums[i] : 0.0;
+		const double value1 = image_core->minimum + texture_minimum*range;
+		const double value2 = image_core->minimum + texture_maximum*range;
+		minimum_values[i] = (value1 < value2) ? value1 : value2;
+		maximum_values[i] = (value1 < value2) ? value2 : value1;
+	}
+	return 1;
+}
+
 int cmzn_field_image_set_texture(cmzn_field_image_id image_field,
 		struct Texture *texture)
 {
@@ -2129,3 +2315,97 @@ int cmzn_field_image_set_buffer(cmzn_field_image_id image_field, const void *buf
 	return CMZN_RESULT_ERROR_ARGUMENT;
 }
 
+bool cmzn_field_image_is_bricked(cmzn_field_image_id image_field)
+{
+	if (image_field)
+	{
+		cmzn_texture *texture = cmzn_field_image_get_texture(image_field);
+		if (texture)
+			return (0 != Texture_get_brick_store(texture));
+	}
+	return false;
+}
+
+int cmzn_field_image_get_brick_cache_size(cmzn_field_image_id image_field)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->get_brick_cache_size();
+	return 0;
+}
+
+int cmzn_field_image_set_brick_cache_size(cmzn_field_image_id image_field,
+	int megabytes)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->set_brick_cache_size(megabytes);
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_field_image_get_brick_cache_statistics(cmzn_field_image_id image_field,
+	int *hits_out, int *misses_out, int *evictions_out)
+{
+	cmzn_texture *texture = (image_field) ? cmzn_field_image_get_texture(image_field) : 0;
+	TextureBrickStore *brick_store = (texture) ? Texture_get_brick_store(texture) : 0;
+	if ((brick_store) && (hits_out) && (misses_out) && (evictions_out))
+	{
+		const unsigned long maximumInt = static_cast<unsigned long>(INT_MAX);
+		const unsigned long hits = brick_store->getHitCount();
+		const unsigned long misses = brick_store->getMissCount();
+		const unsigned long evictions = brick_store->getEvictionCount();
+		*hits_out = static_cast<int>((hits < maximumInt) ? hits : maximumInt);
+		*misses_out = static_cast<int>((misses < maximumInt) ? misses : maximumInt);
+		*evictions_out = static_cast<int>((evictions < maximumInt) ? evictions : maximumInt);
+		return CMZN_OK;
+	}
+	display_message(ERROR_MESSAGE, "cmzn_field_image_get_brick_cache_statistics.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
+
+
+double cmzn_field_image_get_level_of_detail(cmzn_field_image_id image_field)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->get_level_of_detail();
+	return 0.0;
+}
+
+int cmzn_field_image_set_level_of_detail(cmzn_field_image_id image_field,
+	double level_of_detail)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->set_level_of_detail(level_of_detail);
+	return CMZN_ERROR_ARGUMENT;
+}
+
+double cmzn_field_image_get_sampling_footprint(cmzn_field_image_id image_field)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->get_sampling_footprint();
+	return 0.0;
+}
+
+int cmzn_field_image_set_sampling_footprint(cmzn_field_image_id image_field,
+	double footprint)
+{
+	if (image_field)
+		return Computed_field_image_core_cast(image_field)->set_sampling_footprint(footprint);
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_field_image_evaluate_samples(cmzn_field_image_id image_field,
+	int point_count, int coordinate_count, const double *texture_coordinates,
+	int values_count, double *values_out)
+{
+	if (image_field && (0 <= point_count) && (1 <= coordinate_count) && (coordinate_count <= 3) &&
+		((0 == point_count) || (texture_coordinates && values_out)) &&
+		(values_count >= point_count*cmzn_field_get_number_of_components(
+			cmzn_field_image_base_cast(image_field))))
+	{
+		if (Computed_field_image_core_cast(image_field)->evaluate_samples(
+				point_count, coordinate_count, texture_coordinates, values_out))
+			return CMZN_OK;
+		return CMZN_ERROR_GENERAL;
+	}
+	display_message(ERROR_MESSAGE, "cmzn_field_image_evaluate_samples.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
@@ -47,6 +47,51 @@ texture fields which reference <texture>.
 int Computed_field_is_image_type(struct Computed_field *field,
 	void *dummy_void);
 
+/**
+ * Gets the values of image field at all pixel centres in one pass from its
+ * texture, without evaluating each pixel. Only possible if the field's texture
+ * coordinate field is pixel_coordinate_field, which is to be set to pixel centre
+ * locations (i + 0.5)/sizes[i], and the texture's texels are exactly the image
+ * pixels with unit physical size.
+ *
+ * @param pixel_coordinate_field  Field set to pixel centre locations.
+ * @param sizes  Number of pixels in each of dimension directions.
+ * @param values  Array to receive values for all pixels, x varying fastest
+ * and components interleaved.
+ * @return  1 if values obtained, otherwise 0 in which case caller must
+ * evaluate the field at each pixel.
+ */
+/**
+ * Gets the texture of image field if its pixel centres map exactly to texels,
+ * under the same conditions as Computed_field_image_get_pixel_centre_values.
+ * Callers may then read texels directly and use the texture's range tree.
+ *
+ * @param minimum, maximum  Addresses to receive the output range of the image
+ * field, to which texel values are scaled.
+ * @return  Non-accessed texture, or 0 if field values must be evaluated at
+ * each pixel.
+ */
+struct Texture *Computed_field_image_get_pixel_centre_texture(struct Computed_field *field,
+	struct Computed_field *pixel_coordinate_field, int dimension, const int *sizes,
+	int number_of_components, double *minimum, double *maximum);
+
+int Computed_field_image_get_pixel_centre_values(struct Computed_field *field,
+	struct Computed_field *pixel_coordinate_field, int dimension, const int *sizes,
+	int number_of_components, ZnReal *values);
+
+/**
+ * Gets a conservative range of each component of image field for texture
+ * coordinates anywhere within a box, from the min/max octree of its texture.
+ * Values evaluated in the box are guaranteed to be within the range.
+ *
+ * @param minimum_values, maximum_values  Arrays to receive range of each
+ * component of the field.
+ * @return  1 if range found, 0 if field is not an image field or has no image.
+ */
+int Computed_field_image_get_texture_coordinates_range(struct Computed_field *field,
+	int coordinate_count, const double *minimum_coordinates,
+	const double *maximum_coordinates, double *minimum_values, double *maximum_values);
+
 int cmzn_field_image_set_texture(cmzn_field_image_id image_field,
 		struct Texture *texture);
 
@@ -9,6 +9,7 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <cmath>
+#include <vector>
 #include "opencmiss/zinc/fieldmatrixoperators.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_matrix_operators.hpp"
@@ -127,10 +128,7 @@ private:
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
 
-	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
-	{
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	}
+	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative);
 
 	int list();
 
@@ -167,6 +165,57 @@ int Computed_field_determinant::evaluate(cmzn_fieldcache& cache, FieldValueCache
 	return 0;
 }
 
+int Computed_field_determinant::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() > 1)
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	const RealFieldValueCache *sourceCache = getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative);
+	if (!sourceCache)
+		return 0;
+	const FE_value *a = sourceCache->values;
+	const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
+	DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+	FE_value *derivatives = derivativeCache->values;
+	const int termCount = derivativeCache->getTermCount();
+	// d(det A)/dx = sum of cofactor(A)_ij * dA_ij/dx
+	FE_value cofactors[9];
+	const int sourceComponentCount = getSourceField(0)->number_of_components;
+	switch (sourceComponentCount)
+	{
+	case 1:
+		cofactors[0] = 1.0;
+		break;
+	case 4:
+		cofactors[0] = a[3];
+		cofactors[1] = -a[2];
+		cofactors[2] = -a[1];
+		cofactors[3] = a[0];
+		break;
+	case 9:
+		cofactors[0] = a[4]*a[8] - a[5]*a[7];
+		cofactors[1] = a[5]*a[6] - a[3]*a[8];
+		cofactors[2] = a[3]*a[7] - a[4]*a[6];
+		cofactors[3] = a[2]*a[7] - a[1]*a[8];
+		cofactors[4] = a[0]*a[8] - a[2]*a[6];
+		cofactors[5] = a[1]*a[6] - a[0]*a[7];
+		cofactors[6] = a[1]*a[5] - a[2]*a[4];
+		cofactors[7] = a[2]*a[3] - a[0]*a[5];
+		cofactors[8] = a[0]*a[4] - a[1]*a[3];
+		break;
+	default:
+		return 0;
+		break;
+	}
+	for (int j = 0; j < termCount; ++j)
+	{
+		FE_value sum = 0.0;
+		for (int i = 0; i < sourceComponentCount; ++i)
+			sum += cofactors[i]*sourceDerivatives[i*termCount + j];
+		derivatives[j] = sum;
+	}
+	return 1;
+}
+
 int Computed_field_determinant::list()
 {
 	int return_code = 0;
@@ -300,10 +349,7 @@ private:
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
 
-	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
-	{
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	}
+	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative);
 
 	int list();
 
@@ -342,6 +388,37 @@ int Computed_field_eigenvalues::evaluate(cmzn_fieldcache& cache, FieldValueCache
 	return 0;
 }
 
+/** Derivatives of eigenvalues of symmetric matrix: d(lambda_k)/dx = v_k^T dA/dx v_k
+ * for eigenvectors v in columns */
+int Computed_field_eigenvalues::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() > 1)
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	const EigenvalueFieldValueCache *eigenvalueCache = EigenvalueFieldValueCache::cast(this->field->evaluate(cache));
+	const DerivativeValueCache *sourceDerivativeCache = getSourceField(0)->evaluateDerivative(cache, fieldDerivative);
+	if (!((eigenvalueCache) && (sourceDerivativeCache)))
+		return 0;
+	const int n = this->field->number_of_components;
+	const double *v = eigenvalueCache->v;
+	const FE_value *sourceDerivatives = sourceDerivativeCache->values;
+	DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+	FE_value *derivatives = derivativeCache->values;
+	const int termCount = derivativeCache->getTermCount();
+	for (int k = 0; k < n; ++k)
+	{
+		for (int t = 0; t < termCount; ++t)
+		{
+			FE_value sum = 0.0;
+			for (int i = 0; i < n; ++i)
+				for (int j = 0; j < n; ++j)
+					sum += v[i*n + k]*sourceDerivatives[(i*n + j)*termCount + t]*v[j*n + k];
+			derivatives[t] = sum;
+		}
+		derivatives += termCount;
+	}
+	return 1;
+}
+
 int Computed_field_eigenvalues::list()
 /*******************************************************************************
 LAST MODIFIED : 25 August 2006
@@ -566,10 +643,7 @@ private:
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
 
-	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
-	{
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	}
+	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative);
 
 	int list();
 
@@ -597,6 +671,58 @@ int Computed_field_eigenvectors::evaluate(cmzn_fieldcache& cache, FieldValueCach
 	return 0;
 }
 
+/** Derivatives of eigenvectors of symmetric matrix with distinct eigenvalues:
+ * d(v_k)/dx = sum over m != k of (v_m^T dA/dx v_k)/(lambda_k - lambda_m) v_m.
+ * Falls back to finite differences for repeated eigenvalues. */
+int Computed_field_eigenvectors::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() > 1)
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	cmzn_field *eigenvaluesField = getSourceField(0);
+	const EigenvalueFieldValueCache *eigenvalueCache = EigenvalueFieldValueCache::cast(eigenvaluesField->evaluate(cache));
+	if (!eigenvalueCache)
+		return 0;
+	const int n = eigenvaluesField->number_of_components;
+	const double *v = eigenvalueCache->v;
+	const FE_value *lambda = eigenvalueCache->values;
+	FE_value lambdaScale = 0.0;
+	for (int k = 0; k < n; ++k)
+		if (fabs(lambda[k]) > lambdaScale)
+			lambdaScale = fabs(lambda[k]);
+	for (int k = 1; k < n; ++k)
+		if (fabs(lambda[k - 1] - lambda[k]) <= 1.0E-10*lambdaScale)
+			return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	const DerivativeValueCache *sourceDerivativeCache = eigenvaluesField->source_fields[0]->evaluateDerivative(cache, fieldDerivative);
+	if (!sourceDerivativeCache)
+		return 0;
+	const FE_value *sourceDerivatives = sourceDerivativeCache->values;
+	DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+	derivativeCache->zeroValues();
+	FE_value *derivatives = derivativeCache->values;
+	const int termCount = derivativeCache->getTermCount();
+	for (int k = 0; k < n; ++k)
+	{
+		for (int m = 0; m < n; ++m)
+		{
+			if (m == k)
+				continue;
+			const FE_value scale = 1.0/(lambda[k] - lambda[m]);
+			for (int t = 0; t < termCount; ++t)
+			{
+				FE_value sum = 0.0;
+				for (int i = 0; i < n; ++i)
+					for (int j = 0; j < n; ++j)
+						sum += v[i*n + m]*sourceDerivatives[(i*n + j)*termCount + t]*v[j*n + k];
+				sum *= scale;
+				// vectors are across the rows of the field values
+				for (int i = 0; i < n; ++i)
+					derivatives[(k*n + i)*termCount + t] += sum*v[i*n + m];
+			}
+		}
+	}
+	return 1;
+}
+
 int Computed_field_eigenvectors::list()
 /*******************************************************************************
 LAST MODIFIED : 25 August 2006
@@ -796,10 +922,7 @@ private:
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
 
-	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
-	{
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	}
+	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative);
 
 	int list();
 
@@ -857,6 +980,45 @@ int Computed_field_matrix_invert::evaluate(cmzn_fieldcache& cache, FieldValueCac
 	return 0;
 }
 
+/** d(A^-1)/dx = -A^-1 dA/dx A^-1 */
+int Computed_field_matrix_invert::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() > 1)
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	const RealFieldValueCache *inverseCache = RealFieldValueCache::cast(this->field->evaluate(cache));
+	const DerivativeValueCache *sourceDerivativeCache = getSourceField(0)->evaluateDerivative(cache, fieldDerivative);
+	if (!((inverseCache) && (sourceDerivativeCache)))
+		return 0;
+	const int n = Computed_field_get_square_matrix_size(getSourceField(0));
+	const FE_value *b = inverseCache->values;
+	const FE_value *sourceDerivatives = sourceDerivativeCache->values;
+	DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+	FE_value *derivatives = derivativeCache->values;
+	const int termCount = derivativeCache->getTermCount();
+	std::vector<FE_value> c(n*n);
+	for (int t = 0; t < termCount; ++t)
+	{
+		// c = dA/dx A^-1, then derivative = -A^-1 c
+		for (int i = 0; i < n; ++i)
+			for (int j = 0; j < n; ++j)
+			{
+				FE_value sum = 0.0;
+				for (int k = 0; k < n; ++k)
+					sum += sourceDerivatives[(i*n + k)*termCount + t]*b[k*n + j];
+				c[i*n + j] = sum;
+			}
+		for (int i = 0; i < n; ++i)
+			for (int j = 0; j < n; ++j)
+			{
+				FE_value sum = 0.0;
+				for (int k = 0; k < n; ++k)
+					sum += b[i*n + k]*c[k*n + j];
+				derivatives[(i*n + j)*termCount + t] = -sum;
+			}
+	}
+	return 1;
+}
+
 int Computed_field_matrix_invert::list()
 /*******************************************************************************
 LAST MODIFIED : 25 August 2006
@@ -10,6 +10,7 @@
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <cmath>
 #include <iostream>
+#include "computed_field/computed_field_finite_element.h"
 #include "computed_field/computed_field_private.hpp"
 #include "computed_field/computed_field_mesh_operators.hpp"
 #include "computed_field/field_module.hpp"
@@ -220,7 +221,7 @@ template <class ProcessTerm> int Computed_field_mesh_integral::evaluateTerms(Pro
 			IntegrationShapePoints *shapePoints = integrationCache.getPoints(element);
 			if (0 == shapePoints)
 				return 0;
-			processTerm.setElement(element);
+			processTerm.setElement(element, *shapePoints);
 			shapePoints->forEachPoint(processTerm);
 		}
 		return 1;
@@ -236,7 +237,7 @@ template <class ProcessTerm> int Computed_field_mesh_integral::evaluateTerms(Pro
 			result = 0;
 			break;
 		}
-		processTerm.setElement(element);
+		processTerm.setElement(element, *shapePoints);
 		shapePoints->forEachPoint(processTerm);
 	}
 	cmzn_elementiterator_destroy(&iterator);
@@ -256,6 +257,11 @@ protected:
 	const FieldDerivative& fieldDerivativeMesh;
 	cmzn_element *element;
 	unsigned int point_index;  // point index within element
+	// coordinates with derivatives and dL/dA/dV at all points in element if
+	// evaluated together on a grid or with basis tables
+	std::vector<FE_value> gridCoordinateValues;
+	std::vector<FE_value> gridDLAV;
+	bool useGridDLAV;
 
 public:
 	IntegralTermBase(Computed_field_mesh_integral& meshIntegralIn, cmzn_fieldcache& parentCache, MeshIntegralRealFieldValueCache& valueCache) :
@@ -268,27 +274,51 @@ public:
 		coordinatesCount(coordinateField->number_of_components),
 		fieldDerivativeMesh(*cmzn_mesh_get_FE_mesh_internal(meshIntegral.getMesh())->getFieldDerivative(/*order*/1)),
 		element(0),
-		point_index(0)
+		point_index(0),
+		useGridDLAV(false)
 	{
 		cache.setTime(parentCache.getTime());
 	}
 
-	void setElement(cmzn_element *elementIn)
+	/** Set element to integrate over next. If the coordinate field is directly
+	 * a finite element field, dL/dA/dV is calculated at all points together:
+	 * by sum factorisation if points are a tensor product grid, otherwise with
+	 * basis tables shared by all elements using the same points. */
+	void setElement(cmzn_element *elementIn, IntegrationShapePoints& shapePoints)
 	{
 		this->element = elementIn;
 		this->point_index = 0;
+		this->useGridDLAV = false;
+		const int numPoints = shapePoints.getNumPoints();
+		const int valuesPerPoint = this->coordinatesCount*(1 + this->dimension);
+		this->gridCoordinateValues.resize(numPoints*valuesPerPoint);
+		if (shapePoints.isGrid())
+		{
+			const FE_value *gridXi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+			for (int i = 0; i < this->dimension; ++i)
+				gridXi[i] = shapePoints.getGridXi(i);
+			if (!cmzn_field_evaluate_real_grid(this->coordinateField, &this->cache, this->element,
+					/*topLevelElement*/nullptr, shapePoints.getNumbersOfPoints(), gridXi, /*meshDerivativeOrder*/1, this->gridCoordinateValues.data()))
+				return;
+		}
+		else
+		{
+			const FE_value *points = shapePoints.getPoints();
+			if ((!points) || (numPoints < 1) || (!cmzn_field_evaluate_real_table(this->coordinateField, &this->cache, this->element,
+					/*topLevelElement*/nullptr, numPoints, points, /*meshDerivativeOrder*/1, this->gridCoordinateValues.data())))
+				return;
+		}
+		this->gridDLAV.resize(numPoints);
+		for (int p = 0; p < numPoints; ++p)
+			if (!this->calculateDLAV(this->gridCoordinateValues.data() + p*valuesPerPoint + this->coordinatesCount, this->gridDLAV[p]))
+				return;
+		this->useGridDLAV = true;
 	}
 
-	/** @return  true on success, with valid value of dL/dA/dV in dLAV, otherwise false */
-	inline bool evaluateDLAV(FE_value *xi, FE_value &dLAV)
+	/** Calculate dL/dA/dV from coordinate derivatives dx_dxi which cycle over xi fastest.
+	 * @return  true on success, otherwise false */
+	inline bool calculateDLAV(const FE_value *dx_dxi, FE_value &dLAV) const
 	{
-		this->cache.setIndexedMeshLocation(this->point_index, this->element, xi);
-		(this->point_index)++;
-		const DerivativeValueCache *coordinateDerivativeCache = coordinateField->evaluateDerivative(cache, this->fieldDerivativeMesh);
-		if (!coordinateDerivativeCache)
-			return false;
-		// note dx_dxi cycles over xi fastest
-		const FE_value *dx_dxi = coordinateDerivativeCache->values;
 		dLAV = 0.0; // dL (1-D), dA (2-D), dV (3-D)
 		if (this->dimension == 3)
 		{
@@ -322,6 +352,24 @@ public:
 		return false;
 	}
 
+	/** @return  true on success, with valid value of dL/dA/dV in dLAV, otherwise false */
+	inline bool evaluateDLAV(FE_value *xi, FE_value &dLAV)
+	{
+		this->cache.setIndexedMeshLocation(this->point_index, this->element, xi);
+		if (this->useGridDLAV)
+		{
+			dLAV = this->gridDLAV[this->point_index];
+			(this->point_index)++;
+			return true;
+		}
+		(this->point_index)++;
+		const DerivativeValueCache *coordinateDerivativeCache = coordinateField->evaluateDerivative(cache, this->fieldDerivativeMesh);
+		if (!coordinateDerivativeCache)
+			return false;
+		// note dx_dxi cycles over xi fastest
+		return this->calculateDLAV(coordinateDerivativeCache->values, dLAV);
+	}
+
 	/** @return  Pointer to integrand value cache, or nullptr if failed (e.g. integrand or coordiantes not defined) */
 	inline const RealFieldValueCache *evaluateIntegrandDLAV(FE_value *xi, FE_value &dLAV)
 	{
@@ -271,6 +271,20 @@ public:
 	 * @param fieldDerivative  The field derivative operator. */
 	int evaluateDerivativeFiniteDifference(cmzn_fieldcache& cache, RealFieldValueCache& valueCache, const FieldDerivative& fieldDerivative);
 
+	/** Function returning first and second derivatives of a scalar function
+	 * f(u) w.r.t. its argument. */
+	typedef void (*ComponentFunctionDerivatives)(FE_value u, FE_value& df_du, FE_value& d2f_du2);
+
+	/** Evaluate derivatives of a field whose components are each the same
+	 * function f of the corresponding component u of source field 0 by the
+	 * chain rule. Implemented analytically for first derivatives and second
+	 * derivatives not mixing mesh and parameters:
+	 * d2f/dxdy = f''(u) du/dx du/dy + f'(u) d2u/dxdy.
+	 * Other derivatives are evaluated by finite differences.
+	 * @param componentFunctionDerivatives  Function giving f'(u) and f''(u). */
+	int evaluateDerivativeComponentFunction(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache,
+		const FieldDerivative& fieldDerivative, ComponentFunctionDerivatives componentFunctionDerivatives);
+
 	/** Get the highest order of derivatives with non-zero terms for the
 	 * derivative tree evaluated for fieldDerivative. For example, returns
 	 * zero for a constant field, 1 if the field only has the first derivative
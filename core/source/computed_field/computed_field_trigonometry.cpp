@@ -80,30 +80,16 @@ int Computed_field_sin::evaluate(cmzn_fieldcache& cache, FieldValueCache& inValu
 	return 0;
 }
 
+// d(sin u)/du = cos u, d2(sin u)/du2 = -sin u
+void sin_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
+{
+	df_du = cos(u);
+	d2f_du2 = -sin(u);
+}
+
 int Computed_field_sin::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
-	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0 ; i < componentCount; ++i)
-		{
-			// d(sin u)/dx = cos u * du/dx
-			const FE_value cos_u = cos(sourceCache->values[i]);
-			for (int j = 0 ; j < termCount; ++j)
-				derivatives[j] = cos_u * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
-	}
-	return 0;
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, sin_derivatives);
 }
 
 int Computed_field_sin::list()
@@ -273,30 +259,16 @@ int Computed_field_cos::evaluate(cmzn_fieldcache& cache, FieldValueCache& inValu
 	return 0;
 }
 
+// d(cos u)/du = -sin u, d2(cos u)/du2 = -cos u
+void cos_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
+{
+	df_du = -sin(u);
+	d2f_du2 = -cos(u);
+}
+
 int Computed_field_cos::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
-	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0; i < componentCount; ++i)
-		{
-			// d(cos u)/dx = -sin u * du/dx
-			const FE_value _sin_u = -sin(sourceCache->values[i]);
-			for (int j = 0; j < termCount; ++j)
-				derivatives[j] = _sin_u * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
-	}
-	return 0;
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, cos_derivatives);
 }
 
 int Computed_field_cos::list()
@@ -466,31 +438,18 @@ int Computed_field_tan::evaluate(cmzn_fieldcache& cache, FieldValueCache& inValu
 	return 0;
 }
 
+// d(tan u)/du = sec^2 u, d2(tan u)/du2 = 2 tan u sec^2 u
+void tan_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
+{
+	const FE_value cos_u = cos(u);
+	const FE_value sec2_u = 1.0 / (cos_u*cos_u);
+	df_du = sec2_u;
+	d2f_du2 = 2.0*tan(u)*sec2_u;
+}
+
 int Computed_field_tan::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
-	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0; i < componentCount; ++i)
-		{
-			// d(tan u)/dx = sec^2 u * du/dx
-			const FE_value cos_u = cos(sourceCache->values[i]);
-			const FE_value sec2_u = 1.0 / (cos_u*cos_u);
-			for (int j = 0; j < termCount; ++j)
-				derivatives[j] = sec2_u * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
-	}
-	return 0;
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, tan_derivatives);
 }
 int Computed_field_tan::list()
 /*******************************************************************************
@@ -659,32 +618,26 @@ int Computed_field_asin::evaluate(cmzn_fieldcache& cache, FieldValueCache& inVal
 	return 0;
 }
 
-int Computed_field_asin::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+// d(asin u)/du = 1/sqrt(1 - u^2), d2(asin u)/du2 = u/(1 - u^2)^(3/2)
+// avoid division by zero - make derivatives zero there
+void asin_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
+	const FE_value one_u2 = 1.0 - u*u;
+	if (one_u2 > 0.0)
 	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0; i < componentCount; ++i)
-		{
-			// d(asin u)/dx = 1.0/sqrt(1.0 - u^2) * du/dx
-			// avoid division by zero - make derivative zero there
-			const FE_value u = sourceCache->values[i];
-			const FE_value one__sqrt_1_u2 = (u != 1.0) ? 1.0/sqrt(1.0 - u*u) : 0.0;
-			for (int j = 0; j < termCount; ++j)
-				derivatives[j] = one__sqrt_1_u2 * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
+		df_du = 1.0/sqrt(one_u2);
+		d2f_du2 = u*df_du/one_u2;
 	}
-	return 0;
+	else
+	{
+		df_du = 0.0;
+		d2f_du2 = 0.0;
+	}
+}
+
+int Computed_field_asin::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, asin_derivatives);
 }
 
 int Computed_field_asin::list()
@@ -854,32 +807,26 @@ int Computed_field_acos::evaluate(cmzn_fieldcache& cache, FieldValueCache& inVal
 	return 0;
 }
 
-int Computed_field_acos::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+// d(acos u)/du = -1/sqrt(1 - u^2), d2(acos u)/du2 = -u/(1 - u^2)^(3/2)
+// avoid division by zero - make derivatives zero there
+void acos_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
+	const FE_value one_u2 = 1.0 - u*u;
+	if (one_u2 > 0.0)
 	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0; i < componentCount; ++i)
-		{
-			// d(acos u)/dx = -1.0/sqrt(1.0 - u^2) * du/dx
-			// avoid division by zero - make derivative zero there
-			const FE_value u = sourceCache->values[i];
-			const FE_value _one__sqrt_1_u2 = (u != 1.0) ? -1.0/sqrt(1.0 - u*u) : 0.0;
-			for (int j = 0; j < termCount; ++j)
-				derivatives[j] = _one__sqrt_1_u2 * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
+		df_du = -1.0/sqrt(one_u2);
+		d2f_du2 = u*df_du/one_u2;
+	}
+	else
+	{
+		df_du = 0.0;
+		d2f_du2 = 0.0;
 	}
-	return 0;
+}
+
+int Computed_field_acos::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, acos_derivatives);
 }
 
 int Computed_field_acos::list()
@@ -1049,31 +996,17 @@ int Computed_field_atan::evaluate(cmzn_fieldcache& cache, FieldValueCache& inVal
 	return 0;
 }
 
+// d(atan u)/du = 1/(1 + u^2), d2(atan u)/du2 = -2u/(1 + u^2)^2
+void atan_derivatives(FE_value u, FE_value& df_du, FE_value& d2f_du2)
+{
+	const FE_value one__1_u2 = 1.0/(1.0 + u*u);
+	df_du = one__1_u2;
+	d2f_du2 = -2.0*u*one__1_u2*one__1_u2;
+}
+
 int Computed_field_atan::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
 {
-	if (fieldDerivative.getTotalOrder() > 1)
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
-	if (sourceCache)
-	{
-		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
-		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
-		FE_value *derivatives = derivativeCache->values;
-		const int componentCount = this->field->number_of_components;
-		const int termCount = derivativeCache->getTermCount();
-		for (int i = 0; i < componentCount; ++i)
-		{
-			// d(atan u)/dx = 1.0/(1.0 + u^2) * du/dx
-			const FE_value u = sourceCache->values[i];
-			const FE_value one__1_u2 = 1.0/(1.0 + u*u);
-			for (int j = 0; j < termCount; ++j)
-				derivatives[j] = one__1_u2 * sourceDerivatives[j];
-			derivatives += termCount;
-			sourceDerivatives += termCount;
-		}
-		return 1;
-	}
-	return 0;
+	return this->evaluateDerivativeComponentFunction(cache, inValueCache, fieldDerivative, atan_derivatives);
 }
 
 int Computed_field_atan::list()
@@ -64,10 +64,7 @@ private:
 
 	virtual int evaluate(cmzn_fieldcache& cache, FieldValueCache& inValueCache);
 
-	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
-	{
-		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
-	}
+	virtual int evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative);
 
 	int list();
 
@@ -94,6 +91,44 @@ int Computed_field_normalise::evaluate(cmzn_fieldcache& cache, FieldValueCache&
 	return 0;
 }
 
+int Computed_field_normalise::evaluateDerivative(cmzn_fieldcache& cache, RealFieldValueCache& inValueCache, const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() > 1)
+		return this->evaluateDerivativeFiniteDifference(cache, inValueCache, fieldDerivative);
+	const RealFieldValueCache *sourceCache = RealFieldValueCache::cast(getSourceField(0)->evaluateDerivativeTree(cache, fieldDerivative));
+	if (sourceCache)
+	{
+		const FE_value *sourceValues = sourceCache->values;
+		const FE_value *sourceDerivatives = sourceCache->getDerivativeValueCache(fieldDerivative)->values;
+		DerivativeValueCache *derivativeCache = inValueCache.getDerivativeValueCache(fieldDerivative);
+		FE_value *derivatives = derivativeCache->values;
+		const int componentCount = this->field->number_of_components;
+		const int termCount = derivativeCache->getTermCount();
+		FE_value size = 0.0;
+		for (int i = 0; i < componentCount; ++i)
+			size += sourceValues[i] * sourceValues[i];
+		if (size <= 0.0)
+		{
+			// consistent with zero value where source is zero
+			derivativeCache->zeroValues();
+			return 1;
+		}
+		// d(u/|u|)/dx = (du/dx - n (n . du/dx)) / |u|, where n = u/|u|
+		const FE_value one__mag = 1.0 / sqrt(size);
+		for (int j = 0; j < termCount; ++j)
+		{
+			FE_value n_dot_du = 0.0;
+			for (int i = 0; i < componentCount; ++i)
+				n_dot_du += sourceValues[i]*sourceDerivatives[i*termCount + j];
+			n_dot_du *= one__mag;
+			for (int i = 0; i < componentCount; ++i)
+				derivatives[i*termCount + j] = (sourceDerivatives[i*termCount + j] - sourceValues[i]*one__mag*n_dot_du)*one__mag;
+		}
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_normalise::list(
 	)
 /*******************************************************************************
@@ -141,6 +141,9 @@ cmzn_fieldcache::~cmzn_fieldcache()
 	delete[] indexed_location_element_xi;
 	this->indexed_location_element_xi = 0;
 	this->number_of_indexed_location_element_xi = 0;
+	for (std::vector<FieldEvaluationPlan *>::iterator iter = this->evaluationPlans.begin(); iter != this->evaluationPlans.end(); ++iter)
+		delete *iter;
+	this->evaluationPlans.clear();
 	for (ValueCacheVector::iterator iter = valueCaches.begin(); iter < valueCaches.end(); ++iter)
 	{
 		delete (*iter);
@@ -262,6 +265,19 @@ int cmzn_fieldcache::setFieldReal(cmzn_field *field, int numberOfValues, const d
 	return CMZN_OK;
 }
 
+int cmzn_fieldcache::compileField(cmzn_field *field)
+{
+	const size_t planCount = this->evaluationPlans.size();
+	for (size_t i = 0; i < planCount; ++i)
+		if (this->evaluationPlans[i]->getField() == field)
+			return CMZN_OK;
+	FieldEvaluationPlan *plan = FieldEvaluationPlan::create(field);
+	if (!plan)
+		return CMZN_ERROR_ARGUMENT;
+	this->evaluationPlans.push_back(plan);
+	return CMZN_OK;
+}
+
 void cmzn_fieldcache::removeDerivativeCaches(int derivativeCacheIndex)
 {
 	for (ValueCacheVector::iterator iter = valueCaches.begin(); iter < valueCaches.end(); ++iter)
@@ -358,6 +374,14 @@ int cmzn_fieldcache_set_field_real(cmzn_fieldcache_id cache,
 	return CMZN_ERROR_ARGUMENT;
 }
 
+int cmzn_fieldcache_compile_field(cmzn_fieldcache_id cache, cmzn_field_id field)
+{
+	if ((cache) && (field) && (Computed_field_get_region(field) == cache->getRegion()))
+		return cache->compileField(field);
+	display_message(ERROR_MESSAGE, "cmzn_fieldcache_compile_field.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
+
 // Internal function
 int cmzn_fieldcache_set_assign_in_cache(cmzn_fieldcache_id cache, int assign_in_cache)
 {
@@ -19,6 +19,7 @@
 #include "opencmiss/zinc/status.h"
 #include "general/debug.h"
 #include "region/cmiss_region.hpp"
+#include "computed_field/field_evaluation_plan.hpp"
 #include "computed_field/field_location.hpp"
 #include <vector>
 
@@ -292,6 +293,7 @@ private:
 	bool assignInCache;
 	cmzn_fieldcache *parentCache;  // non-accessed parent cache if this is its sharedWorkingCache; finite element evaluation caches are shared with parent
 	cmzn_fieldcache *sharedWorkingCache;  // optional working cache shared by fields evaluating at the same time value
+	std::vector<FieldEvaluationPlan *> evaluationPlans;  // compiled plans for evaluating fields with this cache
 	int access_count;
 
 	/** call whenever location changes to increment location counter */
@@ -526,6 +528,24 @@ public:
 	/** Remove derivative caches for derivativeCacheIndex for all real field value caches */
 	void removeDerivativeCaches(int derivativeCacheIndex);
 
+	/** Create evaluation plan for real-valued field if not already compiled.
+	 * @return  Result OK on success, otherwise ERROR_ARGUMENT. */
+	int compileField(cmzn_field *field);
+
+	/** @return  Compiled evaluation plan for field, or nullptr if none or if
+	 * it cannot be used at the current location or for assignment in cache */
+	FieldEvaluationPlan *getEvaluationPlan(cmzn_field *field) const
+	{
+		if ((this->evaluationPlans.empty()) || (this->assignInCache) ||
+			(this->location == &this->location_field_values))
+			return nullptr;
+		const size_t planCount = this->evaluationPlans.size();
+		for (size_t i = 0; i < planCount; ++i)
+			if (this->evaluationPlans[i]->getField() == field)
+				return this->evaluationPlans[i];
+		return nullptr;
+	}
+
 };
 
 /** Return private extraCache for evaluating fields at different locations and different time. */
@@ -0,0 +1,461 @@
+/**
+ * FILE : field_evaluation_plan.cpp
+ *
+ * Compiled evaluation plan for a real-valued field.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cmath>
+#include <cstring>
+#include "computed_field/computed_field.h"
+#include "computed_field/computed_field_private.hpp"
+#include "computed_field/field_cache.hpp"
+#include "computed_field/field_derivative.hpp"
+#include "computed_field/field_evaluation_plan.hpp"
+#include "computed_field/field_expression_kernel.hpp"
+#include "region/cmiss_region.hpp"
+
+namespace {
+
+/**
+ * @return  True if field type evaluates purely from the values of all its
+ * source fields at the same location, so sources may be evaluated first by
+ * the plan and identical fields with identical sources can be merged.
+ */
+bool Computed_field_type_is_pointwise(enum cmzn_field_type type)
+{
+	switch (type)
+	{
+	case CMZN_FIELD_TYPE_ADD:
+	case CMZN_FIELD_TYPE_POWER:
+	case CMZN_FIELD_TYPE_MULTIPLY:
+	case CMZN_FIELD_TYPE_DIVIDE:
+	case CMZN_FIELD_TYPE_SUBTRACT:
+	case CMZN_FIELD_TYPE_LOG:
+	case CMZN_FIELD_TYPE_SQRT:
+	case CMZN_FIELD_TYPE_EXP:
+	case CMZN_FIELD_TYPE_ABS:
+	case CMZN_FIELD_TYPE_IDENTITY:
+	case CMZN_FIELD_TYPE_COMPONENT:
+	case CMZN_FIELD_TYPE_CONCATENATE:
+	case CMZN_FIELD_TYPE_CONSTANT:
+	case CMZN_FIELD_TYPE_DETERMINANT:
+	case CMZN_FIELD_TYPE_MATRIX_MULTIPLY:
+	case CMZN_FIELD_TYPE_TRANSPOSE:
+	case CMZN_FIELD_TYPE_SIN:
+	case CMZN_FIELD_TYPE_COS:
+	case CMZN_FIELD_TYPE_TAN:
+	case CMZN_FIELD_TYPE_ASIN:
+	case CMZN_FIELD_TYPE_ACOS:
+	case CMZN_FIELD_TYPE_ATAN:
+	case CMZN_FIELD_TYPE_ATAN2:
+	case CMZN_FIELD_TYPE_CROSS_PRODUCT:
+	case CMZN_FIELD_TYPE_DOT_PRODUCT:
+	case CMZN_FIELD_TYPE_MAGNITUDE:
+	case CMZN_FIELD_TYPE_NORMALISE:
+	case CMZN_FIELD_TYPE_SUM_COMPONENTS:
+		return true;
+	default:
+		break;
+	}
+	return false;
+}
+
+FieldEvaluationPlan::Operation Computed_field_type_get_plan_operation(enum cmzn_field_type type)
+{
+	switch (type)
+	{
+	case CMZN_FIELD_TYPE_CONSTANT:
+		return FieldEvaluationPlan::OPERATION_CONSTANT;
+	case CMZN_FIELD_TYPE_ADD:
+	case CMZN_FIELD_TYPE_SUBTRACT:
+		return FieldEvaluationPlan::OPERATION_WEIGHTED_ADD;
+	case CMZN_FIELD_TYPE_MULTIPLY:
+		return FieldEvaluationPlan::OPERATION_MULTIPLY;
+	case CMZN_FIELD_TYPE_DIVIDE:
+		return FieldEvaluationPlan::OPERATION_DIVIDE;
+	case CMZN_FIELD_TYPE_POWER:
+		return FieldEvaluationPlan::OPERATION_POWER;
+	case CMZN_FIELD_TYPE_SQRT:
+		return FieldEvaluationPlan::OPERATION_SQRT;
+	case CMZN_FIELD_TYPE_LOG:
+		return FieldEvaluationPlan::OPERATION_LOG;
+	case CMZN_FIELD_TYPE_EXP:
+		return FieldEvaluationPlan::OPERATION_EXP;
+	case CMZN_FIELD_TYPE_ABS:
+		return FieldEvaluationPlan::OPERATION_ABS;
+	case CMZN_FIELD_TYPE_SIN:
+		return FieldEvaluationPlan::OPERATION_SIN;
+	case CMZN_FIELD_TYPE_COS:
+		return FieldEvaluationPlan::OPERATION_COS;
+	case CMZN_FIELD_TYPE_TAN:
+		return FieldEvaluationPlan::OPERATION_TAN;
+	case CMZN_FIELD_TYPE_ASIN:
+		return FieldEvaluationPlan::OPERATION_ASIN;
+	case CMZN_FIELD_TYPE_ACOS:
+		return FieldEvaluationPlan::OPERATION_ACOS;
+	case CMZN_FIELD_TYPE_ATAN:
+		return FieldEvaluationPlan::OPERATION_ATAN;
+	case CMZN_FIELD_TYPE_ATAN2:
+		return FieldEvaluationPlan::OPERATION_ATAN2;
+	case CMZN_FIELD_TYPE_MAGNITUDE:
+		return FieldEvaluationPlan::OPERATION_MAGNITUDE;
+	case CMZN_FIELD_TYPE_DOT_PRODUCT:
+		return FieldEvaluationPlan::OPERATION_DOT_PRODUCT;
+	default:
+		break;
+	}
+	return FieldEvaluationPlan::OPERATION_EVALUATE;
+}
+
+} // anonymous namespace
+
+FieldEvaluationPlan::FieldEvaluationPlan(cmzn_field *rootFieldIn) :
+	rootField(cmzn_field_access(rootFieldIn)),
+	modifyCounter(-1),
+	mergeCount(0),
+	kernel(nullptr)
+{
+}
+
+FieldEvaluationPlan::~FieldEvaluationPlan()
+{
+	cmzn_field_destroy(&this->rootField);
+}
+
+FieldEvaluationPlan *FieldEvaluationPlan::create(cmzn_field *rootFieldIn)
+{
+	if ((rootFieldIn) && (rootFieldIn->isNumerical()))
+		return new FieldEvaluationPlan(rootFieldIn);
+	return nullptr;
+}
+
+/**
+ * @param sourceInstructions  Canonical instruction indices of field's source fields.
+ * @return  Index of earlier instruction evaluating a field of the same type,
+ * parameters and source instructions, or -1 if none.
+ */
+int FieldEvaluationPlan::findIdenticalInstruction(cmzn_field *field,
+	const std::vector<int>& sourceInstructions) const
+{
+	const enum cmzn_field_type type = field->core->get_type();
+	const int instructionCount = static_cast<int>(this->instructions.size());
+	for (int i = 0; i < instructionCount; ++i)
+	{
+		const Instruction& instruction = this->instructions[i];
+		if ((instruction.operation == OPERATION_COPY) || (instruction.operation == OPERATION_EVALUATE_SOURCES))
+			continue;
+		cmzn_field *otherField = instruction.field;
+		if ((otherField->core->get_type() != type)
+			|| (otherField->number_of_components != field->number_of_components)
+			|| (otherField->number_of_source_values != field->number_of_source_values)
+			|| (this->instructionSources[i] != sourceInstructions))
+			continue;
+		bool match = true;
+		for (int v = 0; match && (v < field->number_of_source_values); ++v)
+			match = (otherField->source_values[v] == field->source_values[v]);
+		if (match && (otherField->core->compare(field->core)))
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Add instructions for field and its sources in post order, merging with
+ * identical earlier instructions.
+ * @return  Canonical instruction index evaluating field's values.
+ */
+int FieldEvaluationPlan::addField(cmzn_field *field, BuildState& buildState)
+{
+	const int visitedCount = static_cast<int>(buildState.visitedFields.size());
+	for (int i = 0; i < visitedCount; ++i)
+		if (buildState.visitedFields[i] == field)
+			return buildState.visitedInstructions[i];
+	Instruction instruction;
+	instruction.field = field;
+	instruction.componentCount = field->number_of_components;
+	instruction.source1 = -1;
+	instruction.source2 = -1;
+	std::vector<int> sourceInstructions;
+	const enum cmzn_field_type type = field->core->get_type();
+	int canonicalIndex = static_cast<int>(this->instructions.size());
+	if (Computed_field_type_is_pointwise(type))
+	{
+		sourceInstructions.resize(field->number_of_source_fields);
+		for (int s = 0; s < field->number_of_source_fields; ++s)
+			sourceInstructions[s] = this->addField(field->source_fields[s], buildState);
+		// sources may have added instructions
+		canonicalIndex = static_cast<int>(this->instructions.size());
+		const int identicalIndex = this->findIdenticalInstruction(field, sourceInstructions);
+		if (identicalIndex >= 0)
+		{
+			instruction.operation = OPERATION_COPY;
+			instruction.source1 = identicalIndex;
+			++(this->mergeCount);
+			canonicalIndex = identicalIndex;
+		}
+		else
+		{
+			instruction.operation = Computed_field_type_get_plan_operation(type);
+			if (field->number_of_source_fields > 0)
+				instruction.source1 = sourceInstructions[0];
+			if (field->number_of_source_fields > 1)
+				instruction.source2 = sourceInstructions[1];
+		}
+	}
+	else
+	{
+		// evaluated normally, including its sources
+		instruction.operation = OPERATION_EVALUATE_SOURCES;
+	}
+	this->instructions.push_back(instruction);
+	this->instructionSources.push_back(sourceInstructions);
+	buildState.visitedFields.push_back(field);
+	buildState.visitedInstructions.push_back(canonicalIndex);
+	return canonicalIndex;
+}
+
+void FieldEvaluationPlan::build()
+{
+	this->instructions.clear();
+	this->instructionSources.clear();
+	this->mergeCount = 0;
+	BuildState buildState;
+	this->addField(this->rootField, buildState);
+	this->kernel = FieldExpressionKernel::get(*this, this->kernelInputInstructions);
+}
+
+void FieldEvaluationPlan::checkBuild(cmzn_fieldcache& cache)
+{
+	const int regionModifyCounter = cache.getRegion()->getFieldModifyCounter();
+	if (this->modifyCounter != regionModifyCounter)
+	{
+		this->build();
+		this->modifyCounter = regionModifyCounter;
+	}
+}
+
+/** Evaluate root field values with compiled kernel, with inputs evaluated normally */
+const RealFieldValueCache *FieldEvaluationPlan::evaluateKernel(cmzn_fieldcache& cache)
+{
+	RealFieldValueCache& valueCache = RealFieldValueCache::cast(*this->rootField->getValueCache(cache));
+	const int locationCounter = cache.getLocationCounter();
+	if ((valueCache.evaluationCounter >= locationCounter) && (!cache.hasRegionModifications()))
+		return &valueCache;
+	this->kernelInputs.resize(this->kernel->getInputCount());
+	FE_value *inputs = this->kernelInputs.data();
+	const size_t inputInstructionCount = this->kernelInputInstructions.size();
+	for (size_t i = 0; i < inputInstructionCount; ++i)
+	{
+		const Instruction& instruction = this->instructions[this->kernelInputInstructions[i]];
+		const FE_value *values;
+		if (instruction.operation == OPERATION_CONSTANT)
+			values = instruction.field->source_values;
+		else
+		{
+			const RealFieldValueCache *inputValueCache = RealFieldValueCache::cast(instruction.field->evaluate(cache));
+			if (!inputValueCache)
+				return nullptr;
+			values = inputValueCache->values;
+		}
+		memcpy(inputs, values, instruction.componentCount*sizeof(FE_value));
+		inputs += instruction.componentCount;
+	}
+	this->kernel->evaluate(1, this->kernelInputs.data(), valueCache.values);
+	valueCache.evaluationCounter = locationCounter;
+	return &valueCache;
+}
+
+const RealFieldValueCache *FieldEvaluationPlan::evaluate(cmzn_fieldcache& cache)
+{
+	this->checkBuild(cache);
+	if (this->kernel)
+		return this->evaluateKernel(cache);
+	const int locationCounter = cache.getLocationCounter();
+	const bool regionModifications = cache.hasRegionModifications();
+	const int instructionCount = static_cast<int>(this->instructions.size());
+	const Instruction *instruction = this->instructions.data();
+	RealFieldValueCache *valueCache = nullptr;
+	for (int i = 0; i < instructionCount; ++i, ++instruction)
+	{
+		cmzn_field *field = instruction->field;
+		FieldValueCache *fieldValueCache = field->getValueCache(cache);
+		valueCache = RealFieldValueCache::cast(fieldValueCache);
+		if ((fieldValueCache->evaluationCounter >= locationCounter) && (!regionModifications))
+			continue;
+		FE_value *values = valueCache->values;
+		const int componentCount = instruction->componentCount;
+		const FE_value *source1Values = (instruction->source1 >= 0) ? RealFieldValueCache::cast(
+			this->instructions[instruction->source1].field->getValueCache(cache))->values : nullptr;
+		const FE_value *source2Values = (instruction->source2 >= 0) ? RealFieldValueCache::cast(
+			this->instructions[instruction->source2].field->getValueCache(cache))->values : nullptr;
+		switch (instruction->operation)
+		{
+		case OPERATION_EVALUATE:
+		case OPERATION_EVALUATE_SOURCES:
+		{
+			if (!field->core->evaluate(cache, *fieldValueCache))
+				return nullptr;
+		} break;
+		case OPERATION_COPY:
+		{
+			memcpy(values, source1Values, componentCount*sizeof(FE_value));
+		} break;
+		case OPERATION_CONSTANT:
+		{
+			memcpy(values, field->source_values, componentCount*sizeof(FE_value));
+		} break;
+		case OPERATION_WEIGHTED_ADD:
+		{
+			const FE_value weight1 = field->source_values[0];
+			const FE_value weight2 = field->source_values[1];
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = weight1*source1Values[c] + weight2*source2Values[c];
+		} break;
+		case OPERATION_MULTIPLY:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = source1Values[c]*source2Values[c];
+		} break;
+		case OPERATION_DIVIDE:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = source1Values[c]/source2Values[c];
+		} break;
+		case OPERATION_POWER:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = pow(source1Values[c], source2Values[c]);
+		} break;
+		case OPERATION_SQRT:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = sqrt(source1Values[c]);
+		} break;
+		case OPERATION_LOG:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = log(source1Values[c]);
+		} break;
+		case OPERATION_EXP:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = exp(source1Values[c]);
+		} break;
+		case OPERATION_ABS:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = fabs(source1Values[c]);
+		} break;
+		case OPERATION_SIN:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = sin(source1Values[c]);
+		} break;
+		case OPERATION_COS:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = cos(source1Values[c]);
+		} break;
+		case OPERATION_TAN:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = tan(source1Values[c]);
+		} break;
+		case OPERATION_ASIN:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = asin(source1Values[c]);
+		} break;
+		case OPERATION_ACOS:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = acos(source1Values[c]);
+		} break;
+		case OPERATION_ATAN:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = atan(source1Values[c]);
+		} break;
+		case OPERATION_ATAN2:
+		{
+			for (int c = 0; c < componentCount; ++c)
+				values[c] = atan2(source1Values[c], source2Values[c]);
+		} break;
+		case OPERATION_MAGNITUDE:
+		{
+			const int sourceComponentCount = this->instructions[instruction->source1].componentCount;
+			FE_value sum = 0.0;
+			for (int c = 0; c < sourceComponentCount; ++c)
+				sum += source1Values[c]*source1Values[c];
+			values[0] = sqrt(sum);
+		} break;
+		case OPERATION_DOT_PRODUCT:
+		{
+			const int sourceComponentCount = this->instructions[instruction->source1].componentCount;
+			FE_value sum = 0.0;
+			for (int c = 0; c < sourceComponentCount; ++c)
+				sum += source1Values[c]*source2Values[c];
+			values[0] = sum;
+		} break;
+		}
+		fieldValueCache->evaluationCounter = locationCounter;
+	}
+	return valueCache;
+}
+
+const DerivativeValueCache *FieldEvaluationPlan::evaluateDerivative(cmzn_fieldcache& cache,
+	const FieldDerivative& fieldDerivative)
+{
+	if (fieldDerivative.getTotalOrder() != 1)
+		return nullptr;
+	this->checkBuild(cache);
+	if (!this->kernel)
+		return nullptr;
+	RealFieldValueCache& valueCache = RealFieldValueCache::cast(*this->rootField->getValueCache(cache));
+	DerivativeValueCache *derivativeValueCache = valueCache.getOrCreateDerivativeValueCache(fieldDerivative, cache.get_location());
+	const int locationCounter = cache.getLocationCounter();
+	if ((derivativeValueCache->evaluationCounter >= locationCounter) && (!cache.hasRegionModifications()))
+		return derivativeValueCache;
+	const int termCount = derivativeValueCache->getTermCount();
+	const int inputCount = this->kernel->getInputCount();
+	this->kernelInputs.resize(inputCount);
+	this->kernelInputDerivatives.resize(inputCount*termCount);
+	this->kernelWork.resize(this->kernel->getWorkCount()*termCount);
+	FE_value *inputs = this->kernelInputs.data();
+	FE_value *inputDerivatives = this->kernelInputDerivatives.data();
+	const size_t inputInstructionCount = this->kernelInputInstructions.size();
+	for (size_t i = 0; i < inputInstructionCount; ++i)
+	{
+		const Instruction& instruction = this->instructions[this->kernelInputInstructions[i]];
+		const int valueCount = instruction.componentCount;
+		if (instruction.operation == OPERATION_CONSTANT)
+		{
+			memcpy(inputs, instruction.field->source_values, valueCount*sizeof(FE_value));
+			for (int v = 0; v < valueCount*termCount; ++v)
+				inputDerivatives[v] = 0.0;
+		}
+		else
+		{
+			const RealFieldValueCache *inputValueCache = instruction.field->evaluateDerivativeTree(cache, fieldDerivative);
+			if (!inputValueCache)
+				return nullptr;
+			const DerivativeValueCache *inputDerivativeCache = inputValueCache->getDerivativeValueCache(fieldDerivative);
+			if (inputDerivativeCache->getTermCount() != termCount)
+				return nullptr;
+			memcpy(inputs, inputValueCache->values, valueCount*sizeof(FE_value));
+			memcpy(inputDerivatives, inputDerivativeCache->values, valueCount*termCount*sizeof(FE_value));
+		}
+		inputs += valueCount;
+		inputDerivatives += valueCount*termCount;
+	}
+	this->kernel->evaluateDerivatives(1, termCount, this->kernelInputs.data(), this->kernelInputDerivatives.data(),
+		valueCache.values, derivativeValueCache->values, this->kernelWork.data());
+	valueCache.evaluationCounter = locationCounter;
+	derivativeValueCache->evaluationCounter = locationCounter;
+	return derivativeValueCache;
+}
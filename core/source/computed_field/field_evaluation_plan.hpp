@@ -0,0 +1,165 @@
+/**
+ * FILE : field_evaluation_plan.hpp
+ *
+ * Compiled evaluation plan for a real-valued field, flattening its expression
+ * DAG into a linear list of instructions in dependency order with structurally
+ * identical subexpressions merged. Common operators are evaluated directly by
+ * the plan without virtual dispatch. Results are stored in the usual field
+ * value caches so they are shared with normal evaluation.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__FIELD_EVALUATION_PLAN_HPP__)
+#define __FIELD_EVALUATION_PLAN_HPP__
+
+#include "opencmiss/zinc/types/fieldcacheid.h"
+#include "opencmiss/zinc/types/fieldid.h"
+#include "opencmiss/zinc/zincconfigure.h"
+#include <vector>
+
+class DerivativeValueCache;
+class FieldDerivative;
+class FieldExpressionKernel;
+class RealFieldValueCache;
+
+class FieldEvaluationPlan
+{
+public:
+	enum Operation
+	{
+		OPERATION_EVALUATE,  // evaluate with field core; sources already evaluated
+		OPERATION_EVALUATE_SOURCES,  // evaluate with field core including its sources
+		OPERATION_COPY,  // copy values of identical earlier instruction
+		OPERATION_CONSTANT,
+		OPERATION_WEIGHTED_ADD,  // add and subtract
+		OPERATION_MULTIPLY,
+		OPERATION_DIVIDE,
+		OPERATION_POWER,
+		OPERATION_SQRT,
+		OPERATION_LOG,
+		OPERATION_EXP,
+		OPERATION_ABS,
+		OPERATION_SIN,
+		OPERATION_COS,
+		OPERATION_TAN,
+		OPERATION_ASIN,
+		OPERATION_ACOS,
+		OPERATION_ATAN,
+		OPERATION_ATAN2,
+		OPERATION_MAGNITUDE,
+		OPERATION_DOT_PRODUCT
+	};
+
+private:
+	struct Instruction
+	{
+		Operation operation;
+		cmzn_field *field;  // not accessed; kept alive by accessed root field
+		int componentCount;
+		int source1, source2;  // instruction indices of sources, or -1 if unused
+	};
+
+	cmzn_field *rootField;  // accessed
+	int modifyCounter;  // region field modify counter plan was built for
+	std::vector<Instruction> instructions;
+	std::vector< std::vector<int> > instructionSources;  // canonical instruction of each source field
+	int mergeCount;  // number of instructions replaced by copies
+	const FieldExpressionKernel *kernel;  // optional compiled kernel, owned by kernel registry
+	std::vector<int> kernelInputInstructions;  // instructions whose values are kernel inputs
+	std::vector<FE_value> kernelInputs, kernelInputDerivatives, kernelWork;  // reused buffers
+
+	FieldEvaluationPlan(cmzn_field *rootFieldIn);
+
+	FieldEvaluationPlan();  // not implemented
+	FieldEvaluationPlan(const FieldEvaluationPlan &source);  // not implemented
+	FieldEvaluationPlan& operator=(const FieldEvaluationPlan &source);  // not implemented
+
+	/** Working data for building instructions */
+	struct BuildState
+	{
+		std::vector<cmzn_field *> visitedFields;
+		std::vector<int> visitedInstructions;  // canonical instruction for each visited field
+	};
+
+	int addField(cmzn_field *field, BuildState& buildState);
+
+	int findIdenticalInstruction(cmzn_field *field, const std::vector<int>& sourceInstructions) const;
+
+	void build();
+
+	void checkBuild(cmzn_fieldcache& cache);
+
+	const RealFieldValueCache *evaluateKernel(cmzn_fieldcache& cache);
+
+public:
+
+	~FieldEvaluationPlan();
+
+	/**
+	 * Create plan for evaluating real-valued field.
+	 * @return  New plan or nullptr if invalid field.
+	 */
+	static FieldEvaluationPlan *create(cmzn_field *rootFieldIn);
+
+	/** @return  Non-accessed root field */
+	cmzn_field *getField() const
+	{
+		return this->rootField;
+	}
+
+	int getInstructionCount() const
+	{
+		return static_cast<int>(this->instructions.size());
+	}
+
+	Operation getInstructionOperation(int index) const
+	{
+		return this->instructions[index].operation;
+	}
+
+	/** @return  Non-accessed field evaluated by instruction */
+	cmzn_field *getInstructionField(int index) const
+	{
+		return this->instructions[index].field;
+	}
+
+	/** @return  Canonical instruction indices evaluating each source field of
+	 * a pointwise instruction, or empty vector if sources not in plan. */
+	const std::vector<int>& getInstructionSources(int index) const
+	{
+		return this->instructionSources[index];
+	}
+
+	/** @return  Number of subexpressions merged with identical earlier ones */
+	int getMergeCount() const
+	{
+		return this->mergeCount;
+	}
+
+	/**
+	 * Evaluate root field at location in cache, rebuilding plan first if
+	 * fields in the region have been modified since it was built.
+	 * Instructions whose field values are already current in the cache are
+	 * not re-evaluated.
+	 * @return  Value cache of root field, or nullptr if any instruction failed
+	 * in which case caller should evaluate normally as plan eagerly evaluates
+	 * sources which may not be needed.
+	 */
+	const RealFieldValueCache *evaluate(cmzn_fieldcache& cache);
+
+	/**
+	 * Evaluate first derivatives of root field at location in cache with the
+	 * compiled kernel, if any.
+	 * @return  Derivative value cache of root field, or nullptr if no kernel,
+	 * unsupported derivative or failed, in which case caller should evaluate
+	 * normally.
+	 */
+	const DerivativeValueCache *evaluateDerivative(cmzn_fieldcache& cache,
+		const FieldDerivative& fieldDerivative);
+
+};
+
+#endif /* !defined (__FIELD_EVALUATION_PLAN_HPP__) */
@@ -0,0 +1,498 @@
+/**
+ * FILE : field_expression_kernel.cpp
+ *
+ * Optional backend compiling the arithmetic part of field evaluation plans.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "opencmiss/zinc/zincconfigure.h"
+#include "computed_field/computed_field.h"
+#include "computed_field/computed_field_composite.h"
+#include "computed_field/computed_field_private.hpp"
+#include "computed_field/field_evaluation_plan.hpp"
+#include "computed_field/field_expression_kernel.hpp"
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#if defined (ZINC_USE_FIELD_KERNEL_COMPILER) && defined (UNIX)
+#  include <cerrno>
+#  include <cstdlib>
+#  include <fstream>
+#  include <map>
+#  include <mutex>
+#  include <dlfcn.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+
+/** Append name of scalar variable for value or derivative of component of instruction */
+void appendScalarName(std::ostringstream& out, char prefix, int instructionIndex, int componentIndex)
+{
+	out << prefix << instructionIndex << '_' << componentIndex;
+}
+
+std::string scalarName(char prefix, int instructionIndex, int componentIndex)
+{
+	std::ostringstream out;
+	appendScalarName(out, prefix, instructionIndex, componentIndex);
+	return out.str();
+}
+
+/** @return  Literal for value with full precision */
+std::string valueLiteral(FE_value value)
+{
+	char buffer[40];
+	snprintf(buffer, sizeof(buffer), "%.17g", static_cast<double>(value));
+	std::string literal(buffer);
+	if (literal.find_first_of(".eE") == std::string::npos)
+		literal += ".0";
+	return "(" + literal + ")";
+}
+
+/**
+ * Generated value and derivative statements for one component of an
+ * instruction.
+ */
+struct ComponentCode
+{
+	std::string value;  // expression for value
+	std::string derivativeFactorDeclarations;  // optional statements before derivative loop
+	std::string derivative;  // expression for derivative term t, or empty if aliasing
+	std::string derivativeAlias;  // derivative pointer aliased, if not computed
+};
+
+/**
+ * Generate code for component of instruction operating on component-wise
+ * sources.
+ * @return  True on success, false if not supported.
+ */
+bool generateComponentCode(const FieldEvaluationPlan& plan, int instructionIndex,
+	int c, ComponentCode& code)
+{
+	const FieldEvaluationPlan::Operation operation = plan.getInstructionOperation(instructionIndex);
+	cmzn_field *field = plan.getInstructionField(instructionIndex);
+	const std::vector<int>& sources = plan.getInstructionSources(instructionIndex);
+	const std::string r = scalarName('v', instructionIndex, c);
+	std::string a, b, da, db;
+	if (sources.size() > 0)
+	{
+		a = scalarName('v', sources[0], c);
+		da = scalarName('d', sources[0], c) + "[t]";
+	}
+	if (sources.size() > 1)
+	{
+		b = scalarName('v', sources[1], c);
+		db = scalarName('d', sources[1], c) + "[t]";
+	}
+	switch (operation)
+	{
+	case FieldEvaluationPlan::OPERATION_WEIGHTED_ADD:
+	{
+		const std::string w1 = valueLiteral(field->source_values[0]);
+		const std::string w2 = valueLiteral(field->source_values[1]);
+		code.value = w1 + "*" + a + " + " + w2 + "*" + b;
+		code.derivative = w1 + "*" + da + " + " + w2 + "*" + db;
+	} break;
+	case FieldEvaluationPlan::OPERATION_MULTIPLY:
+	{
+		code.value = a + "*" + b;
+		code.derivative = a + "*" + db + " + " + b + "*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_DIVIDE:
+	{
+		code.value = a + "/" + b;
+		code.derivative = "(" + da + " - " + r + "*" + db + ")/" + b;
+	} break;
+	case FieldEvaluationPlan::OPERATION_POWER:
+	{
+		// d(u^v)/dx = v * u^(v-1) * du/dx   +   u^v * ln(u) * dv/dx
+		code.value = "pow(" + a + ", " + b + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = " + b + "*pow(" + a + ", " + b + " - 1.0); "
+			"const FE_value f2 = " + r + "*log(" + a + ");";
+		code.derivative = "f1*" + da + " + f2*" + db;
+	} break;
+	case FieldEvaluationPlan::OPERATION_SQRT:
+	{
+		code.value = "sqrt(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = 0.5/" + r + ";";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_LOG:
+	{
+		code.value = "log(" + a + ")";
+		code.derivative = da + "/" + a;
+	} break;
+	case FieldEvaluationPlan::OPERATION_EXP:
+	{
+		code.value = "exp(" + a + ")";
+		code.derivative = r + "*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_ABS:
+	{
+		code.value = "fabs(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = (" + a + " > 0.0) ? 1.0 : ((" + a + " < 0.0) ? -1.0 : 0.0);";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_SIN:
+	{
+		code.value = "sin(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = cos(" + a + ");";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_COS:
+	{
+		code.value = "cos(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = -sin(" + a + ");";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_TAN:
+	{
+		code.value = "tan(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = 1.0 + " + r + "*" + r + ";";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_ASIN:
+	{
+		code.value = "asin(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = 1.0/sqrt(1.0 - " + a + "*" + a + ");";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_ACOS:
+	{
+		code.value = "acos(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = -1.0/sqrt(1.0 - " + a + "*" + a + ");";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_ATAN:
+	{
+		code.value = "atan(" + a + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = 1.0/(1.0 + " + a + "*" + a + ");";
+		code.derivative = "f1*" + da;
+	} break;
+	case FieldEvaluationPlan::OPERATION_ATAN2:
+	{
+		// d(atan (u/v))/dx =  ( v * du/dx - u * dv/dx ) / ( u^2 + v^2 )
+		code.value = "atan2(" + a + ", " + b + ")";
+		code.derivativeFactorDeclarations = "const FE_value f1 = 1.0/(" + a + "*" + a + " + " + b + "*" + b + ");";
+		code.derivative = "f1*(" + b + "*" + da + " - " + a + "*" + db + ")";
+	} break;
+	case FieldEvaluationPlan::OPERATION_MAGNITUDE:
+	case FieldEvaluationPlan::OPERATION_DOT_PRODUCT:
+	{
+		const int sourceComponentCount = plan.getInstructionField(sources[0])->number_of_components;
+		std::ostringstream value, derivative;
+		for (int k = 0; k < sourceComponentCount; ++k)
+		{
+			if (k > 0)
+			{
+				value << " + ";
+				derivative << " + ";
+			}
+			const std::string ak = scalarName('v', sources[0], k);
+			const std::string dak = scalarName('d', sources[0], k) + "[t]";
+			if (operation == FieldEvaluationPlan::OPERATION_MAGNITUDE)
+			{
+				value << ak << "*" << ak;
+				derivative << ak << "*" << dak;
+			}
+			else
+			{
+				const std::string bk = scalarName('v', sources[1], k);
+				const std::string dbk = scalarName('d', sources[1], k) + "[t]";
+				value << ak << "*" << bk;
+				derivative << ak << "*" << dbk << " + " << bk << "*" << dak;
+			}
+		}
+		if (operation == FieldEvaluationPlan::OPERATION_MAGNITUDE)
+		{
+			code.value = "sqrt(" + value.str() + ")";
+			code.derivativeFactorDeclarations = "const FE_value f1 = 1.0/" + r + ";";
+			code.derivative = "f1*(" + derivative.str() + ")";
+		}
+		else
+		{
+			code.value = value.str();
+			code.derivative = derivative.str();
+		}
+	} break;
+	case FieldEvaluationPlan::OPERATION_EVALUATE:
+	{
+		// only composite, component and concatenate fields can be generated
+		int sourceFieldIndex, sourceValueIndex;
+		if (!Computed_field_composite_get_component_source(field, c, &sourceFieldIndex, &sourceValueIndex))
+			return false;
+		if (sourceFieldIndex < 0)
+		{
+			const FE_value value = field->source_values[sourceValueIndex];
+			if (!std::isfinite(value))
+				return false;
+			code.value = valueLiteral(value);
+			code.derivative = "0.0";
+		}
+		else
+		{
+			if (sourceFieldIndex >= static_cast<int>(sources.size()))
+				return false;
+			code.value = scalarName('v', sources[sourceFieldIndex], sourceValueIndex);
+			code.derivativeAlias = scalarName('d', sources[sourceFieldIndex], sourceValueIndex);
+		}
+	} break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+std::string FieldExpressionKernel::generateSource(const FieldEvaluationPlan& plan,
+	std::vector<int>& inputInstructions, int& inputCount, int& workCount)
+{
+	inputInstructions.clear();
+	inputCount = 0;
+	workCount = 0;
+	const int instructionCount = plan.getInstructionCount();
+	if (instructionCount < 2)
+		return std::string();
+	std::ostringstream values, derivatives;
+	int computedCount = 0;
+	for (int i = 0; i < instructionCount; ++i)
+	{
+		const FieldEvaluationPlan::Operation operation = plan.getInstructionOperation(i);
+		if (operation == FieldEvaluationPlan::OPERATION_COPY)
+			continue;  // dependents use canonical instruction
+		const int componentCount = plan.getInstructionField(i)->number_of_components;
+		if ((operation == FieldEvaluationPlan::OPERATION_CONSTANT)
+			|| (operation == FieldEvaluationPlan::OPERATION_EVALUATE_SOURCES))
+		{
+			inputInstructions.push_back(i);
+			for (int c = 0; c < componentCount; ++c)
+			{
+				values << "\t\tconst FE_value " << scalarName('v', i, c) << " = inputs[" << inputCount << "];\n";
+				derivatives << "\t\tconst FE_value " << scalarName('v', i, c) << " = inputs[" << inputCount << "];\n";
+				derivatives << "\t\tconst FE_value *" << scalarName('d', i, c) << " = inputDerivatives + " << inputCount << "*termCount;\n";
+				++inputCount;
+			}
+			continue;
+		}
+		++computedCount;
+		for (int c = 0; c < componentCount; ++c)
+		{
+			if (((operation == FieldEvaluationPlan::OPERATION_MAGNITUDE)
+				|| (operation == FieldEvaluationPlan::OPERATION_DOT_PRODUCT)) && (c > 0))
+				return std::string();
+			ComponentCode code;
+			if (!generateComponentCode(plan, i, c, code))
+				return std::string();
+			const std::string r = scalarName('v', i, c);
+			const std::string dr = scalarName('d', i, c);
+			values << "\t\tconst FE_value " << r << " = " << code.value << ";\n";
+			derivatives << "\t\tconst FE_value " << r << " = " << code.value << ";\n";
+			if (code.derivativeAlias.size() > 0)
+				derivatives << "\t\tconst FE_value *" << dr << " = " << code.derivativeAlias << ";\n";
+			else
+			{
+				derivatives << "\t\tFE_value *" << dr << " = work + " << workCount << "*termCount;\n";
+				derivatives << "\t\t{\n";
+				if (code.derivativeFactorDeclarations.size() > 0)
+					derivatives << "\t\t\t" << code.derivativeFactorDeclarations << "\n";
+				derivatives << "\t\t\tfor (int t = 0; t < termCount; ++t)\n";
+				derivatives << "\t\t\t\t" << dr << "[t] = " << code.derivative << ";\n";
+				derivatives << "\t\t}\n";
+				++workCount;
+			}
+		}
+	}
+	if (computedCount == 0)
+		return std::string();
+	const int rootIndex = instructionCount - 1;
+	const int resultCount = plan.getInstructionField(rootIndex)->number_of_components;
+	for (int c = 0; c < resultCount; ++c)
+	{
+		values << "\t\tresults[" << c << "] = " << scalarName('v', rootIndex, c) << ";\n";
+		derivatives << "\t\tresults[" << c << "] = " << scalarName('v', rootIndex, c) << ";\n";
+		derivatives << "\t\tfor (int t = 0; t < termCount; ++t)\n";
+		derivatives << "\t\t\tresultDerivatives[" << c << "*termCount + t] = " << scalarName('d', rootIndex, c) << "[t];\n";
+	}
+	std::ostringstream source;
+	source << "// Field expression kernel generated by OpenCMISS-Zinc\n"
+		"#include <cmath>\n"
+		"typedef double FE_value;\n"
+		"extern \"C\" {\n"
+		"void zinc_field_kernel_values(int pointCount, const FE_value *inputs, FE_value *results)\n"
+		"{\n"
+		"\tfor (int p = 0; p < pointCount; ++p, inputs += " << inputCount << ", results += " << resultCount << ")\n"
+		"\t{\n"
+		<< values.str() <<
+		"\t}\n"
+		"}\n"
+		"void zinc_field_kernel_derivatives(int pointCount, int termCount,\n"
+		"\tconst FE_value *inputs, const FE_value *inputDerivatives,\n"
+		"\tFE_value *results, FE_value *resultDerivatives, FE_value *work)\n"
+		"{\n"
+		"\tfor (int p = 0; p < pointCount; ++p, inputs += " << inputCount << ", inputDerivatives += " << inputCount << "*termCount,\n"
+		"\t\tresults += " << resultCount << ", resultDerivatives += " << resultCount << "*termCount)\n"
+		"\t{\n"
+		<< derivatives.str() <<
+		"\t}\n"
+		"}\n"
+		"}\n";
+	return source.str();
+}
+
+#if defined (ZINC_USE_FIELD_KERNEL_COMPILER) && defined (UNIX)
+
+namespace {
+
+/** Registry of kernels by source, including nullptr for failed compilations */
+std::map<std::string, FieldExpressionKernel *> kernelRegistry;
+std::mutex kernelRegistryMutex;
+
+/** 64-bit FNV-1a hash */
+unsigned long long hashString(const std::string& text)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (std::string::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+	{
+		hash ^= static_cast<unsigned char>(*iter);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/** @return  True if file exists with exactly the given contents */
+bool fileHasContents(const std::string& fileName, const std::string& contents)
+{
+	std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+		return false;
+	std::ostringstream fileContents;
+	fileContents << file.rdbuf();
+	return fileContents.str() == contents;
+}
+
+/**
+ * Get directory for caching kernels, creating it if needed. For security it
+ * must be a directory owned by the current user with no group or other access.
+ * @return  True on success.
+ */
+bool getKernelCacheDirectory(std::string& directory)
+{
+	const char *cacheDirectory = getenv("ZINC_FIELD_KERNEL_CACHE");
+	if ((cacheDirectory) && (cacheDirectory[0]))
+		directory = cacheDirectory;
+	else
+	{
+		const char *tmpDirectory = getenv("TMPDIR");
+		std::ostringstream defaultDirectory;
+		defaultDirectory << (((tmpDirectory) && (tmpDirectory[0])) ? tmpDirectory : "/tmp")
+			<< "/zinc_field_kernels_" << static_cast<unsigned long>(getuid());
+		directory = defaultDirectory.str();
+	}
+	if (directory.find('\'') != std::string::npos)
+		return false;  // not safe to quote in command
+	if ((0 != mkdir(directory.c_str(), S_IRWXU)) && (errno != EEXIST))
+		return false;
+	struct stat status;
+	return (0 == lstat(directory.c_str(), &status)) && S_ISDIR(status.st_mode)
+		&& (status.st_uid == getuid()) && (0 == (status.st_mode & (S_IRWXG | S_IRWXO)));
+}
+
+/**
+ * Load kernel library from disk cache or compile it there first.
+ * @return  Library handle or nullptr if failed.
+ */
+void *loadKernelLibrary(const std::string& source)
+{
+	const char *compilerEnvironment = getenv("ZINC_FIELD_KERNEL_COMPILER");
+	const std::string compiler((compilerEnvironment) ? compilerEnvironment : "c++");
+	if (compiler.empty())
+		return nullptr;
+	std::string directory;
+	if (!getKernelCacheDirectory(directory))
+		return nullptr;
+	char hashString16[20];
+	snprintf(hashString16, sizeof(hashString16), "%016llx", hashString(compiler + "\n" + source));
+	const std::string baseName = directory + "/kernel_" + hashString16;
+	const std::string sourceFileName = baseName + ".cpp";
+	const std::string libraryFileName = baseName + ".so";
+	struct stat status;
+	if (fileHasContents(sourceFileName, source) && (0 == stat(libraryFileName.c_str(), &status)))
+	{
+		void *library = dlopen(libraryFileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (library)
+			return library;
+	}
+	// write and compile to process-unique names then rename for concurrent processes
+	std::ostringstream uniqueSuffix;
+	uniqueSuffix << "." << static_cast<long>(getpid());
+	const std::string tmpSourceFileName = baseName + uniqueSuffix.str() + ".cpp";
+	const std::string tmpLibraryFileName = baseName + uniqueSuffix.str() + ".so";
+	{
+		std::ofstream file(tmpSourceFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+			return nullptr;
+		file << source;
+		if (!file)
+			return nullptr;
+	}
+	const std::string command = compiler + " -O2 -w -shared -fPIC -o '" + tmpLibraryFileName +
+		"' '" + tmpSourceFileName + "' > /dev/null 2>&1";
+	void *library = nullptr;
+	if ((0 == system(command.c_str())) &&
+		(0 == rename(tmpLibraryFileName.c_str(), libraryFileName.c_str())) &&
+		(0 == rename(tmpSourceFileName.c_str(), sourceFileName.c_str())))
+	{
+		library = dlopen(libraryFileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+	}
+	remove(tmpSourceFileName.c_str());
+	remove(tmpLibraryFileName.c_str());
+	return library;
+}
+
+} // anonymous namespace
+
+const FieldExpressionKernel *FieldExpressionKernel::get(const FieldEvaluationPlan& plan,
+	std::vector<int>& inputInstructions)
+{
+	if (sizeof(FE_value) != sizeof(double))
+		return nullptr;
+	int inputCount, workCount;
+	const std::string source = FieldExpressionKernel::generateSource(plan, inputInstructions, inputCount, workCount);
+	if (source.empty())
+		return nullptr;
+	std::lock_guard<std::mutex> lock(kernelRegistryMutex);
+	std::map<std::string, FieldExpressionKernel *>::iterator iter = kernelRegistry.find(source);
+	if (iter != kernelRegistry.end())
+		return iter->second;
+	FieldExpressionKernel *kernel = nullptr;
+	void *library = loadKernelLibrary(source);
+	if (library)
+	{
+		ValuesFunction valuesFunction = reinterpret_cast<ValuesFunction>(dlsym(library, "zinc_field_kernel_values"));
+		DerivativesFunction derivativesFunction = reinterpret_cast<DerivativesFunction>(dlsym(library, "zinc_field_kernel_derivatives"));
+		if ((valuesFunction) && (derivativesFunction))
+			kernel = new FieldExpressionKernel(valuesFunction, derivativesFunction, inputCount, workCount);
+		else
+			dlclose(library);
+	}
+	kernelRegistry[source] = kernel;
+	return kernel;
+}
+
+#else
+
+const FieldExpressionKernel *FieldExpressionKernel::get(const FieldEvaluationPlan& /*plan*/,
+	std::vector<int>& inputInstructions)
+{
+	inputInstructions.clear();
+	return nullptr;
+}
+
+#endif /* defined (ZINC_USE_FIELD_KERNEL_COMPILER) && defined (UNIX) */
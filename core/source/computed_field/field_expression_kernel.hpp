@@ -0,0 +1,114 @@
+/**
+ * FILE : field_expression_kernel.hpp
+ *
+ * Optional backend generating C++ source for the arithmetic part of a field
+ * evaluation plan, compiling it with the system compiler and loading it as a
+ * kernel evaluating values and first derivatives from arrays of input values.
+ * Compiled kernels are cached on disk keyed by a hash of their source.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__FIELD_EXPRESSION_KERNEL_HPP__)
+#define __FIELD_EXPRESSION_KERNEL_HPP__
+
+#include "opencmiss/zinc/zincconfigure.h"
+#include <string>
+#include <vector>
+
+class FieldEvaluationPlan;
+
+/**
+ * Compiled kernel for a field evaluation plan. Inputs are the values of the
+ * plan's constant and non-arithmetic leaf instructions, which are evaluated
+ * normally. Kernels are owned by a process-wide registry and are never
+ * unloaded.
+ * Only available if built with ZINC_USE_FIELD_KERNEL_COMPILER on UNIX.
+ * Environment variable ZINC_FIELD_KERNEL_COMPILER sets the compiler command,
+ * default c++, or disables kernels if empty. ZINC_FIELD_KERNEL_CACHE sets the
+ * directory for the disk cache, by default a per-user directory in TMPDIR.
+ */
+class FieldExpressionKernel
+{
+public:
+	/** Evaluate results for pointCount points from inputs for each point. */
+	typedef void (*ValuesFunction)(int pointCount, const FE_value *inputs, FE_value *results);
+
+	/** Evaluate results and their termCount derivatives for pointCount points
+	 * from inputs and their derivatives for each point. Work must have space
+	 * for workCount*termCount values. */
+	typedef void (*DerivativesFunction)(int pointCount, int termCount,
+		const FE_value *inputs, const FE_value *inputDerivatives,
+		FE_value *results, FE_value *resultDerivatives, FE_value *work);
+
+private:
+	ValuesFunction valuesFunction;
+	DerivativesFunction derivativesFunction;
+	int inputCount;  // number of input values per point
+	int workCount;  // number of intermediate values needing derivative work space
+
+	FieldExpressionKernel(ValuesFunction valuesFunctionIn, DerivativesFunction derivativesFunctionIn,
+		int inputCountIn, int workCountIn) :
+		valuesFunction(valuesFunctionIn),
+		derivativesFunction(derivativesFunctionIn),
+		inputCount(inputCountIn),
+		workCount(workCountIn)
+	{
+	}
+
+	FieldExpressionKernel();  // not implemented
+	FieldExpressionKernel(const FieldExpressionKernel &source);  // not implemented
+	FieldExpressionKernel& operator=(const FieldExpressionKernel &source);  // not implemented
+
+public:
+
+	/**
+	 * Generate C++ source for kernel evaluating plan.
+	 * @param inputInstructions  On return, indexes of instructions in the plan
+	 * whose values are inputs to the kernel, in order.
+	 * @param inputCount  On return, number of input values.
+	 * @param workCount  On return, number of derivative work values per term.
+	 * @return  Kernel source, or empty string if the plan has instructions
+	 * which cannot be generated, or nothing worth compiling.
+	 */
+	static std::string generateSource(const FieldEvaluationPlan& plan,
+		std::vector<int>& inputInstructions, int& inputCount, int& workCount);
+
+	/**
+	 * Get kernel for plan, generating, compiling and loading it if not already
+	 * done in this process, or loading it from the disk cache.
+	 * @param inputInstructions  On return, indexes of instructions in the plan
+	 * whose values are inputs to the kernel, in order.
+	 * @return  Non-owned kernel, or nullptr if not available.
+	 */
+	static const FieldExpressionKernel *get(const FieldEvaluationPlan& plan,
+		std::vector<int>& inputInstructions);
+
+	int getInputCount() const
+	{
+		return this->inputCount;
+	}
+
+	int getWorkCount() const
+	{
+		return this->workCount;
+	}
+
+	void evaluate(int pointCount, const FE_value *inputs, FE_value *results) const
+	{
+		(this->valuesFunction)(pointCount, inputs, results);
+	}
+
+	void evaluateDerivatives(int pointCount, int termCount,
+		const FE_value *inputs, const FE_value *inputDerivatives,
+		FE_value *results, FE_value *resultDerivatives, FE_value *work) const
+	{
+		(this->derivativesFunction)(pointCount, termCount, inputs, inputDerivatives,
+			results, resultDerivatives, work);
+	}
+
+};
+
+#endif /* !defined (__FIELD_EXPRESSION_KERNEL_HPP__) */
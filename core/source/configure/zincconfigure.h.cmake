@@ -31,6 +31,7 @@
 #cmakedefine ZINC_USE_NETGEN
 #cmakedefine USE_GLEW
 #cmakedefine ZINC_USE_PNG
+#cmakedefine ZINC_USE_FIELD_KERNEL_COMPILER
 
 // Miscellaneous defines
 #cmakedefine HAVE_VFSCANF
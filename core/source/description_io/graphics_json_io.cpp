@@ -751,6 +751,20 @@ void GraphicsJsonIO::ioStreamlinesEntries(Json::Value &graphicsSettings)
 			}
 			double value = streamlines.getTrackLength();
 			attributesSettings["TrackLength"] = value;
+			attributesSettings["Tolerance"] = streamlines.getTolerance();
+			attributesSettings["MaximumNumberOfSteps"] = streamlines.getMaximumNumberOfSteps();
+			enumString = cmzn_graphics_streamlines_trace_mode_enum_to_string(
+				(enum cmzn_graphics_streamlines_trace_mode)streamlines.getTraceMode());
+			if (enumString)
+			{
+				attributesSettings["TraceMode"] = enumString;
+				DEALLOCATE(enumString);
+			}
+			else
+			{
+				attributesSettings["TraceMode"] = "";
+			}
+			attributesSettings["PathTimeStep"] = streamlines.getPathTimeStep();
 			graphicsSettings["Streamlines"] = attributesSettings;
 		}
 		else if (graphicsSettings["Streamlines"].isObject())
@@ -771,18 +785,38 @@ void GraphicsJsonIO::ioStreamlinesEntries(Json::Value &graphicsSettings)
 							attributesSettings["ColourDataType"].asCString())));
 			if (attributesSettings["TrackLength"].isDouble())
 				streamlines.setTrackLength(attributesSettings["TrackLength"].asDouble());
+			if (attributesSettings["Tolerance"].isDouble())
+				streamlines.setTolerance(attributesSettings["Tolerance"].asDouble());
+			if (attributesSettings["MaximumNumberOfSteps"].isInt())
+				streamlines.setMaximumNumberOfSteps(attributesSettings["MaximumNumberOfSteps"].asInt());
+			if (attributesSettings["TraceMode"].isString())
+				streamlines.setTraceMode(
+					static_cast<OpenCMISS::Zinc::GraphicsStreamlines::TraceMode>(
+						cmzn_graphics_streamlines_trace_mode_enum_from_string(
+							attributesSettings["TraceMode"].asCString())));
+			if (attributesSettings["PathTimeStep"].isDouble())
+				streamlines.setPathTimeStep(attributesSettings["PathTimeStep"].asDouble());
 		}
 	}
 }
 
 void GraphicsJsonIO::ioSurfacesEntries(Json::Value &graphicsSettings)
 {
-	if (mode == IO_MODE_EXPORT)
+	OpenCMISS::Zinc::GraphicsSurfaces surfaces = graphics.castSurfaces();
+	if (surfaces.isValid())
 	{
-		OpenCMISS::Zinc::GraphicsSurfaces surfaces = graphics.castSurfaces();
-		if (surfaces.isValid())
+		if (mode == IO_MODE_EXPORT)
+		{
+			Json::Value attributesSettings = Json::Value(Json::objectValue);
+			if (surfaces.isSharedVertices())
+				attributesSettings["SharedVertices"] = true;
+			graphicsSettings["Surfaces"] = attributesSettings;
+		}
+		else if (graphicsSettings["Surfaces"].isObject())
 		{
-			graphicsSettings["Surfaces"] = Json::Value(Json::objectValue);
+			Json::Value attributesSettings = graphicsSettings["Surfaces"];
+			if (attributesSettings["SharedVertices"].isBool())
+				surfaces.setSharedVertices(attributesSettings["SharedVertices"].asBool());
 		}
 	}
 }
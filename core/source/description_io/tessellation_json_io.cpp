@@ -22,6 +22,9 @@ void TessellationJsonIO::ioEntries(Json::Value &tessellationSettings)
 		char *name = tessellation.getName();
 		tessellationSettings["Name"] = name;
 		DEALLOCATE(name);
+		const double adaptiveTolerance = tessellation.getAdaptiveTolerance();
+		if (adaptiveTolerance != 0.0)
+			tessellationSettings["AdaptiveTolerance"] = adaptiveTolerance;
 		tessellationSettings["CircleDivisions"] = tessellation.getCircleDivisions();
 		int valuesCount = tessellation.getMinimumDivisions(0, 0);
 		int *intValues = new int[valuesCount];
@@ -46,6 +49,10 @@ void TessellationJsonIO::ioEntries(Json::Value &tessellationSettings)
 		{
 			tessellation.setName(tessellationSettings["Name"].asCString());
 		}
+		if (tessellationSettings["AdaptiveTolerance"].isDouble())
+		{
+			tessellation.setAdaptiveTolerance(tessellationSettings["AdaptiveTolerance"].asDouble());
+		}
 		if (tessellationSettings["CircleDivisions"].isInt())
 		{
 			tessellation.setCircleDivisions(tessellationSettings["CircleDivisions"].asInt());
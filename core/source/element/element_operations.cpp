@@ -279,6 +279,7 @@ IntegrationShapePoints *IntegrationPointsCache::getPoints(cmzn_element *element)
 			int numPoints = 0;
 			FE_value *points = 0;
 			FE_value *weights = 0;
+			std::vector<FE_value> gridXi;
 			switch (shape_type)
 			{
 				case CMZN_ELEMENT_SHAPE_TYPE_LINE:
@@ -307,6 +308,9 @@ IntegrationShapePoints *IntegrationPointsCache::getPoints(cmzn_element *element)
 							shift_g /= useNumbersOfPoints[i];
 						}
 					}
+					for (int i = 0; i < dimension; ++i)
+						for (int g = 0; g < useNumbersOfPoints[i]; ++g)
+							gridXi.push_back(lineGaussPt[order_offset[i] + g].location);
 				} break;
 				case CMZN_ELEMENT_SHAPE_TYPE_TRIANGLE:
 				{
@@ -400,6 +404,7 @@ IntegrationShapePoints *IntegrationPointsCache::getPoints(cmzn_element *element)
 				} break;
 			}
 			shapePoints = new IntegrationShapePoints(shape, useNumbersOfPoints, numPoints, points, weights);
+			shapePoints->gridXi.swap(gridXi);
 		} break;
 	case CMZN_ELEMENT_QUADRATURE_RULE_MIDPOINT:
 		{
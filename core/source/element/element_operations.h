@@ -36,6 +36,9 @@ protected:
 	int numPoints;
 	FE_value *points;
 	FE_value *weights;
+	// if points are a tensor product grid with xi1 varying fastest: the
+	// numbersOfPoints xi coordinates in each direction in turn; otherwise empty
+	std::vector<FE_value> gridXi;
 
 public:
 	typedef bool (*InvokeFunction)(void *, FE_value *xi, FE_value weight);
@@ -64,6 +67,38 @@ public:
 		return this->numPoints;
 	}
 
+	const int *getNumbersOfPoints() const
+	{
+		return this->numbersOfPoints;
+	}
+
+	/** @return  True if points are a tensor product grid with xi1 varying
+	 * fastest, so fields can be evaluated at all points with grid methods. */
+	bool isGrid() const
+	{
+		return !this->gridXi.empty();
+	}
+
+	/** Get xi coordinates of grid points along a direction.
+	 * @return  Pointer to numbersOfPoints[xiIndex] coordinates, or nullptr
+	 * if not a grid. */
+	const FE_value *getGridXi(int xiIndex) const
+	{
+		if (this->gridXi.empty() || (xiIndex < 0) || (xiIndex >= this->dimension))
+			return nullptr;
+		int offset = 0;
+		for (int i = 0; i < xiIndex; ++i)
+			offset += this->numbersOfPoints[i];
+		return this->gridXi.data() + offset;
+	}
+
+	/** @return  Xi coordinates of all points in turn, or nullptr if points
+	 * are generated on the fly e.g. by subdividing simplices. */
+	const FE_value *getPoints() const
+	{
+		return this->points;
+	}
+
 	void getPoint(int index, FE_value *xi, FE_value *weight)
 	{
 		for (int i = 0; i < this->dimension; ++i)
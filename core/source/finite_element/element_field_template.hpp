@@ -19,6 +19,7 @@
 #include "general/value.h"
 #include "finite_element/finite_element_basis.hpp"
 #include "datastore/labels.hpp"
+#include <atomic>
 #include <vector>
 
 struct FE_basis;
@@ -53,7 +54,8 @@ class FE_element_field_template
 
 	friend int global_to_element_map_values(FE_field *field, int componentNumber,
 		const FE_element_field_template *eft, cmzn_element *element, FE_value time,
-		const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value*& elementValues);
+		const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value *workValues,
+		FE_value *elementValues);
 
 	friend int global_to_element_map_nodes(FE_field *field, int componentNumber,
 		const FE_element_field_template *eft, cmzn_element *element,
@@ -123,7 +125,8 @@ private:
 	int parameterFunctionTermsSize;  // size of parameterFunctionTerms, multiple of 2 for the pairs
 	int *parameterFunctionTerms;  // packed array of pairs (function index, term index) for each parameter term
 
-	int access_count;
+	// atomic so templates can be accessed by field caches on multiple threads
+	std::atomic<int> access_count;
 
 	FE_element_field_template(FE_mesh *meshIn, FE_basis *basisIn);
 
@@ -183,8 +186,7 @@ public:
 	{
 		if (!eft)
 			return CMZN_ERROR_ARGUMENT;
-		--(eft->access_count);
-		if (eft->access_count <= 0)
+		if (--(eft->access_count) <= 0)
 			delete eft;
 		eft = 0;
 		return CMZN_OK;
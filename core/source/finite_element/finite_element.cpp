@@ -1778,16 +1778,19 @@ static int list_FE_node_field(struct FE_node *node, struct FE_field *field,
  * @param element  The element to get values for.
  * @param time  The time at which to get parameter values.
  * @param nodeset  The nodeset owning any node indexes mapped.
- * @param elementValues  Pre-allocated array big enough for the number of basis
- * functions used by the EFT basis. Note this is a reference and will be
- * reallocated if basis uses a blending function. Either way, caller is
- * required to deallocate.
  * @param scaleFactors  Pointer to element scale factors.
+ * @param workValues  Pre-allocated array big enough for the number of basis
+ * functions used by the EFT basis, to receive unblended values if the basis
+ * uses a blending matrix. Not used otherwise.
+ * @param elementValues  Pre-allocated array big enough for the larger of the
+ * number of basis functions and number of blended functions used by the EFT
+ * basis, to receive the values to dot product with the standard basis.
  * @return  Number of values calculated or 0 if error.
  */
 int global_to_element_map_values(FE_field *field, int componentNumber,
 	const FE_element_field_template *eft, cmzn_element *element, FE_value time,
-	const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value*& elementValues)
+	const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value *workValues,
+	FE_value *elementValues)
 {
 	if (eft->getParameterMappingMode() != CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_NODE)
 	{
@@ -1824,6 +1827,8 @@ int global_to_element_map_values(FE_field *field, int componentNumber,
 	}
 
 	const int basisFunctionCount = eft->getNumberOfFunctions();
+	const int blendedElementValuesCount = FE_basis_get_number_of_blended_functions(basis);
+	FE_value *rawValues = (blendedElementValuesCount > 0) ? workValues : elementValues;
 	int lastLocalNodeIndex = -1;
 	FE_node *node = 0;
 	// Cache last node_field_info since expensive to find and probably same as last node
@@ -1906,28 +1911,24 @@ int global_to_element_map_values(FE_field *field, int componentNumber,
 			termSum += termValue;
 			++tt;
 		}
-		elementValues[f] = termSum;
+		rawValues[f] = termSum;
 	}
 	if (eft->getLegacyModifyThetaMode() != FE_BASIS_MODIFY_THETA_MODE_INVALID)
 	{
-		if (!FE_basis_modify_theta_in_xi1(eft->basis, eft->getLegacyModifyThetaMode(), elementValues))
+		if (!FE_basis_modify_theta_in_xi1(eft->basis, eft->getLegacyModifyThetaMode(), rawValues))
 		{
 			display_message(ERROR_MESSAGE, "global_to_element_map_values.  Error modifying element values");
 			return 0;
 		}
 	}
-	const int blendedElementValuesCount = FE_basis_get_number_of_blended_functions(basis);
 	if (blendedElementValuesCount > 0)
 	{
-		FE_value *blendedElementValues = FE_basis_get_blended_element_values(basis, elementValues);
-		if (!blendedElementValues)
+		if (!FE_basis_blend_element_values(basis, rawValues, elementValues))
 		{
 			display_message(ERROR_MESSAGE,
-				"global_to_element_map_values.  Could not allocate memory for blended values");
+				"global_to_element_map_values.  Could not calculate blended values");
 			return 0;
 		}
-		DEALLOCATE(elementValues);
-		elementValues = blendedElementValues;
 		return blendedElementValuesCount;
 	}
 	return basisFunctionCount;
@@ -15,6 +15,9 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 #include "opencmiss/zinc/zincconfigure.h"
 #include "finite_element/finite_element_basis.hpp"
@@ -30,6 +33,15 @@
 #include "general/mystring.h"
 #include "general/message.h"
 
+/* runtime selection of instruction set for evaluating monomials at blocks of
+ * points is supported with GCC or Clang on x86 */
+#if (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define MONOMIAL_BASIS_POINTS_DISPATCH
+#define MONOMIAL_BASIS_POINTS_INLINE inline __attribute__((always_inline))
+#else
+#define MONOMIAL_BASIS_POINTS_INLINE inline
+#endif
+
 /*
 Module types
 ------------
@@ -816,6 +828,267 @@ NB.  xi_1 is varying fastest (xi_n slowest)
 	return (return_code);
 } /* monomial_basis_functions */
 
+namespace {
+
+/** Number of monomial functions with ORDER in each of DIMENSION xi */
+template <int DIMENSION, int ORDER> struct Monomial_basis_size
+{
+	static const int value = (ORDER + 1)*Monomial_basis_size<DIMENSION - 1, ORDER>::value;
+};
+
+template <int ORDER> struct Monomial_basis_size<0, ORDER>
+{
+	static const int value = 1;
+};
+
+/** Monomial basis values and optional first derivatives for fixed dimension
+ * and order, matching monomial_basis_functions with xi1 varying fastest.
+ * Constant loop bounds let the compiler fully unroll these. */
+template <int DIMENSION, int ORDER>
+void monomial_basis_kernel(const FE_value *xi_coordinates, int derivative_order,
+	FE_value *function_values)
+{
+	const int size = Monomial_basis_size<DIMENSION, ORDER>::value;
+	FE_value powers[3][ORDER + 1];
+	FE_value power_derivatives[3][ORDER + 1];
+	for (int d = 0; d < DIMENSION; ++d)
+	{
+		powers[d][0] = 1.0;
+		power_derivatives[d][0] = 0.0;
+		for (int o = 1; o <= ORDER; ++o)
+		{
+			powers[d][o] = powers[d][o - 1]*xi_coordinates[d];
+			power_derivatives[d][o] = static_cast<FE_value>(o)*powers[d][o - 1];
+		}
+	}
+	for (int d = DIMENSION; d < 3; ++d)
+	{
+		for (int o = 0; o <= ORDER; ++o)
+		{
+			powers[d][o] = (o == 0) ? 1.0 : 0.0;
+			power_derivatives[d][o] = 0.0;
+		}
+	}
+	const int n3 = (DIMENSION > 2) ? ORDER + 1 : 1;
+	const int n2 = (DIMENSION > 1) ? ORDER + 1 : 1;
+	FE_value *value = function_values;
+	for (int k = 0; k < n3; ++k)
+		for (int j = 0; j < n2; ++j)
+		{
+			const FE_value p23 = powers[1][j]*powers[2][k];
+			for (int i = 0; i <= ORDER; ++i)
+				*value++ = powers[0][i]*p23;
+		}
+	if (derivative_order > 0)
+	{
+		for (int d = 0; d < DIMENSION; ++d)
+		{
+			const FE_value *p1 = (d == 0) ? power_derivatives[0] : powers[0];
+			const FE_value *p2 = (d == 1) ? power_derivatives[1] : powers[1];
+			const FE_value *p3 = (d == 2) ? power_derivatives[2] : powers[2];
+			FE_value *derivative = function_values + (d + 1)*size;
+			for (int k = 0; k < n3; ++k)
+				for (int j = 0; j < n2; ++j)
+				{
+					const FE_value p23 = p2[j]*p3[k];
+					for (int i = 0; i <= ORDER; ++i)
+						*derivative++ = p1[i]*p23;
+				}
+		}
+	}
+}
+
+/** Maximum order in any xi of monomials evaluated at blocks of points */
+const int MONOMIAL_BASIS_POINTS_MAXIMUM_ORDER = 3;
+
+typedef void (Monomial_basis_points_kernel)(int dimension, const int *orders, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results);
+
+/** Body of monomial basis evaluation and dot product for a block of points,
+ * inlined into copies compiled for each instruction set. Loops over points are
+ * innermost with a fixed count so the compiler vectorises them.
+ * @param orders  Order in each of 3 xi, 0 for xi beyond the dimension. */
+MONOMIAL_BASIS_POINTS_INLINE void monomial_basis_points_body(int dimension, const int *orders,
+	const FE_value *xi, const FE_value *element_values, int derivative_order, FE_value *results)
+{
+	const int BLOCK = MONOMIAL_BASIS_POINTS_BLOCK_SIZE;
+	FE_value powers[3][MONOMIAL_BASIS_POINTS_MAXIMUM_ORDER + 1][BLOCK];
+	FE_value power_derivatives[3][MONOMIAL_BASIS_POINTS_MAXIMUM_ORDER + 1][BLOCK];
+	for (int d = 0; d < 3; ++d)
+	{
+		for (int p = 0; p < BLOCK; ++p)
+		{
+			powers[d][0][p] = 1.0;
+			power_derivatives[d][0][p] = 0.0;
+		}
+		for (int o = 1; o <= orders[d]; ++o)
+		{
+			const FE_value factor = static_cast<FE_value>(o);
+			for (int p = 0; p < BLOCK; ++p)
+			{
+				powers[d][o][p] = powers[d][o - 1][p]*xi[d*BLOCK + p];
+				power_derivatives[d][o][p] = factor*powers[d][o - 1][p];
+			}
+		}
+	}
+	FE_value values[BLOCK];
+	FE_value derivatives[3][BLOCK];
+	for (int p = 0; p < BLOCK; ++p)
+	{
+		values[p] = 0.0;
+		derivatives[0][p] = 0.0;
+		derivatives[1][p] = 0.0;
+		derivatives[2][p] = 0.0;
+	}
+	const FE_value *element_value = element_values;
+	for (int k = 0; k <= orders[2]; ++k)
+		for (int j = 0; j <= orders[1]; ++j)
+		{
+			FE_value p23[BLOCK];
+			for (int p = 0; p < BLOCK; ++p)
+				p23[p] = powers[1][j][p]*powers[2][k][p];
+			if (derivative_order)
+			{
+				FE_value dp2_p3[BLOCK], p2_dp3[BLOCK];
+				for (int p = 0; p < BLOCK; ++p)
+				{
+					dp2_p3[p] = power_derivatives[1][j][p]*powers[2][k][p];
+					p2_dp3[p] = powers[1][j][p]*power_derivatives[2][k][p];
+				}
+				for (int i = 0; i <= orders[0]; ++i)
+				{
+					const FE_value c = *element_value++;
+					for (int p = 0; p < BLOCK; ++p)
+					{
+						const FE_value cp1 = c*powers[0][i][p];
+						values[p] += cp1*p23[p];
+						derivatives[0][p] += c*power_derivatives[0][i][p]*p23[p];
+						derivatives[1][p] += cp1*dp2_p3[p];
+						derivatives[2][p] += cp1*p2_dp3[p];
+					}
+				}
+			}
+			else
+			{
+				for (int i = 0; i <= orders[0]; ++i)
+				{
+					const FE_value c = *element_value++;
+					for (int p = 0; p < BLOCK; ++p)
+						values[p] += c*powers[0][i][p]*p23[p];
+				}
+			}
+		}
+	for (int p = 0; p < BLOCK; ++p)
+		results[p] = values[p];
+	if (derivative_order)
+		for (int d = 0; d < dimension; ++d)
+			for (int p = 0; p < BLOCK; ++p)
+				results[(d + 1)*BLOCK + p] = derivatives[d][p];
+}
+
+void monomial_basis_points_scalar(int dimension, const int *orders, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results)
+{
+	monomial_basis_points_body(dimension, orders, xi, element_values, derivative_order, results);
+}
+
+#if defined (MONOMIAL_BASIS_POINTS_DISPATCH)
+__attribute__((target("avx2,fma")))
+void monomial_basis_points_avx2(int dimension, const int *orders, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results)
+{
+	monomial_basis_points_body(dimension, orders, xi, element_values, derivative_order, results);
+}
+
+__attribute__((target("avx512f")))
+void monomial_basis_points_avx512(int dimension, const int *orders, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results)
+{
+	monomial_basis_points_body(dimension, orders, xi, element_values, derivative_order, results);
+}
+#endif /* defined (MONOMIAL_BASIS_POINTS_DISPATCH) */
+
+struct Monomial_basis_points_implementation
+{
+	Monomial_basis_points_kernel *kernel;
+	const char *instruction_set;
+
+	Monomial_basis_points_implementation() :
+		kernel(monomial_basis_points_scalar),
+		instruction_set("scalar")
+	{
+#if defined (MONOMIAL_BASIS_POINTS_DISPATCH)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			this->kernel = monomial_basis_points_avx512;
+			this->instruction_set = "avx512";
+		}
+		else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		{
+			this->kernel = monomial_basis_points_avx2;
+			this->instruction_set = "avx2";
+		}
+#endif /* defined (MONOMIAL_BASIS_POINTS_DISPATCH) */
+	}
+};
+
+/** Get implementation for this processor, selected on first use. */
+const Monomial_basis_points_implementation& get_monomial_basis_points_implementation()
+{
+	static const Monomial_basis_points_implementation implementation;
+	return implementation;
+}
+
+} // anonymous namespace
+
+Standard_basis_kernel *get_standard_basis_kernel(
+	Standard_basis_function *standard_basis_function, const int *arguments)
+{
+	if ((standard_basis_function != monomial_basis_functions) || (!arguments))
+		return 0;
+	const int dimension = arguments[0];
+	if ((dimension < 1) || (dimension > 3))
+		return 0;
+	const int order = arguments[1];
+	for (int d = 2; d <= dimension; ++d)
+		if (arguments[d] != order)
+			return 0;
+	static Standard_basis_kernel *const kernels[3][3] =
+	{
+		{ monomial_basis_kernel<1, 1>, monomial_basis_kernel<1, 2>, monomial_basis_kernel<1, 3> },
+		{ monomial_basis_kernel<2, 1>, monomial_basis_kernel<2, 2>, monomial_basis_kernel<2, 3> },
+		{ monomial_basis_kernel<3, 1>, monomial_basis_kernel<3, 2>, monomial_basis_kernel<3, 3> }
+	};
+	if ((order < 1) || (order > 3))
+		return 0;
+	return kernels[dimension - 1][order - 1];
+}
+
+bool monomial_basis_points_dot_product(const int *arguments, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results)
+{
+	if (!((arguments) && (xi) && (element_values) && (results)))
+		return false;
+	const int dimension = arguments[0];
+	if ((dimension < 1) || (dimension > 3))
+		return false;
+	int orders[3] = { 0, 0, 0 };
+	for (int d = 0; d < dimension; ++d)
+	{
+		orders[d] = arguments[d + 1];
+		if ((orders[d] < 0) || (orders[d] > MONOMIAL_BASIS_POINTS_MAXIMUM_ORDER))
+			return false;
+	}
+	(get_monomial_basis_points_implementation().kernel)(dimension, orders, xi, element_values, derivative_order, results);
+	return true;
+}
+
+const char *monomial_basis_points_instruction_set()
+{
+	return get_monomial_basis_points_implementation().instruction_set;
+}
+
 int polygon_basis_functions(void *type_arguments,
 	const FE_value *xi_coordinates, FE_value *function_values)
 /*******************************************************************************
@@ -1052,6 +1325,8 @@ const FE_value *Standard_basis_function_evaluation::evaluate_full(
 				}
 			}
 		}
+		this->standard_basis_kernel = get_standard_basis_kernel(this->standard_basis_function,
+			this->standard_basis_function_arguments);
 		this->derivative_order_evaluated = -1;
 	}
 	const int number_of_values_to_allocate = this->get_derivatives_offset(this->derivative_order_maximum + 1);
@@ -1066,6 +1341,18 @@ const FE_value *Standard_basis_function_evaluation::evaluate_full(
 		this->basis_function_values = new_basis_function_values;
 		this->number_of_values_allocated = number_of_values_to_allocate;
 	}
+	if ((this->standard_basis_kernel) && (derivative_order_in <= 1))
+	{
+		// specialised evaluation of values and first derivatives together
+		(this->standard_basis_kernel)(xi_coordinates, derivative_order_in, this->basis_function_values);
+		if (derivative_order_in <= 0)
+		{
+			this->derivative_order_evaluated = 0;
+			return this->basis_function_values;
+		}
+		this->derivative_order_evaluated = 1;
+		return this->basis_function_values + this->number_of_basis_functions;
+	}
 	if (this->derivative_order_evaluated < 0)
 	{
 		(this->standard_basis_function)(static_cast<void *>(this->standard_basis_function_arguments), xi_coordinates, this->basis_function_values);
@@ -1135,6 +1422,200 @@ const FE_value *Standard_basis_function_evaluation::evaluate_full(
 	return source_basis_function_values;
 }
 
+Standard_basis_table::Standard_basis_table(Standard_basis_function *standard_basis_function,
+	const int *standard_basis_function_arguments, int pointCountIn,
+	const FE_value *xi, int derivativeOrderIn) :
+	dimension(standard_basis_function_arguments[0]),
+	functionCount(0),
+	pointCount(pointCountIn),
+	derivativeOrder((derivativeOrderIn > 0) ? 1 : 0)
+{
+	if ((!standard_basis_function) || (pointCount <= 0) || (!xi)
+		|| (this->dimension < 1) || (this->dimension > MAXIMUM_ELEMENT_XI_DIMENSIONS))
+		return;
+	this->pointXi.assign(xi, xi + this->pointCount*this->dimension);
+	Standard_basis_function_evaluation basis_function_evaluation;
+	const int blockCount = (this->derivativeOrder) ? this->dimension + 1 : 1;
+	for (int p = 0; p < this->pointCount; ++p)
+	{
+		const FE_value *pointXi = xi + p*this->dimension;
+		basis_function_evaluation.invalidate();
+		const FE_value *values = basis_function_evaluation.evaluate(standard_basis_function,
+			standard_basis_function_arguments, pointXi, 0);
+		if (!values)
+		{
+			this->tableValues.clear();
+			return;
+		}
+		if (p == 0)
+		{
+			this->functionCount = basis_function_evaluation.get_number_of_basis_functions();
+			this->tableValues.resize(blockCount*this->pointCount*this->functionCount);
+		}
+		const int blockSize = this->pointCount*this->functionCount;
+		FE_value *row = this->tableValues.data() + p*this->functionCount;
+		memcpy(row, values, this->functionCount*sizeof(FE_value));
+		if (this->derivativeOrder)
+		{
+			const FE_value *derivatives = basis_function_evaluation.evaluate(standard_basis_function,
+				standard_basis_function_arguments, pointXi, 1);
+			if (!derivatives)
+			{
+				this->tableValues.clear();
+				return;
+			}
+			for (int d = 0; d < this->dimension; ++d)
+				memcpy(row + (d + 1)*blockSize, derivatives + d*this->functionCount, this->functionCount*sizeof(FE_value));
+		}
+	}
+}
+
+bool Standard_basis_table::hasPoints(int pointCountIn, const FE_value *xi) const
+{
+	return (pointCountIn == this->pointCount)
+		&& (0 == memcmp(xi, this->pointXi.data(), this->pointXi.size()*sizeof(FE_value)));
+}
+
+void Standard_basis_table::multiply(int block, int componentCount, const FE_value *const *componentValues,
+	FE_value *results, int pointStride, int componentStride) const
+{
+	const FE_value *blockValues = this->tableValues.data() + block*this->pointCount*this->functionCount;
+	for (int p = 0; p < this->pointCount; ++p)
+	{
+		const FE_value *row = blockValues + p*this->functionCount;
+		FE_value *pointResults = results + p*pointStride;
+		for (int c = 0; c < componentCount; ++c)
+		{
+			const FE_value *values = componentValues[c];
+			FE_value sum = 0.0;
+			for (int f = 0; f < this->functionCount; ++f)
+				sum += row[f]*values[f];
+			pointResults[c*componentStride] = sum;
+		}
+	}
+}
+
+namespace {
+
+/** Identifies a basis table by basis, derivative order and a hash of the xi
+ * point values so identical point sets from any source share a table. */
+struct Standard_basis_table_key
+{
+	Standard_basis_function *standard_basis_function;
+	int arguments[MAXIMUM_ELEMENT_XI_DIMENSIONS + 1];
+	int derivativeOrder;
+	int pointCount;
+	size_t xiHash;
+
+	bool operator==(const Standard_basis_table_key& other) const
+	{
+		return (this->xiHash == other.xiHash)
+			&& (this->standard_basis_function == other.standard_basis_function)
+			&& (this->derivativeOrder == other.derivativeOrder)
+			&& (this->pointCount == other.pointCount)
+			&& (0 == memcmp(this->arguments, other.arguments, sizeof(this->arguments)));
+	}
+};
+
+struct Standard_basis_table_key_hash
+{
+	size_t operator()(const Standard_basis_table_key& key) const
+	{
+		return key.xiHash ^ (std::hash<Standard_basis_function *>()(key.standard_basis_function)
+			+ static_cast<size_t>(key.derivativeOrder));
+	}
+};
+
+/** @return  FNV-1a hash of the bytes of valueCount xi values. */
+size_t get_xi_hash(int valueCount, const FE_value *xi)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *>(xi);
+	const size_t byteCount = valueCount*sizeof(FE_value);
+	for (size_t i = 0; i < byteCount; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+typedef std::unordered_map<Standard_basis_table_key, std::shared_ptr<const Standard_basis_table>,
+	Standard_basis_table_key_hash> Standard_basis_table_map;
+
+/** Limit on memory used by each thread's cached tables before unused tables
+ * are discarded */
+const size_t STANDARD_BASIS_TABLE_CACHE_MEMORY_LIMIT = 32*1024*1024;
+
+/** Basis tables cached for one thread, so lookups need no locking */
+struct Standard_basis_table_cache
+{
+	Standard_basis_table_map tables;
+	size_t memorySize;
+
+	Standard_basis_table_cache() :
+		memorySize(0)
+	{
+	}
+};
+
+thread_local Standard_basis_table_cache standard_basis_table_cache;
+
+}
+
+std::shared_ptr<const Standard_basis_table> get_standard_basis_table(
+	Standard_basis_function *standard_basis_function,
+	const int *standard_basis_function_arguments, int pointCount,
+	const FE_value *xi, int derivativeOrder)
+{
+	if ((!standard_basis_function) || (!standard_basis_function_arguments) || (pointCount <= 0) || (!xi)
+		|| (standard_basis_function_arguments[0] < 1)
+		|| (standard_basis_function_arguments[0] > MAXIMUM_ELEMENT_XI_DIMENSIONS))
+	{
+		display_message(ERROR_MESSAGE, "get_standard_basis_table.  Invalid argument(s)");
+		return std::shared_ptr<const Standard_basis_table>();
+	}
+	const int dimension = standard_basis_function_arguments[0];
+	Standard_basis_table_key key;
+	key.standard_basis_function = standard_basis_function;
+	for (int i = 0; i <= MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+		key.arguments[i] = (i <= dimension) ? standard_basis_function_arguments[i] : 0;
+	key.derivativeOrder = (derivativeOrder > 0) ? 1 : 0;
+	key.pointCount = pointCount;
+	key.xiHash = get_xi_hash(pointCount*dimension, xi);
+	Standard_basis_table_cache& cache = standard_basis_table_cache;
+	Standard_basis_table_map::const_iterator iter = cache.tables.find(key);
+	const bool hashCollision = (iter != cache.tables.end()) && (!iter->second->hasPoints(pointCount, xi));
+	if ((iter != cache.tables.end()) && (!hashCollision))
+		return iter->second;
+	std::shared_ptr<const Standard_basis_table> table(new Standard_basis_table(
+		standard_basis_function, standard_basis_function_arguments, pointCount, xi, key.derivativeOrder));
+	if (!table->isValid())
+		return std::shared_ptr<const Standard_basis_table>();
+	// different points with the same hash are rare: use table without caching it
+	if (hashCollision)
+		return table;
+	const size_t tableMemorySize = table->getMemorySize();
+	if (cache.memorySize + tableMemorySize > STANDARD_BASIS_TABLE_CACHE_MEMORY_LIMIT)
+	{
+		// discard tables not currently in use
+		Standard_basis_table_map::iterator discardIter = cache.tables.begin();
+		while (discardIter != cache.tables.end())
+		{
+			if (discardIter->second.use_count() == 1)
+			{
+				cache.memorySize -= discardIter->second->getMemorySize();
+				discardIter = cache.tables.erase(discardIter);
+			}
+			else
+				++discardIter;
+		}
+	}
+	cache.tables[key] = table;
+	cache.memorySize += tableMemorySize;
+	return table;
+}
+
 DECLARE_LOCAL_MANAGER_FUNCTIONS(FE_basis)
 
 const int *FE_basis_get_basis_type(struct FE_basis *basis)
@@ -1158,28 +1639,22 @@ int FE_basis_get_number_of_blended_functions(struct FE_basis *basis)
 	return basis->number_of_standard_basis_functions;
 }
 
-FE_value *FE_basis_get_blended_element_values(struct FE_basis *basis,
-	const FE_value *raw_element_values)
+int FE_basis_blend_element_values(struct FE_basis *basis,
+	const FE_value *raw_element_values, FE_value *blended_element_values)
 {
 	if ((!basis) || (0 >= basis->number_of_basis_functions) ||
 		(!basis->standard_basis) || (!basis->blending_matrix) ||
 		(basis->number_of_standard_basis_functions < basis->number_of_basis_functions))
 	{
-		display_message(ERROR_MESSAGE, "FE_basis_get_blended_element_values.  Invalid basis.");
-		return 0;
-	}
-	if (!raw_element_values)
-	{
-		display_message(ERROR_MESSAGE, "FE_basis_get_blended_element_values.  Missing element values.");
+		display_message(ERROR_MESSAGE, "FE_basis_blend_element_values.  Invalid basis.");
 		return 0;
 	}
-	int number_of_blended_element_values = basis->number_of_standard_basis_functions;
-	FE_value *blended_element_values = 0;
-	ALLOCATE(blended_element_values, FE_value, number_of_blended_element_values);
-	if (!blended_element_values)
+	if ((!raw_element_values) || (!blended_element_values))
 	{
+		display_message(ERROR_MESSAGE, "FE_basis_blend_element_values.  Missing element values.");
 		return 0;
 	}
+	const int number_of_blended_element_values = basis->number_of_standard_basis_functions;
 	FE_value *blended_element_value = blended_element_values;
 	double sum;
 	const FE_value *element_value;
@@ -1202,6 +1677,24 @@ FE_value *FE_basis_get_blended_element_values(struct FE_basis *basis,
 		*blended_element_value = (FE_value)sum;
 		blended_element_value++;
 	}
+	return 1;
+}
+
+FE_value *FE_basis_get_blended_element_values(struct FE_basis *basis,
+	const FE_value *raw_element_values)
+{
+	const int number_of_blended_element_values = FE_basis_get_number_of_blended_functions(basis);
+	if (number_of_blended_element_values <= 0)
+	{
+		display_message(ERROR_MESSAGE, "FE_basis_get_blended_element_values.  Invalid basis.");
+		return 0;
+	}
+	FE_value *blended_element_values = 0;
+	ALLOCATE(blended_element_values, FE_value, number_of_blended_element_values);
+	if (!blended_element_values)
+		return 0;
+	if (!FE_basis_blend_element_values(basis, raw_element_values, blended_element_values))
+		DEALLOCATE(blended_element_values);
 	return blended_element_values;
 }
 
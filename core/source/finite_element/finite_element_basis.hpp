@@ -11,6 +11,8 @@
 #if !defined (FINITE_ELEMENT_BASIS_HPP)
 #define FINITE_ELEMENT_BASIS_HPP
 
+#include <memory>
+#include <vector>
 #include "opencmiss/zinc/types/elementbasisid.h"
 #include "opencmiss/zinc/types/nodeid.h"
 #include "finite_element/finite_element_constants.hpp"
@@ -55,6 +57,16 @@ enum FE_basis_type
 typedef int (Standard_basis_function)(/*type_arguments*/void *,
 	/*xi_coordinates*/const FE_value *, /*function_values*/FE_value *);
 
+/** Evaluates values of a monomial basis with dimension and order fixed at
+ * compile time, followed by first derivatives w.r.t. each xi in turn if
+ * derivative_order > 0. */
+typedef void (Standard_basis_kernel)(/*xi_coordinates*/const FE_value *,
+	/*derivative_order*/int, /*function_values*/FE_value *);
+
+/** Number of xi points evaluated together in structure of arrays layout by
+ * monomial_basis_points_dot_product. */
+const int MONOMIAL_BASIS_POINTS_BLOCK_SIZE = 8;
+
 /**
  * Stores the information for calculating basis function values from xi
  * coordinates. For each of basis there will be only one copy stored in a global
@@ -166,6 +178,7 @@ enum FE_basis_modify_theta_mode
 class Standard_basis_function_evaluation
 {
 	Standard_basis_function *standard_basis_function;  // Standard basis function pointer. 0 if cache invalid.
+	Standard_basis_kernel *standard_basis_kernel;  // specialised evaluation of basis and first derivatives, or 0 if none
 	int standard_basis_function_arguments[MAXIMUM_ELEMENT_XI_DIMENSIONS + 1];  // dimension, order1 ... orderN
 	int number_of_basis_functions;
 	FE_value *basis_function_values;
@@ -212,6 +225,7 @@ class Standard_basis_function_evaluation
 public:
 	Standard_basis_function_evaluation() :
 		standard_basis_function(0),
+		standard_basis_kernel(0),
 		number_of_basis_functions(0),
 		basis_function_values(0),
 		number_of_values_allocated(0),
@@ -256,8 +270,90 @@ public:
 		this->standard_basis_function = 0;
 		this->derivative_order_evaluated = -1;
 	}
+
+	/** @return  Number of basis functions for basis last evaluated. */
+	inline int get_number_of_basis_functions() const
+	{
+		return this->number_of_basis_functions;
+	}
+};
+
+/**
+ * Values and optionally first derivatives of a standard basis at a set of xi
+ * points, stored as dense matrices with a row of basis functions per point so
+ * interpolating at all points in an element is a matrix product of the table
+ * with element values. Immutable once created so can be shared between
+ * elements; get from get_standard_basis_table().
+ */
+class Standard_basis_table
+{
+	int dimension;
+	int functionCount;
+	int pointCount;
+	int derivativeOrder;
+	// xi of each point in turn, to check cache lookups
+	std::vector<FE_value> pointXi;
+	// values then derivatives w.r.t. each xi, each pointCount x functionCount
+	std::vector<FE_value> tableValues;
+
+	Standard_basis_table(const Standard_basis_table&);
+	Standard_basis_table& operator=(const Standard_basis_table&);
+
+public:
+	/** Evaluate basis at points. Check isValid() after construction. */
+	Standard_basis_table(Standard_basis_function *standard_basis_function,
+		const int *standard_basis_function_arguments, int pointCountIn,
+		const FE_value *xi, int derivativeOrderIn);
+
+	bool isValid() const
+	{
+		return !this->tableValues.empty();
+	}
+
+	int getFunctionCount() const
+	{
+		return this->functionCount;
+	}
+
+	int getPointCount() const
+	{
+		return this->pointCount;
+	}
+
+	/** @return  True if table was evaluated at exactly these xi points. */
+	bool hasPoints(int pointCountIn, const FE_value *xi) const;
+
+	size_t getMemorySize() const
+	{
+		return sizeof(*this) + (this->pointXi.capacity() + this->tableValues.capacity())*sizeof(FE_value);
+	}
+
+	/** Dense matrix product of a block of the table with values of several
+	 * components interpolated with this basis:
+	 * results[p*pointStride + c*componentStride] = sum_f table[p][f]*componentValues[c][f]
+	 * @param block  0 for values, 1..dimension for derivative w.r.t. that xi.
+	 * Must be 0 if table was created without derivatives. */
+	void multiply(int block, int componentCount, const FE_value *const *componentValues,
+		FE_value *results, int pointStride, int componentStride) const;
 };
 
+/**
+ * Get a basis table for standard basis function, arguments and xi points from
+ * a cache for the calling thread shared by all regions, creating it on first
+ * use. Elements sharing a basis and tessellation or quadrature points thus
+ * evaluate the basis only once per thread. Tables are found by a hash of the
+ * xi values, which are only compared in full with those of the matching
+ * table. Each thread's cache is bounded by memory, discarding all unused
+ * tables when full.
+ * @param xi  pointCount xi locations of basis dimension.
+ * @param derivativeOrder  0 for values only, 1 to include first derivatives.
+ * @return  Shared table, or empty pointer if basis could not be evaluated.
+ */
+std::shared_ptr<const Standard_basis_table> get_standard_basis_table(
+	Standard_basis_function *standard_basis_function,
+	const int *standard_basis_function_arguments, int pointCount,
+	const FE_value *xi, int derivativeOrder);
+
 /*
 Global functions
 ----------------
@@ -458,6 +554,90 @@ int monomial_basis_functions(void *type_arguments,
 int polygon_basis_functions(void *type_arguments,
 	const FE_value *xi_coordinates, FE_value *function_values);
 
+/** Get specialised kernel for evaluating standard basis function, currently
+ * only for monomials of dimension 1-3 with the same order 1-3 in each xi, as
+ * used by linear and quadratic Lagrange and cubic Hermite bases.
+ * @return  Kernel function or 0 if none for basis. */
+Standard_basis_kernel *get_standard_basis_kernel(
+	Standard_basis_function *standard_basis_function, const int *arguments);
+
+/** Calculate dot products of element values with each of number_of_products
+ * consecutive arrays of COUNT basis function values, e.g. for values then
+ * derivatives. With COUNT fixed the compiler can unroll and vectorise. */
+template <int COUNT>
+inline void standard_basis_dot_products_fixed(const FE_value *element_values,
+	const FE_value *basis_values, int number_of_products, FE_value *results)
+{
+	for (int k = 0; k < number_of_products; ++k)
+	{
+		FE_value sum = 0.0;
+		for (int j = 0; j < COUNT; ++j)
+			sum += element_values[j]*basis_values[j];
+		results[k] = sum;
+		basis_values += COUNT;
+	}
+}
+
+/** Calculate dot products of element values with each of number_of_products
+ * consecutive arrays of count basis function values. Inline with loops
+ * specialised for the counts of common linear, quadratic and cubic bases,
+ * selected once for all products. */
+inline void standard_basis_dot_products(const FE_value *element_values,
+	const FE_value *basis_values, int count, int number_of_products, FE_value *results)
+{
+	switch (count)
+	{
+	case 4: // bilinear
+		standard_basis_dot_products_fixed<4>(element_values, basis_values, number_of_products, results);
+		return;
+	case 8: // trilinear
+		standard_basis_dot_products_fixed<8>(element_values, basis_values, number_of_products, results);
+		return;
+	case 9: // biquadratic
+		standard_basis_dot_products_fixed<9>(element_values, basis_values, number_of_products, results);
+		return;
+	case 16: // bicubic
+		standard_basis_dot_products_fixed<16>(element_values, basis_values, number_of_products, results);
+		return;
+	case 27: // triquadratic
+		standard_basis_dot_products_fixed<27>(element_values, basis_values, number_of_products, results);
+		return;
+	case 64: // tricubic
+		standard_basis_dot_products_fixed<64>(element_values, basis_values, number_of_products, results);
+		return;
+	default:
+		break;
+	}
+	for (int k = 0; k < number_of_products; ++k)
+	{
+		FE_value sum = 0.0;
+		for (int j = 0; j < count; ++j)
+			sum += element_values[j]*basis_values[j];
+		results[k] = sum;
+		basis_values += count;
+	}
+}
+
+/** Evaluate a monomial interpolated value and optionally its first
+ * derivatives at a block of MONOMIAL_BASIS_POINTS_BLOCK_SIZE xi points at once.
+ * Points are held in structure of arrays layout so each step operates on all
+ * points in vector registers. Uses AVX-512 or AVX2 code paths if the processor
+ * supports them, selected at runtime, otherwise a scalar fallback.
+ * @param arguments  Monomial arguments: dimension 1-3 then order 0-3 in each xi.
+ * @param xi  Block of xi coordinates for each direction in turn. Unused points
+ * at the end of a partial block must still be set, e.g. to 0.
+ * @param element_values  Monomial coefficients with xi1 varying fastest.
+ * @param derivative_order  0 for values only, 1 to add first derivatives.
+ * @param results  Block of values then if derivative_order is 1, a block of
+ * derivatives w.r.t. each xi in turn.
+ * @return  True on success, false if basis arguments are not supported. */
+bool monomial_basis_points_dot_product(const int *arguments, const FE_value *xi,
+	const FE_value *element_values, int derivative_order, FE_value *results);
+
+/** @return  Name of instruction set used by monomial_basis_points_dot_product
+ * on this processor: "avx512", "avx2" or "scalar". */
+const char *monomial_basis_points_instruction_set();
+
 int standard_basis_function_is_monomial(Standard_basis_function *function,
 	void *arguments_void);
 /*******************************************************************************
@@ -492,6 +672,20 @@ int FE_basis_get_number_of_functions(struct FE_basis *basis);
  */
 int FE_basis_get_number_of_blended_functions(struct FE_basis *basis);
 
+/***************************************************************************//**
+ * Calculate blended element values by multiplying raw element values with the
+ * basis' blending matrix, into caller-supplied storage.
+ * @param basis  The finite element basis object.
+ * @param raw_element_values  Array of element values for unblended basis
+ * functions.
+ * @param blended_element_values  Array to receive blended element values,
+ * big enough for FE_basis_get_number_of_blended_functions. Must not overlap
+ * raw_element_values.
+ * @return  1 on success, 0 on failure.
+ */
+int FE_basis_blend_element_values(struct FE_basis *basis,
+	const FE_value *raw_element_values, FE_value *blended_element_values);
+
 /***************************************************************************//**
  * Calculate blended element values by multiplying raw element values with the
  * basis' blending matrix.
@@ -113,7 +113,7 @@ FE_field::~FE_field()
 {
 	if (0 != this->access_count)
 	{
-		display_message(ERROR_MESSAGE, "~FE_field.  Non-zero access_count (%d)", this->access_count);
+		display_message(ERROR_MESSAGE, "~FE_field.  Non-zero access_count (%d)", this->access_count.load());
 		return;
 	}
 	if (this->element_xi_host_mesh)
@@ -156,8 +156,7 @@ int FE_field::deaccess(FE_field **fieldAddress)
 {
 	if (!((fieldAddress) && (*fieldAddress)))
 		return 0;
-	--((*fieldAddress)->access_count);
-	if ((*fieldAddress)->access_count <= 0)
+	if (--((*fieldAddress)->access_count) <= 0)
 		delete *fieldAddress;
 	*fieldAddress = nullptr;
 	return 1;
@@ -406,7 +405,7 @@ FE_field_parameters *FE_field::get_FE_field_parameters()
 void FE_field::list() const
 {
 	display_message(INFORMATION_MESSAGE, "field : %s\n", this->name);
-	display_message(INFORMATION_MESSAGE, "  access count = %d\n", this->access_count);
+	display_message(INFORMATION_MESSAGE, "  access count = %d\n", this->access_count.load());
 	display_message(INFORMATION_MESSAGE, "  type = %s",
 		ENUMERATOR_STRING(CM_field_type)(this->cm_field_type));
 	display_message(INFORMATION_MESSAGE, "  coordinate system = %s",
@@ -116,8 +116,9 @@ private:
 	/* the number of computed fields wrapping this FE_field */
 	int number_of_wrappers;
 	/* the number of structures that point to this field.  The field cannot be
-		destroyed while this is greater than 0 */
-	int access_count;
+		destroyed while this is greater than 0. Atomic so element field
+		evaluations on multiple threads can access it */
+	std::atomic<int> access_count;
 
 protected:
 
@@ -10,6 +10,7 @@
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <math.h>
+#include <cstring>
 #include <limits>
 
 #include "opencmiss/zinc/result.h"
@@ -25,7 +26,39 @@
 // function from finite_element.cpp
 int global_to_element_map_values(FE_field *field, int componentNumber,
 	const FE_element_field_template *eft, cmzn_element *element, FE_value time,
-	const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value*& elementValues);
+	const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value *workValues,
+	FE_value *elementValues);
+
+namespace {
+
+/** Contract one index of a tensor of monomial coefficients or partial sums
+ * with a table of 1-D basis values at grid points:
+ * out[i + inner*(p + pointCount*q)] = sum_o in[i + inner*(o + order*q)]*table[o*pointCount + p]
+ * for i < inner, p < pointCount, q < outer. */
+void sum_factorised_contract(const FE_value *in, int inner, int order, int outer,
+	const FE_value *table, int pointCount, FE_value *out)
+{
+	for (int q = 0; q < outer; ++q)
+	{
+		const FE_value *inQ = in + inner*order*q;
+		FE_value *outQ = out + inner*pointCount*q;
+		for (int p = 0; p < pointCount; ++p)
+		{
+			FE_value *outP = outQ + inner*p;
+			for (int i = 0; i < inner; ++i)
+				outP[i] = 0.0;
+			for (int o = 0; o < order; ++o)
+			{
+				const FE_value factor = table[o*pointCount + p];
+				const FE_value *inO = inQ + inner*o;
+				for (int i = 0; i < inner; ++i)
+					outP[i] += inO[i]*factor;
+			}
+		}
+	}
+}
+
+} // anonymous namespace
 
 /*
 Global functions
@@ -70,97 +103,34 @@ int FE_element_field_evaluation::deaccess(FE_element_field_evaluation* &element_
 
 void FE_element_field_evaluation::clear()
 {
-	if (this->component_number_in_xi)
-	{
-		if (this->field)
-		{
-			for (int i = 0; i < this->number_of_components; i++)
-			{
-				if (this->component_number_in_xi[i])
-				{
-					DEALLOCATE(this->component_number_in_xi[i]);
-				}
-			}
-		}
-		DEALLOCATE(this->component_number_in_xi);
-	}
 	DEACCESS(FE_field)(&(this->field));
 	cmzn_element::deaccess(this->element);
 	cmzn_element::deaccess(this->field_element);
-	if (this->component_number_of_values)
-	{
-		DEALLOCATE(this->component_number_of_values);
-	}
-	if (this->component_grid_values_storage)
-	{
-		DEALLOCATE(this->component_grid_values_storage);
-	}
-	if (this->component_base_grid_offset)
-	{
-		DEALLOCATE(this->component_base_grid_offset);
-	}
-	if (this->component_grid_offset_in_xi)
-	{
-		for (int i = 0; i < this->number_of_components; i++)
-		{
-			DEALLOCATE(this->component_grid_offset_in_xi[i]);
-		}
-		DEALLOCATE(this->component_grid_offset_in_xi);
-	}
-	if (this->element_value_offsets)
-	{
-		DEALLOCATE(this->element_value_offsets);
-	}
-	if (this->component_values)
-	{
-		FE_value **tmp_values = this->component_values;
-		for (int i = this->number_of_components; i>0; i--)
-		{
-			DEALLOCATE(*tmp_values);
-			tmp_values++;
-		}
-		DEALLOCATE(this->component_values);
-	}
-	delete[] this->component_efts;
-	this->component_efts = nullptr;
-	if (this->component_standard_basis_function_arguments)
-	{
-		if (this->destroy_standard_basis_arguments)
-		{
-			int **tmp_arguments = this->component_standard_basis_function_arguments;
-			for (int i = this->number_of_components; i > 0; --i)
-			{
-				if (*tmp_arguments && ((1 == i) || (*tmp_arguments != tmp_arguments[1])))
-				{
-					DEALLOCATE(*tmp_arguments);
-				}
-				++tmp_arguments;
-			}
-		}
-		DEALLOCATE(this->
-			component_standard_basis_function_arguments);
-	}
-	if (this->component_standard_basis_functions)
-	{
-		DEALLOCATE(this->component_standard_basis_functions);
-	}
-	if (this->component_scale_factors)
+	// per-component arrays point into buffers which are kept for reuse,
+	// except standard basis arguments calculated for inherited fields
+	if ((this->component_standard_basis_function_arguments) && (this->destroy_standard_basis_arguments))
 	{
-		for (int i = 0; i < this->number_of_components; ++i)
+		int **tmp_arguments = this->component_standard_basis_function_arguments;
+		for (int i = this->number_of_components; i > 0; --i)
 		{
-			const FE_value *scaleFactors = this->component_scale_factors[i];
-			if (scaleFactors)
+			if (*tmp_arguments && ((1 == i) || (*tmp_arguments != tmp_arguments[1])))
 			{
-				// clear duplicate entries
-				for (int j = i + 1; j < this->number_of_components; ++j)
-					if (this->component_scale_factors[j] == scaleFactors)
-						this->component_scale_factors[j] = nullptr;
-				delete[] scaleFactors;
+				DEALLOCATE(*tmp_arguments);
 			}
+			++tmp_arguments;
 		}
-		delete[] this->component_scale_factors;
-		this->component_scale_factors = nullptr;
 	}
+	this->component_number_in_xi = nullptr;
+	this->component_number_of_values = nullptr;
+	this->component_grid_values_storage = nullptr;
+	this->component_base_grid_offset = nullptr;
+	this->component_grid_offset_in_xi = nullptr;
+	this->element_value_offsets = nullptr;
+	this->component_values = nullptr;
+	this->component_efts = nullptr;
+	this->component_scale_factors = nullptr;
+	this->component_standard_basis_functions = nullptr;
+	this->component_standard_basis_function_arguments = nullptr;
 	this->number_of_components = 0;
 	if (this->parameterPerturbationCount > 0)
 	{
@@ -169,17 +139,20 @@ void FE_element_field_evaluation::clear()
 	}
 }
 
+size_t FE_element_field_evaluation::getMemorySize() const
+{
+	return sizeof(*this)
+		+ (this->valuesBuffer.capacity() + this->workValuesBuffer.capacity()
+			+ this->gridEvaluationBuffer.capacity())*sizeof(FE_value)
+		+ (this->valuesOffsetBuffer.capacity() + this->intBuffer.capacity())*sizeof(int)
+		+ (this->intPointerBuffer.capacity() + this->valuesPointerBuffer.capacity()
+			+ this->scaleFactorsPointerBuffer.capacity() + this->eftBuffer.capacity()
+			+ this->standardBasisFunctionBuffer.capacity() + this->gridValuesStorageBuffer.capacity())*sizeof(void *);
+}
+
 int FE_element_field_evaluation::calculate_values(FE_field *fieldIn,
 	cmzn_element *element, FE_value time, cmzn_element *top_level_element)
 {
-	FE_value *blending_matrix, *inherited_value, *inherited_values,
-		*transformation, *value, **values_address;
-	int cn, **component_number_in_xi, *component_base_grid_offset,
-		*element_value_offsets, i, j, number_of_inherited_values,
-		*number_of_values_address, row_size,
-		**standard_basis_arguments_address;
-	Standard_basis_function **standard_basis_address;
-
 	if (this->element)
 		this->clear();
 	if (!((element) && (fieldIn)))
@@ -249,391 +222,333 @@ int FE_element_field_evaluation::calculate_values(FE_field *fieldIn,
 		} break;
 		case GENERAL_FE_FIELD:
 		{
-			ALLOCATE(number_of_values_address, int, number_of_components);
-			ALLOCATE(values_address, FE_value *, number_of_components);
-			ALLOCATE(standard_basis_address, Standard_basis_function *, number_of_components);
-			ALLOCATE(standard_basis_arguments_address, int *, number_of_components);
-			blending_matrix = nullptr;
-			ALLOCATE(component_number_in_xi, int *, number_of_components);
-			if (number_of_values_address&&values_address&&
-				standard_basis_address&&standard_basis_arguments_address&&
-				component_number_in_xi)
+			// set up per-component arrays in reused buffers
+			this->intPointerBuffer.assign(3*number_of_components, nullptr);
+			this->component_number_in_xi = this->intPointerBuffer.data();
+			this->component_grid_offset_in_xi = this->component_number_in_xi + number_of_components;
+			this->component_standard_basis_function_arguments = this->component_grid_offset_in_xi + number_of_components;
+			int grid_maximum_number_of_values = elementDimension + 1;
+			for (int i = elementDimension; i > 0; i--)
 			{
-				this->component_efts = new const FE_element_field_template*[number_of_components];
-				this->component_scale_factors = new const FE_value *[number_of_components];
-				for (i=0;i<number_of_components;i++)
-				{
-					number_of_values_address[i] = 0;
-					values_address[i] = nullptr;
-					this->component_efts[i] = nullptr;
-					standard_basis_address[i] = nullptr;
-					standard_basis_arguments_address[i] = nullptr;
-					/* following is non-NULL only for grid-based components */
-					component_number_in_xi[i] = nullptr;
-					this->component_scale_factors[i] = nullptr;
-				}
-				this->component_number_in_xi = component_number_in_xi;
-				this->field = fieldIn->access();
-				this->element = element->access();
-				this->field_element = fieldElement->access();
-				this->time_dependent = fieldIn->hasMultipleTimes();
-				this->time = time;
-				this->destroy_standard_basis_arguments = fieldElementDimension > elementDimension;
-				this->number_of_components = number_of_components;
-				this->component_number_of_values = number_of_values_address;
-				/* clear arrays only used for grid-based fields */
-				this->component_grid_values_storage = 0;
-				this->component_grid_offset_in_xi = 0;
-				this->element_value_offsets = 0;
-				this->component_values = values_address;
-				this->component_standard_basis_functions = standard_basis_address;
-				this->component_standard_basis_function_arguments = standard_basis_arguments_address;
-				int grid_maximum_number_of_values = elementDimension + 1;
-				for (i = elementDimension; i > 0; i--)
+				grid_maximum_number_of_values *= 2;
+			}
+			this->intBuffer.assign(number_of_components*(2 + 2*elementDimension) + grid_maximum_number_of_values, 0);
+			this->component_number_of_values = this->intBuffer.data();
+			this->component_base_grid_offset = this->component_number_of_values + number_of_components;
+			int *grid_number_in_xi = this->component_base_grid_offset + number_of_components;
+			int *grid_offset_in_xi = grid_number_in_xi + number_of_components*elementDimension;
+			this->element_value_offsets = grid_offset_in_xi + number_of_components*elementDimension;
+			this->valuesPointerBuffer.assign(number_of_components, nullptr);
+			this->component_values = this->valuesPointerBuffer.data();
+			this->scaleFactorsPointerBuffer.assign(number_of_components, nullptr);
+			this->component_scale_factors = this->scaleFactorsPointerBuffer.data();
+			this->eftBuffer.assign(number_of_components, nullptr);
+			this->component_efts = this->eftBuffer.data();
+			this->standardBasisFunctionBuffer.assign(number_of_components, nullptr);
+			this->component_standard_basis_functions = this->standardBasisFunctionBuffer.data();
+			this->gridValuesStorageBuffer.assign(number_of_components, nullptr);
+			this->component_grid_values_storage = this->gridValuesStorageBuffer.data();
+			// values are addressed by offset until all are added as valuesBuffer may grow
+			this->valuesOffsetBuffer.assign(2*number_of_components, -1);
+			int *componentValuesOffsets = this->valuesOffsetBuffer.data();
+			int *componentScaleFactorsOffsets = componentValuesOffsets + number_of_components;
+			this->valuesBuffer.clear();
+
+			this->field = fieldIn->access();
+			this->element = element->access();
+			this->field_element = fieldElement->access();
+			this->time_dependent = fieldIn->hasMultipleTimes();
+			this->time = time;
+			this->destroy_standard_basis_arguments = fieldElementDimension > elementDimension;
+			this->number_of_components = number_of_components;
+
+			const FE_mesh_field_data *meshFieldData = fieldIn->getMeshFieldData(fieldElement->getMesh());
+			FE_basis *previous_basis = 0;
+			FE_value *blending_matrix = nullptr;
+			int number_of_inherited_values = 0;
+			const DsLabelIndex fieldElementIndex = fieldElement->getIndex();
+			for (int component_number = 0; component_number < number_of_components; ++component_number)
+			{
+				const FE_element_field_template *eft = this->component_efts[component_number] =
+					meshFieldData->getComponentMeshfieldtemplate(component_number)->getElementfieldtemplate(fieldElementIndex);
+				if (!eft)
 				{
-					grid_maximum_number_of_values *= 2;
+					return_code = 0;
+					break;
 				}
-
-				const FE_mesh_field_data *meshFieldData = fieldIn->getMeshFieldData(fieldElement->getMesh());
-				FE_basis *previous_basis = 0;
-				return_code=1;
-				int **component_grid_offset_in_xi = 0;
-				const DsLabelIndex fieldElementIndex = fieldElement->getIndex();
-				for (int component_number = 0; component_number < number_of_components; ++component_number)
+				int *number_of_values_address = this->component_number_of_values + component_number;
+				if ((eft->getParameterMappingMode() == CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_ELEMENT)
+					&& (0 != eft->getLegacyGridNumberInXi()))
 				{
-					const FE_element_field_template *eft = this->component_efts[component_number] =
-						meshFieldData->getComponentMeshfieldtemplate(component_number)->getElementfieldtemplate(fieldElementIndex);
-					if (!eft)
+					/* legacy grid-based */
+					// always uses linear Lagrange for the element dimension, monomial has same number of functions
+					int basisFunctionCount = 2;
+					for (int d = 1; d < elementDimension; ++d)
+						basisFunctionCount *= 2;
+					componentValuesOffsets[component_number] = static_cast<int>(this->valuesBuffer.size());
+					this->valuesBuffer.resize(this->valuesBuffer.size() + basisFunctionCount);
+					*number_of_values_address = basisFunctionCount;
+					const int *top_level_component_number_in_xi = eft->getLegacyGridNumberInXi();
+					// GRC risky to cache pointers into per-element data
+					FE_mesh_field_data::ComponentBase *componentBase = meshFieldData->getComponentBase(component_number);
+					const int valuesCount = eft->getNumberOfElementDOFs();
+					// following could be done as a virtual function
+					switch (fieldIn->getValueType())
 					{
+					case FE_VALUE_VALUE:
+						{
+							auto component = static_cast<FE_mesh_field_data::Component<FE_value>*>(componentBase);
+							this->component_grid_values_storage[component_number] =
+								reinterpret_cast<const Value_storage*>(component->getElementValues(fieldElementIndex, valuesCount));
+						} break;
+					case INT_VALUE:
+						{
+							auto component = static_cast<FE_mesh_field_data::Component<int>*>(componentBase);
+							this->component_grid_values_storage[component_number] =
+								reinterpret_cast<const Value_storage*>(component->getElementValues(fieldElementIndex, valuesCount));
+						} break;
+					default:
+						{
+							display_message(ERROR_MESSAGE,
+								"FE_element_field_evaluation::calculate_values.  Invalid value type for grid field");
+							return_code = 0;
+						} break;
+					}
+					if (!return_code)
+						break;
+					this->component_number_in_xi[component_number] = grid_number_in_xi + component_number*elementDimension;
+					this->component_grid_offset_in_xi[component_number] = grid_offset_in_xi + component_number*elementDimension;
+					this->component_base_grid_offset[component_number] = 0;
+					if (!calculate_grid_field_offsets(elementDimension,
+						fieldElementDimension, top_level_component_number_in_xi,
+						coordinate_transformation, this->component_number_in_xi[component_number],
+						&(this->component_base_grid_offset[component_number]),
+						this->component_grid_offset_in_xi[component_number]))
+					{
+						display_message(ERROR_MESSAGE,
+							"FE_element_field_evaluation::calculate_values.  "
+							"Could not calculate grid field offsets");
 						return_code = 0;
 						break;
 					}
-					if ((eft->getParameterMappingMode() == CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_ELEMENT)
-						&& (0 != eft->getLegacyGridNumberInXi()))
+				}
+				else /* not grid-based; includes non-grid element-based */
+				{
+					// calculate element values for component on the fieldElement
+					const int basisFunctionCount = eft->getNumberOfFunctions();
+					FE_basis *basis = eft->getBasis();
+					const int blendedElementValuesCount = FE_basis_get_number_of_blended_functions(basis);
+					switch (eft->getParameterMappingMode())
 					{
-						/* legacy grid-based */
-						// always uses linear Lagrange for the element dimension, monomial has same number of functions
-						int basisFunctionCount = 2;
-						for (int d = 1; d < elementDimension; ++d)
-							basisFunctionCount *= 2;
-						ALLOCATE(*values_address, FE_value, basisFunctionCount);
-						*number_of_values_address = basisFunctionCount;
-						if (!(*values_address))
-						{
-							return_code = 0;
-							break;
-						}
-						const int *top_level_component_number_in_xi = eft->getLegacyGridNumberInXi();
-						/* one-off allocation of arrays only needed for grid-based components */
-						if (NULL == this->component_grid_values_storage)
+					case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_NODE:
+					{
+						const int scaleFactorCount = eft->getNumberOfLocalScaleFactors();
+						if (scaleFactorCount)
 						{
-							const Value_storage **component_grid_values_storage;
-							ALLOCATE(component_grid_values_storage, const Value_storage *, number_of_components);
-							ALLOCATE(component_base_grid_offset, int, number_of_components);
-							ALLOCATE(component_grid_offset_in_xi, int*, number_of_components);
-							ALLOCATE(element_value_offsets, int, grid_maximum_number_of_values);
-							if (component_grid_values_storage && component_base_grid_offset &&
-								component_grid_offset_in_xi && element_value_offsets)
+							// get scale factors for same eft in lower component, if any
+							for (int i = component_number - 1; i >= 0; --i)
 							{
-								for (cn = 0; (cn < number_of_components); cn++)
+								if (this->component_efts[i] == eft)
 								{
-									component_grid_values_storage[cn]=NULL;
-									component_base_grid_offset[cn]=0;
-									component_grid_offset_in_xi[cn]=NULL;
+									componentScaleFactorsOffsets[component_number] = componentScaleFactorsOffsets[i];
+									break;
 								}
-								this->component_grid_values_storage = component_grid_values_storage;
-								this->component_base_grid_offset = component_base_grid_offset;
-								this->component_grid_offset_in_xi = component_grid_offset_in_xi;
-								this->element_value_offsets = element_value_offsets;
 							}
-							else
+							if (componentScaleFactorsOffsets[component_number] < 0)
 							{
-								return_code = 0;
-								break;
+								componentScaleFactorsOffsets[component_number] = static_cast<int>(this->valuesBuffer.size());
+								this->valuesBuffer.resize(this->valuesBuffer.size() + scaleFactorCount);
+								FE_value *scaleFactors = this->valuesBuffer.data() + componentScaleFactorsOffsets[component_number];
+								const FE_mesh_element_field_template_data *mftData = fieldElement->getMesh()->getElementfieldtemplateData(eft->getIndexInMesh());
+								if (CMZN_OK != mftData->getElementScaleFactors(fieldElementIndex, scaleFactors))
+								{
+									display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+										"Element %d dimension %d is missing scale factors for field %s component %d.",
+										fieldElement->getIdentifier(), fieldElement->getDimension(), field->getName(), component_number + 1);
+									return_code = 0;
+									break;
+								}
 							}
 						}
-						// GRC risky to cache pointers into per-element data
-						FE_mesh_field_data::ComponentBase *componentBase = meshFieldData->getComponentBase(component_number);
-						const int valuesCount = eft->getNumberOfElementDOFs();
-						// following could be done as a virtual function
-						switch (fieldIn->getValueType())
+						componentValuesOffsets[component_number] = static_cast<int>(this->valuesBuffer.size());
+						this->valuesBuffer.resize(this->valuesBuffer.size() +
+							((blendedElementValuesCount > basisFunctionCount) ? blendedElementValuesCount : basisFunctionCount));
+						if (this->workValuesBuffer.size() < static_cast<size_t>(basisFunctionCount))
+							this->workValuesBuffer.resize(basisFunctionCount);
+						const FE_value *scaleFactors = (componentScaleFactorsOffsets[component_number] >= 0) ?
+							this->valuesBuffer.data() + componentScaleFactorsOffsets[component_number] : nullptr;
+						if (0 == (*number_of_values_address = global_to_element_map_values(fieldIn, component_number,
+							eft, fieldElement, time, nodeset, scaleFactors, this->workValuesBuffer.data(),
+							this->valuesBuffer.data() + componentValuesOffsets[component_number])))
 						{
-						case FE_VALUE_VALUE:
-							{
-								auto component = static_cast<FE_mesh_field_data::Component<FE_value>*>(componentBase);
-								this->component_grid_values_storage[component_number] =
-									reinterpret_cast<const Value_storage*>(component->getElementValues(fieldElementIndex, valuesCount));
-							} break;
-						case INT_VALUE:
-							{
-								auto component = static_cast<FE_mesh_field_data::Component<int>*>(componentBase);
-								this->component_grid_values_storage[component_number] =
-									reinterpret_cast<const Value_storage*>(component->getElementValues(fieldElementIndex, valuesCount));
-							} break;
-						default:
-							{
-								display_message(ERROR_MESSAGE,
-									"FE_element_field_evaluation::calculate_values.  Invalid value type for grid field");
-								return_code = 0;
-							} break;
-						}
-						if (!return_code)
+							display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+								"Could not calculate node-based values for field %s in %d-D element %d",
+								fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
+							return_code = 0;
 							break;
-						ALLOCATE(component_number_in_xi[component_number], int, elementDimension);
-						ALLOCATE(component_grid_offset_in_xi[component_number], int, elementDimension);
-						if ((NULL != component_number_in_xi[component_number]) &&
-							(NULL != component_grid_offset_in_xi[component_number]))
-						{
-							this->component_base_grid_offset[component_number] = 0;
-							if (!calculate_grid_field_offsets(elementDimension,
-								fieldElementDimension, top_level_component_number_in_xi,
-								coordinate_transformation, component_number_in_xi[component_number],
-								&(this->component_base_grid_offset[component_number]),
-								component_grid_offset_in_xi[component_number]))
-							{
-								display_message(ERROR_MESSAGE,
-									"FE_element_field_evaluation::calculate_values.  "
-									"Could not calculate grid field offsets");
-								return_code=0;
-								break;
-							}
 						}
-						else
+					} break;
+					case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_ELEMENT:
+					{
+						// element-based mapping stores the parameters ready for use in the element
+						if (fieldIn->getValueType() != FE_VALUE_VALUE)
 						{
+							display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+								"Element-based non-grid field %s only implemented for real values", fieldIn->getName());
 							return_code = 0;
 							break;
 						}
-					}
-					else /* not grid-based; includes non-grid element-based */
-					{
-						// calculate element values for component on the fieldElement
-						const int basisFunctionCount = eft->getNumberOfFunctions();
-						ALLOCATE(*values_address, FE_value, basisFunctionCount);
-						if (!(*values_address))
+						auto component = static_cast<FE_mesh_field_data::Component<FE_value> *>(meshFieldData->getComponentBase(component_number));
+						const FE_value *values = component->getElementValues(fieldElementIndex, basisFunctionCount);
+						if (!values)
 						{
+							display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+								"Element-based field %s has no values at %d-D element %d",
+								fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
 							return_code = 0;
 							break;
 						}
-						switch (eft->getParameterMappingMode())
-						{
-						case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_NODE:
+						// transform values to standard basis functions if needed
+						componentValuesOffsets[component_number] = static_cast<int>(this->valuesBuffer.size());
+						if (blendedElementValuesCount > 0)
 						{
-							const int scaleFactorCount = eft->getNumberOfLocalScaleFactors();
-							if (scaleFactorCount)
-							{
-								// get scale factors for same eft in lower component, if any
-								for (int i = component_number - 1; i >= 0; --i)
-								{
-									if (this->component_efts[i] == eft)
-									{
-										this->component_scale_factors[component_number] = this->component_scale_factors[i];
-										break;
-									}
-								}
-								if (!this->component_scale_factors[component_number])
-								{
-									FE_value *scaleFactors = new FE_value[scaleFactorCount];
-									this->component_scale_factors[component_number] = scaleFactors;
-									const FE_mesh_element_field_template_data *mftData = fieldElement->getMesh()->getElementfieldtemplateData(eft->getIndexInMesh());
-									if (CMZN_OK != mftData->getElementScaleFactors(fieldElementIndex, scaleFactors))
-									{
-										display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-											"Element %d dimension %d is missing scale factors for field %s component %d.",
-											fieldElement->getIdentifier(), fieldElement->getDimension(), field->getName(), component_number + 1);
-										return_code = 0;
-										break;
-									}
-								}
-							}
-							if (0 == (*number_of_values_address = global_to_element_map_values(fieldIn, component_number,
-								eft, fieldElement, time, nodeset, this->component_scale_factors[component_number], *values_address)))
+							this->valuesBuffer.resize(this->valuesBuffer.size() + blendedElementValuesCount);
+							if (!FE_basis_blend_element_values(basis, values,
+								this->valuesBuffer.data() + componentValuesOffsets[component_number]))
 							{
 								display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-									"Could not calculate node-based values for field %s in %d-D element %d",
-									fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
+									"Could not calculate blended values");
 								return_code = 0;
 								break;
 							}
-						} break;
-						case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_ELEMENT:
-						{
-							// element-based mapping stores the parameters ready for use in the element
-							if (fieldIn->getValueType() != FE_VALUE_VALUE)
-							{
-								display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-									"Element-based non-grid field %s only implemented for real values", fieldIn->getName());
-								return_code = 0;
-								break;
-							}
-							auto component = static_cast<FE_mesh_field_data::Component<FE_value> *>(meshFieldData->getComponentBase(component_number));
-							const FE_value *values = component->getElementValues(fieldElementIndex, basisFunctionCount);
-							if (!values)
-							{
-								display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-									"Element-based field %s has no values at %d-D element %d",
-									fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
-								return_code = 0;
-								break;
-							}
-							// transform values to standard basis functions if needed
-							FE_basis *basis = eft->getBasis();
-							const int blendedElementValuesCount = FE_basis_get_number_of_blended_functions(basis);
-							if (blendedElementValuesCount > 0)
-							{
-								FE_value *blendedElementValues = FE_basis_get_blended_element_values(basis, values);
-								if (!blendedElementValues)
-								{
-									display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-										"Could not allocate memory for blended values");
-									return_code = 0;
-									break;
-								}
-								DEALLOCATE(*values_address); // future: avoid allocating this above
-								*values_address = blendedElementValues;
-								*number_of_values_address = blendedElementValuesCount;
-							}
-							else
-							{
-								memcpy(*values_address, values, basisFunctionCount*sizeof(FE_value));
-								*number_of_values_address = basisFunctionCount;
-							}
-						} break;
-						case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_FIELD:
+							*number_of_values_address = blendedElementValuesCount;
+						}
+						else
 						{
-							if (fieldIn->getValueType() != FE_VALUE_VALUE)
-							{
-								display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-									"Field-based field %s only implemented for real values", fieldIn->getName());
-								return_code = 0;
-								break;
-							}
-							const FE_value *fieldValues = fieldIn->getRealValues();
-							if (!fieldValues)
-							{
-								display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-									"Field-based field %s has no values at %d-D element %d",
-									fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
-								return_code = 0;
-								break;
-							}
-							**values_address = fieldValues[component_number];
-							*number_of_values_address = 1;
-						} break;
-						case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_INVALID:
+							this->valuesBuffer.insert(this->valuesBuffer.end(), values, values + basisFunctionCount);
+							*number_of_values_address = basisFunctionCount;
+						}
+					} break;
+					case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_FIELD:
+					{
+						if (fieldIn->getValueType() != FE_VALUE_VALUE)
 						{
 							display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
-								"Invalid parameter mapping mode for field %s in %d-D element %d",
-								fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
+								"Field-based field %s only implemented for real values", fieldIn->getName());
 							return_code = 0;
-						} break;
-						}
-						if (!return_code)
 							break;
-						if (previous_basis == eft->getBasis())
-						{
-							*standard_basis_address = *(standard_basis_address - 1);
-							*standard_basis_arguments_address = *(standard_basis_arguments_address - 1);
 						}
-						else
+						const FE_value *fieldValues = fieldIn->getRealValues();
+						if (!fieldValues)
 						{
-							previous_basis = eft->getBasis();
-							if (blending_matrix)
-							{
-								DEALLOCATE(blending_matrix);
-								blending_matrix = 0;
-							}
-							*standard_basis_address = FE_basis_get_standard_basis_function(previous_basis);
-							if (fieldElementDimension > elementDimension)
-							{
-								if (!calculate_standard_basis_transformation(
-									previous_basis, coordinate_transformation,
-									elementDimension, standard_basis_arguments_address,
-									&number_of_inherited_values, standard_basis_address,
-									&blending_matrix))
-								{
-									return_code = 0;
-									break;
-								}
-							}
-							else
-							{
-								/* standard basis transformation is just a big identity matrix, so don't compute */
-								/* also use the real basis arguments */
-								*standard_basis_arguments_address =
-									const_cast<int *>(FE_basis_get_standard_basis_function_arguments(previous_basis));
-							}
+							display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+								"Field-based field %s has no values at %d-D element %d",
+								fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
+							return_code = 0;
+							break;
 						}
-						if (fieldElement == element)
+						componentValuesOffsets[component_number] = static_cast<int>(this->valuesBuffer.size());
+						this->valuesBuffer.push_back(fieldValues[component_number]);
+						*number_of_values_address = 1;
+					} break;
+					case CMZN_ELEMENTFIELDTEMPLATE_PARAMETER_MAPPING_MODE_INVALID:
+					{
+						display_message(ERROR_MESSAGE, "FE_element_field_evaluation::calculate_values.  "
+							"Invalid parameter mapping mode for field %s in %d-D element %d",
+							fieldIn->getName(), fieldElementDimension, fieldElement->getIdentifier());
+						return_code = 0;
+					} break;
+					}
+					if (!return_code)
+						break;
+					Standard_basis_function **standard_basis_address = this->component_standard_basis_functions + component_number;
+					int **standard_basis_arguments_address = this->component_standard_basis_function_arguments + component_number;
+					if (previous_basis == basis)
+					{
+						*standard_basis_address = *(standard_basis_address - 1);
+						*standard_basis_arguments_address = *(standard_basis_arguments_address - 1);
+					}
+					else
+					{
+						previous_basis = basis;
+						if (blending_matrix)
 						{
-							/* values already correct regardless of basis */
+							DEALLOCATE(blending_matrix);
+							blending_matrix = 0;
 						}
-						else if ((monomial_basis_functions== *standard_basis_address)||
-							(polygon_basis_functions== *standard_basis_address))
+						*standard_basis_address = FE_basis_get_standard_basis_function(previous_basis);
+						if (fieldElementDimension > elementDimension)
 						{
-							/* project the fieldElement values onto the lower-dimension element
-									using the affine transformation */
-							/* allocate memory for the element values */
-							ALLOCATE(inherited_values,FE_value, number_of_inherited_values);
-							if (inherited_values)
-							{
-								row_size= *number_of_values_address;
-								inherited_value=inherited_values;
-								for (j=0;j<number_of_inherited_values;j++)
-								{
-									FE_value sum = 0.0;
-									value= *values_address;
-									transformation=blending_matrix+j;
-									for (i=row_size;i>0;i--)
-									{
-										sum += (*transformation)*(*value);
-										value++;
-										transformation += number_of_inherited_values;
-									}
-									*inherited_value=(FE_value)sum;
-									inherited_value++;
-								}
-								DEALLOCATE(*values_address);
-								*values_address=inherited_values;
-								*number_of_values_address=number_of_inherited_values;
-							}
-							else
+							if (!calculate_standard_basis_transformation(
+								previous_basis, coordinate_transformation,
+								elementDimension, standard_basis_arguments_address,
+								&number_of_inherited_values, standard_basis_address,
+								&blending_matrix))
 							{
-								display_message(ERROR_MESSAGE,
-									"FE_element_field_evaluation::calculate_values.  "
-									"Insufficient memory for inherited_values");
-								DEALLOCATE(*values_address);
 								return_code = 0;
 								break;
 							}
 						}
 						else
 						{
-							display_message(ERROR_MESSAGE,
-								"FE_element_field_evaluation::calculate_values.  Invalid basis");
-							return_code = 0;
-							break;
+							/* standard basis transformation is just a big identity matrix, so don't compute */
+							/* also use the real basis arguments */
+							*standard_basis_arguments_address =
+								const_cast<int *>(FE_basis_get_standard_basis_function_arguments(previous_basis));
+						}
+					}
+					if (fieldElement == element)
+					{
+						/* values already correct regardless of basis */
+					}
+					else if ((monomial_basis_functions== *standard_basis_address)||
+						(polygon_basis_functions== *standard_basis_address))
+					{
+						/* project the fieldElement values onto the lower-dimension element
+								using the affine transformation; add after existing values */
+						const int inheritedValuesOffset = static_cast<int>(this->valuesBuffer.size());
+						this->valuesBuffer.resize(this->valuesBuffer.size() + number_of_inherited_values);
+						const FE_value *values = this->valuesBuffer.data() + componentValuesOffsets[component_number];
+						FE_value *inherited_value = this->valuesBuffer.data() + inheritedValuesOffset;
+						const int row_size = *number_of_values_address;
+						for (int j = 0; j < number_of_inherited_values; j++)
+						{
+							FE_value sum = 0.0;
+							const FE_value *value = values;
+							const FE_value *transformation = blending_matrix + j;
+							for (int i = row_size; i > 0; i--)
+							{
+								sum += (*transformation)*(*value);
+								value++;
+								transformation += number_of_inherited_values;
+							}
+							*inherited_value = sum;
+							inherited_value++;
 						}
-						standard_basis_address++;
-						standard_basis_arguments_address++;
+						componentValuesOffsets[component_number] = inheritedValuesOffset;
+						*number_of_values_address = number_of_inherited_values;
+					}
+					else
+					{
+						display_message(ERROR_MESSAGE,
+							"FE_element_field_evaluation::calculate_values.  Invalid basis");
+						return_code = 0;
+						break;
 					}
-					number_of_values_address++;
-					values_address++;
 				}
 			}
-			else
-			{
-				display_message(ERROR_MESSAGE,
-					"FE_element_field_evaluation::calculate_values.  Insufficient memory");
-				DEALLOCATE(number_of_values_address);
-				DEALLOCATE(values_address);
-				DEALLOCATE(standard_basis_address);
-				DEALLOCATE(standard_basis_arguments_address);
-				return_code=0;
-			}
 			if (blending_matrix)
 			{
 				DEALLOCATE(blending_matrix);
 			}
+			// valuesBuffer no longer changes size, so point into it
+			for (int i = 0; i < number_of_components; ++i)
+			{
+				if (componentValuesOffsets[i] >= 0)
+					this->component_values[i] = this->valuesBuffer.data() + componentValuesOffsets[i];
+				if (componentScaleFactorsOffsets[i] >= 0)
+					this->component_scale_factors[i] = this->valuesBuffer.data() + componentScaleFactorsOffsets[i];
+			}
 		} break;
 		default:
 		{
@@ -1023,17 +938,11 @@ int FE_element_field_evaluation::evaluate_real(int component_number,
 						else
 						{
 							// calculate field value as a dot product of the element and basis values
-							for (int k = 0; k < number_of_mesh_derivatives; ++k)
-							{
-								const FE_value *element_value = *element_values_ptr;
-								// performance critical dot product: keep simple & let compiler optimise it
-								FE_value sum = 0.0;
-								for (int j = 0; j < valueCount; ++j)
-									sum += element_value[j]*basis_value[j];
-								*calculated_value = sum;
-								++calculated_value;
-								basis_value += valueCount;
-							}
+							// performance critical: inline loops specialised for value count
+							standard_basis_dot_products(*element_values_ptr, basis_value, valueCount,
+								number_of_mesh_derivatives, calculated_value);
+							calculated_value += number_of_mesh_derivatives;
+							basis_value += number_of_mesh_derivatives*valueCount;
 							if (this->parameterPerturbationCount)
 							{
 								if (this->element != this->field_element)
@@ -1164,7 +1073,7 @@ int FE_element_field_evaluation::evaluate_real(int component_number,
 				{
 					/* derivatives are zero for constant and indexed fields */
 					const int values_count = number_of_mesh_derivatives*components_to_calculate;
-					for (int i = 0; 0 < values_count; ++i)
+					for (int i = 0; i < values_count; ++i)
 						values[i] = 0.0;
 				}
 			} break;
@@ -1187,6 +1096,346 @@ int FE_element_field_evaluation::evaluate_real(int component_number,
 	return (return_code);
 }
 
+const int *FE_element_field_evaluation::get_direct_monomial_arguments(int component_number) const
+{
+	if ((this->field->get_FE_field_type() != GENERAL_FE_FIELD)
+		|| (0 != this->parameterPerturbationCount)
+		|| (this->component_number_in_xi[component_number])
+		|| (this->component_standard_basis_functions[component_number] != monomial_basis_functions))
+		return nullptr;
+	const int *arguments = this->component_standard_basis_function_arguments[component_number];
+	const int dimension = this->element->getDimension();
+	if (arguments[0] != dimension)
+		return nullptr;
+	int valueCount = 1;
+	for (int d = 1; d <= dimension; ++d)
+		valueCount *= arguments[d] + 1;
+	if (valueCount != this->component_number_of_values[component_number])
+		return nullptr;
+	return arguments;
+}
+
+bool FE_element_field_evaluation::is_standard_basis_interpolated(int component_number) const
+{
+	return (this->field->get_FE_field_type() == GENERAL_FE_FIELD)
+		&& (0 == this->parameterPerturbationCount)
+		&& (!this->component_number_in_xi[component_number])
+		&& (this->component_standard_basis_functions[component_number]);
+}
+
+int FE_element_field_evaluation::evaluate_real_grid(const int *numbers_of_points,
+	const FE_value *const *grid_xi, Standard_basis_function_evaluation &basis_function_evaluation,
+	int mesh_derivative_order, FE_value *values)
+{
+	if (!((this->field) && (this->element) && (numbers_of_points) && (grid_xi) && (values)
+		&& (0 <= mesh_derivative_order) && (mesh_derivative_order <= 1)))
+	{
+		display_message(ERROR_MESSAGE, "FE_element_field_evaluation::evaluate_real_grid.  Invalid argument(s)");
+		return 0;
+	}
+	const int dimension = this->element->getDimension();
+	const int componentCount = this->field->getNumberOfComponents();
+	const int valuesPerPoint = componentCount*(1 + ((mesh_derivative_order) ? dimension : 0));
+	// pad unused xi directions with a single point at xi = 0
+	int pointsCount[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	const FE_value zeroXi = 0.0;
+	const FE_value *xiValues[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	for (int d = 0; d < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++d)
+	{
+		if (d < dimension)
+		{
+			if ((numbers_of_points[d] < 1) || (!grid_xi[d]))
+			{
+				display_message(ERROR_MESSAGE, "FE_element_field_evaluation::evaluate_real_grid.  Invalid grid");
+				return 0;
+			}
+			pointsCount[d] = numbers_of_points[d];
+			xiValues[d] = grid_xi[d];
+		}
+		else
+		{
+			pointsCount[d] = 1;
+			xiValues[d] = &zeroXi;
+		}
+	}
+	const int pointCount = pointsCount[0]*pointsCount[1]*pointsCount[2];
+	FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	for (int c = 0; c < componentCount; ++c)
+	{
+		const int *monomialArguments = this->get_direct_monomial_arguments(c);
+		if (!monomialArguments)
+		{
+			FE_value *pointValues = values;
+			for (int k = 0; k < pointsCount[2]; ++k)
+			{
+				xi[2] = xiValues[2][k];
+				for (int j = 0; j < pointsCount[1]; ++j)
+				{
+					xi[1] = xiValues[1][j];
+					for (int i = 0; i < pointsCount[0]; ++i)
+					{
+						xi[0] = xiValues[0][i];
+						basis_function_evaluation.invalidate();
+						if (!(this->evaluate_real(c, xi, basis_function_evaluation,
+								/*mesh_derivative_order*/0, /*parameter_derivative_order*/0, pointValues + c)
+							&& ((!mesh_derivative_order) || this->evaluate_real(c, xi, basis_function_evaluation,
+								/*mesh_derivative_order*/1, /*parameter_derivative_order*/0,
+								pointValues + componentCount + c*dimension))))
+							return 0;
+						pointValues += valuesPerPoint;
+					}
+				}
+			}
+			continue;
+		}
+		int order[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int d = 0; d < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++d)
+			order[d] = (d < dimension) ? monomialArguments[d + 1] + 1 : 1;
+		// layout in buffer: powers and derivatives of powers for each direction,
+		// 2 sets of partial sums over xi3, 2 over xi2 then results for each point
+		int tableOffset[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		size_t size = 0;
+		for (int d = 0; d < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++d)
+		{
+			tableOffset[d] = static_cast<int>(size);
+			size += 2*order[d]*pointsCount[d];
+		}
+		const size_t sum3Size = order[0]*order[1]*pointsCount[2];
+		const size_t sum2Size = order[0]*pointsCount[1]*pointsCount[2];
+		const size_t sum3Offset = size;
+		size += 2*sum3Size;
+		const size_t sum2Offset = size;
+		size += 2*sum2Size;
+		const size_t resultOffset = size;
+		size += pointCount;
+		if (this->gridEvaluationBuffer.size() < size)
+			this->gridEvaluationBuffer.resize(size);
+		FE_value *buffer = this->gridEvaluationBuffer.data();
+		const FE_value *powers[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		const FE_value *powerDerivatives[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int d = 0; d < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++d)
+		{
+			const int count = pointsCount[d];
+			FE_value *power = buffer + tableOffset[d];
+			FE_value *powerDerivative = power + order[d]*count;
+			for (int p = 0; p < count; ++p)
+			{
+				const FE_value xiValue = xiValues[d][p];
+				power[p] = 1.0;
+				powerDerivative[p] = 0.0;
+				for (int o = 1; o < order[d]; ++o)
+				{
+					power[o*count + p] = power[(o - 1)*count + p]*xiValue;
+					powerDerivative[o*count + p] = static_cast<FE_value>(o)*power[(o - 1)*count + p];
+				}
+			}
+			powers[d] = power;
+			powerDerivatives[d] = powerDerivative;
+		}
+		FE_value *sum3 = buffer + sum3Offset;
+		FE_value *sum3Derivative = sum3 + sum3Size;
+		FE_value *sum2 = buffer + sum2Offset;
+		FE_value *sum2Derivative = sum2 + sum2Size;
+		FE_value *result = buffer + resultOffset;
+		const FE_value *coefficients = this->component_values[c];
+		// values
+		sum_factorised_contract(coefficients, order[0]*order[1], order[2], 1, powers[2], pointsCount[2], sum3);
+		sum_factorised_contract(sum3, order[0], order[1], pointsCount[2], powers[1], pointsCount[1], sum2);
+		sum_factorised_contract(sum2, 1, order[0], pointsCount[1]*pointsCount[2], powers[0], pointsCount[0], result);
+		for (int p = 0; p < pointCount; ++p)
+			values[p*valuesPerPoint + c] = result[p];
+		if (mesh_derivative_order)
+		{
+			FE_value *derivatives = values + componentCount + c*dimension;
+			for (int d = 0; d < dimension; ++d)
+			{
+				if (d == 0)
+				{
+					sum_factorised_contract(sum2, 1, order[0], pointsCount[1]*pointsCount[2], powerDerivatives[0], pointsCount[0], result);
+				}
+				else
+				{
+					const FE_value *use_sum3 = sum3;
+					if (d == 2)
+					{
+						sum_factorised_contract(coefficients, order[0]*order[1], order[2], 1, powerDerivatives[2], pointsCount[2], sum3Derivative);
+						use_sum3 = sum3Derivative;
+					}
+					sum_factorised_contract(use_sum3, order[0], order[1], pointsCount[2],
+						(d == 1) ? powerDerivatives[1] : powers[1], pointsCount[1], sum2Derivative);
+					sum_factorised_contract(sum2Derivative, 1, order[0], pointsCount[1]*pointsCount[2], powers[0], pointsCount[0], result);
+				}
+				for (int p = 0; p < pointCount; ++p)
+					derivatives[p*valuesPerPoint + d] = result[p];
+			}
+		}
+	}
+	return 1;
+}
+
+int FE_element_field_evaluation::evaluate_real_points(int component_number,
+	int number_of_points, const FE_value *xi_coordinates,
+	Standard_basis_function_evaluation &basis_function_evaluation,
+	int mesh_derivative_order, FE_value *values)
+{
+	if (!((this->field) && (this->element) && (0 < number_of_points) && (xi_coordinates) && (values)
+		&& (0 <= mesh_derivative_order) && (mesh_derivative_order <= 1)))
+	{
+		display_message(ERROR_MESSAGE, "FE_element_field_evaluation::evaluate_real_points.  Invalid argument(s)");
+		return 0;
+	}
+	const int dimension = this->element->getDimension();
+	const int componentCount = this->field->getNumberOfComponents();
+	int comp_no, components_to_calculate;
+	if ((0 <= component_number) && (component_number < componentCount))
+	{
+		comp_no = component_number;
+		components_to_calculate = 1;
+	}
+	else
+	{
+		comp_no = 0;
+		components_to_calculate = componentCount;
+	}
+	const int valuesPerPoint = components_to_calculate*(1 + ((mesh_derivative_order) ? dimension : 0));
+	const int BLOCK = MONOMIAL_BASIS_POINTS_BLOCK_SIZE;
+	FE_value blockXi[MAXIMUM_ELEMENT_XI_DIMENSIONS*MONOMIAL_BASIS_POINTS_BLOCK_SIZE];
+	FE_value blockResults[(1 + MAXIMUM_ELEMENT_XI_DIMENSIONS)*MONOMIAL_BASIS_POINTS_BLOCK_SIZE];
+	for (int cn = 0; cn < components_to_calculate; ++cn)
+	{
+		const int c = comp_no + cn;
+		const int *monomialArguments = this->get_direct_monomial_arguments(c);
+		if (monomialArguments)
+		{
+			for (int start = 0; start < number_of_points; start += BLOCK)
+			{
+				const int blockCount = (number_of_points - start < BLOCK) ? number_of_points - start : BLOCK;
+				// transpose xi to structure of arrays, padding partial blocks
+				for (int d = 0; d < dimension; ++d)
+					for (int p = 0; p < BLOCK; ++p)
+						blockXi[d*BLOCK + p] = (p < blockCount) ? xi_coordinates[(start + p)*dimension + d] : 0.0;
+				if (!monomial_basis_points_dot_product(monomialArguments, blockXi,
+					this->component_values[c], mesh_derivative_order, blockResults))
+				{
+					// basis not supported: evaluate point by point
+					monomialArguments = nullptr;
+					break;
+				}
+				for (int p = 0; p < blockCount; ++p)
+				{
+					FE_value *pointValues = values + (start + p)*valuesPerPoint;
+					pointValues[cn] = blockResults[p];
+					if (mesh_derivative_order)
+						for (int d = 0; d < dimension; ++d)
+							pointValues[components_to_calculate + cn*dimension + d] = blockResults[(d + 1)*BLOCK + p];
+				}
+			}
+			if (monomialArguments)
+				continue;
+		}
+		for (int p = 0; p < number_of_points; ++p)
+		{
+			const FE_value *xi = xi_coordinates + p*dimension;
+			FE_value *pointValues = values + p*valuesPerPoint;
+			basis_function_evaluation.invalidate();
+			if (!(this->evaluate_real(c, xi, basis_function_evaluation,
+					/*mesh_derivative_order*/0, /*parameter_derivative_order*/0, pointValues + cn)
+				&& ((!mesh_derivative_order) || this->evaluate_real(c, xi, basis_function_evaluation,
+					/*mesh_derivative_order*/1, /*parameter_derivative_order*/0,
+					pointValues + components_to_calculate + cn*dimension))))
+				return 0;
+		}
+	}
+	return 1;
+}
+
+int FE_element_field_evaluation::evaluate_real_table(int component_number,
+	int number_of_points, const FE_value *xi_coordinates,
+	Standard_basis_function_evaluation &basis_function_evaluation,
+	int mesh_derivative_order, FE_value *values)
+{
+	if (!((this->field) && (this->element) && (0 < number_of_points) && (xi_coordinates) && (values)
+		&& (0 <= mesh_derivative_order) && (mesh_derivative_order <= 1)))
+	{
+		display_message(ERROR_MESSAGE, "FE_element_field_evaluation::evaluate_real_table.  Invalid argument(s)");
+		return 0;
+	}
+	const int dimension = this->element->getDimension();
+	const int componentCount = this->field->getNumberOfComponents();
+	int comp_no, components_to_calculate;
+	if ((0 <= component_number) && (component_number < componentCount))
+	{
+		comp_no = component_number;
+		components_to_calculate = 1;
+	}
+	else
+	{
+		comp_no = 0;
+		components_to_calculate = componentCount;
+	}
+	const int valuesPerPoint = components_to_calculate*(1 + ((mesh_derivative_order) ? dimension : 0));
+	const int maximumGroupCount = 4;
+	const FE_value *componentValues[maximumGroupCount];
+	int cn = 0;
+	while (cn < components_to_calculate)
+	{
+		const int c = comp_no + cn;
+		// group consecutive components sharing the same basis to multiply together
+		int groupCount = 1;
+		std::shared_ptr<const Standard_basis_table> table;
+		if (this->is_standard_basis_interpolated(c))
+		{
+			Standard_basis_function *basisFunction = this->component_standard_basis_functions[c];
+			const int *basisArguments = this->component_standard_basis_function_arguments[c];
+			if (basisArguments[0] == dimension)
+			{
+				table = get_standard_basis_table(basisFunction, basisArguments,
+					number_of_points, xi_coordinates, mesh_derivative_order);
+				if ((table) && (table->getFunctionCount() != this->component_number_of_values[c]))
+					table.reset();
+			}
+			if (table)
+			{
+				while ((cn + groupCount < components_to_calculate)
+					&& (groupCount < maximumGroupCount)
+					&& this->is_standard_basis_interpolated(c + groupCount)
+					&& (this->component_standard_basis_functions[c + groupCount] == basisFunction)
+					&& (this->component_number_of_values[c + groupCount] == this->component_number_of_values[c])
+					&& (0 == memcmp(this->component_standard_basis_function_arguments[c + groupCount],
+						basisArguments, (dimension + 1)*sizeof(int))))
+					++groupCount;
+			}
+		}
+		if (table)
+		{
+			for (int g = 0; g < groupCount; ++g)
+				componentValues[g] = this->component_values[c + g];
+			table->multiply(0, groupCount, componentValues, values + cn, valuesPerPoint, 1);
+			if (mesh_derivative_order)
+				for (int d = 0; d < dimension; ++d)
+					table->multiply(d + 1, groupCount, componentValues,
+						values + components_to_calculate + cn*dimension + d, valuesPerPoint, dimension);
+		}
+		else
+		{
+			for (int p = 0; p < number_of_points; ++p)
+			{
+				const FE_value *xi = xi_coordinates + p*dimension;
+				FE_value *pointValues = values + p*valuesPerPoint;
+				basis_function_evaluation.invalidate();
+				if (!(this->evaluate_real(c, xi, basis_function_evaluation,
+						/*mesh_derivative_order*/0, /*parameter_derivative_order*/0, pointValues + cn)
+					&& ((!mesh_derivative_order) || this->evaluate_real(c, xi, basis_function_evaluation,
+						/*mesh_derivative_order*/1, /*parameter_derivative_order*/0,
+						pointValues + components_to_calculate + cn*dimension))))
+					return 0;
+			}
+		}
+		cn += groupCount;
+	}
+	return 1;
+}
+
 int FE_element_field_evaluation::evaluate_string(int component_number,
 	const FE_value *xi_coordinates, char **values)
 {
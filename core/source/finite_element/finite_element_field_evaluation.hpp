@@ -11,6 +11,7 @@
 #if !defined (FINITE_ELEMENT_FIELD_EVALUATION_HPP)
 #define FINITE_ELEMENT_FIELD_EVALUATION_HPP
 
+#include <vector>
 #include <opencmiss/zinc/zincconfigure.h>
 #include "finite_element/finite_element_basis.hpp"
 #include "finite_element/finite_element_constants.hpp"
@@ -104,6 +105,27 @@ class FE_element_field_evaluation
 	int parameterPerturbationIndex[MAXIMUM_PARAMETER_DERIVATIVE_ORDER];
 	// size of each perturbation for value -> value + delta*derivative
 	FE_value parameterPerturbationDelta[MAXIMUM_PARAMETER_DERIVATIVE_ORDER];
+	// Storage for the per-component arrays above, kept by clear() and only
+	// grown to fit the largest element calculated so calculate_values does
+	// not allocate in steady state. Values and scale factors share valuesBuffer.
+	std::vector<FE_value> valuesBuffer;
+	// working space for unblended values
+	std::vector<FE_value> workValuesBuffer;
+	// offsets of each component's values then scale factors in valuesBuffer
+	// while calculating values, or -1 if none
+	std::vector<int> valuesOffsetBuffer;
+	// component number of values, base grid offsets, grid number in xi and
+	// offsets in xi, element value offsets
+	std::vector<int> intBuffer;
+	// component number in xi, grid offset in xi, standard basis arguments
+	std::vector<int *> intPointerBuffer;
+	std::vector<FE_value *> valuesPointerBuffer;
+	std::vector<const FE_value *> scaleFactorsPointerBuffer;
+	std::vector<const FE_element_field_template *> eftBuffer;
+	std::vector<Standard_basis_function *> standardBasisFunctionBuffer;
+	std::vector<const Value_storage *> gridValuesStorageBuffer;
+	// power tables and partial sums for sum factorised grid evaluation
+	std::vector<FE_value> gridEvaluationBuffer;
 	int access_count;
 
 	FE_element_field_evaluation();
@@ -113,6 +135,14 @@ class FE_element_field_evaluation
 		this->clear();
 	}
 
+	/** @return  Monomial basis arguments if component can be interpolated
+	 * directly from its values as monomial coefficients, otherwise nullptr. */
+	const int *get_direct_monomial_arguments(int component_number) const;
+
+	/** @return  True if component is interpolated with its standard basis
+	 * directly from its component values, i.e. not grid-based or perturbed. */
+	bool is_standard_basis_interpolated(int component_number) const;
+
 public:
 	/** create on heap with access_count = 1 */
 	static FE_element_field_evaluation *create()
@@ -144,6 +174,10 @@ public:
 			&& ((!this->time_dependent) || (time_in == this->time));
 	}
 
+	/** Get approximate number of bytes of memory used by this object and its
+	 * calculated values, for limiting the size of evaluation caches. */
+	size_t getMemorySize() const;
+
 	static inline int get_number_of_mesh_derivatives(int derivative_order, int dimension)
 	{
 		int number_of_derivatives = 1;
@@ -186,6 +220,62 @@ public:
 		Standard_basis_function_evaluation &basis_function_evaluation,
 		int mesh_derivative_order, int parameter_derivative_order, FE_value *values);
 
+	/** Evaluate all real components and optionally their first derivatives
+	 * on a tensor product grid of xi locations. Monomial components are sum
+	 * factorised: coefficients are contracted with 1-D power tables one xi
+	 * direction at a time, so the cost per point grows with the basis order
+	 * rather than the number of basis functions. Other components e.g. grid or
+	 * polygon based, or any with parameter perturbations active, are evaluated
+	 * point by point. Must have called calculate_values first.
+	 * @param numbers_of_points  Number of points in each xi direction, for the
+	 * dimension of the element.
+	 * @param grid_xi  For each xi direction, array of numbers_of_points[d] xi
+	 * coordinates in that direction.
+	 * @param basis_function_evaluation  Standard basis function evaluation
+	 * cache, used for components evaluated point by point.
+	 * @param mesh_derivative_order  0 for values only, 1 to also evaluate first
+	 * derivatives w.r.t. xi.
+	 * @param values  Caller-supplied space to store the real values for each
+	 * point in turn, with xi1 varying fastest. Each point has values for all
+	 * components followed, if mesh_derivative_order is 1, by derivatives as
+	 * output by evaluate_real with mesh_derivative_order 1. */
+	int evaluate_real_grid(const int *numbers_of_points, const FE_value *const *grid_xi,
+		Standard_basis_function_evaluation &basis_function_evaluation,
+		int mesh_derivative_order, FE_value *values);
+
+	/** Evaluate real field/component values and optionally their first
+	 * derivatives at several xi locations in the element. Monomial components
+	 * are evaluated for blocks of points together with vector instructions.
+	 * Other components are evaluated point by point. Must have called
+	 * calculate_values first.
+	 * @param component_number  Component number to evaluate starting at 0, or any
+	 * other value to evaluate all components.
+	 * @param number_of_points  Number of xi locations, at least 1.
+	 * @param xi_coordinates  Element chart locations, dimension values per point.
+	 * @param basis_function_evaluation  Standard basis function evaluation
+	 * cache, used for components evaluated point by point.
+	 * @param mesh_derivative_order  0 for values only, 1 to also evaluate first
+	 * derivatives w.r.t. xi.
+	 * @param values  Caller-supplied space to store the real values for each
+	 * point in turn: values for components followed, if mesh_derivative_order
+	 * is 1, by derivatives as output by evaluate_real with mesh_derivative_order 1. */
+	int evaluate_real_points(int component_number, int number_of_points,
+		const FE_value *xi_coordinates, Standard_basis_function_evaluation &basis_function_evaluation,
+		int mesh_derivative_order, FE_value *values);
+
+	/** Evaluate real field/component values and optionally their first
+	 * derivatives at a set of xi locations in the element using basis tables
+	 * shared with other elements evaluated at the same points, so that each
+	 * component is interpolated by a matrix product. Intended for fixed point
+	 * sets e.g. quadrature or tessellation points reused for many elements.
+	 * Components which cannot use a table are evaluated point by point.
+	 * Must have called calculate_values first.
+	 * @see get_standard_basis_table
+	 * Arguments and output as for evaluate_real_points. */
+	int evaluate_real_table(int component_number, int number_of_points,
+		const FE_value *xi_coordinates, Standard_basis_function_evaluation &basis_function_evaluation,
+		int mesh_derivative_order, FE_value *values);
+
 	/** Returns allocated copies of the string values of the field in the element.
 	 * @param component_number  Component number to evaluate starting at 0, or any
 	 * other value to evaluate all components.
@@ -312,7 +312,7 @@ cmzn_element::~cmzn_element()
 	if (0 != this->access_count)
 	{
 		display_message(ERROR_MESSAGE, "~cmzn_element.  Element destroyed with non-zero access count %d. Dimension %d Index %d",
-			this->access_count, this->mesh ? this->mesh->getDimension() : -1, this->index);
+			this->access_count.load(), this->mesh ? this->mesh->getDimension() : -1, this->index);
 	}
 }
 
@@ -2673,7 +2673,7 @@ DsLabelIndex FE_mesh::getElementFirstNeighbour(DsLabelIndex elementIndex, int fa
 	DsLabelIndex faceIndex;
 	if ((this->faceMesh) && (elementShapeFaces = this->getElementShapeFaces(elementIndex)) &&
 		(faces = elementShapeFaces->getElementFaces(elementIndex)) &&
-		(0 < faceNumber) && (faceNumber < elementShapeFaces->getFaceCount()) &&
+		(0 <= faceNumber) && (faceNumber < elementShapeFaces->getFaceCount()) &&
 		(0 <= (faceIndex = faces[faceNumber])))
 	{
 		const DsLabelIndex *parents;
@@ -22,6 +22,7 @@
 #include "general/block_array.hpp"
 #include "general/list.h"
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 #include <set>
@@ -205,7 +206,8 @@ private:
 	// index into mesh labels, maps to unique identifier
 	DsLabelIndex index;
 	// the number of references held to this element; destroyed once reduces to 0
-	int access_count;
+	// atomic so elements can be accessed by field caches on multiple threads
+	std::atomic<int> access_count;
 
 	cmzn_element(FE_mesh *meshIn, DsLabelIndex indexIn) :
 		mesh(meshIn),
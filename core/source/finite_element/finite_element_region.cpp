@@ -224,6 +224,9 @@ FE_region::FE_region(cmzn_region *region, FE_region *base_fe_region) :
 	fe_field_changes(0),
 	informed_make_cmiss_number_field(false),
 	informed_make_xi_field(false),
+	elementEvaluationCacheBudget(8*1024*1024),
+	elementEvaluationCacheHits(0),
+	elementEvaluationCacheMisses(0),
 	access_count(1)
 {
 	this->createFieldChangeLog();
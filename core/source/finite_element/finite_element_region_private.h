@@ -17,6 +17,7 @@ privileged finite_element modules.
 
 #include "finite_element/finite_element_private.h"
 #include "finite_element/finite_element_region.h"
+#include <atomic>
 
 /*
 Private types
@@ -100,6 +101,13 @@ struct FE_region
 	bool informed_make_cmiss_number_field;
 	bool informed_make_xi_field;
 
+	/* maximum bytes of element field evaluations cached per field cache */
+	int elementEvaluationCacheBudget;
+	/* counts of element field evaluation cache lookups reusing or recalculating
+	 * values, atomic as field caches may be used on several threads at once */
+	std::atomic<unsigned long long> elementEvaluationCacheHits;
+	std::atomic<unsigned long long> elementEvaluationCacheMisses;
+
 	/* number of objects using this region */
 	int access_count;
 
@@ -154,6 +162,47 @@ struct FE_region
 	}
 
 	cmzn_fielditerator *create_fielditerator();
+
+	int getElementEvaluationCacheBudget() const
+	{
+		return this->elementEvaluationCacheBudget;
+	}
+
+	/** @param budget  Maximum bytes of element field evaluations to cache, >= 0.
+	 * With 0, only the evaluation for the latest element is kept. */
+	int setElementEvaluationCacheBudget(int budget)
+	{
+		if (budget < 0)
+			return CMZN_ERROR_ARGUMENT;
+		this->elementEvaluationCacheBudget = budget;
+		return CMZN_OK;
+	}
+
+	inline void recordElementEvaluationCacheHit()
+	{
+		this->elementEvaluationCacheHits.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline void recordElementEvaluationCacheMiss()
+	{
+		this->elementEvaluationCacheMisses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	unsigned long long getElementEvaluationCacheHits() const
+	{
+		return this->elementEvaluationCacheHits.load(std::memory_order_relaxed);
+	}
+
+	unsigned long long getElementEvaluationCacheMisses() const
+	{
+		return this->elementEvaluationCacheMisses.load(std::memory_order_relaxed);
+	}
+
+	void resetElementEvaluationCacheStatistics()
+	{
+		this->elementEvaluationCacheHits.store(0, std::memory_order_relaxed);
+		this->elementEvaluationCacheMisses.store(0, std::memory_order_relaxed);
+	}
 };
 
 /*
@@ -1795,6 +1795,36 @@ SAB Doesn't work for polygons at the moment.
 	return (return_code);
 } /* FE_element_shape_find_face_number_for_xi */
 
+int FE_element_shape_find_face_number_outside_xi(struct FE_element_shape *shape,
+	const FE_value *xi, FE_value tolerance, int *face_number)
+{
+	if (!((shape) && (xi) && (face_number)))
+	{
+		display_message(ERROR_MESSAGE, "FE_element_shape_find_face_number_outside_xi.  Invalid argument(s)");
+		return 0;
+	}
+	FE_value maximumDistance = tolerance;
+	*face_number = -1;
+	for (int i = 0; i < shape->number_of_faces; ++i)
+	{
+		FE_value sum = 0.0;
+		int bit = 2;
+		for (int j = 0; j < shape->dimension; ++j)
+		{
+			if (shape->faces[i] & bit)
+				sum += xi[j];
+			bit *= 2;
+		}
+		const FE_value distance = (shape->faces[i] & 1) ? sum - 1.0 : -sum;
+		if (distance > maximumDistance)
+		{
+			maximumDistance = distance;
+			*face_number = i;
+		}
+	}
+	return (*face_number >= 0) ? 1 : 0;
+}
+
 int get_FE_element_shape_xi_linkage_number(
 	struct FE_element_shape *element_shape, int xi_number1, int xi_number2,
 	int *xi_linkage_number_address)
@@ -147,6 +147,16 @@ const FE_value *get_FE_element_shape_face_to_element(
 int FE_element_shape_find_face_number_for_xi(struct FE_element_shape *shape,
 	FE_value *xi, int *face_number);
 
+/**
+ * Find the face of shape which xi is furthest outside, e.g. to choose the
+ * neighbouring element to continue a search in.
+ * @param tolerance  Distance in xi space xi must be outside the face by.
+ * @param face_number  On success, set to the face number, otherwise -1.
+ * @return  1 if xi is outside a face by more than tolerance, otherwise 0.
+ */
+int FE_element_shape_find_face_number_outside_xi(struct FE_element_shape *shape,
+	const FE_value *xi, FE_value tolerance, int *face_number);
+
 int get_FE_element_shape_xi_linkage_number(
 	struct FE_element_shape *element_shape, int xi_number1, int xi_number2,
 	int *xi_linkage_number_address);
@@ -12,6 +12,7 @@ The functions for creating graphical objects from finite elements.
 #include <limits.h>
 #include <cmath>
 #include <cstdlib>
+#include <vector>
 #include "opencmiss/zinc/differentialoperator.h"
 #include "opencmiss/zinc/fieldcache.h"
 #include "opencmiss/zinc/mesh.h"
@@ -969,13 +970,31 @@ int FE_element_add_line_to_vertex_array(struct FE_element *element,
 			}
 
 			distance=(FE_value)number_of_segments;
+			/* evaluate coordinates at all points together if the coordinate
+			 * field is directly a finite element field */
+			std::vector<FE_value> grid_xi(number_of_segments + 1);
 			for (i = 0; (i <= number_of_segments); i++)
+				grid_xi[i] = ((FE_value)i)/distance;
+			const FE_value *grid_xi_pointer = grid_xi.data();
+			const int grid_number_of_points = static_cast<int>(number_of_segments + 1);
+			std::vector<FE_value> grid_coordinate_values((number_of_segments + 1)*coordinate_dimension);
+			if (!cmzn_field_evaluate_real_grid(coordinate_field, field_cache, element, top_level_element,
+				&grid_number_of_points, &grid_xi_pointer, /*meshDerivativeOrder*/0, grid_coordinate_values.data()))
 			{
-				xi=((FE_value)i)/distance;
+				grid_coordinate_values.clear();
+			}
+			for (i = 0; (i <= number_of_segments); i++)
+			{
+				xi = grid_xi[i];
 				/* evaluate the fields */
 				return_code = (CMZN_OK == field_cache->setIndexedMeshLocation(i, element, &xi, top_level_element));
-				if (return_code && (CMZN_OK == cmzn_field_evaluate_real(coordinate_field,
-					field_cache, coordinate_dimension, coordinates)) &&
+				if ((!grid_coordinate_values.empty()) && return_code)
+				{
+					for (int c = 0; c < coordinate_dimension; ++c)
+						coordinates[c] = grid_coordinate_values[i*coordinate_dimension + c];
+				}
+				if (return_code && ((!grid_coordinate_values.empty()) || (CMZN_OK == cmzn_field_evaluate_real(coordinate_field,
+					field_cache, coordinate_dimension, coordinates))) &&
 					((!data_field) || (CMZN_OK == cmzn_field_evaluate_real(data_field,
 						field_cache, number_of_data_values, data_buffer))) &&
 						((!texture_coordinate_field) || (CMZN_OK == cmzn_field_evaluate_real(texture_coordinate_field,
@@ -1044,6 +1063,7 @@ int FE_element_add_line_to_vertex_array(struct FE_element *element,
 					array->replace_integer_vertex_buffer_at_position(
 						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED,
 						vertex_location, 1, 1, &updated);
+					array->add_partial_redraw_range(vertex_start, number_of_segments + 1);
 				}
 			}
 			/* else could try and remove vertices that failed */
@@ -1671,6 +1691,8 @@ int FE_element_add_cylinder_to_vertex_array(struct FE_element *element,
 				array->replace_integer_vertex_buffer_at_position(
 					GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED,
 					vertex_location, 1, 1, &updated);
+				if (return_code)
+					array->add_partial_redraw_range(vertex_start, number_of_points);
 			}
 		}
 		cmzn_differentialoperator_destroy(&d_dxi);
@@ -1795,6 +1817,421 @@ int get_surface_element_segmentation(struct FE_element *element,
 	return (return_code);
 }
 
+/**
+ * For adaptive tessellation. Get number of linear segments needed over unit
+ * xi for chord deviation within tolerance times chord length, from first and
+ * second derivatives of coordinates with respect to xi. Over xi interval h
+ * the chord deviates from the curve by approximately |x''n|*h*h/8 where x''n
+ * is the component of x'' normal to x', and the chord length is |x'|*h.
+ * @return  Number of segments >= 1, or 0 if the first derivative is zero.
+ */
+static int FE_element_adaptive_number_of_segments(int coordinate_dimension,
+	const FE_value *derivative, const FE_value *second_derivative, FE_value tolerance)
+{
+	FE_value dx_dx = 0.0, dx_d2x = 0.0, d2x_d2x = 0.0;
+	for (int c = 0; c < coordinate_dimension; ++c)
+	{
+		dx_dx += derivative[c]*derivative[c];
+		dx_d2x += derivative[c]*second_derivative[c];
+		d2x_d2x += second_derivative[c]*second_derivative[c];
+	}
+	if (!(dx_dx > 0.0))
+		return 0;
+	const FE_value normal_d2x_squared = d2x_d2x - dx_d2x*dx_d2x/dx_dx;
+	if (!(normal_d2x_squared > 0.0))
+		return 1;
+	const FE_value segments = sqrt(normal_d2x_squared/dx_dx)/(8.0*tolerance);
+	if (!(segments < (FE_value)(INT_MAX/2)))
+		return INT_MAX/2;
+	const int number_of_segments = static_cast<int>(ceil(segments));
+	return (number_of_segments > 1) ? number_of_segments : 1;
+}
+
+/**
+ * Limit adaptive number of segments to range minimum..maximum, with 0 meaning
+ * the estimate failed so the maximum is used.
+ */
+static inline int FE_element_adaptive_clamp_segments(int number_of_segments,
+	int minimum, int maximum)
+{
+	if ((number_of_segments <= 0) || (number_of_segments > maximum))
+		return maximum;
+	if (number_of_segments < minimum)
+		return (minimum < maximum) ? minimum : maximum;
+	return number_of_segments;
+}
+
+/**
+ * Adaptive tessellation is only applied to 2-D elements which are square and
+ * not collapsed, i.e. have all 4 faces.
+ */
+static bool FE_mesh_is_adaptive_square_element(FE_mesh *fe_mesh, DsLabelIndex elementIndex)
+{
+	FE_element_shape *element_shape = fe_mesh->getElementShape(elementIndex);
+	enum FE_element_shape_type shape_type;
+	if (!((element_shape) && (2 == get_FE_element_shape_dimension(element_shape)) &&
+		get_FE_element_shape_xi_shape_type(element_shape, /*xi_number*/0, &shape_type) &&
+		(LINE_SHAPE == shape_type) &&
+		get_FE_element_shape_xi_shape_type(element_shape, /*xi_number*/1, &shape_type) &&
+		(LINE_SHAPE == shape_type)))
+		return false;
+	for (int face = 0; face < 4; ++face)
+	{
+		if (fe_mesh->getElementFace(elementIndex, face) < 0)
+			return false;
+	}
+	return true;
+}
+
+int FE_element_get_adaptive_discretization(struct FE_element *element,
+	cmzn_fieldcache_id field_cache, cmzn_mesh_id mesh,
+	struct Computed_field *coordinate_field, struct FE_element *top_level_element,
+	FE_value tolerance, const int *minimum_number_in_xi, int *number_in_xi)
+{
+	FE_mesh *fe_mesh = (element) ? element->getMesh() : 0;
+	const int coordinate_dimension = (coordinate_field) ?
+		cmzn_field_get_number_of_components(coordinate_field) : 0;
+	if (!((fe_mesh) && (field_cache) && (mesh) && (0 < coordinate_dimension) &&
+		(3 >= coordinate_dimension) && (0.0 < tolerance) && (minimum_number_in_xi) &&
+		(number_in_xi)))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_element_get_adaptive_discretization.  Invalid argument(s)");
+		return 0;
+	}
+	const int dimension = fe_mesh->getDimension();
+	const DsLabelIndex elementIndex = get_FE_element_index(element);
+	if (!((1 == dimension) ||
+		((2 == dimension) && FE_mesh_is_adaptive_square_element(fe_mesh, elementIndex))))
+		return 1;
+	cmzn_differentialoperator_id d_dxi[2], d2_dxi2[2];
+	for (int d = 0; d < dimension; ++d)
+	{
+		d_dxi[d] = cmzn_mesh_get_chart_differentialoperator(mesh, /*order*/1, d + 1);
+		// second derivative terms are numbered with last xi varying fastest
+		d2_dxi2[d] = cmzn_mesh_get_chart_differentialoperator(mesh, /*order*/2, d*dimension + d + 1);
+	}
+	/* sample at xi = 0, 0.5, 1 in each direction, xi1 varying fastest */
+	const int number_of_samples = (1 == dimension) ? 3 : 9;
+	int sample_segments[2][9];
+	FE_value derivative[3], second_derivative[3], xi[2];
+	bool evaluated = true;
+	for (int s = 0; (s < number_of_samples) && evaluated; ++s)
+	{
+		xi[0] = 0.5*(FE_value)(s % 3);
+		xi[1] = 0.5*(FE_value)(s / 3);
+		if (CMZN_OK != field_cache->setMeshLocation(element, xi, top_level_element))
+		{
+			evaluated = false;
+			break;
+		}
+		for (int d = 0; d < dimension; ++d)
+		{
+			if ((CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field, d_dxi[d],
+					field_cache, coordinate_dimension, derivative)) ||
+				(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field, d2_dxi2[d],
+					field_cache, coordinate_dimension, second_derivative)))
+			{
+				evaluated = false;
+				break;
+			}
+			sample_segments[d][s] = FE_element_adaptive_clamp_segments(
+				FE_element_adaptive_number_of_segments(coordinate_dimension,
+					derivative, second_derivative, tolerance),
+				minimum_number_in_xi[d], number_in_xi[d]);
+		}
+	}
+	for (int d = 0; d < dimension; ++d)
+	{
+		cmzn_differentialoperator_destroy(&d_dxi[d]);
+		cmzn_differentialoperator_destroy(&d2_dxi2[d]);
+	}
+	// not an error if field does not have second derivatives: keep discretization
+	if (!evaluated)
+		return 1;
+	/* need the most segments sampled anywhere in each direction */
+	for (int d = 0; d < dimension; ++d)
+	{
+		int number_of_segments = sample_segments[d][0];
+		for (int s = 1; s < number_of_samples; ++s)
+		{
+			if (sample_segments[d][s] > number_of_segments)
+				number_of_segments = sample_segments[d][s];
+		}
+		number_in_xi[d] = number_of_segments;
+	}
+	return 1;
+}
+
+FE_mesh_adaptive_segments::FE_mesh_adaptive_segments(FE_mesh *fe_mesh) :
+	fe_mesh(fe_mesh),
+	elementAdded(fe_mesh->getLabelsIndexSize(), 0)
+{
+	FE_mesh *face_mesh = fe_mesh->getFaceMesh();
+	const DsLabelIndex lineCount = (face_mesh) ? face_mesh->getLabelsIndexSize() : 0;
+	this->lineParents.resize(lineCount);
+	for (DsLabelIndex lineIndex = 0; lineIndex < lineCount; ++lineIndex)
+		this->lineParents[lineIndex] = lineIndex;
+	this->lineSegments.resize(lineCount, 0);
+}
+
+DsLabelIndex FE_mesh_adaptive_segments::getLineRoot(DsLabelIndex lineIndex)
+{
+	DsLabelIndex rootIndex = lineIndex;
+	while (this->lineParents[rootIndex] != rootIndex)
+		rootIndex = this->lineParents[rootIndex];
+	// shorten paths for later searches
+	while (this->lineParents[lineIndex] != rootIndex)
+	{
+		const DsLabelIndex parentIndex = this->lineParents[lineIndex];
+		this->lineParents[lineIndex] = rootIndex;
+		lineIndex = parentIndex;
+	}
+	return rootIndex;
+}
+
+void FE_mesh_adaptive_segments::joinLines(DsLabelIndex lineIndex1,
+	DsLabelIndex lineIndex2, int numberOfSegments)
+{
+	const DsLabelIndex rootIndex1 = this->getLineRoot(lineIndex1);
+	const DsLabelIndex rootIndex2 = this->getLineRoot(lineIndex2);
+	int& segments = this->lineSegments[rootIndex1];
+	if (rootIndex2 != rootIndex1)
+	{
+		this->lineParents[rootIndex2] = rootIndex1;
+		if (this->lineSegments[rootIndex2] > segments)
+			segments = this->lineSegments[rootIndex2];
+	}
+	if (numberOfSegments > segments)
+		segments = numberOfSegments;
+}
+
+void FE_mesh_adaptive_segments::addElement(DsLabelIndex elementIndex,
+	const int *numberInXi, const int *maximumNumberInXi)
+{
+	if ((elementIndex < 0) || (elementIndex >= static_cast<DsLabelIndex>(this->elementAdded.size())) ||
+		(!FE_mesh_is_adaptive_square_element(this->fe_mesh, elementIndex)))
+		return;
+	FE_mesh *face_mesh = this->fe_mesh->getFaceMesh();
+	DsLabelIndex lineIndexes[4];
+	for (int face = 0; face < 4; ++face)
+	{
+		lineIndexes[face] = this->fe_mesh->getElementFace(elementIndex, face);
+		if (lineIndexes[face] >= static_cast<DsLabelIndex>(this->lineParents.size()))
+			return;
+	}
+	// faces xi1=0, xi1=1 vary in xi2; faces xi2=0, xi2=1 vary in xi1
+	for (int d = 0; d < 2; ++d)
+	{
+		int numberOfSegments = numberInXi[d];
+		for (int face = 2 - 2*d; face < 4 - 2*d; ++face)
+		{
+			const DsLabelIndex *parents;
+			const int parentsCount = face_mesh->getElementParents(lineIndexes[face], parents);
+			for (int p = 0; p < parentsCount; ++p)
+			{
+				if ((parents[p] != elementIndex) &&
+					(!FE_mesh_is_adaptive_square_element(this->fe_mesh, parents[p])) &&
+					(maximumNumberInXi[d] > numberOfSegments))
+					numberOfSegments = maximumNumberInXi[d];
+			}
+		}
+		this->joinLines(lineIndexes[2 - 2*d], lineIndexes[3 - 2*d], numberOfSegments);
+	}
+	this->elementAdded[elementIndex] = 1;
+}
+
+bool FE_mesh_adaptive_segments::getElementSegments(DsLabelIndex elementIndex,
+	int *numberInXi)
+{
+	if ((elementIndex < 0) || (elementIndex >= static_cast<DsLabelIndex>(this->elementAdded.size())) ||
+		(!this->elementAdded[elementIndex]))
+		return false;
+	numberInXi[0] = this->lineSegments[this->getLineRoot(this->fe_mesh->getElementFace(elementIndex, 2))];
+	numberInXi[1] = this->lineSegments[this->getLineRoot(this->fe_mesh->getElementFace(elementIndex, 0))];
+	return true;
+}
+
+/**
+ * Get index of grid point t along face of square element, where points are
+ * listed with xi1 varying fastest and reversed in rows if reverse_winding.
+ * Faces are numbered 0:xi1=0, 1:xi1=1, 2:xi2=0, 3:xi2=1; t increases with
+ * the xi of the other direction.
+ */
+static inline int square_surface_face_grid_index(int face, int t,
+	int number_of_points_in_xi1, int number_of_points_in_xi2, bool reverse_winding)
+{
+	const int last1 = number_of_points_in_xi1 - 1;
+	switch (face)
+	{
+	case 0:
+		return t*number_of_points_in_xi1 + (reverse_winding ? last1 : 0);
+	case 1:
+		return t*number_of_points_in_xi1 + (reverse_winding ? 0 : last1);
+	case 2:
+		return (reverse_winding ? last1 - t : t);
+	}
+	return (number_of_points_in_xi2 - 1)*number_of_points_in_xi1 + (reverse_winding ? last1 - t : t);
+}
+
+/**
+ * Minimum cosine of angle between normals of adjacent elements at a common
+ * edge for sharing vertices, so creases such as cube edges are kept sharp.
+ */
+const FE_value surface_shared_vertices_minimum_normal_cosine = 0.5;
+
+/**
+ * For FE_element_add_surface_to_vertex_array with shared vertices. Gets
+ * vertex indices for each grid point in a non-collapsed square element,
+ * reusing vertices recorded in the array for faces/lines shared with
+ * previously added elements. Faces are reused if the coordinates at their
+ * ends match in either direction and normals do not differ by more than the
+ * crease angle.
+ * @param vertex_start  Index of first vertex to be added for element.
+ * @param vertex_indices  Array of number_of_points_in_xi1*number_of_points_in_xi2
+ * to receive index of vertex for each grid point. Vertices to be added by the
+ * caller are numbered consecutively from vertex_start.
+ * @return  Number of vertices to be added by the caller.
+ */
+static unsigned int FE_element_surface_get_shared_vertex_indices(
+	struct FE_element *element, cmzn_fieldcache_id field_cache,
+	cmzn_differentialoperator_id d_dxi1, cmzn_differentialoperator_id d_dxi2,
+	struct Graphics_vertex_array *array, struct Computed_field *coordinate_field,
+	int coordinate_dimension, int number_of_points_in_xi1, int number_of_points_in_xi2,
+	bool reverse_winding, bool reverse_normals, struct FE_element *top_level_element,
+	unsigned int vertex_start, unsigned int *vertex_indices)
+{
+	const unsigned int not_shared = vertex_start;
+	const int number_of_points = number_of_points_in_xi1*number_of_points_in_xi2;
+	for (int k = 0; k < number_of_points; ++k)
+		vertex_indices[k] = not_shared;
+	FE_mesh *fe_mesh = element->getMesh();
+	const DsLabelIndex elementIndex = get_FE_element_index(element);
+	GLfloat *position_buffer = 0, *normal_buffer = 0;
+	unsigned int position_values_per_vertex = 0, position_vertex_count = 0,
+		normal_values_per_vertex = 0, normal_vertex_count = 0;
+	if ((vertex_start > 0) && fe_mesh &&
+		array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+			&position_buffer, &position_values_per_vertex, &position_vertex_count) &&
+		array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+			&normal_buffer, &normal_values_per_vertex, &normal_vertex_count) &&
+		(position_values_per_vertex == static_cast<unsigned int>(coordinate_dimension)) &&
+		(3 == normal_values_per_vertex))
+	{
+		FE_value coordinates[3], derivative_xi1[3], derivative_xi2[3], xi[2];
+		unsigned int *edge_vertex_indices = new unsigned int[
+			(number_of_points_in_xi1 > number_of_points_in_xi2) ? number_of_points_in_xi1 : number_of_points_in_xi2];
+		for (int face = 0; face < 4; ++face)
+		{
+			const DsLabelIndex lineIndex = fe_mesh->getElementFace(elementIndex, face);
+			if (lineIndex < 0)
+				continue;
+			const int edge_points = (face < 2) ? number_of_points_in_xi2 : number_of_points_in_xi1;
+			if (!array->get_shared_edge_vertices(lineIndex, edge_points, edge_vertex_indices))
+				continue;
+			const unsigned int first = edge_vertex_indices[0];
+			const unsigned int last = edge_vertex_indices[edge_points - 1];
+			if ((first >= position_vertex_count) || (last >= position_vertex_count) ||
+				(first >= normal_vertex_count) || (last >= normal_vertex_count))
+				continue;
+			/* evaluate coordinates and normal at start of face in this element */
+			xi[0] = (1 == face) ? 1.0 : 0.0;
+			xi[1] = (3 == face) ? 1.0 : 0.0;
+			coordinates[1] = coordinates[2] = 0.0;
+			derivative_xi1[1] = derivative_xi1[2] = 0.0;
+			derivative_xi2[1] = derivative_xi2[2] = 0.0;
+			if ((CMZN_OK != field_cache->setMeshLocation(element, xi, top_level_element)) ||
+				(CMZN_OK != cmzn_field_evaluate_real(coordinate_field, field_cache,
+					coordinate_dimension, coordinates)) ||
+				(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
+					d_dxi1, field_cache, coordinate_dimension, derivative_xi1)) ||
+				(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
+					d_dxi2, field_cache, coordinate_dimension, derivative_xi2)))
+				continue;
+			FE_value distance_first = 0.0, distance_last = 0.0, edge_length = 0.0;
+			for (int c = 0; c < coordinate_dimension; ++c)
+			{
+				const FE_value first_value = position_buffer[first*position_values_per_vertex + c];
+				const FE_value last_value = position_buffer[last*position_values_per_vertex + c];
+				distance_first += (coordinates[c] - first_value)*(coordinates[c] - first_value);
+				distance_last += (coordinates[c] - last_value)*(coordinates[c] - last_value);
+				edge_length += (last_value - first_value)*(last_value - first_value);
+			}
+			/* squared distances: within 0.1% of face length */
+			const FE_value tolerance = 1.0E-6*edge_length;
+			if (!(tolerance > 0.0))
+				continue;
+			bool reverse_face;
+			if (distance_first <= tolerance)
+				reverse_face = false;
+			else if (distance_last <= tolerance)
+				reverse_face = true;
+			else
+				continue;
+			FE_value normal[3];
+			normal[0] = derivative_xi1[1]*derivative_xi2[2] - derivative_xi2[1]*derivative_xi1[2];
+			normal[1] = derivative_xi1[2]*derivative_xi2[0] - derivative_xi2[2]*derivative_xi1[0];
+			normal[2] = derivative_xi1[0]*derivative_xi2[1] - derivative_xi2[0]*derivative_xi1[1];
+			const FE_value normal_length = sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+			if (!(normal_length > 0.0))
+				continue;
+			const GLfloat *shared_normal = normal_buffer + 3*(reverse_face ? last : first);
+			FE_value normal_cosine = (normal[0]*shared_normal[0] + normal[1]*shared_normal[1] +
+				normal[2]*shared_normal[2])/normal_length;
+			if (reverse_normals)
+				normal_cosine = -normal_cosine;
+			if (normal_cosine < surface_shared_vertices_minimum_normal_cosine)
+				continue;
+			for (int t = 0; t < edge_points; ++t)
+			{
+				vertex_indices[square_surface_face_grid_index(face, t,
+					number_of_points_in_xi1, number_of_points_in_xi2, reverse_winding)] =
+					edge_vertex_indices[reverse_face ? (edge_points - 1 - t) : t];
+			}
+		}
+		delete[] edge_vertex_indices;
+	}
+	unsigned int number_of_new_vertices = 0;
+	for (int k = 0; k < number_of_points; ++k)
+	{
+		if (vertex_indices[k] == not_shared)
+		{
+			vertex_indices[k] = vertex_start + number_of_new_vertices;
+			++number_of_new_vertices;
+		}
+	}
+	return number_of_new_vertices;
+}
+
+/**
+ * Record vertex indices along faces/lines of a square element for sharing
+ * with subsequently added adjacent elements.
+ * @see FE_element_surface_get_shared_vertex_indices
+ */
+static void FE_element_surface_add_shared_edge_vertices(struct FE_element *element,
+	struct Graphics_vertex_array *array, int number_of_points_in_xi1,
+	int number_of_points_in_xi2, bool reverse_winding, const unsigned int *vertex_indices)
+{
+	FE_mesh *fe_mesh = element->getMesh();
+	if (!fe_mesh)
+		return;
+	const DsLabelIndex elementIndex = get_FE_element_index(element);
+	std::vector<unsigned int> edge_vertex_indices;
+	for (int face = 0; face < 4; ++face)
+	{
+		const DsLabelIndex lineIndex = fe_mesh->getElementFace(elementIndex, face);
+		if (lineIndex < 0)
+			continue;
+		const int edge_points = (face < 2) ? number_of_points_in_xi2 : number_of_points_in_xi1;
+		edge_vertex_indices.resize(edge_points);
+		for (int t = 0; t < edge_points; ++t)
+		{
+			edge_vertex_indices[t] = vertex_indices[square_surface_face_grid_index(face, t,
+				number_of_points_in_xi1, number_of_points_in_xi2, reverse_winding)];
+		}
+		array->add_shared_edge_vertices(lineIndex, edge_points, &(edge_vertex_indices[0]));
+	}
+}
 
 int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 	cmzn_fieldcache_id field_cache, cmzn_mesh_id surface_mesh,
@@ -1804,7 +2241,8 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 	struct Computed_field *data_field,
 	unsigned int number_of_segments_in_xi1_requested,
 	unsigned int number_of_segments_in_xi2_requested,
-	char reverse_normals, struct FE_element *top_level_element)
+	char reverse_normals, struct FE_element *top_level_element,
+	bool share_vertices)
 {
 	char modified_reverse_normals, special_normals;
 	enum Collapsed_element_type collapsed_element;
@@ -1869,6 +2307,8 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 		const DsLabelIndex elementIndex = get_FE_element_index(element);
 		GLfloat *floatData = data_field ? new GLfloat[n_data_components] : 0;
 		FE_value *xi_points = new FE_value[2*number_of_points];
+		unsigned int *vertex_indices = 0;
+		unsigned int number_of_new_vertices = number_of_points;
 		int replaceRequired = 0;
 		/* find if vertex already in the array */
 		int vertex_location = array->find_first_fast_search_id_location(elementIndex);
@@ -1995,6 +2435,48 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 					}
 				}
 			}
+			/* evaluate coordinates and derivatives at all points together if the
+			 * coordinate field is directly a finite element field: on a grid for
+			 * square elements, otherwise with basis tables shared by elements with
+			 * the same tessellation */
+			std::vector<FE_value> grid_coordinate_values;
+			if ((LINE_SHAPE == shape_type) &&
+				(number_of_points == number_of_points_in_xi1*number_of_points_in_xi2))
+			{
+				std::vector<FE_value> grid_xi(number_of_points_in_xi1 + number_of_points_in_xi2);
+				for (i = 0; i < number_of_points_in_xi1; i++)
+					grid_xi[i] = xi_points[2*i];
+				for (j = 0; j < number_of_points_in_xi2; j++)
+					grid_xi[number_of_points_in_xi1 + j] = xi_points[2*j*number_of_points_in_xi1 + 1];
+				const FE_value *grid_xi_pointers[2] = { grid_xi.data(), grid_xi.data() + number_of_points_in_xi1 };
+				const int grid_numbers_of_points[2] = { number_of_points_in_xi1, number_of_points_in_xi2 };
+				grid_coordinate_values.resize(number_of_points*3*coordinate_dimension);
+				if (!cmzn_field_evaluate_real_grid(coordinate_field, field_cache, element, top_level_element,
+					grid_numbers_of_points, grid_xi_pointers, /*meshDerivativeOrder*/1, grid_coordinate_values.data()))
+				{
+					grid_coordinate_values.clear();
+				}
+			}
+			else if (SIMPLEX_SHAPE == shape_type)
+			{
+				grid_coordinate_values.resize(number_of_points*3*coordinate_dimension);
+				if (!cmzn_field_evaluate_real_table(coordinate_field, field_cache, element, top_level_element,
+					number_of_points, xi_points, /*meshDerivativeOrder*/1, grid_coordinate_values.data()))
+				{
+					grid_coordinate_values.clear();
+				}
+			}
+			/* get vertices shared with adjacent square elements along common faces */
+			if (share_vertices && (vertex_location < 0) && (LINE_SHAPE == shape_type) &&
+				(ELEMENT_NOT_COLLAPSED == collapsed_element))
+			{
+				vertex_indices = new unsigned int[number_of_points];
+				number_of_new_vertices = FE_element_surface_get_shared_vertex_indices(
+					element, field_cache, d_dxi1, d_dxi2, array, coordinate_field,
+					coordinate_dimension, number_of_points_in_xi1, number_of_points_in_xi2,
+					reverse_winding, (0 != modified_reverse_normals), top_level_element,
+					vertex_start, vertex_indices);
+			}
 			/* calculate the points, normals and data */
 			normal=normalpoints;
 			calculate_tangent_points = 0;
@@ -2020,9 +2502,51 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 			FE_value *xi = xi_points;
 			while ((i<number_of_points)&&return_code)
 			{
+				if (vertex_indices && (vertex_indices[i] < vertex_start))
+				{
+					/* vertex shared with adjacent element: only get normal here to
+					 * average with those of the other elements using it */
+					if (!grid_coordinate_values.empty())
+					{
+						const FE_value *grid_values = grid_coordinate_values.data() + i*3*coordinate_dimension;
+						for (int c = 0; c < coordinate_dimension; ++c)
+						{
+							derivative_xi1[c] = grid_values[coordinate_dimension + 2*c];
+							derivative_xi2[c] = grid_values[coordinate_dimension + 2*c + 1];
+						}
+					}
+					else if ((CMZN_OK != field_cache->setIndexedMeshLocation(static_cast<unsigned int>(i), element, xi, top_level_element)) ||
+						(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
+							d_dxi1, field_cache, coordinate_dimension, derivative_xi1)) ||
+						(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
+							d_dxi2, field_cache, coordinate_dimension, derivative_xi2)))
+					{
+						return_code = 0;
+						break;
+					}
+					(*normal)[0] = ZnReal(derivative_xi1[1]*derivative_xi2[2] - derivative_xi2[1]*derivative_xi1[2]);
+					(*normal)[1] = ZnReal(derivative_xi1[2]*derivative_xi2[0] - derivative_xi2[2]*derivative_xi1[0]);
+					(*normal)[2] = ZnReal(derivative_xi1[0]*derivative_xi2[1] - derivative_xi2[0]*derivative_xi1[1]);
+					normal++;
+					if (texture_coordinate_field)
+						tangent++;
+					xi += 2;
+					i++;
+					continue;
+				}
 				return_code = (CMZN_OK == field_cache->setIndexedMeshLocation(static_cast<unsigned int>(i), element, xi, top_level_element));
 				/* evaluate the fields */
-				if ((CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
+				if (!grid_coordinate_values.empty())
+				{
+					const FE_value *grid_values = grid_coordinate_values.data() + i*3*coordinate_dimension;
+					for (int c = 0; c < coordinate_dimension; ++c)
+					{
+						coordinates[c] = grid_values[c];
+						derivative_xi1[c] = grid_values[coordinate_dimension + 2*c];
+						derivative_xi2[c] = grid_values[coordinate_dimension + 2*c + 1];
+					}
+				}
+				else if ((CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
 						d_dxi1, field_cache, coordinate_dimension, derivative_xi1)) ||
 					(CMZN_OK != cmzn_field_evaluate_derivative(coordinate_field,
 						d_dxi2, field_cache, coordinate_dimension, derivative_xi2)) ||
@@ -2351,8 +2875,15 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 						floatField[2] = (GLfloat)(*normal)[2];
 						if (vertex_location < 0)
 						{
-							array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-								3, 1, floatField);
+							if ((!vertex_indices) || (vertex_indices[number_of_points - i] >= vertex_start))
+							{
+								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+									3, 1, floatField);
+							}
+							else
+							{
+								array->add_shared_vertex_normal(vertex_indices[number_of_points - i], floatField);
+							}
 						}
 						else
 						{
@@ -2378,8 +2909,15 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 						floatField[2] = (GLfloat)(*normal)[2];
 						if (vertex_location < 0)
 						{
-							array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-								3, 1, floatField);
+							if ((!vertex_indices) || (vertex_indices[number_of_points - i] >= vertex_start))
+							{
+								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+									3, 1, floatField);
+							}
+							else
+							{
+								array->add_shared_vertex_normal(vertex_indices[number_of_points - i], floatField);
+							}
 						}
 						else
 						{
@@ -2407,8 +2945,11 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 						floatField[2] = (GLfloat)(*tangent)[2];
 						if (vertex_location < 0)
 						{
-							array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TANGENT,
-								3, 1, floatField);
+							if ((!vertex_indices) || (vertex_indices[number_of_points - i] >= vertex_start))
+							{
+								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TANGENT,
+									3, 1, floatField);
+							}
 						}
 						else
 						{
@@ -2424,7 +2965,7 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 		}
 		if (return_code && (vertex_location < 0))
 		{
-			unsigned int number_of_vertices = number_of_points;
+			unsigned int number_of_vertices = vertex_indices ? number_of_new_vertices : number_of_points;
 			unsigned int number_of_xi1 = number_of_points_in_xi1;
 			unsigned int number_of_xi2 = number_of_points_in_xi2;
 			int polygonType = (int)polygon_type;
@@ -2445,23 +2986,23 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 					ARRAY_SHAPE_TYPE_SIMPLEX);
 			else
 				array->fill_element_index(vertex_start, number_of_xi1, number_of_xi2,
-					ARRAY_SHAPE_TYPE_UNSPECIFIED);
+					ARRAY_SHAPE_TYPE_UNSPECIFIED, vertex_indices);
+			if (vertex_indices)
+				FE_element_surface_add_shared_edge_vertices(element, array,
+					number_of_points_in_xi1, number_of_points_in_xi2, reverse_winding, vertex_indices);
 		}
 		if (replaceRequired)
 		{
-			unsigned int number_of_vertices = number_of_points;
 			int updated = 0;
 			array->replace_integer_vertex_buffer_at_position(
 				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED,
 				vertex_location, 1, 1, &updated);
-			array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW,
-					1, 1, &vertex_start);
-			array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW_COUNT,
-					1, 1, &number_of_vertices);
+			array->add_partial_redraw_range(vertex_start, number_of_points);
 		}
 
 		delete[] floatData;
 		delete[] xi_points;
+		delete[] vertex_indices;
 		cmzn_differentialoperator_destroy(&d_dxi1);
 		cmzn_differentialoperator_destroy(&d_dxi2);
 		DEALLOCATE(normalpoints);
@@ -2675,6 +3216,27 @@ int add_glyphset_vertex_from_FE_element(
 				name = names;
 				label = labels;
 				GLfloat *data_value = data;
+				/* evaluate coordinates at all points together if drawing all and the
+				 * coordinate field is directly a finite element field */
+				const int coordinate_dimension = cmzn_field_get_number_of_components(coordinate_field);
+				std::vector<FE_value> points_coordinates;
+				if (draw_all)
+				{
+					std::vector<FE_value> points_xi(number_of_xi_points*element_dimension);
+					for (i = 0; i < number_of_xi_points; i++)
+					{
+						for (j = 0; j < element_dimension; j++)
+						{
+							points_xi[i*element_dimension + j] = xi_points[i][j];
+						}
+					}
+					points_coordinates.resize(number_of_xi_points*coordinate_dimension);
+					if (!cmzn_field_evaluate_real_points(coordinate_field, field_cache, element, top_level_element,
+						number_of_xi_points, points_xi.data(), /*meshDerivativeOrder*/0, points_coordinates.data()))
+					{
+						points_coordinates.clear();
+					}
+				}
 				for (i = 0; i < number_of_xi_points; i++)
 				{
 					if (point_numbers)
@@ -2704,6 +3266,13 @@ int add_glyphset_vertex_from_FE_element(
 						xi[0] = xi_points[i][0];
 						xi[1] = xi_points[i][1];
 						xi[2] = xi_points[i][2];
+						if (!points_coordinates.empty())
+						{
+							for (j = 0; j < coordinate_dimension; j++)
+							{
+								coordinates[j] = points_coordinates[i*coordinate_dimension + j];
+							}
+						}
 						/* evaluate all the fields in order orientation_scale, coordinate
 							 then data (if each specified). Reason for this order is that the
 							 orientation_scale field very often requires the evaluation of the
@@ -2716,7 +3285,8 @@ int add_glyphset_vertex_from_FE_element(
 							((!variable_scale_field) ||
 								(CMZN_OK == cmzn_field_evaluate_real(variable_scale_field, field_cache,
 									number_of_variable_scale_components, variable_scale))) &&
-							(CMZN_OK == cmzn_field_evaluate_real(coordinate_field, field_cache, /*number_of_components*/3, coordinates)) &&
+							((!points_coordinates.empty()) ||
+								(CMZN_OK == cmzn_field_evaluate_real(coordinate_field, field_cache, /*number_of_components*/3, coordinates))) &&
 							((!data_field) ||
 								(CMZN_OK == cmzn_field_evaluate_real(data_field, field_cache, n_data_components, feData))) &&
 							((!label_field) ||
@@ -22,6 +22,9 @@ The function prototypes for creating graphical objects from finite elements.
 #include "graphics/auxiliary_graphics_types.h"
 #include "graphics/graphics_object.h"
 #include "graphics/volume_texture.h"
+#include <vector>
+
+class FE_mesh;
 
 /*
 Global types
@@ -211,6 +214,9 @@ int FE_element_add_line_to_vertex_array(struct FE_element *element,
  * @param field_cache  cmzn_fieldcache for evaluating fields. Time is expected
  * to be set in the field_cache if needed.
  * @param surface_mesh  2-D surface mesh being converted to surface graphics.
+ * @param share_vertices  If true, reuse vertices already in the array along
+ * faces of square elements shared with adjacent elements, and record this
+ * element's face vertices for reuse. Only valid on first build of element.
 */
 int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 	cmzn_fieldcache_id field_cache, cmzn_mesh_id surface_mesh,
@@ -220,7 +226,8 @@ int FE_element_add_surface_to_vertex_array(struct FE_element *element,
 	struct Computed_field *data_field,
 	unsigned int number_of_segments_in_xi1_requested,
 	unsigned int number_of_segments_in_xi2_requested,
-	char reverse_normals, struct FE_element *top_level_element);
+	char reverse_normals, struct FE_element *top_level_element,
+	bool share_vertices = false);
 
 /***************************************************************************//**
  * Fills the array with coordinates from the <coordinate_field> and the radius for
@@ -252,6 +259,78 @@ int FE_element_add_cylinder_to_vertex_array(struct FE_element *element,
 	struct Computed_field *texture_coordinate_field,
 	struct FE_element *top_level_element);
 
+/**
+ * Reduces the numbers of segments in each xi direction of a 1-D or 2-D element
+ * to the fewest for which the deviation of each linear segment from the
+ * curved coordinate field is estimated to be within tolerance times the
+ * segment length, but no fewer than the minimum. The estimate uses first
+ * and second xi derivatives sampled at xi = 0, 0.5 and 1 in each direction.
+ * Only 1-D elements and 2-D square elements with all faces are reduced.
+ * Surfaces must then make numbers agree with adjacent elements with
+ * FE_mesh_adaptive_segments.
+ * If second derivatives cannot be evaluated the discretization is unchanged.
+ * @param mesh  Mesh of element's dimension for getting chart derivatives.
+ * @param coordinate_field  Rectangular cartesian coordinate field.
+ * @param tolerance  Maximum ratio of chord deviation to chord length, > 0.
+ * @param minimum_number_in_xi  Minimum number of segments in each xi direction.
+ * @param number_in_xi  On input, the maximum number of segments in each xi
+ * direction as used without adaptive tessellation; on output the reduced
+ * number of segments.
+ * @return  1 on success, 0 if invalid arguments.
+ */
+int FE_element_get_adaptive_discretization(struct FE_element *element,
+	cmzn_fieldcache_id field_cache, cmzn_mesh_id mesh,
+	struct Computed_field *coordinate_field, struct FE_element *top_level_element,
+	FE_value tolerance, const int *minimum_number_in_xi, int *number_in_xi);
+
+/**
+ * Numbers of segments for adaptive tessellation of 2-D square elements, made
+ * equal along lines shared by adjacent elements so they have the same
+ * vertices there, without T-junctions or cracks. Since opposite faces of a
+ * square element have the same number of segments, each chain of elements
+ * joined through opposite faces uses the most segments any of them needs.
+ * All elements of the mesh must be added before numbers are got.
+ */
+class FE_mesh_adaptive_segments
+{
+	FE_mesh *fe_mesh;  // not accessed
+	/* 1 for each square element added, otherwise 0 */
+	std::vector<unsigned char> elementAdded;
+	/* lines joined through opposite faces of square elements, by line index:
+	 * parent line in join tree, and number of segments held by root line */
+	std::vector<DsLabelIndex> lineParents;
+	std::vector<int> lineSegments;
+
+	FE_mesh_adaptive_segments(const FE_mesh_adaptive_segments&);  // not implemented
+	FE_mesh_adaptive_segments& operator=(const FE_mesh_adaptive_segments&);  // not implemented
+
+	DsLabelIndex getLineRoot(DsLabelIndex lineIndex);
+
+	void joinLines(DsLabelIndex lineIndex1, DsLabelIndex lineIndex2, int numberOfSegments);
+
+public:
+	/** @param fe_mesh  2-D mesh with faces defined. */
+	FE_mesh_adaptive_segments(FE_mesh *fe_mesh);
+
+	/**
+	 * Add the numbers of segments needed in a square element. Does nothing
+	 * for other elements. Lines shared with elements which are not square
+	 * get the maximum numbers of segments, as used in those elements.
+	 * @param numberInXi  Numbers of segments needed in xi1, xi2.
+	 * @param maximumNumberInXi  Numbers of segments in xi1, xi2 without
+	 * adaptive tessellation.
+	 */
+	void addElement(DsLabelIndex elementIndex, const int *numberInXi,
+		const int *maximumNumberInXi);
+
+	/**
+	 * Get numbers of segments in xi1, xi2 agreed for element.
+	 * @return  True if element was added, otherwise false with numberInXi
+	 * unchanged.
+	 */
+	bool getElementSegments(DsLabelIndex elementIndex, int *numberInXi);
+};
+
 /****************************************************************************//**
  * Sorts out how standard, polygon and simplex elements are segmented, based on
  * numbers of segments requested for "square" elements.
@@ -8,13 +8,19 @@
 * This Source Code Form is subject to the terms of the Mozilla Public
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <atomic>
+#include <functional>
 #include <list>
 #include <map>
+#include <vector>
 #include "opencmiss/zinc/differentialoperator.h"
 #include "opencmiss/zinc/fieldcache.h"
+#include "opencmiss/zinc/fieldimage.h"
+#include "opencmiss/zinc/fieldmodule.h"
 #include "opencmiss/zinc/mesh.h"
 #include "opencmiss/zinc/status.h"
 #include "computed_field/computed_field.h"
+#include "computed_field/computed_field_image.h"
 #include "computed_field/computed_field_wrappers.h"
 #include "computed_field/field_cache.hpp"
 #include "finite_element/finite_element.h"
@@ -23,7 +29,9 @@
 #include "finite_element/finite_element_to_iso_surfaces.h"
 #include "general/debug.h"
 #include "general/matrix_vector.h"
+#include "general/parallel.hpp"
 #include "graphics/graphics_object.hpp"
+#include "graphics/marching_cubes.hpp"
 #include "graphics/volume_texture.h"
 #include "general/message.h"
 
@@ -39,6 +47,9 @@ public:
 	int number_of_data_components, number_of_iso_values;
 	struct Computed_field *coordinate_field, *data_field, *scalar_field,
 		*texture_coordinate_field;
+	/* true if scalar field is or depends on an image field, so is sampled on
+	 * a grid and extracted with parallel marching cubes */
+	bool image_scalar_field;
 
 public:
 	double get_iso_value(int iso_value_number) const;
@@ -219,6 +230,8 @@ class Iso_mesh
 {
 public:
 	Iso_vertex_map vertex_map;
+	// vertices added without point index pair, already welded
+	std::vector<Iso_vertex*> vertex_list;
 	Iso_triangle_list triangle_list;
 
 	Iso_mesh() :
@@ -238,6 +251,10 @@ public:
 			Iso_vertex *vertex = vertex_iter->second;
 			delete (vertex);
 		}
+		for (std::vector<Iso_vertex*>::iterator vertex_iter = vertex_list.begin(); vertex_iter != vertex_list.end(); vertex_iter++)
+		{
+			delete (*vertex_iter);
+		}
 	}
 
 	const Iso_vertex *get_vertex(const Point_index_pair& pp) const
@@ -257,6 +274,13 @@ public:
 		return vertex;
 	}
 
+	/** transfers ownership of vertex to mesh; not found by get_vertex */
+	const Iso_vertex *add_vertex(Iso_vertex* vertex)
+	{
+		vertex_list.push_back(vertex);
+		return vertex;
+	}
+
 	/**
 	 *      3
 	 *     / \
@@ -592,6 +616,9 @@ private:
 	int last_mesh_number;
 	Iso_mesh *last_mesh;
 
+	bool sample_image_grid(cmzn_fieldmodule_id fieldmodule, FE_value time,
+		cmzn_field_image_id image_field, const int *sizes, std::vector<double>& scalars);
+
 public:
 	Isosurface_builder(FE_element *element, cmzn_fieldcache_id field_cache, cmzn_mesh_id mesh,
 		int requested_number_in_xi1, int requested_number_in_xi2, int requested_number_in_xi3,
@@ -599,8 +626,16 @@ public:
 
 	~Isosurface_builder();
 
+	/** @return  True if element can be swept with sweep_grid(). */
+	bool can_sweep_grid() const
+	{
+		return cube && (!polygon12) && (!polygon13) && (!polygon23);
+	}
+
 	int sweep();
 
+	int sweep_grid();
+
 	int fill_graphics(struct Graphics_vertex_array *array);
 
 	void add_vertex_array_entries(struct Graphics_vertex_array *array,
@@ -1776,6 +1811,311 @@ int Isosurface_builder::sweep()
 	return (return_code);
 }
 
+/**
+ * Call function for indexes 0 to count - 1 on several threads, each with its
+ * own field cache at time. The first index is processed alone so anything
+ * fields build on first evaluation exists before other threads start.
+ * @return  True if all calls succeeded.
+ */
+static bool Isosurface_builder_run_in_parallel(cmzn_fieldmodule_id fieldmodule,
+	FE_value time, int count, const std::function<bool(cmzn_fieldcache_id, int)>& function)
+{
+	if (count <= 0)
+		return true;
+	const int thread_count = CMZN::parallel_get_thread_count(static_cast<size_t>(count));
+	std::vector<cmzn_fieldcache_id> fieldcaches(thread_count);
+	for (int t = 0; t < thread_count; ++t)
+	{
+		fieldcaches[t] = cmzn_fieldmodule_create_fieldcache(fieldmodule);
+		cmzn_fieldcache_set_time(fieldcaches[t], time);
+	}
+	std::atomic<bool> success(function(fieldcaches[0], 0));
+	CMZN::parallel_for(1, static_cast<size_t>(count), thread_count,
+		[&](int thread_index, size_t index)
+		{
+			if (!function(fieldcaches[thread_index], static_cast<int>(index)))
+				success = false;
+		});
+	for (int t = 0; t < thread_count; ++t)
+		cmzn_fieldcache_destroy(&fieldcaches[t]);
+	return success;
+}
+
+/**
+ * Sample image field at all grid points for sweep_grid. Texture coordinates
+ * are evaluated at all points, then bricks of grid cells are checked against
+ * the image's min/max range tree: points only in bricks whose texture
+ * coordinates cannot give values spanning any iso-value are set to a value
+ * from the brick's range instead of being sampled, which is on the same side
+ * of every iso-value as the true values. Other points are sampled in batches.
+ * @return  True on success.
+ */
+bool Isosurface_builder::sample_image_grid(cmzn_fieldmodule_id fieldmodule,
+	FE_value time, cmzn_field_image_id image_field, const int *sizes,
+	std::vector<double>& scalars)
+{
+	const int brick_size = 8;
+	const int point_plane_size = sizes[0]*sizes[1];
+	cmzn_field_id domain_field = cmzn_field_image_get_domain_field(image_field);
+	const int coordinate_count = std::min(3, cmzn_field_get_number_of_components(domain_field));
+	std::vector<double> texture_coordinates(scalars.size()*coordinate_count);
+	auto evaluate_plane = [this, sizes, domain_field, coordinate_count, point_plane_size,
+		&texture_coordinates](cmzn_fieldcache_id plane_field_cache, int k)
+	{
+		FE_value xi[3], coordinates[3];
+		xi[2] = k*this->delta_xi3;
+		double *plane_coordinates = texture_coordinates.data() +
+			static_cast<size_t>(k)*point_plane_size*coordinate_count;
+		for (int j = 0; j < sizes[1]; ++j)
+		{
+			xi[1] = j*this->delta_xi2;
+			for (int i = 0; i < sizes[0]; ++i)
+			{
+				xi[0] = i*this->delta_xi1;
+				if ((CMZN_OK != plane_field_cache->setMeshLocation(this->element, xi)) ||
+					(CMZN_OK != cmzn_field_evaluate_real(domain_field, plane_field_cache, coordinate_count, coordinates)))
+				{
+					return false;
+				}
+				double *point_coordinates = plane_coordinates + (j*sizes[0] + i)*coordinate_count;
+				for (int c = 0; c < coordinate_count; ++c)
+					point_coordinates[c] = static_cast<double>(coordinates[c]);
+			}
+		}
+		return true;
+	};
+	bool success = (0 < coordinate_count) &&
+		Isosurface_builder_run_in_parallel(fieldmodule, time, sizes[2], evaluate_plane);
+	cmzn_field_destroy(&domain_field);
+	if (!success)
+		return false;
+	// bricks of cells include the points on their upper faces
+	const int brick_counts[3] = { (sizes[0] - 2)/brick_size + 1,
+		(sizes[1] - 2)/brick_size + 1, (sizes[2] - 2)/brick_size + 1 };
+	const int brick_layer_size = brick_counts[0]*brick_counts[1];
+	const int brick_count = brick_layer_size*brick_counts[2];
+	std::vector<unsigned char> active_bricks(brick_count, 1);
+	std::vector<double> brick_values(brick_count);
+	auto check_brick_layer = [this, sizes, brick_counts, brick_layer_size, coordinate_count,
+		point_plane_size, &texture_coordinates, &active_bricks, &brick_values](cmzn_fieldcache_id, int bk)
+	{
+		const int k0 = bk*brick_size;
+		const int k1 = std::min(k0 + brick_size, sizes[2] - 1);
+		for (int bj = 0; bj < brick_counts[1]; ++bj)
+		{
+			const int j0 = bj*brick_size;
+			const int j1 = std::min(j0 + brick_size, sizes[1] - 1);
+			for (int bi = 0; bi < brick_counts[0]; ++bi)
+			{
+				const int i0 = bi*brick_size;
+				const int i1 = std::min(i0 + brick_size, sizes[0] - 1);
+				double minimum_coordinates[3], maximum_coordinates[3];
+				for (int c = 0; c < coordinate_count; ++c)
+				{
+					minimum_coordinates[c] = maximum_coordinates[c] =
+						texture_coordinates[(static_cast<size_t>(k0)*point_plane_size + j0*sizes[0] + i0)*coordinate_count + c];
+				}
+				for (int k = k0; k <= k1; ++k)
+					for (int j = j0; j <= j1; ++j)
+					{
+						const double *point_coordinates = texture_coordinates.data() +
+							(static_cast<size_t>(k)*point_plane_size + j*sizes[0] + i0)*coordinate_count;
+						for (int i = i0; i <= i1; ++i)
+							for (int c = 0; c < coordinate_count; ++c, ++point_coordinates)
+							{
+								minimum_coordinates[c] = std::min(minimum_coordinates[c], *point_coordinates);
+								maximum_coordinates[c] = std::max(maximum_coordinates[c], *point_coordinates);
+							}
+					}
+				double minimum, maximum;
+				const int brick = bk*brick_layer_size + bj*brick_counts[0] + bi;
+				if (!Computed_field_image_get_texture_coordinates_range(this->scalar_field, coordinate_count,
+					minimum_coordinates, maximum_coordinates, &minimum, &maximum))
+				{
+					continue;
+				}
+				bool active = false;
+				for (int v = 0; (v < this->number_of_iso_values) && (!active); ++v)
+				{
+					const double iso_value = this->specification.get_iso_value(v);
+					active = (minimum <= iso_value) && (maximum > iso_value);
+				}
+				active_bricks[brick] = active ? 1 : 0;
+				brick_values[brick] = 0.5*(minimum + maximum);
+			}
+		}
+		return true;
+	};
+	Isosurface_builder_run_in_parallel(fieldmodule, time, brick_counts[2], check_brick_layer);
+	// fill points of skipped bricks, then mark points of sampled bricks
+	std::vector<unsigned char> sample_points(scalars.size(), 0);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int brick = 0; brick < brick_count; ++brick)
+		{
+			if (active_bricks[brick] != pass)
+				continue;
+			const int bk = brick/brick_layer_size;
+			const int bj = (brick % brick_layer_size)/brick_counts[0];
+			const int bi = brick % brick_counts[0];
+			const int k0 = bk*brick_size, k1 = std::min(k0 + brick_size, sizes[2] - 1);
+			const int j0 = bj*brick_size, j1 = std::min(j0 + brick_size, sizes[1] - 1);
+			const int i0 = bi*brick_size, i1 = std::min(i0 + brick_size, sizes[0] - 1);
+			for (int k = k0; k <= k1; ++k)
+				for (int j = j0; j <= j1; ++j)
+				{
+					const size_t row = static_cast<size_t>(k)*point_plane_size + j*sizes[0];
+					if (pass)
+						std::fill(sample_points.begin() + row + i0, sample_points.begin() + row + i1 + 1, 1);
+					else
+						std::fill(scalars.begin() + row + i0, scalars.begin() + row + i1 + 1, brick_values[brick]);
+				}
+		}
+	}
+	auto sample_plane = [image_field, coordinate_count, point_plane_size,
+		&texture_coordinates, &sample_points, &scalars](cmzn_fieldcache_id, int k)
+	{
+		const size_t plane_start = static_cast<size_t>(k)*point_plane_size;
+		std::vector<int> point_indexes;
+		std::vector<double> point_coordinates;
+		for (int p = 0; p < point_plane_size; ++p)
+		{
+			if (sample_points[plane_start + p])
+			{
+				point_indexes.push_back(p);
+				point_coordinates.insert(point_coordinates.end(),
+					texture_coordinates.begin() + (plane_start + p)*coordinate_count,
+					texture_coordinates.begin() + (plane_start + p + 1)*coordinate_count);
+			}
+		}
+		const int point_count = static_cast<int>(point_indexes.size());
+		if (0 == point_count)
+			return true;
+		std::vector<double> values(point_count);
+		if (CMZN_OK != cmzn_field_image_evaluate_samples(image_field, point_count, coordinate_count,
+			point_coordinates.data(), point_count, values.data()))
+		{
+			return false;
+		}
+		for (int n = 0; n < point_count; ++n)
+			scalars[plane_start + point_indexes[n]] = values[n];
+		return true;
+	};
+	return Isosurface_builder_run_in_parallel(fieldmodule, time, sizes[2], sample_plane);
+}
+
+/**
+ * Alternative to sweep() for cube elements, used for scalar fields sampled
+ * from images where grids are large. Evaluates the scalar field at all grid
+ * points in parallel planes, then for each iso-value extracts a welded surface
+ * with parallel marching cubes, skipping bricks of cells which cannot contain
+ * it, and evaluates fields at the surface vertices in parallel.
+ */
+int Isosurface_builder::sweep_grid()
+{
+	const int sizes[3] = { number_in_xi1 + 1, number_in_xi2 + 1, number_in_xi3 + 1 };
+	const int point_plane_size = sizes[0]*sizes[1];
+	std::vector<double> scalars(static_cast<size_t>(point_plane_size)*sizes[2]);
+	cmzn_fieldmodule_id fieldmodule = cmzn_mesh_get_fieldmodule(this->mesh);
+	const FE_value time = this->field_cache->getTime();
+	auto evaluate_plane = [this, &sizes, &scalars, point_plane_size](cmzn_fieldcache_id plane_field_cache, int k)
+	{
+		FE_value xi[3], scalar_FE_value;
+		xi[2] = k*this->delta_xi3;
+		double *plane_scalars = scalars.data() + static_cast<size_t>(k)*point_plane_size;
+		for (int j = 0; j < sizes[1]; ++j)
+		{
+			xi[1] = j*this->delta_xi2;
+			for (int i = 0; i < sizes[0]; ++i)
+			{
+				xi[0] = i*this->delta_xi1;
+				if ((CMZN_OK != plane_field_cache->setMeshLocation(this->element, xi)) ||
+					(CMZN_OK != cmzn_field_evaluate_real(this->scalar_field, plane_field_cache, 1, &scalar_FE_value)))
+				{
+					return false;
+				}
+				plane_scalars[j*sizes[0] + i] = static_cast<double>(scalar_FE_value);
+			}
+		}
+		return true;
+	};
+	// image fields are sampled in batches, skipping bricks that cannot contain an iso-value
+	cmzn_field_image_id image_field = cmzn_field_cast_image(this->scalar_field);
+	int return_code = ((image_field) ?
+		this->sample_image_grid(fieldmodule, time, image_field, sizes, scalars) :
+		Isosurface_builder_run_in_parallel(fieldmodule, time, sizes[2], evaluate_plane)) ? 1 : 0;
+	cmzn_field_image_destroy(&image_field);
+	if (return_code)
+	{
+		MarchingCubes marching_cubes(sizes, scalars.data());
+		MarchingCubes::Mesh grid_mesh;
+		std::vector<Iso_vertex*> vertices;
+		for (int v = 0; (v < number_of_iso_values) && return_code; v++)
+		{
+			current_iso_value_number = v;
+			current_iso_value = specification.get_iso_value(v);
+			if (!marching_cubes.extract(current_iso_value, grid_mesh))
+			{
+				return_code = 0;
+				break;
+			}
+			if (0 == grid_mesh.getTriangleCount())
+				continue;
+			Iso_mesh& iso_mesh = get_mesh();
+			const int vertex_count = grid_mesh.getVertexCount();
+			vertices.resize(vertex_count);
+			for (int n = 0; n < vertex_count; ++n)
+			{
+				vertices[n] = new Iso_vertex();
+				iso_mesh.add_vertex(vertices[n]);
+			}
+			auto evaluate_vertex = [this, &grid_mesh, &vertices](cmzn_fieldcache_id vertex_field_cache, int n)
+			{
+				Iso_vertex *vertex = vertices[n];
+				const double *position = grid_mesh.positions.data() + n*3;
+				vertex->xi[0] = position[0]*this->delta_xi1;
+				vertex->xi[1] = position[1]*this->delta_xi2;
+				vertex->xi[2] = position[2]*this->delta_xi3;
+				if ((CMZN_OK != vertex_field_cache->setMeshLocation(this->element, vertex->xi)) ||
+					(CMZN_OK != cmzn_field_evaluate_real(this->coordinate_field, vertex_field_cache, 3, vertex->coordinates)))
+				{
+					return false;
+				}
+				if ((this->texture_coordinate_field) && (CMZN_OK != cmzn_field_evaluate_real(
+					this->texture_coordinate_field, vertex_field_cache, 3, vertex->texture_coordinates)))
+				{
+					return false;
+				}
+				if (this->data_field)
+				{
+					FE_value *data = new FE_value[this->number_of_data_components];
+					vertex->set_data(data);
+					if (CMZN_OK != cmzn_field_evaluate_real(this->data_field, vertex_field_cache,
+						this->number_of_data_components, data))
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			if (!Isosurface_builder_run_in_parallel(fieldmodule, time, vertex_count, evaluate_vertex))
+			{
+				return_code = 0;
+				break;
+			}
+			const int *triangle_vertices = grid_mesh.triangles.data();
+			const int triangle_count = grid_mesh.getTriangleCount();
+			for (int t = 0; t < triangle_count; ++t, triangle_vertices += 3)
+			{
+				iso_mesh.add_triangle(vertices[triangle_vertices[0]],
+					vertices[triangle_vertices[1]], vertices[triangle_vertices[2]]);
+			}
+		}
+	}
+	cmzn_fieldmodule_destroy(&fieldmodule);
+	return (return_code);
+}
+
 bool Isosurface_builder::reverse_winding()
 {
 	FE_value result[3], winding_coordinate_derivative1[3],
@@ -2032,6 +2372,12 @@ Global functions
 ----------------
 */
 
+/** Iterator function stopping at the first image field. */
+static int Computed_field_is_not_image_type(struct Computed_field *field, void *dummy_void)
+{
+	return (Computed_field_is_image_type(field, dummy_void)) ? 0 : 1;
+}
+
 struct Iso_surface_specification *Iso_surface_specification_create(
 	int number_of_iso_values, const double *iso_values,
 	double first_iso_value, double last_iso_value,
@@ -2057,6 +2403,8 @@ struct Iso_surface_specification *Iso_surface_specification_create(
 			specification->scalar_field = ACCESS(Computed_field)(scalar_field);
 			specification->texture_coordinate_field =
 				(NULL != texture_coordinate_field) ? ACCESS(Computed_field)(texture_coordinate_field) : NULL;
+			specification->image_scalar_field = (0 == Computed_field_for_each_ancestor(
+				scalar_field, Computed_field_is_not_image_type, NULL));
 			specification->number_of_data_components = (NULL != data_field) ?
 				cmzn_field_get_number_of_components(data_field) : 0;
 			specification->iso_values = NULL;
@@ -2143,7 +2491,14 @@ int create_iso_surfaces_from_FE_element(struct FE_element *element,
 		{
 			Isosurface_builder iso_builder(element, field_cache, mesh,
 				number_in_xi[0], number_in_xi[1], number_in_xi[2], *specification);
-			return_code = iso_builder.sweep();
+			if (specification->image_scalar_field && iso_builder.can_sweep_grid())
+			{
+				return_code = iso_builder.sweep_grid();
+			}
+			else
+			{
+				return_code = iso_builder.sweep();
+			}
 			if (return_code)
 			{
 				return_code = iso_builder.fill_graphics(array);
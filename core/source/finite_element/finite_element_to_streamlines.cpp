@@ -15,6 +15,11 @@ Functions for calculating streamlines in finite elements.
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include "opencmiss/zinc/fieldcache.h"
+#include "opencmiss/zinc/fieldmodule.h"
 #include "computed_field/computed_field.h"
 #include "finite_element/finite_element_to_graphics_object.h"
 #include "finite_element/finite_element_region.h"
@@ -22,6 +27,7 @@ Functions for calculating streamlines in finite elements.
 #include "general/debug.h"
 #include "general/geometry.h"
 #include "general/matrix_vector.h"
+#include "general/parallel.hpp"
 #include "general/random.h"
 #include "graphics/graphics_object.h"
 #include "graphics/graphics_object.hpp"
@@ -166,450 +172,243 @@ calculating the inverse of the Jacobian matrix <dxdxi> and multiplying.
 	return (return_code);
 } /* calculate_delta_xi */
 
-static int update_adaptive_imp_euler(cmzn_fieldcache_id field_cache,
-	struct Computed_field *coordinate_field,
-	struct Computed_field *stream_vector_field,int reverse_track,
-	struct FE_element **element,FE_value *xi,
-	FE_value *point,FE_value *step_size,
-	FE_value *total_stepped, int *keep_tracking)
-/*******************************************************************************
-LAST MODIFIED : 23 June 2004
+/**
+ * Evaluates the rate of change of xi following the stream vector field at the
+ * location in element, and the coordinate derivatives there.
+ * @param dxdxi  Receives vector_dimension*element_dimension derivatives.
+ * @param dxi_dt  Receives MAXIMUM_ELEMENT_XI_DIMENSIONS rates, 0 if unused.
+ */
+static int evaluate_streamline_dxi_dt(cmzn_fieldcache_id field_cache,
+	struct Computed_field *coordinate_field, struct Computed_field *stream_vector_field,
+	int reverse_track, struct FE_element *element, int element_dimension,
+	int vector_dimension, const FE_value *xi, FE_value *dxdxi, FE_value *dxi_dt)
+{
+	FE_value coordinates[MAXIMUM_ELEMENT_XI_DIMENSIONS],
+		vector[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	if ((CMZN_OK != field_cache->setMeshLocation(element, xi)) ||
+		(CMZN_OK != cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
+			vector_dimension, coordinates, /*number_of_derivatives*/element_dimension, dxdxi)) ||
+		(CMZN_OK != cmzn_field_evaluate_real(stream_vector_field, field_cache,
+			MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector)))
+	{
+		return 0;
+	}
+	if (reverse_track)
+	{
+		for (int i = 0; i < vector_dimension; ++i)
+			vector[i] = -vector[i];
+	}
+	return calculate_delta_xi(vector_dimension, vector, element_dimension, dxdxi, dxi_dt);
+}
 
-DESCRIPTION :
-Update the xi coordinates using the <stream_vector_field> with adaptive step
-size control and the improved euler method.  The function updates the <total_stepped>.
-If <reverse_track> is true, the reverse of vector field is tracked.
-==============================================================================*/
+/** Integration state carried between steps along a streamline */
+struct Streamline_step_state
+{
+	/* step size in time from the last step, 0 before first step */
+	FE_value step_size;
+	/* true if dxi_dt and dxdxi are valid at the current location: the last
+	 * stage of an accepted step is the first stage of the next */
+	bool derivatives_valid;
+	FE_value dxi_dt[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	FE_value dxdxi[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+};
+
+/* Dormand-Prince 5(4) coefficients */
+static const FE_value dormand_prince_a[7][6] =
+{
+	{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+	{ 1.0/5.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+	{ 3.0/40.0, 9.0/40.0, 0.0, 0.0, 0.0, 0.0 },
+	{ 44.0/45.0, -56.0/15.0, 32.0/9.0, 0.0, 0.0, 0.0 },
+	{ 19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0, 0.0, 0.0 },
+	{ 9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0, -5103.0/18656.0, 0.0 },
+	{ 35.0/384.0, 0.0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0 }
+};
+
+/* fraction of step at which each stage is evaluated */
+static const FE_value dormand_prince_c[7] =
+{
+	0.0, 1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0
+};
+
+/* difference between 5th and embedded 4th order weights, giving error estimate */
+static const FE_value dormand_prince_e[7] =
+{
+	71.0/57600.0, 0.0, -71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0, -1.0/40.0
+};
+
+/**
+ * Advances xi along the <stream_vector_field> by one adaptive step of the
+ * Dormand-Prince (RK45) method, integrating in xi space. The step is chosen so
+ * the estimated position error is within <tolerance> times the element size.
+ * If the step reaches a face of the element it ends there and changes to the
+ * adjacent element through the <tracker>'s shared crossings, or stops tracking
+ * if there is none. Adds the time stepped to <total_stepped>.
+ * If <reverse_track> is true, the reverse of the vector field is tracked.
+ * @param maximum_step  Maximum step size in time.
+ * @param time_origin  If not NULL, each stage is evaluated at time
+ * *time_origin + *total_stepped + the stage's fraction of the step, for
+ * following particles forward through a time-varying field. Otherwise the
+ * field cache time is not changed.
+ */
+static int update_adaptive_dormand_prince(cmzn_fieldcache_id field_cache,
+	struct Computed_field *coordinate_field, struct Computed_field *stream_vector_field,
+	int reverse_track, FE_value tolerance, StreamlineTracker *tracker,
+	struct FE_element **element, FE_value *xi, Streamline_step_state *state,
+	FE_value maximum_step, FE_value *total_stepped, int *keep_tracking,
+	const FE_value *time_origin)
 {
-	int element_dimension,face_number,i,initial_face_number,j,
-		number_of_permutations, permutation, return_code,vector_dimension, face_numberB = 0;
-	FE_value coordinate_length, coordinate_point_error, coordinate_point_vector, coordinate_tolerance,
-		deltaxi[MAXIMUM_ELEMENT_XI_DIMENSIONS],deltaxiA[MAXIMUM_ELEMENT_XI_DIMENSIONS],
-		deltaxiC[MAXIMUM_ELEMENT_XI_DIMENSIONS], deltaxiD[MAXIMUM_ELEMENT_XI_DIMENSIONS],
-		deltaxiE[MAXIMUM_ELEMENT_XI_DIMENSIONS], 
-		dxdxi[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS], error, fraction,
-		increment_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], local_step_size,
-		point1[3], point2[3], point3[3], tolerance, 
-		vector[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS], 
-		xiA[MAXIMUM_ELEMENT_XI_DIMENSIONS], xiB[MAXIMUM_ELEMENT_XI_DIMENSIONS], 
-		xiC[MAXIMUM_ELEMENT_XI_DIMENSIONS], xiD[MAXIMUM_ELEMENT_XI_DIMENSIONS],
-		xiE[MAXIMUM_ELEMENT_XI_DIMENSIONS], xiF[MAXIMUM_ELEMENT_XI_DIMENSIONS],
-		xi_face[MAXIMUM_ELEMENT_XI_DIMENSIONS];
-	struct FE_element *initial_element;
-
-	ENTER(update_adaptive_imp_euler);
-	/* clear coordinates in case fewer than 3 components */
 	FE_element_shape *element_shape = get_FE_element_shape(*element);
-	element_dimension = get_FE_element_shape_dimension(element_shape);
+	const int element_dimension = get_FE_element_shape_dimension(element_shape);
 	/* It is expected that the coordinate dimension and vector dimension match as
-		far as tracking is concerned,
-		the vector field may have extra components related to the cross directions
-	   which are used to orient stream ribbons and tubes */
-	vector_dimension = cmzn_field_get_number_of_components(coordinate_field);
-	point1[0]=0.0;
-	point1[1]=0.0;
-	point1[2]=0.0;
-	point2[0]=0.0;
-	point2[1]=0.0;
-	point2[2]=0.0;
-	point3[0]=0.0;
-	point3[1]=0.0;
-	point3[2]=0.0;
-	tolerance=1.0e-4;
-	error=1.0;
-	coordinate_point_error = 1.0;
-	coordinate_tolerance = 1.0e-2;  /* We are tolerating a greater error in the coordinate
-											  positions so long as the tracking is valid */
-	local_step_size = *step_size;
-	return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xi)) &&
-		(CMZN_OK == cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
-			vector_dimension, point1, /*number_of_derivatives*/element_dimension, dxdxi)) &&
-		(CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
-			MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector));
-
-	/* Get a length scale estimate */
-	coordinate_length = 0;
-	for (i = 0 ; i < vector_dimension ; i++)
+		far as tracking is concerned, the vector field may have extra components
+		related to the cross directions which are used to orient stream ribbons
+		and tubes */
+	const int vector_dimension = cmzn_field_get_number_of_components(coordinate_field);
+	if (!state->derivatives_valid)
 	{
-		for (j = 0 ; j < element_dimension ; j++)
+		if (time_origin)
+			cmzn_fieldcache_set_time(field_cache, *time_origin + *total_stepped);
+		if (!evaluate_streamline_dxi_dt(field_cache, coordinate_field, stream_vector_field,
+			reverse_track, *element, element_dimension, vector_dimension, xi,
+			state->dxdxi, state->dxi_dt))
 		{
-			coordinate_length += dxdxi[i + j * vector_dimension] * 
-				dxdxi[i + j * vector_dimension];
+			return 0;
 		}
+		state->derivatives_valid = true;
 	}
+	/* Get a length scale estimate */
+	FE_value coordinate_length = 0.0;
+	for (int i = 0; i < vector_dimension*element_dimension; ++i)
+		coordinate_length += state->dxdxi[i]*state->dxdxi[i];
 	coordinate_length = sqrt(coordinate_length / (FE_value)element_dimension);
-
-	if (reverse_track)
+	FE_value dxi_dt_magnitude = 0.0;
+	for (int j = 0; j < element_dimension; ++j)
+		dxi_dt_magnitude += state->dxi_dt[j]*state->dxi_dt[j];
+	dxi_dt_magnitude = sqrt(dxi_dt_magnitude);
+	if ((dxi_dt_magnitude <= 0.0) || (coordinate_length <= 0.0))
 	{
-		for (i = 0 ; i < vector_dimension ; i++)
+		if (time_origin && (coordinate_length > 0.0))
 		{
-			vector[i] = -vector[i];
+			/* particle is at rest at this time: wait for the field to change */
+			*total_stepped += maximum_step;
+			state->derivatives_valid = false;
+			return 1;
 		}
+		/* streamline is not going anywhere */
+		*keep_tracking = 0;
+		return 1;
 	}
-	if (return_code)
+	FE_value step_size = state->step_size;
+	if (step_size <= 0.0)
 	{
-		return_code=calculate_delta_xi(vector_dimension,vector,element_dimension,
-			dxdxi,deltaxi);
+		/* This is the first step, set the step_size to make the
+			magnitude of delta xi 0.01 */
+		step_size = 1.0e-2 / dxi_dt_magnitude;
 	}
-	if (return_code)
+	if (step_size > maximum_step)
+		step_size = maximum_step;
+	const FE_value error_limit = tolerance*coordinate_length;
+	FE_value k[7][MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	FE_value stage_dxdxi[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	FE_value error_ratio, fraction, increment_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS],
+		stage_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], xi_face[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	int face_number;
+	for (int j = 0; j < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++j)
+		k[0][j] = state->dxi_dt[j];
+	int rejected_steps = 0;
+	while (true)
 	{
-		if (local_step_size == 0.0)
+		for (int s = 1; s < 7; ++s)
 		{
-			/* This is the first step, set the step_size to make the
-			 magnitude of deltaxi 0.01 */
-			local_step_size=1.0e-2/sqrt(deltaxi[0]*deltaxi[0]+deltaxi[1]*deltaxi[1]
-				+deltaxi[2]*deltaxi[2]);
-		}
-		/* whole step */
-		for (i = 0 ; i < element_dimension ; i++)
-		{
-			xiA[i] = xi[i];
-			increment_xi[i] = local_step_size * deltaxi[i];
-		}
-		return_code = FE_element_shape_xi_increment(element_shape, xiA, increment_xi, &fraction,
-		   &face_number, xi_face);
-		/* If an element boundary is reached then xiA will automatically be on this boundary.
-			We want to go to the same location with the more accurate xiB integration so 
-			leave the step size alone and adjust the stepsize after xiB */
-		if (return_code)
-		{
-			return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiA)) &&
-				(CMZN_OK == cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
-					vector_dimension, point3, /*number_of_derivatives*/element_dimension, dxdxi)) &&
-				(CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
-					MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector));
-			if (reverse_track)
-			{
-				for (i = 0 ; i < vector_dimension ; i++)
-				{
-					vector[i] = -vector[i];
-				}
-			}
-		}
-		if (return_code)
-		{
-			return_code=calculate_delta_xi(vector_dimension,vector,element_dimension,
-				dxdxi,deltaxiA);
-		}
-		if (return_code)
-		{
-			for (i = 0 ; i < element_dimension ; i++)
-			{
-				xiB[i] = xi[i];
-				increment_xi[i] = local_step_size*(deltaxi[i]+deltaxiA[i])/2.0;
-			}
-			return_code = FE_element_shape_xi_increment(element_shape, xiB,
-				increment_xi, &fraction, &face_number, xi_face);
-			face_numberB = face_number;
-		}
-		if (face_number != -1)
-		{
-			int onBoundary = 0;
-			for (i = 0 ; i < element_dimension ; i++)
-			{
-				if (xiB[i] == xi[i] && (xiB[i] == 0.0 || xiB[i] == 1.0))
-				{
-					onBoundary = 1;
-					break;
-				}
-			}
-			if (0.0 >= fraction && !onBoundary)
-			{
-				/* Don't go into the loop, so set error, coordinate_error and xiF */
-				error = 0.0;
-				coordinate_point_error = 0.0;
-				local_step_size = 0.0;
-				for (i = 0 ; i < element_dimension ; i++)
-				{
-					xiF[i] = xiB[i];
-				}
-			}
-			else
+			for (int j = 0; j < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++j)
 			{
-				/* Reduce the step to the fraction that was successful plus a bit 
-					to make it likely that the more accurate integration below will
-					still reach the boundary */
-				local_step_size *= (fraction + 0.001);
+				FE_value dxi_dt = 0.0;
+				for (int r = 0; r < s; ++r)
+					dxi_dt += dormand_prince_a[s][r]*k[r][j];
+				stage_xi[j] = xi[j];
+				increment_xi[j] = step_size*dxi_dt;
 			}
-		}
-	}
-	while (((error>tolerance)||(coordinate_point_error>coordinate_tolerance))
-		&&return_code)
-	{
-		for (i = 0 ; i < element_dimension ; i++)
-		{
-			xiC[i] = xi[i];
-			increment_xi[i] = local_step_size*deltaxi[i]/2.0;
-		}
-		return_code = FE_element_shape_xi_increment(element_shape, xiC,
-			increment_xi, &fraction, &face_number, xi_face);
-		if (return_code)
-		{
-			return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiC)) &&
-				(CMZN_OK == cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
-					vector_dimension, point2, /*number_of_derivatives*/element_dimension, dxdxi)) &&
-				(CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
-					MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector));
-			if (reverse_track)
+			if (time_origin)
+				cmzn_fieldcache_set_time(field_cache,
+					*time_origin + *total_stepped + dormand_prince_c[s]*step_size);
+			/* evaluate stages outside the element on its boundary */
+			if (!(FE_element_shape_xi_increment(element_shape, stage_xi, increment_xi,
+				&fraction, &face_number, xi_face) &&
+				evaluate_streamline_dxi_dt(field_cache, coordinate_field, stream_vector_field,
+					reverse_track, *element, element_dimension, vector_dimension, stage_xi,
+					stage_dxdxi, k[s])))
 			{
-				for (i = 0 ; i < vector_dimension ; i++)
-				{
-					vector[i] = -vector[i];
-				}
+				return 0;
 			}
 		}
-		if (return_code)
+		/* estimate error in coordinates from error in xi */
+		FE_value error_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int j = 0; j < element_dimension; ++j)
 		{
-			return_code=calculate_delta_xi(vector_dimension,vector,element_dimension,
-				dxdxi,deltaxiC);
-		}
-		if (return_code)
-		{
-			for (i = 0 ; i < element_dimension ; i++)
-			{
-				xiD[i] = xi[i];
-				increment_xi[i] = local_step_size*(deltaxi[i]+deltaxiC[i])/4.0;
-			}
-			return_code = FE_element_shape_xi_increment(element_shape, xiD,
-				increment_xi, &fraction, &face_number, xi_face);
+			error_xi[j] = 0.0;
+			for (int s = 0; s < 7; ++s)
+				error_xi[j] += dormand_prince_e[s]*k[s][j];
+			error_xi[j] *= step_size;
 		}
-
-		/* On boundary but check either it is already on boundary from the beginning */
-		/* if a larger step has moved it out of the boundary than use it*/
-		if (face_number != -1)
+		FE_value error = 0.0;
+		for (int i = 0; i < vector_dimension; ++i)
 		{
-			for (i = 0 ; i < element_dimension ; i++)
-			{
-				if (xiD[i] == xi[i] && (xiD[i] == 0.0 || xiD[i] == 1.0))
-				{
-					if (face_numberB == -1)
-					{
-						for (i = 0 ; i < element_dimension ; i++)
-						{
-							face_number = -1;
-							xiD[i] = xiB[i];
-						}
-					}
-					break;
-				}
-			}
-		}
-
-		/* If we are really close to the boundary then the extra bit added on
-			above may push us to the boundary in this half step so we should check
-			here.  Steps xi->xiD and xiD->xiF are our final steps so check these */
-		if (face_number == -1)
-		{
-			if (return_code)
-			{
-				return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiD)) &&
-					(CMZN_OK == cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
-						vector_dimension, point2, /*number_of_derivatives*/element_dimension, dxdxi)) &&
-					(CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
-						MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector));
-				if (reverse_track)
-				{
-					for (i = 0 ; i < vector_dimension ; i++)
-					{
-						vector[i] = -vector[i];
-					}
-				}
-			}
-			if (return_code)
-			{
-				return_code=calculate_delta_xi(vector_dimension,vector,element_dimension,
-					dxdxi,deltaxiD);
-			}
-			if (return_code)
-			{
-				for (i = 0 ; i < element_dimension ; i++)
-				{
-					xiE[i] = xiD[i];
-					increment_xi[i] = local_step_size*deltaxiD[i]/2.0;
-				}
-				return_code = FE_element_shape_xi_increment(element_shape, xiE,
-					increment_xi, &fraction, &face_number, xi_face);
-			}
-			if (return_code)
-			{
-				return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiE)) &&
-					(CMZN_OK == cmzn_field_evaluate_real_with_derivatives(coordinate_field, field_cache,
-						vector_dimension, point3, /*number_of_derivatives*/element_dimension, dxdxi)) &&
-					(CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
-						MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector));
-				if (reverse_track)
-				{
-					for (i = 0 ; i < vector_dimension ; i++)
-					{
-						vector[i] = -vector[i];
-					}
-				}
-			}
-			if (return_code)
-			{
-				return_code=calculate_delta_xi(vector_dimension,vector,element_dimension,
-					dxdxi,deltaxiE);
-			}
-			if (return_code)
-			{
-				for (i = 0 ; i < element_dimension ; i++)
-				{
-					xiF[i] = xiD[i];
-					increment_xi[i] = local_step_size*(deltaxiD[i]+deltaxiE[i])/4.0;
-				}
-				return_code = FE_element_shape_xi_increment(element_shape, xiF,
-					increment_xi, &fraction, &face_number, xi_face);
-				if (face_number != -1)
-				{
-					/* Reduce the step size to that which was actually taken */
-					local_step_size *= (0.5 + fraction / 2.0);
-				}
-			}
-		}
-		else
-		{
-			/* Reduce the step size to that which was actually taken */
-			local_step_size *= fraction / 2.0;
-			for (i = 0 ; i < element_dimension ; i++)
-			{
-				/* Copy the values from the half step result */
-				xiF[i] = xiD[i];
-			}			
-		}
-		if (return_code)
-		{
-			/* Calculate halfway coordinate position from start and end, 
-			 error is deviation from halfway point divided by length from
-			start to end to normalise it. */
-			coordinate_point_error = 0.0;
-			for (i = 0 ; i < vector_dimension ; i++)
-			{
-				coordinate_point_vector = point2[i] - 
-					(point1[i] * fraction + point3[i]) / (1.0 + fraction);
-				coordinate_point_error += coordinate_point_vector * 
-					coordinate_point_vector;
-			}
-			coordinate_point_error = sqrt(coordinate_point_error) / 
-				coordinate_length;
-
-			error=sqrt((xiF[0]-xiB[0])*(xiF[0]-xiB[0])+
-				(xiF[1]-xiB[1])*(xiF[1]-xiB[1])+(xiF[2]-xiB[2])*(xiF[2]-xiB[2]));
-			if ((local_step_size*sqrt(deltaxiC[0]*deltaxiC[0]+
-				deltaxiC[1]*deltaxiC[1]+deltaxiC[2]*deltaxiC[2]))<1.0e-3)
-			{
-				error=0.0;
-			}
-		}
-		if (((error>tolerance)||(coordinate_point_error>coordinate_tolerance))&&
-			return_code)
-		{
-			local_step_size /= 2.0;
-			xiB[0]=xiD[0];
-			xiB[1]=xiD[1];
-			xiB[2]=xiD[2];
+			FE_value error_x = 0.0;
+			for (int j = 0; j < element_dimension; ++j)
+				error_x += state->dxdxi[i*element_dimension + j]*error_xi[j];
+			error += error_x*error_x;
 		}
+		error_ratio = sqrt(error) / error_limit;
+		if ((error_ratio <= 1.0) || (rejected_steps >= 20))
+			break;
+		step_size *= (error_ratio < 2.0e+4) ? 0.9*pow(error_ratio, -0.25) : 0.075;
+		++rejected_steps;
 	}
-	if (return_code)
+	/* the 5th order increment uses the weights of the last stage */
+	for (int j = 0; j < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++j)
 	{
-			*total_stepped += local_step_size;
-			if (face_number != -1)
-			{
-				initial_element = *element;
-				initial_face_number = face_number;
-				xiD[0]=xiF[0];
-				xiD[1]=xiF[1];
-				xiD[2]=xiF[2];
-				/* The last increment should have been the most accurate, if
-				it wants to change then change element if we can */
-				return_code = FE_element_change_to_adjacent_element(element,
-					xiF, (FE_value *)NULL, &face_number, xi_face, /*permutation*/0);
-				if (face_number == -1)
-				{
-					/* There is no adjacent element */
-					*keep_tracking = 0;
-				}
-				else
-				{
-					/* Check the new xi coordinates are correct for our
-					coordinate field and if not try rotating them */
-
-					return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiF)) &&
-						(CMZN_OK == cmzn_field_evaluate_real(coordinate_field, field_cache, vector_dimension, point1));
-					coordinate_point_error = 0.0;
-					for (i = 0 ; i < vector_dimension ; i++)
-					{
-						coordinate_point_error += (point1[i] - point3[i]) * 
-							(point1[i] - point3[i]);
-					}
-					coordinate_point_error = sqrt(coordinate_point_error) / coordinate_length;
-					// this permutation loop is inefficient; should extract common adjacent element code
-					number_of_permutations =
-						FE_element_get_number_of_change_to_adjacent_element_permutations(
-							*element, xiF, face_number);
-					/* We have already tried permutation 0 */
-					permutation = 1;
-					while ((permutation < number_of_permutations) &&
-						(coordinate_point_error > coordinate_tolerance))
-					{
-						*element = initial_element;
-						face_number = initial_face_number;
-						xiF[0]=xiD[0];
-						xiF[1]=xiD[1];
-						xiF[2]=xiD[2];
-						return_code = FE_element_change_to_adjacent_element(element,
-							xiF, (FE_value *)NULL, &face_number, xi_face, permutation);
-						return_code = (CMZN_OK == field_cache->setMeshLocation(*element, xiF)) &&
-							(CMZN_OK == cmzn_field_evaluate_real(coordinate_field, field_cache, vector_dimension, point1));
-						coordinate_point_error = 0.0;
-						for (i = 0 ; i < vector_dimension ; i++)
-						{
-							coordinate_point_error += (point1[i] - point3[i]) *
-								(point1[i] - point3[i]);
-						}
-						coordinate_point_error = sqrt(coordinate_point_error) / coordinate_length;
-						permutation++;
-					}
-					element_shape = get_FE_element_shape(*element);
-					if (!element_shape)
-					{
-						display_message(ERROR_MESSAGE, "track_streamline_from_FE_element.  Missing shape.");
-						*keep_tracking = 0;
-					}
-					if (coordinate_point_error > coordinate_tolerance)
-					{
-						display_message(ERROR_MESSAGE,"track_streamline_from_FE_element.  "
-							"Coordinates don't match after changing elements.");
-						*keep_tracking = 0;
-						*element = initial_element;
-						xiF[0]=xiD[0];
-						xiF[1]=xiD[1];
-						xiF[2]=xiD[2];
-					}
-				}
-			}
-			else
-			{
-				/* Update the global step_size */
-				if (error<tolerance/10.0)
-				{
-					local_step_size *= 2.0;
-				}
-				*step_size = local_step_size;
-			}
+		increment_xi[j] = 0.0;
+		for (int s = 0; s < 6; ++s)
+			increment_xi[j] += dormand_prince_a[6][s]*k[s][j];
+		increment_xi[j] *= step_size;
 	}
-	if (return_code)
+	if (!FE_element_shape_xi_increment(element_shape, xi, increment_xi,
+		&fraction, &face_number, xi_face))
 	{
-		xi[0]=xiF[0];
-		xi[1]=xiF[1];
-		xi[2]=xiF[2];
-		point[0] = point3[0];
-		point[1] = point3[1];
-		point[2] = point3[2];
+		return 0;
 	}
-	LEAVE;
-
-	return (return_code);
-} /* update_adaptive_imp_euler */
+	if (face_number == -1)
+	{
+		*total_stepped += step_size;
+		/* last stage was evaluated at the new xi */
+		for (int j = 0; j < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++j)
+			state->dxi_dt[j] = k[6][j];
+		for (int i = 0; i < vector_dimension*element_dimension; ++i)
+			state->dxdxi[i] = stage_dxdxi[i];
+		/* grow step by up to 5 times for next step */
+		FE_value growth = (error_ratio > 1.0e-4) ? 0.9*pow(error_ratio, -0.2) : 5.0;
+		if (growth > 5.0)
+			growth = 5.0;
+		state->step_size = growth*step_size;
+	}
+	else
+	{
+		/* xi has stopped on the face at fraction of the step */
+		*total_stepped += fraction*step_size;
+		state->derivatives_valid = false;
+		if (!tracker->changeToAdjacentElement(field_cache, element, xi, &face_number, xi_face))
+			return 0;
+		if (face_number == -1)
+		{
+			/* There is no adjacent element */
+			*keep_tracking = 0;
+		}
+		if (state->step_size <= 0.0)
+			state->step_size = step_size;
+	}
+	return 1;
+}
 
 static int update_interactive_streampoint(FE_value *point_coordinates,
 	struct FE_element **element, cmzn_fieldcache_id field_cache,
@@ -693,7 +492,9 @@ accurate if small), also ensuring that the element is updated.
 static int track_streamline_from_FE_element(struct FE_element **element,
 	FE_value *xi, cmzn_fieldcache_id field_cache, struct Computed_field *coordinate_field,
 	struct Computed_field *stream_vector_field,int reverse_track,
-	FE_value length, enum cmzn_graphics_streamlines_colour_data_type colour_data_type,
+	FE_value length, FE_value tolerance, int maximum_number_of_steps,
+	StreamlineTracker *tracker,
+	enum cmzn_graphics_streamlines_colour_data_type colour_data_type,
 	struct Computed_field *data_field,int *number_of_points,
 	Triple **stream_points,Triple **stream_vectors,Triple **stream_normals,
 	GLfloat **stream_data)
@@ -712,6 +513,9 @@ and data_field.
 The <*element> and <xi> values are updated to where the stream is tracked to, so
 that tracking can be continued.
 On unsuccessful return the above arrays are deallocated.
+Tracking stops after <length> time or <maximum_number_of_steps> steps, each
+integrated to <tolerance> relative to the element size. Element crossings are
+made through the <tracker>, which also collects messages to display.
 
 If <reverse_track> is true, the reverse of <stream_vector_field> is tracked, and
 the negative travel_scalar is recorded, if requested.
@@ -732,11 +536,11 @@ following way:
 		displacement[3] = {0.0, 0.0, 0.0},dv_dxi[9],dv_dx[9],dx_dxi[9],dxi_dx[9],
 		magnitude,normal[3],normal2[3] = {0.0, 0.0, 0.0},old_normal[3] = {0.0, 0.0, 0.0},
 		previous_curl_component = 0.0,previous_total_stepped_A,
-		previous_total_stepped_B,sin_angle,step_size,stream_vector_values[9],
+		previous_total_stepped_B,sin_angle,stream_vector_values[9],
 		temp,total_stepped,vector[3],vector_magnitude;
 	GLfloat *stream_datum,*tmp_stream_data;
 	int add_point,allocated_number_of_points,calculate_curl,element_dimension,
-		i,keep_tracking,number_of_coordinate_components,
+		i,keep_tracking,number_of_coordinate_components,number_of_steps,
 		number_of_stream_vector_components,return_code;
 	struct FE_element *previous_element_A = NULL, *previous_element_B = NULL;
 	Triple *stream_point,*stream_vector,*stream_normal,*tmp_triples = NULL;
@@ -760,11 +564,15 @@ following way:
 		(2==number_of_stream_vector_components)))&&
 		(0.0<length) && ((colour_data_type != CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_FIELD) ||
 		(0 == data_field) || (1 == cmzn_field_get_number_of_components(data_field))) &&
+		(0.0 < tolerance) && (0 < maximum_number_of_steps) && tracker &&
 		number_of_points&&stream_points&&stream_vectors&&stream_normals&&
 		((!hasData) || stream_data))
 	{
+		Streamline_step_state step_state;
 		/*	step_size of zero indicates first step */
-		step_size = 0;
+		step_state.step_size = 0.0;
+		step_state.derivatives_valid = false;
+		number_of_steps = 0;
 		total_stepped = 0.0;
 		previous_total_stepped_A = 0.0;
 
@@ -822,7 +630,7 @@ following way:
 										return_code = (CMZN_OK == cmzn_field_evaluate_real(stream_vector_field, field_cache,
 											number_of_stream_vector_components, stream_vector_values));
 										calculate_curl = 0;
-										display_message(WARNING_MESSAGE,
+										tracker->addMessage(WARNING_MESSAGE,
 											"Stream vector field derivatives are unavailable, "
 											"continuing but not integrating the curl.");
 									}
@@ -931,7 +739,7 @@ following way:
 									} break;
 									default:
 									{
-										display_message(ERROR_MESSAGE,
+										tracker->addMessage(ERROR_MESSAGE,
 											"track_streamline_from_FE_element.  "
 											"Incompatible element dimension and vector components.");
 										return_code = 0;
@@ -1131,7 +939,7 @@ following way:
 									} break;
 									default:
 									{
-										display_message(ERROR_MESSAGE,
+										tracker->addMessage(ERROR_MESSAGE,
 											"track_streamline_from_FE_element.  "
 											"Incompatible element dimension and vector components.");
 										return_code = 0;
@@ -1140,7 +948,7 @@ following way:
 							} break;
 							default:
 							{
-								display_message(ERROR_MESSAGE,
+								tracker->addMessage(ERROR_MESSAGE,
 									"track_streamline_from_FE_element.  "
 									"Unsupported number of element dimension.");
 								return_code = 0;
@@ -1156,7 +964,7 @@ following way:
 									// cache location should be unchanged from earlier
 									if (CMZN_OK != cmzn_field_evaluate_real(data_field, field_cache, /*number_of_values*/1, &data_value))
 									{
-										display_message(ERROR_MESSAGE,
+										tracker->addMessage(ERROR_MESSAGE,
 											"track_streamline_from_FE_element.   Error calculating data field");
 										return_code = 0;
 									}
@@ -1172,7 +980,7 @@ following way:
 							} break;
 							default:
 							{
-								display_message(ERROR_MESSAGE,
+								tracker->addMessage(ERROR_MESSAGE,
 									"track_streamline_from_FE_element.  Unknown streamlines data type");
 								return_code = 0;
 							} break;
@@ -1196,20 +1004,19 @@ following way:
 							stream_datum++;
 						}
 						i++;
-						if (keep_tracking && (total_stepped<length))
+						if (keep_tracking && (total_stepped<length) &&
+							(number_of_steps < maximum_number_of_steps))
 						{
 							/* perform the tracking, changing elements as necessary */
-							if (total_stepped + step_size > length)
-							{
-								step_size = length - total_stepped;
-							}
 							previous_total_stepped_B = previous_total_stepped_A;
 							previous_total_stepped_A = total_stepped;
 							previous_element_B = previous_element_A;
 							previous_element_A = *element;
-							return_code=update_adaptive_imp_euler(field_cache,coordinate_field,
-								stream_vector_field,reverse_track,element,xi,
-								coordinates,&step_size,&total_stepped,&keep_tracking);
+							return_code = update_adaptive_dormand_prince(field_cache, coordinate_field,
+								stream_vector_field, reverse_track, tolerance, tracker, element, xi,
+								&step_state, /*maximum_step*/length - total_stepped, &total_stepped,
+								&keep_tracking, /*time_origin*/0);
+							++number_of_steps;
 							/* If we haven't gone anywhere and are changing back to the previous
 								element then we are stuck */
 							if (total_stepped == previous_total_stepped_B)
@@ -1296,7 +1103,7 @@ following way:
 						}
 						if (!return_code)
 						{
-							display_message(ERROR_MESSAGE,
+							tracker->addMessage(ERROR_MESSAGE,
 								"track_streamline_from_FE_element.  Could not reallocate");
 							return_code=0;
 						}
@@ -1311,7 +1118,7 @@ following way:
 		}
 		else
 		{
-			display_message(ERROR_MESSAGE,"track_streamline_from_FE_element.  "
+			tracker->addMessage(ERROR_MESSAGE, "track_streamline_from_FE_element.  "
 				"Not enough memory for streamline");
 			return_code=0;
 		}
@@ -1348,471 +1155,966 @@ following way:
 	return (return_code);
 } /* track_streamline_from_FE_element */
 
-/*
-Global functions
-----------------
-*/
+/**
+ * Adds streamline points and data as a polyline to the vertex array.
+ */
+static int add_polyline_streamline_to_vertex_array(int number_of_stream_points,
+	Triple *stream_points, GLfloat *stream_data, struct Graphics_vertex_array *array)
+{
+	unsigned int total_number_of_vertices = number_of_stream_points;
+	unsigned int vertex_start = array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
 
-int create_polyline_streamline_FE_element_vertex_array(
-	struct FE_element *element,FE_value *start_xi,
-	cmzn_fieldcache_id field_cache, struct Computed_field *coordinate_field,
-	struct Computed_field *stream_vector_field,int reverse_track,
-	FE_value length, enum cmzn_graphics_streamlines_colour_data_type colour_data_type,
-	struct Computed_field *data_field,
-	struct Graphics_vertex_array *array)
+	array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+		3, number_of_stream_points, &(stream_points[0][0]));
+	if (stream_data)
+		array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+			1, number_of_stream_points, stream_data);
+	array->add_unsigned_integer_attribute(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+		1, 1, &total_number_of_vertices);
+	array->add_unsigned_integer_attribute(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+		1, 1, &vertex_start);
+	return 1;
+}
+
+/**
+ * Adds a ribbon or extrusion surface around the streamline points to the
+ * vertex array, oriented by the stream vectors and normals.
+ * @param line_shape  RIBBON, CIRCLE_EXTRUSION or SQUARE_EXTRUSION.
+ * @param line_base_size  width and thickness of line, use depends on shape.
+ */
+static int add_surface_streamribbon_to_vertex_array(int number_of_stream_points,
+	Triple *stream_points, Triple *stream_vectors, Triple *stream_normals,
+	GLfloat *stream_data, enum cmzn_graphicslineattributes_shape_type line_shape,
+	int circleDivisions, FE_value *line_base_size, struct Graphics_vertex_array *array)
 {
-	GLfloat *stream_data;
-	int element_dimension,number_of_stream_points,number_of_coordinate_components,
-		number_of_stream_vector_components, return_code = 1;
-	Triple *stream_points,*stream_normals,*stream_vectors;
+	double cosw,magnitude,sinw;
+	GLfloat stream_datum= 0.0;
+	int d,i,surface_points_per_step;
+	Triple cross_thickness,cross_width,normal,point,stream_cross,
+		stream_normal,stream_point,
+		stream_unit_vector = {1.0, 0.0, 0.0},stream_vector;
 
-	if (stream_vector_field)
+	const FE_value width = line_base_size[0];
+	const FE_value thickness = line_base_size[1];
+	switch (line_shape)
 	{
-		if (element&&FE_element_is_top_level(element, NULL)&&
-			(element_dimension = get_FE_element_dimension(element))&&
-			((3 == element_dimension) || (2 == element_dimension))
-			&&start_xi&&coordinate_field&&
-			(number_of_coordinate_components=cmzn_field_get_number_of_components(coordinate_field))&&
-			(number_of_stream_vector_components=cmzn_field_get_number_of_components(stream_vector_field))
-			&& (((3 == number_of_coordinate_components) &&
-			((3==number_of_stream_vector_components)||
-			(6==number_of_stream_vector_components)||
-			(9==number_of_stream_vector_components)))
-			|| ((2 == number_of_coordinate_components) &&
-			(2==number_of_stream_vector_components)))&&
-			(0.0<length) && array)
+		case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
+		{
+			surface_points_per_step = 8;
+		} break;
+		case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
+		{
+			surface_points_per_step = circleDivisions + 1;
+		} break;
+		case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
+		default:
 		{
-			/* track points and normals on streamline, and data if requested */
-			if (track_streamline_from_FE_element(&element,start_xi,
-				field_cache, coordinate_field,stream_vector_field,reverse_track,length,
-				colour_data_type,data_field,&number_of_stream_points,&stream_points,
-					&stream_vectors,&stream_normals,&stream_data))
+			surface_points_per_step = 2;
+		} break;
+	}
+
+	unsigned int vertex_start = array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+	unsigned int number_of_vertices = surface_points_per_step * number_of_stream_points;
+	/* now fill in the points and data from the streamline */
+	GLfloat floatField[3];
+	for (i=0;i<number_of_stream_points;i++)
+	{
+		stream_point[0]=stream_points[i][0];
+		stream_point[1]=stream_points[i][1];
+		stream_point[2]=stream_points[i][2];
+		stream_vector[0]=stream_vectors[i][0];
+		stream_vector[1]=stream_vectors[i][1];
+		stream_vector[2]=stream_vectors[i][2];
+		stream_normal[0]=stream_normals[i][0];
+		stream_normal[1]=stream_normals[i][1];
+		stream_normal[2]=stream_normals[i][2];
+		if (stream_data)
+		{
+			stream_datum=stream_data[i];
+		}
+		if (0.0 < (magnitude = sqrt(stream_vector[0]*stream_vector[0]+
+			stream_vector[1]*stream_vector[1]+
+			stream_vector[2]*stream_vector[2])))
+		{
+			stream_unit_vector[0] = stream_vector[0] / GLfloat(magnitude);
+			stream_unit_vector[1] = stream_vector[1] / GLfloat(magnitude);
+			stream_unit_vector[2] = stream_vector[2] / GLfloat(magnitude);
+		}
+		/* get stream_cross = stream_normal (x) stream_unit_vector */
+		stream_cross[0]=stream_normal[1]*stream_unit_vector[2]-
+			stream_normal[2]*stream_unit_vector[1];
+		stream_cross[1]=stream_normal[2]*stream_unit_vector[0]-
+			stream_normal[0]*stream_unit_vector[2];
+		stream_cross[2]=stream_normal[0]*stream_unit_vector[1]-
+			stream_normal[1]*stream_unit_vector[0];
+		cross_width[0] = stream_cross[0] * 0.5f * width;
+		cross_width[1] = stream_cross[1] * 0.5f * width;
+		cross_width[2] = stream_cross[2] * 0.5f * width;
+		cross_thickness[0] = stream_normal[0] * 0.5f * GLfloat(thickness);
+		cross_thickness[1] = stream_normal[1] * 0.5f * GLfloat(thickness);
+		cross_thickness[2] = stream_normal[2] * 0.5f * GLfloat(thickness);
+		switch (line_shape)
+		{
+			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
+			default:
 			{
-				if (0<number_of_stream_points)
+				point[0] = stream_point[0] + cross_width[0];
+				point[1] = stream_point[1] + cross_width[1];
+				point[2] = stream_point[2] + cross_width[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_normal[0];
+				normal[1] = stream_normal[1];
+				normal[2] = stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
 				{
-					unsigned int total_number_of_vertices = number_of_stream_points;
-					unsigned int vertex_start = array->get_number_of_vertices(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
-
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+				point[0] = stream_point[0] - cross_width[0];
+				point[1] = stream_point[1] - cross_width[1];
+				point[2] = stream_point[2] - cross_width[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_normal[0];
+				normal[1] = stream_normal[1];
+				normal[2] = stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+			} break;
+			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
+			{
+				for (d = 0 ; d < surface_points_per_step ; d++)
+				{
+					sinw = sin( 2 * PI * (double)d /
+						(double)(surface_points_per_step - 1));
+					cosw = cos( 2 * PI * (double)d /
+						(double)(surface_points_per_step - 1));
+					point[0] = stream_point[0] + GLfloat(sinw) * cross_width[0] + GLfloat(cosw) * cross_thickness[0];
+					point[1] = stream_point[1] + GLfloat(sinw) * cross_width[1] + GLfloat(cosw) * cross_thickness[1];
+					point[2] = stream_point[2] + GLfloat(sinw) * cross_width[2] + GLfloat(cosw) * cross_thickness[2];
+					CAST_TO_OTHER(floatField,point,GLfloat,3);
 					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-						3, number_of_stream_points, &(stream_points[0][0]));
+						3, 1, floatField);
+					normal[0] = -GLfloat(sinw) * stream_cross[0] * 0.5f * GLfloat(thickness) -
+						GLfloat(cosw) * stream_normal[0] * 0.5f * width;
+					normal[1] = -GLfloat(sinw) * stream_cross[1] * 0.5f * GLfloat(thickness) -
+						GLfloat(cosw) * stream_normal[1] * 0.5f * GLfloat(thickness);
+					normal[2] = -GLfloat(sinw) * stream_cross[2] * 0.5f * GLfloat(thickness) -
+						GLfloat(cosw) * stream_normal[2] * 0.5f * GLfloat(thickness);
+					magnitude = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+					if (0.0<magnitude)
+					{
+						normal[0] /= GLfloat(magnitude);
+						normal[1] /= GLfloat(magnitude);
+						normal[2] /= GLfloat(magnitude);
+					}
+					CAST_TO_OTHER(floatField,normal,GLfloat,3);
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+						3, 1, floatField);
 					if (stream_data)
+					{
 						array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-							1, number_of_stream_points, stream_data);
-					array->add_unsigned_integer_attribute(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
-						1, 1, &total_number_of_vertices);
-					array->add_unsigned_integer_attribute(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
-						1, 1, &vertex_start);
-					DEALLOCATE(stream_points);
-					DEALLOCATE(stream_data);
-					DEALLOCATE(stream_vectors);
-					DEALLOCATE(stream_normals);
+							1, 1, &stream_datum);
+					}
 				}
-				else
+			} break;
+			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
+			{
+				point[0] = stream_point[0] + cross_width[0] + cross_thickness[0];
+				point[1] = stream_point[1] + cross_width[1] + cross_thickness[1];
+				point[2] = stream_point[2] + cross_width[2] + cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_normal[0];
+				normal[1] = stream_normal[1];
+				normal[2] = stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+				point[0] = stream_point[0] - cross_width[0] + cross_thickness[0];
+				point[1] = stream_point[1] - cross_width[1] + cross_thickness[1];
+				point[2] = stream_point[2] - cross_width[2] + cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_normal[0];
+				normal[1] = stream_normal[1];
+				normal[2] = stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+
+				point[0] = stream_point[0] - cross_width[0] + cross_thickness[0];
+				point[1] = stream_point[1] - cross_width[1] + cross_thickness[1];
+				point[2] = stream_point[2] - cross_width[2] + cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = -stream_cross[0];
+				normal[1] = -stream_cross[1];
+				normal[2] = -stream_cross[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+				point[0] = stream_point[0] - cross_width[0] - cross_thickness[0];
+				point[1] = stream_point[1] - cross_width[1] - cross_thickness[1];
+				point[2] = stream_point[2] - cross_width[2] - cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = -stream_cross[0];
+				normal[1] = -stream_cross[1];
+				normal[2] = -stream_cross[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+
+				point[0] = stream_point[0] - cross_width[0] - cross_thickness[0];
+				point[1] = stream_point[1] - cross_width[1] - cross_thickness[1];
+				point[2] = stream_point[2] - cross_width[2] - cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = -stream_normal[0];
+				normal[1] = -stream_normal[1];
+				normal[2] = -stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
 				{
-					return_code = 0;
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
 				}
+				point[0] = stream_point[0] + cross_width[0] - cross_thickness[0];
+				point[1] = stream_point[1] + cross_width[1] - cross_thickness[1];
+				point[2] = stream_point[2] + cross_width[2] - cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = -stream_normal[0];
+				normal[1] = -stream_normal[1];
+				normal[2] = -stream_normal[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+
+				point[0] = stream_point[0] + cross_width[0] - cross_thickness[0];
+				point[1] = stream_point[1] + cross_width[1] - cross_thickness[1];
+				point[2] = stream_point[2] + cross_width[2] - cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_cross[0];
+				normal[1] = stream_cross[1];
+				normal[2] = stream_cross[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+				point[0] = stream_point[0] + cross_width[0] + cross_thickness[0];
+				point[1] = stream_point[1] + cross_width[1] + cross_thickness[1];
+				point[2] = stream_point[2] + cross_width[2] + cross_thickness[2];
+				CAST_TO_OTHER(floatField,point,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+					3, 1, floatField);
+				normal[0] = stream_cross[0];
+				normal[1] = stream_cross[1];
+				normal[2] = stream_cross[2];
+				CAST_TO_OTHER(floatField,normal,GLfloat,3);
+				array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+					3, 1, floatField);
+				if (stream_data)
+				{
+					array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+						1, 1, &stream_datum);
+				}
+			} break;
+		}
+	}
+	int polygonType = (int)g_TRIANGLE;
+
+	unsigned int number_of_xi1 = surface_points_per_step,
+		number_of_xi2 = number_of_stream_points;
+	array->add_unsigned_integer_attribute(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+		1, 1, &number_of_vertices);
+	array->add_unsigned_integer_attribute(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+		1, 1, &vertex_start);
+	array->add_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POLYGON,
+		1, 1, &polygonType);
+	array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_XI1,
+		1, 1, &number_of_xi1);
+	array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_XI2,
+		1, 1, &number_of_xi2);
+	array->fill_element_index(vertex_start, number_of_xi1, number_of_xi2,
+		ARRAY_SHAPE_TYPE_UNSPECIFIED);
+	return 1;
+}
+
+/*
+Global functions
+----------------
+*/
+
+StreamlineTracker::StreamlineTracker(cmzn_fieldmodule_id fieldmoduleIn, FE_value timeIn,
+	Computed_field *coordinateFieldIn, Computed_field *streamVectorFieldIn,
+	int reverseTrackIn, FE_value lengthIn, FE_value toleranceIn, int maximumNumberOfStepsIn,
+	enum cmzn_graphics_streamlines_colour_data_type colourDataTypeIn,
+	Computed_field *dataFieldIn) :
+	fieldmodule(cmzn_fieldmodule_access(fieldmoduleIn)),
+	time(timeIn),
+	coordinateField(cmzn_field_access(coordinateFieldIn)),
+	streamVectorField(cmzn_field_access(streamVectorFieldIn)),
+	dataField(cmzn_field_access(dataFieldIn)),
+	reverseTrack(reverseTrackIn),
+	length(lengthIn),
+	tolerance(toleranceIn),
+	maximumNumberOfSteps(maximumNumberOfStepsIn),
+	colourDataType(colourDataTypeIn)
+{
+}
+
+StreamlineTracker::~StreamlineTracker()
+{
+	for (std::vector<Streamline>::iterator iter = this->streamlines.begin();
+		iter != this->streamlines.end(); ++iter)
+	{
+		cmzn_element::deaccess(iter->element);
+		DEALLOCATE(iter->points);
+		DEALLOCATE(iter->vectors);
+		DEALLOCATE(iter->normals);
+		DEALLOCATE(iter->data);
+	}
+	cmzn_field_destroy(&this->dataField);
+	cmzn_field_destroy(&this->streamVectorField);
+	cmzn_field_destroy(&this->coordinateField);
+	cmzn_fieldmodule_destroy(&this->fieldmodule);
+}
+
+int StreamlineTracker::addSeed(FE_element *element, const FE_value *xi)
+{
+	if (!((element) && (xi)))
+	{
+		display_message(ERROR_MESSAGE, "StreamlineTracker::addSeed.  Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	Streamline streamline;
+	streamline.element = element->access();
+	const int dimension = element->getDimension();
+	for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+		streamline.xi[i] = (i < dimension) ? xi[i] : 0.0;
+	streamline.numberOfPoints = 0;
+	streamline.points = 0;
+	streamline.vectors = 0;
+	streamline.normals = 0;
+	streamline.data = 0;
+	this->streamlines.push_back(streamline);
+	return CMZN_OK;
+}
+
+bool StreamlineTracker::runInParallel(int count,
+	const std::function<bool(cmzn_fieldcache_id, int)>& function)
+{
+	if (count <= 0)
+		return true;
+	const int threadCount = CMZN::parallel_get_thread_count(static_cast<size_t>(count));
+	// field caches are created and destroyed on this thread; each tracking
+	// thread evaluates fields only in its own cache
+	std::vector<cmzn_fieldcache_id> fieldcaches(threadCount);
+	for (int t = 0; t < threadCount; ++t)
+	{
+		fieldcaches[t] = cmzn_fieldmodule_create_fieldcache(this->fieldmodule);
+		cmzn_fieldcache_set_time(fieldcaches[t], this->time);
+	}
+	// run the first index alone so anything fields build on first evaluation
+	// exists before other threads start
+	std::atomic<bool> success(function(fieldcaches[0], 0));
+	CMZN::parallel_for(1, static_cast<size_t>(count), threadCount,
+		[&](int threadIndex, size_t index)
+		{
+			if (!function(fieldcaches[threadIndex], static_cast<int>(index)))
+				success = false;
+		});
+	for (int t = 0; t < threadCount; ++t)
+		cmzn_fieldcache_destroy(&fieldcaches[t]);
+	this->reportMessages();
+	return success;
+}
+
+void StreamlineTracker::reportMessages()
+{
+	for (size_t i = 0; i < this->messages.size(); ++i)
+		display_message_string(this->messages[i].first, this->messages[i].second.c_str());
+	this->messages.clear();
+}
+
+void StreamlineTracker::addMessage(enum Message_type messageType, const char *message)
+{
+	std::lock_guard<std::mutex> lock(this->messagesMutex);
+	for (size_t i = 0; i < this->messages.size(); ++i)
+		if ((this->messages[i].first == messageType) && (this->messages[i].second == message))
+			return;
+	this->messages.push_back(std::make_pair(messageType, std::string(message)));
+}
+
+int StreamlineTracker::track()
+{
+	auto trackSeed = [this](cmzn_fieldcache_id fieldcache, int seed)
+	{
+		Streamline& streamline = this->streamlines[seed];
+		DEALLOCATE(streamline.points);
+		DEALLOCATE(streamline.vectors);
+		DEALLOCATE(streamline.normals);
+		DEALLOCATE(streamline.data);
+		streamline.numberOfPoints = 0;
+		// tracking updates element and xi
+		FE_element *element = streamline.element;
+		FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+			xi[i] = streamline.xi[i];
+		return (0 != track_streamline_from_FE_element(&element, xi, fieldcache,
+			this->coordinateField, this->streamVectorField, this->reverseTrack,
+			this->length, this->tolerance, this->maximumNumberOfSteps, this,
+			this->colourDataType, this->dataField, &streamline.numberOfPoints,
+			&streamline.points, &streamline.vectors, &streamline.normals, &streamline.data));
+	};
+	return (this->runInParallel(this->getNumberOfSeeds(), trackSeed)) ? 1 : 0;
+}
+
+bool StreamlineTracker::evaluatePathSample(cmzn_fieldcache_id fieldcache,
+	StreamlinePathCache& pathCache, int particle, int sample,
+	FE_element *element, const FE_value *xi)
+{
+	const int coordinatesCount = cmzn_field_get_number_of_components(this->coordinateField);
+	FE_value coordinates[MAXIMUM_ELEMENT_XI_DIMENSIONS] = { 0.0, 0.0, 0.0 };
+	cmzn_fieldcache_set_time(fieldcache, pathCache.getSampleTime(sample));
+	if ((CMZN_OK != fieldcache->setMeshLocation(element, xi)) ||
+		(CMZN_OK != cmzn_field_evaluate_real(this->coordinateField, fieldcache,
+			coordinatesCount, coordinates)))
+	{
+		return false;
+	}
+	GLfloat *values = &(pathCache.samples[sample][particle*pathCache.getValuesPerParticle()]);
+	for (int i = 0; i < 3; ++i)
+		values[i] = static_cast<GLfloat>(coordinates[i]);
+	if (pathCache.hasData)
+	{
+		FE_value data_value = 0.0;
+		switch (this->colourDataType)
+		{
+		case CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_FIELD:
+			if (CMZN_OK != cmzn_field_evaluate_real(this->dataField, fieldcache, 1, &data_value))
+				return false;
+			break;
+		case CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_MAGNITUDE:
+		{
+			FE_value vector[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+			if (CMZN_OK != cmzn_field_evaluate_real(this->streamVectorField, fieldcache,
+				MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS, vector))
+			{
+				return false;
 			}
-			else
+			for (int i = 0; i < coordinatesCount; ++i)
+				data_value += vector[i]*vector[i];
+			data_value = sqrt(data_value);
+		} break;
+		case CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_TRAVEL_TIME:
+			data_value = (sample - pathCache.getReleaseSample(particle))*pathCache.timeStep;
+			break;
+		default:
+			return false;
+		}
+		values[3] = static_cast<GLfloat>(data_value);
+	}
+	return true;
+}
+
+bool StreamlineTracker::advanceParticle(cmzn_fieldcache_id fieldcache,
+	StreamlinePathCache& pathCache, int particle, int endSample)
+{
+	FE_element *element = pathCache.elements[particle];
+	FE_value *xi = &(pathCache.xi[particle*MAXIMUM_ELEMENT_XI_DIMENSIONS]);
+	int sample = pathCache.lastSamples[particle];
+	if (sample < 0)
+	{
+		// record position where released
+		sample = pathCache.getReleaseSample(particle);
+		if (!this->evaluatePathSample(fieldcache, pathCache, particle, sample, element, xi))
+		{
+			pathCache.activeFlags[particle] = 0;
+			return false;
+		}
+		pathCache.lastSamples[particle] = sample;
+	}
+	if (!pathCache.activeFlags[particle])
+		return true;
+	Streamline_step_state step_state;
+	step_state.step_size = pathCache.stepSizes[particle];
+	step_state.derivatives_valid = false;
+	// integrate time from start time so stages are evaluated at the right time
+	FE_value total_stepped = sample*pathCache.timeStep;
+	int keep_tracking = 1;
+	bool result = true;
+	while (result && keep_tracking && (sample < endSample))
+	{
+		const FE_value sample_stepped = (sample + 1)*pathCache.timeStep;
+		while (keep_tracking && (sample_stepped - total_stepped > 1.0E-6*pathCache.timeStep))
+		{
+			if (pathCache.stepCounts[particle] >= this->maximumNumberOfSteps)
 			{
-				return_code = 0;
+				keep_tracking = 0;
+				break;
+			}
+			if (!update_adaptive_dormand_prince(fieldcache, this->coordinateField,
+				this->streamVectorField, /*reverse_track*/0, this->tolerance, this, &element, xi,
+				&step_state, /*maximum_step*/sample_stepped - total_stepped, &total_stepped,
+				&keep_tracking, &pathCache.startTime))
+			{
+				result = false;
+				break;
 			}
+			++(pathCache.stepCounts[particle]);
 		}
-		else
+		if (!(result && keep_tracking))
+			break;
+		total_stepped = sample_stepped;
+		++sample;
+		if (!this->evaluatePathSample(fieldcache, pathCache, particle, sample, element, xi))
 		{
-			return_code = 0;
+			result = false;
+			break;
 		}
+		pathCache.lastSamples[particle] = sample;
 	}
-	else
+	if (!(result && keep_tracking))
+		pathCache.activeFlags[particle] = 0;
+	if (element != pathCache.elements[particle])
+		cmzn_element::reaccess(pathCache.elements[particle], element);
+	pathCache.stepSizes[particle] = step_state.step_size;
+	return result;
+}
+
+int StreamlineTracker::trackPaths(StreamlinePathCache& pathCache,
+	StreamlinePathCache::Mode mode, FE_value startTime, FE_value timeStep, FE_value endTime)
+{
+	if (!(0.0 < timeStep))
 	{
-		return_code = 0;
+		display_message(ERROR_MESSAGE, "StreamlineTracker::trackPaths.  Invalid argument(s)");
+		return 0;
 	}
+	const int seedCount = this->getNumberOfSeeds();
+	std::vector<FE_element *> seedElements(seedCount);
+	std::vector<FE_value> seedXi(seedCount*MAXIMUM_ELEMENT_XI_DIMENSIONS);
+	for (int seed = 0; seed < seedCount; ++seed)
+	{
+		seedElements[seed] = this->streamlines[seed].element;
+		for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+			seedXi[seed*MAXIMUM_ELEMENT_XI_DIMENSIONS + i] = this->streamlines[seed].xi[i];
+	}
+	const bool hasData = (this->colourDataType != CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_FIELD) ||
+		(0 != this->dataField);
+	pathCache.setSeeds(mode, startTime, timeStep, hasData, seedElements, seedXi);
+	if ((0 == seedCount) || (endTime < startTime))
+		return 1;
+	// advance to first sample at or after end time
+	const int sampleCount = static_cast<int>(ceil((endTime - startTime)/timeStep - 1.0E-6)) + 1;
+	if (sampleCount <= pathCache.getNumberOfSamples())
+		return 1;
+	pathCache.addSamples(sampleCount);
+	const int endSample = sampleCount - 1;
+	auto advanceParticle = [this, &pathCache, endSample](cmzn_fieldcache_id fieldcache, int particle)
+	{
+		return this->advanceParticle(fieldcache, pathCache, particle, endSample);
+	};
+	if (!this->runInParallel(pathCache.getParticleCount(endSample), advanceParticle))
+	{
+		display_message(ERROR_MESSAGE, "StreamlineTracker::trackPaths.  Failed to advance particles");
+		return 0;
+	}
+	return 1;
+}
 
-	return (return_code);
+bool StreamlineTracker::resolveCrossing(cmzn_fieldcache_id field_cache,
+	FE_element *element, int faceNumber, Crossing& crossing)
+{
+	crossing.element = 0;
+	crossing.faceNumber = -1;
+	crossing.permutation = 0;
+	FE_element_shape *element_shape = get_FE_element_shape(element);
+	const int dimension = get_FE_element_shape_dimension(element_shape);
+	const FE_value *face_to_element = get_FE_element_shape_face_to_element(element_shape, faceNumber);
+	if (!face_to_element)
+		return false;
+	/* compare coordinates at a point on the face away from its symmetry axes
+		so only the correct permutation of face xi matches */
+	FE_value probe_xi_face[MAXIMUM_ELEMENT_XI_DIMENSIONS] = { 0.2, 0.3, 0.0 };
+	FE_value probe_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS] = { 0.0, 0.0, 0.0 };
+	for (int i = 0; i < dimension; ++i)
+	{
+		probe_xi[i] = *face_to_element;
+		++face_to_element;
+		for (int j = 0; j < dimension - 1; ++j)
+		{
+			probe_xi[i] += (*face_to_element)*probe_xi_face[j];
+			++face_to_element;
+		}
+	}
+	FE_element *adjacent_element = element;
+	int adjacent_face_number = faceNumber;
+	FE_value adjacent_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	if (!FE_element_change_to_adjacent_element(&adjacent_element, adjacent_xi,
+		(FE_value *)NULL, &adjacent_face_number, probe_xi_face, /*permutation*/0))
+	{
+		return false;
+	}
+	if (adjacent_face_number == -1)
+		return true;  // no adjacent element
+	const int vector_dimension = cmzn_field_get_number_of_components(this->coordinateField);
+	FE_value adjacent_coordinates[MAXIMUM_ELEMENT_XI_DIMENSIONS], coordinates[MAXIMUM_ELEMENT_XI_DIMENSIONS],
+		dxdxi[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	if ((CMZN_OK != field_cache->setMeshLocation(element, probe_xi)) ||
+		(CMZN_OK != cmzn_field_evaluate_real_with_derivatives(this->coordinateField, field_cache,
+			vector_dimension, coordinates, /*number_of_derivatives*/dimension, dxdxi)))
+	{
+		return false;
+	}
+	FE_value coordinate_length = 0.0;
+	for (int i = 0; i < vector_dimension*dimension; ++i)
+		coordinate_length += dxdxi[i]*dxdxi[i];
+	coordinate_length = sqrt(coordinate_length / (FE_value)dimension);
+	const int number_of_permutations =
+		FE_element_get_number_of_change_to_adjacent_element_permutations(
+			element, (FE_value *)NULL, faceNumber);
+	FE_value minimum_error = -1.0;
+	for (int permutation = 0; permutation < number_of_permutations; ++permutation)
+	{
+		adjacent_element = element;
+		adjacent_face_number = faceNumber;
+		if (!(FE_element_change_to_adjacent_element(&adjacent_element, adjacent_xi,
+				(FE_value *)NULL, &adjacent_face_number, probe_xi_face, permutation) &&
+			(CMZN_OK == field_cache->setMeshLocation(adjacent_element, adjacent_xi)) &&
+			(CMZN_OK == cmzn_field_evaluate_real(this->coordinateField, field_cache,
+				vector_dimension, adjacent_coordinates))))
+		{
+			return false;
+		}
+		FE_value error = 0.0;
+		for (int i = 0; i < vector_dimension; ++i)
+			error += (adjacent_coordinates[i] - coordinates[i])*(adjacent_coordinates[i] - coordinates[i]);
+		if ((minimum_error < 0.0) || (error < minimum_error))
+		{
+			minimum_error = error;
+			crossing.element = adjacent_element;
+			crossing.faceNumber = adjacent_face_number;
+			crossing.permutation = permutation;
+		}
+	}
+	/* We are tolerating a greater error in the coordinate positions so long
+		as the tracking is valid */
+	if (sqrt(minimum_error) > 1.0e-2*coordinate_length)
+	{
+		this->addMessage(ERROR_MESSAGE, "StreamlineTracker::resolveCrossing.  "
+			"Coordinates don't match after changing elements.");
+		crossing.element = 0;
+		crossing.faceNumber = -1;
+		crossing.permutation = 0;
+	}
+	return true;
 }
 
-int create_surface_streamribbon_FE_element_vertex_array(
-	struct FE_element *element,FE_value *start_xi,
-	cmzn_fieldcache_id field_cache, struct Computed_field *coordinate_field,
-	struct Computed_field *stream_vector_field,int reverse_track, FE_value length,
+int StreamlineTracker::changeToAdjacentElement(cmzn_fieldcache_id field_cache,
+	FE_element **element_address, FE_value *xi, int *face_number, FE_value *xi_face)
+{
+	FE_element *element = *element_address;
+	const uint64_t key = (static_cast<uint64_t>(element->getIndex()) << 8) |
+		(static_cast<uint64_t>(*face_number) << 2) | static_cast<uint64_t>(element->getDimension());
+	Crossing crossing;
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(this->crossingsMutex);
+		std::unordered_map<uint64_t, Crossing>::const_iterator iter = this->crossings.find(key);
+		if (iter != this->crossings.end())
+		{
+			crossing = iter->second;
+			found = true;
+		}
+	}
+	if (!found)
+	{
+		// resolved outside lock; another thread may resolve the same crossing
+		if (!this->resolveCrossing(field_cache, element, *face_number, crossing))
+		{
+			this->addMessage(ERROR_MESSAGE, "StreamlineTracker::changeToAdjacentElement.  "
+				"Failed to resolve element crossing");
+			return 0;
+		}
+		std::lock_guard<std::mutex> lock(this->crossingsMutex);
+		this->crossings[key] = crossing;
+	}
+	if (!crossing.element)
+	{
+		*face_number = -1;
+		return 1;
+	}
+	return FE_element_change_to_adjacent_element(element_address, xi,
+		(FE_value *)NULL, face_number, xi_face, crossing.permutation);
+}
+
+int StreamlineTracker::addPolylines(struct Graphics_vertex_array *array)
+{
+	if (!array)
+	{
+		display_message(ERROR_MESSAGE, "StreamlineTracker::addPolylines.  Invalid argument(s)");
+		return 0;
+	}
+	for (std::vector<Streamline>::iterator iter = this->streamlines.begin();
+		iter != this->streamlines.end(); ++iter)
+	{
+		if ((0 < iter->numberOfPoints) &&
+			(!add_polyline_streamline_to_vertex_array(iter->numberOfPoints,
+				iter->points, iter->data, array)))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int StreamlineTracker::addSurfaces(struct Graphics_vertex_array *array,
 	enum cmzn_graphicslineattributes_shape_type line_shape, int circleDivisions,
 	FE_value *line_base_size, FE_value *line_scale_factors,
-	struct Computed_field *line_orientation_scale_field,
-	enum cmzn_graphics_streamlines_colour_data_type colour_data_type, struct Computed_field *data_field,
-	struct Graphics_vertex_array *array)
+	struct Computed_field *line_orientation_scale_field)
 {
-	double cosw,magnitude,sinw;
-	GLfloat *stream_data,stream_datum= 0.0;
-	int d,element_dimension,i,number_of_stream_points,number_of_coordinate_components,
-		number_of_stream_vector_components,surface_points_per_step, return_code = 1;
-	Triple cross_thickness,cross_width,normal,point,stream_cross,
-		stream_normal,*stream_normals,stream_point,*stream_points,
-		stream_unit_vector = {1.0, 0.0, 0.0},stream_vector,*stream_vectors;
-
 	USE_PARAMETER(line_scale_factors);
 	USE_PARAMETER(line_orientation_scale_field);
-	if (stream_vector_field)
+	if (!((array) && (line_base_size)))
 	{
-		if (element&&FE_element_is_top_level(element, NULL)&&
-			(0 < (element_dimension = get_FE_element_dimension(element))) &&
-			((3 == element_dimension) || (2 == element_dimension))
-			&&start_xi&&coordinate_field&&
-			(0 < (number_of_coordinate_components=cmzn_field_get_number_of_components(coordinate_field))) &&
-			(number_of_stream_vector_components=
-				cmzn_field_get_number_of_components(stream_vector_field))
-				&& (((3 == number_of_coordinate_components) &&
-					((3==number_of_stream_vector_components)||
-						(6==number_of_stream_vector_components)||
-						(9==number_of_stream_vector_components)))
-						|| ((2 == number_of_coordinate_components) &&
-							(2==number_of_stream_vector_components)))&&
-							(0.0<length) && array)
+		display_message(ERROR_MESSAGE, "StreamlineTracker::addSurfaces.  Invalid argument(s)");
+		return 0;
+	}
+	for (std::vector<Streamline>::iterator iter = this->streamlines.begin();
+		iter != this->streamlines.end(); ++iter)
+	{
+		if ((0 < iter->numberOfPoints) &&
+			(!add_surface_streamribbon_to_vertex_array(iter->numberOfPoints,
+				iter->points, iter->vectors, iter->normals, iter->data,
+				line_shape, circleDivisions, line_base_size, array)))
 		{
-			const bool hasData =
-				(colour_data_type != CMZN_GRAPHICS_STREAMLINES_COLOUR_DATA_TYPE_FIELD) || (data_field);
-			const FE_value width = line_base_size[0];
-			const FE_value thickness = line_base_size[1];
-
-			/* track points and normals on streamline, and data if requested */
-			if (track_streamline_from_FE_element(&element,start_xi,
-				field_cache, coordinate_field,stream_vector_field,reverse_track,length,
-				colour_data_type,data_field,&number_of_stream_points,&stream_points,
-				&stream_vectors,&stream_normals,&stream_data))
-			{
-				if (0<number_of_stream_points)
-				{
-					switch (line_shape)
-					{
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
-						{
-							surface_points_per_step = 8;
-						} break;
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
-						{
-							surface_points_per_step = circleDivisions + 1;
-						} break;
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
-						default:
-						{
-							surface_points_per_step = 2;
-						} break;
-					}
+			return 0;
+		}
+	}
+	return 1;
+}
 
-					unsigned int vertex_start = array->get_number_of_vertices(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
-					unsigned int number_of_vertices = surface_points_per_step * number_of_stream_points;
-					/* now fill in the points and data from the streamline */
-					GLfloat floatField[3];
-					for (i=0;i<number_of_stream_points;i++)
-					{
-						stream_point[0]=stream_points[i][0];
-						stream_point[1]=stream_points[i][1];
-						stream_point[2]=stream_points[i][2];
-						stream_vector[0]=stream_vectors[i][0];
-						stream_vector[1]=stream_vectors[i][1];
-						stream_vector[2]=stream_vectors[i][2];
-						stream_normal[0]=stream_normals[i][0];
-						stream_normal[1]=stream_normals[i][1];
-						stream_normal[2]=stream_normals[i][2];
-						if (stream_data)
-						{
-							stream_datum=stream_data[i];
-						}
-						if (0.0 < (magnitude = sqrt(stream_vector[0]*stream_vector[0]+
-							stream_vector[1]*stream_vector[1]+
-							stream_vector[2]*stream_vector[2])))
-						{
-							stream_unit_vector[0] = stream_vector[0] / GLfloat(magnitude);
-							stream_unit_vector[1] = stream_vector[1] / GLfloat(magnitude);
-							stream_unit_vector[2] = stream_vector[2] / GLfloat(magnitude);
-						}
-						/* get stream_cross = stream_normal (x) stream_unit_vector */
-						stream_cross[0]=stream_normal[1]*stream_unit_vector[2]-
-							stream_normal[2]*stream_unit_vector[1];
-						stream_cross[1]=stream_normal[2]*stream_unit_vector[0]-
-							stream_normal[0]*stream_unit_vector[2];
-						stream_cross[2]=stream_normal[0]*stream_unit_vector[1]-
-							stream_normal[1]*stream_unit_vector[0];
-						cross_width[0] = stream_cross[0] * 0.5f * width;
-						cross_width[1] = stream_cross[1] * 0.5f * width;
-						cross_width[2] = stream_cross[2] * 0.5f * width;
-						cross_thickness[0] = stream_normal[0] * 0.5f * GLfloat(thickness);
-						cross_thickness[1] = stream_normal[1] * 0.5f * GLfloat(thickness);
-						cross_thickness[2] = stream_normal[2] * 0.5f * GLfloat(thickness);
-						switch (line_shape)
-						{
-							case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
-							default:
-							{
-								point[0] = stream_point[0] + cross_width[0];
-								point[1] = stream_point[1] + cross_width[1];
-								point[2] = stream_point[2] + cross_width[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_normal[0];
-								normal[1] = stream_normal[1];
-								normal[2] = stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && (stream_data))
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-								point[0] = stream_point[0] - cross_width[0];
-								point[1] = stream_point[1] - cross_width[1];
-								point[2] = stream_point[2] - cross_width[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_normal[0];
-								normal[1] = stream_normal[1];
-								normal[2] = stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-							} break;
-							case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
-							{
-								for (d = 0 ; d < surface_points_per_step ; d++)
-								{
-									sinw = sin( 2 * PI * (double)d /
-										(double)(surface_points_per_step - 1));
-									cosw = cos( 2 * PI * (double)d /
-										(double)(surface_points_per_step - 1));
-									point[0] = stream_point[0] + GLfloat(sinw) * cross_width[0] + GLfloat(cosw) * cross_thickness[0];
-									point[1] = stream_point[1] + GLfloat(sinw) * cross_width[1] + GLfloat(cosw) * cross_thickness[1];
-									point[2] = stream_point[2] + GLfloat(sinw) * cross_width[2] + GLfloat(cosw) * cross_thickness[2];
-									CAST_TO_OTHER(floatField,point,GLfloat,3);
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-										3, 1, floatField);
-									normal[0] = -GLfloat(sinw) * stream_cross[0] * 0.5f * GLfloat(thickness) -
-										GLfloat(cosw) * stream_normal[0] * 0.5f * width;
-									normal[1] = -GLfloat(sinw) * stream_cross[1] * 0.5f * GLfloat(thickness) -
-										GLfloat(cosw) * stream_normal[1] * 0.5f * GLfloat(thickness);
-									normal[2] = -GLfloat(sinw) * stream_cross[2] * 0.5f * GLfloat(thickness) -
-										GLfloat(cosw) * stream_normal[2] * 0.5f * GLfloat(thickness);
-									magnitude = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-									if (0.0<magnitude)
-									{
-										normal[0] /= GLfloat(magnitude);
-										normal[1] /= GLfloat(magnitude);
-										normal[2] /= GLfloat(magnitude);
-									}
-									CAST_TO_OTHER(floatField,normal,GLfloat,3);
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-										3, 1, floatField);
-									if (hasData && stream_data)
-									{
-										array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-											1, 1, &stream_datum);
-									}
-								}
-							} break;
-							case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
-							{
-								point[0] = stream_point[0] + cross_width[0] + cross_thickness[0];
-								point[1] = stream_point[1] + cross_width[1] + cross_thickness[1];
-								point[2] = stream_point[2] + cross_width[2] + cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_normal[0];
-								normal[1] = stream_normal[1];
-								normal[2] = stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-								point[0] = stream_point[0] - cross_width[0] + cross_thickness[0];
-								point[1] = stream_point[1] - cross_width[1] + cross_thickness[1];
-								point[2] = stream_point[2] - cross_width[2] + cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_normal[0];
-								normal[1] = stream_normal[1];
-								normal[2] = stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
+StreamlinePathCache::StreamlinePathCache() :
+	mode(MODE_PATHLINES),
+	startTime(0.0),
+	timeStep(0.0),
+	hasData(false)
+{
+}
 
-								point[0] = stream_point[0] - cross_width[0] + cross_thickness[0];
-								point[1] = stream_point[1] - cross_width[1] + cross_thickness[1];
-								point[2] = stream_point[2] - cross_width[2] + cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = -stream_cross[0];
-								normal[1] = -stream_cross[1];
-								normal[2] = -stream_cross[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-								point[0] = stream_point[0] - cross_width[0] - cross_thickness[0];
-								point[1] = stream_point[1] - cross_width[1] - cross_thickness[1];
-								point[2] = stream_point[2] - cross_width[2] - cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = -stream_cross[0];
-								normal[1] = -stream_cross[1];
-								normal[2] = -stream_cross[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
+StreamlinePathCache::~StreamlinePathCache()
+{
+	this->clear();
+}
 
-								point[0] = stream_point[0] - cross_width[0] - cross_thickness[0];
-								point[1] = stream_point[1] - cross_width[1] - cross_thickness[1];
-								point[2] = stream_point[2] - cross_width[2] - cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = -stream_normal[0];
-								normal[1] = -stream_normal[1];
-								normal[2] = -stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-								point[0] = stream_point[0] + cross_width[0] - cross_thickness[0];
-								point[1] = stream_point[1] + cross_width[1] - cross_thickness[1];
-								point[2] = stream_point[2] + cross_width[2] - cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = -stream_normal[0];
-								normal[1] = -stream_normal[1];
-								normal[2] = -stream_normal[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
+void StreamlinePathCache::clear()
+{
+	for (std::vector<FE_element *>::iterator iter = this->seedElements.begin();
+		iter != this->seedElements.end(); ++iter)
+		cmzn_element::deaccess(*iter);
+	for (std::vector<FE_element *>::iterator iter = this->elements.begin();
+		iter != this->elements.end(); ++iter)
+		cmzn_element::deaccess(*iter);
+	this->seedElements.clear();
+	this->seedXi.clear();
+	this->elements.clear();
+	this->xi.clear();
+	this->stepSizes.clear();
+	this->stepCounts.clear();
+	this->lastSamples.clear();
+	this->activeFlags.clear();
+	this->samples.clear();
+}
 
-								point[0] = stream_point[0] + cross_width[0] - cross_thickness[0];
-								point[1] = stream_point[1] + cross_width[1] - cross_thickness[1];
-								point[2] = stream_point[2] + cross_width[2] - cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_cross[0];
-								normal[1] = stream_cross[1];
-								normal[2] = stream_cross[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-								point[0] = stream_point[0] + cross_width[0] + cross_thickness[0];
-								point[1] = stream_point[1] + cross_width[1] + cross_thickness[1];
-								point[2] = stream_point[2] + cross_width[2] + cross_thickness[2];
-								CAST_TO_OTHER(floatField,point,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
-									3, 1, floatField);
-								normal[0] = stream_cross[0];
-								normal[1] = stream_cross[1];
-								normal[2] = stream_cross[2];
-								CAST_TO_OTHER(floatField,normal,GLfloat,3);
-								array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
-									3, 1, floatField);
-								if (hasData && stream_data)
-								{
-									array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
-										1, 1, &stream_datum);
-								}
-							} break;
-						}
-					}
-					int polygonType = (int)g_TRIANGLE;
-
-					unsigned int number_of_xi1 = surface_points_per_step,
-						number_of_xi2 = number_of_stream_points;
-					array->add_unsigned_integer_attribute(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
-						1, 1, &number_of_vertices);
-					array->add_unsigned_integer_attribute(
-						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
-						1, 1, &vertex_start);
-					array->add_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POLYGON,
-						1, 1, &polygonType);
-					array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_XI1,
-						1, 1, &number_of_xi1);
-					array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_XI2,
-						1, 1, &number_of_xi2);
-					array->fill_element_index(vertex_start, number_of_xi1, number_of_xi2,
-						ARRAY_SHAPE_TYPE_UNSPECIFIED);
-					/* no longer need original streamline */
-					DEALLOCATE(stream_points);
-					DEALLOCATE(stream_vectors);
-					DEALLOCATE(stream_normals);
-					DEALLOCATE(stream_data);
-				}
-				else
+void StreamlinePathCache::setSeeds(Mode modeIn, FE_value startTimeIn, FE_value timeStepIn,
+	bool hasDataIn, const std::vector<FE_element *>& seedElementsIn,
+	const std::vector<FE_value>& seedXiIn)
+{
+	if ((modeIn == this->mode) && (startTimeIn == this->startTime) &&
+		(timeStepIn == this->timeStep) && (hasDataIn == this->hasData) &&
+		(seedElementsIn == this->seedElements) && (seedXiIn == this->seedXi))
+	{
+		return;
+	}
+	this->clear();
+	this->mode = modeIn;
+	this->startTime = startTimeIn;
+	this->timeStep = timeStepIn;
+	this->hasData = hasDataIn;
+	this->seedElements = seedElementsIn;
+	for (std::vector<FE_element *>::iterator iter = this->seedElements.begin();
+		iter != this->seedElements.end(); ++iter)
+		(*iter)->access();
+	this->seedXi = seedXiIn;
+}
+
+void StreamlinePathCache::addSamples(int sampleCount)
+{
+	const int seedCount = this->getSeedCount();
+	const int valuesPerParticle = this->getValuesPerParticle();
+	for (int sample = this->getNumberOfSamples(); sample < sampleCount; ++sample)
+	{
+		// release particles from seeds
+		const int particleCount = this->getParticleCount(sample);
+		for (int particle = static_cast<int>(this->elements.size()); particle < particleCount; ++particle)
+		{
+			const int seed = particle % seedCount;
+			this->elements.push_back(this->seedElements[seed]->access());
+			std::vector<FE_value>::const_iterator seedXiIter =
+				this->seedXi.begin() + seed*MAXIMUM_ELEMENT_XI_DIMENSIONS;
+			this->xi.insert(this->xi.end(), seedXiIter, seedXiIter + MAXIMUM_ELEMENT_XI_DIMENSIONS);
+			this->stepSizes.push_back(0.0);
+			this->stepCounts.push_back(0);
+			this->lastSamples.push_back(-1);
+			this->activeFlags.push_back(1);
+		}
+		this->samples.push_back(std::vector<GLfloat>(particleCount*valuesPerParticle, 0.0f));
+	}
+}
+
+void StreamlinePathCache::appendValues(int particle0, int sample0, int particle1, int sample1,
+	FE_value weight, std::vector<GLfloat>& points, std::vector<GLfloat>& data) const
+{
+	const int valuesPerParticle = this->getValuesPerParticle();
+	const GLfloat *values0 = &(this->samples[sample0][particle0*valuesPerParticle]);
+	const GLfloat *values1 = &(this->samples[sample1][particle1*valuesPerParticle]);
+	for (int i = 0; i < 3; ++i)
+		points.push_back(static_cast<GLfloat>((1.0 - weight)*values0[i] + weight*values1[i]));
+	if (this->hasData)
+		data.push_back(static_cast<GLfloat>((1.0 - weight)*values0[3] + weight*values1[3]));
+}
+
+int StreamlinePathCache::addPolylines(struct Graphics_vertex_array *array, FE_value time) const
+{
+	if (!array)
+	{
+		display_message(ERROR_MESSAGE, "StreamlinePathCache::addPolylines.  Invalid argument(s)");
+		return 0;
+	}
+	const int seedCount = this->getSeedCount();
+	const int sampleCount = this->getNumberOfSamples();
+	if ((0 == seedCount) || (0 == sampleCount) || (time < this->startTime))
+		return 1;
+	// samples either side of time, matching rounding in StreamlineTracker::trackPaths
+	const FE_value samplePosition = (time - this->startTime)/this->timeStep;
+	int lowerSample = static_cast<int>(floor(samplePosition));
+	FE_value weight = samplePosition - lowerSample;
+	if (weight > 1.0 - 1.0E-6)
+	{
+		++lowerSample;
+		weight = 0.0;
+	}
+	else if (weight < 1.0E-6)
+		weight = 0.0;
+	const int upperSample = (weight > 0.0) ? lowerSample + 1 : lowerSample;
+	if (upperSample >= sampleCount)
+	{
+		display_message(ERROR_MESSAGE, "StreamlinePathCache::addPolylines.  "
+			"Particles have not been advanced to time %g", time);
+		return 0;
+	}
+	std::vector<GLfloat> points, data;
+	for (int seed = 0; seed < seedCount; ++seed)
+	{
+		points.clear();
+		data.clear();
+		if (MODE_PATHLINES == this->mode)
+		{
+			const int particle = seed;
+			const int lastSample = this->lastSamples[particle];
+			for (int sample = 0; (sample <= lowerSample) && (sample <= lastSample); ++sample)
+				this->appendValues(particle, sample, particle, sample, 0.0, points, data);
+			if ((weight > 0.0) && (lastSample >= upperSample))
+				this->appendValues(particle, lowerSample, particle, upperSample, weight, points, data);
+		}
+		else
+		{
+			// join particles from the seed to the oldest, omitting any which stopped
+			for (int releaseSample = upperSample; 0 <= releaseSample; --releaseSample)
+			{
+				const int particle = releaseSample*seedCount + seed;
+				if (this->lastSamples[particle] < upperSample)
+					continue;
+				if (releaseSample > lowerSample)
 				{
-					/* no error: streamline empty */
-					return_code = 0;
+					// released after time: interpolate seed position from previous release
+					const int previousParticle = lowerSample*seedCount + seed;
+					if (this->lastSamples[previousParticle] >= lowerSample)
+						this->appendValues(previousParticle, lowerSample, particle, upperSample,
+							weight, points, data);
 				}
-			}
-			else
-			{
-				display_message(ERROR_MESSAGE,
-					"create_surface_streamribbon_FE_element_vertex_array.  "
-					"failed to track streamline");
-				return_code = 0;
+				else
+					this->appendValues(particle, lowerSample, particle, upperSample, weight, points, data);
 			}
 		}
-		else
+		const int pointCount = static_cast<int>(points.size()/3);
+		if ((1 < pointCount) && (!add_polyline_streamline_to_vertex_array(pointCount,
+			reinterpret_cast<Triple *>(points.data()), (this->hasData) ? data.data() : 0, array)))
 		{
-			display_message(ERROR_MESSAGE,
-				"create_surface_streamribbon_FE_element_vertex_array.  Invalid argument(s)");
-			return_code = 0;
+			return 0;
 		}
 	}
-	else
-	{
-		return_code = 0;
-	}
-
-	return (return_code);
+	return 1;
 }
 
 int add_flow_particle(struct Streampoint **list,FE_value *xi,
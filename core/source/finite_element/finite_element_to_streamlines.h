@@ -15,9 +15,18 @@ Functions for calculating streamlines in finite elements.
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #if !defined (FINITE_ELEMENT_TO_STREAMLINES_H)
 #define FINITE_ELEMENT_TO_STREAMLINES_H
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "opencmiss/zinc/types/fieldmoduleid.h"
+#include "opencmiss/zinc/types/graphicsid.h"
 #include "finite_element/finite_element.h"
 #include "general/list.h"
 #include "general/manager.h"
+#include "general/message.h"
 #include "general/object.h"
 
 /*
@@ -57,44 +66,276 @@ Global functions
 ----------------
 */
 
-
 /**
- * Creates a <GT_polyline_vertex_buffers> streamline from the <coordinate_field> tracking
- * <stream_vector_field> (with 3, 6 or 9 components) starting in the element and at
- * the xi coordinates supplied. If <reverse_track> is true, the reverse of the
- * stream vector is tracked, and the travel_scalar is made negative.
- * @param field_cache  cmzn_fieldcache for evaluating fields with. Time is
- * expected to have been set in the field_cache if needed.
+ * Particle paths for pathlines or streaklines from fixed seed points through a
+ * time-varying stream vector field, kept between graphics builds so they can
+ * be advanced incrementally as time increases. Particles are released from each
+ * seed at the start time for pathlines, or at every sample time for
+ * streaklines. The element, xi and integration state of each particle are held
+ * in flat arrays indexed by particle, and particle positions are sampled at
+ * regular time steps from the start time. Samples are kept for all times
+ * reached so earlier times are drawn without retracing.
+ * Particles are advanced by StreamlineTracker::trackPaths.
  */
-int create_polyline_streamline_FE_element_vertex_array(
-	struct FE_element *element,FE_value *start_xi,
-	cmzn_fieldcache_id field_cache, struct Computed_field *coordinate_field,
-	struct Computed_field *stream_vector_field,int reverse_track,
-	FE_value length, enum cmzn_graphics_streamlines_colour_data_type colour_data_type,
-	struct Computed_field *data_field,
-	struct Graphics_vertex_array *array);
+class StreamlinePathCache
+{
+	friend class StreamlineTracker;
+
+public:
+	enum Mode
+	{
+		MODE_PATHLINES,
+		MODE_STREAKLINES
+	};
+
+private:
+	Mode mode;
+	FE_value startTime, timeStep;
+	bool hasData;
+	std::vector<FE_element *> seedElements;  // accessed
+	std::vector<FE_value> seedXi;  // MAXIMUM_ELEMENT_XI_DIMENSIONS per seed
+	/* particle state: particle p is released from seed p % seedCount at
+	 * sample p / seedCount */
+	std::vector<FE_element *> elements;  // accessed current element
+	std::vector<FE_value> xi;  // MAXIMUM_ELEMENT_XI_DIMENSIONS per particle
+	std::vector<FE_value> stepSizes;  // next integration step size, 0 if none yet
+	std::vector<int> stepCounts;
+	std::vector<int> lastSamples;  // last sample particle reached, -1 if none
+	std::vector<unsigned char> activeFlags;  // 0 once particle stops
+	/* 3 coordinates then data value if hasData for each particle released by
+	 * each sample */
+	std::vector< std::vector<GLfloat> > samples;
+
+	StreamlinePathCache(const StreamlinePathCache&);  // not implemented
+	StreamlinePathCache& operator=(const StreamlinePathCache&);  // not implemented
+
+	int getSeedCount() const
+	{
+		return static_cast<int>(this->seedElements.size());
+	}
+
+	int getValuesPerParticle() const
+	{
+		return (this->hasData) ? 4 : 3;
+	}
+
+	/** @return  Number of particles released by sample. */
+	int getParticleCount(int sample) const
+	{
+		return (MODE_PATHLINES == this->mode) ? this->getSeedCount() : (sample + 1)*this->getSeedCount();
+	}
+
+	int getReleaseSample(int particle) const
+	{
+		return (MODE_PATHLINES == this->mode) ? 0 : particle / this->getSeedCount();
+	}
+
+	FE_value getSampleTime(int sample) const
+	{
+		return this->startTime + sample*this->timeStep;
+	}
+
+	/** Append position and data interpolated by weight from particle0 at
+	 * sample0 to particle1 at sample1. */
+	void appendValues(int particle0, int sample0, int particle1, int sample1,
+		FE_value weight, std::vector<GLfloat>& points, std::vector<GLfloat>& data) const;
+
+	/** Ensure sample storage and particles are allocated up to sampleCount */
+	void addSamples(int sampleCount);
+
+public:
+
+	StreamlinePathCache();
+
+	~StreamlinePathCache();
+
+	/** Discard seeds, particles and samples. */
+	void clear();
+
+	/**
+	 * Set seeds, mode and sampling for paths, clearing any particles and samples
+	 * if they differ from those the cache was built with.
+	 * @param seedElements  Top-level seed elements, not accessed by caller.
+	 * @param seedXi  MAXIMUM_ELEMENT_XI_DIMENSIONS xi for each seed.
+	 * @param hasData  True if a data value is kept with each position.
+	 */
+	void setSeeds(Mode mode, FE_value startTime, FE_value timeStep, bool hasData,
+		const std::vector<FE_element *>& seedElements, const std::vector<FE_value>& seedXi);
+
+	/** @return  Number of sample times particles have been advanced to. */
+	int getNumberOfSamples() const
+	{
+		return static_cast<int>(this->samples.size());
+	}
+
+	/**
+	 * Add pathlines or streaklines at time to the array as polylines, with
+	 * positions interpolated between samples either side of time. Particles must
+	 * have been advanced to cover time. Particles which have stopped are omitted
+	 * from streaklines.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int addPolylines(struct Graphics_vertex_array *array, FE_value time) const;
+
+};
 
 /**
- * Fills the array with coordinates of the streamline from the <coordinate_field> following
- * <stream_vector_field> (with 3, 6 or 9 components) starting in the element and at
- * the xi coordinates supplied. If <reverse_track> is true, the reverse of the
- * stream vector is tracked, and the travel_scalar is made negative.
- * @param field_cache  cmzn_fieldcache for evaluating fields with. Time is
- * expected to have been set in the field_cache if needed.
- * @param line_shape  LINE, RIBBON, CIRCLE_EXTRUSION or SQUARE_EXTRUSION.
- * @param line_base_size  width and thickness of line, use depends on shape.
- * @param line_scale_factors  Ignored. For future use.
- * @param line_orientation_scale_field  Ignored. For future use.
+ * Tracks streamlines of <stream_vector_field> (with 3, 6 or 9 components) on the
+ * <coordinate_field> from seed points in top-level elements, and adds them to a
+ * vertex array as lines or surfaces in the order seeds were added.
+ * Streamlines are integrated with an adaptive Dormand-Prince (RK45) method, and
+ * seeds are tracked in parallel on several threads, each with its own field
+ * cache. Element face crossings are resolved once against the coordinate field
+ * when first reached and shared by all streamlines.
  */
-int create_surface_streamribbon_FE_element_vertex_array(
-	struct FE_element *element,FE_value *start_xi,
-	cmzn_fieldcache_id field_cache, struct Computed_field *coordinate_field,
-	struct Computed_field *stream_vector_field,int reverse_track, FE_value length,
-	enum cmzn_graphicslineattributes_shape_type line_shape, int circleDivisions,
-	FE_value *line_base_size, FE_value *line_scale_factors,
-	struct Computed_field *line_orientation_scale_field,
-	enum cmzn_graphics_streamlines_colour_data_type colour_data_type, struct Computed_field *data_field,
-	struct Graphics_vertex_array *array);
+class StreamlineTracker
+{
+public:
+	/** Element, face and xi face permutation across a face of an element */
+	struct Crossing
+	{
+		FE_element *element;  // not accessed; 0 if no adjacent element
+		int faceNumber;
+		int permutation;
+	};
+
+private:
+	struct Streamline
+	{
+		FE_element *element;  // accessed seed element
+		FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		int numberOfPoints;
+		Triple *points, *vectors, *normals;
+		GLfloat *data;
+	};
+
+	cmzn_fieldmodule_id fieldmodule;
+	FE_value time;
+	Computed_field *coordinateField, *streamVectorField, *dataField;
+	int reverseTrack;
+	FE_value length;
+	FE_value tolerance;
+	int maximumNumberOfSteps;
+	enum cmzn_graphics_streamlines_colour_data_type colourDataType;
+	std::vector<Streamline> streamlines;
+	std::unordered_map<uint64_t, Crossing> crossings;
+	std::mutex crossingsMutex;
+	// messages from tracking threads, reported after they join
+	std::vector< std::pair<enum Message_type, std::string> > messages;
+	std::mutex messagesMutex;
+
+	StreamlineTracker(const StreamlineTracker&);  // not implemented
+	StreamlineTracker& operator=(const StreamlineTracker&);  // not implemented
+
+	bool resolveCrossing(cmzn_fieldcache_id field_cache, FE_element *element,
+		int faceNumber, Crossing& crossing);
+
+	/** Call function for indexes 0 to count - 1 on several threads, each with
+	 * its own field cache, then report messages added while running.
+	 * @return  True if all calls succeeded. */
+	bool runInParallel(int count,
+		const std::function<bool(cmzn_fieldcache_id, int)>& function);
+
+	/** Display and clear messages added by tracking threads. */
+	void reportMessages();
+
+	/** Evaluate position and data of particle at element xi at sample time. */
+	bool evaluatePathSample(cmzn_fieldcache_id fieldcache, StreamlinePathCache& pathCache,
+		int particle, int sample, FE_element *element, const FE_value *xi);
+
+	/** Advance particle from its last sample to endSample unless it stops. */
+	bool advanceParticle(cmzn_fieldcache_id fieldcache, StreamlinePathCache& pathCache,
+		int particle, int endSample);
+
+public:
+
+	/**
+	 * @param fieldmodule  Field module to create field caches for tracking in.
+	 * @param time  Time to evaluate fields at.
+	 * @param reverseTrack  If true, the reverse of the stream vector is tracked,
+	 * and the travel time data is made negative.
+	 * @param length  Maximum length of time to track each streamline for.
+	 * @param tolerance  Error tolerance for each step relative to element size.
+	 * @param maximumNumberOfSteps  Maximum number of steps on each streamline.
+	 */
+	StreamlineTracker(cmzn_fieldmodule_id fieldmodule, FE_value time,
+		Computed_field *coordinateField, Computed_field *streamVectorField,
+		int reverseTrack, FE_value length, FE_value tolerance, int maximumNumberOfSteps,
+		enum cmzn_graphics_streamlines_colour_data_type colourDataType,
+		Computed_field *dataField);
+
+	~StreamlineTracker();
+
+	/** Add seed point to track a streamline from. @return  CMZN_OK on success,
+	 * otherwise any other error code. */
+	int addSeed(FE_element *element, const FE_value *xi);
+
+	int getNumberOfSeeds() const
+	{
+		return static_cast<int>(this->streamlines.size());
+	}
+
+	/**
+	 * Track streamlines from all seeds not yet tracked, in parallel.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int track();
+
+	/**
+	 * Advance particles in pathCache released from this tracker's seeds
+	 * forward through the time-varying stream vector field to the first sample
+	 * at or after endTime, in parallel. Samples already in the cache are reused,
+	 * and particles continue from the last sample reached. The cache is cleared
+	 * first if its seeds, mode, start time or time step differ. Track direction
+	 * and length are not used; tolerance and maximum number of steps apply over
+	 * the life of each particle.
+	 * @param startTime  Time particles are first released at.
+	 * @param timeStep  Interval between samples and streakline releases > 0.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int trackPaths(StreamlinePathCache& pathCache, StreamlinePathCache::Mode mode,
+		FE_value startTime, FE_value timeStep, FE_value endTime);
+
+	/**
+	 * Get element and xi on the other side of face of element, resolving and
+	 * remembering the crossing the first time the face is reached.
+	 * @param field_cache  Field cache for the calling thread.
+	 * @param element_address  On input the element, on output the adjacent
+	 * element. Unchanged if there is no adjacent element.
+	 * @param xi  Receives xi in the adjacent element.
+	 * @param face_number  On input the face of element, on output the face of
+	 * the adjacent element, or -1 if there is no adjacent element.
+	 * @param xi_face  Xi on the face of element to convert.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int changeToAdjacentElement(cmzn_fieldcache_id field_cache,
+		FE_element **element_address, FE_value *xi, int *face_number, FE_value *xi_face);
+
+	/**
+	 * Add message to display once tracking threads have finished, since
+	 * messages cannot be displayed from them. Repeats of a message are
+	 * displayed once.
+	 */
+	void addMessage(enum Message_type messageType, const char *message);
+
+	/** Add tracked streamlines to array as polylines.
+	 * @return  1 on success, 0 on failure. */
+	int addPolylines(struct Graphics_vertex_array *array);
+
+	/**
+	 * Add tracked streamlines to array as surfaces.
+	 * @param line_shape  RIBBON, CIRCLE_EXTRUSION or SQUARE_EXTRUSION.
+	 * @param line_base_size  width and thickness of line, use depends on shape.
+	 * @param line_scale_factors  Ignored. For future use.
+	 * @param line_orientation_scale_field  Ignored. For future use.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int addSurfaces(struct Graphics_vertex_array *array,
+		enum cmzn_graphicslineattributes_shape_type line_shape, int circleDivisions,
+		FE_value *line_base_size, FE_value *line_scale_factors,
+		struct Computed_field *line_orientation_scale_field);
+
+};
 
 int add_flow_particle(struct Streampoint **list,FE_value *xi,
 	struct FE_element *element,Triple **pointlist,int index,
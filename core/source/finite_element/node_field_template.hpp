@@ -33,7 +33,8 @@ class FE_node_field_template
 {
 	friend int global_to_element_map_values(FE_field *field, int componentNumber,
 		const FE_element_field_template *eft, cmzn_element *element, FE_value time,
-		const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value*& elementValues);
+		const FE_nodeset *nodeset, const FE_value *scaleFactors, FE_value *workValues,
+		FE_value *elementValues);
 
 	// the offset for the field component values within the node values storage
 	int valuesOffset;
@@ -4988,6 +4988,27 @@ Clears 'valid' flag if fails.
 	return (return_code);
 } /* Cmgui_image_information_add_file_name */
 
+int Cmgui_image_information_clear_file_names(
+	struct Cmgui_image_information *cmgui_image_information)
+{
+	if (!cmgui_image_information)
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmgui_image_information_clear_file_names.  Invalid argument(s)");
+		return 0;
+	}
+	if (cmgui_image_information->file_names)
+	{
+		for (int i = 0; i < cmgui_image_information->number_of_file_names; i++)
+		{
+			DEALLOCATE(cmgui_image_information->file_names[i]);
+		}
+		DEALLOCATE(cmgui_image_information->file_names);
+	}
+	cmgui_image_information->number_of_file_names = 0;
+	return 1;
+}
+
 int Cmgui_image_information_set_file_name_series(
 	struct Cmgui_image_information *cmgui_image_information,
 	char *file_name_template, char *file_number_pattern, int start_file_number,
@@ -6236,7 +6257,7 @@ right in each row. Pixel colours are interleaved, eg. RGBARGBARGBA...
 
 int Cmgui_image_dispatch(struct Cmgui_image *cmgui_image,
 	int image_number, int left, int bottom, int width, int height,
-	int padded_width_bytes, int number_of_fill_bytes, unsigned char *fill_bytes,
+	int padded_width_bytes, int number_of_fill_bytes, const unsigned char *fill_bytes,
 	int components, unsigned char *destination_pixels)
 /*******************************************************************************
 LAST MODIFIED : 12 March 2002
@@ -283,6 +283,12 @@ enum Image_file_format Cmgui_image_information_get_image_file_format(
 int Cmgui_image_information_add_file_name(
 	struct Cmgui_image_information *cmgui_image_information, char *file_name);
 
+/**
+ * Removes all file names from <cmgui_image_information>.
+ */
+int Cmgui_image_information_clear_file_names(
+	struct Cmgui_image_information *cmgui_image_information);
+
 /**
  * Adds a series of file names based on the <file_name_template> to the
  * <cmgui_image_information>. The numbers from <start_file_number> to
@@ -490,7 +496,7 @@ right in each row. Pixel colours are interleaved, eg. RGBARGBARGBA...
 
 int Cmgui_image_dispatch(struct Cmgui_image *cmgui_image,
 	int image_number, int left, int bottom, int width, int height,
-	int padded_width_bytes, int number_of_fill_bytes, unsigned char *fill_bytes,
+	int padded_width_bytes, int number_of_fill_bytes, const unsigned char *fill_bytes,
 	int components, unsigned char *destination_pixels);
 /*******************************************************************************
 LAST MODIFIED : 27 February 2002
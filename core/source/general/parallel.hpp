@@ -0,0 +1,101 @@
+/**
+ * FILE : parallel.hpp
+ *
+ * Runs independent tasks over hardware threads.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (PARALLEL_HPP)
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace CMZN {
+
+/**
+ * Get number of threads to run count independent tasks on.
+ * @param maximumThreadCount  Limit on number of threads, or 0 for no limit
+ * other than the number of hardware threads.
+ * @return  Number of threads from 1 to count, or 1 if count is 0.
+ */
+inline int parallel_get_thread_count(size_t count, int maximumThreadCount = 0)
+{
+	size_t threadCount = (0 < maximumThreadCount) ?
+		static_cast<size_t>(maximumThreadCount) : std::thread::hardware_concurrency();
+	threadCount = std::min(threadCount, count);
+	return (threadCount > 1) ? static_cast<int>(threadCount) : 1;
+}
+
+/**
+ * Call function(threadIndex, index) for indexes begin to end - 1 on
+ * threadCount threads. The calling thread is thread 0 and this returns once
+ * all calls have returned. Threads take the next index in increasing order
+ * as they become free, so tasks of varying cost are balanced. Calls on
+ * different threads must not modify the same data without synchronisation;
+ * use threadIndex to select per-thread working storage.
+ * If a thread cannot be started, the remaining indexes are run on the
+ * threads already started and the calling thread.
+ * @param threadCount  Number of threads, normally from
+ * parallel_get_thread_count. Values < 2 run all calls on the calling thread.
+ */
+template <typename Function>
+void parallel_for(size_t begin, size_t end, int threadCount, Function function)
+{
+	if (end <= begin)
+		return;
+	std::atomic<size_t> nextIndex(begin);
+	auto runIndexes = [&](int threadIndex)
+	{
+		size_t index;
+		while ((index = nextIndex++) < end)
+			function(threadIndex, index);
+	};
+	std::vector<std::thread> threads;
+	if (threadCount > 1)
+		threads.reserve(threadCount - 1);
+	for (int t = 1; t < threadCount; ++t)
+	{
+		try
+		{
+			threads.push_back(std::thread(runIndexes, t));
+		}
+		catch (const std::system_error&)
+		{
+			break; // out of threads: calling thread takes remaining indexes
+		}
+	}
+	runIndexes(0);
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+}
+
+/**
+ * Call function(block, start, end) for consecutive blocks of blockSize
+ * indexes covering 0 to count - 1, on as many hardware threads as there are
+ * blocks, up to maximumThreadCount if > 0.
+ */
+template <typename Function>
+void parallel_for_blocks(size_t count, size_t blockSize, Function function,
+	int maximumThreadCount = 0)
+{
+	const size_t blockCount = (count + blockSize - 1)/blockSize;
+	parallel_for(0, blockCount, parallel_get_thread_count(blockCount, maximumThreadCount),
+		[&](int, size_t block)
+		{
+			const size_t start = block*blockSize;
+			function(block, start, std::min(count, start + blockSize));
+		});
+}
+
+} // namespace CMZN
+
+#endif /* !defined (PARALLEL_HPP) */
@@ -59,6 +59,8 @@
 #include "graphics/render_gl.h"
 #include "graphics/scene_coordinate_system.hpp"
 #include "graphics/tessellation.hpp"
+#include "mesh/cmiss_element_private.hpp"
+#include "time/time_keeper.hpp"
 #if defined(USE_OPENCASCADE)
 #	include "cad/computed_field_cad_geometry.h"
 #	include "cad/computed_field_cad_topology.h"
@@ -79,8 +81,137 @@ enum cmzn_graphics_change
 	CMZN_GRAPHICS_CHANGE_SELECTION = 3,       /**< change to selected objects */
 	CMZN_GRAPHICS_CHANGE_PARTIAL_REBUILD = 4, /**< partial rebuild of graphics object */
 	CMZN_GRAPHICS_CHANGE_FULL_REBUILD = 5,    /**< graphics object needs full rebuild */
+	CMZN_GRAPHICS_CHANGE_LEVEL_OF_DETAIL = 6, /**< tessellation divisions changed: rebuild or reuse cached */
+	CMZN_GRAPHICS_CHANGE_TIME = 7             /**< time changed: full rebuild reusing cached particle paths */
 };
 
+void GraphicsLevelOfDetailCache::clear()
+{
+	for (std::list<Entry>::iterator iter = this->entries.begin(); iter != this->entries.end(); ++iter)
+		DEACCESS(GT_object)(&(iter->graphicsObject));
+	this->entries.clear();
+	this->memorySize = 0;
+}
+
+void GraphicsLevelOfDetailCache::evict()
+{
+	while ((0 < this->entries.size()) &&
+		((this->memorySize > this->memoryBudget) || (this->entries.size() > this->maximumEntries)))
+	{
+		Entry& entry = this->entries.back();
+		this->memorySize -= entry.memorySize;
+		DEACCESS(GT_object)(&(entry.graphicsObject));
+		this->entries.pop_back();
+	}
+}
+
+void GraphicsLevelOfDetailCache::add(const cmzn_graphics_level_of_detail& levelOfDetail,
+	GT_object *graphicsObject)
+{
+	if (!graphicsObject)
+		return;
+	GT_object *oldGraphicsObject = this->extract(levelOfDetail);
+	if (oldGraphicsObject)
+		DEACCESS(GT_object)(&oldGraphicsObject);
+	Entry entry;
+	entry.levelOfDetail = levelOfDetail;
+	entry.graphicsObject = ACCESS(GT_object)(graphicsObject);
+	entry.memorySize = GT_object_get_memory_size(graphicsObject);
+	this->entries.push_front(entry);
+	this->memorySize += entry.memorySize;
+	this->evict();
+}
+
+GT_object *GraphicsLevelOfDetailCache::extract(const cmzn_graphics_level_of_detail& levelOfDetail)
+{
+	for (std::list<Entry>::iterator iter = this->entries.begin(); iter != this->entries.end(); ++iter)
+	{
+		if (iter->levelOfDetail == levelOfDetail)
+		{
+			GT_object *graphicsObject = iter->graphicsObject;
+			this->memorySize -= iter->memorySize;
+			this->entries.erase(iter);
+			return graphicsObject;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Discard graphics objects kept for other levels of detail, which is required
+ * whenever graphics are changed in any way other than tessellation divisions.
+ */
+static void cmzn_graphics_clear_level_of_detail(struct cmzn_graphics *graphics)
+{
+	if (graphics->level_of_detail_display_object)
+		DEACCESS(GT_object)(&(graphics->level_of_detail_display_object));
+	if (graphics->level_of_detail_cache)
+		graphics->level_of_detail_cache->clear();
+}
+
+/**
+ * Discard particle paths kept for pathlines and streaklines, which is required
+ * whenever graphics are changed in any way other than time.
+ */
+static void cmzn_graphics_clear_streamlines_path_cache(struct cmzn_graphics *graphics)
+{
+	if (graphics->streamlines_path_cache)
+	{
+		delete graphics->streamlines_path_cache;
+		graphics->streamlines_path_cache = 0;
+	}
+}
+
+/**
+ * Put graphics object displayed while building a new level of detail into
+ * the level of detail cache for later reuse.
+ */
+static void cmzn_graphics_cache_level_of_detail_display_object(struct cmzn_graphics *graphics)
+{
+	if (graphics->level_of_detail_display_object)
+	{
+		if (!graphics->level_of_detail_cache)
+		{
+			graphics->level_of_detail_cache = (graphics->scene) ?
+				new GraphicsLevelOfDetailCache(
+					static_cast<size_t>(graphics->scene->getLevelOfDetailCacheBudget())*1024*1024,
+					graphics->scene->getLevelOfDetailCacheMaximumLevels()) :
+				new GraphicsLevelOfDetailCache(
+					static_cast<size_t>(GraphicsLevelOfDetailCache::defaultMemoryBudgetMegabytes)*1024*1024,
+					GraphicsLevelOfDetailCache::defaultMaximumEntries);
+		}
+		graphics->level_of_detail_cache->add(graphics->display_object_level_of_detail,
+			graphics->level_of_detail_display_object);
+		DEACCESS(GT_object)(&(graphics->level_of_detail_display_object));
+	}
+}
+
+/**
+ * Called when the tessellation divisions for graphics change. A complete
+ * graphics object continues to be displayed until graphics for the new level
+ * of detail are built, then it is put in the level of detail cache.
+ * An incomplete graphics object is discarded.
+ */
+static void cmzn_graphics_level_of_detail_changed(struct cmzn_graphics *graphics)
+{
+	if (graphics->graphics_object)
+	{
+		if (graphics->graphics_changed)
+		{
+			DEACCESS(GT_object)(&(graphics->graphics_object));
+		}
+		else
+		{
+			cmzn_graphics_cache_level_of_detail_display_object(graphics);
+			// transfer access
+			graphics->level_of_detail_display_object = graphics->graphics_object;
+			graphics->display_object_level_of_detail = graphics->graphics_object_level_of_detail;
+			graphics->graphics_object = 0;
+		}
+	}
+	graphics->graphics_changed = 1;
+}
+
 /***************************************************************************//**
  * Call whenever attributes of the graphics have changed to ensure the graphics
  * object is invalidated (if needed) or that the minimum rebuild and redraw is
@@ -103,19 +234,33 @@ static int cmzn_graphics_changed(struct cmzn_graphics *graphics,
 		case CMZN_GRAPHICS_CHANGE_PARTIAL_REBUILD:
 			// partial removal of graphics should have been done by caller
 			graphics->graphics_changed = 1;
+			cmzn_graphics_clear_level_of_detail(graphics);
+			cmzn_graphics_clear_streamlines_path_cache(graphics);
 			break;
 		case CMZN_GRAPHICS_CHANGE_FULL_REBUILD:
+			cmzn_graphics_clear_streamlines_path_cache(graphics);
+			// fall through
+		case CMZN_GRAPHICS_CHANGE_TIME:
 			graphics->graphics_changed = 1;
 			if (graphics->graphics_object)
 			{
 				DEACCESS(GT_object)(&(graphics->graphics_object));
 			}
+			cmzn_graphics_clear_level_of_detail(graphics);
+			cmzn::Deaccess(graphics->partialRebuildElements);
+			break;
+		case CMZN_GRAPHICS_CHANGE_LEVEL_OF_DETAIL:
+			cmzn_graphics_level_of_detail_changed(graphics);
+			cmzn_graphics_clear_streamlines_path_cache(graphics);
+			cmzn::Deaccess(graphics->partialRebuildElements);
 			break;
 		default:
 			return_code = 0;
 			break;
 		}
 		graphics->incrementalBuildIndex = DS_LABEL_INDEX_INVALID;
+		delete graphics->adaptive_surface_segments;
+		graphics->adaptive_surface_segments = 0;
 		if (return_code && (graphics->scene))
 			graphics->scene->setChanged();
 	}
@@ -259,8 +404,13 @@ struct cmzn_graphics *CREATE(cmzn_graphics)(
 			graphics->stream_vector_field=(struct Computed_field *)NULL;
 			graphics->streamlines_track_direction = CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_FORWARD;
 			graphics->streamline_length=1.0;
+			graphics->streamlines_tolerance = 1.0E-4;
+			graphics->streamlines_maximum_number_of_steps = 100000;
+			graphics->streamlines_trace_mode = CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE;
+			graphics->streamlines_path_time_step = 0.0;
 			graphics->seed_nodeset = (cmzn_nodeset_id)0;
 			graphics->seed_node_mesh_location_field = (struct Computed_field *)NULL;
+			graphics->surfaces_shared_vertices = false;
 			graphics->overlay_flag = 0;
 			graphics->overlay_order = 1;
 			graphics->coordinate_system = CMZN_SCENECOORDINATESYSTEM_LOCAL;
@@ -285,7 +435,20 @@ struct cmzn_graphics *CREATE(cmzn_graphics)(
 			/* rendering information defaults */
 			graphics->graphics_object = (struct GT_object *)NULL;
 			graphics->graphics_changed = 1;
+			for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+			{
+				graphics->graphics_object_level_of_detail.top_level_number_in_xi[i] = 0;
+				graphics->graphics_object_level_of_detail.top_level_minimum_number_in_xi[i] = 0;
+			}
+			graphics->graphics_object_level_of_detail.adaptive_tolerance = 0.0;
+			graphics->graphics_object_level_of_detail.circle_divisions = 0;
+			graphics->level_of_detail_display_object = (struct GT_object *)NULL;
+			graphics->display_object_level_of_detail = graphics->graphics_object_level_of_detail;
+			graphics->level_of_detail_cache = 0;
+			graphics->streamlines_path_cache = 0;
+			graphics->adaptive_surface_segments = 0;
 			graphics->incrementalBuildIndex = DS_LABEL_INDEX_INVALID;
+			graphics->partialRebuildElements = 0;
 			graphics->selected_graphics_changed = 0;
 			graphics->timeDependent = false;
 
@@ -327,6 +490,14 @@ int DESTROY(cmzn_graphics)(
 		{
 			DEACCESS(GT_object)(&(graphics->graphics_object));
 		}
+		if (graphics->level_of_detail_display_object)
+		{
+			DEACCESS(GT_object)(&(graphics->level_of_detail_display_object));
+		}
+		delete graphics->level_of_detail_cache;
+		delete graphics->streamlines_path_cache;
+		delete graphics->adaptive_surface_segments;
+		cmzn::Deaccess(graphics->partialRebuildElements);
 		if (graphics->coordinate_field)
 		{
 			DEACCESS(Computed_field)(&(graphics->coordinate_field));
@@ -497,6 +668,74 @@ int cmzn_element_conditional_field_is_true(cmzn_element_id element,
 }
 #endif // OLD_CODE
 
+/**
+ * Get the discretization of element for graphics, with numbers of segments
+ * reduced for adaptive tessellation of lines and surfaces, if on. Surfaces
+ * use numbers agreed with adjacent elements in adaptive_surface_segments.
+ * @param top_level_element  On return, the top level element used.
+ * @param number_in_xi  Array of size MAXIMUM_ELEMENT_XI_DIMENSIONS to receive
+ * numbers of segments in each xi direction.
+ * @param maximum_number_in_xi  Optional array of size
+ * MAXIMUM_ELEMENT_XI_DIMENSIONS to receive numbers of segments without
+ * adaptive tessellation.
+ * @return  1 on success, 0 on failure.
+ */
+static int cmzn_graphics_get_element_discretization(struct cmzn_graphics *graphics,
+	cmzn_graphics_to_graphics_object_data *graphics_to_object_data,
+	struct FE_element *element, struct FE_element **top_level_element,
+	int *number_in_xi, int *maximum_number_in_xi = 0)
+{
+	// copy top_level_number_in_xi since scaled by native_discretization in
+	// get_FE_element_discretization
+	int top_level_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
+	{
+		top_level_number_in_xi[dim] = graphics_to_object_data->top_level_number_in_xi[dim];
+	}
+	*top_level_element = (struct FE_element *)NULL;
+	struct FE_field *native_discretization_field = 0;
+	if (graphics->tessellation_field)
+	{
+		Computed_field_get_type_finite_element(graphics->tessellation_field, &native_discretization_field);
+	}
+	if (!get_FE_element_discretization(element,
+		graphics->face, native_discretization_field, top_level_number_in_xi,
+		top_level_element, number_in_xi))
+		return 0;
+	if (maximum_number_in_xi)
+	{
+		for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
+			maximum_number_in_xi[dim] = number_in_xi[dim];
+	}
+	if ((graphics->adaptive_surface_segments) &&
+		graphics->adaptive_surface_segments->getElementSegments(get_FE_element_index(element), number_in_xi))
+		return 1;
+	/* adaptive tessellation reduces divisions where lines and surfaces
+	 * are flatter, down to the minimum divisions */
+	if ((0.0 < graphics_to_object_data->adaptive_tolerance) &&
+		((CMZN_GRAPHICS_TYPE_LINES == graphics->graphics_type) ||
+		 (CMZN_GRAPHICS_TYPE_SURFACES == graphics->graphics_type)))
+	{
+		int minimum_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
+		{
+			top_level_number_in_xi[dim] = graphics_to_object_data->top_level_minimum_number_in_xi[dim];
+		}
+		struct FE_element *minimum_top_level_element = *top_level_element;
+		if (get_FE_element_discretization(element,
+			graphics->face, native_discretization_field, top_level_number_in_xi,
+			&minimum_top_level_element, minimum_number_in_xi))
+		{
+			FE_element_get_adaptive_discretization(element,
+				graphics_to_object_data->field_cache, graphics_to_object_data->master_mesh,
+				graphics_to_object_data->rc_coordinate_field, *top_level_element,
+				graphics_to_object_data->adaptive_tolerance, minimum_number_in_xi,
+				number_in_xi);
+		}
+	}
+	return 1;
+}
+
 /**
  * Converts a finite element into a graphics object with the supplied graphics.
  * @param element  The cmzn_element.
@@ -506,7 +745,6 @@ int cmzn_element_conditional_field_is_true(cmzn_element_id element,
 static int FE_element_to_graphics_object(struct FE_element *element,
 	cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
 {
-	FE_value initial_xi[3];
 	int i, number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS],
 		number_of_xi_points, return_code = 1;
 	struct Element_point_ranges_identifier element_point_ranges_identifier;
@@ -558,22 +796,8 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 				return 1;
 		}
 		/* determine discretization of element for graphics */
-		// copy top_level_number_in_xi since scaled by native_discretization in
-		// get_FE_element_discretization
-		int top_level_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
-		for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
-		{
-			top_level_number_in_xi[dim] = graphics_to_object_data->top_level_number_in_xi[dim];
-		}
-		top_level_element = (struct FE_element *)NULL;
-		struct FE_field *native_discretization_field = 0;
-		if (graphics->tessellation_field)
-		{
-			Computed_field_get_type_finite_element(graphics->tessellation_field, &native_discretization_field);
-		}
-		if (get_FE_element_discretization(element,
-			graphics->face, native_discretization_field, top_level_number_in_xi,
-			&top_level_element, number_in_xi))
+		if (cmzn_graphics_get_element_discretization(graphics, graphics_to_object_data,
+			element, &top_level_element, number_in_xi))
 		{
 			switch (graphics->graphics_type)
 			{
@@ -617,7 +841,8 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 						graphics->texture_coordinate_field,
 						graphics->data_field,
 						number_in_xi[0], number_in_xi[1],
-						/*reverse_normals*/0, top_level_element);
+						/*reverse_normals*/0, top_level_element,
+						graphics->surfaces_shared_vertices);
 				} break;
 				case CMZN_GRAPHICS_TYPE_CONTOURS:
 				{
@@ -731,12 +956,12 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 				} break;
 				case CMZN_GRAPHICS_TYPE_STREAMLINES:
 				{
-					/* use local copy of sample_location since tracking function updates it */
 					for (i = 0; i < 3; i++)
 					{
-						initial_xi[i] =  element_point_ranges_identifier.exact_xi[i] = graphics->sample_location[i];
+						element_point_ranges_identifier.exact_xi[i] = graphics->sample_location[i];
 					}
-					if (FE_element_get_xi_points(element,
+					if ((graphics_to_object_data->streamline_tracker) &&
+						FE_element_get_xi_points(element,
 						graphics->sampling_mode, number_in_xi,
 						element_point_ranges_identifier.exact_xi,
 						graphics_to_object_data->field_cache,
@@ -744,53 +969,14 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 						graphics->sample_density_field,
 						&number_of_xi_points, &xi_points))
 					{
-						switch (graphics->line_shape)
+						/* streamlines are tracked together once all seeds are added */
+						for (i = 0; i < number_of_xi_points; i++)
 						{
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_LINE:
+							if (CMZN_OK != graphics_to_object_data->streamline_tracker->addSeed(element, xi_points[i]))
 							{
-								for (i = 0; i < number_of_xi_points; i++)
-								{
-									initial_xi[0] = xi_points[i][0];
-									initial_xi[1] = xi_points[i][1];
-									initial_xi[2] = xi_points[i][2];
-									return_code = create_polyline_streamline_FE_element_vertex_array(
-										element, initial_xi, graphics_to_object_data->field_cache,
-										graphics_to_object_data->rc_coordinate_field,
-										graphics_to_object_data->wrapper_stream_vector_field,
-										static_cast<int>(graphics->streamlines_track_direction == CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE),
-										graphics->streamline_length,
-										graphics->streamlines_colour_data_type, graphics->data_field,
-										GT_object_get_vertex_set(graphics->graphics_object));
-								}
-							} break;
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
-							{
-								for (i = 0; i < number_of_xi_points; i++)
-								{
-									initial_xi[0] = xi_points[i][0];
-									initial_xi[1] = xi_points[i][1];
-									initial_xi[2] = xi_points[i][2];
-									return_code = create_surface_streamribbon_FE_element_vertex_array(
-										element, initial_xi, graphics_to_object_data->field_cache,
-										graphics_to_object_data->rc_coordinate_field,
-										graphics_to_object_data->wrapper_stream_vector_field,
-										static_cast<int>(graphics->streamlines_track_direction == CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE),
-										graphics->streamline_length,
-										graphics->line_shape, cmzn_tessellation_get_circle_divisions(graphics->tessellation),
-										graphics->line_base_size, graphics->line_scale_factors,
-										graphics->line_orientation_scale_field,
-										graphics->streamlines_colour_data_type, graphics->data_field,
-										GT_object_get_vertex_set(graphics->graphics_object));
-								}
-							} break;
-						case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_INVALID:
-							{
-								display_message(ERROR_MESSAGE,
-									"FE_element_to_graphics_object.  Unknown streamline type");
 								return_code = 0;
-							} break;
+								break;
+							}
 						}
 					}
 					else
@@ -827,11 +1013,11 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 } /* FE_element_to_graphics_object */
 
 /***************************************************************************//**
- * Creates a streamline seeded from the location given by the
+ * Adds a streamline seed at the location given by the
  * seed_node_mesh_location_field at the node.
  * @param node  The node to seed streamline from.
  * @param graphics_to_object_data  All other data including graphics.
- * @return  1 if successfully added streamline
+ * @return  1 if successfully added streamline seed or node has no location
  */
 static int cmzn_node_to_streamline(struct FE_node *node,
 	struct cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
@@ -842,7 +1028,7 @@ static int cmzn_node_to_streamline(struct FE_node *node,
 	struct cmzn_graphics *graphics = 0;
 	if (node && graphics_to_object_data &&
 		(NULL != (graphics = graphics_to_object_data->graphics)) &&
-		graphics->graphics_object)
+		graphics->graphics_object && graphics_to_object_data->streamline_tracker)
 	{
 		cmzn_fieldcache_set_node(graphics_to_object_data->field_cache, node);
 		FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
@@ -851,48 +1037,10 @@ static int cmzn_node_to_streamline(struct FE_node *node,
 			MAXIMUM_ELEMENT_XI_DIMENSIONS, xi);
 		if (element)
 		{
-			switch (graphics->line_shape)
-			{
-			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_LINE:
-				{
-					return_code = create_polyline_streamline_FE_element_vertex_array(element,
-							xi, graphics_to_object_data->field_cache,
-							graphics_to_object_data->rc_coordinate_field,
-							graphics_to_object_data->wrapper_stream_vector_field,
-							static_cast<int>(graphics->streamlines_track_direction == CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE),
-							graphics->streamline_length,
-							graphics->streamlines_colour_data_type, graphics->data_field,
-							GT_object_get_vertex_set(graphics->graphics_object));
-				} break;
-			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_RIBBON:
-			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION:
-			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_SQUARE_EXTRUSION:
-				{
-					return_code = create_surface_streamribbon_FE_element_vertex_array(element,
-						xi, graphics_to_object_data->field_cache,
-						graphics_to_object_data->rc_coordinate_field,
-						graphics_to_object_data->wrapper_stream_vector_field,
-						static_cast<int>(graphics->streamlines_track_direction == CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE),
-						graphics->streamline_length,
-						graphics->line_shape, cmzn_tessellation_get_circle_divisions(graphics->tessellation),
-						graphics->line_base_size, graphics->line_scale_factors,
-						graphics->line_orientation_scale_field,
-						graphics->streamlines_colour_data_type, graphics->data_field,
-						GT_object_get_vertex_set(graphics->graphics_object));
-				} break;
-			case CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_INVALID:
-				{
-					display_message(ERROR_MESSAGE,
-						"cmzn_node_to_streamline.  Unknown streamline type");
-					return_code=0;
-				} break;
-			}
+			if (CMZN_OK != graphics_to_object_data->streamline_tracker->addSeed(element, xi))
+				return_code = 0;
 			cmzn_element_destroy(&element);
 		}
-		else
-		{
-			return_code=1;
-		}
 	}
 	else
 	{
@@ -1402,6 +1550,11 @@ void cmzn_graphics_update_graphics_object_trivial_glyph(struct cmzn_graphics *gr
 int cmzn_graphics_update_graphics_object_trivial(struct cmzn_graphics *graphics)
 {
 	int return_code = 0;
+	if (graphics && graphics->level_of_detail_display_object)
+	{
+		// not worth updating; cached levels of detail are updated when reused
+		DEACCESS(GT_object)(&(graphics->level_of_detail_display_object));
+	}
 	if (graphics && graphics->graphics_object)
 	{
 		set_GT_object_default_material(graphics->graphics_object,
@@ -2001,6 +2154,16 @@ char *cmzn_graphics_string(struct cmzn_graphics *graphics,
 				ENUMERATOR_STRING(cmzn_graphics_streamlines_track_direction)(graphics->streamlines_track_direction), &error);
 			sprintf(temp_string," length %g ", graphics->streamline_length);
 			append_string(&graphics_string,temp_string,&error);
+			sprintf(temp_string, "tolerance %g maximum_steps %d ", graphics->streamlines_tolerance,
+				graphics->streamlines_maximum_number_of_steps);
+			append_string(&graphics_string, temp_string, &error);
+			if (CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE != graphics->streamlines_trace_mode)
+			{
+				append_string(&graphics_string, (CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE ==
+					graphics->streamlines_trace_mode) ? "pathline " : "streakline ", &error);
+				sprintf(temp_string, "path_time_step %g ", graphics->streamlines_path_time_step);
+				append_string(&graphics_string, temp_string, &error);
+			}
 			append_string(&graphics_string,
 				ENUMERATOR_STRING(cmzn_graphics_streamlines_colour_data_type)(graphics->streamlines_colour_data_type),&error);
 			if (graphics->seed_nodeset)
@@ -2028,6 +2191,11 @@ char *cmzn_graphics_string(struct cmzn_graphics *graphics,
 				}
 			}
 		}
+		if ((CMZN_GRAPHICS_TYPE_SURFACES == graphics->graphics_type) &&
+			(graphics->surfaces_shared_vertices))
+		{
+			append_string(&graphics_string, " shared_vertices", &error);
+		}
 		append_string(&graphics_string," ",&error);
 		append_string(&graphics_string,
 			ENUMERATOR_STRING(cmzn_graphics_select_mode)(graphics->select_mode),&error);
@@ -2641,8 +2809,77 @@ static char *cmzn_graphics_get_graphics_object_name(cmzn_graphics *graphics, con
 	return graphics_object_name;
 }
 
+/**
+ * Partial rebuild of graphics for only the changed elements in mesh.
+ * Supports incremental build.
+ */
+static int cmzn_mesh_partial_to_graphics(cmzn_mesh_id mesh,
+	cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
+{
+	FE_mesh *fe_mesh = cmzn_mesh_get_FE_mesh_internal(mesh);
+	if (!fe_mesh)
+		return 0;
+	int return_code = 1;
+	GraphicsIncrementalBuild *incrementalBuild = graphics_to_object_data->incrementalBuild;
+	cmzn_graphics *graphics = graphics_to_object_data->graphics;
+	DsLabelsGroup *changedElements = graphics->partialRebuildElements;
+	DsLabelIndex elementIndex = (incrementalBuild) ? graphics->incrementalBuildIndex : DS_LABEL_INDEX_INVALID;
+	while (changedElements->incrementIndex(elementIndex))
+	{
+		cmzn_element *element = fe_mesh->getElement(elementIndex);
+		if ((!element) || (!cmzn_mesh_contains_element(mesh, element)))
+			continue;
+		if (!FE_element_to_graphics_object(element, graphics_to_object_data))
+		{
+			return_code = 0;
+			break;
+		}
+		if ((incrementalBuild) && incrementalBuild->incrementDone())
+		{
+			graphics->incrementalBuildIndex = elementIndex;
+			if (changedElements->incrementIndex(elementIndex))
+				incrementalBuild->setMoreWorkToDo();
+			break;
+		}
+	}
+	if ((incrementalBuild) && !incrementalBuild->isMoreWorkToDo())
+		graphics->incrementalBuildIndex = DS_LABEL_INDEX_INVALID;
+	return return_code;
+}
+
+/**
+ * For surfaces with adaptive tessellation, get the numbers of segments needed
+ * in all elements of the master mesh and make them agree along shared lines.
+ * Graphics keeps these until its build is complete.
+ */
+static void cmzn_graphics_set_adaptive_surface_segments(struct cmzn_graphics *graphics,
+	cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
+{
+	FE_mesh *fe_mesh = cmzn_mesh_get_FE_mesh_internal(graphics_to_object_data->master_mesh);
+	if ((graphics->adaptive_surface_segments) ||
+		(CMZN_GRAPHICS_TYPE_SURFACES != graphics->graphics_type) ||
+		(!(0.0 < graphics_to_object_data->adaptive_tolerance)) ||
+		(!fe_mesh) || (2 != fe_mesh->getDimension()) || (!fe_mesh->getFaceMesh()))
+		return;
+	FE_mesh_adaptive_segments *adaptive_segments = new FE_mesh_adaptive_segments(fe_mesh);
+	int number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS], maximum_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	struct FE_element *top_level_element;
+	const DsLabelIndex elementsCount = fe_mesh->getLabelsIndexSize();
+	for (DsLabelIndex elementIndex = 0; elementIndex < elementsCount; ++elementIndex)
+	{
+		cmzn_element *element = fe_mesh->getElement(elementIndex);
+		if ((element) && cmzn_graphics_get_element_discretization(graphics, graphics_to_object_data,
+			element, &top_level_element, number_in_xi, maximum_number_in_xi))
+			adaptive_segments->addElement(elementIndex, number_in_xi, maximum_number_in_xi);
+	}
+	graphics->adaptive_surface_segments = adaptive_segments;
+}
+
 static int cmzn_mesh_to_graphics(cmzn_mesh_id mesh, cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
 {
+	if (graphics_to_object_data->graphics->partialRebuildElements)
+		return cmzn_mesh_partial_to_graphics(mesh, graphics_to_object_data);
+	cmzn_graphics_set_adaptive_surface_segments(graphics_to_object_data->graphics, graphics_to_object_data);
 	cmzn_elementiterator_id iterator = cmzn_mesh_create_elementiterator(mesh);
 	if (!iterator)
 		return 0;
@@ -2668,11 +2905,88 @@ static int cmzn_mesh_to_graphics(cmzn_mesh_id mesh, cmzn_graphics_to_graphics_ob
 		}
 	}
 	cmzn_elementiterator_destroy(&iterator);
-	if ((incrementalBuild) && !incrementalBuild->isMoreWorkToDo())
+	if (!((incrementalBuild) && incrementalBuild->isMoreWorkToDo()))
+	{
 		graphics->incrementalBuildIndex = DS_LABEL_INDEX_INVALID;
+		delete graphics->adaptive_surface_segments;
+		graphics->adaptive_surface_segments = 0;
+	}
 	return return_code;
 }
 
+/**
+ * Get the tessellation divisions graphics are built with.
+ */
+static void cmzn_graphics_get_level_of_detail(struct cmzn_graphics *graphics,
+	cmzn_graphics_level_of_detail *level_of_detail)
+{
+	cmzn_graphics_get_top_level_number_in_xi(graphics,
+		MAXIMUM_ELEMENT_XI_DIMENSIONS, level_of_detail->top_level_number_in_xi);
+	for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+		level_of_detail->top_level_minimum_number_in_xi[i] = 1;
+	level_of_detail->adaptive_tolerance = 0.0;
+	level_of_detail->circle_divisions = 0;
+	if (graphics->tessellation)
+	{
+		if ((CMZN_GRAPHICS_TYPE_LINES == graphics->graphics_type) ||
+			(CMZN_GRAPHICS_TYPE_SURFACES == graphics->graphics_type))
+		{
+			level_of_detail->adaptive_tolerance =
+				cmzn_tessellation_get_adaptive_tolerance(graphics->tessellation);
+			cmzn_tessellation_get_minimum_divisions(graphics->tessellation,
+				MAXIMUM_ELEMENT_XI_DIMENSIONS, level_of_detail->top_level_minimum_number_in_xi);
+		}
+		if ((CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION == graphics->line_shape) ||
+			((graphics->glyph) && (graphics->glyph->usesCircleDivisions())))
+			level_of_detail->circle_divisions = cmzn_tessellation_get_circle_divisions(graphics->tessellation);
+	}
+}
+
+/**
+ * If graphics must be built from scratch, reuse the displayed or a cached
+ * graphics object built previously for the current level of detail.
+ * @return  True if graphics object reused, false if it must be built.
+ */
+static bool cmzn_graphics_reuse_level_of_detail(struct cmzn_graphics *graphics,
+	cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
+{
+	if (graphics->graphics_object || !((graphics->level_of_detail_display_object) ||
+		((graphics->level_of_detail_cache) && (0 < graphics->level_of_detail_cache->getNumberOfEntries()))))
+		return false;
+	cmzn_graphics_level_of_detail level_of_detail;
+	cmzn_graphics_get_level_of_detail(graphics, &level_of_detail);
+	GT_object *graphics_object = 0;
+	if ((graphics->level_of_detail_display_object) &&
+		(graphics->display_object_level_of_detail == level_of_detail))
+	{
+		// transfer access
+		graphics_object = graphics->level_of_detail_display_object;
+		graphics->level_of_detail_display_object = 0;
+	}
+	else if (graphics->level_of_detail_cache)
+	{
+		graphics_object = graphics->level_of_detail_cache->extract(level_of_detail);
+		if (graphics_object)
+			cmzn_graphics_cache_level_of_detail_display_object(graphics);
+	}
+	if (!graphics_object)
+		return false;
+	graphics->graphics_object = graphics_object;
+	graphics->graphics_object_level_of_detail = level_of_detail;
+	char *graphics_object_name = cmzn_graphics_get_graphics_object_name(graphics, graphics_to_object_data->name_prefix);
+	if (graphics_object_name)
+	{
+		GT_object_set_name(graphics->graphics_object, graphics_object_name);
+		DEALLOCATE(graphics_object_name);
+	}
+	/* materials etc. may have changed since cached */
+	cmzn_graphics_update_graphics_object_trivial(graphics);
+	graphics->graphics_changed = 0;
+	graphics->incrementalBuildIndex = DS_LABEL_INDEX_INVALID;
+	graphics->selected_graphics_changed = 1;
+	return true;
+}
+
 int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *graphics,
 	cmzn_graphics_to_graphics_object_data *graphics_to_object_data)
 {
@@ -2681,6 +2995,8 @@ int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *gr
 	{
 		GraphicsIncrementalBuild *incrementalBuild = graphics_to_object_data->incrementalBuild;
 		bool buildNow = (0 != graphics->graphics_changed);
+		if (buildNow && cmzn_graphics_reuse_level_of_detail(graphics, graphics_to_object_data))
+			buildNow = false;
 		if (buildNow)
 			if (incrementalBuild)
 				if (incrementalBuild->incrementDone())
@@ -2753,8 +3069,17 @@ int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *gr
 						DEALLOCATE(graphics_string);
 					}
 #endif /* defined (DEBUG_CODE) */
-					cmzn_graphics_get_top_level_number_in_xi(graphics,
-						MAXIMUM_ELEMENT_XI_DIMENSIONS, graphics_to_object_data->top_level_number_in_xi);
+					cmzn_graphics_level_of_detail level_of_detail;
+					cmzn_graphics_get_level_of_detail(graphics, &level_of_detail);
+					for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+					{
+						graphics_to_object_data->top_level_number_in_xi[i] =
+							level_of_detail.top_level_number_in_xi[i];
+						graphics_to_object_data->top_level_minimum_number_in_xi[i] =
+							level_of_detail.top_level_minimum_number_in_xi[i];
+					}
+					graphics_to_object_data->adaptive_tolerance = level_of_detail.adaptive_tolerance;
+					graphics->graphics_object_level_of_detail = level_of_detail;
 					/* work out the name the graphics object is to have */
 					char *graphics_object_name = cmzn_graphics_get_graphics_object_name(graphics, graphics_to_object_data->name_prefix);
 					if (graphics_object_name)
@@ -3100,6 +3425,14 @@ int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *gr
 							}
 							else
 								GT_object_reset_buffer_binding(graphics->graphics_object);
+							StreamlineTracker streamlineTracker(graphics_to_object_data->field_module,
+								graphics_to_object_data->time, graphics_to_object_data->rc_coordinate_field,
+								graphics_to_object_data->wrapper_stream_vector_field,
+								static_cast<int>(graphics->streamlines_track_direction == CMZN_GRAPHICS_STREAMLINES_TRACK_DIRECTION_REVERSE),
+								graphics->streamline_length, graphics->streamlines_tolerance,
+								graphics->streamlines_maximum_number_of_steps,
+								graphics->streamlines_colour_data_type, graphics->data_field);
+							graphics_to_object_data->streamline_tracker = &streamlineTracker;
 							if (graphics->seed_element)
 							{
 								return_code = FE_element_to_graphics_object(
@@ -3127,6 +3460,43 @@ int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *gr
 									return_code = cmzn_mesh_to_graphics(graphics_to_object_data->iteration_mesh, graphics_to_object_data);
 								}
 							}
+							graphics_to_object_data->streamline_tracker = 0;
+							if (return_code && (CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE != graphics->streamlines_trace_mode))
+							{
+								// particles are traced from the timekeeper minimum time; paths
+								// are kept between builds so only new time needs tracing
+								cmzn_timekeeper *timekeeper = (graphics->scene) ? graphics->scene->getTimekeeper() : 0;
+								const FE_value startTime = (timekeeper) ? timekeeper->getMinimum() : 0.0;
+								FE_value timeStep = graphics->streamlines_path_time_step;
+								if (timeStep <= 0.0)
+								{
+									timeStep = (timekeeper) ? 0.01*(timekeeper->getMaximum() - startTime) : 0.0;
+									if (timeStep <= 0.0)
+										timeStep = 0.01;
+								}
+								if (!graphics->streamlines_path_cache)
+									graphics->streamlines_path_cache = new StreamlinePathCache();
+								return_code = streamlineTracker.trackPaths(*(graphics->streamlines_path_cache),
+									(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE == graphics->streamlines_trace_mode) ?
+										StreamlinePathCache::MODE_PATHLINES : StreamlinePathCache::MODE_STREAKLINES,
+									startTime, timeStep, graphics_to_object_data->time);
+								if (return_code)
+									return_code = graphics->streamlines_path_cache->addPolylines(
+										GT_object_get_vertex_set(graphics->graphics_object), graphics_to_object_data->time);
+							}
+							else if (return_code)
+								return_code = streamlineTracker.track();
+							if (return_code && (CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE == graphics->streamlines_trace_mode))
+							{
+								Graphics_vertex_array *vertex_array = GT_object_get_vertex_set(graphics->graphics_object);
+								if (CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_LINE == graphics->line_shape)
+									return_code = streamlineTracker.addPolylines(vertex_array);
+								else
+									return_code = streamlineTracker.addSurfaces(vertex_array,
+										graphics->line_shape, cmzn_tessellation_get_circle_divisions(graphics->tessellation),
+										graphics->line_base_size, graphics->line_scale_factors,
+										graphics->line_orientation_scale_field);
+							}
 						} break;
 						default:
 						{
@@ -3145,7 +3515,12 @@ int cmzn_graphics_to_graphics_object_no_check_on_filter(struct cmzn_graphics *gr
 								set_GT_object_Spectrum(graphics->graphics_object, graphics->spectrum);
 							}
 							if (!((incrementalBuild) && incrementalBuild->isMoreWorkToDo()))
+							{
 								graphics->graphics_changed = 0;
+								cmzn::Deaccess(graphics->partialRebuildElements);
+								// new level of detail complete: keep previous for reuse
+								cmzn_graphics_cache_level_of_detail_display_object(graphics);
+							}
 							/* mark display list as needing updating */
 							GT_object_changed(graphics->graphics_object);
 						}
@@ -3410,6 +3785,34 @@ cmzn_field_change_flags cmzn_graphics_get_most_significant_field_change(
 
 } // namespace anonymous
 
+/**
+ * Record changed elements so partial rebuild of graphics only visits them.
+ * Not recorded if graphics object is still being built for all elements.
+ * @param elementChangeLog  Element changes for domain dimension, not all change.
+ * @return  True on success, false if failed.
+ */
+static bool cmzn_graphics_add_partial_rebuild_elements(struct cmzn_graphics *graphics,
+	DsLabelsChangeLog *elementChangeLog)
+{
+	if (!graphics->partialRebuildElements)
+	{
+		if (graphics->graphics_changed)
+			return true; // still building all elements
+		graphics->partialRebuildElements = DsLabelsGroup::create(elementChangeLog->getLabels());
+		if (!graphics->partialRebuildElements)
+			return false;
+	}
+	DsLabelsGroup *changedElements = elementChangeLog->getLabelsGroup();
+	DsLabelIndex elementIndex = DS_LABEL_INDEX_INVALID;
+	while (changedElements->incrementIndex(elementIndex))
+	{
+		const int result = graphics->partialRebuildElements->setIndex(elementIndex, true);
+		if ((CMZN_OK != result) && (CMZN_ERROR_ALREADY_EXISTS != result))
+			return false;
+	}
+	return true;
+}
+
 int cmzn_graphics_field_change(struct cmzn_graphics *graphics,
 	void *change_data_void)
 {
@@ -3473,15 +3876,28 @@ int cmzn_graphics_field_change(struct cmzn_graphics *graphics,
 			}
 			if (partialUpdate)
 			{
+				// shared surface vertices are owned by whichever element was built first
+				// so can't be replaced per element. Adaptive tessellation can change
+				// numbers of vertices in changed elements and their neighbours.
 				if (graphics->graphics_type == CMZN_GRAPHICS_TYPE_STREAMLINES ||
-					graphics->graphics_type == CMZN_GRAPHICS_TYPE_POINTS)
+					graphics->graphics_type == CMZN_GRAPHICS_TYPE_POINTS ||
+					((graphics->graphics_type == CMZN_GRAPHICS_TYPE_SURFACES) &&
+						graphics->surfaces_shared_vertices) ||
+					(((graphics->graphics_type == CMZN_GRAPHICS_TYPE_LINES) ||
+						(graphics->graphics_type == CMZN_GRAPHICS_TYPE_SURFACES)) &&
+						(graphics->tessellation) &&
+						(0.0 < cmzn_tessellation_get_adaptive_tolerance(graphics->tessellation))))
 				{
 					cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
 					return 1;
 				}
 				feRegionChanges->propagateToDimension(domainDimension);
-				if (elementChangeLog->isAllChange() || (elementChangeLog->getChangeCount()*2 >
-					FE_region_find_FE_mesh_by_dimension(graphics->scene->region->get_FE_region(), domainDimension)->getSize()))
+				const int meshSize = FE_region_find_FE_mesh_by_dimension(
+					graphics->scene->region->get_FE_region(), domainDimension)->getSize();
+				if (elementChangeLog->isAllChange() || (elementChangeLog->getChangeCount()*2 > meshSize) ||
+					(!cmzn_graphics_add_partial_rebuild_elements(graphics, elementChangeLog)) ||
+					((graphics->partialRebuildElements) &&
+						(graphics->partialRebuildElements->getSize()*2 > meshSize)))
 				{
 					// too many changes for partial rebuild
 					cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
@@ -3539,7 +3955,9 @@ struct GT_object *cmzn_graphics_get_graphics_object(
 	ENTER(cmzn_graphics_get_graphics_object);
 	if (graphics)
 	{
-		graphics_object=graphics->graphics_object;
+		// show previous level of detail until new one is completely built
+		graphics_object = (graphics->level_of_detail_display_object) ?
+			graphics->level_of_detail_display_object : graphics->graphics_object;
 	}
 	else
 	{
@@ -3640,6 +4058,7 @@ int cmzn_graphics_copy_without_graphics_object(
 		/* for 1-D and 2-D elements only */
 		destination->exterior=source->exterior;
 		destination->face=source->face;
+		destination->surfaces_shared_vertices = source->surfaces_shared_vertices;
 		/* overlay_flag */
 		destination->overlay_flag = source->overlay_flag;
 		destination->overlay_order = source->overlay_order;
@@ -3756,6 +4175,10 @@ int cmzn_graphics_copy_without_graphics_object(
 			source->stream_vector_field);
 		destination->streamlines_track_direction = source->streamlines_track_direction;
 		destination->streamline_length=source->streamline_length;
+		destination->streamlines_tolerance = source->streamlines_tolerance;
+		destination->streamlines_maximum_number_of_steps = source->streamlines_maximum_number_of_steps;
+		destination->streamlines_trace_mode = source->streamlines_trace_mode;
+		destination->streamlines_path_time_step = source->streamlines_path_time_step;
 		if (destination->seed_nodeset)
 		{
 			cmzn_nodeset_destroy(&destination->seed_nodeset);
@@ -3787,6 +4210,8 @@ int cmzn_graphics_copy_without_graphics_object(
 		/* ensure destination graphics object is cleared */
 		REACCESS(GT_object)(&(destination->graphics_object),
 			(struct GT_object *)NULL);
+		cmzn_graphics_clear_level_of_detail(destination);
+		cmzn::Deaccess(destination->partialRebuildElements);
 		destination->graphics_changed = 1;
 		destination->selected_graphics_changed = 1;
 
@@ -3886,6 +4311,12 @@ int cmzn_graphics_same_non_trivial(cmzn_graphics *graphics,
 			}
 		}
 
+		if (return_code && (CMZN_GRAPHICS_TYPE_SURFACES == graphics->graphics_type))
+		{
+			return_code = (graphics->surfaces_shared_vertices ==
+				second_graphics->surfaces_shared_vertices);
+		}
+
 		/* line attributes */
 		if (return_code && (
 			(CMZN_GRAPHICS_TYPE_LINES==graphics->graphics_type) ||
@@ -3999,6 +4430,10 @@ int cmzn_graphics_same_non_trivial(cmzn_graphics *graphics,
 				(graphics->stream_vector_field==second_graphics->stream_vector_field)&&
 				(graphics->streamlines_track_direction == second_graphics->streamlines_track_direction) &&
 				(graphics->streamline_length==second_graphics->streamline_length)&&
+				(graphics->streamlines_tolerance == second_graphics->streamlines_tolerance) &&
+				(graphics->streamlines_maximum_number_of_steps == second_graphics->streamlines_maximum_number_of_steps) &&
+				(graphics->streamlines_trace_mode == second_graphics->streamlines_trace_mode) &&
+				(graphics->streamlines_path_time_step == second_graphics->streamlines_path_time_step) &&
 				(((graphics->seed_nodeset==0) && (second_graphics->seed_nodeset==0)) ||
 					((graphics->seed_nodeset) && (second_graphics->seed_nodeset) &&
 						cmzn_nodeset_match(graphics->seed_nodeset, second_graphics->seed_nodeset)))&&
@@ -4289,14 +4724,19 @@ int cmzn_graphics_extract_graphics_object_from_list(
 				/* make sure graphics_changed and selected_graphics_changed flags
 					 are brought across */
 				graphics->graphics_object = matching_graphics->graphics_object;
+				graphics->graphics_object_level_of_detail =
+					matching_graphics->graphics_object_level_of_detail;
 				/* make sure graphics and graphics object have same material and
 					 spectrum */
 				cmzn_graphics_update_graphics_object_trivial(graphics);
 				graphics->graphics_changed = matching_graphics->graphics_changed;
 				graphics->selected_graphics_changed =
 					matching_graphics->selected_graphics_changed;
+				cmzn::Deaccess(graphics->partialRebuildElements);
+				graphics->partialRebuildElements = matching_graphics->partialRebuildElements;
 				/* reset graphics_object and flags in matching_graphics */
 				matching_graphics->graphics_object = (struct GT_object *)NULL;
+				matching_graphics->partialRebuildElements = 0;
 				//cmzn_graphics_changed(matching_graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
 			}
 		}
@@ -4387,7 +4827,7 @@ int cmzn_graphics_set_tessellation(
 		if (tessellation != graphics->tessellation)
 		{
 			REACCESS(cmzn_tessellation)(&(graphics->tessellation), tessellation);
-			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_LEVEL_OF_DETAIL);
 		}
 		return CMZN_OK;
 	}
@@ -4601,7 +5041,7 @@ int cmzn_graphics_time_change(
 		}
 		if (graphics->timeDependent)
 		{
-			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_TIME);
 		}
 	}
 	else
@@ -4637,6 +5077,9 @@ void cmzn_graphics::updateTimeDependence()
 		this->timeDependent = true;
 	else if ((this->stream_vector_field) && Computed_field_has_multiple_times(this->stream_vector_field))
 		this->timeDependent = true;
+	else if ((CMZN_GRAPHICS_TYPE_STREAMLINES == this->graphics_type) &&
+			(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE != this->streamlines_trace_mode))
+		this->timeDependent = true;  // particles move with time
 	else if (this->dataFieldIsTimeDependent())
 		this->timeDependent = true;
 	else
@@ -4803,13 +5246,13 @@ int cmzn_graphics_tessellation_change(struct cmzn_graphics *graphics,
 				if (change_detail->isElementDivisionsChanged() &&
 					(0 < cmzn_graphics_get_domain_dimension(graphics)))
 				{
-					cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+					cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_LEVEL_OF_DETAIL);
 				}
 				else if (change_detail->isCircleDivisionsChanged())
 				{
 					if (CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_CIRCLE_EXTRUSION == graphics->line_shape)
 					{
-						cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+						cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_LEVEL_OF_DETAIL);
 					}
 					else if (graphics->glyph && graphics->glyph->usesCircleDivisions())
 					{
@@ -5038,6 +5481,16 @@ int cmzn_graphics_set_scene_for_list_private(struct cmzn_graphics *graphics, voi
 	return 0;
 }
 
+int cmzn_graphics_update_level_of_detail_cache_limits(struct cmzn_graphics *graphics,
+	void *)
+{
+	if ((graphics) && (graphics->scene) && (graphics->level_of_detail_cache))
+		graphics->level_of_detail_cache->setLimits(
+			static_cast<size_t>(graphics->scene->getLevelOfDetailCacheBudget())*1024*1024,
+			graphics->scene->getLevelOfDetailCacheMaximumLevels());
+	return 1;
+}
+
 cmzn_graphics_id cmzn_graphics_access(cmzn_graphics_id graphics)
 {
 	if (graphics)
@@ -5244,6 +5697,44 @@ char *cmzn_graphics_streamlines_track_direction_enum_to_string(
 	return (string ? duplicate_string(string) : 0);
 }
 
+class cmzn_graphics_streamlines_trace_mode_conversion
+{
+public:
+	static const char *to_string(enum cmzn_graphics_streamlines_trace_mode mode)
+	{
+		const char *enum_string = 0;
+		switch (mode)
+		{
+		case CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE:
+			enum_string = "STREAMLINE";
+			break;
+		case CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE:
+			enum_string = "PATHLINE";
+			break;
+		case CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE:
+			enum_string = "STREAKLINE";
+			break;
+		default:
+			break;
+		}
+		return enum_string;
+	}
+};
+
+enum cmzn_graphics_streamlines_trace_mode cmzn_graphics_streamlines_trace_mode_enum_from_string(
+	const char *string)
+{
+	return string_to_enum<enum cmzn_graphics_streamlines_trace_mode,
+		cmzn_graphics_streamlines_trace_mode_conversion>(string);
+}
+
+char *cmzn_graphics_streamlines_trace_mode_enum_to_string(
+	enum cmzn_graphics_streamlines_trace_mode mode)
+{
+	const char *string = cmzn_graphics_streamlines_trace_mode_conversion::to_string(mode);
+	return (string ? duplicate_string(string) : 0);
+}
+
 class cmzn_graphics_streamlines_colour_data_type_conversion
 {
 public:
@@ -5699,6 +6190,107 @@ int cmzn_graphics_streamlines_set_track_length(
 	return CMZN_ERROR_ARGUMENT;
 }
 
+double cmzn_graphics_streamlines_get_tolerance(
+	cmzn_graphics_streamlines_id streamlines)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics)
+		return graphics->streamlines_tolerance;
+	return 0.0;
+}
+
+int cmzn_graphics_streamlines_set_tolerance(
+	cmzn_graphics_streamlines_id streamlines, double tolerance)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics && (tolerance > 0.0))
+	{
+		if (tolerance != graphics->streamlines_tolerance)
+		{
+			graphics->streamlines_tolerance = tolerance;
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+		}
+		return CMZN_OK;
+	}
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_graphics_streamlines_get_maximum_number_of_steps(
+	cmzn_graphics_streamlines_id streamlines)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics)
+		return graphics->streamlines_maximum_number_of_steps;
+	return 0;
+}
+
+int cmzn_graphics_streamlines_set_maximum_number_of_steps(
+	cmzn_graphics_streamlines_id streamlines, int maximum_number_of_steps)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics && (maximum_number_of_steps > 0))
+	{
+		if (maximum_number_of_steps != graphics->streamlines_maximum_number_of_steps)
+		{
+			graphics->streamlines_maximum_number_of_steps = maximum_number_of_steps;
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+		}
+		return CMZN_OK;
+	}
+	return CMZN_ERROR_ARGUMENT;
+}
+
+enum cmzn_graphics_streamlines_trace_mode cmzn_graphics_streamlines_get_trace_mode(
+	cmzn_graphics_streamlines_id streamlines)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics)
+		return graphics->streamlines_trace_mode;
+	return CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_INVALID;
+}
+
+int cmzn_graphics_streamlines_set_trace_mode(
+	cmzn_graphics_streamlines_id streamlines,
+	enum cmzn_graphics_streamlines_trace_mode trace_mode)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics && (0 != cmzn_graphics_streamlines_trace_mode_conversion::to_string(trace_mode)))
+	{
+		if (trace_mode != graphics->streamlines_trace_mode)
+		{
+			graphics->streamlines_trace_mode = trace_mode;
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+		}
+		return CMZN_OK;
+	}
+	return CMZN_ERROR_ARGUMENT;
+}
+
+double cmzn_graphics_streamlines_get_path_time_step(
+	cmzn_graphics_streamlines_id streamlines)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics)
+		return graphics->streamlines_path_time_step;
+	return 0.0;
+}
+
+int cmzn_graphics_streamlines_set_path_time_step(
+	cmzn_graphics_streamlines_id streamlines, double time_step)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(streamlines);
+	if (graphics && (time_step >= 0.0))
+	{
+		if (time_step != graphics->streamlines_path_time_step)
+		{
+			graphics->streamlines_path_time_step = time_step;
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+		}
+		return CMZN_OK;
+	}
+	return CMZN_ERROR_ARGUMENT;
+}
+
 cmzn_graphics_surfaces_id cmzn_graphics_cast_surfaces(cmzn_graphics_id graphics)
 {
 	if (graphics && (graphics->graphics_type == CMZN_GRAPHICS_TYPE_SURFACES))
@@ -5714,6 +6306,31 @@ int cmzn_graphics_surfaces_destroy(cmzn_graphics_surfaces_id *surfaces_address)
 	return cmzn_graphics_destroy(reinterpret_cast<cmzn_graphics_id *>(surfaces_address));
 }
 
+bool cmzn_graphics_surfaces_is_shared_vertices(
+	cmzn_graphics_surfaces_id surfaces)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(surfaces);
+	if (graphics)
+		return graphics->surfaces_shared_vertices;
+	return false;
+}
+
+int cmzn_graphics_surfaces_set_shared_vertices(
+	cmzn_graphics_surfaces_id surfaces, bool shared_vertices)
+{
+	cmzn_graphics *graphics = reinterpret_cast<cmzn_graphics *>(surfaces);
+	if (graphics)
+	{
+		if (shared_vertices != graphics->surfaces_shared_vertices)
+		{
+			graphics->surfaces_shared_vertices = shared_vertices;
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+		}
+		return CMZN_OK;
+	}
+	return CMZN_ERROR_ARGUMENT;
+}
+
 cmzn_graphicslineattributes_id cmzn_graphics_get_graphicslineattributes(
 	cmzn_graphics_id graphics)
 {
@@ -6518,7 +7135,7 @@ int cmzn_graphics_flag_for_full_rebuild(
 		return_code = 1;
 		if (graphics->timeDependent)
 		{
-			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_FULL_REBUILD);
+			cmzn_graphics_changed(graphics, CMZN_GRAPHICS_CHANGE_TIME);
 		}
 	}
 	else
@@ -6577,7 +7194,8 @@ enum GT_object_type cmzn_graphics_get_graphics_object_type(struct cmzn_graphics
 		} break;
 		case CMZN_GRAPHICS_TYPE_STREAMLINES:
 		{
-			if (CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_LINE == graphics->line_shape)
+			if ((CMZN_GRAPHICSLINEATTRIBUTES_SHAPE_TYPE_LINE == graphics->line_shape) ||
+				(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE != graphics->streamlines_trace_mode))
 			{
 				return g_POLYLINE_VERTEX_BUFFERS;
 			}
@@ -6638,7 +7256,10 @@ struct GT_object *cmzn_graphics_copy_graphics_object(struct cmzn_graphics *graph
 				for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
 				{
 					graphics_to_object_data.top_level_number_in_xi[i] = 0;
+					graphics_to_object_data.top_level_minimum_number_in_xi[i] = 0;
 				}
+				graphics_to_object_data.adaptive_tolerance = 0.0;
+				graphics_to_object_data.streamline_tracker = 0;
 
 				cmzn_graphics_to_graphics_object_no_check_on_filter(copy_graphics,
 					&graphics_to_object_data);
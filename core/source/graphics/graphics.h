@@ -11,6 +11,7 @@
 #define CMZN_GRAPHICS_H
 
 #include <ctime>
+#include <list>
 #include "opencmiss/zinc/fieldgroup.h"
 #include "opencmiss/zinc/graphics.h"
 #include "opencmiss/zinc/types/scenefilterid.h"
@@ -29,6 +30,33 @@
 
 struct cmzn_graphicspointattributes;
 struct cmzn_graphicslineattributes;
+class DsLabelsGroup;
+class GraphicsLevelOfDetailCache;
+class StreamlinePathCache;
+
+/**
+ * Tessellation divisions a graphics object is built with, identifying its
+ * level of detail.
+ */
+struct cmzn_graphics_level_of_detail
+{
+	int top_level_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	int top_level_minimum_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	FE_value adaptive_tolerance;
+	int circle_divisions;
+
+	bool operator==(const cmzn_graphics_level_of_detail& other) const
+	{
+		for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
+		{
+			if ((this->top_level_number_in_xi[i] != other.top_level_number_in_xi[i]) ||
+				(this->top_level_minimum_number_in_xi[i] != other.top_level_minimum_number_in_xi[i]))
+				return false;
+		}
+		return (this->adaptive_tolerance == other.adaptive_tolerance) &&
+			(this->circle_divisions == other.circle_divisions);
+	}
+};
 
 struct cmzn_graphics
 /*******************************************************************************
@@ -110,11 +138,20 @@ finite element group scene.
 	struct Computed_field *stream_vector_field;
 	enum cmzn_graphics_streamlines_track_direction streamlines_track_direction;
 	FE_value streamline_length;
+	/* relative error tolerance per integration step and limit on steps */
+	FE_value streamlines_tolerance;
+	int streamlines_maximum_number_of_steps;
+	enum cmzn_graphics_streamlines_trace_mode streamlines_trace_mode;
+	/* interval between pathline and streakline samples, 0 for automatic */
+	FE_value streamlines_path_time_step;
 	enum cmzn_graphics_streamlines_colour_data_type streamlines_colour_data_type;
 	/* streamline seed nodeset and field giving mesh location */
 	cmzn_nodeset_id seed_nodeset;
 	struct Computed_field *seed_node_mesh_location_field;
 
+	/* surfaces: share vertices on common edges of adjacent elements */
+	bool surfaces_shared_vertices;
+
 	/* appearance settings */
 	/* for all graphics types */
 	bool visibility_flag;
@@ -137,8 +174,25 @@ finite element group scene.
 	struct GT_object *graphics_object;
 	/* flag indicating the graphics_object needs rebuilding */
 	int graphics_changed;
+	/* tessellation divisions graphics_object is built with */
+	struct cmzn_graphics_level_of_detail graphics_object_level_of_detail;
+	/* complete graphics object for the previous level of detail, displayed
+	 * while graphics_object is built incrementally for new divisions */
+	struct GT_object *level_of_detail_display_object;
+	struct cmzn_graphics_level_of_detail display_object_level_of_detail;
+	/* graphics objects built for other levels of detail; created on demand */
+	GraphicsLevelOfDetailCache *level_of_detail_cache;
+	/* particle paths for pathlines and streaklines kept while only time
+	 * changes; created on demand */
+	StreamlinePathCache *streamlines_path_cache;
+	/* surfaces with adaptive tessellation: numbers of segments agreed between
+	 * adjacent elements, kept from start to end of an incremental build */
+	FE_mesh_adaptive_segments *adaptive_surface_segments;
 	/* for incremental build: last completed element index to start after (or before first if INVALID) */
 	DsLabelIndex incrementalBuildIndex;
+	/* elements to rebuild in partial rebuild of complete graphics_object,
+	 * or 0 if building for all elements; accessed */
+	DsLabelsGroup *partialRebuildElements;
 	/* flag indicating that selected graphics have changed */
 	int selected_graphics_changed;
 	/* flag indicating that this settings needs to be regenerated when time changes */
@@ -290,6 +344,89 @@ public:
 	}
 };
 
+/**
+ * Small cache of complete graphics objects previously built for a graphics at
+ * other levels of detail i.e. tessellation divisions, so switching back to
+ * them e.g. during interactive zoom reuses their buffers instead of rebuilding.
+ * Least recently used objects are evicted to keep within the memory budget and
+ * maximum number of levels, which are settings of the owning scene.
+ * Owner must clear the cache whenever the graphics changes in any other way.
+ */
+class GraphicsLevelOfDetailCache
+{
+	struct Entry
+	{
+		cmzn_graphics_level_of_detail levelOfDetail;
+		GT_object *graphicsObject; // accessed
+		size_t memorySize;
+	};
+
+	std::list<Entry> entries; // most recently used first
+	size_t memoryBudget;
+	size_t maximumEntries;
+	size_t memorySize;
+
+	void evict();
+
+public:
+
+	/** Default limit on memory used by cached graphics objects, in megabytes.
+	 * @see cmzn_scene_set_level_of_detail_cache_budget */
+	static const int defaultMemoryBudgetMegabytes = 64;
+	/** Default maximum number of levels of detail cached.
+	 * @see cmzn_scene_set_level_of_detail_cache_maximum_levels */
+	static const int defaultMaximumEntries = 4;
+
+	GraphicsLevelOfDetailCache(size_t memoryBudgetIn, size_t maximumEntriesIn) :
+		memoryBudget(memoryBudgetIn),
+		maximumEntries(maximumEntriesIn),
+		memorySize(0)
+	{
+	}
+
+	~GraphicsLevelOfDetailCache()
+	{
+		this->clear();
+	}
+
+	/** Release all cached graphics objects. */
+	void clear();
+
+	/**
+	 * Add graphics object for level of detail, replacing any existing entry,
+	 * then evict least recently used entries if over budget.
+	 * @param graphicsObject  Complete graphics object. Cache takes an access.
+	 */
+	void add(const cmzn_graphics_level_of_detail& levelOfDetail, GT_object *graphicsObject);
+
+	/**
+	 * Remove and return graphics object for level of detail if cached.
+	 * @return  Accessed graphics object which caller takes ownership of,
+	 * or 0 if none.
+	 */
+	GT_object *extract(const cmzn_graphics_level_of_detail& levelOfDetail);
+
+	/** Change limits, evicting least recently used entries to meet them. */
+	void setLimits(size_t memoryBudgetIn, size_t maximumEntriesIn)
+	{
+		this->memoryBudget = memoryBudgetIn;
+		this->maximumEntries = maximumEntriesIn;
+		this->evict();
+	}
+
+	size_t getMemorySize() const
+	{
+		return this->memorySize;
+	}
+
+	size_t getNumberOfEntries() const
+	{
+		return this->entries.size();
+	}
+};
+
+class StreamlineTracker;
+
 struct cmzn_graphics_to_graphics_object_data
 {
 	cmzn_fieldcache_id field_cache;
@@ -322,6 +459,11 @@ struct cmzn_graphics_to_graphics_object_data
 	/* additional values for passing to element_to_graphics_object */
 	struct cmzn_graphics *graphics;
 	int top_level_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	/* adaptive tessellation tolerance for lines and surfaces, 0 if off */
+	FE_value adaptive_tolerance;
+	int top_level_minimum_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	/* streamlines: collects seed points to track together */
+	StreamlineTracker *streamline_tracker;
 };
 
 struct cmzn_graphics_field_change_data
@@ -673,6 +815,16 @@ int cmzn_graphics_set_scene_private(struct cmzn_graphics *graphics,
 int cmzn_graphics_selected_element_points_change(
 	struct cmzn_graphics *graphics,void *dummy_void);
 
+/**
+ * Apply the level of detail cache limits of the graphics' scene to any level
+ * of detail cache it has, evicting cached graphics objects to meet them.
+ * Suitable for passing to FOR_EACH_OBJECT_IN_LIST.
+ * @param dummy_void  Unused.
+ * @return  1.
+ */
+int cmzn_graphics_update_level_of_detail_cache_limits(
+	struct cmzn_graphics *graphics, void *dummy_void);
+
 /***************************************************************************//**
  * A function to call set_scene_private but with a void pointer to the
  * scene passing into the function for list macro.
@@ -715,6 +867,12 @@ enum cmzn_graphics_streamlines_track_direction cmzn_graphics_streamlines_track_d
 char *cmzn_graphics_streamlines_track_direction_enum_to_string(
 	enum cmzn_graphics_streamlines_track_direction direction);
 
+enum cmzn_graphics_streamlines_trace_mode cmzn_graphics_streamlines_trace_mode_enum_from_string(
+	const char *string);
+
+char *cmzn_graphics_streamlines_trace_mode_enum_to_string(
+	enum cmzn_graphics_streamlines_trace_mode mode);
+
 enum cmzn_graphics_streamlines_colour_data_type cmzn_graphics_streamlines_colour_data_type_enum_from_string(
 	const char *string);
 
@@ -342,21 +342,52 @@ static int GT_object_mark_vertex_array_primitives_changes(struct GT_object *obje
 				{
 					int object_name = 0;
 					int modified_required = 1;
-					for (unsigned int i = 0; i < vertex_count; i++)
+					int invalid_id = -1;
+					if ((!changeLog->isAllChange()) &&
+						(static_cast<unsigned int>(changeLog->getChangeCount()) < vertex_count))
 					{
-						object_name = value_buffer[i];
-						if (changeLog->isIndexChange(object_name))
+						/* few changes: look up locations of changed objects only */
+						DsLabelsGroup *changedGroup = changeLog->getLabelsGroup();
+						DsLabelIndex index = DS_LABEL_INDEX_INVALID;
+						while (changedGroup->incrementIndex(index))
 						{
-							object->vertex_array->replace_integer_vertex_buffer_at_position(
-								GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED, i, 1, 1,
-								&modified_required);
-							int invalid_id = -1;
-							/* setting object id here to -1, marking it as invalid, removed object
-								* will not be drawn and modified object will be modified and given
-								* correctly during object compilation.*/
-							object->vertex_array->replace_integer_vertex_buffer_at_position(
-								GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_OBJECT_ID, i, 1, 1,
-								&invalid_id);
+							int number_of_locations = 0;
+							int *locations = 0;
+							object->vertex_array->get_all_fast_search_id_locations(index,
+								&number_of_locations, &locations);
+							for (int j = 0; j < number_of_locations; ++j)
+							{
+								const unsigned int i = static_cast<unsigned int>(locations[j]);
+								if ((i < vertex_count) && (value_buffer[i] == index))
+								{
+									object->vertex_array->replace_integer_vertex_buffer_at_position(
+										GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED, i, 1, 1,
+										&modified_required);
+									object->vertex_array->replace_integer_vertex_buffer_at_position(
+										GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_OBJECT_ID, i, 1, 1,
+										&invalid_id);
+								}
+							}
+							delete[] locations;
+						}
+					}
+					else
+					{
+						for (unsigned int i = 0; i < vertex_count; i++)
+						{
+							object_name = value_buffer[i];
+							if (changeLog->isIndexChange(object_name))
+							{
+								object->vertex_array->replace_integer_vertex_buffer_at_position(
+									GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_UPDATE_REQUIRED, i, 1, 1,
+									&modified_required);
+								/* setting object id here to -1, marking it as invalid, removed object
+									* will not be drawn and modified object will be modified and given
+									* correctly during object compilation.*/
+								object->vertex_array->replace_integer_vertex_buffer_at_position(
+									GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_OBJECT_ID, i, 1, 1,
+									&invalid_id);
+							}
 						}
 					}
 				}
@@ -1116,6 +1147,7 @@ struct GT_object *CREATE(GT_object)(const char *name,enum GT_object_type object_
 				object->display_list = 0;
 				object->position_vertex_buffer_object = 0;
 				object->position_values_per_vertex = 0;
+				object->position_vertex_count = 0;
 				object->colour_vertex_buffer_object = 0;
 				object->colour_values_per_vertex = 0;
 				object->normal_vertex_buffer_object = 0;
@@ -1498,6 +1530,13 @@ Graphics_vertex_array *
 	return (set);
 } /* GT_object_get_vertex_set */
 
+size_t GT_object_get_memory_size(struct GT_object *graphics_object)
+{
+	if ((graphics_object) && (graphics_object->vertex_array))
+		return graphics_object->vertex_array->get_memory_size();
+	return 0;
+}
+
 ZnReal GT_object_get_time(struct GT_object *graphics_object,int time_number)
 /*******************************************************************************
 LAST MODIFIED : 18 June 1998
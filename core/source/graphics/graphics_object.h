@@ -435,6 +435,12 @@ Returns 1 if the time parameter is used by the graphics_object.
  */
 struct Graphics_vertex_array *GT_object_get_vertex_set(struct GT_object *graphics_object);
 
+/**
+ * Returns estimate of memory used by the graphics_object's vertex buffers.
+ * @return  Size in bytes, 0 if no vertex set.
+ */
+size_t GT_object_get_memory_size(struct GT_object *graphics_object);
+
 /**
  * Returns the number of times/primitive lists in the graphics_object.
  */
@@ -156,6 +156,8 @@ Graphical object data structure.
 
 	GLuint position_vertex_buffer_object;
 	GLuint position_values_per_vertex;
+	/* number of vertices in position buffer object, for checking partial redraw */
+	GLuint position_vertex_count;
 	GLuint colour_vertex_buffer_object;
 	GLuint colour_values_per_vertex;
 	GLuint normal_vertex_buffer_object;
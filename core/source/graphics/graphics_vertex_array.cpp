@@ -6,6 +6,7 @@
 /**
  * C++ interfaces for graphics_vertex_array.cpp
  */
+#include <cmath>
 #include <iostream>
 #include <map>
 #include <stdlib.h>
@@ -130,6 +131,8 @@ int DESTROY(Graphics_vertex_buffer)(
 
 typedef std::map<Graphics_vertex_array_attribute_type, Graphics_vertex_string_buffer*> String_buffer_map;
 typedef std::multimap<int , int> Fast_search_id_map;
+typedef std::map<int, std::vector<unsigned int> > Shared_edge_vertices_map;
+typedef std::map<unsigned int, std::vector<GLfloat> > Shared_vertex_normals_map;
 
 class Graphics_vertex_array_internal
 {
@@ -140,6 +143,10 @@ public:
 	/* fast search map for locating id for quick modification,
 	 * this is implemented as multimap for graphics type that have varying number of primitives */
 	Fast_search_id_map id_map;
+	/* vertex indices along element edges for sharing vertices between elements */
+	Shared_edge_vertices_map shared_edge_map;
+	/* sums of unit normals from each element using a shared vertex */
+	Shared_vertex_normals_map shared_normal_sums;
 
 	Graphics_vertex_array_internal(Graphics_vertex_array_type type)
 		: type(type)
@@ -776,7 +783,7 @@ int Graphics_vertex_array::find_first_location_of_integer_value(
 
 void Graphics_vertex_array::fill_element_index(
 	unsigned vertex_start, unsigned int number_of_xi1, unsigned int number_of_xi2,
-	enum Graphics_vertex_array_shape_type shape_type)
+	enum Graphics_vertex_array_shape_type shape_type, const unsigned int *vertex_indices)
 {
 	unsigned int last_entry = get_number_of_vertices(
 		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_STRIP_START);
@@ -823,7 +830,7 @@ void Graphics_vertex_array::fill_element_index(
 			unsigned int current_index = 0;
 			for (unsigned int j = 0; j < points_per_strip; j++)
 			{
-				current_index = index + vertex_start;
+				current_index = vertex_indices ? vertex_indices[index] : index + vertex_start;
 				if (j & 1)
 				{
 					index += (number_of_strips - (j >> 1));
@@ -859,7 +866,7 @@ void Graphics_vertex_array::fill_element_index(
 				unsigned int current_index = 0;
 				for (unsigned int j = 0; j < points_per_strip; j++)
 				{
-					current_index = index + vertex_start;
+					current_index = vertex_indices ? vertex_indices[index] : index + vertex_start;
 					if (j & 1)
 						index += number_of_strips;
 					else
@@ -902,6 +909,73 @@ int Graphics_vertex_buffer_clear(
 	return (return_code);
 }
 
+/*****************************************************************************//**
+ * Adds the memory allocated for the buffer to the size_t total.
+ *
+ * @param buffer  Buffer to get memory size of.
+ * @param memory_size_void  Pointer to size_t total to add to.
+ * @return return_code. 1 for Success, 0 for failure.
+*/
+static int Graphics_vertex_buffer_add_memory_size(
+	struct Graphics_vertex_buffer *buffer, void *memory_size_void)
+{
+	size_t *memory_size = static_cast<size_t *>(memory_size_void);
+	if (buffer && memory_size)
+	{
+		/* all numeric vertex buffers store 4 byte values */
+		*memory_size += static_cast<size_t>(buffer->max_vertex_count)*
+			static_cast<size_t>(buffer->values_per_vertex)*4;
+		return 1;
+	}
+	return 0;
+}
+
+int Graphics_vertex_array::add_shared_edge_vertices(int edge_id,
+	unsigned int number_of_vertices, const unsigned int *vertex_indices)
+{
+	if (internal->shared_edge_map.find(edge_id) != internal->shared_edge_map.end())
+		return 0;
+	internal->shared_edge_map[edge_id].assign(vertex_indices, vertex_indices + number_of_vertices);
+	return 1;
+}
+
+int Graphics_vertex_array::get_shared_edge_vertices(int edge_id,
+	unsigned int number_of_vertices, unsigned int *vertex_indices)
+{
+	Shared_edge_vertices_map::const_iterator iter = internal->shared_edge_map.find(edge_id);
+	if ((iter == internal->shared_edge_map.end()) || (iter->second.size() != number_of_vertices))
+		return 0;
+	for (unsigned int i = 0; i < number_of_vertices; ++i)
+		vertex_indices[i] = iter->second[i];
+	return 1;
+}
+
+int Graphics_vertex_array::add_shared_vertex_normal(unsigned int vertex_index,
+	const GLfloat *normal)
+{
+	GLfloat *normal_buffer = 0;
+	unsigned int values_per_vertex = 0, vertex_count = 0;
+	if ((!get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+			&normal_buffer, &values_per_vertex, &vertex_count)) ||
+		(3 != values_per_vertex) || (vertex_index >= vertex_count))
+		return 0;
+	GLfloat *vertex_normal = normal_buffer + 3*vertex_index;
+	std::vector<GLfloat>& sum = internal->shared_normal_sums[vertex_index];
+	if (sum.empty())
+		sum.assign(vertex_normal, vertex_normal + 3);
+	sum[0] += normal[0];
+	sum[1] += normal[1];
+	sum[2] += normal[2];
+	const GLfloat length = std::sqrt(sum[0]*sum[0] + sum[1]*sum[1] + sum[2]*sum[2]);
+	if (length > 0.0f)
+	{
+		vertex_normal[0] = sum[0]/length;
+		vertex_normal[1] = sum[1]/length;
+		vertex_normal[2] = sum[2]/length;
+	}
+	return 1;
+}
+
 int Graphics_vertex_array::add_fast_search_id(int object_id)
 {
 	internal->add_fast_search_id(object_id);
@@ -923,10 +997,21 @@ int Graphics_vertex_array::get_all_fast_search_id_locations(int target_id,
 int Graphics_vertex_array::clear_buffers()
 {
 	internal->clear_string_buffer();
+	internal->shared_edge_map.clear();
+	internal->shared_normal_sums.clear();
 	return FOR_EACH_OBJECT_IN_LIST(Graphics_vertex_buffer)(
 		Graphics_vertex_buffer_clear, NULL, internal->buffer_list);
 }
 
+size_t Graphics_vertex_array::get_memory_size()
+{
+	size_t memory_size = 0;
+	FOR_EACH_OBJECT_IN_LIST(Graphics_vertex_buffer)(
+		Graphics_vertex_buffer_add_memory_size, static_cast<void *>(&memory_size),
+		internal->buffer_list);
+	return memory_size;
+}
+
 int Graphics_vertex_array::clear_specified_buffer(Graphics_vertex_array_attribute_type vertex_type)
 {
 	Graphics_vertex_buffer *buffer = FIND_BY_IDENTIFIER_IN_LIST(Graphics_vertex_buffer,type)
@@ -936,6 +1021,41 @@ int Graphics_vertex_array::clear_specified_buffer(Graphics_vertex_array_attribut
 	return 1;
 }
 
+void Graphics_vertex_array::add_partial_redraw_range(unsigned int vertex_start,
+	unsigned int vertex_count)
+{
+	const unsigned int maximum_number_of_ranges = 1024;
+	const unsigned int number_of_vertices =
+		this->get_number_of_vertices(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+	unsigned int *range_starts = 0, *range_counts = 0;
+	unsigned int values_per_vertex = 0, number_of_ranges = 0;
+	if (this->get_unsigned_integer_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW_COUNT,
+			&range_counts, &values_per_vertex, &number_of_ranges) && (0 < number_of_ranges) &&
+		this->get_unsigned_integer_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW,
+			&range_starts, &values_per_vertex, &number_of_ranges) && (0 < number_of_ranges))
+	{
+		const unsigned int last = number_of_ranges - 1;
+		if ((0 == range_starts[0]) && (range_counts[0] >= number_of_vertices))
+			return; // already redrawing all
+		if ((range_starts[last] + range_counts[last]) == vertex_start)
+		{
+			range_counts[last] += vertex_count;
+			return;
+		}
+		if (number_of_ranges >= maximum_number_of_ranges)
+		{
+			this->clear_specified_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW);
+			this->clear_specified_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW_COUNT);
+			vertex_start = 0;
+			vertex_count = number_of_vertices;
+		}
+	}
+	this->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW,
+		1, 1, &vertex_start);
+	this->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW_COUNT,
+		1, 1, &vertex_count);
+}
+
 Graphics_vertex_array::~Graphics_vertex_array()
 {
 	delete internal;
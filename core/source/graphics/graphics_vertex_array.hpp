@@ -303,6 +303,14 @@ public:
 	*/
 	int clear_buffers();
 
+	/**
+	 * Get the memory allocated for vertex buffers in the set, excluding
+	 * string buffers and search maps.
+	 *
+	 * @return  Size in bytes.
+	 */
+	size_t get_memory_size();
+
 	/*****************************************************************************//**
 	 * Resets the sizes of the specified buffers in the set.  Does not actually
 	 * release memory in the buffer as it is assumed likely that the same buffer
@@ -312,6 +320,17 @@ public:
 	*/
 	int clear_specified_buffer(Graphics_vertex_array_attribute_type vertex_type);
 
+	/**
+	 * Record a range of vertices replaced in place since the array was last
+	 * compiled, in the PARTIAL_REDRAW and PARTIAL_REDRAW_COUNT buffers, so the
+	 * renderer need only update that part of its buffers. Contiguous ranges are
+	 * merged; beyond a maximum number of ranges all vertices are redrawn.
+	 *
+	 * @param vertex_start  Index of first vertex in range.
+	 * @param vertex_count  Number of vertices in range.
+	 */
+	void add_partial_redraw_range(unsigned int vertex_start, unsigned int vertex_count);
+
 	/*****************************************************************************//**
 	 * Find the first location in the array with the same integer value.
 	 *
@@ -329,8 +348,52 @@ public:
 	 * with varying number of vertices per id e.g contour */
 	int get_all_fast_search_id_locations(int target_id, int *number_of_locations, int **locations);
 
+	/**
+	 * Add triangle strip indices for a grid of number_of_xi1*number_of_xi2
+	 * points for an element.
+	 *
+	 * @param vertex_start  Index of the first vertex of the element, used if
+	 * vertex_indices not supplied.
+	 * @param vertex_indices  Optional array mapping each grid point to the index
+	 * of its vertex in the array, permitting vertices to be shared between
+	 * elements. If omitted grid points are consecutive from vertex_start.
+	 */
 	void fill_element_index(unsigned vertex_start, unsigned int number_of_xi1, unsigned int number_of_xi2,
-		enum Graphics_vertex_array_shape_type shape_type);
+		enum Graphics_vertex_array_shape_type shape_type, const unsigned int *vertex_indices = 0);
+
+	/**
+	 * Record the vertex indices along an edge of an element so adjacent
+	 * elements can share them. Only the first record for an edge is kept.
+	 *
+	 * @param edge_id  Identifier of the edge, e.g. index of the line element.
+	 * @param number_of_vertices  Number of vertices along the edge.
+	 * @param vertex_indices  Vertex indices in order along the edge.
+	 * @return  1 if recorded, 0 if edge already recorded.
+	 */
+	int add_shared_edge_vertices(int edge_id, unsigned int number_of_vertices,
+		const unsigned int *vertex_indices);
+
+	/**
+	 * Get vertex indices recorded for an edge with add_shared_edge_vertices.
+	 *
+	 * @param edge_id  Identifier of the edge.
+	 * @param number_of_vertices  Expected number of vertices along the edge.
+	 * @param vertex_indices  Array to receive number_of_vertices indices.
+	 * @return  1 if found with matching number of vertices, 0 if not.
+	 */
+	int get_shared_edge_vertices(int edge_id, unsigned int number_of_vertices,
+		unsigned int *vertex_indices);
+
+	/**
+	 * Add the unit normal of another element using a shared vertex, and set
+	 * the vertex normal to the normalised sum of the unit normals of all
+	 * elements using it, starting with the normal it was added with.
+	 *
+	 * @param vertex_index  Index of the shared vertex.
+	 * @param normal  Unit normal of the element at the vertex.
+	 * @return  1 on success, 0 if no normal buffer or invalid vertex.
+	 */
+	int add_shared_vertex_normal(unsigned int vertex_index, const GLfloat *normal);
 
 };
 
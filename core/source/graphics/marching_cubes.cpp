@@ -0,0 +1,437 @@
+/**
+ * FILE : marching_cubes.cpp
+ *
+ * Parallel marching cubes extraction of welded iso-surfaces from regular grids.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "general/message.h"
+#include "general/parallel.hpp"
+#include "graphics/marching_cubes.hpp"
+#include <algorithm>
+
+namespace {
+
+/*
+ * Cube corners are numbered with bit 0 set for x = 1, bit 1 for y = 1 and
+ * bit 2 for z = 1. Edges are numbered 4*axis + the bits of the lower corner
+ * in the other two axes, in increasing axis order:
+ *   edges 0-3 along x at (y,z) = (0,0),(1,0),(0,1),(1,1);
+ *   edges 4-7 along y at (x,z) = (0,0),(1,0),(0,1),(1,1);
+ *   edges 8-11 along z at (x,y) = (0,0),(1,0),(0,1),(1,1).
+ */
+
+/** @return  Lower corner of cube edge. */
+inline int getEdgeLowerCorner(int edge)
+{
+	const int axis = edge / 4;
+	const int bit0 = edge & 1;
+	const int bit1 = (edge >> 1) & 1;
+	switch (axis)
+	{
+	case 0:
+		return (bit0 << 1) | (bit1 << 2);
+	case 1:
+		return bit0 | (bit1 << 2);
+	}
+	return bit0 | (bit1 << 1);
+}
+
+/** @return  Edge joining two corners differing in one bit. */
+int getCornersEdge(int corner1, int corner2)
+{
+	const int difference = corner1 ^ corner2;
+	const int axis = (difference == 1) ? 0 : ((difference == 2) ? 1 : 2);
+	const int lowerCorner = corner1 & corner2;
+	int otherBits = 0;
+	int b = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (i != axis)
+		{
+			otherBits |= ((lowerCorner >> i) & 1) << b;
+			++b;
+		}
+	}
+	return 4*axis + otherBits;
+}
+
+/** @return  True if cube edges lie in the same face of the cube. */
+bool edgesShareFace(int edge1, int edge2)
+{
+	const int axis1 = edge1 / 4;
+	const int axis2 = edge2 / 4;
+	const int lowerCorner1 = getEdgeLowerCorner(edge1);
+	const int lowerCorner2 = getEdgeLowerCorner(edge2);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if ((axis != axis1) && (axis != axis2) &&
+			(((lowerCorner1 ^ lowerCorner2) & (1 << axis)) == 0))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Triangulations of all 256 cases of corners above the iso-value, built once
+ * by tracing the surface around the faces of the cube. On each face, the
+ * surface enters where the boundary walked anticlockwise from outside the
+ * cube passes from below to above the iso-value, and leaves at the next edge
+ * passing back below it. This separates corners above the iso-value on
+ * ambiguous faces, and traces loops with consistent winding which are cut
+ * into triangle fans.
+ */
+class CaseTable
+{
+public:
+	// up to 4 loops of up to 12 edges in total give at most 10 triangles
+	int triangleCounts[256];
+	unsigned char triangleEdges[256][30];
+
+	CaseTable();
+
+	static const CaseTable& get()
+	{
+		static const CaseTable caseTable;
+		return caseTable;
+	}
+};
+
+CaseTable::CaseTable()
+{
+	for (int cubeCase = 0; cubeCase < 256; ++cubeCase)
+	{
+		int nextEdge[12];
+		for (int e = 0; e < 12; ++e)
+			nextEdge[e] = -1;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const int u = (axis + 1) % 3;
+			const int v = (axis + 2) % 3;
+			for (int side = 0; side < 2; ++side)
+			{
+				// corners anticlockwise viewed from outside face
+				int corners[4];
+				const int uv[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+				for (int c = 0; c < 4; ++c)
+				{
+					const int s = (side) ? c : 3 - c;
+					corners[c] = (side << axis) | (uv[s][0] << u) | (uv[s][1] << v);
+				}
+				for (int c = 0; c < 4; ++c)
+				{
+					const int cornerA = corners[c];
+					const int cornerB = corners[(c + 1) % 4];
+					if ((0 == (cubeCase & (1 << cornerA))) && (0 != (cubeCase & (1 << cornerB))))
+					{
+						for (int t = 1; t < 4; ++t)
+						{
+							const int exitA = corners[(c + t) % 4];
+							const int exitB = corners[(c + t + 1) % 4];
+							if ((0 != (cubeCase & (1 << exitA))) && (0 == (cubeCase & (1 << exitB))))
+							{
+								nextEdge[getCornersEdge(cornerA, cornerB)] = getCornersEdge(exitA, exitB);
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+		int triangleCount = 0;
+		bool traced[12] = { false, false, false, false, false, false,
+			false, false, false, false, false, false };
+		for (int e = 0; e < 12; ++e)
+		{
+			if ((nextEdge[e] < 0) || traced[e])
+				continue;
+			int loop[12];
+			int loopSize = 0;
+			for (int f = e; !traced[f]; f = nextEdge[f])
+			{
+				traced[f] = true;
+				loop[loopSize++] = f;
+			}
+			// fan from a vertex with no diagonals lying in a cube face, which
+			// could coincide with an edge of the neighbouring cell
+			int root = 0;
+			for (; root < loopSize; ++root)
+			{
+				int i = 2;
+				for (; i < loopSize - 1; ++i)
+					if (edgesShareFace(loop[root], loop[(root + i) % loopSize]))
+						break;
+				if (i >= loopSize - 1)
+					break;
+			}
+			if (root == loopSize)
+				root = 0;
+			for (int i = 1; i < loopSize - 1; ++i)
+			{
+				// loops trace clockwise viewed from above iso-value: reverse
+				this->triangleEdges[cubeCase][triangleCount*3] = static_cast<unsigned char>(loop[root]);
+				this->triangleEdges[cubeCase][triangleCount*3 + 1] = static_cast<unsigned char>(loop[(root + i + 1) % loopSize]);
+				this->triangleEdges[cubeCase][triangleCount*3 + 2] = static_cast<unsigned char>(loop[(root + i) % loopSize]);
+				++triangleCount;
+			}
+		}
+		this->triangleCounts[cubeCase] = triangleCount;
+	}
+}
+
+}
+
+MarchingCubes::MarchingCubes(const int *sizesIn, const double *valuesIn, int brickSizeIn) :
+	values(valuesIn),
+	brickSize(std::max(1, brickSizeIn))
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		this->sizes[i] = (sizesIn) ? sizesIn[i] : 0;
+		this->brickCounts[i] = (this->sizes[i] > 1) ?
+			(this->sizes[i] - 2) / this->brickSize + 1 : 0;
+	}
+	if (this->values)
+		this->findBrickRanges();
+}
+
+void MarchingCubes::findBrickRanges()
+{
+	const int brickCount = this->brickCounts[0]*this->brickCounts[1]*this->brickCounts[2];
+	this->brickMinimums.resize(brickCount);
+	this->brickMaximums.resize(brickCount);
+	const size_t pointsPerPlane = static_cast<size_t>(this->sizes[0])*this->sizes[1];
+	auto findLayerRanges = [this, pointsPerPlane](int, size_t layer)
+	{
+		const int bk = static_cast<int>(layer);
+		// bricks include points on their upper faces
+		const int k0 = bk*this->brickSize;
+		const int k1 = std::min(k0 + this->brickSize, this->sizes[2] - 1);
+		for (int bj = 0; bj < this->brickCounts[1]; ++bj)
+		{
+			const int j0 = bj*this->brickSize;
+			const int j1 = std::min(j0 + this->brickSize, this->sizes[1] - 1);
+			for (int bi = 0; bi < this->brickCounts[0]; ++bi)
+			{
+				const int i0 = bi*this->brickSize;
+				const int i1 = std::min(i0 + this->brickSize, this->sizes[0] - 1);
+				double minimum = this->values[k0*pointsPerPlane + j0*this->sizes[0] + i0];
+				double maximum = minimum;
+				for (int k = k0; k <= k1; ++k)
+				{
+					for (int j = j0; j <= j1; ++j)
+					{
+						const double *rowValues = this->values + k*pointsPerPlane + j*this->sizes[0];
+						for (int i = i0; i <= i1; ++i)
+						{
+							if (rowValues[i] < minimum)
+								minimum = rowValues[i];
+							else if (rowValues[i] > maximum)
+								maximum = rowValues[i];
+						}
+					}
+				}
+				const int brick = (bk*this->brickCounts[1] + bj)*this->brickCounts[0] + bi;
+				this->brickMinimums[brick] = minimum;
+				this->brickMaximums[brick] = maximum;
+			}
+		}
+	};
+	CMZN::parallel_for(0, this->brickCounts[2],
+		CMZN::parallel_get_thread_count(this->brickCounts[2]), findLayerRanges);
+}
+
+/**
+ * Extract mesh for the layers of cells in one layer of bricks.
+ * @param bottomEdgeVertices  Receives slab vertex indexes for x then y edges
+ * on the bottom plane of the slab, or -1 if none.
+ * @param topEdgeVertices  Receives slab vertex indexes for x then y edges on
+ * the top plane of the slab, or -1 if none.
+ */
+void MarchingCubes::extractSlab(double isoValue, int brickLayer, Mesh& slabMesh,
+	std::vector<int>& bottomEdgeVertices, std::vector<int>& topEdgeVertices) const
+{
+	const CaseTable& caseTable = CaseTable::get();
+	const int nx = this->sizes[0];
+	const int ny = this->sizes[1];
+	const size_t pointsPerPlane = static_cast<size_t>(nx)*ny;
+	const int k0 = brickLayer*this->brickSize;
+	const int k1 = std::min(k0 + this->brickSize, this->sizes[2] - 1);
+	slabMesh.clear();
+	// edge vertex caches indexed by lower grid point in plane: x and y edges
+	// on planes at bottom [0] and top [1] of current cell layer, z edges between
+	std::vector<int> planeEdgeVertices[2][2];
+	for (int p = 0; p < 2; ++p)
+		for (int a = 0; a < 2; ++a)
+			planeEdgeVertices[p][a].assign(pointsPerPlane, -1);
+	std::vector<int> zEdgeVertices(pointsPerPlane);
+	// active flags for bricks in this layer
+	const int brickRowCount = this->brickCounts[0]*this->brickCounts[1];
+	std::vector<unsigned char> activeBricks(brickRowCount);
+	int skippedBrickCount = 0;
+	for (int b = 0; b < brickRowCount; ++b)
+	{
+		const int brick = brickLayer*brickRowCount + b;
+		activeBricks[b] = ((this->brickMinimums[brick] <= isoValue) &&
+			(this->brickMaximums[brick] > isoValue)) ? 1 : 0;
+		if (!activeBricks[b])
+			++skippedBrickCount;
+	}
+	if (skippedBrickCount == brickRowCount)
+	{
+		bottomEdgeVertices.assign(2*pointsPerPlane, -1);
+		topEdgeVertices.assign(2*pointsPerPlane, -1);
+		return;
+	}
+	for (int k = k0; k < k1; ++k)
+	{
+		if (k > k0)
+		{
+			for (int a = 0; a < 2; ++a)
+			{
+				planeEdgeVertices[0][a].swap(planeEdgeVertices[1][a]);
+				std::fill(planeEdgeVertices[1][a].begin(), planeEdgeVertices[1][a].end(), -1);
+			}
+		}
+		std::fill(zEdgeVertices.begin(), zEdgeVertices.end(), -1);
+		const double *planeValues = this->values + k*pointsPerPlane;
+		for (int j = 0; j < ny - 1; ++j)
+		{
+			const unsigned char *activeBrickRow = activeBricks.data() + (j/this->brickSize)*this->brickCounts[0];
+			for (int i = 0; i < nx - 1; ++i)
+			{
+				if (!activeBrickRow[i/this->brickSize])
+				{
+					// skip to next brick
+					i = (i/this->brickSize + 1)*this->brickSize - 1;
+					continue;
+				}
+				const double *cellValues = planeValues + j*nx + i;
+				const double cornerValues[8] =
+				{
+					cellValues[0], cellValues[1], cellValues[nx], cellValues[nx + 1],
+					cellValues[pointsPerPlane], cellValues[pointsPerPlane + 1],
+					cellValues[pointsPerPlane + nx], cellValues[pointsPerPlane + nx + 1]
+				};
+				int cubeCase = 0;
+				for (int c = 0; c < 8; ++c)
+					if (cornerValues[c] > isoValue)
+						cubeCase |= (1 << c);
+				const int triangleCount = caseTable.triangleCounts[cubeCase];
+				if (0 == triangleCount)
+					continue;
+				const unsigned char *triangleEdges = caseTable.triangleEdges[cubeCase];
+				for (int t = 0; t < triangleCount*3; ++t)
+				{
+					const int edge = triangleEdges[t];
+					const int axis = edge / 4;
+					const int lowerCorner = getEdgeLowerCorner(edge);
+					const int ci = i + (lowerCorner & 1);
+					const int cj = j + ((lowerCorner >> 1) & 1);
+					const int cz = (lowerCorner >> 2) & 1;
+					const int planeIndex = cj*nx + ci;
+					int& vertex = (axis < 2) ?
+						planeEdgeVertices[cz][axis][planeIndex] : zEdgeVertices[planeIndex];
+					if (vertex < 0)
+					{
+						vertex = slabMesh.getVertexCount();
+						const double valueA = cornerValues[lowerCorner];
+						const double valueB = cornerValues[lowerCorner | (1 << axis)];
+						double r = (isoValue - valueA)/(valueB - valueA);
+						if (r < 0.0)
+							r = 0.0;
+						else if (r > 1.0)
+							r = 1.0;
+						const double position[3] =
+						{
+							static_cast<double>(ci), static_cast<double>(cj), static_cast<double>(k + cz)
+						};
+						for (int a = 0; a < 3; ++a)
+							slabMesh.positions.push_back((a == axis) ? position[a] + r : position[a]);
+						slabMesh.edges.push_back(static_cast<int>((k + cz)*pointsPerPlane + planeIndex));
+						slabMesh.edges.push_back(axis);
+					}
+					slabMesh.triangles.push_back(vertex);
+				}
+			}
+		}
+		if (k == k0)
+		{
+			bottomEdgeVertices = planeEdgeVertices[0][0];
+			bottomEdgeVertices.insert(bottomEdgeVertices.end(),
+				planeEdgeVertices[0][1].begin(), planeEdgeVertices[0][1].end());
+		}
+	}
+	topEdgeVertices = planeEdgeVertices[1][0];
+	topEdgeVertices.insert(topEdgeVertices.end(),
+		planeEdgeVertices[1][1].begin(), planeEdgeVertices[1][1].end());
+}
+
+bool MarchingCubes::extract(double isoValue, Mesh& mesh) const
+{
+	mesh.clear();
+	if (!((this->values) && (1 < this->sizes[0]) && (1 < this->sizes[1]) && (1 < this->sizes[2])))
+	{
+		display_message(ERROR_MESSAGE, "MarchingCubes::extract.  Invalid grid");
+		return false;
+	}
+	const int slabCount = this->brickCounts[2];
+	std::vector<Mesh> slabMeshes(slabCount);
+	std::vector< std::vector<int> > bottomEdgeVertices(slabCount), topEdgeVertices(slabCount);
+	CMZN::parallel_for(0, slabCount, CMZN::parallel_get_thread_count(slabCount),
+		[&](int, size_t slab)
+		{
+			this->extractSlab(isoValue, static_cast<int>(slab), slabMeshes[slab],
+				bottomEdgeVertices[slab], topEdgeVertices[slab]);
+		});
+
+	// join slabs, giving vertices on bottom plane of each slab the indexes of
+	// the same vertices on the top plane of the slab below
+	size_t vertexCount = 0, triangleIndexCount = 0;
+	for (int slab = 0; slab < slabCount; ++slab)
+	{
+		vertexCount += slabMeshes[slab].edges.size() / 2;
+		triangleIndexCount += slabMeshes[slab].triangles.size();
+	}
+	mesh.positions.reserve(vertexCount*3);
+	mesh.edges.reserve(vertexCount*2);
+	mesh.triangles.reserve(triangleIndexCount);
+	std::vector<int> vertexMap, lastVertexMap;
+	for (int slab = 0; slab < slabCount; ++slab)
+	{
+		const Mesh& slabMesh = slabMeshes[slab];
+		const int slabVertexCount = slabMesh.getVertexCount();
+		vertexMap.assign(slabVertexCount, -1);
+		if (0 < slab)
+		{
+			const std::vector<int>& bottomVertices = bottomEdgeVertices[slab];
+			const std::vector<int>& lastTopVertices = topEdgeVertices[slab - 1];
+			const size_t edgeCount = std::min(bottomVertices.size(), lastTopVertices.size());
+			for (size_t e = 0; e < edgeCount; ++e)
+			{
+				if ((bottomVertices[e] >= 0) && (lastTopVertices[e] >= 0))
+					vertexMap[bottomVertices[e]] = lastVertexMap[lastTopVertices[e]];
+			}
+		}
+		for (int v = 0; v < slabVertexCount; ++v)
+		{
+			if (vertexMap[v] < 0)
+			{
+				vertexMap[v] = mesh.getVertexCount();
+				mesh.positions.insert(mesh.positions.end(),
+					slabMesh.positions.begin() + v*3, slabMesh.positions.begin() + v*3 + 3);
+				mesh.edges.insert(mesh.edges.end(),
+					slabMesh.edges.begin() + v*2, slabMesh.edges.begin() + v*2 + 2);
+			}
+		}
+		for (std::vector<int>::const_iterator iter = slabMesh.triangles.begin();
+			iter != slabMesh.triangles.end(); ++iter)
+			mesh.triangles.push_back(vertexMap[*iter]);
+		lastVertexMap.swap(vertexMap);
+	}
+	return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * FILE : marching_cubes.hpp
+ *
+ * Parallel marching cubes extraction of welded iso-surfaces from regular grids.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__MARCHING_CUBES_HPP__)
+#define __MARCHING_CUBES_HPP__
+
+#include <vector>
+
+/**
+ * Extracts iso-surfaces from scalar values at the points of a regular 3-D
+ * grid. Cells are processed in z-slabs in parallel. Each vertex lies on one
+ * grid edge and its index is cached between adjacent cells and slabs, so the
+ * result is a welded indexed triangle mesh. Minimum and maximum values are
+ * kept for bricks of cells so bricks which cannot contain the iso-value are
+ * skipped without visiting their cells.
+ * Ambiguous faces are resolved by separating the corners above the iso-value,
+ * consistently between neighbouring cells so the surface has no cracks.
+ * The extractor does not own the grid values, which must not change while it
+ * is in use. Extraction is thread safe.
+ */
+class MarchingCubes
+{
+public:
+
+	/** Welded triangle mesh in grid point index units */
+	struct Mesh
+	{
+		/* x, y, z location of each vertex */
+		std::vector<double> positions;
+		/* for each vertex: index of grid point at lower end of its edge, with
+		 * x varying fastest, then edge axis 0, 1 or 2 */
+		std::vector<int> edges;
+		/* 3 vertex indexes per triangle, wound anticlockwise when viewed from
+		 * the side with values greater than the iso-value */
+		std::vector<int> triangles;
+
+		int getVertexCount() const
+		{
+			return static_cast<int>(this->positions.size() / 3);
+		}
+
+		int getTriangleCount() const
+		{
+			return static_cast<int>(this->triangles.size() / 3);
+		}
+
+		void clear()
+		{
+			this->positions.clear();
+			this->edges.clear();
+			this->triangles.clear();
+		}
+	};
+
+private:
+	int sizes[3];
+	const double *values;
+	int brickSize;
+	int brickCounts[3];
+	std::vector<double> brickMinimums;
+	std::vector<double> brickMaximums;
+
+	MarchingCubes();  // not implemented
+	MarchingCubes(const MarchingCubes &source);  // not implemented
+	MarchingCubes& operator=(const MarchingCubes &source);  // not implemented
+
+	void findBrickRanges();
+
+	void extractSlab(double isoValue, int brickLayer, Mesh& slabMesh,
+		std::vector<int>& bottomEdgeVertices, std::vector<int>& topEdgeVertices) const;
+
+public:
+
+	/**
+	 * @param sizesIn  Number of grid points in x, y, z, each at least 2.
+	 * @param valuesIn  Values at all grid points with x varying fastest, then
+	 * y, then z. Must remain valid for the lifetime of the extractor.
+	 * @param brickSizeIn  Number of cells along each side of a brick, and the
+	 * number of layers of cells in each slab.
+	 */
+	MarchingCubes(const int *sizesIn, const double *valuesIn, int brickSizeIn = 8);
+
+	/**
+	 * Extract surface where values equal isoValue. Vertices are interpolated
+	 * linearly along grid edges between points on either side of the iso-value,
+	 * where a point is above the iso-value if its value is greater.
+	 * @param mesh  Mesh to receive surface; existing contents are replaced.
+	 * @return  True on success, false if grid is invalid.
+	 */
+	bool extract(double isoValue, Mesh& mesh) const;
+
+};
+
+#endif /* !defined (__MARCHING_CUBES_HPP__) */
@@ -1724,6 +1724,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_PARTIAL_REDRAW_COUNT,
 						&redraw_count_buffer, &redrawPerVertex,
 						&redrawCount);
+				bool partialRedraw = false;
 				GLfloat *position_vertex_buffer = NULL;
 				unsigned int position_values_per_vertex, position_vertex_count;
 				if (object->vertex_array->get_float_vertex_buffer(
@@ -1736,6 +1737,10 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 						object->buffer_binding = 1;
 						glGenBuffers(1, &object->position_vertex_buffer_object);
 					}
+					/* only update modified ranges if buffers have not changed size */
+					partialRedraw = (0 != partialRedrawIndices) && (0 != redraw_count_buffer) &&
+						(0 < redrawCount) && (redrawCount == partialRedrawIndicesCount) &&
+						(position_vertex_count == object->position_vertex_count);
 
 					if (object->secondary_material)
 					{
@@ -1746,10 +1751,13 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 					else if (object->buffer_binding)
 					{
 						glBindBuffer(GL_ARRAY_BUFFER, object->position_vertex_buffer_object);
-						if (!partialRedrawIndices)
+						if (!partialRedraw)
+						{
 							glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*
 									position_values_per_vertex*position_vertex_count,
 									position_vertex_buffer, GL_STATIC_DRAW);
+							object->position_vertex_count = position_vertex_count;
+						}
 						else
 						{
 							GLintptr bytesStart = 0;
@@ -1771,6 +1779,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 					{
 						glDeleteBuffers(1, &object->position_vertex_buffer_object);
 						object->position_vertex_buffer_object = 0;
+						object->position_vertex_count = 0;
 					}
 				}
 				unsigned int colour_values_per_vertex, colour_vertex_count;
@@ -1823,7 +1832,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 					if (object->buffer_binding)
 					{
 						glBindBuffer(GL_ARRAY_BUFFER, object->normal_vertex_buffer_object);
-						if (!partialRedrawIndices)
+						if (!partialRedraw)
 							glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*normal_values_per_vertex*normal_vertex_count,
 								normal_buffer, GL_STATIC_DRAW);
 						else
@@ -1864,7 +1873,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 					if (object->buffer_binding)
 					{
 						glBindBuffer(GL_ARRAY_BUFFER, object->texture_coordinate0_vertex_buffer_object);
-						if (!partialRedrawIndices)
+						if (!partialRedraw)
 							glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*texture_coordinate0_values_per_vertex*texture_coordinate0_vertex_count,
 								texture_coordinate0_buffer, GL_STATIC_DRAW);
 						else
@@ -1905,7 +1914,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 						glGenBuffers(1, &object->tangent_vertex_buffer_object);
 					}
 					glBindBuffer(GL_ARRAY_BUFFER, object->tangent_vertex_buffer_object);
-					if (!partialRedrawIndices)
+					if (!partialRedraw)
 						glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*tangent_values_per_vertex*tangent_vertex_count,
 								tangent_buffer, GL_STATIC_DRAW);
 					else
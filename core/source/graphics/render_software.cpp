@@ -0,0 +1,831 @@
+/***************************************************************************//**
+ * render_software.cpp
+ * Renderer rasterising graphics to pixels on the CPU, without a graphics library.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cmath>
+#include "opencmiss/zinc/graphics.h"
+#include "opencmiss/zinc/scenefilter.h"
+#include "opencmiss/zinc/status.h"
+#include "general/debug.h"
+#include "general/message.h"
+#include "general/parallel.hpp"
+#include "graphics/glyph.hpp"
+#include "graphics/graphics.h"
+#include "graphics/graphics_object.h"
+#include "graphics/graphics_object_private.hpp"
+#include "graphics/material.h"
+#include "graphics/render_software.hpp"
+#include "graphics/scene.hpp"
+#include "graphics/scenefilter.hpp"
+#include "graphics/spectrum.h"
+#include "region/cmiss_region.hpp"
+
+namespace {
+
+/* tile size in pixels for binning and parallel rasterisation */
+const int SOFTWARE_TILE_SIZE = 32;
+
+enum Software_primitive_type
+{
+	SOFTWARE_PRIMITIVE_TRIANGLE = 0,
+	SOFTWARE_PRIMITIVE_LINE = 1,
+	SOFTWARE_PRIMITIVE_POINT = 2
+};
+
+/* depth offset bringing lines and points in front of coincident surfaces */
+const double SOFTWARE_LINE_DEPTH_OFFSET = 1.0E-5;
+
+/** Column major 4x4 matrix product c = a.b; c must not be a or b. */
+void software_multiply_matrix(const double *a, const double *b, double *c)
+{
+	for (int col = 0; col < 4; ++col)
+		for (int row = 0; row < 4; ++row)
+			c[col*4 + row] =
+				a[row]*b[col*4] + a[4 + row]*b[col*4 + 1] +
+				a[8 + row]*b[col*4 + 2] + a[12 + row]*b[col*4 + 3];
+}
+
+void software_identity_matrix(double *m)
+{
+	for (int i = 0; i < 16; ++i)
+		m[i] = (i % 5) ? 0.0 : 1.0;
+}
+
+inline void software_interpolate_vertex(const Render_graphics_software::Vertex& v1,
+	const Render_graphics_software::Vertex& v2, double xi,
+	Render_graphics_software::Vertex& result)
+{
+	for (int i = 0; i < 4; ++i)
+		result.coordinates[i] = v1.coordinates[i] + xi*(v2.coordinates[i] - v1.coordinates[i]);
+	for (int i = 0; i < 4; ++i)
+		result.rgba[i] = v1.rgba[i] + static_cast<float>(xi)*(v2.rgba[i] - v1.rgba[i]);
+}
+
+/** Signed distance-like value which is non-negative for clip coordinates in
+ * front of the near plane. */
+inline double software_near_distance(const Render_graphics_software::Vertex& v)
+{
+	return v.coordinates[2] + v.coordinates[3];
+}
+
+/** @return  True if all vertices are outside the same side of the view volume
+ * in x or y. */
+bool software_vertices_outside(const Render_graphics_software::Vertex *vertices,
+	int count)
+{
+	for (int c = 0; c < 2; ++c)
+	{
+		bool allBelow = true, allAbove = true;
+		for (int i = 0; i < count; ++i)
+		{
+			const double w = vertices[i].coordinates[3];
+			if (vertices[i].coordinates[c] >= -w)
+				allBelow = false;
+			if (vertices[i].coordinates[c] <= w)
+				allAbove = false;
+		}
+		if (allBelow || allAbove)
+			return true;
+	}
+	return false;
+}
+
+struct Software_scene_graphics_data
+{
+	Render_graphics_software *renderer;
+	cmzn_scenefilter *filter;
+};
+
+int Software_execute_graphics_iterator(cmzn_graphics *graphics, void *data_void)
+{
+	Software_scene_graphics_data *data = static_cast<Software_scene_graphics_data *>(data_void);
+	if ((0 == data->filter) || (cmzn_scenefilter_evaluate_graphics(data->filter, graphics)))
+		data->renderer->Graphics_execute(graphics);
+	return 1;
+}
+
+} // anonymous namespace
+
+Render_graphics_software::Render_graphics_software(int widthIn, int heightIn,
+	const double *windowProjectionMatrixIn, const double *modelviewMatrixIn,
+	const double *backgroundRgba, int numberOfThreadsIn) :
+	width(widthIn),
+	height(heightIn),
+	numberOfThreads(numberOfThreadsIn),
+	perspective(false),
+	windowCoordinates(false)
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		this->windowProjectionMatrix[i] = windowProjectionMatrixIn[i];
+		this->modelviewMatrix[i] = modelviewMatrixIn[i];
+	}
+	software_identity_matrix(this->sceneToWorldMatrix);
+	for (int i = 0; i < 4; ++i)
+		this->backgroundColour[i] = static_cast<float>(backgroundRgba[i]);
+	// perspective projections give w = -z_eye
+	this->perspective = (0.0 == this->windowProjectionMatrix[15]);
+	this->setObjectTransformation(this->sceneToWorldMatrix);
+}
+
+void Render_graphics_software::setObjectTransformation(const double *objectToWorld)
+{
+	if (this->windowCoordinates)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			this->objectToEyeMatrix[i] = objectToWorld[i];
+			this->objectToClipMatrix[i] = objectToWorld[i];
+		}
+	}
+	else
+	{
+		software_multiply_matrix(this->modelviewMatrix, objectToWorld, this->objectToEyeMatrix);
+		software_multiply_matrix(this->windowProjectionMatrix, this->objectToEyeMatrix,
+			this->objectToClipMatrix);
+	}
+}
+
+void Render_graphics_software::transformVertex(const GLfloat *position,
+	int valuesPerVertex, const float *rgba, Vertex& vertex) const
+{
+	const double x = position[0];
+	const double y = (1 < valuesPerVertex) ? position[1] : 0.0;
+	const double z = (2 < valuesPerVertex) ? position[2] : 0.0;
+	const double *m = this->objectToClipMatrix;
+	for (int i = 0; i < 4; ++i)
+		vertex.coordinates[i] = m[i]*x + m[4 + i]*y + m[8 + i]*z + m[12 + i];
+	for (int i = 0; i < 4; ++i)
+		vertex.rgba[i] = rgba[i];
+}
+
+void Render_graphics_software::transformEyeVertex(const GLfloat *position,
+	int valuesPerVertex, double *eye) const
+{
+	const double x = position[0];
+	const double y = (1 < valuesPerVertex) ? position[1] : 0.0;
+	const double z = (2 < valuesPerVertex) ? position[2] : 0.0;
+	const double *m = this->objectToEyeMatrix;
+	for (int i = 0; i < 3; ++i)
+		eye[i] = m[i]*x + m[4 + i]*y + m[8 + i]*z + m[12 + i];
+}
+
+/** Converts vertex from clip to window coordinates and appends to vertices. */
+void Render_graphics_software::addWindowVertex(const Vertex& vertex,
+	std::vector<Vertex>& vertices)
+{
+	Vertex windowVertex;
+	const double w = vertex.coordinates[3];
+	windowVertex.coordinates[0] = 0.5*(vertex.coordinates[0]/w + 1.0)*this->width;
+	windowVertex.coordinates[1] = 0.5*(vertex.coordinates[1]/w + 1.0)*this->height;
+	windowVertex.coordinates[2] = 0.5*(vertex.coordinates[2]/w + 1.0);
+	windowVertex.coordinates[3] = 1.0;
+	for (int i = 0; i < 4; ++i)
+		windowVertex.rgba[i] = vertex.rgba[i];
+	vertices.push_back(windowVertex);
+}
+
+void Render_graphics_software::addTriangle(const GLfloat *position1,
+	const GLfloat *position2, const GLfloat *position3, int valuesPerVertex,
+	const float *rgba1, const float *rgba2, const float *rgba3)
+{
+	Vertex vertices[3];
+	this->transformVertex(position1, valuesPerVertex, rgba1, vertices[0]);
+	this->transformVertex(position2, valuesPerVertex, rgba2, vertices[1]);
+	this->transformVertex(position3, valuesPerVertex, rgba3, vertices[2]);
+	if (software_vertices_outside(vertices, 3))
+		return;
+	// flat shade with headlight at eye
+	double eye[3][3];
+	this->transformEyeVertex(position1, valuesPerVertex, eye[0]);
+	this->transformEyeVertex(position2, valuesPerVertex, eye[1]);
+	this->transformEyeVertex(position3, valuesPerVertex, eye[2]);
+	const double a[3] = { eye[1][0] - eye[0][0], eye[1][1] - eye[0][1], eye[1][2] - eye[0][2] };
+	const double b[3] = { eye[2][0] - eye[0][0], eye[2][1] - eye[0][1], eye[2][2] - eye[0][2] };
+	const double normal[3] = { a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0] };
+	const double normalLength = sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+	if (normalLength <= 0.0)
+		return;
+	double view[3] = { 0.0, 0.0, 1.0 };
+	if ((this->perspective) && (!this->windowCoordinates))
+	{
+		for (int i = 0; i < 3; ++i)
+			view[i] = -(eye[0][i] + eye[1][i] + eye[2][i]);
+		const double viewLength = sqrt(view[0]*view[0] + view[1]*view[1] + view[2]*view[2]);
+		if (viewLength > 0.0)
+			for (int i = 0; i < 3; ++i)
+				view[i] /= viewLength;
+	}
+	const float shade = static_cast<float>(0.3 + 0.7*fabs(
+		normal[0]*view[0] + normal[1]*view[1] + normal[2]*view[2])/normalLength);
+	for (int v = 0; v < 3; ++v)
+		for (int i = 0; i < 3; ++i)
+			vertices[v].rgba[i] *= shade;
+	// clip against near plane giving up to 4 vertices
+	Vertex clipped[4];
+	int clippedCount = 0;
+	for (int v = 0; v < 3; ++v)
+	{
+		const Vertex& v1 = vertices[v];
+		const Vertex& v2 = vertices[(v + 1) % 3];
+		const double d1 = software_near_distance(v1);
+		const double d2 = software_near_distance(v2);
+		if (d1 >= 0.0)
+			clipped[clippedCount++] = v1;
+		if ((d1 >= 0.0) != (d2 >= 0.0))
+			software_interpolate_vertex(v1, v2, d1/(d1 - d2), clipped[clippedCount++]);
+	}
+	for (int v = 2; v < clippedCount; ++v)
+	{
+		const unsigned int index = static_cast<unsigned int>(this->triangleVertices.size()/3);
+		this->addWindowVertex(clipped[0], this->triangleVertices);
+		this->addWindowVertex(clipped[v - 1], this->triangleVertices);
+		this->addWindowVertex(clipped[v], this->triangleVertices);
+		this->primitives.push_back((index << 2) | SOFTWARE_PRIMITIVE_TRIANGLE);
+	}
+}
+
+void Render_graphics_software::addLine(const GLfloat *position1,
+	const GLfloat *position2, int valuesPerVertex, const float *rgba1,
+	const float *rgba2)
+{
+	Vertex vertices[2];
+	this->transformVertex(position1, valuesPerVertex, rgba1, vertices[0]);
+	this->transformVertex(position2, valuesPerVertex, rgba2, vertices[1]);
+	if (software_vertices_outside(vertices, 2))
+		return;
+	const double d1 = software_near_distance(vertices[0]);
+	const double d2 = software_near_distance(vertices[1]);
+	if ((d1 < 0.0) && (d2 < 0.0))
+		return;
+	if (d1 < 0.0)
+		software_interpolate_vertex(vertices[0], vertices[1], d1/(d1 - d2), vertices[0]);
+	else if (d2 < 0.0)
+		software_interpolate_vertex(vertices[1], vertices[0], d2/(d2 - d1), vertices[1]);
+	const unsigned int index = static_cast<unsigned int>(this->lineVertices.size()/2);
+	this->addWindowVertex(vertices[0], this->lineVertices);
+	this->addWindowVertex(vertices[1], this->lineVertices);
+	this->primitives.push_back((index << 2) | SOFTWARE_PRIMITIVE_LINE);
+}
+
+void Render_graphics_software::addPoint(const GLfloat *position,
+	int valuesPerVertex, const float *rgba)
+{
+	Vertex vertex;
+	this->transformVertex(position, valuesPerVertex, rgba, vertex);
+	if ((vertex.coordinates[3] <= 0.0) || (software_near_distance(vertex) < 0.0) ||
+		software_vertices_outside(&vertex, 1))
+		return;
+	const unsigned int index = static_cast<unsigned int>(this->pointVertices.size());
+	this->addWindowVertex(vertex, this->pointVertices);
+	this->primitives.push_back((index << 2) | SOFTWARE_PRIMITIVE_POINT);
+}
+
+/**
+ * Collects primitives from graphics object with its position vertices
+ * transformed by objectToWorld.
+ * @param overrideRgba  Optional colour to use for all primitives, used for
+ * glyphs coloured by their glyph set. Otherwise material or spectrum colour.
+ */
+int Render_graphics_software::executeObject(GT_object *object,
+	const double *objectToWorld, const float *overrideRgba)
+{
+	if (!object)
+		return 0;
+	Graphics_vertex_array *vertex_array = object->vertex_array;
+	if (!((vertex_array) && (object->primitive_lists)))
+		return 1;
+	this->setObjectTransformation(objectToWorld);
+	GLfloat *position_buffer = 0;
+	unsigned int position_values_per_vertex = 0, position_vertex_count = 0;
+	vertex_array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+		&position_buffer, &position_values_per_vertex, &position_vertex_count);
+	const unsigned int element_count = vertex_array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START);
+
+	// colours: a single base colour unless coloured by spectrum per vertex
+	float baseRgba[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	cmzn_material *material = get_GT_object_default_material(object);
+	if (material)
+	{
+		Colour diffuse;
+		MATERIAL_PRECISION alpha = 1.0;
+		Graphical_material_get_diffuse(material, &diffuse);
+		Graphical_material_get_alpha(material, &alpha);
+		baseRgba[0] = static_cast<float>(diffuse.red);
+		baseRgba[1] = static_cast<float>(diffuse.green);
+		baseRgba[2] = static_cast<float>(diffuse.blue);
+		baseRgba[3] = static_cast<float>(alpha);
+	}
+	if (overrideRgba)
+		for (int i = 0; i < 4; ++i)
+			baseRgba[i] = overrideRgba[i];
+	std::vector<float> vertexRgba;
+	GLfloat *data_buffer = 0;
+	unsigned int data_values_per_vertex = 0, data_vertex_count = 0;
+	cmzn_spectrum *spectrum = get_GT_object_spectrum(object);
+	if ((!overrideRgba) && (spectrum) && (vertex_array->get_float_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+		&data_buffer, &data_values_per_vertex, &data_vertex_count)) &&
+		(data_vertex_count == position_vertex_count))
+	{
+		vertexRgba.resize(4*data_vertex_count);
+		std::vector<FE_value> feData(data_values_per_vertex);
+		ZnReal rgba[4];
+		for (unsigned int v = 0; v < data_vertex_count; ++v)
+		{
+			for (int i = 0; i < 4; ++i)
+				rgba[i] = baseRgba[i];
+			for (unsigned int i = 0; i < data_values_per_vertex; ++i)
+				feData[i] = static_cast<FE_value>(data_buffer[v*data_values_per_vertex + i]);
+			Spectrum_value_to_rgba(spectrum, data_values_per_vertex, feData.data(), rgba);
+			for (int i = 0; i < 4; ++i)
+				vertexRgba[v*4 + i] = static_cast<float>(rgba[i]);
+		}
+		Spectrum_end_value_to_rgba(spectrum);
+	}
+	const float *colours = (vertexRgba.size()) ? vertexRgba.data() : baseRgba;
+	const unsigned int colourStride = (vertexRgba.size()) ? 4 : 0;
+	const unsigned int pvv = position_values_per_vertex;
+
+	switch (object->object_type)
+	{
+	case g_SURFACE_VERTEX_BUFFERS:
+	{
+		GT_surface_vertex_buffers *surface = object->primitive_lists->gt_surface_vertex_buffers;
+		if (!surface)
+			break;
+		unsigned int *index_vertex_buffer = 0, index_values_per_vertex = 0, index_vertex_count = 0;
+		vertex_array->get_unsigned_integer_vertex_buffer(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_STRIP_INDEX_ARRAY,
+			&index_vertex_buffer, &index_values_per_vertex, &index_vertex_count);
+		for (unsigned int surface_index = 0; surface_index < element_count; ++surface_index)
+		{
+			int object_name = 0;
+			if (!vertex_array->get_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_OBJECT_ID,
+				surface_index, 1, &object_name))
+				object_name = 0;
+			if (object_name < 0)
+				continue;
+			switch (surface->surface_type)
+			{
+			case g_SHADED:
+			case g_SHADED_TEXMAP:
+			{
+				if (!index_vertex_buffer)
+					break;
+				unsigned int number_of_strips = 0, strip_start = 0;
+				vertex_array->get_unsigned_integer_attribute(
+					GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_STRIPS,
+					surface_index, 1, &number_of_strips);
+				vertex_array->get_unsigned_integer_attribute(
+					GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_STRIP_START,
+					surface_index, 1, &strip_start);
+				for (unsigned int s = 0; s < number_of_strips; ++s)
+				{
+					unsigned int points_per_strip = 0, index_start_for_strip = 0;
+					vertex_array->get_unsigned_integer_attribute(
+						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_STRIP_INDEX_START,
+						strip_start + s, 1, &index_start_for_strip);
+					vertex_array->get_unsigned_integer_attribute(
+						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NUMBER_OF_POINTS_FOR_STRIP,
+						strip_start + s, 1, &points_per_strip);
+					const unsigned int *indices = index_vertex_buffer + index_start_for_strip;
+					for (unsigned int j = 2; j < points_per_strip; ++j)
+					{
+						// alternate winding to keep consistent orientation
+						const unsigned int i1 = (j % 2) ? indices[j - 1] : indices[j - 2];
+						const unsigned int i2 = (j % 2) ? indices[j - 2] : indices[j - 1];
+						const unsigned int i3 = indices[j];
+						this->addTriangle(position_buffer + i1*pvv, position_buffer + i2*pvv,
+							position_buffer + i3*pvv, pvv, colours + i1*colourStride,
+							colours + i2*colourStride, colours + i3*colourStride);
+					}
+				}
+			} break;
+			case g_SH_DISCONTINUOUS:
+			case g_SH_DISCONTINUOUS_STRIP:
+			case g_SH_DISCONTINUOUS_TEXMAP:
+			case g_SH_DISCONTINUOUS_STRIP_TEXMAP:
+			{
+				unsigned int index_start = 0, index_count = 0;
+				vertex_array->get_unsigned_integer_attribute(
+					GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+					surface_index, 1, &index_start);
+				vertex_array->get_unsigned_integer_attribute(
+					GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+					surface_index, 1, &index_count);
+				for (unsigned int i = 0; i + 2 < index_count; i += 3)
+				{
+					const unsigned int i1 = index_start + i;
+					this->addTriangle(position_buffer + i1*pvv, position_buffer + (i1 + 1)*pvv,
+						position_buffer + (i1 + 2)*pvv, pvv, colours + i1*colourStride,
+						colours + (i1 + 1)*colourStride, colours + (i1 + 2)*colourStride);
+				}
+			} break;
+			default:
+			{
+			} break;
+			}
+		}
+	} break;
+	case g_POLYLINE_VERTEX_BUFFERS:
+	{
+		GT_polyline_vertex_buffers *line = object->primitive_lists->gt_polyline_vertex_buffers;
+		if (!line)
+			break;
+		const bool discontinuous = (g_PLAIN_DISCONTINUOUS == line->polyline_type) ||
+			(g_NORMAL_DISCONTINUOUS == line->polyline_type);
+		for (unsigned int line_index = 0; line_index < element_count; ++line_index)
+		{
+			int object_name = 0;
+			if (!vertex_array->get_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_OBJECT_ID,
+				line_index, 1, &object_name))
+				object_name = 0;
+			if (object_name < 0)
+				continue;
+			unsigned int index_start = 0, index_count = 0;
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+				line_index, 1, &index_start);
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+				line_index, 1, &index_count);
+			const unsigned int step = discontinuous ? 2 : 1;
+			for (unsigned int i = 0; i + 1 < index_count; i += step)
+			{
+				const unsigned int i1 = index_start + i;
+				this->addLine(position_buffer + i1*pvv, position_buffer + (i1 + 1)*pvv, pvv,
+					colours + i1*colourStride, colours + (i1 + 1)*colourStride);
+			}
+		}
+	} break;
+	case g_POINT_SET_VERTEX_BUFFERS:
+	{
+		for (unsigned int pointset_index = 0; pointset_index < element_count; ++pointset_index)
+		{
+			unsigned int index_start = 0, index_count = 0;
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+				pointset_index, 1, &index_start);
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+				pointset_index, 1, &index_count);
+			for (unsigned int i = index_start; i < index_start + index_count; ++i)
+				this->addPoint(position_buffer + i*pvv, pvv, colours + i*colourStride);
+		}
+	} break;
+	case g_GLYPH_SET_VERTEX_BUFFERS:
+	{
+		GT_glyphset_vertex_buffers *glyph_set = object->primitive_lists->gt_glyphset_vertex_buffers;
+		if ((!glyph_set) || (!glyph_set->glyph) || (!position_buffer))
+			break;
+		GLfloat *axis1_buffer = 0, *axis2_buffer = 0, *axis3_buffer = 0, *scale_buffer = 0;
+		unsigned int axis1_values_per_vertex = 0, axis1_vertex_count = 0,
+			axis2_values_per_vertex = 0, axis2_vertex_count = 0,
+			axis3_values_per_vertex = 0, axis3_vertex_count = 0,
+			scale_values_per_vertex = 0, scale_vertex_count = 0;
+		vertex_array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_AXIS1,
+			&axis1_buffer, &axis1_values_per_vertex, &axis1_vertex_count);
+		vertex_array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_AXIS2,
+			&axis2_buffer, &axis2_values_per_vertex, &axis2_vertex_count);
+		vertex_array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_AXIS3,
+			&axis3_buffer, &axis3_values_per_vertex, &axis3_vertex_count);
+		vertex_array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_SCALE,
+			&scale_buffer, &scale_values_per_vertex, &scale_vertex_count);
+		if (!((axis1_buffer) && (axis2_buffer) && (axis3_buffer) && (scale_buffer)))
+			break;
+		const int number_of_glyphs =
+			cmzn_glyph_repeat_mode_get_number_of_glyphs(glyph_set->glyph_repeat_mode);
+		Triple temp_point, temp_axis1, temp_axis2, temp_axis3;
+		double glyphMatrix[16], glyphToWorld[16];
+		for (unsigned int nodeset_index = 0; nodeset_index < element_count; ++nodeset_index)
+		{
+			unsigned int index_start = 0, index_count = 0;
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+				nodeset_index, 1, &index_start);
+			vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+				nodeset_index, 1, &index_count);
+			for (unsigned int i = index_start; i < index_start + index_count; ++i)
+			{
+				for (int glyph_number = 0; glyph_number < number_of_glyphs; ++glyph_number)
+				{
+					resolve_glyph_axes(glyph_set->glyph_repeat_mode, glyph_number,
+						glyph_set->base_size, glyph_set->scale_factors, glyph_set->offset,
+						position_buffer + i*pvv, axis1_buffer + i*axis1_values_per_vertex,
+						axis2_buffer + i*axis2_values_per_vertex, axis3_buffer + i*axis3_values_per_vertex,
+						scale_buffer + i*scale_values_per_vertex,
+						temp_point, temp_axis1, temp_axis2, temp_axis3);
+					for (int j = 0; j < 3; ++j)
+					{
+						glyphMatrix[j] = temp_axis1[j];
+						glyphMatrix[4 + j] = temp_axis2[j];
+						glyphMatrix[8 + j] = temp_axis3[j];
+						glyphMatrix[12 + j] = temp_point[j];
+					}
+					glyphMatrix[3] = glyphMatrix[7] = glyphMatrix[11] = 0.0;
+					glyphMatrix[15] = 1.0;
+					software_multiply_matrix(objectToWorld, glyphMatrix, glyphToWorld);
+					for (GT_object *glyph = glyph_set->glyph; glyph; glyph = GT_object_get_next_object(glyph))
+						this->executeObject(glyph, glyphToWorld, colours + i*colourStride);
+				}
+			}
+		}
+		this->setObjectTransformation(objectToWorld);
+	} break;
+	default:
+	{
+	} break;
+	}
+	return 1;
+}
+
+int Render_graphics_software::Scene_tree_execute(cmzn_scene *scene)
+{
+	if (!scene)
+		return 0;
+	this->set_Scene(scene);
+	this->triangleVertices.clear();
+	this->lineVertices.clear();
+	this->pointVertices.clear();
+	this->primitives.clear();
+	return this->executeSceneTree(scene);
+}
+
+int Render_graphics_software::executeSceneTree(cmzn_scene *scene)
+{
+	double rowMajor[16];
+	const int result = scene->getTotalTransformationMatrix(this->get_Scene(), rowMajor);
+	if (CMZN_OK == result)
+	{
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				this->sceneToWorldMatrix[j*4 + i] = rowMajor[i*4 + j];
+	}
+	else if (CMZN_ERROR_NOT_FOUND == result)
+		software_identity_matrix(this->sceneToWorldMatrix);
+	else
+		return 0;
+	Software_scene_graphics_data data = { this, this->getScenefilter() };
+	for_each_graphics_in_cmzn_scene(scene, Software_execute_graphics_iterator, (void *)&data);
+	int return_code = 1;
+	cmzn_region *child_region = cmzn_region_get_first_child(cmzn_scene_get_region_internal(scene));
+	while (child_region)
+	{
+		cmzn_scene *child_scene = child_region->getScene();
+		if ((child_scene) && (!this->executeSceneTree(child_scene)))
+			return_code = 0;
+		cmzn_region_reaccess_next_sibling(&child_region);
+	}
+	return return_code;
+}
+
+int Render_graphics_software::Graphics_execute(cmzn_graphics *graphics)
+{
+	GT_object *graphics_object = cmzn_graphics_get_graphics_object(graphics);
+	if (!graphics_object)
+		return 1;
+	double identity[16];
+	software_identity_matrix(identity);
+	int return_code = 1;
+	switch (cmzn_graphics_get_scenecoordinatesystem(graphics))
+	{
+	case CMZN_SCENECOORDINATESYSTEM_LOCAL:
+		return_code = this->executeObject(graphics_object, this->sceneToWorldMatrix, 0);
+		break;
+	case CMZN_SCENECOORDINATESYSTEM_WORLD:
+		return_code = this->executeObject(graphics_object, identity, 0);
+		break;
+	case CMZN_SCENECOORDINATESYSTEM_NORMALISED_WINDOW_FILL:
+		this->windowCoordinates = true;
+		return_code = this->executeObject(graphics_object, identity, 0);
+		this->windowCoordinates = false;
+		break;
+	default:
+		// other window-relative coordinate systems are not supported
+		break;
+	}
+	return return_code;
+}
+
+int Render_graphics_software::Graphics_object_execute(GT_object *graphics_object)
+{
+	double identity[16];
+	software_identity_matrix(identity);
+	return this->executeObject(graphics_object, identity, 0);
+}
+
+inline void Render_graphics_software::writeFragment(int x, int y, double depth,
+	const float *rgba)
+{
+	if ((depth < 0.0) || (depth > 1.0))
+		return;
+	const int index = y*this->width + x;
+	if (depth > this->depthBuffer[index])
+		return;
+	float *colour = this->colourBuffer.data() + 4*index;
+	const float alpha = rgba[3];
+	if (alpha >= 1.0f)
+	{
+		for (int i = 0; i < 4; ++i)
+			colour[i] = rgba[i];
+		this->depthBuffer[index] = static_cast<float>(depth);
+	}
+	else
+	{
+		// blend without depth write as for OpenGL transparency
+		for (int i = 0; i < 3; ++i)
+			colour[i] = alpha*rgba[i] + (1.0f - alpha)*colour[i];
+		colour[3] = alpha + (1.0f - alpha)*colour[3];
+	}
+}
+
+/** Rasterise primitives overlapping tile with pixel bounds left <= x < right
+ * and bottom <= y < top. Different tiles write to disjoint pixels so can be
+ * rasterised concurrently. */
+void Render_graphics_software::rasteriseTile(int tileLeft, int tileBottom,
+	int tileRight, int tileTop, const std::vector<unsigned int>& tilePrimitives)
+{
+	float rgba[4];
+	for (std::vector<unsigned int>::const_iterator iter = tilePrimitives.begin();
+		iter != tilePrimitives.end(); ++iter)
+	{
+		const unsigned int index = (*iter) >> 2;
+		switch ((*iter) & 3)
+		{
+		case SOFTWARE_PRIMITIVE_TRIANGLE:
+		{
+			const Vertex *v = this->triangleVertices.data() + 3*index;
+			const double x0 = v[0].coordinates[0], y0 = v[0].coordinates[1];
+			const double x1 = v[1].coordinates[0], y1 = v[1].coordinates[1];
+			const double x2 = v[2].coordinates[0], y2 = v[2].coordinates[1];
+			const double area = (x1 - x0)*(y2 - y0) - (y1 - y0)*(x2 - x0);
+			if (fabs(area) < 1.0E-12)
+				break;
+			const double invArea = 1.0/area;
+			const int xMin = std::max(tileLeft, static_cast<int>(floor(std::min(x0, std::min(x1, x2)))));
+			const int xMax = std::min(tileRight - 1, static_cast<int>(floor(std::max(x0, std::max(x1, x2)))));
+			const int yMin = std::max(tileBottom, static_cast<int>(floor(std::min(y0, std::min(y1, y2)))));
+			const int yMax = std::min(tileTop - 1, static_cast<int>(floor(std::max(y0, std::max(y1, y2)))));
+			for (int y = yMin; y <= yMax; ++y)
+			{
+				const double py = y + 0.5;
+				for (int x = xMin; x <= xMax; ++x)
+				{
+					const double px = x + 0.5;
+					const double w0 = ((x2 - x1)*(py - y1) - (y2 - y1)*(px - x1))*invArea;
+					if (w0 < 0.0)
+						continue;
+					const double w1 = ((x0 - x2)*(py - y2) - (y0 - y2)*(px - x2))*invArea;
+					if (w1 < 0.0)
+						continue;
+					const double w2 = 1.0 - w0 - w1;
+					if (w2 < 0.0)
+						continue;
+					const double depth = w0*v[0].coordinates[2] + w1*v[1].coordinates[2] + w2*v[2].coordinates[2];
+					for (int i = 0; i < 4; ++i)
+						rgba[i] = static_cast<float>(w0*v[0].rgba[i] + w1*v[1].rgba[i] + w2*v[2].rgba[i]);
+					this->writeFragment(x, y, depth, rgba);
+				}
+			}
+		} break;
+		case SOFTWARE_PRIMITIVE_LINE:
+		{
+			const Vertex *v = this->lineVertices.data() + 2*index;
+			const double dx = v[1].coordinates[0] - v[0].coordinates[0];
+			const double dy = v[1].coordinates[1] - v[0].coordinates[1];
+			const int steps = static_cast<int>(ceil(std::max(fabs(dx), fabs(dy))));
+			for (int s = 0; s <= steps; ++s)
+			{
+				const double xi = (steps > 0) ? static_cast<double>(s)/steps : 0.0;
+				const int x = static_cast<int>(floor(v[0].coordinates[0] + xi*dx));
+				const int y = static_cast<int>(floor(v[0].coordinates[1] + xi*dy));
+				if ((x < tileLeft) || (x >= tileRight) || (y < tileBottom) || (y >= tileTop))
+					continue;
+				const double depth = v[0].coordinates[2] +
+					xi*(v[1].coordinates[2] - v[0].coordinates[2]) - SOFTWARE_LINE_DEPTH_OFFSET;
+				for (int i = 0; i < 4; ++i)
+					rgba[i] = v[0].rgba[i] + static_cast<float>(xi)*(v[1].rgba[i] - v[0].rgba[i]);
+				this->writeFragment(x, y, depth, rgba);
+			}
+		} break;
+		case SOFTWARE_PRIMITIVE_POINT:
+		{
+			const Vertex& v = this->pointVertices[index];
+			const int x = static_cast<int>(floor(v.coordinates[0]));
+			const int y = static_cast<int>(floor(v.coordinates[1]));
+			if ((x >= tileLeft) && (x < tileRight) && (y >= tileBottom) && (y < tileTop))
+				this->writeFragment(x, y, v.coordinates[2] - SOFTWARE_LINE_DEPTH_OFFSET, v.rgba);
+		} break;
+		}
+	}
+}
+
+int Render_graphics_software::rasterise(unsigned char *pixels)
+{
+	if (!((pixels) && (0 < this->width) && (0 < this->height)))
+	{
+		display_message(ERROR_MESSAGE, "Render_graphics_software::rasterise.  Invalid argument(s)");
+		return 0;
+	}
+	const int pixelCount = this->width*this->height;
+	this->colourBuffer.resize(4*pixelCount);
+	for (int p = 0; p < pixelCount; ++p)
+		for (int i = 0; i < 4; ++i)
+			this->colourBuffer[4*p + i] = this->backgroundColour[i];
+	this->depthBuffer.assign(pixelCount, 1.0f);
+
+	// bin primitives into tiles, preserving submission order within each tile
+	const int tilesX = (this->width + SOFTWARE_TILE_SIZE - 1)/SOFTWARE_TILE_SIZE;
+	const int tilesY = (this->height + SOFTWARE_TILE_SIZE - 1)/SOFTWARE_TILE_SIZE;
+	const int tileCount = tilesX*tilesY;
+	std::vector<std::vector<unsigned int> > tilePrimitives(tileCount);
+	for (std::vector<unsigned int>::const_iterator iter = this->primitives.begin();
+		iter != this->primitives.end(); ++iter)
+	{
+		const unsigned int index = (*iter) >> 2;
+		const Vertex *v = 0;
+		int count = 0;
+		switch ((*iter) & 3)
+		{
+		case SOFTWARE_PRIMITIVE_TRIANGLE:
+			v = this->triangleVertices.data() + 3*index;
+			count = 3;
+			break;
+		case SOFTWARE_PRIMITIVE_LINE:
+			v = this->lineVertices.data() + 2*index;
+			count = 2;
+			break;
+		default:
+			v = this->pointVertices.data() + index;
+			count = 1;
+			break;
+		}
+		double xMin = v[0].coordinates[0], xMax = xMin;
+		double yMin = v[0].coordinates[1], yMax = yMin;
+		for (int i = 1; i < count; ++i)
+		{
+			xMin = std::min(xMin, v[i].coordinates[0]);
+			xMax = std::max(xMax, v[i].coordinates[0]);
+			yMin = std::min(yMin, v[i].coordinates[1]);
+			yMax = std::max(yMax, v[i].coordinates[1]);
+		}
+		if ((xMax < 0.0) || (yMax < 0.0) || (xMin >= this->width) || (yMin >= this->height))
+			continue;
+		const int tx0 = std::max(0, static_cast<int>(floor(xMin))/SOFTWARE_TILE_SIZE);
+		const int tx1 = std::min(tilesX - 1, static_cast<int>(floor(xMax))/SOFTWARE_TILE_SIZE);
+		const int ty0 = std::max(0, static_cast<int>(floor(yMin))/SOFTWARE_TILE_SIZE);
+		const int ty1 = std::min(tilesY - 1, static_cast<int>(floor(yMax))/SOFTWARE_TILE_SIZE);
+		for (int ty = ty0; ty <= ty1; ++ty)
+			for (int tx = tx0; tx <= tx1; ++tx)
+				tilePrimitives[ty*tilesX + tx].push_back(*iter);
+	}
+
+	CMZN::parallel_for(0, tileCount, CMZN::parallel_get_thread_count(tileCount, this->numberOfThreads),
+		[&](int, size_t tile)
+		{
+			if (tilePrimitives[tile].empty())
+				return;
+			const int tx = static_cast<int>(tile) % tilesX;
+			const int ty = static_cast<int>(tile) / tilesX;
+			this->rasteriseTile(tx*SOFTWARE_TILE_SIZE, ty*SOFTWARE_TILE_SIZE,
+				std::min(this->width, (tx + 1)*SOFTWARE_TILE_SIZE),
+				std::min(this->height, (ty + 1)*SOFTWARE_TILE_SIZE), tilePrimitives[tile]);
+		});
+
+	for (int i = 0; i < 4*pixelCount; ++i)
+	{
+		const float value = std::max(0.0f, std::min(1.0f, this->colourBuffer[i]));
+		pixels[i] = static_cast<unsigned char>(value*255.0f + 0.5f);
+	}
+	return 1;
+}
+
+int Scene_render_software(cmzn_scene *scene, cmzn_scenefilter *filter,
+	int width, int height, const double *windowProjectionMatrix,
+	const double *modelviewMatrix, const double *backgroundRgba,
+	int numberOfThreads, unsigned char *pixels)
+{
+	if (!((scene) && (0 < width) && (0 < height) && (windowProjectionMatrix) &&
+		(modelviewMatrix) && (backgroundRgba) && (pixels)))
+	{
+		display_message(ERROR_MESSAGE, "Scene_render_software.  Invalid argument(s)");
+		return 0;
+	}
+	Render_graphics_software renderer(width, height, windowProjectionMatrix,
+		modelviewMatrix, backgroundRgba, numberOfThreads);
+	if (!renderer.Scene_compile(scene, filter))
+		return 0;
+	if (!renderer.Scene_tree_execute(scene))
+		return 0;
+	return renderer.rasterise(pixels);
+}
@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ * render_software.hpp
+ * Renderer rasterising graphics to pixels on the CPU, without a graphics library.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (RENDER_SOFTWARE_HPP)
+#define RENDER_SOFTWARE_HPP
+
+#include <vector>
+#include "graphics/graphics_object.h"
+#include "graphics/render.hpp"
+
+/**
+ * Renderer that rasterises triangles, lines and points from graphics vertex
+ * arrays into an RGBA image in memory using a depth buffer, so images can be
+ * produced on machines without an OpenGL context. Colours are from the
+ * material diffuse colour or spectrum, with a simple headlight on surfaces.
+ * The image is divided into tiles which are rasterised in parallel.
+ */
+class Render_graphics_software : public Render_graphics_build_objects
+{
+public:
+	/** Vertex in clip coordinates, or window pixel x, y and depth 0..1 after
+	 * clipping, with colour. */
+	struct Vertex
+	{
+		double coordinates[4];
+		float rgba[4];
+	};
+
+private:
+	int width, height;
+	int numberOfThreads;
+	/* window projection and modelview matrices, OpenGL style column major */
+	double windowProjectionMatrix[16];
+	double modelviewMatrix[16];
+	/* current transformation from object to eye coordinates, column major */
+	double objectToEyeMatrix[16];
+	/* current transformation from object to clip coordinates, column major */
+	double objectToClipMatrix[16];
+	float backgroundColour[4];
+	bool perspective;
+	/* set when graphics are in normalised window coordinates */
+	bool windowCoordinates;
+	/* transformation from top scene to world coordinates of current scene, column major */
+	double sceneToWorldMatrix[16];
+	/* vertices after clipping, in window pixel coordinates */
+	std::vector<Vertex> triangleVertices;
+	std::vector<Vertex> lineVertices;
+	std::vector<Vertex> pointVertices;
+	/* submission order of primitives: index << 2 | type */
+	std::vector<unsigned int> primitives;
+	std::vector<float> colourBuffer;
+	std::vector<float> depthBuffer;
+
+	void setObjectTransformation(const double *objectToWorld);
+
+	void transformVertex(const GLfloat *position, int valuesPerVertex,
+		const float *rgba, Vertex& vertex) const;
+
+	void transformEyeVertex(const GLfloat *position, int valuesPerVertex,
+		double *eye) const;
+
+	void addWindowVertex(const Vertex& vertex, std::vector<Vertex>& vertices);
+
+	void addTriangle(const GLfloat *position1, const GLfloat *position2,
+		const GLfloat *position3, int valuesPerVertex,
+		const float *rgba1, const float *rgba2, const float *rgba3);
+
+	void addLine(const GLfloat *position1, const GLfloat *position2,
+		int valuesPerVertex, const float *rgba1, const float *rgba2);
+
+	void addPoint(const GLfloat *position, int valuesPerVertex, const float *rgba);
+
+	int executeObject(GT_object *object, const double *objectToWorld,
+		const float *overrideRgba);
+
+	inline void writeFragment(int x, int y, double depth, const float *rgba);
+
+	void rasteriseTile(int tileLeft, int tileBottom, int tileRight, int tileTop,
+		const std::vector<unsigned int>& tilePrimitives);
+
+	int executeSceneTree(cmzn_scene *scene);
+
+public:
+	/**
+	 * @param widthIn  Width of image in pixels.
+	 * @param heightIn  Height of image in pixels.
+	 * @param windowProjectionMatrixIn  Column major matrix from eye to clip
+	 * coordinates filling the window.
+	 * @param modelviewMatrixIn  Column major matrix from world to eye coordinates.
+	 * @param backgroundRgba  Background colour, 4 components 0 to 1.
+	 * @param numberOfThreadsIn  Number of threads to rasterise with, or 0 to
+	 * use the hardware concurrency.
+	 */
+	Render_graphics_software(int widthIn, int heightIn,
+		const double *windowProjectionMatrixIn, const double *modelviewMatrixIn,
+		const double *backgroundRgba, int numberOfThreadsIn);
+
+	virtual ~Render_graphics_software()
+	{
+	}
+
+	/** Collects primitives from visible graphics in scene tree. */
+	virtual int Scene_tree_execute(cmzn_scene *scene);
+
+	virtual int Graphics_execute(cmzn_graphics *graphics);
+
+	virtual int Graphics_object_execute(GT_object *graphics_object);
+
+	/**
+	 * Rasterise primitives collected by Scene_tree_execute.
+	 * @param pixels  Array of width*height*4 bytes to receive RGBA values,
+	 * stored in rows from the bottom to top of the image.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int rasterise(unsigned char *pixels);
+};
+
+/**
+ * Builds and renders graphics for scene tree into RGBA pixels with the
+ * software renderer.
+ * @see Render_graphics_software
+ * @param pixels  Array of width*height*4 bytes to receive RGBA values,
+ * stored in rows from the bottom to top of the image.
+ * @return  1 on success, 0 on failure.
+ */
+int Scene_render_software(cmzn_scene *scene, cmzn_scenefilter *filter,
+	int width, int height, const double *windowProjectionMatrix,
+	const double *modelviewMatrix, const double *backgroundRgba,
+	int numberOfThreads, unsigned char *pixels);
+
+#endif /* !defined (RENDER_SOFTWARE_HPP) */
@@ -182,7 +182,9 @@ cmzn_scene::cmzn_scene(cmzn_region *regionIn, cmzn_graphics_module *graphicsmodu
 	selectionChanged(false),
 	selectionnotifier_list(0),
 	editorCopy(false),
-	access_count(1)
+	access_count(1),
+	levelOfDetailCacheBudget(GraphicsLevelOfDetailCache::defaultMemoryBudgetMegabytes),
+	levelOfDetailCacheMaximumLevels(GraphicsLevelOfDetailCache::defaultMaximumEntries)
 {
 }
 
@@ -506,6 +508,26 @@ int cmzn_scene::evaluateTransformationMatrixFromField()
 	return return_code;
 }
 
+int cmzn_scene::setLevelOfDetailCacheBudget(int budget)
+{
+	if (budget <= 0)
+		return CMZN_ERROR_ARGUMENT;
+	this->levelOfDetailCacheBudget = budget;
+	FOR_EACH_OBJECT_IN_LIST(cmzn_graphics)(cmzn_graphics_update_level_of_detail_cache_limits,
+		(void *)0, this->list_of_graphics);
+	return CMZN_OK;
+}
+
+int cmzn_scene::setLevelOfDetailCacheMaximumLevels(int maximumLevels)
+{
+	if (maximumLevels < 0)
+		return CMZN_ERROR_ARGUMENT;
+	this->levelOfDetailCacheMaximumLevels = maximumLevels;
+	FOR_EACH_OBJECT_IN_LIST(cmzn_graphics)(cmzn_graphics_update_level_of_detail_cache_limits,
+		(void *)0, this->list_of_graphics);
+	return CMZN_OK;
+}
+
 void cmzn_scene::transformationChange()
 {
 	if (this->transformation_callback_list)
@@ -1025,7 +1047,10 @@ static int cmzn_scene_build_graphics_objects(
 			for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++i)
 			{
 				graphics_to_object_data.top_level_number_in_xi[i] = 0;
+				graphics_to_object_data.top_level_minimum_number_in_xi[i] = 0;
 			}
+			graphics_to_object_data.adaptive_tolerance = 0.0;
+			graphics_to_object_data.streamline_tracker = 0;
 			return_code = FOR_EACH_OBJECT_IN_LIST(cmzn_graphics)(
 				cmzn_graphics_to_graphics_object, (void *) &graphics_to_object_data,
 				scene->list_of_graphics);
@@ -2019,6 +2044,36 @@ int cmzn_scene_set_visibility_flag(struct cmzn_scene *scene,
 	return CMZN_ERROR_ARGUMENT;
 }
 
+int cmzn_scene_get_level_of_detail_cache_budget(cmzn_scene_id scene)
+{
+	if (scene)
+		return scene->getLevelOfDetailCacheBudget();
+	return 0;
+}
+
+int cmzn_scene_set_level_of_detail_cache_budget(cmzn_scene_id scene,
+	int budget_megabytes)
+{
+	if (scene)
+		return scene->setLevelOfDetailCacheBudget(budget_megabytes);
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_scene_get_level_of_detail_cache_maximum_levels(cmzn_scene_id scene)
+{
+	if (scene)
+		return scene->getLevelOfDetailCacheMaximumLevels();
+	return 0;
+}
+
+int cmzn_scene_set_level_of_detail_cache_maximum_levels(cmzn_scene_id scene,
+	int maximum_levels)
+{
+	if (scene)
+		return scene->setLevelOfDetailCacheMaximumLevels(maximum_levels);
+	return CMZN_ERROR_ARGUMENT;
+}
+
 int cmzn_scene_is_visible_hierarchical(
 	struct cmzn_scene *scene)
 {
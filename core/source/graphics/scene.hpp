@@ -72,6 +72,8 @@ struct cmzn_scene
 	int access_count;
 
 private:
+	int levelOfDetailCacheBudget;
+	int levelOfDetailCacheMaximumLevels;
 	SceneCoordinateFieldWrapperMap coordinateFieldWrappers;
 	SceneVectorFieldWrapperMap vectorFieldWrappers;
 
@@ -167,6 +169,27 @@ public:
 	  * @return  Result OK on success, any other value on failure */
 	int evaluateTransformationMatrixFromField();
 
+	/** @return  Maximum megabytes of graphics objects each graphics keeps for
+	 * other levels of detail. */
+	int getLevelOfDetailCacheBudget() const
+	{
+		return this->levelOfDetailCacheBudget;
+	}
+
+	/** @param budget  Maximum megabytes to keep, > 0.
+	 * @return  Result OK on success, otherwise ERROR_ARGUMENT. */
+	int setLevelOfDetailCacheBudget(int budget);
+
+	/** @return  Maximum number of other levels of detail each graphics keeps. */
+	int getLevelOfDetailCacheMaximumLevels() const
+	{
+		return this->levelOfDetailCacheMaximumLevels;
+	}
+
+	/** @param maximumLevels  Maximum number of levels to keep, >= 0.
+	 * @return  Result OK on success, otherwise ERROR_ARGUMENT. */
+	int setLevelOfDetailCacheMaximumLevels(int maximumLevels);
+
 	bool isEditorCopy() const
 	{
 		return this->editorCopy;
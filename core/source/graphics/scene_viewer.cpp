@@ -56,6 +56,7 @@ November 97 Created from rendering part of Drawing.
 #include "three_d_drawing/graphics_buffer.h"
 #include "interaction/interactive_event.h"
 #include "graphics/render_gl.h"
+#include "graphics/render_software.hpp"
 #include "graphics/scene_coordinate_system.hpp"
 #include <algorithm>
 
@@ -729,6 +730,190 @@ DESCRIPTION :
 	return (return_code);
 } /* Scene_viewer_render_background_texture */
 
+/**
+ * Calculates the projection, window projection and modelview matrices for the
+ * scene_viewer onto a viewport of viewport_width x viewport_height pixels,
+ * without reference to any graphics library. Matrices are stored OpenGL-style
+ * with values ordered down columns first.
+ * In CUSTOM projection mode the stored projection_matrix and modelview_matrix
+ * are returned unmodified.
+ * @see Scene_viewer_calculate_transformation
+ */
+static int Scene_viewer_calculate_transformation_matrices(
+	struct Scene_viewer *scene_viewer, int viewport_width, int viewport_height,
+	double *projection_matrix, double *window_projection_matrix,
+	double *modelview_matrix)
+{
+	if (!((scene_viewer) && (0 < viewport_width) && (0 < viewport_height) &&
+		(projection_matrix) && (window_projection_matrix) && (modelview_matrix)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Scene_viewer_calculate_transformation_matrices.  Invalid argument(s)");
+		return 0;
+	}
+	double postmultiply_matrix[16];
+	int i;
+	/* 1. calculate projection_matrix - no need in CUSTOM mode */
+	if (SCENE_VIEWER_CUSTOM != scene_viewer->projection_mode)
+	{
+		for (i = 0; i < 16; ++i)
+			projection_matrix[i] = 0.0;
+		const double left = scene_viewer->left;
+		const double right = scene_viewer->right;
+		const double bottom = scene_viewer->bottom;
+		const double top = scene_viewer->top;
+		const double near_plane = scene_viewer->near_plane;
+		const double far_plane = scene_viewer->far_plane;
+		switch (scene_viewer->projection_mode)
+		{
+			case SCENE_VIEWER_PARALLEL:
+			{
+				/* equivalent to glOrtho */
+				projection_matrix[0] = 2.0/(right - left);
+				projection_matrix[5] = 2.0/(top - bottom);
+				projection_matrix[10] = -2.0/(far_plane - near_plane);
+				projection_matrix[12] = -(right + left)/(right - left);
+				projection_matrix[13] = -(top + bottom)/(top - bottom);
+				projection_matrix[14] = -(far_plane + near_plane)/(far_plane - near_plane);
+				projection_matrix[15] = 1.0;
+			} break;
+			case SCENE_VIEWER_PERSPECTIVE:
+			{
+				/* adjust left, right, bottom, top from lookat plane to near plane */
+				const double dx = scene_viewer->eyex - scene_viewer->lookatx;
+				const double dy = scene_viewer->eyey - scene_viewer->lookaty;
+				const double dz = scene_viewer->eyez - scene_viewer->lookatz;
+				const double factor = near_plane/sqrt(dx*dx + dy*dy + dz*dz);
+				/* perspective projection equivalent to glFrustum */
+				const double l = left*factor, r = right*factor;
+				const double b = bottom*factor, t = top*factor;
+				projection_matrix[0] = 2.0*near_plane/(r - l);
+				projection_matrix[5] = 2.0*near_plane/(t - b);
+				projection_matrix[8] = (r + l)/(r - l);
+				projection_matrix[9] = (t + b)/(t - b);
+				projection_matrix[10] = -(far_plane + near_plane)/(far_plane - near_plane);
+				projection_matrix[11] = -1.0;
+				projection_matrix[14] = -2.0*far_plane*near_plane/(far_plane - near_plane);
+			} break;
+			case SCENE_VIEWER_CUSTOM:
+			{
+				/* Do nothing */
+			} break;
+		}
+	}
+	else
+	{
+		for (i = 0; i < 16; ++i)
+			projection_matrix[i] = scene_viewer->projection_matrix[i];
+	}
+
+	/* 2. calculate window_projection_matrix - all modes */
+	/* the projection matrix converts the viewing volume into the Normalised
+		 Device Coordinates (NDCs) ranging from -1 to +1 in each coordinate
+		 direction. Need to scale this range to fit the viewport/window by
+		 postmultiplying with a matrix. First start with identity: Note that
+		 numbers go down columns first in OpenGL matrices */
+	for (i=1;i<15;i++)
+	{
+		postmultiply_matrix[i] = 0.0;
+	}
+	postmultiply_matrix[ 0] = 1.0;
+	postmultiply_matrix[ 5] = 1.0;
+	postmultiply_matrix[10] = 1.0;
+	postmultiply_matrix[15] = 1.0;
+	switch (scene_viewer->viewport_mode)
+	{
+		case CMZN_SCENEVIEWER_VIEWPORT_MODE_ABSOLUTE:
+		{
+			/* absolute viewport: NDC volume is placed in the position
+				 described by the NDC_info relative to user viewport
+				 coordinates - as with the background texture */
+			postmultiply_matrix[0] *= scene_viewer->NDC_width*
+				scene_viewer->user_viewport_pixels_per_unit_x/viewport_width;
+			postmultiply_matrix[5] *= scene_viewer->NDC_height*
+				scene_viewer->user_viewport_pixels_per_unit_y/viewport_height;
+			postmultiply_matrix[12] = -1.0+
+				((scene_viewer->user_viewport_pixels_per_unit_x)/viewport_width)*
+				((scene_viewer->NDC_width)+
+					2.0*(scene_viewer->NDC_left-scene_viewer->user_viewport_left));
+			postmultiply_matrix[13] =1.0+
+				((scene_viewer->user_viewport_pixels_per_unit_y)/viewport_height)*
+				(-(scene_viewer->NDC_height)+
+					2.0*(scene_viewer->NDC_top-scene_viewer->user_viewport_top));
+		} break;
+		case CMZN_SCENEVIEWER_VIEWPORT_MODE_RELATIVE:
+		{
+			/* relative viewport: NDC volume is scaled to the largest size
+				 that can fit in the viewport without distorting its shape. Note that
+				 the NDC_height and NDC_width are all that is needed to characterise
+				 the size/shape of the NDC volume in relative mode */
+			if (scene_viewer->NDC_height/scene_viewer->NDC_width >
+				(double)viewport_height/(double)viewport_width)
+			{
+				/* make NDC represent a wider viewing volume. */
+				postmultiply_matrix[0] *= (scene_viewer->NDC_width*viewport_height/
+					(scene_viewer->NDC_height*viewport_width));
+			}
+			else
+			{
+				/* make NDC represent a taller viewing volume */
+				postmultiply_matrix[5] *= (scene_viewer->NDC_height*viewport_width/
+					(scene_viewer->NDC_width*viewport_height));
+			}
+		} break;
+		case CMZN_SCENEVIEWER_VIEWPORT_MODE_DISTORTING_RELATIVE:
+		{
+			/* distorting relative viewport: NDC volume is scaled to the largest size
+				 that can fit in the viewport. Note that
+				 the NDC_height and NDC_width are all that is needed to characterise
+				 the size/shape of the NDC volume in relative mode
+				 This is a simple no-op, as the identity matrix is sufficient to achieve this.
+			*/
+		} break;
+		case CMZN_SCENEVIEWER_VIEWPORT_MODE_INVALID:
+		{
+			display_message(ERROR_MESSAGE,
+				"Scene_viewer_calculate_transformation_matrices.  Invalid viewport mode");
+		} break;
+	}
+	multiply_matrix(4,4,4,projection_matrix,postmultiply_matrix,
+		window_projection_matrix);
+
+	/* 3. Calculate modelview_matrix - no need in CUSTOM mode */
+	if (SCENE_VIEWER_CUSTOM != scene_viewer->projection_mode)
+	{
+		/* equivalent to gluLookAt */
+		double f[3], s[3], u[3], up[3];
+		f[0] = scene_viewer->lookatx - scene_viewer->eyex;
+		f[1] = scene_viewer->lookaty - scene_viewer->eyey;
+		f[2] = scene_viewer->lookatz - scene_viewer->eyez;
+		normalize3(f);
+		up[0] = scene_viewer->upx;
+		up[1] = scene_viewer->upy;
+		up[2] = scene_viewer->upz;
+		cross_product3(f, up, s);
+		normalize3(s);
+		cross_product3(s, f, u);
+		for (i = 0; i < 3; ++i)
+		{
+			modelview_matrix[i*4    ] = s[i];
+			modelview_matrix[i*4 + 1] = u[i];
+			modelview_matrix[i*4 + 2] = -f[i];
+			modelview_matrix[i*4 + 3] = 0.0;
+		}
+		modelview_matrix[12] = -(s[0]*scene_viewer->eyex + s[1]*scene_viewer->eyey + s[2]*scene_viewer->eyez);
+		modelview_matrix[13] = -(u[0]*scene_viewer->eyex + u[1]*scene_viewer->eyey + u[2]*scene_viewer->eyez);
+		modelview_matrix[14] = f[0]*scene_viewer->eyex + f[1]*scene_viewer->eyey + f[2]*scene_viewer->eyez;
+		modelview_matrix[15] = 1.0;
+	}
+	else
+	{
+		for (i = 0; i < 16; ++i)
+			modelview_matrix[i] = scene_viewer->modelview_matrix[i];
+	}
+	return 1;
+}
+
 static int Scene_viewer_calculate_transformation(
 	struct Scene_viewer *scene_viewer, int viewport_width, int viewport_height)
 /*******************************************************************************
@@ -754,138 +939,29 @@ Note that this function makes changes to the OpenGL rendering matrices in some
 modes, so push/pop them if you want them preserved.
 ==============================================================================*/
 {
-	double dx,dy,dz,postmultiply_matrix[16],factor;
-	int return_code,i;
+	int return_code;
 
 	ENTER(Scene_viewer_calculate_transformation);
-	if (scene_viewer&&(0<viewport_width)&&(0<viewport_height))
+	double projection_matrix[16], window_projection_matrix[16], modelview_matrix[16];
+	return_code = Scene_viewer_calculate_transformation_matrices(scene_viewer,
+		viewport_width, viewport_height, projection_matrix,
+		window_projection_matrix, modelview_matrix);
+	if (return_code)
 	{
-		return_code=1;
-
-		/* 1. calculate and store projection_matrix - no need in CUSTOM mode */
-		if (SCENE_VIEWER_CUSTOM != scene_viewer->projection_mode)
-		{
-			glMatrixMode(GL_PROJECTION);
-			glLoadIdentity();
-			switch (scene_viewer->projection_mode)
-			{
-				case SCENE_VIEWER_PARALLEL:
-				{
-					glOrtho(scene_viewer->left, scene_viewer->right,
-						scene_viewer->bottom, scene_viewer->top,
-						scene_viewer->near_plane, scene_viewer->far_plane);
-				} break;
-				case SCENE_VIEWER_PERSPECTIVE:
-				{
-					/* adjust left, right, bottom, top from lookat plane to near plane */
-					dx = scene_viewer->eyex-scene_viewer->lookatx;
-					dy = scene_viewer->eyey-scene_viewer->lookaty;
-					dz = scene_viewer->eyez-scene_viewer->lookatz;
-					factor = scene_viewer->near_plane/sqrt(dx*dx+dy*dy+dz*dz);
-					/* perspective projection */
-
-					glFrustum(scene_viewer->left*factor, scene_viewer->right*factor,
-						scene_viewer->bottom*factor, scene_viewer->top*factor,
-						scene_viewer->near_plane, scene_viewer->far_plane);
-				} break;
-				case SCENE_VIEWER_CUSTOM:
-				{
-					/* Do nothing */
-				} break;
-			}
-			glGetDoublev(GL_PROJECTION_MATRIX,scene_viewer->projection_matrix);
-		}
-
-		/* 2. calculate and store window_projection_matrix - all modes */
-		/* the projection matrix converts the viewing volume into the Normalised
-			 Device Coordinates (NDCs) ranging from -1 to +1 in each coordinate
-			 direction. Need to scale this range to fit the viewport/window by
-			 postmultiplying with a matrix. First start with identity: Note that
-			 numbers go down columns first in OpenGL matrices */
-		for (i=1;i<15;i++)
-		{
-			postmultiply_matrix[i] = 0.0;
-		}
-		postmultiply_matrix[ 0] = 1.0;
-		postmultiply_matrix[ 5] = 1.0;
-		postmultiply_matrix[10] = 1.0;
-		postmultiply_matrix[15] = 1.0;
-		switch (scene_viewer->viewport_mode)
+		for (int i = 0; i < 16; ++i)
 		{
-			case CMZN_SCENEVIEWER_VIEWPORT_MODE_ABSOLUTE:
-			{
-				/* absolute viewport: NDC volume is placed in the position
-					 described by the NDC_info relative to user viewport
-					 coordinates - as with the background texture */
-				postmultiply_matrix[0] *= scene_viewer->NDC_width*
-					scene_viewer->user_viewport_pixels_per_unit_x/viewport_width;
-				postmultiply_matrix[5] *= scene_viewer->NDC_height*
-					scene_viewer->user_viewport_pixels_per_unit_y/viewport_height;
-				postmultiply_matrix[12] = -1.0+
-					((scene_viewer->user_viewport_pixels_per_unit_x)/viewport_width)*
-					((scene_viewer->NDC_width)+
-						2.0*(scene_viewer->NDC_left-scene_viewer->user_viewport_left));
-				postmultiply_matrix[13] =1.0+
-					((scene_viewer->user_viewport_pixels_per_unit_y)/viewport_height)*
-					(-(scene_viewer->NDC_height)+
-						2.0*(scene_viewer->NDC_top-scene_viewer->user_viewport_top));
-			} break;
-			case CMZN_SCENEVIEWER_VIEWPORT_MODE_RELATIVE:
-			{
-				/* relative viewport: NDC volume is scaled to the largest size
-					 that can fit in the viewport without distorting its shape. Note that
-					 the NDC_height and NDC_width are all that is needed to characterise
-					 the size/shape of the NDC volume in relative mode */
-				if (scene_viewer->NDC_height/scene_viewer->NDC_width >
-					(double)viewport_height/(double)viewport_width)
-				{
-					/* make NDC represent a wider viewing volume. */
-					postmultiply_matrix[0] *= (scene_viewer->NDC_width*viewport_height/
-						(scene_viewer->NDC_height*viewport_width));
-				}
-				else
-				{
-					/* make NDC represent a taller viewing volume */
-					postmultiply_matrix[5] *= (scene_viewer->NDC_height*viewport_width/
-						(scene_viewer->NDC_width*viewport_height));
-				}
-			} break;
-			case CMZN_SCENEVIEWER_VIEWPORT_MODE_DISTORTING_RELATIVE:
-			{
-				/* distorting relative viewport: NDC volume is scaled to the largest size
-					 that can fit in the viewport. Note that
-					 the NDC_height and NDC_width are all that is needed to characterise
-					 the size/shape of the NDC volume in relative mode
-					 This is a simple no-op, as the identity matrix is sufficient to achieve this.
-				*/
-			} break;
-			case CMZN_SCENEVIEWER_VIEWPORT_MODE_INVALID:
-			{
-				display_message(ERROR_MESSAGE,
-					"Scene_viewer_calculate_transformation.  Invalid viewport mode");
-			} break;
+			scene_viewer->projection_matrix[i] = projection_matrix[i];
+			scene_viewer->window_projection_matrix[i] = window_projection_matrix[i];
+			scene_viewer->modelview_matrix[i] = modelview_matrix[i];
 		}
-		multiply_matrix(4,4,4,scene_viewer->projection_matrix,postmultiply_matrix,
-			scene_viewer->window_projection_matrix);
-
-		/* 3. Calculate and store modelview_matrix - no need in CUSTOM mode */
 		if (SCENE_VIEWER_CUSTOM != scene_viewer->projection_mode)
 		{
+			glMatrixMode(GL_PROJECTION);
+			glLoadMatrixd(scene_viewer->projection_matrix);
 			glMatrixMode(GL_MODELVIEW);
-			glLoadIdentity();
-			gluLookAt(scene_viewer->eyex,scene_viewer->eyey,
-				scene_viewer->eyez,scene_viewer->lookatx,
-				scene_viewer->lookaty,scene_viewer->lookatz,
-				scene_viewer->upx,scene_viewer->upy,scene_viewer->upz);
-			glGetDoublev(GL_MODELVIEW_MATRIX,scene_viewer->modelview_matrix);
+			glLoadMatrixd(scene_viewer->modelview_matrix);
 		}
 	}
-	else
-	{
-		display_message(ERROR_MESSAGE,
-			"Scene_viewer_calculate_transformation.  Invalid argument(s)");
-		return_code=0;
-	}
 	LEAVE;
 
 	return (return_code);
@@ -7141,6 +7217,64 @@ Writes the view in the scene_viewer to the specified filename.
 	return (return_code);
 } /* cmzn_sceneviewer_write_image_to_file */
 
+int cmzn_sceneviewer_render_software_pixels(cmzn_sceneviewer_id scene_viewer,
+	int width, int height, unsigned char *pixels)
+{
+	if (!((scene_viewer) && (0 < width) && (0 < height) && (pixels)))
+	{
+		display_message(ERROR_MESSAGE, "cmzn_sceneviewer_render_software_pixels.  "
+			"Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	if (!scene_viewer->scene)
+		return CMZN_ERROR_ARGUMENT;
+	double projection_matrix[16], window_projection_matrix[16], modelview_matrix[16];
+	if (!Scene_viewer_calculate_transformation_matrices(scene_viewer, width, height,
+		projection_matrix, window_projection_matrix, modelview_matrix))
+		return CMZN_ERROR_GENERAL;
+	const double background_rgba[4] =
+	{
+		scene_viewer->background_colour.red,
+		scene_viewer->background_colour.green,
+		scene_viewer->background_colour.blue,
+		scene_viewer->background_colour.alpha
+	};
+	if (!Scene_render_software(scene_viewer->scene, scene_viewer->filter,
+		width, height, window_projection_matrix, modelview_matrix,
+		background_rgba, /*numberOfThreads*/0, pixels))
+		return CMZN_ERROR_GENERAL;
+	return CMZN_OK;
+}
+
+int cmzn_sceneviewer_write_image_to_file_software(cmzn_sceneviewer_id scene_viewer,
+	const char *file_name, int width, int height)
+{
+	if (!((scene_viewer) && (file_name) && (0 < width) && (0 < height)))
+	{
+		display_message(ERROR_MESSAGE, "cmzn_sceneviewer_write_image_to_file_software.  "
+			"Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	std::vector<unsigned char> pixels(4*width*height);
+	int result = cmzn_sceneviewer_render_software_pixels(scene_viewer, width, height,
+		pixels.data());
+	if (CMZN_OK != result)
+		return result;
+	Cmgui_image *cmgui_image = Cmgui_image_constitute(width, height,
+		/*number_of_components*/4, /*number_of_bytes_per_component*/1,
+		/*source_width_bytes*/4*width, pixels.data());
+	if (!cmgui_image)
+		return CMZN_ERROR_GENERAL;
+	Cmgui_image_information *cmgui_image_information = CREATE(Cmgui_image_information)();
+	Cmgui_image_information_add_file_name(cmgui_image_information,
+		(char *)file_name);
+	if (!Cmgui_image_write(cmgui_image, cmgui_image_information))
+		result = CMZN_ERROR_GENERAL;
+	DESTROY(Cmgui_image_information)(&cmgui_image_information);
+	DESTROY(Cmgui_image)(&cmgui_image);
+	return result;
+}
+
 int cmzn_sceneviewer_get_NDC_info(cmzn_sceneviewer_id scene_viewer,
 	double *NDC_left,double *NDC_top,double *NDC_width,double *NDC_height)
 /*******************************************************************************
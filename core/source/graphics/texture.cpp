@@ -22,6 +22,8 @@ The functions for manipulating graphical textures.
 #define _USE_MATH_DEFINES
 #endif // defined (WIN32_SYSTEM)
 #include <math.h>
+#include <algorithm>
+#include <vector>
 #if defined (WIN32_SYSTEM)
 #if (defined(_MSC_VER) && (_MSC_VER < 1700))
 // Added in Visual Studio 2012
@@ -51,6 +53,9 @@ long lround(double d)
 #include "general/message.h"
 #include "general/enumerator_private.hpp"
 #include "graphics/texture.hpp"
+#include "graphics/texture_brick_store.hpp"
+#include "graphics/texture_range_tree.hpp"
+#include "graphics/texture_sampler.hpp"
 #include "graphics/render_gl.h"
 
 /*
@@ -138,6 +143,15 @@ The properties of a graphical texture.
 		 information must be 4-byte aligned (end of row byte padded) */
 		/*???DB.  OpenGL allows greater choice, but this will not be used */
 	unsigned char *image;
+	/* if non-NULL, accessed out-of-core store holding the texels instead of
+		 image, which is then a dummy single texel. Stored size equals original */
+	TextureBrickStore *brick_store;
+	/* CPU sampler and mip pyramid for evaluating image, built on demand and
+		discarded whenever the image changes */
+	TextureSampler *sampler;
+	/* min/max range octree over bricks of image, built on demand and
+		discarded whenever the image changes */
+	TextureRangeTree *range_tree;
 	/* OpenGL requires the width and height of textures to be in powers of 2.
 		Hence, only the original width x height contains useful image data */
 	/* stored image size in texels */
@@ -442,6 +456,23 @@ Returns the number of components used per texel for <storage> type.
 	return (return_code);
 } /* Texture_get_number_of_bytes_per_texel_from_storage_type */
 
+enum Texture_storage_type Texture_storage_type_from_number_of_components(
+	int number_of_components)
+{
+	switch (number_of_components)
+	{
+		case 1:
+			return TEXTURE_LUMINANCE;
+		case 2:
+			return TEXTURE_LUMINANCE_ALPHA;
+		case 3:
+			return TEXTURE_RGB;
+		case 4:
+			return TEXTURE_RGBA;
+	}
+	return TEXTURE_STORAGE_TYPE_INVALID;
+}
+
 #if defined (OPENGL_API)
 static int Texture_get_type_and_format_from_storage_type(
 	enum Texture_storage_type storage,int number_of_bytes_per_component,
@@ -1752,6 +1783,19 @@ static unsigned char *Texture_get_resized_image(struct Texture *texture,
 #endif /* defined (OPENGL_API) */
 
 #if defined (OPENGL_API)
+/**
+ * Discard sampler and range tree for <texture>, if any, so they are rebuilt
+ * from the current image when next needed. Must be called whenever the image
+ * changes.
+ */
+static void Texture_discard_sampler(struct Texture *texture)
+{
+	delete texture->sampler;
+	texture->sampler = nullptr;
+	delete texture->range_tree;
+	texture->range_tree = nullptr;
+}
+
 static int Texture_expand_to_power_of_two(struct Texture *texture)
 /*******************************************************************************
 LAST MODIFIED : 18 July 2006
@@ -1867,6 +1911,7 @@ storage to power of two size in each direction.
 				}
 
 				texture->image = texture_image;
+				Texture_discard_sampler(texture);
 				texture->width_texels = width;
 				texture->height_texels = height;
 				texture->depth_texels = depth;
@@ -2523,14 +2568,28 @@ Directly outputs the commands setting up the <texture>.
 		glEnable(texture_target);
 		Texture_activate_texture_target_environment(texture,
 			texture_target);
+		int power_of_two_only = 0;
+		if (texture->brick_store)
+		{
+			/* bricked textures have no image to expand; they are resampled to
+				a power of two size on upload if required */
 #if defined (GL_ARB_texture_non_power_of_two)
-		if (!Graphics_library_check_extension(GL_ARB_texture_non_power_of_two))
+			power_of_two_only = !Graphics_library_check_extension(GL_ARB_texture_non_power_of_two);
+#else /* defined (GL_ARB_texture_non_power_of_two) */
+			power_of_two_only = 1;
+#endif /* defined (GL_ARB_texture_non_power_of_two) */
+		}
+		else
 		{
+#if defined (GL_ARB_texture_non_power_of_two)
+			if (!Graphics_library_check_extension(GL_ARB_texture_non_power_of_two))
+			{
 #endif /* defined (GL_ARB_texture_non_power_of_two) */
-			Texture_expand_to_power_of_two(texture);
+				Texture_expand_to_power_of_two(texture);
 #if defined (GL_ARB_texture_non_power_of_two)
-		}
+			}
 #endif /* defined (GL_ARB_texture_non_power_of_two) */
+		}
 
 		/* make each row of the image start on a 4-byte boundary */
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
@@ -2542,8 +2601,11 @@ Directly outputs the commands setting up the <texture>.
 			(texture->compression_mode, number_of_components,
 			texture->number_of_bytes_per_component);
 
+		/* bricked textures are never tiled */
+		int no_texture_tiling = 0;
 		if (0 < (reduction_flag = Texture_get_hardware_reduction_or_tiling(texture,
-			 reductions, renderer->allow_texture_tiling, &renderer->texture_tiling)))
+			 reductions, (texture->brick_store) ? no_texture_tiling : renderer->allow_texture_tiling,
+			 &renderer->texture_tiling)))
 		{
 			reduced_image = (unsigned char *)NULL;
 			switch(reduction_flag)
@@ -2616,7 +2678,11 @@ Directly outputs the commands setting up the <texture>.
 							return_code = 0;
 						}
 					}
-					if (return_code)
+					if (return_code && texture->brick_store)
+					{
+						/* resampled from bricks below */
+					}
+					else if (return_code)
 					{
 						reduced_image = Texture_get_resized_image(texture,
 							texture->image, texture->width_texels, texture->height_texels, texture->depth_texels,
@@ -2664,6 +2730,40 @@ Directly outputs the commands setting up the <texture>.
 					}
 				} break;
 			}
+			if (return_code && texture->brick_store)
+			{
+				/* page texels in from the bricks, resampled to the rendered size */
+				int rendered_sizes[3] = { texture->rendered_width_texels,
+					texture->rendered_height_texels, texture->rendered_depth_texels };
+				if (power_of_two_only)
+				{
+					for (i = 0; i < 3; i++)
+					{
+						int size = 1;
+						while (2*size <= rendered_sizes[i])
+						{
+							size *= 2;
+						}
+						rendered_sizes[i] = size;
+					}
+				}
+				texture->rendered_width_texels = render_tile_width = rendered_sizes[0];
+				texture->rendered_height_texels = render_tile_height = rendered_sizes[1];
+				texture->rendered_depth_texels = render_tile_depth = rendered_sizes[2];
+				const size_t rendered_image_size = (size_t)rendered_sizes[2]*rendered_sizes[1]*4*
+					(((size_t)rendered_sizes[0]*texture->brick_store->getBytesPerTexel() + 3)/4);
+				if (ALLOCATE(reduced_image, unsigned char, rendered_image_size) &&
+					texture->brick_store->getResampledImage(rendered_sizes, reduced_image))
+				{
+					rendered_image = reduced_image;
+				}
+				else
+				{
+					display_message(ERROR_MESSAGE, "direct_render_Texture.  "
+						"Could not read texture %s from image bricks", texture->name);
+					return_code = 0;
+				}
+			}
 			if (return_code)
 			{
 				for (i = 0 ; return_code && (i < number_of_tiles) ; i++)
@@ -3087,6 +3187,9 @@ of all textures.
 			texture->width = 1.0;
 			/* assign image description fields */
 			texture->image_file_name = (char *)NULL;
+			texture->brick_store = nullptr;
+			texture->sampler = nullptr;
+			texture->range_tree = nullptr;
 			/* file number pattern and ranges for 3-D textures */
 			texture->file_number_pattern = (char *)NULL;
 			texture->start_file_number = 0;
@@ -3200,7 +3303,9 @@ Frees the memory for the texture and sets <*texture_address> to NULL.
 				{
 					DEALLOCATE(texture->file_number_pattern);
 				}
+				Texture_discard_sampler(texture);
 				DEALLOCATE(texture->image);
+				TextureBrickStore::deaccess(texture->brick_store);
 				if (texture->property_list)
 				{
 					DESTROY(LIST(Texture_property))(&texture->property_list);
@@ -3311,7 +3416,9 @@ int Texture_copy_image(const struct Texture *source, struct Texture *destination
 	if (source && destination)
 	{
 		const int number_of_components = Texture_storage_type_get_number_of_components(source->storage);
-		const int image_size = source->depth_texels * source->height_texels * 4 *
+		/* bricked textures share the brick store and only copy the dummy texel */
+		const int image_size = (source->brick_store) ? 4 :
+			source->depth_texels * source->height_texels * 4 *
 			((source->width_texels * number_of_components *
 				source->number_of_bytes_per_component + 3)/4);
 		unsigned char *destination_image;
@@ -3319,8 +3426,15 @@ int Texture_copy_image(const struct Texture *source, struct Texture *destination
 			destination->image, unsigned char, image_size))
 		{
 			destination->image = destination_image;
+			Texture_discard_sampler(destination);
 			/* use memcpy to copy the image data - should be fastest method */
 			memcpy((void *)destination->image, (void *)source->image, image_size);
+			if (source->brick_store != destination->brick_store)
+			{
+				TextureBrickStore::deaccess(destination->brick_store);
+				if (source->brick_store)
+					destination->brick_store = source->brick_store->access();
+			}
 		}
 		else
 		{
@@ -3857,6 +3971,12 @@ int Texture_allocate_image(struct Texture *texture,
 		bytes_per_pixel = number_of_components * number_of_bytes_per_component;
 		padded_width_bytes = 4*((width*bytes_per_pixel + 3)/4);
 
+		if (texture->brick_store)
+		{
+			/* discard out-of-core texels; image is only a dummy texel */
+			TextureBrickStore::deaccess(texture->brick_store);
+			texture->original_width_texels = 0;
+		}
 		// avoid allocation if already correct size
 		if ((texture->original_width_texels != width) ||
 			(texture->original_height_texels != height) ||
@@ -3882,6 +4002,7 @@ int Texture_allocate_image(struct Texture *texture,
 		}
 		if (return_code)
 		{
+			Texture_discard_sampler(texture);
 			/* assign values in the texture */
 			texture->dimension = dimension;
 			texture->storage = storage;
@@ -3933,6 +4054,7 @@ int Texture_set_storage_type(struct Texture *texture, enum Texture_storage_type
 {
 	if (texture && (0 == texture->image_file_name))
 	{
+		Texture_discard_sampler(texture);
 		texture->storage = storage_type;
 		return CMZN_OK;
 	}
@@ -3963,8 +4085,28 @@ Up to the calling function to DESTROY the returned Cmgui_image.
 		return_code = 1;
 		width_bytes = 4*((texture->width_texels*bytes_per_pixel + 3)/4);
 		source = texture->image;
+		std::vector<unsigned char> brick_plane;
+		if (texture->brick_store)
+		{
+			/* read each plane from the bricks in turn */
+			width_bytes = texture->width_texels*bytes_per_pixel;
+			brick_plane.resize((size_t)width_bytes*texture->height_texels);
+		}
 		for (i = 0; (i < texture->original_depth_texels) && return_code; i++)
 		{
+			if (texture->brick_store)
+			{
+				const int start[3] = { 0, 0, i };
+				const int block_sizes[3] = { texture->width_texels, texture->height_texels, 1 };
+				if (!texture->brick_store->getBlock(start, block_sizes, brick_plane.data()))
+				{
+					display_message(ERROR_MESSAGE,
+						"Texture_get_image.  Could not read image bricks");
+					return_code = 0;
+					break;
+				}
+				source = brick_plane.data();
+			}
 			next_cmgui_image = Cmgui_image_constitute(
 				texture->original_width_texels, texture->original_height_texels,
 				number_of_components, texture->number_of_bytes_per_component,
@@ -4145,8 +4287,10 @@ positive. Cropping is not available in the depth direction.
 				texture->width_texels = texture_width;
 				texture->height_texels = texture_height;
 				texture->depth_texels = texture_depth;
+				Texture_discard_sampler(texture);
 				DEALLOCATE(texture->image);
 				texture->image = texture_image;
+				TextureBrickStore::deaccess(texture->brick_store);
 				if (texture->image_file_name)
 				{
 					DEALLOCATE(texture->image_file_name);
@@ -4235,7 +4379,7 @@ in size.
 		(0 < (bytes_per_pixel =
 			number_of_components*texture->number_of_bytes_per_component)) &&
 		(width*bytes_per_pixel <= source_width_bytes) &&
-		source_pixels)
+		source_pixels && (!texture->brick_store))
 	{
 		width_bytes = 4*((texture->width_texels*bytes_per_pixel + 3)/4);
 		copy_width = width*bytes_per_pixel;
@@ -4249,7 +4393,8 @@ in size.
 			destination += width_bytes;
 			source += source_width_bytes;
 		}
-		/* display list needs to be compiled again */
+		/* sampler mip levels and display list need to be rebuilt */
+		Texture_discard_sampler(texture);
 		texture->display_list_current = TEXTURE_COMPILE_STATE_NOT_COMPILED;
 		return_code = 1;
 	}
@@ -4270,7 +4415,8 @@ int Texture_get_image_block(struct Texture *texture,
 	int bytes_per_pixel = 0, number_of_components = 0;
 	if (buffer_out)
 	{
-		if (texture && (texture->width_texels > 0) &&  (texture->height_texels > 0) &&
+		if (texture && (!texture->brick_store) &&
+			(texture->width_texels > 0) &&  (texture->height_texels > 0) &&
 			(texture->depth_texels > 0) &&
 			(0 < (number_of_components =
 				Texture_storage_type_get_number_of_components(texture->storage))) &&
@@ -4319,6 +4465,7 @@ int Texture_fill_image_block(struct Texture *texture, unsigned char *source_pixe
 			if (strcmp(texture->image_file_name, "user_buffer") == 0)
 			{
 				memcpy(texture->image, source_pixels, buffer_length);
+				Texture_discard_sampler(texture);
 				texture->display_list_current = TEXTURE_COMPILE_STATE_NOT_COMPILED;
 				return CMZN_OK;
 			}
@@ -4328,6 +4475,27 @@ int Texture_fill_image_block(struct Texture *texture, unsigned char *source_pixe
 	return CMZN_RESULT_ERROR_ARGUMENT;
 }
 
+unsigned char *Texture_access_image_texels(struct Texture *texture,
+	int *padded_width_bytes_address)
+{
+	int number_of_components;
+	if (texture && texture->image && (!texture->brick_store) &&
+		padded_width_bytes_address && (0 < (number_of_components =
+			Texture_storage_type_get_number_of_components(texture->storage))))
+	{
+		const int bytes_per_pixel =
+			number_of_components*texture->number_of_bytes_per_component;
+		*padded_width_bytes_address = 4*((texture->width_texels*bytes_per_pixel + 3)/4);
+		/* sampler mip levels and display list need to be rebuilt */
+		Texture_discard_sampler(texture);
+		texture->display_list_current = TEXTURE_COMPILE_STATE_NOT_COMPILED;
+		return texture->image;
+	}
+	display_message(ERROR_MESSAGE,
+		"Texture_access_image_texels.  Invalid argument(s)");
+	return 0;
+}
+
 int Texture_add_image(struct Texture *texture,
 	struct Cmgui_image *cmgui_image,
 	int crop_left, int crop_bottom, int crop_width, int crop_height)
@@ -4348,7 +4516,7 @@ Adds <cmgui_image> into <texture> making a 3D image from 2D images.
 	unsigned char *destination;
 
 	ENTER(Texture_set_image);
-	if (texture && cmgui_image &&
+	if (texture && cmgui_image && (!texture->brick_store) &&
 		(0 < (image_width = Cmgui_image_get_width(cmgui_image))) &&
 		(0 < (image_height = Cmgui_image_get_height(cmgui_image))) &&
 		(0 < (number_of_components =
@@ -4447,6 +4615,7 @@ Adds <cmgui_image> into <texture> making a 3D image from 2D images.
 				}
 
 				/* assign values in the texture */
+				Texture_discard_sampler(texture);
 				texture->image = texture_image;
 				texture->dimension = dimension;
 				/* original size is intended to specify useful part of texture */
@@ -4478,6 +4647,70 @@ Adds <cmgui_image> into <texture> making a 3D image from 2D images.
 	return (return_code);
 } /* Texture_add_image */
 
+int Texture_set_brick_store(struct Texture *texture, TextureBrickStore *brick_store,
+	const char *image_file_name)
+{
+	if (!((texture) && (brick_store)))
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_brick_store.  Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	enum Texture_storage_type storage;
+	switch (brick_store->getComponentCount())
+	{
+		case 1:
+			storage = TEXTURE_LUMINANCE;
+			break;
+		case 2:
+			storage = TEXTURE_LUMINANCE_ALPHA;
+			break;
+		case 3:
+			storage = TEXTURE_RGB;
+			break;
+		default:
+			storage = TEXTURE_RGBA;
+			break;
+	}
+	unsigned char *texture_image;
+	if (!REALLOCATE(texture_image, texture->image, unsigned char, 4))
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_brick_store.  Insufficient memory");
+		return CMZN_ERROR_MEMORY;
+	}
+	Texture_discard_sampler(texture);
+	texture->image = texture_image;
+	memset(texture_image, 0, 4);
+	if (brick_store != texture->brick_store)
+	{
+		TextureBrickStore::deaccess(texture->brick_store);
+		texture->brick_store = brick_store->access();
+	}
+	const int *sizes = brick_store->getSizes();
+	texture->dimension = (1 < sizes[2]) ? 3 : ((1 < sizes[1]) ? 2 : 1);
+	texture->storage = storage;
+	texture->number_of_bytes_per_component = brick_store->getBytesPerComponent();
+	texture->original_width_texels = texture->width_texels = sizes[0];
+	texture->original_height_texels = texture->height_texels = sizes[1];
+	texture->original_depth_texels = texture->depth_texels = sizes[2];
+	if (texture->image_file_name)
+	{
+		DEALLOCATE(texture->image_file_name);
+	}
+	if (image_file_name)
+	{
+		texture->image_file_name = duplicate_string(image_file_name);
+	}
+	texture->display_list_current = TEXTURE_COMPILE_STATE_NOT_COMPILED;
+	return CMZN_OK;
+}
+
+TextureBrickStore *Texture_get_brick_store(struct Texture *texture)
+{
+	if (texture)
+		return texture->brick_store;
+	return nullptr;
+}
+
 int Texture_get_raw_pixel_values(struct Texture *texture,int x,int y,int z,
 	unsigned char *values)
 /*******************************************************************************
@@ -4497,6 +4730,10 @@ Returns the byte values in the texture at x,y,z.
 	{
 		number_of_bytes = Texture_storage_type_get_number_of_components(texture->storage)
 			* texture->number_of_bytes_per_component;
+		if (texture->brick_store)
+		{
+			return (texture->brick_store->getTexel(x, y, z, values)) ? 1 : 0;
+		}
 		row_width_bytes=
 			((int)(texture->width_texels*number_of_bytes+3)/4)*4;
 		pixel_ptr=(unsigned char *)(texture->image);
@@ -4518,458 +4755,452 @@ Returns the byte values in the texture at x,y,z.
 	return (return_code);
 } /* Texture_get_raw_pixel_values */
 
-int Texture_get_pixel_values(struct Texture *texture,
-	ZnReal x, ZnReal y, ZnReal z, ZnReal *values)
-/*******************************************************************************
-LAST MODIFIED : 28 August 2002
-
-DESCRIPTION :
-Returns the byte values in the texture using the texture coordinates relative
-to the physical size.  Each texel is assumed to apply exactly
-at its centre and the filter_mode used to determine whether the pixels are
-interpolated or not.  When closer than half a texel to a boundary the colour
-is constant from the half texel location to the edge.
-==============================================================================*/
+int Texture_get_original_texel_block_values(struct Texture *texture,
+	const int *start, const int *block_sizes, ZnReal minimum, ZnReal maximum,
+	ZnReal *values)
 {
-	ZnReal local_xi[3], max_v, pos[3], weight, weight_i, weight_j, weight_k, v;
-	int bytes_per_pixel, component_max, dimension, i, in_border, j, k,
-		max_i, max_j, max_k, n, number_of_bytes_per_component,
-		number_of_components, original_size[3], return_code, row_width_bytes,
-		size[3];
-	long int high_offset[3], low_offset[3], offset, offset_i, offset_j, offset_k,
-		v_i, x_i, y_i, z_i;
-	unsigned char *pixel_ptr;
-	unsigned short short_value;
-
-	ENTER(Texture_get_pixel_values);
-	if (texture && values)
+	if (!((texture) && ((texture->image) || (texture->brick_store)) &&
+		(start) && (block_sizes) && (values)))
 	{
-		return_code = 1;
-		number_of_components =
-			Texture_storage_type_get_number_of_components(texture->storage);
-		number_of_bytes_per_component = texture->number_of_bytes_per_component;
-		bytes_per_pixel = number_of_components*number_of_bytes_per_component;
-		row_width_bytes=
-			((int)(texture->width_texels*bytes_per_pixel+3)/4)*4;
-
-		in_border = 0;
-		switch (texture->wrap_mode)
+		display_message(ERROR_MESSAGE,
+			"Texture_get_original_texel_block_values.  Invalid argument(s)");
+		return 0;
+	}
+	const int original_sizes[3] = { texture->original_width_texels,
+		texture->original_height_texels, texture->original_depth_texels };
+	for (int i = 0; i < 3; ++i)
+	{
+		if ((start[i] < 0) || (block_sizes[i] < 1) ||
+			(start[i] + block_sizes[i] > original_sizes[i]))
 		{
-			/* SAB As far as I can tell we had actually implemented clamp_to_edge for
-				normal clamp, so it is the same. It also behaves differently to the
-			   OpenGL implementation where it uses the original_sizes.  Would be
-				able to simplify this if we allowed non-power-of-2 textures. */
-			case TEXTURE_CLAMP_WRAP:
-			case TEXTURE_CLAMP_EDGE_WRAP:
-			{
-				if ((x < 0.0) || (texture->original_width_texels <= 1))
-					x = 0.0;
-				else if (x > texture->width)
-					x = texture->original_width_texels;
-				else
-					x *= ((ZnReal)texture->original_width_texels / texture->width);
-
-				if ((y < 0.0) || (texture->original_height_texels <= 1))
-					y = 0.0;
-				else if (y > texture->height)
-					y = texture->original_height_texels;
-				else
-					y *= ((ZnReal)texture->original_height_texels / texture->height);
-
-				if ((z < 0.0) || (texture->original_depth_texels <= 1))
-					z = 0.0;
-				else if (z > texture->depth)
-					z = texture->original_depth_texels;
-				else
-					z *= ((ZnReal)texture->original_depth_texels / texture->depth);
-			} break;
-			case TEXTURE_CLAMP_BORDER_WRAP:
+			display_message(ERROR_MESSAGE,
+				"Texture_get_original_texel_block_values.  Block is outside image");
+			return 0;
+		}
+	}
+	const int number_of_components =
+		Texture_storage_type_get_number_of_components(texture->storage);
+	const int number_of_bytes_per_component = texture->number_of_bytes_per_component;
+	const int bytes_per_pixel = number_of_components*number_of_bytes_per_component;
+	const long int row_width_bytes =
+		((long int)(texture->width_texels*bytes_per_pixel + 3)/4)*4;
+	const long int plane_bytes = (long int)texture->height_texels*row_width_bytes;
+	const long int row_values = (long int)block_sizes[0]*number_of_components;
+	const ZnReal scale = (maximum - minimum)/
+		((2 == number_of_bytes_per_component) ? 65535.0 : 255.0);
+	std::vector<unsigned char> brick_row;
+	if (texture->brick_store)
+	{
+		brick_row.resize(row_values*number_of_bytes_per_component);
+	}
+	ZnReal *value = values;
+	for (int k = start[2]; k < start[2] + block_sizes[2]; ++k)
+	{
+		for (int j = start[1]; j < start[1] + block_sizes[1]; ++j)
+		{
+			const unsigned char *row;
+			if (texture->brick_store)
 			{
-				/* Technically we should be merging to the border using the
-					current filter, so this is correct for nearest but the colour
-					should blend to the border colour 1/2 a pixel outside the texture
-					for linear.  We are also doing clamp to edge for the values inside
-					the texture range rather than blending to the border colour. */
-				if ((x < 0)||(x > texture->width))
-				{
-					x = 0.0;
-					in_border = 1;
-				}
-				else if (texture->original_width_texels <= 1)
-					x = 0.0;
-				else
-					x *= ((double)texture->original_width_texels / texture->width);
-
-				if ((y < 0)||(y > texture->height))
+				const int row_start[3] = { start[0], j, k };
+				const int row_sizes[3] = { block_sizes[0], 1, 1 };
+				if (!texture->brick_store->getBlock(row_start, row_sizes, brick_row.data()))
 				{
-					y = 0.0;
-					in_border = 1;
+					display_message(ERROR_MESSAGE,
+						"Texture_get_original_texel_block_values.  Could not read image bricks");
+					return 0;
 				}
-				else if (texture->original_height_texels <= 1)
-					y = 0.0;
-				else
-					y *= ((double)texture->original_height_texels / texture->height);
-
-				if ((z < 0)||(z > texture->depth))
+				row = brick_row.data();
+			}
+			else
+			{
+				row = texture->image + k*plane_bytes + j*row_width_bytes +
+					start[0]*bytes_per_pixel;
+			}
+			if (2 == number_of_bytes_per_component)
+			{
+				for (long int i = 0; i < row_values; ++i)
 				{
-					z = 0.0;
-					in_border = 1;
+#if (1234==BYTE_ORDER)
+					const unsigned short short_value =
+						(((unsigned short)(row[2*i + 1])) << 8) + row[2*i];
+#else /* (1234==BYTE_ORDER) */
+					const unsigned short short_value =
+						(((unsigned short)(row[2*i])) << 8) + row[2*i + 1];
+#endif /* (1234==BYTE_ORDER) */
+					value[i] = minimum + (ZnReal)short_value*scale;
 				}
-				else if (texture->original_depth_texels <= 1)
-					z = 0.0;
-				else
-					z *= ((double)texture->original_depth_texels / texture->depth);
-			} break;
-			case TEXTURE_REPEAT_WRAP:
+			}
+			else
 			{
-				/* make x, y and z range from 0.0 to 1.0 over full texture size */
-				if (texture->original_width_texels <= 1)
-					x = 0.0;
-				else
+				for (long int i = 0; i < row_values; ++i)
 				{
-					x *= ((double)texture->original_width_texels /
-						(double)texture->width_texels) / texture->width;
-					x -= floor(x);
-					x *= (double)(texture->width_texels);
+					value[i] = minimum + (ZnReal)row[i]*scale;
 				}
+			}
+			value += row_values;
+		}
+	}
+	return 1;
+}
 
-				if (texture->original_height_texels <= 1)
-					y = 0.0;
-				else
-				{
-					y *= ((double)texture->original_height_texels /
-						(double)texture->height_texels) / texture->height;
-					y -= floor(y);
-					y *= (double)(texture->height_texels);
-				}
+int Texture_get_original_texel_values(struct Texture *texture,
+	ZnReal minimum, ZnReal maximum, ZnReal *values)
+{
+	if (!texture)
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_get_original_texel_values.  Invalid argument(s)");
+		return 0;
+	}
+	const int start[3] = { 0, 0, 0 };
+	const int block_sizes[3] = { texture->original_width_texels,
+		texture->original_height_texels, texture->original_depth_texels };
+	return Texture_get_original_texel_block_values(texture, start, block_sizes,
+		minimum, maximum, values);
+}
 
-				if (texture->original_depth_texels <= 1)
-					z = 0.0;
-				else
-				{
-					z *= ((double)texture->original_depth_texels /
-						(double)texture->depth_texels) / texture->depth;
-					z -= floor(z);
-					z *= (double)(texture->depth_texels);
-				}
-			} break;
-			default:
+int Texture_get_original_texel_value_interval(struct Texture *texture,
+	ZnReal minimum, ZnReal maximum, ZnReal lower, ZnReal upper,
+	int *texel_lower, int *texel_upper)
+{
+	if (!((texture) && (texel_lower) && (texel_upper)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_get_original_texel_value_interval.  Invalid argument(s)");
+		return 0;
+	}
+	const int maximum_texel = (2 == texture->number_of_bytes_per_component) ? 65535 : 255;
+	const ZnReal scale = (maximum - minimum)/(ZnReal)maximum_texel;
+	/* converted values are monotonic in the texel value, so those in range
+		form one interval; convert exactly as Texture_get_original_texel_values */
+	*texel_lower = maximum_texel + 1;
+	*texel_upper = -1;
+	for (int t = 0; t <= maximum_texel; ++t)
+	{
+		const ZnReal value = minimum + (ZnReal)t*scale;
+		if ((lower <= value) && (value <= upper))
+		{
+			if (t < *texel_lower)
 			{
-				display_message(ERROR_MESSAGE,
-					"Texture_get_pixel_values.  Unknown wrap type");
-				return_code = 0;
-			} break;
+				*texel_lower = t;
+			}
+			*texel_upper = t;
 		}
-		if (2 == number_of_bytes_per_component)
+	}
+	return 1;
+}
+
+TextureRangeTree *Texture_get_range_tree(struct Texture *texture)
+{
+	if (!texture)
+	{
+		return nullptr;
+	}
+	if (!texture->range_tree)
+	{
+		if (texture->brick_store)
 		{
-			component_max = 65535;
+			texture->range_tree = TextureRangeTree::create(texture->brick_store);
 		}
-		else
+		else if (texture->image)
 		{
-			component_max = 255;
+			const int sizes[3] = { texture->original_width_texels,
+				texture->original_height_texels, texture->original_depth_texels };
+			const int stored_sizes[3] = { texture->width_texels,
+				texture->height_texels, texture->depth_texels };
+			texture->range_tree = TextureRangeTree::create(sizes, stored_sizes,
+				Texture_storage_type_get_number_of_components(texture->storage),
+				texture->number_of_bytes_per_component, texture->image);
 		}
-		if (!in_border)
+	}
+	return texture->range_tree;
+}
+
+/**
+ * Get sampler for <texture>, creating it for the current image if needed.
+ * @return  Non-owned sampler, or nullptr if failed.
+ */
+static TextureSampler *Texture_get_sampler(struct Texture *texture)
+{
+	if (!texture->sampler)
+	{
+		if (texture->brick_store)
 		{
-			switch (texture->filter_mode)
-			{
-				case TEXTURE_LINEAR_FILTER:
-				case TEXTURE_LINEAR_MIPMAP_NEAREST_FILTER:
-				case TEXTURE_LINEAR_MIPMAP_LINEAR_FILTER:
-				{
-					dimension = texture->dimension;
-					pos[0] = x;
-					pos[1] = y;
-					pos[2] = z;
-					size[0] = texture->width_texels;
-					size[1] = texture->height_texels;
-					size[2] = texture->depth_texels;
-					offset = bytes_per_pixel;
-					switch (texture->wrap_mode)
-					{
-						case TEXTURE_CLAMP_BORDER_WRAP:
-						/* We should handle this correctly as a border clamp, but lets do something anyway */
-						case TEXTURE_CLAMP_WRAP:
-						case TEXTURE_CLAMP_EDGE_WRAP:
-						{
-							/* note we clamp to the original size; not the power-of-2 */
-							original_size[0] = texture->original_width_texels;
-							original_size[1] = texture->original_height_texels;
-							original_size[2] = texture->original_depth_texels;
-							offset = bytes_per_pixel;
-							for (i = 0; i < dimension; i++)
-							{
-								max_v = (double)original_size[i] - 0.5;
-								v = pos[i];
-								if ((0.5 <= v) && (v < max_v))
-								{
-									v_i = (long int)(v - 0.5);
-									local_xi[i] = v - 0.5 - (double)v_i;
-									low_offset[i] = v_i*offset;
-									high_offset[i] = (v_i + 1)*offset;
-								}
-								else
-								{
-									/* I think this implements clamp to edge? */
-									low_offset[i] = (long int)(original_size[i] - 1)*offset;
-									high_offset[i] = 0;
-									if (v < 0.5)
-									{
-										local_xi[i] = 1.0;
-									}
-									else
-									{
-										local_xi[i] = 0.0;
-									}
-								}
-								if (i == 0)
-								{
-									offset = row_width_bytes;
-								}
-								else
-								{
-									offset *= (long int)size[i];
-								}
-							}
-						} break;
-						case TEXTURE_MIRRORED_REPEAT_WRAP:
-						/* We should handle this correctly as a mirror, but lets do something anyway */
-						case TEXTURE_REPEAT_WRAP:
-						{
-							for (i = 0; i < dimension; i++)
-							{
-								max_v = (double)size[i] - 0.5;
-								v = pos[i];
-								if ((0.5 <= v) && (v < max_v))
-								{
-									v_i = (long int)(v - 0.5);
-									local_xi[i] = v - 0.5 - (double)v_i;
-									low_offset[i] = v_i*offset;
-									high_offset[i] = (v_i + 1)*offset;
-								}
-								else
-								{
-									low_offset[i] = (long int)(size[i] - 1)*offset;
-									high_offset[i] = 0;
-									if (v < 0.5)
-									{
-										local_xi[i] = v + 0.5;
-									}
-									else
-									{
-										local_xi[i] = v - max_v;
-									}
-								}
-								if (i == 0)
-								{
-									offset = row_width_bytes;
-								}
-								else
-								{
-									offset *= (long int)size[i];
-								}
-							}
-						} break;
-					}
+			texture->sampler = TextureSampler::create(texture->dimension, texture->brick_store);
+		}
+		else if (texture->image)
+		{
+			const int sizes[3] = { texture->original_width_texels,
+				texture->original_height_texels, texture->original_depth_texels };
+			const int stored_sizes[3] = { texture->width_texels,
+				texture->height_texels, texture->depth_texels };
+			texture->sampler = TextureSampler::create(texture->dimension, sizes, stored_sizes,
+				Texture_storage_type_get_number_of_components(texture->storage),
+				texture->number_of_bytes_per_component, texture->image);
+		}
+	}
+	return texture->sampler;
+}
 
-					max_i = 2;
-					if (1 < dimension)
-					{
-						max_j = 2;
-					}
-					else
-					{
-						max_j = 1;
-					}
-					if (2 < dimension)
-					{
-						max_k = 2;
-					}
-					else
-					{
-						max_k = 1;
-					}
+/**
+ * Get settings for sampling <texture> on CPU from its filter and wrap modes,
+ * physical size and combine colour used as border colour.
+ * @return  1 on success, 0 if modes are not supported.
+ */
+static int Texture_get_sampler_settings(struct Texture *texture,
+	TextureSampler::Settings& settings)
+{
+	switch (texture->filter_mode)
+	{
+		case TEXTURE_NEAREST_FILTER:
+		{
+			settings.filter = TextureSampler::FILTER_NEAREST;
+			settings.mipmapFilter = TextureSampler::MIPMAP_FILTER_NONE;
+		} break;
+		case TEXTURE_LINEAR_FILTER:
+		{
+			settings.filter = TextureSampler::FILTER_LINEAR;
+			settings.mipmapFilter = TextureSampler::MIPMAP_FILTER_NONE;
+		} break;
+		case TEXTURE_NEAREST_MIPMAP_NEAREST_FILTER:
+		{
+			settings.filter = TextureSampler::FILTER_NEAREST;
+			settings.mipmapFilter = TextureSampler::MIPMAP_FILTER_NEAREST;
+		} break;
+		case TEXTURE_LINEAR_MIPMAP_NEAREST_FILTER:
+		{
+			settings.filter = TextureSampler::FILTER_LINEAR;
+			settings.mipmapFilter = TextureSampler::MIPMAP_FILTER_NEAREST;
+		} break;
+		case TEXTURE_LINEAR_MIPMAP_LINEAR_FILTER:
+		{
+			settings.filter = TextureSampler::FILTER_LINEAR;
+			settings.mipmapFilter = TextureSampler::MIPMAP_FILTER_LINEAR;
+		} break;
+		default:
+		{
+			display_message(ERROR_MESSAGE,
+				"Texture_get_sampler_settings.  Unknown filter type");
+			return 0;
+		} break;
+	}
+	switch (texture->wrap_mode)
+	{
+		/* clamp was always implemented as clamp to edge on the CPU */
+		case TEXTURE_CLAMP_WRAP:
+		case TEXTURE_CLAMP_EDGE_WRAP:
+		{
+			settings.wrap = TextureSampler::WRAP_CLAMP;
+		} break;
+		case TEXTURE_CLAMP_BORDER_WRAP:
+		{
+			settings.wrap = TextureSampler::WRAP_BORDER;
+		} break;
+		case TEXTURE_REPEAT_WRAP:
+		{
+			settings.wrap = TextureSampler::WRAP_REPEAT;
+		} break;
+		case TEXTURE_MIRRORED_REPEAT_WRAP:
+		{
+			settings.wrap = TextureSampler::WRAP_MIRRORED_REPEAT;
+		} break;
+		default:
+		{
+			display_message(ERROR_MESSAGE,
+				"Texture_get_sampler_settings.  Unknown wrap type");
+			return 0;
+		} break;
+	}
+	const ZnReal physical_sizes[3] = { texture->width, texture->height, texture->depth };
+	const int original_sizes[3] = { texture->original_width_texels,
+		texture->original_height_texels, texture->original_depth_texels };
+	for (int i = 0; i < 3; i++)
+	{
+		settings.texelScales[i] = (physical_sizes[i] > 0.0) ?
+			(double)original_sizes[i] / physical_sizes[i] : 0.0;
+	}
+	/* border uses combine colour, with luminance from red */
+	settings.borderValues[0] = (texture->combine_colour).red;
+	switch (texture->storage)
+	{
+		case TEXTURE_LUMINANCE_ALPHA:
+		{
+			settings.borderValues[1] = texture->combine_alpha;
+		} break;
+		default:
+		{
+			settings.borderValues[1] = (texture->combine_colour).green;
+		} break;
+	}
+	settings.borderValues[2] = (texture->combine_colour).blue;
+	settings.borderValues[3] = texture->combine_alpha;
+	return 1;
+}
 
-					for (i = 0; i < number_of_components; i++)
-					{
-						values[i] = 0.0;
-					}
+int Texture_evaluate_pixel_values(struct Texture *texture, int point_count,
+	int coordinate_count, const double *texture_coordinates, double level_of_detail,
+	double *values)
+{
+	TextureSampler::Settings settings;
+	if (!(texture && Texture_get_sampler_settings(texture, settings)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_evaluate_pixel_values.  Invalid argument(s)");
+		return 0;
+	}
+	TextureSampler *sampler = Texture_get_sampler(texture);
+	if (!sampler)
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_evaluate_pixel_values.  Texture %s has no image", texture->name);
+		return 0;
+	}
+	return (sampler->sample(settings, point_count, coordinate_count, texture_coordinates,
+		level_of_detail, values)) ? 1 : 0;
+}
 
-					for (k = 0; k < max_k; k++)
-					{
-						if (2 < dimension)
-						{
-							if (0 == k)
-							{
-								weight_k = (1.0 - local_xi[2]);
-								offset_k = low_offset[2];
-							}
-							else
-							{
-								weight_k = local_xi[2];
-								offset_k = high_offset[2];
-							}
-						}
-						else
-						{
-							weight_k = 1.0;
-							offset_k = 0;
-						}
-						for (j = 0; j < max_j; j++)
-						{
-							if (1 < dimension)
-							{
-								if (0 == j)
-								{
-									weight_j = weight_k*(1.0 - local_xi[1]);
-									offset_j = offset_k + low_offset[1];
-								}
-								else
-								{
-									weight_j = weight_k*local_xi[1];
-									offset_j = offset_k + high_offset[1];
-								}
-							}
-							else
-							{
-								weight_j = 1.0;
-								offset_j = 0;
-							}
-							for (i = 0; i < max_i; i++)
-							{
-								if (0 == i)
-								{
-									weight_i = weight_j*(1.0 - local_xi[0]);
-									offset_i = offset_j + low_offset[0];
-								}
-								else
-								{
-									weight_i = weight_j*local_xi[0];
-									offset_i = offset_j + high_offset[0];
-								}
-								pixel_ptr = texture->image + offset_i;
-								weight = weight_i / component_max;
-								for (n = 0; n < number_of_components; n++)
-								{
-									if (2 == number_of_bytes_per_component)
-									{
-#if (1234==BYTE_ORDER)
-										short_value =
-											(((unsigned short)(*(pixel_ptr + 1))) << 8) + (*pixel_ptr);
-#else /* (1234==BYTE_ORDER) */
-										short_value =
-											(((unsigned short)(*pixel_ptr)) << 8) + (*(pixel_ptr + 1));
-#endif /* (1234==BYTE_ORDER) */
-										values[n] += (double)short_value * weight;
-									}
-									else
-									{
-										values[n] += (double)(*pixel_ptr) * weight;
-									}
-									pixel_ptr += number_of_bytes_per_component;
-								}
-							}
-						}
-					}
-				} break;
-				case TEXTURE_NEAREST_FILTER:
-				case TEXTURE_NEAREST_MIPMAP_NEAREST_FILTER:
-				{
-					x_i = (int)x;
-					y_i = (int)y;
-					z_i = (int)z;
-					if (TEXTURE_CLAMP_WRAP == texture->wrap_mode)
-					{
-						/* fix problem of value being exactly on upper boundary */
-						if (x_i == texture->original_width_texels)
-						{
-							x_i--;
-						}
-						if (y_i == texture->original_height_texels)
-						{
-							y_i--;
-						}
-						if (z_i == texture->original_depth_texels)
-						{
-							z_i--;
-						}
-					}
-					offset = (z_i*(long int)texture->height_texels + y_i)*(long int)row_width_bytes +
-						x_i*(long int)bytes_per_pixel;
-					pixel_ptr = texture->image + offset;
-					for (n = 0; n < number_of_components; n++)
-					{
-						if (2 == number_of_bytes_per_component)
-						{
-#if (1234==BYTE_ORDER)
-							short_value =
-								(((unsigned short)(*(pixel_ptr + 1))) << 8) + (*pixel_ptr);
-#else /* (1234==BYTE_ORDER) */
-							short_value =
-								(((unsigned short)(*pixel_ptr)) << 8) + (*(pixel_ptr + 1));
-#endif /* (1234==BYTE_ORDER) */
-							values[n] = (double)short_value / component_max;
-						}
-						else
-						{
-							values[n] = (double)(*pixel_ptr) / component_max;
-						}
-						pixel_ptr += number_of_bytes_per_component;
-					}
-				} break;
-				default:
-				{
-					display_message(ERROR_MESSAGE,
-						"Texture_get_pixel_values.  Unknown filter type");
-					return_code = 0;
-				}
-			}
+double Texture_get_footprint_level_of_detail(struct Texture *texture,
+	double footprint)
+{
+	TextureSampler::Settings settings;
+	if (texture && Texture_get_sampler_settings(texture, settings))
+	{
+		TextureSampler *sampler = Texture_get_sampler(texture);
+		if (sampler)
+			return sampler->getFootprintLevelOfDetail(settings, footprint);
+	}
+	return 0.0;
+}
+
+int Texture_get_coordinates_value_range(struct Texture *texture,
+	int coordinate_count, const double *minimum_coordinates,
+	const double *maximum_coordinates, double *minimum_values, double *maximum_values)
+{
+	TextureSampler::Settings settings;
+	if (!((texture) && (0 < coordinate_count) && (minimum_coordinates) &&
+		(maximum_coordinates) && (minimum_values) && (maximum_values) &&
+		Texture_get_sampler_settings(texture, settings)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_get_coordinates_value_range.  Invalid argument(s)");
+		return 0;
+	}
+	TextureRangeTree *range_tree = Texture_get_range_tree(texture);
+	if (!range_tree)
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_get_coordinates_value_range.  Texture %s has no image", texture->name);
+		return 0;
+	}
+	const int original_sizes[3] = { texture->original_width_texels,
+		texture->original_height_texels, texture->original_depth_texels };
+	int start[3] = { 0, 0, 0 };
+	int block_sizes[3] = { 1, 1, 1 };
+	/* mip levels average texels so are bounded by the whole image range */
+	bool whole_image = (settings.mipmapFilter != TextureSampler::MIPMAP_FILTER_NONE);
+	bool in_border = false;
+	for (int d = 0; (d < texture->dimension) && (!whole_image); ++d)
+	{
+		const double minimum_coordinate = (d < coordinate_count) ? minimum_coordinates[d] : 0.0;
+		const double maximum_coordinate = (d < coordinate_count) ? maximum_coordinates[d] : 0.0;
+		if (!(minimum_coordinate <= maximum_coordinate))
+		{
+			whole_image = true;
+			break;
+		}
+		const double u0 = minimum_coordinate*settings.texelScales[d];
+		const double u1 = maximum_coordinate*settings.texelScales[d];
+		if ((u0 < -1.0E9) || (u1 > 1.0E9))
+		{
+			whole_image = true;
+			break;
+		}
+		/* texels either side of texel centres are blended by linear filter */
+		int first, last;
+		if (settings.filter == TextureSampler::FILTER_LINEAR)
+		{
+			first = static_cast<int>(floor(u0 - 0.5));
+			last = static_cast<int>(floor(u1 - 0.5)) + 1;
 		}
 		else
 		{
-			/* Use border colour */
-			switch (texture->storage)
+			first = static_cast<int>(floor(u0));
+			last = static_cast<int>(floor(u1));
+		}
+		if ((first < 0) || (last >= original_sizes[d]))
+		{
+			if ((settings.wrap == TextureSampler::WRAP_REPEAT) ||
+				(settings.wrap == TextureSampler::WRAP_MIRRORED_REPEAT))
 			{
-				case TEXTURE_LUMINANCE:
-				{
-					/* Just use the red colour to be efficient */
-					values[0] = (texture->combine_colour).red;
-				} break;
-				case TEXTURE_LUMINANCE_ALPHA:
-				{
-					values[0] = (texture->combine_colour).red;
-					values[1] = texture->combine_alpha;
-				} break;
-				case TEXTURE_RGB:
-				{
-					values[0] = (texture->combine_colour).red;
-					values[1] = (texture->combine_colour).green;
-					values[2] = (texture->combine_colour).blue;
-				} break;
-				case TEXTURE_RGBA:
-				{
-					values[0] = (texture->combine_colour).red;
-					values[1] = (texture->combine_colour).green;
-					values[2] = (texture->combine_colour).blue;
-					values[3] = texture->combine_alpha;
-				} break;
-				default:
-				{
-					display_message(ERROR_MESSAGE,  "Texture_get_pixel_values.  "
-						"Border code not implemented for texture storage.");
-					return_code = 0;
-				} break;
+				whole_image = true;
+				break;
 			}
+			if ((settings.wrap == TextureSampler::WRAP_BORDER) &&
+				((u0 < 0.0) || (u1 > original_sizes[d])))
+			{
+				in_border = true;
+			}
+			first = std::min(std::max(first, 0), original_sizes[d] - 1);
+			last = std::min(std::max(last, 0), original_sizes[d] - 1);
 		}
+		start[d] = first;
+		block_sizes[d] = last - first + 1;
 	}
-	else
+	const double scale = 1.0/(double)range_tree->getMaximumTexelValue();
+	const int number_of_components = range_tree->getComponentCount();
+	for (int c = 0; c < number_of_components; ++c)
+	{
+		int texel_minimum, texel_maximum;
+		if (whole_image)
+		{
+			range_tree->getRange(c, texel_minimum, texel_maximum);
+		}
+		else
+		{
+			range_tree->getBlockRange(c, start, block_sizes, texel_minimum, texel_maximum);
+		}
+		/* widened to cover rounding in sampled values */
+		minimum_values[c] = scale*texel_minimum - 1.0E-12;
+		maximum_values[c] = scale*texel_maximum + 1.0E-12;
+		if (in_border || (whole_image && (settings.wrap == TextureSampler::WRAP_BORDER)))
+		{
+			minimum_values[c] = std::min(minimum_values[c], settings.borderValues[c]);
+			maximum_values[c] = std::max(maximum_values[c], settings.borderValues[c]);
+		}
+	}
+	return 1;
+}
+
+int Texture_get_pixel_values(struct Texture *texture,
+	ZnReal x, ZnReal y, ZnReal z, ZnReal *values)
+/*******************************************************************************
+LAST MODIFIED : 28 August 2002
+
+DESCRIPTION :
+Returns the byte values in the texture using the texture coordinates relative
+to the physical size.  Each texel is assumed to apply exactly
+at its centre and the filter_mode used to determine whether the pixels are
+interpolated or not.  When closer than half a texel to a boundary the colour
+is constant from the half texel location to the edge.
+==============================================================================*/
+{
+	const double texture_coordinates[3] = { x, y, z };
+	double texel_values[4];
+	if (!(texture && values))
 	{
 		display_message(ERROR_MESSAGE,
 			"Texture_get_pixel_values.  Invalid arguments");
-		return_code = 0;
+		return 0;
 	}
-	LEAVE;
-
-	return (return_code);
+	if (!Texture_evaluate_pixel_values(texture, 1, 3, texture_coordinates, 0.0, texel_values))
+		return 0;
+	const int number_of_components =
+		Texture_storage_type_get_number_of_components(texture->storage);
+	for (int i = 0; i < number_of_components; i++)
+	{
+		values[i] = texel_values[i];
+	}
+	return 1;
 } /* Texture_get_pixel_values */
 
 char *Texture_get_image_file_name(struct Texture *texture)
@@ -5127,6 +5358,7 @@ int Texture_set_number_of_bytes_per_component(struct Texture *texture,
 	if ((texture && (0 == texture->image_file_name)) &&
 			((number_of_bytes == 1) || (number_of_bytes ==2 )))
 	{
+		Texture_discard_sampler(texture);
 		texture->number_of_bytes_per_component = number_of_bytes;
 		return 1;
 	}
@@ -268,6 +268,13 @@ DESCRIPTION :
 Returns the number of components used per texel for <storage> type.
 ==============================================================================*/
 
+/**
+ * @return  Storage type with 1 to 4 components in the order used by images:
+ * luminance, luminance alpha, RGB or RGBA, or TEXTURE_STORAGE_TYPE_INVALID.
+ */
+enum Texture_storage_type Texture_storage_type_from_number_of_components(
+	int number_of_components);
+
 int Texture_get_combine_alpha(struct Texture *texture,ZnReal *alpha);
 /*******************************************************************************
 LAST MODIFIED : 13 February 1998
@@ -468,6 +475,19 @@ int Texture_fill_image_block(struct Texture *texture, unsigned char *source_pixe
 int Texture_get_image_block(struct Texture *texture,
 		const void **buffer_out, unsigned int *buffer_length_out);
 
+/**
+ * Get writable access to the texels of the in-memory texture image, for
+ * readers filling an image just allocated with Texture_allocate_image in
+ * place. Depth planes follow each other, each with rows from bottom to top
+ * padded to a multiple of 4 bytes. Discards samplers and display lists
+ * built from the previous texels; do not evaluate or render the texture while
+ * texels are being written.
+ * @param padded_width_bytes_address  On success receives bytes per row.
+ * @return  Pointer to first texel, or 0 if texture has no in-memory image.
+ */
+unsigned char *Texture_access_image_texels(struct Texture *texture,
+	int *padded_width_bytes_address);
+
 int Texture_add_image(struct Texture *texture,
 	struct Cmgui_image *cmgui_image,
 	int crop_left, int crop_bottom, int crop_width, int crop_height);
@@ -489,6 +509,42 @@ DESCRIPTION :
 Returns the byte values in the texture at x,y,z.
 ==============================================================================*/
 
+/**
+ * Converts all texels of the original image in <texture> to real values in one
+ * pass, scaling each component from the range [0,1] to [minimum,maximum].
+ * Values are the same as sampling at texel centres with Texture_get_pixel_values,
+ * up to rounding, but without interpolation or wrapping.
+ * @param values  Array to receive original_width*original_height*
+ * original_depth*number_of_components values, x varying fastest and
+ * components interleaved.
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_get_original_texel_values(struct Texture *texture,
+	ZnReal minimum, ZnReal maximum, ZnReal *values);
+
+/**
+ * Converts texels of the original image in <texture> in a block to real
+ * values, as for Texture_get_original_texel_values.
+ * @param start  Index of first texel in block in x, y, z.
+ * @param block_sizes  Number of texels in block in x, y, z, within image.
+ * @param values  Array to receive block_sizes[0]*block_sizes[1]*block_sizes[2]*
+ * number_of_components values, x varying fastest and components interleaved.
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_get_original_texel_block_values(struct Texture *texture,
+	const int *start, const int *block_sizes, ZnReal minimum, ZnReal maximum,
+	ZnReal *values);
+
+/**
+ * Gets the interval of raw texel values of <texture> which, converted to real
+ * values exactly as by Texture_get_original_texel_values, lie from <lower> to
+ * <upper> inclusive. The interval is empty if <texel_lower> > <texel_upper>.
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_get_original_texel_value_interval(struct Texture *texture,
+	ZnReal minimum, ZnReal maximum, ZnReal lower, ZnReal upper,
+	int *texel_lower, int *texel_upper);
+
 int Texture_get_pixel_values(struct Texture *texture,
 	double x, double y, double z, double *values);
 /*******************************************************************************
@@ -502,6 +558,51 @@ interpolated or not.  When closer than half a texel to a boundary the colour
 is constant from the half texel location to the edge. 
 ==============================================================================*/
 
+/**
+ * Evaluates the component values of <texture> at <point_count> texture
+ * coordinates in one call, with samplers specialised for the storage, filter
+ * and wrap modes. Mipmap filter modes sample from a mip pyramid built on
+ * demand, held in memory until the image changes.
+ * @param coordinate_count  Number of texture coordinates per point, 1 to 3.
+ * @param texture_coordinates  Coordinates relative to the physical size for
+ * each point in turn.
+ * @param level_of_detail  Mip level sampled with mipmap filter modes, where 0
+ * is full resolution and each level halves it. Fractions blend levels with
+ * the linear mipmap filter. Ignored by other filter modes.
+ * @param values  Array to receive number_of_components values in [0,1] for
+ * each point in turn.
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_evaluate_pixel_values(struct Texture *texture, int point_count,
+	int coordinate_count, const double *texture_coordinates, double level_of_detail,
+	double *values);
+
+/**
+ * @return  Level of detail at which one texel of <texture> spans <footprint>
+ * in texture coordinates along its most minified direction, or 0 if the
+ * footprint is no larger than a texel or on error.
+ */
+double Texture_get_footprint_level_of_detail(struct Texture *texture,
+	double footprint);
+
+/**
+ * Gets a conservative range of each component of <texture> sampled anywhere
+ * within a box of texture coordinates, using a min/max octree over bricks of
+ * the image built on demand and held until the image changes. Ranges include
+ * texels blended by the filter mode and border colour if reached, and are
+ * over the whole image for mipmap filter modes or if repeat wrapping applies.
+ * @param coordinate_count  Number of texture coordinates, 1 to 3. Missing
+ * coordinates are taken as 0.
+ * @param minimum_coordinates, maximum_coordinates  Box of coordinates relative
+ * to the physical size.
+ * @param minimum_values, maximum_values  Arrays to receive number_of_components
+ * values in [0,1].
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_get_coordinates_value_range(struct Texture *texture,
+	int coordinate_count, const double *minimum_coordinates,
+	const double *maximum_coordinates, double *minimum_values, double *maximum_values);
+
 char *Texture_get_image_file_name(struct Texture *texture);
 /*******************************************************************************
 LAST MODIFIED : 8 February 2002
@@ -10,6 +10,8 @@
 #define TEXTURE_HPP
 
 class Render_graphics_opengl;
+class TextureBrickStore;
+class TextureRangeTree;
 
 #include <general/callback_class.hpp>
 
@@ -38,4 +40,27 @@ int Texture_compile_opengl_display_list(struct Texture *texture,
 int Texture_execute_opengl_display_list(struct Texture *texture,
 	Render_graphics_opengl *renderer);
 
+/**
+ * Make <texture> use texels paged in on demand from <brick_store>, freeing any
+ * in-memory image. The texture size and storage are set from the brick store.
+ * @param brick_store  Brick store to access.
+ * @param image_file_name  Optional name of file the image came from.
+ * @return  CMZN_OK on success, any other value on failure.
+ */
+int Texture_set_brick_store(struct Texture *texture, TextureBrickStore *brick_store,
+	const char *image_file_name);
+
+/**
+ * @return  Non-accessed brick store holding texels of <texture>, or nullptr if
+ * texture image is in memory.
+ */
+TextureBrickStore *Texture_get_brick_store(struct Texture *texture);
+
+/**
+ * Get min/max octree over bricks of the image in <texture>, building it from
+ * the current image if needed. It is discarded when the image changes.
+ * @return  Non-owned range tree, or nullptr if texture has no image.
+ */
+TextureRangeTree *Texture_get_range_tree(struct Texture *texture);
+
 #endif /* !defined (TEXTURE_HPP) */
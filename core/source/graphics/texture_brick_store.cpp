@@ -0,0 +1,391 @@
+/**
+ * FILE : texture_brick_store.cpp
+ *
+ * Out-of-core storage of large texture images as fixed-size bricks.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "general/message.h"
+#include "graphics/texture_brick_store.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char brickFileMagic[8] = { 'Z', 'N', 'B', 'R', 'I', 'C', 'K', '1' };
+const int brickFileByteOrderMark = 0x01020304;
+// header is magic, byte order mark, sizes[3], componentCount, bytesPerComponent,
+// brickSizes[3], padded to:
+const std::streamoff brickFileHeaderSize = 64;
+const int defaultBrickSize = 64;
+const size_t defaultMemoryBudget = 256*1024*1024;
+
+}
+
+TextureBrickStore::TextureBrickStore(const char *fileNameIn) :
+	fileName(fileNameIn),
+	componentCount(0),
+	bytesPerComponent(0),
+	bytesPerTexel(0),
+	brickBytes(0),
+	memoryBudget(defaultMemoryBudget),
+	hitCount(0),
+	missCount(0),
+	evictionCount(0),
+	access_count(1)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		this->sizes[i] = 0;
+		this->brickSizes[i] = 0;
+		this->brickCounts[i] = 0;
+	}
+}
+
+TextureBrickStore::~TextureBrickStore()
+{
+	if (this->file.is_open())
+		this->file.close();
+}
+
+void TextureBrickStore::setSizes(const int *sizesIn, int componentCountIn, int bytesPerComponentIn,
+	const int *brickSizesIn)
+{
+	this->componentCount = componentCountIn;
+	this->bytesPerComponent = bytesPerComponentIn;
+	this->bytesPerTexel = componentCountIn*bytesPerComponentIn;
+	this->brickBytes = static_cast<size_t>(this->bytesPerTexel);
+	for (int i = 0; i < 3; ++i)
+	{
+		this->sizes[i] = sizesIn[i];
+		this->brickSizes[i] = (brickSizesIn) ? brickSizesIn[i] :
+			((sizesIn[i] > 1) ? defaultBrickSize : 1);
+		if (this->brickSizes[i] > sizesIn[i])
+			this->brickSizes[i] = sizesIn[i];
+		this->brickCounts[i] = (sizesIn[i] + this->brickSizes[i] - 1)/this->brickSizes[i];
+		this->brickBytes *= static_cast<size_t>(this->brickSizes[i]);
+	}
+}
+
+bool TextureBrickStore::readHeader()
+{
+	char header[brickFileHeaderSize];
+	this->file.seekg(0);
+	if (!this->file.read(header, brickFileHeaderSize))
+		return false;
+	if (0 != memcmp(header, brickFileMagic, sizeof(brickFileMagic)))
+		return false;
+	int values[9];
+	memcpy(values, header + sizeof(brickFileMagic), sizeof(values));
+	if (values[0] != brickFileByteOrderMark)
+		return false;
+	const int *sizesIn = values + 1;
+	const int componentCountIn = values[4];
+	const int bytesPerComponentIn = values[5];
+	const int *brickSizesIn = values + 6;
+	if ((componentCountIn < 1) || (componentCountIn > 4) ||
+			(bytesPerComponentIn < 1) || (bytesPerComponentIn > 2))
+		return false;
+	for (int i = 0; i < 3; ++i)
+		if ((sizesIn[i] < 1) || (brickSizesIn[i] < 1) || (brickSizesIn[i] > sizesIn[i]))
+			return false;
+	this->setSizes(sizesIn, componentCountIn, bytesPerComponentIn, brickSizesIn);
+	return true;
+}
+
+bool TextureBrickStore::writeHeader()
+{
+	char header[brickFileHeaderSize];
+	memset(header, 0, brickFileHeaderSize);
+	memcpy(header, brickFileMagic, sizeof(brickFileMagic));
+	int values[9] = { brickFileByteOrderMark,
+		this->sizes[0], this->sizes[1], this->sizes[2],
+		this->componentCount, this->bytesPerComponent,
+		this->brickSizes[0], this->brickSizes[1], this->brickSizes[2] };
+	memcpy(header + sizeof(brickFileMagic), values, sizeof(values));
+	this->file.seekp(0);
+	return static_cast<bool>(this->file.write(header, brickFileHeaderSize));
+}
+
+std::streamoff TextureBrickStore::getBrickFileOffset(int brickIndex) const
+{
+	return brickFileHeaderSize + static_cast<std::streamoff>(brickIndex)*
+		static_cast<std::streamoff>(this->brickBytes);
+}
+
+TextureBrickStore *TextureBrickStore::create(const char *fileNameIn, const int *sizesIn,
+	int componentCountIn, int bytesPerComponentIn, const int *brickSizesIn)
+{
+	if (!((fileNameIn) && (sizesIn) && (0 < sizesIn[0]) && (0 < sizesIn[1]) &&
+		(0 < sizesIn[2]) && (0 < componentCountIn) && (componentCountIn <= 4) &&
+		((1 == bytesPerComponentIn) || (2 == bytesPerComponentIn))))
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::create.  Invalid argument(s)");
+		return nullptr;
+	}
+	if (brickSizesIn)
+	{
+		for (int i = 0; i < 3; ++i)
+			if (brickSizesIn[i] < 1)
+			{
+				display_message(ERROR_MESSAGE, "TextureBrickStore::create.  Invalid brick sizes");
+				return nullptr;
+			}
+	}
+	TextureBrickStore *brickStore = new TextureBrickStore(fileNameIn);
+	brickStore->setSizes(sizesIn, componentCountIn, bytesPerComponentIn, brickSizesIn);
+	brickStore->file.open(fileNameIn,
+		std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!((brickStore->file.is_open()) && (brickStore->writeHeader())))
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::create.  "
+			"Could not create brick file %s", fileNameIn);
+		delete brickStore;
+		return nullptr;
+	}
+	return brickStore;
+}
+
+TextureBrickStore *TextureBrickStore::open(const char *fileNameIn)
+{
+	if (!fileNameIn)
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::open.  Invalid argument(s)");
+		return nullptr;
+	}
+	TextureBrickStore *brickStore = new TextureBrickStore(fileNameIn);
+	brickStore->file.open(fileNameIn, std::ios::in | std::ios::out | std::ios::binary);
+	if (!brickStore->file.is_open())
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::open.  "
+			"Could not open brick file %s", fileNameIn);
+		delete brickStore;
+		return nullptr;
+	}
+	if (!brickStore->readHeader())
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::open.  "
+			"%s is not a valid brick file", fileNameIn);
+		delete brickStore;
+		return nullptr;
+	}
+	return brickStore;
+}
+
+void TextureBrickStore::setMemoryBudget(size_t memoryBudgetIn)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->memoryBudget = memoryBudgetIn;
+	while ((this->bricks.size() > 1) && (this->bricks.size()*this->brickBytes > this->memoryBudget))
+	{
+		this->brickMap.erase(this->bricks.back().index);
+		this->bricks.pop_back();
+		++(this->evictionCount);
+	}
+}
+
+size_t TextureBrickStore::getMemoryUsed()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->bricks.size()*this->brickBytes;
+}
+
+const std::shared_ptr<std::vector<unsigned char> >& TextureBrickStore::getBrickData(int brickIndex)
+{
+	std::unordered_map<int, BrickList::iterator>::iterator mapIter = this->brickMap.find(brickIndex);
+	if (mapIter != this->brickMap.end())
+	{
+		++(this->hitCount);
+		if (mapIter->second != this->bricks.begin())
+			this->bricks.splice(this->bricks.begin(), this->bricks, mapIter->second);
+		return this->bricks.front().data;
+	}
+	++(this->missCount);
+	// evict least recently used brick if over budget, reusing its storage
+	// unless it is still held by a reader
+	if ((!this->bricks.empty()) &&
+		((this->bricks.size() + 1)*this->brickBytes > this->memoryBudget))
+	{
+		this->brickMap.erase(this->bricks.back().index);
+		this->bricks.splice(this->bricks.begin(), this->bricks, --(this->bricks.end()));
+		++(this->evictionCount);
+		if (this->bricks.front().data.use_count() > 1)
+			this->bricks.front().data.reset(new std::vector<unsigned char>(this->brickBytes));
+	}
+	else
+	{
+		this->bricks.push_front(Brick());
+		this->bricks.front().data.reset(new std::vector<unsigned char>(this->brickBytes));
+	}
+	Brick& brick = this->bricks.front();
+	brick.index = brickIndex;
+	this->brickMap[brickIndex] = this->bricks.begin();
+	// bricks not yet written read as zero
+	unsigned char *brickData = brick.data->data();
+	this->file.clear();
+	this->file.seekg(this->getBrickFileOffset(brickIndex));
+	this->file.read(reinterpret_cast<char *>(brickData), this->brickBytes);
+	const std::streamsize readBytes = (this->file) ? static_cast<std::streamsize>(this->brickBytes) :
+		this->file.gcount();
+	if (readBytes < static_cast<std::streamsize>(this->brickBytes))
+	{
+		memset(brickData + readBytes, 0, this->brickBytes - static_cast<size_t>(readBytes));
+		this->file.clear();
+	}
+	return brick.data;
+}
+
+bool TextureBrickStore::copyTexel(int x, int y, int z, unsigned char *texel)
+{
+	const std::shared_ptr<std::vector<unsigned char> >& brickData =
+		this->getBrickData(this->getBrickIndex(x, y, z));
+	memcpy(texel, brickData->data() + this->getBrickTexelOffset(x, y, z), this->bytesPerTexel);
+	return true;
+}
+
+bool TextureBrickStore::writePlane(int z, const unsigned char *plane, size_t rowBytes)
+{
+	if (!((0 <= z) && (z < this->sizes[2]) && (plane)))
+	{
+		display_message(ERROR_MESSAGE, "TextureBrickStore::writePlane.  Invalid argument(s)");
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const int bz = z/this->brickSizes[2];
+	const size_t brickRowBytes = static_cast<size_t>(this->brickSizes[0])*this->bytesPerTexel;
+	const size_t sliceBytes = brickRowBytes*this->brickSizes[1];
+	const std::streamoff sliceOffset = static_cast<std::streamoff>(z - bz*this->brickSizes[2])*sliceBytes;
+	std::vector<unsigned char> slice(sliceBytes);
+	bool result = true;
+	for (int by = 0; (by < this->brickCounts[1]) && result; ++by)
+	{
+		for (int bx = 0; bx < this->brickCounts[0]; ++bx)
+		{
+			const int x0 = bx*this->brickSizes[0];
+			const int y0 = by*this->brickSizes[1];
+			const int xCount = ((x0 + this->brickSizes[0]) <= this->sizes[0]) ?
+				this->brickSizes[0] : (this->sizes[0] - x0);
+			const int yCount = ((y0 + this->brickSizes[1]) <= this->sizes[1]) ?
+				this->brickSizes[1] : (this->sizes[1] - y0);
+			if ((xCount < this->brickSizes[0]) || (yCount < this->brickSizes[1]))
+				std::fill(slice.begin(), slice.end(), static_cast<unsigned char>(0));
+			for (int j = 0; j < yCount; ++j)
+				memcpy(slice.data() + j*brickRowBytes,
+					plane + static_cast<size_t>(y0 + j)*rowBytes + static_cast<size_t>(x0)*this->bytesPerTexel,
+					static_cast<size_t>(xCount)*this->bytesPerTexel);
+			const int brickIndex = (bz*this->brickCounts[1] + by)*this->brickCounts[0] + bx;
+			this->file.clear();
+			this->file.seekp(this->getBrickFileOffset(brickIndex) + sliceOffset);
+			if (!this->file.write(reinterpret_cast<const char *>(slice.data()), sliceBytes))
+			{
+				display_message(ERROR_MESSAGE, "TextureBrickStore::writePlane.  "
+					"Failed to write to brick file %s", this->fileName.c_str());
+				result = false;
+				break;
+			}
+			// update cached copy, copying it first if held by a reader
+			std::unordered_map<int, BrickList::iterator>::iterator mapIter = this->brickMap.find(brickIndex);
+			if (mapIter != this->brickMap.end())
+			{
+				std::shared_ptr<std::vector<unsigned char> >& brickData = mapIter->second->data;
+				if (brickData.use_count() > 1)
+					brickData.reset(new std::vector<unsigned char>(*brickData));
+				memcpy(brickData->data() + sliceOffset, slice.data(), sliceBytes);
+			}
+		}
+	}
+	this->file.flush();
+	return result;
+}
+
+bool TextureBrickStore::getTexel(int x, int y, int z, unsigned char *texel)
+{
+	if (!((0 <= x) && (x < this->sizes[0]) && (0 <= y) && (y < this->sizes[1]) &&
+		(0 <= z) && (z < this->sizes[2]) && (texel)))
+		return false;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->copyTexel(x, y, z, texel);
+}
+
+TextureBrickStore::BrickData TextureBrickStore::getBrick(int brickIndex)
+{
+	if (!((0 <= brickIndex) && (brickIndex < this->brickCounts[0]*this->brickCounts[1]*this->brickCounts[2])))
+		return BrickData();
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->getBrickData(brickIndex);
+}
+
+bool TextureBrickStore::getBlock(const int *start, const int *blockSizes, unsigned char *texels)
+{
+	if (!((start) && (blockSizes) && (texels)))
+		return false;
+	for (int i = 0; i < 3; ++i)
+		if ((start[i] < 0) || (blockSizes[i] < 1) || (start[i] + blockSizes[i] > this->sizes[i]))
+			return false;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const size_t outRowBytes = static_cast<size_t>(blockSizes[0])*this->bytesPerTexel;
+	const int bx0 = start[0]/this->brickSizes[0];
+	const int bx1 = (start[0] + blockSizes[0] - 1)/this->brickSizes[0];
+	for (int k = 0; k < blockSizes[2]; ++k)
+	{
+		const int z = start[2] + k;
+		const int bz = z/this->brickSizes[2];
+		for (int j = 0; j < blockSizes[1]; ++j)
+		{
+			const int y = start[1] + j;
+			const int by = y/this->brickSizes[1];
+			unsigned char *outRow = texels + (static_cast<size_t>(k)*blockSizes[1] + j)*outRowBytes;
+			// copy the part of the row in each brick it crosses
+			for (int bx = bx0; bx <= bx1; ++bx)
+			{
+				const unsigned char *brickData = this->getBrickData(
+					(bz*this->brickCounts[1] + by)*this->brickCounts[0] + bx)->data();
+				const int brickX0 = bx*this->brickSizes[0];
+				const int x0 = (start[0] > brickX0) ? start[0] : brickX0;
+				int x1 = brickX0 + this->brickSizes[0];
+				if (x1 > start[0] + blockSizes[0])
+					x1 = start[0] + blockSizes[0];
+				const size_t brickOffset = ((static_cast<size_t>(z - bz*this->brickSizes[2])*this->brickSizes[1] +
+					static_cast<size_t>(y - by*this->brickSizes[1]))*this->brickSizes[0] +
+					static_cast<size_t>(x0 - brickX0))*this->bytesPerTexel;
+				memcpy(outRow + static_cast<size_t>(x0 - start[0])*this->bytesPerTexel,
+					brickData + brickOffset, static_cast<size_t>(x1 - x0)*this->bytesPerTexel);
+			}
+		}
+	}
+	return true;
+}
+
+bool TextureBrickStore::getResampledImage(const int *outSizes, unsigned char *image)
+{
+	if (!((outSizes) && (image)))
+		return false;
+	for (int i = 0; i < 3; ++i)
+		if (outSizes[i] < 1)
+			return false;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const size_t outRowBytes = ((static_cast<size_t>(outSizes[0])*this->bytesPerTexel + 3)/4)*4;
+	std::vector<int> sourceX(outSizes[0]);
+	for (int i = 0; i < outSizes[0]; ++i)
+		sourceX[i] = static_cast<int>(((static_cast<double>(i) + 0.5)*this->sizes[0])/outSizes[0]);
+	for (int k = 0; k < outSizes[2]; ++k)
+	{
+		const int z = static_cast<int>(((static_cast<double>(k) + 0.5)*this->sizes[2])/outSizes[2]);
+		for (int j = 0; j < outSizes[1]; ++j)
+		{
+			const int y = static_cast<int>(((static_cast<double>(j) + 0.5)*this->sizes[1])/outSizes[1]);
+			unsigned char *outTexel = image + (static_cast<size_t>(k)*outSizes[1] + j)*outRowBytes;
+			for (int i = 0; i < outSizes[0]; ++i)
+			{
+				if (!this->copyTexel(sourceX[i], y, z, outTexel))
+					return false;
+				outTexel += this->bytesPerTexel;
+			}
+		}
+	}
+	return true;
+}
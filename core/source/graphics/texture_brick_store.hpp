@@ -0,0 +1,233 @@
+/**
+ * FILE : texture_brick_store.hpp
+ *
+ * Out-of-core storage of large texture images as fixed-size bricks in a raw
+ * brick file, paged into an LRU cache with a configurable memory budget.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__TEXTURE_BRICK_STORE_HPP__)
+#define __TEXTURE_BRICK_STORE_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Texel data for an image of up to 3 dimensions held in a brick file. Texels
+ * are addressed by integer x, y, z from the bottom left and have a number of
+ * components of 1 or 2 bytes in the same layout as texels in a Texture image.
+ * The brick file has a short header followed by bricks in x, y, z order, each
+ * with all its texels in x, y, z order. Bricks at the upper edges are padded.
+ * Bricks are read into an LRU cache on demand; all access is thread safe.
+ */
+class TextureBrickStore
+{
+public:
+	/** Brick data shared with the cache so it stays valid after eviction. */
+	typedef std::shared_ptr<const std::vector<unsigned char> > BrickData;
+
+private:
+	struct Brick
+	{
+		int index;
+		std::shared_ptr<std::vector<unsigned char> > data;
+	};
+
+	typedef std::list<Brick> BrickList;
+
+	std::string fileName;
+	std::fstream file;
+	int sizes[3];
+	int componentCount;
+	int bytesPerComponent;
+	int bytesPerTexel;
+	int brickSizes[3];
+	int brickCounts[3];
+	size_t brickBytes;
+	BrickList bricks;  // cached bricks, most recently used first
+	std::unordered_map<int, BrickList::iterator> brickMap;  // brick index -> cached brick
+	size_t memoryBudget;
+	std::atomic<unsigned long> hitCount, missCount, evictionCount;
+	std::mutex mutex;
+	std::atomic<int> access_count;
+
+	TextureBrickStore(const char *fileNameIn);
+
+	TextureBrickStore();  // not implemented
+	TextureBrickStore(const TextureBrickStore &source);  // not implemented
+	TextureBrickStore& operator=(const TextureBrickStore &source);  // not implemented
+
+	~TextureBrickStore();
+
+	void setSizes(const int *sizesIn, int componentCountIn, int bytesPerComponentIn,
+		const int *brickSizesIn);
+
+	bool readHeader();
+
+	bool writeHeader();
+
+	std::streamoff getBrickFileOffset(int brickIndex) const;
+
+	/** Get cached brick, reading it from file if needed. Caller must lock mutex.
+	 * @return  Reference to brick data, valid until next call. */
+	const std::shared_ptr<std::vector<unsigned char> >& getBrickData(int brickIndex);
+
+	/** Copy texel at valid x, y, z. Caller must lock mutex. */
+	bool copyTexel(int x, int y, int z, unsigned char *texel);
+
+public:
+
+	/**
+	 * Create new brick file, overwriting any existing file with name.
+	 * @param sizesIn  Image size in texels in x, y, z. Use 1 for unused dimensions.
+	 * @param componentCountIn  Number of components per texel, 1 to 4.
+	 * @param bytesPerComponentIn  1 or 2.
+	 * @param brickSizesIn  Optional brick sizes in texels, or nullptr to use the
+	 * default of 64 for each used dimension.
+	 * @return  Accessed brick store, or nullptr if failed.
+	 */
+	static TextureBrickStore *create(const char *fileNameIn, const int *sizesIn,
+		int componentCountIn, int bytesPerComponentIn, const int *brickSizesIn = nullptr);
+
+	/**
+	 * Open existing brick file.
+	 * @return  Accessed brick store, or nullptr if failed or not a brick file.
+	 */
+	static TextureBrickStore *open(const char *fileNameIn);
+
+	TextureBrickStore *access()
+	{
+		++(this->access_count);
+		return this;
+	}
+
+	static void deaccess(TextureBrickStore* &brickStore)
+	{
+		if (brickStore)
+		{
+			if (--(brickStore->access_count) == 0)
+				delete brickStore;
+			brickStore = nullptr;
+		}
+	}
+
+	const std::string& getFileName() const
+	{
+		return this->fileName;
+	}
+
+	/** @return  Pointer to image size in texels in x, y, z. */
+	const int *getSizes() const
+	{
+		return this->sizes;
+	}
+
+	int getComponentCount() const
+	{
+		return this->componentCount;
+	}
+
+	int getBytesPerComponent() const
+	{
+		return this->bytesPerComponent;
+	}
+
+	int getBytesPerTexel() const
+	{
+		return this->bytesPerTexel;
+	}
+
+	const int *getBrickSizes() const
+	{
+		return this->brickSizes;
+	}
+
+	/** @return  Maximum memory for cached bricks in bytes, default 256 MB. */
+	size_t getMemoryBudget() const
+	{
+		return this->memoryBudget;
+	}
+
+	/** Set maximum memory for cached bricks, evicting least recently used
+	 * bricks if over. At least one brick is always cached. */
+	void setMemoryBudget(size_t memoryBudgetIn);
+
+	/** @return  Number of bytes of cached bricks. */
+	size_t getMemoryUsed();
+
+	unsigned long getHitCount() const
+	{
+		return this->hitCount;
+	}
+
+	unsigned long getMissCount() const
+	{
+		return this->missCount;
+	}
+
+	/** @return  Number of bricks discarded to stay within memory budget. */
+	unsigned long getEvictionCount() const
+	{
+		return this->evictionCount;
+	}
+
+	/** @return  Index of brick containing valid texel x, y, z. */
+	int getBrickIndex(int x, int y, int z) const
+	{
+		return ((z/this->brickSizes[2])*this->brickCounts[1] + y/this->brickSizes[1])*
+			this->brickCounts[0] + x/this->brickSizes[0];
+	}
+
+	/** @return  Byte offset of valid texel x, y, z in the data for its brick. */
+	size_t getBrickTexelOffset(int x, int y, int z) const
+	{
+		return ((static_cast<size_t>(z % this->brickSizes[2])*this->brickSizes[1] +
+			static_cast<size_t>(y % this->brickSizes[1]))*this->brickSizes[0] +
+			static_cast<size_t>(x % this->brickSizes[0]))*this->bytesPerTexel;
+	}
+
+	/**
+	 * Write plane of texels at z into the bricks containing it.
+	 * @param plane  Texels for plane from bottom to top, rows starting at
+	 * multiples of rowBytes.
+	 * @return  True on success.
+	 */
+	bool writePlane(int z, const unsigned char *plane, size_t rowBytes);
+
+	/** Get bytes of texel at x, y, z. @return  True on success. */
+	bool getTexel(int x, int y, int z, unsigned char *texel);
+
+	/**
+	 * Get data for brick, locking the cache once. Use with getBrickIndex and
+	 * getBrickTexelOffset to read many texels from the same brick.
+	 * @return  Brick data, or empty if invalid brick index.
+	 */
+	BrickData getBrick(int brickIndex);
+
+	/**
+	 * Get block of texels starting at start with blockSizes in x, y, z, tightly
+	 * packed in x, y, z order.
+	 * @return  True on success.
+	 */
+	bool getBlock(const int *start, const int *blockSizes, unsigned char *texels);
+
+	/**
+	 * Get whole image resampled to outSizes with nearest texel to centre of
+	 * each output texel, with rows 4-byte aligned as for OpenGL upload.
+	 * @return  True on success.
+	 */
+	bool getResampledImage(const int *outSizes, unsigned char *image);
+
+};
+
+#endif /* !defined (__TEXTURE_BRICK_STORE_HPP__) */
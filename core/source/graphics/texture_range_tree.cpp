@@ -0,0 +1,285 @@
+/**
+ * FILE : texture_range_tree.cpp
+ *
+ * Hierarchy of minimum and maximum texel values over bricks of a texture image.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "general/message.h"
+#include "graphics/texture_brick_store.hpp"
+#include "graphics/texture_range_tree.hpp"
+#include <algorithm>
+
+TextureRangeTree::TextureRangeTree(const int *sizesIn, int componentCountIn,
+		int bytesPerComponentIn, int brickSizeIn) :
+	componentCount(componentCountIn),
+	maximumTexelValue((bytesPerComponentIn == 2) ? 65535 : 255),
+	brickSize(std::max(1, brickSizeIn))
+{
+	Level level;
+	for (int i = 0; i < 3; ++i)
+	{
+		this->sizes[i] = sizesIn[i];
+		level.counts[i] = (this->sizes[i] + this->brickSize - 1) / this->brickSize;
+	}
+	const size_t valueCount = static_cast<size_t>(level.counts[0])*level.counts[1]*
+		level.counts[2]*this->componentCount;
+	level.minimums.assign(valueCount, static_cast<unsigned short>(this->maximumTexelValue));
+	level.maximums.assign(valueCount, 0);
+	this->levels.push_back(level);
+}
+
+/**
+ * Merge texel values in plane z into ranges of level 0 bricks.
+ * @param rowStride  Number of components from the start of one row to the next.
+ */
+template <typename ComponentType>
+	void TextureRangeTree::addPlaneRanges(int z, const ComponentType *plane, size_t rowStride)
+{
+	Level& level = this->levels[0];
+	const int componentCount = this->componentCount;
+	const size_t brickLayerOffset = static_cast<size_t>(z/this->brickSize)*level.counts[1]*level.counts[0];
+	for (int y = 0; y < this->sizes[1]; ++y)
+	{
+		const ComponentType *row = plane + y*rowStride;
+		const size_t brickRowOffset = brickLayerOffset + static_cast<size_t>(y/this->brickSize)*level.counts[0];
+		for (int bx = 0; bx < level.counts[0]; ++bx)
+		{
+			const int x0 = bx*this->brickSize;
+			const int x1 = std::min(x0 + this->brickSize, this->sizes[0]);
+			unsigned short *minimums = level.minimums.data() + (brickRowOffset + bx)*componentCount;
+			unsigned short *maximums = level.maximums.data() + (brickRowOffset + bx)*componentCount;
+			for (int c = 0; c < componentCount; ++c)
+			{
+				unsigned short minimum = minimums[c];
+				unsigned short maximum = maximums[c];
+				const ComponentType *texel = row + x0*componentCount + c;
+				for (int x = x0; x < x1; ++x, texel += componentCount)
+				{
+					const unsigned short value = static_cast<unsigned short>(*texel);
+					if (value < minimum)
+						minimum = value;
+					if (value > maximum)
+						maximum = value;
+				}
+				minimums[c] = minimum;
+				maximums[c] = maximum;
+			}
+		}
+	}
+}
+
+/** Build coarser levels from level 0 until a single root node remains. */
+void TextureRangeTree::buildLevels()
+{
+	const int componentCount = this->componentCount;
+	while ((this->levels.back().counts[0] > 1) || (this->levels.back().counts[1] > 1) ||
+		(this->levels.back().counts[2] > 1))
+	{
+		const int sourceIndex = static_cast<int>(this->levels.size()) - 1;
+		Level level;
+		for (int i = 0; i < 3; ++i)
+			level.counts[i] = (this->levels[sourceIndex].counts[i] + 1)/2;
+		const size_t valueCount = static_cast<size_t>(level.counts[0])*level.counts[1]*
+			level.counts[2]*componentCount;
+		level.minimums.assign(valueCount, static_cast<unsigned short>(this->maximumTexelValue));
+		level.maximums.assign(valueCount, 0);
+		this->levels.push_back(level);
+		const Level& source = this->levels[sourceIndex];
+		Level& target = this->levels.back();
+		for (int z = 0; z < source.counts[2]; ++z)
+			for (int y = 0; y < source.counts[1]; ++y)
+				for (int x = 0; x < source.counts[0]; ++x)
+				{
+					const size_t sourceOffset = ((static_cast<size_t>(z)*source.counts[1] + y)*
+						source.counts[0] + x)*componentCount;
+					const size_t targetOffset = ((static_cast<size_t>(z/2)*target.counts[1] + y/2)*
+						target.counts[0] + x/2)*componentCount;
+					for (int c = 0; c < componentCount; ++c)
+					{
+						target.minimums[targetOffset + c] = std::min(target.minimums[targetOffset + c],
+							source.minimums[sourceOffset + c]);
+						target.maximums[targetOffset + c] = std::max(target.maximums[targetOffset + c],
+							source.maximums[sourceOffset + c]);
+					}
+				}
+	}
+}
+
+TextureRangeTree *TextureRangeTree::create(const int *sizes, const int *storedSizes,
+	int componentCount, int bytesPerComponent, const unsigned char *image, int brickSize)
+{
+	if ((!sizes) || (!storedSizes) || (componentCount < 1) || (componentCount > 4) ||
+		((bytesPerComponent != 1) && (bytesPerComponent != 2)) || (!image))
+	{
+		display_message(ERROR_MESSAGE, "TextureRangeTree::create.  Invalid argument(s)");
+		return nullptr;
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		if ((sizes[i] < 1) || (storedSizes[i] < sizes[i]))
+		{
+			display_message(ERROR_MESSAGE, "TextureRangeTree::create.  Invalid image sizes");
+			return nullptr;
+		}
+	}
+	TextureRangeTree *rangeTree = new TextureRangeTree(sizes, componentCount, bytesPerComponent, brickSize);
+	// rows are padded to 4 bytes, and may be for a larger stored image
+	const size_t rowBytes = ((static_cast<size_t>(storedSizes[0])*componentCount*bytesPerComponent + 3)/4)*4;
+	const size_t planeBytes = rowBytes*storedSizes[1];
+	for (int z = 0; z < sizes[2]; ++z)
+	{
+		if (bytesPerComponent == 2)
+			rangeTree->addPlaneRanges(z, reinterpret_cast<const unsigned short *>(image + z*planeBytes), rowBytes/2);
+		else
+			rangeTree->addPlaneRanges(z, image + z*planeBytes, rowBytes);
+	}
+	rangeTree->buildLevels();
+	return rangeTree;
+}
+
+TextureRangeTree *TextureRangeTree::create(TextureBrickStore *brickStore, int brickSize)
+{
+	if (!brickStore)
+	{
+		display_message(ERROR_MESSAGE, "TextureRangeTree::create.  Invalid argument(s)");
+		return nullptr;
+	}
+	const int *sizes = brickStore->getSizes();
+	const int componentCount = brickStore->getComponentCount();
+	const int bytesPerComponent = brickStore->getBytesPerComponent();
+	TextureRangeTree *rangeTree = new TextureRangeTree(sizes, componentCount, bytesPerComponent, brickSize);
+	const size_t rowComponents = static_cast<size_t>(sizes[0])*componentCount;
+	// 2 byte aligned storage for a plane of either component size
+	std::vector<unsigned short> plane((rowComponents*sizes[1]*bytesPerComponent + 1)/2);
+	unsigned char *planeBytes = reinterpret_cast<unsigned char *>(plane.data());
+	for (int z = 0; z < sizes[2]; ++z)
+	{
+		const int start[3] = { 0, 0, z };
+		const int blockSizes[3] = { sizes[0], sizes[1], 1 };
+		if (!brickStore->getBlock(start, blockSizes, planeBytes))
+		{
+			display_message(ERROR_MESSAGE, "TextureRangeTree::create.  "
+				"Failed to read plane %d of image bricks", z);
+			delete rangeTree;
+			return nullptr;
+		}
+		if (bytesPerComponent == 2)
+			rangeTree->addPlaneRanges(z, plane.data(), rowComponents);
+		else
+			rangeTree->addPlaneRanges(z, planeBytes, rowComponents);
+	}
+	rangeTree->buildLevels();
+	return rangeTree;
+}
+
+void TextureRangeTree::getRange(int component, int& minimum, int& maximum) const
+{
+	const Level& root = this->levels.back();
+	minimum = root.minimums[component];
+	maximum = root.maximums[component];
+}
+
+/**
+ * Merge range of node at x, y, z in level into minimum and maximum if it
+ * overlaps texels from start up to but not including end, descending to
+ * finer levels only where the node is partly covered.
+ */
+void TextureRangeTree::mergeBlockRange(int levelIndex, int x, int y, int z, int component,
+	const int *start, const int *end, int& minimum, int& maximum) const
+{
+	const Level& level = this->levels[levelIndex];
+	const int nodeSize = this->brickSize << levelIndex;
+	const int nodeStart[3] = { x*nodeSize, y*nodeSize, z*nodeSize };
+	bool covered = true;
+	for (int i = 0; i < 3; ++i)
+	{
+		const int nodeEnd = std::min(nodeStart[i] + nodeSize, this->sizes[i]);
+		if ((nodeStart[i] >= end[i]) || (nodeEnd <= start[i]))
+			return;
+		if ((nodeStart[i] < start[i]) || (nodeEnd > end[i]))
+			covered = false;
+	}
+	if (covered || (0 == levelIndex))
+	{
+		const size_t offset = ((static_cast<size_t>(z)*level.counts[1] + y)*level.counts[0] + x)*
+			this->componentCount + component;
+		minimum = std::min(minimum, static_cast<int>(level.minimums[offset]));
+		maximum = std::max(maximum, static_cast<int>(level.maximums[offset]));
+		return;
+	}
+	const Level& child = this->levels[levelIndex - 1];
+	for (int cz = 2*z; cz < std::min(2*z + 2, child.counts[2]); ++cz)
+		for (int cy = 2*y; cy < std::min(2*y + 2, child.counts[1]); ++cy)
+			for (int cx = 2*x; cx < std::min(2*x + 2, child.counts[0]); ++cx)
+				this->mergeBlockRange(levelIndex - 1, cx, cy, cz, component, start, end, minimum, maximum);
+}
+
+bool TextureRangeTree::getBlockRange(int component, const int *start, const int *blockSizes,
+	int& minimum, int& maximum) const
+{
+	int clippedStart[3], end[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		clippedStart[i] = std::max(0, start[i]);
+		end[i] = std::min(this->sizes[i], start[i] + blockSizes[i]);
+		if (clippedStart[i] >= end[i])
+			return false;
+	}
+	minimum = this->maximumTexelValue;
+	maximum = 0;
+	this->mergeBlockRange(this->getLevelCount() - 1, 0, 0, 0, component, clippedStart, end, minimum, maximum);
+	return true;
+}
+
+/**
+ * Classify level 0 bricks under node at x, y, z in level against raw texel
+ * values from lower to upper inclusive.
+ */
+void TextureRangeTree::classifyNode(int levelIndex, int x, int y, int z, int component,
+	int lower, int upper, std::vector<unsigned char>& brickClasses) const
+{
+	const Level& level = this->levels[levelIndex];
+	const size_t offset = ((static_cast<size_t>(z)*level.counts[1] + y)*level.counts[0] + x)*
+		this->componentCount + component;
+	const int minimum = level.minimums[offset];
+	const int maximum = level.maximums[offset];
+	unsigned char brickClass = BRICK_STRADDLE;
+	if ((maximum < lower) || (minimum > upper))
+		brickClass = BRICK_OUTSIDE;
+	else if ((minimum >= lower) && (maximum <= upper))
+		brickClass = BRICK_INSIDE;
+	else if (levelIndex > 0)
+	{
+		const Level& child = this->levels[levelIndex - 1];
+		for (int cz = 2*z; cz < std::min(2*z + 2, child.counts[2]); ++cz)
+			for (int cy = 2*y; cy < std::min(2*y + 2, child.counts[1]); ++cy)
+				for (int cx = 2*x; cx < std::min(2*x + 2, child.counts[0]); ++cx)
+					this->classifyNode(levelIndex - 1, cx, cy, cz, component, lower, upper, brickClasses);
+		return;
+	}
+	// fill all bricks under node
+	const int *brickCounts = this->levels[0].counts;
+	const int span = 1 << levelIndex;
+	for (int bz = z*span; bz < std::min((z + 1)*span, brickCounts[2]); ++bz)
+		for (int by = y*span; by < std::min((y + 1)*span, brickCounts[1]); ++by)
+		{
+			const size_t rowOffset = (static_cast<size_t>(bz)*brickCounts[1] + by)*brickCounts[0];
+			const int bx0 = x*span;
+			const int bx1 = std::min((x + 1)*span, brickCounts[0]);
+			std::fill(brickClasses.begin() + rowOffset + bx0, brickClasses.begin() + rowOffset + bx1, brickClass);
+		}
+}
+
+void TextureRangeTree::classifyBricks(int component, int lower, int upper,
+	std::vector<unsigned char>& brickClasses) const
+{
+	const int *brickCounts = this->levels[0].counts;
+	brickClasses.assign(static_cast<size_t>(brickCounts[0])*brickCounts[1]*brickCounts[2], BRICK_OUTSIDE);
+	if ((lower <= upper) && (upper >= 0) && (lower <= this->maximumTexelValue))
+		this->classifyNode(this->getLevelCount() - 1, 0, 0, 0, component, lower, upper, brickClasses);
+}
@@ -0,0 +1,153 @@
+/**
+ * FILE : texture_range_tree.hpp
+ *
+ * Hierarchy of minimum and maximum texel values over bricks of a texture image.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__TEXTURE_RANGE_TREE_HPP__)
+#define __TEXTURE_RANGE_TREE_HPP__
+
+#include <cstddef>
+#include <vector>
+
+class TextureBrickStore;
+
+/**
+ * Octree of the range of each component's texel values over fixed-size
+ * bricks of a texture image. Level 0 holds the range over each brick; each
+ * coarser level merges up to 2x2x2 nodes of the previous level until a single
+ * root node covers the whole image. Queries descend from the root so whole
+ * regions whose range lies outside the range of interest are skipped at once.
+ * Ranges are of the raw integer texel values, which are 0 to 255 for 1 byte
+ * components and 0 to 65535 for 2 byte components.
+ * The tree is built in one pass over the image when created and does not
+ * reference it afterwards; it must be discarded whenever the image changes.
+ * Queries are thread safe.
+ */
+class TextureRangeTree
+{
+public:
+	/** Classification of a brick's values against a range of interest */
+	enum BrickClass
+	{
+		BRICK_OUTSIDE = 0,  // no values in range
+		BRICK_INSIDE = 1,  // all values in range
+		BRICK_STRADDLE = 2  // some values may be in range
+	};
+
+private:
+	struct Level
+	{
+		int counts[3];  // number of nodes in x, y, z
+		/* componentCount minimums and maximums for each node, x fastest */
+		std::vector<unsigned short> minimums;
+		std::vector<unsigned short> maximums;
+	};
+
+	int sizes[3];
+	int componentCount;
+	int maximumTexelValue;
+	int brickSize;
+	std::vector<Level> levels;  // from bricks at level 0 up to the root
+
+	TextureRangeTree(const int *sizesIn, int componentCountIn,
+		int bytesPerComponentIn, int brickSizeIn);
+
+	TextureRangeTree();  // not implemented
+	TextureRangeTree(const TextureRangeTree &source);  // not implemented
+	TextureRangeTree& operator=(const TextureRangeTree &source);  // not implemented
+
+	template <typename ComponentType>
+		void addPlaneRanges(int z, const ComponentType *plane, size_t rowStride);
+
+	void buildLevels();
+
+	void mergeBlockRange(int levelIndex, int x, int y, int z, int component,
+		const int *start, const int *end, int& minimum, int& maximum) const;
+
+	void classifyNode(int levelIndex, int x, int y, int z, int component,
+		int lower, int upper, std::vector<unsigned char>& brickClasses) const;
+
+public:
+
+	/**
+	 * Create range tree for in-memory image with rows padded to 4 bytes, as in
+	 * Texture. Image is only read during creation.
+	 * @param sizes  Size of image in texels in x, y, z, 1 for unused dimensions.
+	 * @param storedSizes  Size of image storage, at least sizes.
+	 * @param componentCount  Number of components 1 to 4.
+	 * @param bytesPerComponent  1 or 2, with 2 byte components in native order.
+	 * @param brickSize  Number of texels along each side of a level 0 brick.
+	 * @return  New range tree or nullptr if invalid arguments.
+	 */
+	static TextureRangeTree *create(const int *sizes, const int *storedSizes,
+		int componentCount, int bytesPerComponent, const unsigned char *image,
+		int brickSize = 8);
+
+	/**
+	 * Create range tree for image in brickStore, reading it a plane at a time.
+	 * @return  New range tree or nullptr if invalid arguments or read failed.
+	 */
+	static TextureRangeTree *create(TextureBrickStore *brickStore, int brickSize = 8);
+
+	int getComponentCount() const
+	{
+		return this->componentCount;
+	}
+
+	/** @return  255 for 1 byte components, 65535 for 2 byte components. */
+	int getMaximumTexelValue() const
+	{
+		return this->maximumTexelValue;
+	}
+
+	/** @return  Number of texels along each side of a level 0 brick. */
+	int getBrickSize() const
+	{
+		return this->brickSize;
+	}
+
+	/** @return  Number of level 0 bricks in x, y, z. */
+	const int *getBrickCounts() const
+	{
+		return this->levels[0].counts;
+	}
+
+	int getLevelCount() const
+	{
+		return static_cast<int>(this->levels.size());
+	}
+
+	/**
+	 * Get range of raw texel values of component over the whole image.
+	 */
+	void getRange(int component, int& minimum, int& maximum) const;
+
+	/**
+	 * Get range of raw texel values of component in block of texels. The range
+	 * is conservative: it contains all values in the block, but may include
+	 * values from the rest of the bricks the block partly overlaps.
+	 * @param start  Index of first texel in block in x, y, z.
+	 * @param blockSizes  Number of texels in block in x, y, z, clipped to image.
+	 * @return  True if block overlaps image, otherwise false with no range.
+	 */
+	bool getBlockRange(int component, const int *start, const int *blockSizes,
+		int& minimum, int& maximum) const;
+
+	/**
+	 * Classify all level 0 bricks by whether the raw texel values of component
+	 * are within lower to upper inclusive. Nodes entirely inside or outside
+	 * the range classify all bricks under them without visiting them.
+	 * @param brickClasses  Vector resized to receive the BrickClass of each
+	 * brick, x fastest.
+	 */
+	void classifyBricks(int component, int lower, int upper,
+		std::vector<unsigned char>& brickClasses) const;
+
+};
+
+#endif /* !defined (__TEXTURE_RANGE_TREE_HPP__) */
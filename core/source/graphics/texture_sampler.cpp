@@ -0,0 +1,544 @@
+/**
+ * FILE : texture_sampler.cpp
+ *
+ * CPU-side mip pyramid and specialised samplers for evaluating texture images.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "general/message.h"
+#include "graphics/texture_brick_store.hpp"
+#include "graphics/texture_sampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// number of points sampled at a time, sized so work arrays fit on the stack
+const int samplePointChunkSize = 64;
+
+/** @return  Integer floor of v, limited to a range safe for index arithmetic. */
+inline int floorToIndex(double v)
+{
+	const double limit = 1.0E9;
+	const double f = std::floor(v);
+	return static_cast<int>((f > -limit) ? ((f < limit) ? f : limit) : -limit);
+}
+
+struct ClampIndex
+{
+	static inline int wrap(int i, int size)
+	{
+		return std::min(std::max(i, 0), size - 1);
+	}
+};
+
+struct RepeatIndex
+{
+	static inline int wrap(int i, int size)
+	{
+		const int r = i % size;
+		return r + ((r < 0) ? size : 0);
+	}
+};
+
+struct MirroredRepeatIndex
+{
+	static inline int wrap(int i, int size)
+	{
+		const int period = 2*size;
+		int r = i % period;
+		r += (r < 0) ? period : 0;
+		return std::min(r, period - 1 - r);
+	}
+};
+
+/** Texels of a level held in memory */
+template <typename ComponentType, int componentCount>
+class MemoryTexels
+{
+	const ComponentType *data;
+	size_t strides[3];
+
+public:
+	MemoryTexels(const TextureSampler::Level& level, TextureBrickStore *) :
+		data(reinterpret_cast<const ComponentType *>(level.data))
+	{
+		for (int i = 0; i < 3; ++i)
+			this->strides[i] = level.strides[i];
+	}
+
+	inline const ComponentType *getTexel(const int *index, ComponentType *) const
+	{
+		return this->data + index[0]*this->strides[0] + index[1]*this->strides[1] +
+			index[2]*this->strides[2];
+	}
+};
+
+/** Texels of a level read from a brick store, holding the last brick used so
+ * the store is only locked when sampling moves to another brick. */
+template <typename ComponentType, int componentCount>
+class BrickTexels
+{
+	TextureBrickStore *brickStore;
+	int brickIndex;
+	TextureBrickStore::BrickData brickData;
+
+public:
+	BrickTexels(const TextureSampler::Level&, TextureBrickStore *brickStoreIn) :
+		brickStore(brickStoreIn),
+		brickIndex(-1)
+	{
+	}
+
+	inline const ComponentType *getTexel(const int *index, ComponentType *buffer)
+	{
+		const int texelBrickIndex = this->brickStore->getBrickIndex(index[0], index[1], index[2]);
+		if (texelBrickIndex != this->brickIndex)
+		{
+			this->brickData = this->brickStore->getBrick(texelBrickIndex);
+			this->brickIndex = texelBrickIndex;
+		}
+		if (!this->brickData)
+		{
+			memset(buffer, 0, componentCount*sizeof(ComponentType));
+			return buffer;
+		}
+		return reinterpret_cast<const ComponentType *>(this->brickData->data() +
+			this->brickStore->getBrickTexelOffset(index[0], index[1], index[2]));
+	}
+};
+
+template <typename ComponentType, int componentCount, int dimension, class Texels, class WrapIndex>
+void sampleNearest(const TextureSampler::Level& level, TextureBrickStore *brickStore,
+	int pointCount, const double *texelCoordinates, double *values)
+{
+	Texels texels(level, brickStore);
+	const double scale = 1.0/std::numeric_limits<ComponentType>::max();
+	ComponentType buffer[componentCount];
+	int index[3] = { 0, 0, 0 };
+	for (int p = 0; p < pointCount; ++p)
+	{
+		const double *u = texelCoordinates + 3*p;
+		for (int d = 0; d < dimension; ++d)
+			index[d] = WrapIndex::wrap(floorToIndex(u[d]), level.sizes[d]);
+		const ComponentType *texel = texels.getTexel(index, buffer);
+		double *value = values + componentCount*p;
+		for (int c = 0; c < componentCount; ++c)
+			value[c] = scale*texel[c];
+	}
+}
+
+template <typename ComponentType, int componentCount, int dimension, class Texels, class WrapIndex>
+void sampleLinear(const TextureSampler::Level& level, TextureBrickStore *brickStore,
+	int pointCount, const double *texelCoordinates, double *values)
+{
+	Texels texels(level, brickStore);
+	const double scale = 1.0/std::numeric_limits<ComponentType>::max();
+	ComponentType buffer[componentCount];
+	int cornerIndexes[3][2];
+	double cornerWeights[3][2];
+	for (int p = 0; p < pointCount; ++p)
+	{
+		const double *u = texelCoordinates + 3*p;
+		// texel values apply at their centres
+		for (int d = 0; d < dimension; ++d)
+		{
+			const double v = u[d] - 0.5;
+			const int i = floorToIndex(v);
+			const double xi = std::min(std::max(v - i, 0.0), 1.0);
+			cornerIndexes[d][0] = WrapIndex::wrap(i, level.sizes[d]);
+			cornerIndexes[d][1] = WrapIndex::wrap(i + 1, level.sizes[d]);
+			cornerWeights[d][0] = 1.0 - xi;
+			cornerWeights[d][1] = xi;
+		}
+		double sums[componentCount];
+		for (int c = 0; c < componentCount; ++c)
+			sums[c] = 0.0;
+		for (int corner = 0; corner < (1 << dimension); ++corner)
+		{
+			int index[3] = { 0, 0, 0 };
+			double weight = scale;
+			for (int d = 0; d < dimension; ++d)
+			{
+				const int high = (corner >> d) & 1;
+				index[d] = cornerIndexes[d][high];
+				weight *= cornerWeights[d][high];
+			}
+			const ComponentType *texel = texels.getTexel(index, buffer);
+			for (int c = 0; c < componentCount; ++c)
+				sums[c] += weight*texel[c];
+		}
+		double *value = values + componentCount*p;
+		for (int c = 0; c < componentCount; ++c)
+			value[c] = sums[c];
+	}
+}
+
+template <typename ComponentType, int componentCount, int dimension, class Texels>
+TextureSampler::SampleFunction getSampleFunctionForTexels(TextureSampler::Filter filter,
+	TextureSampler::Wrap wrap)
+{
+	const bool linear = (filter == TextureSampler::FILTER_LINEAR);
+	switch (wrap)
+	{
+	case TextureSampler::WRAP_CLAMP:
+	case TextureSampler::WRAP_BORDER:
+		return (linear) ? sampleLinear<ComponentType, componentCount, dimension, Texels, ClampIndex> :
+			sampleNearest<ComponentType, componentCount, dimension, Texels, ClampIndex>;
+	case TextureSampler::WRAP_REPEAT:
+		return (linear) ? sampleLinear<ComponentType, componentCount, dimension, Texels, RepeatIndex> :
+			sampleNearest<ComponentType, componentCount, dimension, Texels, RepeatIndex>;
+	case TextureSampler::WRAP_MIRRORED_REPEAT:
+		return (linear) ? sampleLinear<ComponentType, componentCount, dimension, Texels, MirroredRepeatIndex> :
+			sampleNearest<ComponentType, componentCount, dimension, Texels, MirroredRepeatIndex>;
+	}
+	return nullptr;
+}
+
+template <typename ComponentType, int componentCount, int dimension>
+TextureSampler::SampleFunction getSampleFunctionForDimension(TextureSampler::Filter filter,
+	TextureSampler::Wrap wrap, bool bricked)
+{
+	if (bricked)
+		return getSampleFunctionForTexels<ComponentType, componentCount, dimension,
+			BrickTexels<ComponentType, componentCount> >(filter, wrap);
+	return getSampleFunctionForTexels<ComponentType, componentCount, dimension,
+		MemoryTexels<ComponentType, componentCount> >(filter, wrap);
+}
+
+template <typename ComponentType, int componentCount>
+TextureSampler::SampleFunction getSampleFunctionForComponentCount(int dimension,
+	TextureSampler::Filter filter, TextureSampler::Wrap wrap, bool bricked)
+{
+	switch (dimension)
+	{
+	case 1:
+		return getSampleFunctionForDimension<ComponentType, componentCount, 1>(filter, wrap, bricked);
+	case 2:
+		return getSampleFunctionForDimension<ComponentType, componentCount, 2>(filter, wrap, bricked);
+	case 3:
+		return getSampleFunctionForDimension<ComponentType, componentCount, 3>(filter, wrap, bricked);
+	}
+	return nullptr;
+}
+
+template <typename ComponentType>
+TextureSampler::SampleFunction getSampleFunctionForComponentType(int componentCount,
+	int dimension, TextureSampler::Filter filter, TextureSampler::Wrap wrap, bool bricked)
+{
+	switch (componentCount)
+	{
+	case 1:
+		return getSampleFunctionForComponentCount<ComponentType, 1>(dimension, filter, wrap, bricked);
+	case 2:
+		return getSampleFunctionForComponentCount<ComponentType, 2>(dimension, filter, wrap, bricked);
+	case 3:
+		return getSampleFunctionForComponentCount<ComponentType, 3>(dimension, filter, wrap, bricked);
+	case 4:
+		return getSampleFunctionForComponentCount<ComponentType, 4>(dimension, filter, wrap, bricked);
+	}
+	return nullptr;
+}
+
+/**
+ * Box filter two planes of source level into plane of next level with half
+ * the size in each dimension of size > 1. Planes are tightly packed.
+ * @param plane1  Next source plane, or same as plane0 if source has depth 1.
+ */
+template <typename ComponentType>
+void downsamplePlanes(const ComponentType *plane0, const ComponentType *plane1,
+	const int *sourceSizes, const int *sizes, int componentCount, ComponentType *target)
+{
+	for (int y = 0; y < sizes[1]; ++y)
+	{
+		const size_t rowOffsets[2] = {
+			static_cast<size_t>(std::min(2*y, sourceSizes[1] - 1))*sourceSizes[0],
+			static_cast<size_t>(std::min(2*y + 1, sourceSizes[1] - 1))*sourceSizes[0] };
+		for (int x = 0; x < sizes[0]; ++x)
+		{
+			const size_t texelOffsets[4] = {
+				(rowOffsets[0] + std::min(2*x, sourceSizes[0] - 1))*componentCount,
+				(rowOffsets[0] + std::min(2*x + 1, sourceSizes[0] - 1))*componentCount,
+				(rowOffsets[1] + std::min(2*x, sourceSizes[0] - 1))*componentCount,
+				(rowOffsets[1] + std::min(2*x + 1, sourceSizes[0] - 1))*componentCount };
+			for (int c = 0; c < componentCount; ++c)
+			{
+				unsigned int sum = 4;  // for rounding
+				for (int i = 0; i < 4; ++i)
+					sum += plane0[texelOffsets[i] + c] + plane1[texelOffsets[i] + c];
+				*target = static_cast<ComponentType>(sum/8);
+				++target;
+			}
+		}
+	}
+}
+
+}
+
+TextureSampler::TextureSampler(int dimensionIn, const int *sizesIn, int componentCountIn,
+		int bytesPerComponentIn) :
+	dimension(dimensionIn),
+	componentCount(componentCountIn),
+	bytesPerComponent(bytesPerComponentIn),
+	brickStore(nullptr),
+	builtLevelCount(1)
+{
+	int maximumSize = 1;
+	for (int i = 0; i < 3; ++i)
+		maximumSize = std::max(maximumSize, sizesIn[i]);
+	int levelCount = 1;
+	while ((maximumSize >> levelCount) > 0)
+		++levelCount;
+	this->levels.resize(levelCount);
+	for (int n = 0; n < levelCount; ++n)
+	{
+		Level& level = this->levels[n];
+		for (int i = 0; i < 3; ++i)
+			level.sizes[i] = std::max(1, sizesIn[i] >> n);
+		level.data = nullptr;
+		level.strides[0] = componentCountIn;
+		level.strides[1] = level.strides[0]*level.sizes[0];
+		level.strides[2] = level.strides[1]*level.sizes[1];
+	}
+}
+
+TextureSampler::~TextureSampler()
+{
+	TextureBrickStore::deaccess(this->brickStore);
+}
+
+TextureSampler *TextureSampler::create(int dimension, const int *sizes, const int *storedSizes,
+	int componentCount, int bytesPerComponent, const unsigned char *image)
+{
+	if ((dimension < 1) || (dimension > 3) || (!sizes) || (!storedSizes) ||
+		(componentCount < 1) || (componentCount > 4) ||
+		((bytesPerComponent != 1) && (bytesPerComponent != 2)) || (!image))
+	{
+		display_message(ERROR_MESSAGE, "TextureSampler::create.  Invalid argument(s)");
+		return nullptr;
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		if ((sizes[i] < 1) || (storedSizes[i] < sizes[i]))
+		{
+			display_message(ERROR_MESSAGE, "TextureSampler::create.  Invalid image sizes");
+			return nullptr;
+		}
+	}
+	TextureSampler *sampler = new TextureSampler(dimension, sizes, componentCount, bytesPerComponent);
+	Level& level = sampler->levels[0];
+	level.data = image;
+	// rows are padded to 4 bytes, and may be for a larger stored image
+	const size_t rowBytes = ((static_cast<size_t>(storedSizes[0])*componentCount*bytesPerComponent + 3)/4)*4;
+	level.strides[1] = rowBytes/bytesPerComponent;
+	level.strides[2] = level.strides[1]*storedSizes[1];
+	return sampler;
+}
+
+TextureSampler *TextureSampler::create(int dimension, TextureBrickStore *brickStore)
+{
+	if ((dimension < 1) || (dimension > 3) || (!brickStore))
+	{
+		display_message(ERROR_MESSAGE, "TextureSampler::create.  Invalid argument(s)");
+		return nullptr;
+	}
+	TextureSampler *sampler = new TextureSampler(dimension, brickStore->getSizes(),
+		brickStore->getComponentCount(), brickStore->getBytesPerComponent());
+	sampler->brickStore = brickStore->access();
+	return sampler;
+}
+
+bool TextureSampler::readLevelPlane(int levelIndex, int z, unsigned char *plane) const
+{
+	const Level& level = this->levels[levelIndex];
+	const size_t rowBytes = static_cast<size_t>(level.sizes[0])*this->componentCount*this->bytesPerComponent;
+	if (level.data)
+	{
+		for (int y = 0; y < level.sizes[1]; ++y)
+			memcpy(plane + y*rowBytes, level.data +
+				(z*level.strides[2] + y*level.strides[1])*this->bytesPerComponent, rowBytes);
+		return true;
+	}
+	if (this->brickStore)
+	{
+		const int start[3] = { 0, 0, z };
+		const int blockSizes[3] = { level.sizes[0], level.sizes[1], 1 };
+		return this->brickStore->getBlock(start, blockSizes, plane);
+	}
+	return false;
+}
+
+bool TextureSampler::buildLevel(int levelIndex)
+{
+	const Level& source = this->levels[levelIndex - 1];
+	Level& level = this->levels[levelIndex];
+	const size_t sourcePlaneBytes = static_cast<size_t>(source.sizes[0])*source.sizes[1]*
+		this->componentCount*this->bytesPerComponent;
+	const size_t planeBytes = static_cast<size_t>(level.sizes[0])*level.sizes[1]*
+		this->componentCount*this->bytesPerComponent;
+	std::vector<unsigned char> sourcePlanes(2*sourcePlaneBytes);
+	level.storage.resize(planeBytes*level.sizes[2]);
+	for (int z = 0; z < level.sizes[2]; ++z)
+	{
+		const int sourceZ[2] = {
+			std::min(2*z, source.sizes[2] - 1), std::min(2*z + 1, source.sizes[2] - 1) };
+		if (!(this->readLevelPlane(levelIndex - 1, sourceZ[0], sourcePlanes.data()) &&
+			this->readLevelPlane(levelIndex - 1, sourceZ[1], sourcePlanes.data() + sourcePlaneBytes)))
+		{
+			display_message(ERROR_MESSAGE, "TextureSampler::buildLevel.  "
+				"Failed to read level %d to build mip level %d", levelIndex - 1, levelIndex);
+			level.storage.clear();
+			return false;
+		}
+		unsigned char *target = level.storage.data() + z*planeBytes;
+		if (this->bytesPerComponent == 2)
+			downsamplePlanes(reinterpret_cast<const unsigned short *>(sourcePlanes.data()),
+				reinterpret_cast<const unsigned short *>(sourcePlanes.data() + sourcePlaneBytes),
+				source.sizes, level.sizes, this->componentCount, reinterpret_cast<unsigned short *>(target));
+		else
+			downsamplePlanes(sourcePlanes.data(), sourcePlanes.data() + sourcePlaneBytes,
+				source.sizes, level.sizes, this->componentCount, target);
+	}
+	level.data = level.storage.data();
+	return true;
+}
+
+bool TextureSampler::buildLevels(int levelIndex)
+{
+	std::lock_guard<std::mutex> lock(this->buildMutex);
+	int levelCount = this->builtLevelCount.load(std::memory_order_relaxed);
+	while (levelCount <= levelIndex)
+	{
+		if (!this->buildLevel(levelCount))
+			return false;
+		++levelCount;
+		this->builtLevelCount.store(levelCount, std::memory_order_release);
+	}
+	return true;
+}
+
+TextureSampler::SampleFunction TextureSampler::getSampleFunction(Filter filter, Wrap wrap,
+	bool bricked) const
+{
+	if (this->bytesPerComponent == 2)
+		return getSampleFunctionForComponentType<unsigned short>(this->componentCount,
+			this->dimension, filter, wrap, bricked);
+	return getSampleFunctionForComponentType<unsigned char>(this->componentCount,
+		this->dimension, filter, wrap, bricked);
+}
+
+void TextureSampler::sampleLevel(const Settings& settings, int levelIndex,
+	int pointCount, int coordinateCount, const double *coordinates,
+	double *texelCoordinates, double *values) const
+{
+	const Level& level = this->levels[levelIndex];
+	TextureBrickStore *levelBrickStore = (level.data) ? nullptr : this->brickStore;
+	const SampleFunction sampleFunction = this->getSampleFunction(settings.filter, settings.wrap,
+		levelBrickStore != nullptr);
+	double scales[3];
+	for (int d = 0; d < 3; ++d)
+		scales[d] = settings.texelScales[d]*level.sizes[d]/this->levels[0].sizes[d];
+	const int usedCount = std::min(coordinateCount, this->dimension);
+	for (int p = 0; p < pointCount; ++p)
+	{
+		const double *coordinate = coordinates + coordinateCount*p;
+		double *texelCoordinate = texelCoordinates + 3*p;
+		for (int d = 0; d < usedCount; ++d)
+			texelCoordinate[d] = coordinate[d]*scales[d];
+		for (int d = usedCount; d < 3; ++d)
+			texelCoordinate[d] = 0.0;
+	}
+	(sampleFunction)(level, levelBrickStore, pointCount, texelCoordinates, values);
+}
+
+double TextureSampler::getFootprintLevelOfDetail(const Settings& settings, double footprint) const
+{
+	double texels = 0.0;
+	for (int d = 0; d < this->dimension; ++d)
+		texels = std::max(texels, std::fabs(footprint*settings.texelScales[d]));
+	if (texels <= 1.0)
+		return 0.0;
+	return std::log(texels)/std::log(2.0);
+}
+
+bool TextureSampler::sample(const Settings& settings, int pointCount, int coordinateCount,
+	const double *coordinates, double levelOfDetail, double *values)
+{
+	if ((pointCount < 0) || (coordinateCount < 1) || (coordinateCount > 3) ||
+		((0 < pointCount) && ((!coordinates) || (!values))))
+	{
+		display_message(ERROR_MESSAGE, "TextureSampler::sample.  Invalid argument(s)");
+		return false;
+	}
+	if (!this->getSampleFunction(settings.filter, settings.wrap, false))
+	{
+		display_message(ERROR_MESSAGE, "TextureSampler::sample.  Unsupported filter or wrap");
+		return false;
+	}
+	// choose levels and blend weight
+	int levelIndex = 0;
+	int upperLevelIndex = 0;
+	double upperWeight = 0.0;
+	const int maximumLevelIndex = this->getLevelCount() - 1;
+	if ((settings.mipmapFilter != MIPMAP_FILTER_NONE) && (levelOfDetail > 0.0))
+	{
+		const double lod = std::min(levelOfDetail, static_cast<double>(maximumLevelIndex));
+		if (settings.mipmapFilter == MIPMAP_FILTER_NEAREST)
+		{
+			levelIndex = upperLevelIndex = static_cast<int>(lod + 0.5);
+		}
+		else
+		{
+			levelIndex = static_cast<int>(lod);
+			upperWeight = lod - levelIndex;
+			upperLevelIndex = (upperWeight > 0.0) ? levelIndex + 1 : levelIndex;
+		}
+	}
+	if (!this->checkLevel(upperLevelIndex))
+		return false;
+	double texelCoordinates[3*samplePointChunkSize];
+	double upperValues[4*samplePointChunkSize];
+	for (int start = 0; start < pointCount; start += samplePointChunkSize)
+	{
+		const int chunkSize = std::min(samplePointChunkSize, pointCount - start);
+		const double *chunkCoordinates = coordinates + coordinateCount*start;
+		double *chunkValues = values + this->componentCount*start;
+		this->sampleLevel(settings, levelIndex, chunkSize, coordinateCount, chunkCoordinates,
+			texelCoordinates, chunkValues);
+		if (upperLevelIndex != levelIndex)
+		{
+			this->sampleLevel(settings, upperLevelIndex, chunkSize, coordinateCount, chunkCoordinates,
+				texelCoordinates, upperValues);
+			const int valueCount = this->componentCount*chunkSize;
+			for (int i = 0; i < valueCount; ++i)
+				chunkValues[i] += upperWeight*(upperValues[i] - chunkValues[i]);
+		}
+		if (settings.wrap == WRAP_BORDER)
+		{
+			const int usedCount = std::min(coordinateCount, this->dimension);
+			for (int p = 0; p < chunkSize; ++p)
+			{
+				const double *coordinate = chunkCoordinates + coordinateCount*p;
+				bool inBorder = false;
+				for (int d = 0; d < usedCount; ++d)
+				{
+					const double u = coordinate[d]*settings.texelScales[d];
+					inBorder = inBorder || (u < 0.0) || (u > this->levels[0].sizes[d]);
+				}
+				if (inBorder)
+				{
+					double *value = chunkValues + this->componentCount*p;
+					for (int c = 0; c < this->componentCount; ++c)
+						value[c] = settings.borderValues[c];
+				}
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,192 @@
+/**
+ * FILE : texture_sampler.hpp
+ *
+ * CPU-side mip pyramid and specialised samplers for evaluating texture images.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__TEXTURE_SAMPLER_HPP__)
+#define __TEXTURE_SAMPLER_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class TextureBrickStore;
+
+/**
+ * Samples the image of a texture at arrays of texture coordinates with
+ * nearest or linear filtering, optionally from a mip pyramid of successively
+ * halved images. Level 0 is the texture image itself, either in memory or in a
+ * brick store; coarser levels are box filtered from the previous level and
+ * held in memory, built on demand the first time they are needed.
+ * Sampling loops are instantiated for each combination of component type,
+ * number of components, dimension, filter and wrap so the choice is made once
+ * per call, not per texel. Sampling is thread safe.
+ * The sampler does not own the level 0 image; it must be discarded whenever
+ * the texture image changes.
+ */
+class TextureSampler
+{
+public:
+	enum Filter
+	{
+		FILTER_NEAREST,
+		FILTER_LINEAR
+	};
+
+	enum MipmapFilter
+	{
+		MIPMAP_FILTER_NONE,  // always sample level 0
+		MIPMAP_FILTER_NEAREST,  // sample level nearest level of detail
+		MIPMAP_FILTER_LINEAR  // blend samples from levels either side of level of detail
+	};
+
+	enum Wrap
+	{
+		WRAP_CLAMP,  // clamp to edge texels
+		WRAP_BORDER,  // clamp to edge texels, or border values outside image
+		WRAP_REPEAT,
+		WRAP_MIRRORED_REPEAT
+	};
+
+	/** Per-call sampling options */
+	struct Settings
+	{
+		Filter filter;
+		MipmapFilter mipmapFilter;
+		Wrap wrap;
+		/* level 0 texels per unit texture coordinate in each direction */
+		double texelScales[3];
+		/* values for texture coordinates outside image with WRAP_BORDER */
+		double borderValues[4];
+	};
+
+	/** Image data for one mip level */
+	struct Level
+	{
+		int sizes[3];
+		/* data for in-memory levels, with texels at strides[0], rows at
+		 * strides[1] and planes at strides[2] in components */
+		const unsigned char *data;
+		size_t strides[3];
+		std::vector<unsigned char> storage;  // owned data for levels > 0
+	};
+
+	/** Sample values for pointCount points at 3 coordinates each in texel
+	 * units of the level, returning componentCount values for each point.
+	 * @param brickStore  Store to read texels from if level has no data. */
+	typedef void (*SampleFunction)(const Level& level, TextureBrickStore *brickStore,
+		int pointCount, const double *texelCoordinates, double *values);
+
+private:
+	int dimension;
+	int componentCount;
+	int bytesPerComponent;
+	TextureBrickStore *brickStore;  // accessed if level 0 is in brick store
+	std::vector<Level> levels;  // all levels allocated, up to builtLevelCount built
+	std::atomic<int> builtLevelCount;
+	std::mutex buildMutex;
+
+	TextureSampler(int dimensionIn, const int *sizesIn, int componentCountIn,
+		int bytesPerComponentIn);
+
+	TextureSampler();  // not implemented
+	TextureSampler(const TextureSampler &source);  // not implemented
+	TextureSampler& operator=(const TextureSampler &source);  // not implemented
+
+	bool readLevelPlane(int levelIndex, int z, unsigned char *plane) const;
+
+	bool buildLevel(int levelIndex);
+
+	/** Ensure levels up to levelIndex are built. @return  True on success. */
+	bool checkLevel(int levelIndex)
+	{
+		if (levelIndex < this->builtLevelCount.load(std::memory_order_acquire))
+			return true;
+		return this->buildLevels(levelIndex);
+	}
+
+	bool buildLevels(int levelIndex);
+
+	SampleFunction getSampleFunction(Filter filter, Wrap wrap, bool bricked) const;
+
+	void sampleLevel(const Settings& settings, int levelIndex,
+		int pointCount, int coordinateCount, const double *coordinates,
+		double *texelCoordinates, double *values) const;
+
+public:
+
+	/**
+	 * Create sampler for in-memory image with rows padded to 4 bytes, as in
+	 * Texture. Image must remain valid for the lifetime of the sampler.
+	 * @param dimension  Image dimension 1 to 3.
+	 * @param sizes  Size of image in texels in x, y, z, 1 for unused dimensions.
+	 * @param storedSizes  Size of image storage, at least sizes.
+	 * @param componentCount  Number of components 1 to 4.
+	 * @param bytesPerComponent  1 or 2, with 2 byte components in native order.
+	 * @return  New sampler or nullptr if invalid arguments.
+	 */
+	static TextureSampler *create(int dimension, const int *sizes, const int *storedSizes,
+		int componentCount, int bytesPerComponent, const unsigned char *image);
+
+	/**
+	 * Create sampler for image in brickStore, which it accesses.
+	 * @return  New sampler or nullptr if invalid arguments.
+	 */
+	static TextureSampler *create(int dimension, TextureBrickStore *brickStore);
+
+	~TextureSampler();
+
+	int getComponentCount() const
+	{
+		return this->componentCount;
+	}
+
+	/** @return  Number of mip levels including level 0. */
+	int getLevelCount() const
+	{
+		return static_cast<int>(this->levels.size());
+	}
+
+	/** @return  Number of levels built so far, including level 0. */
+	int getBuiltLevelCount() const
+	{
+		return this->builtLevelCount.load(std::memory_order_acquire);
+	}
+
+	/** @return  Size of level in texels in x, y, z. */
+	const int *getLevelSizes(int levelIndex) const
+	{
+		return this->levels[levelIndex].sizes;
+	}
+
+	/**
+	 * Get level of detail at which one texel spans footprint in texture
+	 * coordinates along the most minified direction.
+	 * @param footprint  Distance between samples in texture coordinates.
+	 * @return  Level of detail >= 0.
+	 */
+	double getFootprintLevelOfDetail(const Settings& settings, double footprint) const;
+
+	/**
+	 * Sample image at pointCount points.
+	 * @param coordinateCount  Number of texture coordinates per point, 1 to 3.
+	 * Missing coordinates are taken as 0.
+	 * @param coordinates  Texture coordinates for each point in turn.
+	 * @param levelOfDetail  Mip level to sample with mipmap filters, where 0 is
+	 * the full image and each level halves the resolution.
+	 * @param values  Array receiving componentCount values for each point in
+	 * turn, in the range [0,1].
+	 * @return  True on success.
+	 */
+	bool sample(const Settings& settings, int pointCount, int coordinateCount,
+		const double *coordinates, double levelOfDetail, double *values);
+
+};
+
+#endif /* !defined (__TEXTURE_SAMPLER_HPP__) */
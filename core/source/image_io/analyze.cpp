@@ -9,14 +9,19 @@
 #include <sstream>
 #include <fstream>
 #include <stdint.h>
+#include <string>
+#include <vector>
 #include "general/debug.h"
 #include "general/io_stream.h"
 #include "analyze.h"
+#include "opencmiss/zinc/status.h"
 #include "opencmiss/zinc/types/streamid.h"
 #include "general/image_utilities.h"
 #include "general/mystring.h"
 #include "general/debug.h"
 #include "general/message.h"
+#include "graphics/texture.h"
+#include "image_io/volume_reader.hpp"
 
 #if defined (ZINC_USE_IMAGEMAGICK)
 #  if defined _MSC_VER
@@ -354,6 +359,74 @@ struct Cmgui_image *Cmgui_image_read_analyze(
 	return cmgui_image;
 }
 
+int Texture_read_analyze_volume(struct Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information,
+	enum cmzn_streaminformation_data_compression_type data_compression_type,
+	const char *source_name)
+{
+	if (!((texture) && (cmgui_image_information)))
+		return CMZN_ERROR_ARGUMENT;
+	if ((!cmgui_image_information->file_names) ||
+		(cmgui_image_information->number_of_file_names < 1) ||
+		(cmgui_image_information->memory_blocks) ||
+		(data_compression_type == CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_GZIP) ||
+		(data_compression_type == CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_BZIP2))
+		return CMZN_ERROR_NOT_IMPLEMENTED;
+	const int number_of_files = cmgui_image_information->number_of_file_names;
+	int width = 0, height = 0, datatype = 0, glmin = 0, glmax = 0;
+	bool big_endian = false;
+	std::vector<std::string> image_file_names(number_of_files);
+	std::vector<long long> offsets(number_of_files);
+	std::vector<int> depths(number_of_files);
+	for (int i = 0; i < number_of_files; ++i)
+	{
+		const char *file_name = cmgui_image_information->file_names[i];
+		AnalyzeImageHandler analyze(ANALYZE_STREAMS_TYPE_FILE);
+		// let the general reader report files it cannot open
+		if (!(analyze.setFilename(file_name) && analyze.readHeader()))
+			return CMZN_ERROR_NOT_IMPLEMENTED;
+		const int number_of_dimensions = analyze.getNumberOfDimensions();
+		if ((number_of_dimensions != 2) && (number_of_dimensions != 3))
+			return CMZN_ERROR_NOT_IMPLEMENTED;
+		if (0 == i)
+		{
+			width = analyze.getWidth();
+			height = analyze.getHeight();
+			datatype = analyze.getDatatype();
+			big_endian = analyze.isBigEndian();
+			glmin = analyze.getGlMin();
+			glmax = analyze.getGlMax();
+			if (!((datatype == ANALYZE_DT_UNSIGNED_CHAR) ||
+				(datatype == ANALYZE_DT_SIGNED_SHORT) ||
+				((datatype == ANALYZE_DT_FLOAT) && (glmin < glmax))))
+				return CMZN_ERROR_NOT_IMPLEMENTED;
+		}
+		else if ((analyze.getWidth() != width) || (analyze.getHeight() != height) ||
+			(analyze.getDatatype() != datatype) || (analyze.isBigEndian() != big_endian))
+		{
+			display_message(ERROR_MESSAGE, "Texture_read_analyze_volume.  "
+				"Analyze file '%s' does not match size or data type of first file", file_name);
+			return CMZN_ERROR_ARGUMENT;
+		}
+		char *image_file_name = analyze.getImageFilename();
+		if (!image_file_name)
+			return CMZN_ERROR_MEMORY;
+		image_file_names[i] = image_file_name;
+		DEALLOCATE(image_file_name);
+		offsets[i] = analyze.getVoxelOffset();
+		depths[i] = (number_of_dimensions == 3) ? analyze.getDepth() : 1;
+	}
+	const VolumeReader::VoxelType voxel_type =
+		(datatype == ANALYZE_DT_UNSIGNED_CHAR) ? VolumeReader::VOXEL_TYPE_UNSIGNED_8 :
+		(datatype == ANALYZE_DT_SIGNED_SHORT) ? VolumeReader::VOXEL_TYPE_SIGNED_16 :
+		VolumeReader::VOXEL_TYPE_FLOAT_32;
+	VolumeReader reader(width, height, /*componentCount*/1, voxel_type, big_endian);
+	reader.setFloatRange(static_cast<double>(glmin), static_cast<double>(glmax));
+	for (int i = 0; i < number_of_files; ++i)
+		reader.addFile(image_file_names[i].c_str(), offsets[i], depths[i]);
+	return reader.read(texture, source_name);
+}
+
 enum EndianEnum systemEndianTest()
 {
 	unsigned char swapTest[2] = { 1, 0 };
@@ -745,13 +818,27 @@ void AnalyzeImageHandler::readImageData(void *imgBuffer, int buffer_length)
 	readImageInternal(static_cast<unsigned int>(sz));
 }
 
-void AnalyzeImageHandler::readImageData()
+long long AnalyzeImageHandler::getVoxelOffset() const
+{
+	return (hdr.dime.vox_offset > 0.0) ? static_cast<long long>(hdr.dime.vox_offset) : 0;
+}
+
+char *AnalyzeImageHandler::getImageFilename() const
 {
 	char *data_filename = duplicate_string(filename);
-	size_t len = strlen(data_filename);
-	data_filename[len-3] = 'i';
-	data_filename[len-2] = 'm';
-	data_filename[len-1] = 'g';
+	if (data_filename)
+	{
+		size_t len = strlen(data_filename);
+		data_filename[len-3] = 'i';
+		data_filename[len-2] = 'm';
+		data_filename[len-1] = 'g';
+	}
+	return data_filename;
+}
+
+void AnalyzeImageHandler::readImageData()
+{
+	char *data_filename = getImageFilename();
 #if PRINT_ANALYZE_INFO
 	printf("filename = %s\n", data_filename);
 #endif
@@ -15,6 +15,7 @@
 
 struct Cmgui_image_information;
 struct Cmgui_image;
+struct Texture;
 
 enum AnalyzeStreamsType
 {
@@ -43,6 +44,9 @@ public:
 	int getGlMax() const;
 	int getGlMin() const;
 	const char *getQuantumFormat() const;
+	int getDatatype() const { return hdr.dime.datatype; }
+	long long getVoxelOffset() const;
+	char *getImageFilename() const;
 	bool isBigEndian() const { return bigEndian; }
 	bool setFilename(const char *filenameIn);
 
@@ -87,6 +91,24 @@ struct Cmgui_image *Cmgui_image_read_analyze(
 	struct Cmgui_image_information *cmgui_image_information,
 	enum cmzn_streaminformation_data_compression_type data_compression_type);
 
+/**
+ * Reads the uncompressed Analyze volume files listed in the image information
+ * directly into the texture, without ImageMagick or an intermediate
+ * Cmgui_image. Unsigned char and signed short volumes are read directly, as
+ * are float volumes whose header gives the glmin to glmax range mapped to the
+ * full range of 2 byte texels. Files are stacked in order, each adding its
+ * depth planes.
+ *
+ * @param source_name  Name recorded as the texture's image file name.
+ * @return  CMZN_OK on success, CMZN_ERROR_NOT_IMPLEMENTED if the files are
+ * compressed, in memory or of a data type not read directly, in which case
+ * Cmgui_image_read_analyze must be used, otherwise any other error code.
+ */
+int Texture_read_analyze_volume(struct Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information,
+	enum cmzn_streaminformation_data_compression_type data_compression_type,
+	const char *source_name);
+
 typedef ::size_t      BufferSizeType;
 
 void SwapRange2(void *void_p, BufferSizeType n);
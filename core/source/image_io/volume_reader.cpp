@@ -0,0 +1,285 @@
+/**
+ * FILE : volume_reader.cpp
+ *
+ * Direct reader of uncompressed binary voxel data into texture images.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "opencmiss/zinc/status.h"
+#include "general/image_utilities.h"
+#include "general/message.h"
+#include "general/parallel.hpp"
+#include "graphics/texture.h"
+#include "image_io/analyze.h"
+#include "image_io/volume_reader.hpp"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+
+namespace {
+
+inline uint16_t swapBytes16(uint16_t value)
+{
+	return static_cast<uint16_t>((value >> 8) | (value << 8));
+}
+
+inline uint32_t swapBytes32(uint32_t value)
+{
+	return (value >> 24) | ((value >> 8) & 0xff00u) |
+		((value << 8) & 0xff0000u) | (value << 24);
+}
+
+/*
+ * Row conversions read the unaligned source with memcpy and have no branches
+ * inside the loop so compilers vectorise them, including the byte swaps.
+ */
+
+void convertRow16(const unsigned char *source, uint16_t *destination,
+	size_t count, bool swapBytes, uint16_t signFlip)
+{
+	if (swapBytes)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint16_t value;
+			memcpy(&value, source + 2*i, 2);
+			destination[i] = swapBytes16(value) ^ signFlip;
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint16_t value;
+			memcpy(&value, source + 2*i, 2);
+			destination[i] = value ^ signFlip;
+		}
+	}
+}
+
+inline uint16_t floatToTexel(float value, double minimum, double scale)
+{
+	const double texel = (value - minimum)*scale + 0.5;
+	// NaN fails the first test so maps to 0
+	return (!(texel > 0.0)) ? 0 : (texel >= 65535.0) ? 65535 : static_cast<uint16_t>(texel);
+}
+
+void convertRowFloat(const unsigned char *source, uint16_t *destination,
+	size_t count, bool swapBytes, double minimum, double scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t bits;
+		memcpy(&bits, source + 4*i, 4);
+		if (swapBytes)
+			bits = swapBytes32(bits);
+		float value;
+		memcpy(&value, &bits, 4);
+		destination[i] = floatToTexel(value, minimum, scale);
+	}
+}
+
+int getVoxelTypeBytes(VolumeReader::VoxelType voxelType)
+{
+	switch (voxelType)
+	{
+	case VolumeReader::VOXEL_TYPE_UNSIGNED_8:
+		return 1;
+	case VolumeReader::VOXEL_TYPE_UNSIGNED_16:
+	case VolumeReader::VOXEL_TYPE_SIGNED_16:
+		return 2;
+	case VolumeReader::VOXEL_TYPE_FLOAT_32:
+		return 4;
+	case VolumeReader::VOXEL_TYPE_INVALID:
+		break;
+	}
+	return 0;
+}
+
+}
+
+VolumeReader::VolumeReader(int widthIn, int heightIn, int componentCountIn,
+		VoxelType voxelTypeIn, bool bigEndian) :
+	width(widthIn),
+	height(heightIn),
+	componentCount(componentCountIn),
+	voxelType(voxelTypeIn),
+	swapBytes(bigEndian != (EndianBig == systemEndianTest())),
+	floatMinimum(0.0),
+	floatMaximum(0.0),
+	depth(0)
+{
+}
+
+void VolumeReader::addFile(const char *fileName, long long offset, int planeCount)
+{
+	File file;
+	file.name = fileName;
+	file.offset = offset;
+	file.planeCount = planeCount;
+	file.firstPlane = this->depth;
+	this->files.push_back(file);
+	this->depth += planeCount;
+}
+
+long long VolumeReader::getPlaneBytes() const
+{
+	return static_cast<long long>(this->width)*this->height*this->componentCount*
+		getVoxelTypeBytes(this->voxelType);
+}
+
+void VolumeReader::convertRow(const unsigned char *source, unsigned char *destination) const
+{
+	const size_t count = static_cast<size_t>(this->width)*this->componentCount;
+	switch (this->voxelType)
+	{
+	case VOXEL_TYPE_UNSIGNED_8:
+		memcpy(destination, source, count);
+		break;
+	case VOXEL_TYPE_UNSIGNED_16:
+		convertRow16(source, reinterpret_cast<uint16_t *>(destination), count, this->swapBytes, 0);
+		break;
+	case VOXEL_TYPE_SIGNED_16:
+		convertRow16(source, reinterpret_cast<uint16_t *>(destination), count, this->swapBytes, 0x8000);
+		break;
+	case VOXEL_TYPE_FLOAT_32:
+		convertRowFloat(source, reinterpret_cast<uint16_t *>(destination), count, this->swapBytes,
+			this->floatMinimum, 65535.0/(this->floatMaximum - this->floatMinimum));
+		break;
+	case VOXEL_TYPE_INVALID:
+		break;
+	}
+}
+
+int VolumeReader::read(Texture *texture, const char *sourceName) const
+{
+	const enum Texture_storage_type storage =
+		Texture_storage_type_from_number_of_components(this->componentCount);
+	if ((!texture) || (this->width < 1) || (this->height < 1) || (this->depth < 1) ||
+		(TEXTURE_STORAGE_TYPE_INVALID == storage) || (0 == getVoxelTypeBytes(this->voxelType)) ||
+		((VOXEL_TYPE_FLOAT_32 == this->voxelType) && (!(this->floatMaximum > this->floatMinimum))))
+	{
+		display_message(ERROR_MESSAGE, "VolumeReader::read.  Invalid arguments");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	if (!Texture_allocate_image(texture, this->width, this->height, this->depth, storage,
+		this->getTextureBytesPerComponent(), sourceName))
+	{
+		display_message(ERROR_MESSAGE, "VolumeReader::read.  Could not allocate texture image");
+		return CMZN_ERROR_MEMORY;
+	}
+	int paddedRowBytes = 0;
+	unsigned char *texels = Texture_access_image_texels(texture, &paddedRowBytes);
+	if (!texels)
+		return CMZN_ERROR_GENERAL;
+	const long long planeBytes = this->getPlaneBytes();
+	const size_t sourceRowBytes = static_cast<size_t>(planeBytes/this->height);
+	const size_t texturePlaneBytes = static_cast<size_t>(paddedRowBytes)*this->height;
+	const int threadCount = CMZN::parallel_get_thread_count(static_cast<size_t>(this->depth));
+	// each thread reads into its own buffer from its own stream, which stays
+	// open on the last file it read from
+	std::vector< std::vector<unsigned char> > buffers(threadCount,
+		std::vector<unsigned char>(static_cast<size_t>(planeBytes)));
+	std::vector<std::ifstream> streams(threadCount);
+	std::vector<size_t> fileIndexes(threadCount, this->files.size());
+	std::atomic<int> failedPlane(this->depth);
+	CMZN::parallel_for(0, static_cast<size_t>(this->depth), threadCount,
+		[&](int threadIndex, size_t index)
+		{
+			const int plane = static_cast<int>(index);
+			std::ifstream& stream = streams[threadIndex];
+			size_t& f = fileIndexes[threadIndex];
+			if ((f == this->files.size()) || (plane < this->files[f].firstPlane) ||
+				(plane >= this->files[f].firstPlane + this->files[f].planeCount))
+			{
+				f = 0;
+				while (plane >= this->files[f].firstPlane + this->files[f].planeCount)
+					++f;
+				stream.close();
+				stream.clear();
+				stream.open(this->files[f].name.c_str(), std::ifstream::binary);
+			}
+			const File& file = this->files[f];
+			std::vector<unsigned char>& buffer = buffers[threadIndex];
+			stream.seekg(file.offset + (plane - file.firstPlane)*planeBytes);
+			if (!stream.read(reinterpret_cast<char *>(buffer.data()), planeBytes))
+			{
+				// remember lowest failed plane so the error is deterministic
+				int failed = failedPlane;
+				while ((plane < failed) && (!failedPlane.compare_exchange_weak(failed, plane)))
+				{
+				}
+				stream.close();
+				f = this->files.size();
+				return;
+			}
+			unsigned char *destination = texels + plane*texturePlaneBytes;
+			// file rows are top to bottom, texture rows bottom to top
+			for (int row = this->height - 1; row >= 0; --row)
+			{
+				this->convertRow(buffer.data() + row*sourceRowBytes, destination);
+				destination += paddedRowBytes;
+			}
+		});
+	if (failedPlane < this->depth)
+	{
+		size_t f = 0;
+		while (failedPlane >= this->files[f].firstPlane + this->files[f].planeCount)
+			++f;
+		display_message(ERROR_MESSAGE, "VolumeReader::read.  Could not read plane %d of file %s",
+			failedPlane - this->files[f].firstPlane + 1, this->files[f].name.c_str());
+		return CMZN_ERROR_GENERAL;
+	}
+	return CMZN_OK;
+}
+
+int Texture_read_raw_volume(Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information, const char *sourceName)
+{
+	if (!((texture) && (cmgui_image_information)))
+		return CMZN_ERROR_ARGUMENT;
+	const int componentCount = cmgui_image_information->number_of_components;
+	const int bytesPerComponent = cmgui_image_information->number_of_bytes_per_component;
+	if ((!cmgui_image_information->file_names) ||
+		(cmgui_image_information->number_of_file_names < 1) ||
+		(cmgui_image_information->memory_blocks) ||
+		(cmgui_image_information->width < 1) || (cmgui_image_information->height < 1) ||
+		(componentCount < 1) || (componentCount > 4) ||
+		((1 < componentCount) && (RAW_INTERLEAVED_RGB != cmgui_image_information->raw_image_storage)) ||
+		(bytesPerComponent < 0) || (bytesPerComponent > 2))
+		return CMZN_ERROR_NOT_IMPLEMENTED;
+	VolumeReader reader(cmgui_image_information->width, cmgui_image_information->height,
+		componentCount, (2 == bytesPerComponent) ?
+			VolumeReader::VOXEL_TYPE_UNSIGNED_16 : VolumeReader::VOXEL_TYPE_UNSIGNED_8,
+		EndianBig == systemEndianTest());
+	const long long planeBytes = reader.getPlaneBytes();
+	for (int i = 0; i < cmgui_image_information->number_of_file_names; ++i)
+	{
+		const char *fileName = cmgui_image_information->file_names[i];
+		enum Image_file_format imageFileFormat = cmgui_image_information->image_file_format;
+		if ((UNKNOWN_IMAGE_FILE_FORMAT == imageFileFormat) &&
+				(!Image_file_format_from_file_name(fileName, &imageFileFormat)))
+			return CMZN_ERROR_NOT_IMPLEMENTED;
+		if (RAW_FILE_FORMAT != imageFileFormat)
+			return CMZN_ERROR_NOT_IMPLEMENTED;
+		// names which do not open, e.g. with a format prefix, are left to ImageMagick
+		std::ifstream stream(fileName, std::ifstream::binary | std::ifstream::ate);
+		if (!stream.is_open())
+			return CMZN_ERROR_NOT_IMPLEMENTED;
+		const long long fileBytes = static_cast<long long>(stream.tellg());
+		if ((fileBytes < planeBytes) || (0 != fileBytes % planeBytes))
+		{
+			display_message(ERROR_MESSAGE, "Texture_read_raw_volume.  "
+				"Size of raw file %s is not a whole number of %d x %d planes", fileName,
+				cmgui_image_information->width, cmgui_image_information->height);
+			return CMZN_ERROR_ARGUMENT;
+		}
+		reader.addFile(fileName, 0, static_cast<int>(fileBytes/planeBytes));
+	}
+	return reader.read(texture, sourceName);
+}
@@ -0,0 +1,130 @@
+/**
+ * FILE : volume_reader.hpp
+ *
+ * Direct reader of uncompressed binary voxel data into texture images.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__VOLUME_READER_HPP__)
+#define __VOLUME_READER_HPP__
+
+#include <string>
+#include <vector>
+
+struct Cmgui_image_information;
+struct Texture;
+
+/**
+ * Reads planes of uncompressed voxels from one or more binary files straight
+ * into a newly allocated texture image, bypassing ImageMagick and the
+ * intermediate Cmgui_image. Each plane is read with a single stream read and
+ * converted into its final place in the texture in one pass, swapping bytes
+ * if the file endianness differs from the system, and flipping rows from the
+ * top-to-bottom file order to the bottom-to-top texture order. Planes are read
+ * in parallel, each thread with its own file streams.
+ * Voxel values are stored in the texture as follows:
+ * - unsigned 8 bit: unchanged in 1 byte components;
+ * - unsigned 16 bit: unchanged in 2 byte components;
+ * - signed 16 bit: offset by 32768 into 2 byte components;
+ * - 32 bit float: linearly mapped from the value range set with
+ *   setFloatRange to 0 to 65535 in 2 byte components, clamped and rounded.
+ */
+class VolumeReader
+{
+public:
+	enum VoxelType
+	{
+		VOXEL_TYPE_INVALID = 0,
+		VOXEL_TYPE_UNSIGNED_8 = 1,
+		VOXEL_TYPE_UNSIGNED_16 = 2,
+		VOXEL_TYPE_SIGNED_16 = 3,
+		VOXEL_TYPE_FLOAT_32 = 4
+	};
+
+private:
+	struct File
+	{
+		std::string name;
+		long long offset;  // bytes before first plane
+		int planeCount;
+		int firstPlane;  // index of first plane in texture
+	};
+
+	int width;
+	int height;
+	int componentCount;
+	VoxelType voxelType;
+	bool swapBytes;
+	double floatMinimum;
+	double floatMaximum;
+	std::vector<File> files;
+	int depth;
+
+	VolumeReader();  // not implemented
+	VolumeReader(const VolumeReader &source);  // not implemented
+	VolumeReader& operator=(const VolumeReader &source);  // not implemented
+
+	void convertRow(const unsigned char *source, unsigned char *destination) const;
+
+public:
+
+	/**
+	 * @param widthIn  Number of voxels in each row.
+	 * @param heightIn  Number of rows in each plane.
+	 * @param componentCountIn  Number of interleaved components per voxel, 1 to 4.
+	 * @param voxelTypeIn  Type of each component in file.
+	 * @param bigEndian  True if multi-byte values are stored most significant
+	 * byte first, false if least significant byte first.
+	 */
+	VolumeReader(int widthIn, int heightIn, int componentCountIn,
+		VoxelType voxelTypeIn, bool bigEndian);
+
+	/** Set range of float values mapped to 0 to 65535 */
+	void setFloatRange(double minimum, double maximum)
+	{
+		this->floatMinimum = minimum;
+		this->floatMaximum = maximum;
+	}
+
+	/**
+	 * Add file containing planeCount planes of voxels starting offset bytes
+	 * into the file. Planes from successive files are stacked in order.
+	 */
+	void addFile(const char *fileName, long long offset, int planeCount);
+
+	/** @return  Number of bytes in each plane of file data. */
+	long long getPlaneBytes() const;
+
+	/** @return  Number of bytes per component in texture: 1 or 2. */
+	int getTextureBytesPerComponent() const
+	{
+		return (VOXEL_TYPE_UNSIGNED_8 == this->voxelType) ? 1 : 2;
+	}
+
+	/**
+	 * Allocate texture image for all planes in files and read them into it.
+	 * @param sourceName  Name recorded as the texture's image file name.
+	 * @return  CMZN_OK on success, otherwise any other error code.
+	 */
+	int read(Texture *texture, const char *sourceName) const;
+
+};
+
+/**
+ * Read raw volume files listed in the image information directly into texture.
+ * Files must have RAW_FILE_FORMAT, explicitly or from their .raw extension,
+ * and contain planes of the width and height in the image information with
+ * number_of_components interleaved components of 1 or 2 bytes, the latter in
+ * native byte order. Each file may contain any number of whole planes.
+ * @param sourceName  Name recorded as the texture's image file name.
+ * @return  CMZN_OK on success, CMZN_ERROR_NOT_IMPLEMENTED if the image
+ * information does not describe raw volume files in a form read directly, or
+ * other error code if reading failed.
+ */
+int Texture_read_raw_volume(Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information, const char *sourceName);
+
+#endif /* !defined (__VOLUME_READER_HPP__) */
@@ -4,7 +4,8 @@ FILE : computed_field_binary_threshold_image_filter.cpp
 LAST MODIFIED : 16 May 2008
 
 DESCRIPTION :
-Wraps itk::BinaryThresholdImageFilter
+Binary threshold image filter evaluated with native kernel equivalent to
+itk::BinaryThresholdImageFilter
 ==============================================================================*/
 /* OpenCMISS-Zinc Library
 *
@@ -20,9 +21,15 @@ Wraps itk::BinaryThresholdImageFilter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_binary_threshold_image_filter.h"
+#include "graphics/texture.h"
+#include "graphics/texture.hpp"
+#include "graphics/texture_range_tree.hpp"
+#include "image_processing/image_filter_kernels.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkBinaryThresholdImageFilter.h"
 
 using namespace CMZN;
 
@@ -137,6 +144,91 @@ int Computed_field_binary_threshold_image_filter::compare(Computed_field_core *o
 	return (return_code);
 } /* Computed_field_binary_threshold_image_filter::compare */
 
+/**
+ * Threshold the texels of the source image field's texture straight into the
+ * output image, using the texture's min/max range tree to fill bricks entirely
+ * inside or outside the thresholds without reading their texels. Equivalent
+ * to itk::BinaryThresholdImageFilter on the input image.
+ *
+ * @param minimum, maximum  Output range of source image field.
+ * @return  1 on success, 0 on failure.
+ */
+template < class ImageType >
+int Computed_field_binary_threshold_image_filter_threshold_texture(
+	Computed_field_binary_threshold_image_filter *binary_threshold_image_filter,
+	struct Texture *texture, TextureRangeTree *range_tree, double minimum, double maximum,
+	typename ImageType::PixelType inside_value, typename ImageType::PixelType outside_value,
+	typename ImageType::Pointer &outputImage)
+{
+	typedef typename ImageType::PixelType PixelType;
+	int texel_lower, texel_upper;
+	if (!Texture_get_original_texel_value_interval(texture, minimum, maximum,
+		binary_threshold_image_filter->lower_threshold,
+		binary_threshold_image_filter->upper_threshold, &texel_lower, &texel_upper))
+	{
+		return 0;
+	}
+	std::vector<unsigned char> brick_classes;
+	range_tree->classifyBricks(/*component*/0, texel_lower, texel_upper, brick_classes);
+	binary_threshold_image_filter->allocate_image(outputImage, static_cast<ImageType*>(NULL));
+	PixelType *output = outputImage->GetBufferPointer();
+	const int image_sizes[3] = { binary_threshold_image_filter->sizes[0],
+		(binary_threshold_image_filter->dimension > 1) ? binary_threshold_image_filter->sizes[1] : 1,
+		(binary_threshold_image_filter->dimension > 2) ? binary_threshold_image_filter->sizes[2] : 1 };
+	const int brick_size = range_tree->getBrickSize();
+	const int *brick_counts = range_tree->getBrickCounts();
+	const ZnReal lower = binary_threshold_image_filter->lower_threshold;
+	const ZnReal upper = binary_threshold_image_filter->upper_threshold;
+	std::vector<ZnReal> brick_values;
+	int brick = 0;
+	for (int bk = 0; bk < brick_counts[2]; ++bk)
+	{
+		for (int bj = 0; bj < brick_counts[1]; ++bj)
+		{
+			for (int bi = 0; bi < brick_counts[0]; ++bi, ++brick)
+			{
+				const int start[3] = { bi*brick_size, bj*brick_size, bk*brick_size };
+				int block_sizes[3];
+				for (int i = 0; i < 3; ++i)
+				{
+					block_sizes[i] = std::min(brick_size, image_sizes[i] - start[i]);
+				}
+				const unsigned char brick_class = brick_classes[brick];
+				if (TextureRangeTree::BRICK_STRADDLE == brick_class)
+				{
+					brick_values.resize(block_sizes[0]*block_sizes[1]*block_sizes[2]);
+					if (!Texture_get_original_texel_block_values(texture, start, block_sizes,
+						minimum, maximum, brick_values.data()))
+					{
+						return 0;
+					}
+				}
+				const ZnReal *value = brick_values.data();
+				for (int k = start[2]; k < start[2] + block_sizes[2]; ++k)
+				{
+					for (int j = start[1]; j < start[1] + block_sizes[1]; ++j)
+					{
+						PixelType *pixel = output + (static_cast<size_t>(k)*image_sizes[1] + j)*image_sizes[0] + start[0];
+						if (TextureRangeTree::BRICK_STRADDLE == brick_class)
+						{
+							for (int i = 0; i < block_sizes[0]; ++i, ++value)
+							{
+								pixel[i] = ((lower <= *value) && (*value <= upper)) ? inside_value : outside_value;
+							}
+						}
+						else
+						{
+							std::fill(pixel, pixel + block_sizes[0],
+								(TextureRangeTree::BRICK_INSIDE == brick_class) ? inside_value : outside_value);
+						}
+					}
+				}
+			}
+		}
+	}
+	return 1;
+}
+
 template < class ImageType >
 class Computed_field_binary_threshold_image_filter_Functor :
 	public computed_field_image_filter_FunctorTmpl< ImageType >
@@ -160,28 +252,40 @@ public:
 	}
 
 /*****************************************************************************//**
- * Create a filter of the correct type, set the filter specific parameters
- * and generate the output
+ * Generate the output image from the source texture or with the native kernel
  * 
  * @param location Field location
  * @return Return code indicating succes (1) or failure (0)
 */
 	int set_filter(cmzn_fieldcache& cache)
 	{
-		int return_code;
-		
-		typedef itk::BinaryThresholdImageFilter< ImageType , ImageType > FilterType;
-		
-		typename FilterType::Pointer filter = FilterType::New();
-		
-		filter->SetLowerThreshold( binary_threshold_image_filter->lower_threshold );
-		filter->SetUpperThreshold( binary_threshold_image_filter->upper_threshold );
-		
-		return_code = binary_threshold_image_filter->update_output_image
-			(cache, filter, this->outputImage,
-			static_cast<ImageType*>(NULL), static_cast<FilterType*>(NULL));
-		
-		return (return_code);
+		// default values of itk::BinaryThresholdImageFilter
+		const ZnReal inside_value = std::numeric_limits<ZnReal>::max();
+		const ZnReal outside_value = 0.0;
+
+		// threshold image field texels directly, skipping bricks outside or inside range
+		double minimum, maximum;
+		struct Texture *texture = binary_threshold_image_filter->get_source_pixel_centre_texture(
+			cache, minimum, maximum);
+		TextureRangeTree *range_tree = (texture) ? Texture_get_range_tree(texture) : 0;
+		if (range_tree)
+		{
+			return Computed_field_binary_threshold_image_filter_threshold_texture<ImageType>(
+				binary_threshold_image_filter, texture, range_tree, minimum, maximum,
+				inside_value, outside_value, this->outputImage);
+		}
+
+		// otherwise pointwise so evaluated natively in place
+		if (!binary_threshold_image_filter->create_native_output_image(cache, this->outputImage,
+			static_cast<ImageType*>(NULL)))
+		{
+			return 0;
+		}
+		image_kernel_binary_threshold(this->outputImage->GetBufferPointer(),
+			binary_threshold_image_filter->get_pixel_count(),
+			binary_threshold_image_filter->lower_threshold,
+			binary_threshold_image_filter->upper_threshold, inside_value, outside_value);
+		return 1;
 	} /* set_filter */
 
 }; /* template < class ImageType > class Computed_field_binary_threshold_image_filter_Functor */
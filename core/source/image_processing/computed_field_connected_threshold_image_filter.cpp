@@ -20,6 +20,12 @@ Wraps itk::MeanImageFilter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_connected_threshold_image_filter.h"
+#include "graphics/texture.h"
+#include "graphics/texture.hpp"
+#include "graphics/texture_range_tree.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 #include "itkImage.h"
 #include "itkVector.h"
@@ -122,6 +128,133 @@ Compare the type specific data.
 	return (return_code);
 } /* Computed_field_connected_threshold_image_filter::compare */
 
+/**
+ * Grow regions from the seed points through face-connected pixels of the
+ * source image field's texture within the thresholds, writing the output image
+ * directly. The texture's min/max range tree classifies bricks so growth never
+ * reads texels of bricks entirely outside the thresholds, and passes through
+ * bricks entirely inside them without reading texels. Texels are read only for
+ * bricks straddling a threshold that the region reaches. Equivalent to
+ * itk::ConnectedThresholdImageFilter on the input image.
+ *
+ * @param minimum, maximum  Output range of source image field.
+ * @return  1 on success, 0 on failure.
+ */
+template < class ImageType >
+int Computed_field_connected_threshold_image_filter_grow_texture(
+	Computed_field_connected_threshold_image_filter *connected_threshold_image_filter,
+	struct Texture *texture, TextureRangeTree *range_tree, double minimum, double maximum,
+	typename ImageType::Pointer &outputImage)
+{
+	typedef typename ImageType::PixelType PixelType;
+	int texel_lower, texel_upper;
+	if (!Texture_get_original_texel_value_interval(texture, minimum, maximum,
+		connected_threshold_image_filter->lower_threshold,
+		connected_threshold_image_filter->upper_threshold, &texel_lower, &texel_upper))
+	{
+		return 0;
+	}
+	std::vector<unsigned char> brick_classes;
+	range_tree->classifyBricks(/*component*/0, texel_lower, texel_upper, brick_classes);
+	connected_threshold_image_filter->allocate_image(outputImage, static_cast<ImageType*>(NULL));
+	PixelType *output = outputImage->GetBufferPointer();
+	const int dimension = connected_threshold_image_filter->dimension;
+	const int image_sizes[3] = { connected_threshold_image_filter->sizes[0],
+		(dimension > 1) ? connected_threshold_image_filter->sizes[1] : 1,
+		(dimension > 2) ? connected_threshold_image_filter->sizes[2] : 1 };
+	const size_t pixel_count = static_cast<size_t>(image_sizes[0])*image_sizes[1]*image_sizes[2];
+	std::fill(output, output + pixel_count, static_cast<PixelType>(0));
+	const PixelType replace_value = static_cast<PixelType>(connected_threshold_image_filter->replace_value);
+	const ZnReal lower = connected_threshold_image_filter->lower_threshold;
+	const ZnReal upper = connected_threshold_image_filter->upper_threshold;
+	const int brick_size = range_tree->getBrickSize();
+	const int *brick_counts = range_tree->getBrickCounts();
+	// texel values of straddling bricks reached so far
+	std::unordered_map<int, std::vector<ZnReal> > brick_values;
+	bool read_failed = false;
+	auto is_pixel_in_range = [&](int x, int y, int z)
+	{
+		const int bi = x/brick_size, bj = y/brick_size, bk = z/brick_size;
+		const int brick = (bk*brick_counts[1] + bj)*brick_counts[0] + bi;
+		const unsigned char brick_class = brick_classes[brick];
+		if (TextureRangeTree::BRICK_STRADDLE != brick_class)
+		{
+			return (TextureRangeTree::BRICK_INSIDE == brick_class);
+		}
+		const int start[3] = { bi*brick_size, bj*brick_size, bk*brick_size };
+		int block_sizes[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			block_sizes[i] = std::min(brick_size, image_sizes[i] - start[i]);
+		}
+		std::vector<ZnReal>& values = brick_values[brick];
+		if (values.empty())
+		{
+			values.resize(block_sizes[0]*block_sizes[1]*block_sizes[2]);
+			if (!Texture_get_original_texel_block_values(texture, start, block_sizes,
+				minimum, maximum, values.data()))
+			{
+				read_failed = true;
+				return false;
+			}
+		}
+		const ZnReal value = values[((z - start[2])*block_sizes[1] + (y - start[1]))*block_sizes[0] + (x - start[0])];
+		return ((lower <= value) && (value <= upper));
+	};
+	std::vector<unsigned char> visited(pixel_count, 0);
+	std::vector<size_t> stack;
+	for (int s = 0; s < connected_threshold_image_filter->num_seed_points; ++s)
+	{
+		int seed[3] = { 0, 0, 0 };
+		bool inside = true;
+		for (int i = 0; i < dimension; ++i)
+		{
+			seed[i] = (int)(connected_threshold_image_filter->seed_points[s*dimension + i] * image_sizes[i]);
+			inside = inside && (0 <= seed[i]) && (seed[i] < image_sizes[i]);
+		}
+		if (!inside)
+		{
+			continue;
+		}
+		const size_t index = (static_cast<size_t>(seed[2])*image_sizes[1] + seed[1])*image_sizes[0] + seed[0];
+		if ((!visited[index]) && is_pixel_in_range(seed[0], seed[1], seed[2]))
+		{
+			visited[index] = 1;
+			stack.push_back(index);
+		}
+	}
+	const size_t strides[3] = { 1, static_cast<size_t>(image_sizes[0]),
+		static_cast<size_t>(image_sizes[0])*image_sizes[1] };
+	while ((!stack.empty()) && (!read_failed))
+	{
+		const size_t index = stack.back();
+		stack.pop_back();
+		output[index] = replace_value;
+		const int location[3] = { static_cast<int>(index % image_sizes[0]),
+			static_cast<int>((index / image_sizes[0]) % image_sizes[1]),
+			static_cast<int>(index / strides[2]) };
+		for (int i = 0; i < dimension; ++i)
+		{
+			for (int direction = -1; direction <= 1; direction += 2)
+			{
+				int neighbour[3] = { location[0], location[1], location[2] };
+				neighbour[i] += direction;
+				if ((neighbour[i] < 0) || (neighbour[i] >= image_sizes[i]))
+				{
+					continue;
+				}
+				const size_t neighbour_index = (direction > 0) ? index + strides[i] : index - strides[i];
+				if ((!visited[neighbour_index]) && is_pixel_in_range(neighbour[0], neighbour[1], neighbour[2]))
+				{
+					visited[neighbour_index] = 1;
+					stack.push_back(neighbour_index);
+				}
+			}
+		}
+	}
+	return (read_failed) ? 0 : 1;
+}
+
 template < class ImageType >
 class Computed_field_connected_threshold_image_filter_Functor :
 	public computed_field_image_filter_FunctorTmpl< ImageType >
@@ -165,6 +298,18 @@ and generate the outputImage.
 		filter->SetUpper( connected_threshold_image_filter->upper_threshold );
 		filter->SetReplaceValue( connected_threshold_image_filter->replace_value );
 
+		// grow directly through image field texels, skipping bricks outside range
+		double minimum, maximum;
+		struct Texture *texture = connected_threshold_image_filter->get_source_pixel_centre_texture(
+			cache, minimum, maximum);
+		TextureRangeTree *range_tree = (texture) ? Texture_get_range_tree(texture) : 0;
+		if (range_tree)
+		{
+			return Computed_field_connected_threshold_image_filter_grow_texture<ImageType>(
+				connected_threshold_image_filter, texture, range_tree, minimum, maximum,
+				this->outputImage);
+		}
+
 		typename ImageType::IndexType seedIndex;
 
 		image_size = connected_threshold_image_filter->sizes;
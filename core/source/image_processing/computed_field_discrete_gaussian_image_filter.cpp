@@ -4,7 +4,8 @@ FILE : computed_field_discrete_gaussian_image_filter.c
 LAST MODIFIED : 16 May 2008
 
 DESCRIPTION :
-Wraps itk::DiscreteGaussianImageFilter
+Discrete gaussian image filter evaluated with native kernel equivalent to
+itk::DiscreteGaussianImageFilter
 ==============================================================================*/
 /* OpenCMISS-Zinc Library
 *
@@ -20,9 +21,9 @@ Wraps itk::DiscreteGaussianImageFilter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_discrete_gaussian_image_filter.h"
+#include "image_processing/image_filter_kernels.hpp"
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkDiscreteGaussianImageFilter.h"
 
 using namespace CMZN;
 
@@ -234,24 +235,20 @@ public:
 LAST MODIFIED : 12 September 2006
 
 DESCRIPTION :
-Create a filter of the correct type, set the filter specific parameters
-and generate the outputImage.
+Generate the outputImage by filtering a copy of the input image in place
+with the native kernel.
 ==============================================================================*/
 	{
-		int return_code;
-
-		typedef itk::DiscreteGaussianImageFilter< ImageType , ImageType > FilterType;
-		
-		typename FilterType::Pointer filter = FilterType::New();
-
-		filter->SetVariance( discrete_gaussian_image_filter->variance );
-		filter->SetMaximumKernelWidth( discrete_gaussian_image_filter->maxKernelWidth);
-		
-		return_code = discrete_gaussian_image_filter->update_output_image
-			(cache, filter, this->outputImage,
-			static_cast<ImageType*>(NULL), static_cast<FilterType*>(NULL));
-		
-		return (return_code);
+		// separable so evaluated natively in place, equivalent to
+		// itk::DiscreteGaussianImageFilter with unit image spacing
+		if (!discrete_gaussian_image_filter->create_native_output_image(cache, this->outputImage,
+			static_cast<ImageType*>(NULL)))
+		{
+			return 0;
+		}
+		return image_kernel_discrete_gaussian(this->outputImage->GetBufferPointer(),
+			discrete_gaussian_image_filter->dimension, discrete_gaussian_image_filter->sizes,
+			discrete_gaussian_image_filter->variance, discrete_gaussian_image_filter->maxKernelWidth) ? 1 : 0;
 	} /* set_filter */
 
 }; /* template < class ImageType > class Computed_field_discrete_gaussian_image_filter_Functor */
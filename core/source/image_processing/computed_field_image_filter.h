@@ -13,15 +13,17 @@
 #define computed_field_image_filter_H
 
 #include "computed_field/computed_field.h"
+#include "computed_field/computed_field_finite_element.h"
+#include "computed_field/computed_field_image.h"
 #include "computed_field/computed_field_private.hpp"
 #include "computed_field/computed_field_set.h"
 #include "general/debug.h"
 #include "general/mystring.h"
 #include "general/message.h"
+#include <algorithm>
 #include "itkImage.h"
 #include "itkVector.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkImportImageFilter.h"
 
 #if defined (SGI)
 /* The IRIX compiler 7.3.1.3m does not seem to support templates of templates so
@@ -151,11 +153,94 @@ protected:
 #endif /* !defined (DONOTUSE_TEMPLATETEMPLATES) */
 
 public:
+	/**
+	 * Get field whose values at the cache location are the pixel centre
+	 * locations used to build the input image, if any.
+	 */
+	Computed_field *get_pixel_coordinate_field(cmzn_fieldcache& cache)
+	{
+		const Field_location_element_xi* element_xi_location = cache.get_location_element_xi();
+		const Field_location_field_values* coordinate_location = cache.get_location_field_values();
+		if (coordinate_location)
+		{
+			return coordinate_location->get_field();
+		}
+		if ((element_xi_location) &&
+			(get_FE_element_dimension(element_xi_location->get_element()) == dimension) &&
+			Computed_field_is_type_xi_coordinates(texture_coordinate_field, (void *)NULL))
+		{
+			return texture_coordinate_field;
+		}
+		return 0;
+	}
+
+	/**
+	 * Get texture of source image field if its texels are exactly the pixels
+	 * of this filter at the cache location, so filters can read texels and
+	 * skip bricks using the texture's range tree instead of building the
+	 * input image.
+	 * @param minimum, maximum  Receive output range of source image field.
+	 * @return  Non-accessed texture or 0 if not possible.
+	 */
+	struct Texture *get_source_pixel_centre_texture(cmzn_fieldcache& cache,
+		double& minimum, double& maximum)
+	{
+		Computed_field *pixel_coordinate_field = this->get_pixel_coordinate_field(cache);
+		if (!pixel_coordinate_field)
+		{
+			return 0;
+		}
+		return Computed_field_image_get_pixel_centre_texture(field->source_fields[0],
+			pixel_coordinate_field, dimension, sizes, field->source_fields[0]->number_of_components,
+			&minimum, &maximum);
+	}
+
+	/** Create image of the filter's sizes with allocated buffer. */
+	template <class ImageType >
+	void allocate_image(typename ImageType::Pointer &image, ImageType * /*dummytemplarg*/)
+	{
+		image = ImageType::New();
+		typename ImageType::IndexType start;
+		typename ImageType::SizeType size;
+		for (int i = 0 ; i < dimension ; i++)
+		{
+			start[i] = 0;
+			size[i] = sizes[i];
+		}
+		typename ImageType::RegionType region;
+		region.SetSize(size);
+		region.SetIndex(start);
+		image->SetRegions(region);
+		image->Allocate();
+	}
+
 	template <class ImageType >
 	int create_input_image(cmzn_fieldcache& cache,
 		typename ImageType::Pointer &inputImage,
 		ImageType *dummytemplarg1);
 
+	/**
+	 * Create output image holding the input values for filters evaluated with
+	 * native kernels from image_filter_kernels.hpp, which filter it in place.
+	 * Image field sources are converted straight into the output buffer; only
+	 * the output of a source filter is copied, as it must not be modified.
+	 * @return  1 on success, 0 on failure.
+	 */
+	template <class ImageType >
+	int create_native_output_image(cmzn_fieldcache& cache,
+		typename ImageType::Pointer &outputImage, ImageType *dummytemplarg);
+
+	/** @return  Total number of pixels in the filter's image. */
+	size_t get_pixel_count() const
+	{
+		size_t pixel_count = 1;
+		for (int i = 0 ; i < dimension ; i++)
+		{
+			pixel_count *= static_cast<size_t>(sizes[i]);
+		}
+		return pixel_count;
+	}
+
 	template <class ImageType, class FilterType >
 	int update_output_image(cmzn_fieldcache& cache,
 		typename FilterType::Pointer filter,
@@ -1011,22 +1096,34 @@ for subsequent operations.
 			
 				inputImage->SetRegions(region);
 				inputImage->Allocate();
-			
-				FE_value pixel_xi[3];
-				
-				for (i = 0 ; i < 3 ; i++)
+
+				// If the source is an image field sampled at its pixel centres, convert
+				// its texture straight into the ITK buffer instead of evaluating per pixel.
+				// Pixels are ZnReal or itk::Vector of ZnReal stored contiguously.
+				cmzn_field *pixel_coordinate_field = this->get_pixel_coordinate_field(cache);
+				const int number_of_components = sourceField->number_of_components;
+				if ((sizeof(typename ImageType::PixelType) == number_of_components*sizeof(ZnReal)) &&
+					Computed_field_image_get_pixel_centre_values(sourceField, pixel_coordinate_field,
+						dimension, sizes, number_of_components,
+						reinterpret_cast<ZnReal *>(inputImage->GetBufferPointer())))
 				{
-					pixel_xi[i] = 0.0;
+					return_code = 1;
 				}
-
-				// work with a private field cache to avoid stomping current location
-				cmzn_fieldmodule_id field_module = cmzn_field_get_fieldmodule(field);
-				cmzn_fieldcache_id field_cache = cmzn_fieldmodule_create_fieldcache(field_module);
-				field_cache->setTime(cache.getTime());
-				if(element_xi_location)
+				else
 				{
-					cmzn_element* element = element_xi_location->get_element();
+					FE_value pixel_xi[3];
+				
+					for (i = 0 ; i < 3 ; i++)
+					{
+						pixel_xi[i] = 0.0;
+					}
 
+					// work with a private field cache to avoid stomping current location
+					cmzn_fieldmodule_id field_module = cmzn_field_get_fieldmodule(field);
+					cmzn_fieldcache_id field_cache = cmzn_fieldmodule_create_fieldcache(field_module);
+					field_cache->setTime(cache.getTime());
+					cmzn_element* element = (element_xi_location) ? element_xi_location->get_element() : 0;
+					cmzn_field* reference_field = (coordinate_location) ? coordinate_location->get_field() : 0;
 					itk::ImageRegionIteratorWithIndex< ImageType >
 						generateInput( inputImage, region );
 					for ( generateInput.GoToBegin(); !generateInput.IsAtEnd();
@@ -1040,43 +1137,18 @@ for subsequent operations.
 							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
 						}
 
-						field_cache->setMeshLocation(element, pixel_xi);
-						const RealFieldValueCache *valueCache = RealFieldValueCache::cast(sourceField->evaluate(*field_cache));
-						if (valueCache)
+						if (element)
 						{
-							generateInput.Set( valueCache->values[0] );
+							field_cache->setMeshLocation(element, pixel_xi);
 						}
 						else
 						{
-							return_code = 0;
-							break;
+							field_cache->setFieldReal(reference_field, dimension, pixel_xi);
 						}
-					}
-				}
-				else if (coordinate_location)
-				{
-					cmzn_field* reference_field = coordinate_location->get_field();
-					FE_value time = coordinate_location->get_time();
-					itk::ImageRegionIteratorWithIndex< ImageType >
-						generateInput( inputImage, region );
-					//Field_location_field_values pixel_location(reference_field, 
-					//	dimension, pixel_xi, time);
-
-					for ( generateInput.GoToBegin(); !generateInput.IsAtEnd(); ++generateInput)
-					{
-						typename ImageType::IndexType idx = generateInput.GetIndex();
-				
-						/* Find element xi for idx, assuming xi field for now. */
-						for (i = 0 ; i < dimension ; i++)
-						{
-							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-						}
-
-						field_cache->setFieldReal(reference_field, dimension, pixel_xi);
 						const RealFieldValueCache *valueCache = RealFieldValueCache::cast(sourceField->evaluate(*field_cache));
 						if (valueCache)
 						{
-							generateInput.Set( valueCache->values[0] );
+							setPixelValues( generateInput.Value(), valueCache->values );
 						}
 						else
 						{
@@ -1084,143 +1156,10 @@ for subsequent operations.
 							break;
 						}
 					}
-				}
-				cmzn_fieldcache_destroy(&field_cache);
-				cmzn_fieldmodule_destroy(&field_module);
-#if defined (NEW_CODE)
-				typedef itk::ImportImageFilter<
-				   typename ImageType::PixelType, ImageType::ImageDimension >
-					ImportFilterType;
-				typename ImportFilterType::Pointer importFilter = 
-					ImportFilterType::New();
-
-				printf("ImportImageFilter %d\n", ImageType::ImageDimension); 
-
-				typename ImportFilterType::IndexType start;
-				for (i = 0 ; i < dimension ; i++)
-				{
-					start[i] = 0; // first index on X
-				}
-				typename ImportFilterType::SizeType size;
-				for (i = 0 ; i < dimension ; i++)
-				{
-					size[i] = sizes[i];
-				}
-				typename ImportFilterType::RegionType region;
-				region.SetSize( size );
-				region.SetIndex( start );
-			
-				importFilter->SetRegion(region);
-
-				unsigned int totalSize = sizes[0];
-				for (i = 1 ; i < dimension ; i++)
-				{
-					totalSize *= sizes[i];
-				}
-				typename ImageType::PixelType * localBuffer =
-					new typename ImageType::PixelType[ totalSize ];
-			
-				ZnReal pixel_xi[3];
-				
-				for (i = 0 ; i < dimension ; i++)
-				{
-					pixel_xi[i] = 0.5 / (ZnReal)sizes[i];
-				}
-				for ( ; i < 3 ; i++)
-				{
-					pixel_xi[i] = 0.0;
-				}
-
-				typename ImageType::IndexType idx;
-				for (i = 0 ; i < dimension ; i++)
-				{
-					idx[i] = 0;
-				}
-
-				if(element_xi_location)
-				{
-					unsigned int count = 0;
-					FE_element* element = element_xi_location->get_element();
-					FE_value time = element_xi_location->get_time();
-					typename ImageType::PixelType *buffer_ptr = localBuffer;
-
-					/* Find element xi for idx, assuming xi field for now. */
-					for (i = 0 ; i < dimension ; i++)
-					{
-						pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-					}
-					Field_location_element_xi pixel_location(element, pixel_xi);
-					pixel_location.set_time(time);
-					while (count < totalSize)
-					{
-						pixel_location.set_element_xi(element, pixel_xi);
-						
-						Computed_field_evaluate_cache_at_location(
-							field->source_fields[0], &pixel_location);
-				
-						setPixelValues( *buffer_ptr, 
-							field->source_fields[0]->values );
-
-						buffer_ptr++;
-						count++;
-						idx[0]++;
-						pixel_xi[0] = ((ZnReal)idx[0] + 0.5) / (ZnReal)sizes[0];
-						for (i = 1 ; (i < dimension) && (idx[i-1] >= sizes[i-1]) ; i++)
-						{
-							idx[i-1] = 0;
-							pixel_xi[i-1] = ((ZnReal)idx[i-1] + 0.5) / (ZnReal)sizes[i-1];
-							idx[i]++;
-							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-						}
-					}
-				}
-				else if (coordinate_location)
-				{
-					unsigned int count = 0;
-					Computed_field* reference_field = 
-						coordinate_location->get_reference_field();
-					FE_value time = coordinate_location->get_time();
-					Field_location_field_values pixel_location(reference_field, 
-						dimension, pixel_xi, time);
-					typename ImageType::PixelType *buffer_ptr = localBuffer;
-
-					/* Find element xi for idx, assuming xi field for now. */
-					for (i = 0 ; i < dimension ; i++)
-					{
-						pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-					}
-					while (count < totalSize)
-					{
-						pixel_location.set_values(dimension, pixel_xi);
-
-						Computed_field_evaluate_cache_at_location(
-							field->source_fields[0], &pixel_location);
-				
-						setPixelValues( *buffer_ptr, 
-							field->source_fields[0]->values );
-
-						buffer_ptr++;
-						count++;
-						idx[0]++;
-						pixel_xi[0] = ((ZnReal)idx[0] + 0.5) / (ZnReal)sizes[0];
-						for (i = 1 ; (i < dimension) && (idx[i-1] >= sizes[i-1]) ; i++)
-						{
-							idx[i-1] = 0;
-							pixel_xi[i-1] = ((ZnReal)idx[i-1] + 0.5) / (ZnReal)sizes[i-1];
-							idx[i]++;
-							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-						}
-					}
-
+					cmzn_fieldcache_destroy(&field_cache);
+					cmzn_fieldmodule_destroy(&field_module);
 				}
 
-				importFilter->SetImportPointer( localBuffer, totalSize,
-					/*importImageFilterWillOwnTheBuffer*/true );
-				importFilter->Update();
-
-				inputImage = importFilter->GetOutput();
-#endif // defined (NEW_CODE)
-
 			}
 		}
 		else
@@ -1240,6 +1179,32 @@ for subsequent operations.
 	return (return_code);
 } /* computed_field_image_filter::create_input_image */
 
+template <class ImageType >
+int computed_field_image_filter::create_native_output_image(cmzn_fieldcache& cache,
+	typename ImageType::Pointer &outputImage, ImageType *dummytemplarg)
+{
+	typename ImageType::Pointer inputImage;
+	if (!create_input_image(cache, inputImage, dummytemplarg))
+	{
+		return 0;
+	}
+	computed_field_image_filter *input_field_image_filter =
+		dynamic_cast<computed_field_image_filter *>(field->source_fields[0]->core);
+	if ((input_field_image_filter) &&
+		(dynamic_cast<computed_field_image_filter_FunctorTmpl<ImageType>*>(input_field_image_filter->functor)))
+	{
+		allocate_image(outputImage, dummytemplarg);
+		std::copy(inputImage->GetBufferPointer(),
+			inputImage->GetBufferPointer() + get_pixel_count(),
+			outputImage->GetBufferPointer());
+	}
+	else
+	{
+		outputImage = inputImage;
+	}
+	return 1;
+}
+
 template <class ImageType, class FilterType >
 int computed_field_image_filter::update_output_image(cmzn_fieldcache& cache,
 	typename FilterType::Pointer filter, typename ImageType::Pointer &outputImage,
@@ -4,7 +4,8 @@ FILE : computed_field_mean_image_filter.c
 LAST MODIFIED : 9 September 2006
 
 DESCRIPTION :
-Wraps itk::MeanImageFilter
+Mean image filter evaluated with native kernel equivalent to
+itk::MeanImageFilter
 ==============================================================================*/
 /* OpenCMISS-Zinc Library
 *
@@ -20,9 +21,9 @@ Wraps itk::MeanImageFilter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_mean_image_filter.h"
+#include "image_processing/image_filter_kernels.hpp"
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkMeanImageFilter.h"
 
 using namespace CMZN;
 
@@ -207,31 +208,19 @@ public:
 LAST MODIFIED : 12 September 2006
 
 DESCRIPTION :
-Create a filter of the correct type, set the filter specific parameters
-and generate the outputImage.
+Generate the outputImage by filtering a copy of the input image in place
+with the native kernel.
 ==============================================================================*/
 	{
-		int i, return_code;
-
-		typedef itk::MeanImageFilter< ImageType , ImageType > FilterType;
-		
-		typename FilterType::Pointer filter = FilterType::New();
-		typename FilterType::InputSizeType radius;
-		
-		for (i = 0 ; i < mean_image_filter->dimension ; i++)
+		// separable so evaluated natively in place, equivalent to itk::MeanImageFilter
+		if (!mean_image_filter->create_native_output_image(cache, this->outputImage,
+			static_cast<ImageType*>(NULL)))
 		{
-			radius[i] = mean_image_filter->radius_sizes[i];
+			return 0;
 		}
-		if (mean_image_filter->dimension > 0)
-		{
-			filter->SetRadius( radius );
-		}
-		
-		return_code = mean_image_filter->update_output_image
-			(cache, filter, this->outputImage,
-			static_cast<ImageType*>(NULL), static_cast<FilterType*>(NULL));
-		
-		return (return_code);
+		return image_kernel_mean(this->outputImage->GetBufferPointer(),
+			mean_image_filter->dimension, mean_image_filter->sizes,
+			mean_image_filter->radius_sizes) ? 1 : 0;
 	} /* set_filter */
 
 }; /* template < class ImageType > class Computed_field_mean_image_filter_Functor */
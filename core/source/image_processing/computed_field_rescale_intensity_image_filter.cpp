@@ -4,7 +4,8 @@ FILE : computed_field_rescale_intensity_image_filter.c
 LAST MODIFIED : 15 Dec 2006
 
 DESCRIPTION :
-Wraps itk::RescaleIntensityImageFiter
+Rescale intensity image filter evaluated with native kernel equivalent to
+itk::RescaleIntensityImageFilter
 ==============================================================================*/
 /* OpenCMISS-Zinc Library
 *
@@ -20,9 +21,9 @@ Wraps itk::RescaleIntensityImageFiter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_rescale_intensity_image_filter.h"
+#include "image_processing/image_filter_kernels.hpp"
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkRescaleIntensityImageFilter.h"
 
 using namespace CMZN;
 
@@ -196,24 +197,21 @@ public:
 LAST MODIFIED : 12 September 2006
 
 DESCRIPTION :
-Create a filter of the correct type, set the filter specific parameters
-and generate the outputImage.
+Generate the outputImage by filtering a copy of the input image in place
+with the native kernel.
 ==============================================================================*/
 	{
-		int return_code;
-
-		typedef itk::RescaleIntensityImageFilter< ImageType , ImageType > FilterType;
-		
-		typename FilterType::Pointer filter = FilterType::New();
-
-		filter->SetOutputMinimum( rescale_intensity_image_filter->outputMin );
-		filter->SetOutputMaximum( rescale_intensity_image_filter->outputMax );
-		
-		return_code = rescale_intensity_image_filter->update_output_image
-			(cache, filter, this->outputImage,
-			static_cast<ImageType*>(NULL), static_cast<FilterType*>(NULL));
-		
-		return (return_code);
+		// pointwise after finding range so evaluated natively in place,
+		// equivalent to itk::RescaleIntensityImageFilter
+		if (!rescale_intensity_image_filter->create_native_output_image(cache, this->outputImage,
+			static_cast<ImageType*>(NULL)))
+		{
+			return 0;
+		}
+		image_kernel_rescale_intensity(this->outputImage->GetBufferPointer(),
+			rescale_intensity_image_filter->get_pixel_count(),
+			rescale_intensity_image_filter->outputMin, rescale_intensity_image_filter->outputMax);
+		return 1;
 	} /* set_filter */
 
 }; /* template < class ImageType > class Computed_field_rescale_intensity_image_filter_Functor */
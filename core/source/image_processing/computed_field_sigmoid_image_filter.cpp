@@ -4,7 +4,8 @@ FILE : computed_field_sigmoid_image_filter.c
 LAST MODIFIED : 9 September 2006
 
 DESCRIPTION :
-Wraps itk::SigmoidImageFilter
+Sigmoid image filter evaluated with native kernel equivalent to
+itk::SigmoidImageFilter
 ==============================================================================*/
 /* OpenCMISS-Zinc Library
 *
@@ -20,9 +21,9 @@ Wraps itk::SigmoidImageFilter
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_sigmoid_image_filter.h"
+#include "image_processing/image_filter_kernels.hpp"
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkSigmoidImageFilter.h"
 
 using namespace CMZN;
 
@@ -207,26 +208,20 @@ public:
 LAST MODIFIED : 12 September 2006
 
 DESCRIPTION :
-Create a filter of the correct type, set the filter specific parameters
-and generate the outputImage.
+Generate the outputImage by filtering a copy of the input image in place
+with the native kernel.
 ==============================================================================*/
 	{
-		int return_code;
-
-		typedef itk::SigmoidImageFilter< ImageType , ImageType > FilterType;
-		
-		typename FilterType::Pointer filter = FilterType::New();
-
-		filter->SetOutputMinimum( sigmoid_image_filter->min );
-		filter->SetOutputMaximum( sigmoid_image_filter->max );
-		filter->SetAlpha( sigmoid_image_filter->alpha );
-		filter->SetBeta( sigmoid_image_filter->beta );
-		
-		return_code = sigmoid_image_filter->update_output_image
-			(cache, filter, this->outputImage,
-			static_cast<ImageType*>(NULL), static_cast<FilterType*>(NULL));
-		
-		return (return_code);
+		// pointwise so evaluated natively in place, equivalent to itk::SigmoidImageFilter
+		if (!sigmoid_image_filter->create_native_output_image(cache, this->outputImage,
+			static_cast<ImageType*>(NULL)))
+		{
+			return 0;
+		}
+		image_kernel_sigmoid(this->outputImage->GetBufferPointer(),
+			sigmoid_image_filter->get_pixel_count(), sigmoid_image_filter->min,
+			sigmoid_image_filter->max, sigmoid_image_filter->alpha, sigmoid_image_filter->beta);
+		return 1;
 	} /* set_filter */
 
 }; /* template < class ImageType > class Computed_field_sigmoid_image_filter_Functor */
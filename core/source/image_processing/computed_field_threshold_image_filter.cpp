@@ -4,7 +4,8 @@ FILE : computed_field_threshold_image_filter.cpp
 LAST MODIFIED : 26 September 2008
 
 DESCRIPTION :
-Wraps itk::ThresholdImageFilter
+Threshold image filter evaluated with native kernel equivalent to
+itk::ThresholdImageFilter
 
 This enables the use of itk to do general thresholding.  The threshold filter
 can be used in three different ways.
@@ -33,9 +34,10 @@ can be used in three different ways.
 #include "general/mystring.h"
 #include "general/message.h"
 #include "image_processing/computed_field_threshold_image_filter.h"
+#include "image_processing/image_filter_kernels.hpp"
+#include <limits>
 #include "itkImage.h"
 #include "itkVector.h"
-#include "itkThresholdImageFilter.h"
 
 using namespace CMZN;
 
@@ -251,33 +253,27 @@ It is instantiated for each of the chosen ImageTypes.
 LAST MODIFIED : 8 December 2006
 
 DESCRIPTION :
-Create a filter of the correct type, set the filter specific parameters
-and generate the outputImage.
+Generate the outputImage by filtering a copy of the input image in place
+with the native kernel.
 ==============================================================================*/
 		{
-			int return_code;
-
-			typedef itk::ThresholdImageFilter< ImageType > FilterType;
-
-			typename FilterType::Pointer filter = FilterType::New();
-
-			filter->SetOutsideValue( threshold_image_filter->outsideValue );
-
-			// call appropriate threshold mode based on condition variable
-
+			// pointwise so evaluated natively in place, equivalent to itk::ThresholdImageFilter
+			ZnReal lower = -std::numeric_limits<ZnReal>::max();
+			ZnReal upper = std::numeric_limits<ZnReal>::max();
 			switch (threshold_image_filter->condition)
 			{
 				case CMZN_FIELD_IMAGEFILTER_THRESHOLD_CONDITION_BELOW:
 				{
-					filter->ThresholdBelow( threshold_image_filter->lowerValue );
+					lower = threshold_image_filter->lowerValue;
 				} break;
 				case CMZN_FIELD_IMAGEFILTER_THRESHOLD_CONDITION_ABOVE:
 				{
-					filter->ThresholdAbove( threshold_image_filter->upperValue );
+					upper = threshold_image_filter->upperValue;
 				} break;
 				case CMZN_FIELD_IMAGEFILTER_THRESHOLD_CONDITION_OUTSIDE:
 				{
-					filter->ThresholdOutside( threshold_image_filter->lowerValue, threshold_image_filter->upperValue );
+					lower = threshold_image_filter->lowerValue;
+					upper = threshold_image_filter->upperValue;
 				} break;
 				default:
 				{
@@ -286,12 +282,15 @@ and generate the outputImage.
 				} break;
 			}
 
-			return_code = threshold_image_filter->update_output_image
-				(cache, filter, this->outputImage,
-				 static_cast<ImageType*>(NULL),
-				 static_cast<FilterType*>(NULL));
-
-			return (return_code);
+			if (!threshold_image_filter->create_native_output_image(cache, this->outputImage,
+				static_cast<ImageType*>(NULL)))
+			{
+				return 0;
+			}
+			image_kernel_threshold(this->outputImage->GetBufferPointer(),
+				threshold_image_filter->get_pixel_count(), lower, upper,
+				threshold_image_filter->outsideValue);
+			return 1;
 		} /* set_filter */
 
 	}; /* template < class ImageType > class Computed_field_threshold_image_filter_Functor */
@@ -0,0 +1,335 @@
+/**
+ * FILE : image_filter_kernels.cpp
+ *
+ * Native multithreaded kernels for simple image filters.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "general/parallel.hpp"
+#include "image_processing/image_filter_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/** Number of values processed together by one thread. */
+const size_t blockValueCount = 16384;
+
+/*
+ * Modified Bessel functions of the first kind as evaluated by
+ * itk::GaussianOperator, so kernel coefficients are identical.
+ */
+
+double modifiedBesselI0(double y)
+{
+	const double d = std::fabs(y);
+	if (d < 3.75)
+	{
+		double m = y/3.75;
+		m *= m;
+		return 1.0 + m*(3.5156229 + m*(3.0899424 + m*(1.2067492 +
+			m*(0.2659732 + m*(0.360768e-1 + m*0.45813e-2)))));
+	}
+	const double m = 3.75/d;
+	return (std::exp(d)/std::sqrt(d))*(0.39894228 + m*(0.1328592e-1 +
+		m*(0.225319e-2 + m*(-0.157565e-2 + m*(0.916281e-2 + m*(-0.2057706e-1 +
+		m*(0.2635537e-1 + m*(-0.1647633e-1 + m*0.392377e-2))))))));
+}
+
+double modifiedBesselI1(double y)
+{
+	const double d = std::fabs(y);
+	double accumulator;
+	if (d < 3.75)
+	{
+		double m = y/3.75;
+		m *= m;
+		accumulator = d*(0.5 + m*(0.87890594 + m*(0.51498869 + m*(0.15084934 +
+			m*(0.2658733e-1 + m*(0.301532e-2 + m*0.32411e-3))))));
+	}
+	else
+	{
+		const double m = 3.75/d;
+		accumulator = 0.2282967e-1 + m*(-0.2895312e-1 + m*(0.1787654e-1 - m*0.420059e-2));
+		accumulator = 0.39894228 + m*(-0.3988024e-1 + m*(-0.362018e-2 +
+			m*(0.163801e-2 + m*(-0.1031555e-1 + m*accumulator))));
+		accumulator *= (std::exp(d)/std::sqrt(d));
+	}
+	return (y < 0.0) ? -accumulator : accumulator;
+}
+
+/** Modified Bessel function of order n >= 2 by downward recurrence. */
+double modifiedBesselI(int n, double y)
+{
+	if (y == 0.0)
+		return 0.0;
+	const double accuracy = 40.0;
+	const double toy = 2.0/std::fabs(y);
+	double qip = 0.0;
+	double accumulator = 0.0;
+	double qi = 1.0;
+	for (int j = 2*(n + static_cast<int>(std::sqrt(accuracy*n))); j > 0; --j)
+	{
+		const double qim = qip + j*toy*qi;
+		qip = qi;
+		qi = qim;
+		if (std::fabs(qi) > 1.0e10)
+		{
+			accumulator *= 1.0e-10;
+			qi *= 1.0e-10;
+			qip *= 1.0e-10;
+		}
+		if (j == n)
+			accumulator = qip;
+	}
+	accumulator *= modifiedBesselI0(y)/qi;
+	return ((y < 0.0) && (n & 1)) ? -accumulator : accumulator;
+}
+
+/**
+ * Convolve source along axis with the symmetric kernel whose coefficients
+ * from the centre outwards are halfKernel, writing to target. Indexes beyond
+ * the image are clamped to its boundary.
+ * @param sizes  Number of pixels in x, y and z.
+ */
+void convolveAxis(const ZnReal *source, ZnReal *target, const int *sizes,
+	int axis, const std::vector<ZnReal>& halfKernel)
+{
+	const int radius = static_cast<int>(halfKernel.size()) - 1;
+	const int width = 2*radius + 1;
+	std::vector<ZnReal> kernel(width);
+	for (int k = 0; k <= radius; ++k)
+		kernel[radius - k] = kernel[radius + k] = halfKernel[k];
+	const size_t rowSize = static_cast<size_t>(sizes[0]);
+	const size_t rowCount = static_cast<size_t>(sizes[1])*sizes[2];
+	const size_t rowsPerBlock = std::max(static_cast<size_t>(1), blockValueCount/rowSize);
+	CMZN::parallel_for_blocks(rowCount, rowsPerBlock, [&](size_t, size_t startRow, size_t endRow)
+	{
+		std::vector<ZnReal> line;
+		if (0 == axis)
+			line.resize(rowSize + 2*radius);
+		for (size_t row = startRow; row < endRow; ++row)
+		{
+			ZnReal *targetRow = target + row*rowSize;
+			if (0 == axis)
+			{
+				// pad row with repeated end values so the inner loop has no tests
+				const ZnReal *sourceRow = source + row*rowSize;
+				std::fill(line.begin(), line.begin() + radius, sourceRow[0]);
+				std::copy(sourceRow, sourceRow + rowSize, line.begin() + radius);
+				std::fill(line.begin() + radius + rowSize, line.end(), sourceRow[rowSize - 1]);
+				const ZnReal *lineValues = line.data();
+				for (size_t i = 0; i < rowSize; ++i)
+					targetRow[i] = kernel[0]*lineValues[i];
+				for (int k = 1; k < width; ++k)
+				{
+					const ZnReal coefficient = kernel[k];
+					const ZnReal *shiftedValues = lineValues + k;
+					for (size_t i = 0; i < rowSize; ++i)
+						targetRow[i] += coefficient*shiftedValues[i];
+				}
+			}
+			else
+			{
+				// whole rows are weighted and summed, clamping the row index
+				const int j = static_cast<int>(row % sizes[1]);
+				const int k = static_cast<int>(row / sizes[1]);
+				const int index = (1 == axis) ? j : k;
+				for (int t = 0; t < width; ++t)
+				{
+					const int shiftedIndex = std::min(std::max(index + t - radius, 0), sizes[axis] - 1);
+					const size_t sourceRowIndex = (1 == axis) ?
+						static_cast<size_t>(k)*sizes[1] + shiftedIndex :
+						static_cast<size_t>(shiftedIndex)*sizes[1] + j;
+					const ZnReal *sourceRow = source + sourceRowIndex*rowSize;
+					const ZnReal coefficient = kernel[t];
+					if (0 == t)
+					{
+						for (size_t i = 0; i < rowSize; ++i)
+							targetRow[i] = coefficient*sourceRow[i];
+					}
+					else
+					{
+						for (size_t i = 0; i < rowSize; ++i)
+							targetRow[i] += coefficient*sourceRow[i];
+					}
+				}
+			}
+		}
+	});
+}
+
+/**
+ * Convolve values with the half kernel for each axis in turn, skipping axes
+ * with single coefficient kernels.
+ */
+bool convolveSeparable(ZnReal *values, int dimension, const int *sizesIn,
+	const std::vector<ZnReal> *halfKernels)
+{
+	if ((!values) || (dimension < 1) || (dimension > 3) || (!sizesIn))
+		return false;
+	int sizes[3] = { 1, 1, 1 };
+	for (int d = 0; d < dimension; ++d)
+	{
+		if (sizesIn[d] < 1)
+			return false;
+		sizes[d] = sizesIn[d];
+	}
+	const size_t count = static_cast<size_t>(sizes[0])*sizes[1]*sizes[2];
+	std::vector<ZnReal> buffer;
+	ZnReal *source = values;
+	ZnReal *target = 0;
+	for (int d = 0; d < dimension; ++d)
+	{
+		if (halfKernels[d].size() < 2)
+			continue;
+		if (!target)
+		{
+			buffer.resize(count);
+			target = buffer.data();
+		}
+		convolveAxis(source, target, sizes, d, halfKernels[d]);
+		std::swap(source, target);
+	}
+	if (source != values)
+		std::copy(source, source + count, values);
+	return true;
+}
+
+}
+
+namespace CMZN {
+
+void image_kernel_threshold(ZnReal *values, size_t count,
+	ZnReal lower, ZnReal upper, ZnReal outside_value)
+{
+	CMZN::parallel_for_blocks(count, blockValueCount, [=](size_t, size_t start, size_t end)
+	{
+		for (size_t i = start; i < end; ++i)
+		{
+			const ZnReal value = values[i];
+			values[i] = ((lower <= value) && (value <= upper)) ? value : outside_value;
+		}
+	});
+}
+
+void image_kernel_binary_threshold(ZnReal *values, size_t count,
+	ZnReal lower, ZnReal upper, ZnReal inside_value, ZnReal outside_value)
+{
+	CMZN::parallel_for_blocks(count, blockValueCount, [=](size_t, size_t start, size_t end)
+	{
+		for (size_t i = start; i < end; ++i)
+		{
+			const ZnReal value = values[i];
+			values[i] = ((lower <= value) && (value <= upper)) ? inside_value : outside_value;
+		}
+	});
+}
+
+void image_kernel_sigmoid(ZnReal *values, size_t count,
+	ZnReal output_minimum, ZnReal output_maximum, ZnReal alpha, ZnReal beta)
+{
+	const ZnReal scale = output_maximum - output_minimum;
+	CMZN::parallel_for_blocks(count, blockValueCount, [=](size_t, size_t start, size_t end)
+	{
+		for (size_t i = start; i < end; ++i)
+			values[i] = scale/(1.0 + std::exp(-(values[i] - beta)/alpha)) + output_minimum;
+	});
+}
+
+void image_kernel_rescale_intensity(ZnReal *values, size_t count,
+	ZnReal output_minimum, ZnReal output_maximum)
+{
+	if (count < 1)
+		return;
+	// per-block ranges are merged after all threads finish
+	const size_t blockCount = (count + blockValueCount - 1)/blockValueCount;
+	std::vector<ZnReal> blockMinimums(blockCount, values[0]);
+	std::vector<ZnReal> blockMaximums(blockCount, values[0]);
+	CMZN::parallel_for_blocks(count, blockValueCount, [&](size_t block, size_t start, size_t end)
+	{
+		ZnReal minimum = values[start];
+		ZnReal maximum = values[start];
+		for (size_t i = start; i < end; ++i)
+		{
+			minimum = (values[i] < minimum) ? values[i] : minimum;
+			maximum = (values[i] > maximum) ? values[i] : maximum;
+		}
+		blockMinimums[block] = minimum;
+		blockMaximums[block] = maximum;
+	});
+	const ZnReal input_minimum = *std::min_element(blockMinimums.begin(), blockMinimums.end());
+	const ZnReal input_maximum = *std::max_element(blockMaximums.begin(), blockMaximums.end());
+	ZnReal scale = 0.0;
+	if (input_minimum != input_maximum)
+		scale = (output_maximum - output_minimum)/(input_maximum - input_minimum);
+	else if (input_maximum != 0.0)
+		scale = (output_maximum - output_minimum)/input_maximum;
+	const ZnReal shift = output_minimum - input_minimum*scale;
+	CMZN::parallel_for_blocks(count, blockValueCount, [=](size_t, size_t start, size_t end)
+	{
+		for (size_t i = start; i < end; ++i)
+		{
+			const ZnReal value = values[i]*scale + shift;
+			values[i] = (value < output_minimum) ? output_minimum :
+				(value > output_maximum) ? output_maximum : value;
+		}
+	});
+}
+
+bool image_kernel_mean(ZnReal *values, int dimension, const int *sizes,
+	const int *radii)
+{
+	if ((dimension < 1) || (dimension > 3) || (!radii))
+		return false;
+	std::vector<ZnReal> halfKernels[3];
+	for (int d = 0; d < dimension; ++d)
+	{
+		const int radius = std::max(0, radii[d]);
+		halfKernels[d].assign(radius + 1, 1.0/(2*radius + 1));
+	}
+	return convolveSeparable(values, dimension, sizes, halfKernels);
+}
+
+void image_kernel_gaussian_coefficients(double variance, double maximum_error,
+	int maximum_kernel_width, std::vector<ZnReal>& coefficients)
+{
+	const double et = std::exp(-variance);
+	const double cap = 1.0 - maximum_error;
+	const size_t maximumCount = static_cast<size_t>(std::max(0, maximum_kernel_width));
+	coefficients.clear();
+	coefficients.push_back(et*modifiedBesselI0(variance));
+	double sum = coefficients[0];
+	coefficients.push_back(et*modifiedBesselI1(variance));
+	sum += coefficients[1]*2.0;
+	for (int i = 2; sum < cap; ++i)
+	{
+		coefficients.push_back(et*modifiedBesselI(i, variance));
+		sum += coefficients[i]*2.0;
+		if (coefficients[i] <= 0.0)
+			break;  // underflow
+		if (coefficients.size() > maximumCount)
+			break;
+	}
+	for (size_t i = 0; i < coefficients.size(); ++i)
+		coefficients[i] /= sum;
+}
+
+bool image_kernel_discrete_gaussian(ZnReal *values, int dimension,
+	const int *sizes, double variance, int maximum_kernel_width,
+	double maximum_error)
+{
+	if ((dimension < 1) || (dimension > 3) || (variance < 0.0))
+		return false;
+	std::vector<ZnReal> halfKernels[3];
+	image_kernel_gaussian_coefficients(variance, maximum_error, maximum_kernel_width, halfKernels[0]);
+	for (int d = 1; d < dimension; ++d)
+		halfKernels[d] = halfKernels[0];
+	return convolveSeparable(values, dimension, sizes, halfKernels);
+}
+
+} // namespace CMZN
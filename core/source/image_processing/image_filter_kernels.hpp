@@ -0,0 +1,96 @@
+/**
+ * FILE : image_filter_kernels.hpp
+ *
+ * Native multithreaded kernels for simple image filters.
+ */
+/* OpenCMISS-Zinc Library
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (__IMAGE_FILTER_KERNELS_HPP__)
+#define __IMAGE_FILTER_KERNELS_HPP__
+
+#include "opencmiss/zinc/zincconfigure.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * Kernels filter single component images of ZnReal values in place, with
+ * x varying fastest then y then z, as in the buffer of the itk::Image used
+ * by image filter fields. They do not depend on ITK, but give the same
+ * results as the ITK filters named below, up to rounding.
+ * Work is split over hardware threads in blocks of contiguous values, and the
+ * inner loops have no branches or calls so compilers vectorise them.
+ */
+
+namespace CMZN {
+
+/**
+ * Replace values outside lower to upper inclusive with outside_value, as
+ * itk::ThresholdImageFilter. NaN values are outside.
+ */
+void image_kernel_threshold(ZnReal *values, size_t count,
+	ZnReal lower, ZnReal upper, ZnReal outside_value);
+
+/**
+ * Replace values from lower to upper inclusive with inside_value and all
+ * others with outside_value, as itk::BinaryThresholdImageFilter.
+ */
+void image_kernel_binary_threshold(ZnReal *values, size_t count,
+	ZnReal lower, ZnReal upper, ZnReal inside_value, ZnReal outside_value);
+
+/**
+ * Map values through the sigmoid
+ * (maximum - minimum)/(1 + exp(-(value - beta)/alpha)) + minimum
+ * as itk::SigmoidImageFilter.
+ */
+void image_kernel_sigmoid(ZnReal *values, size_t count,
+	ZnReal output_minimum, ZnReal output_maximum, ZnReal alpha, ZnReal beta);
+
+/**
+ * Linearly map the range of values onto output_minimum to output_maximum, as
+ * itk::RescaleIntensityImageFilter, including its handling of constant images.
+ */
+void image_kernel_rescale_intensity(ZnReal *values, size_t count,
+	ZnReal output_minimum, ZnReal output_maximum);
+
+/**
+ * Replace values with the mean over the box of radii around them, as
+ * itk::MeanImageFilter, by averaging along each axis in turn. Values beyond
+ * the image boundary repeat the nearest value in the image.
+ * @param dimension  Number of image dimensions 1 to 3.
+ * @param sizes  Number of pixels in each dimension.
+ * @param radii  Box radius in pixels in each dimension.
+ * @return  True on success, false if invalid arguments.
+ */
+bool image_kernel_mean(ZnReal *values, int dimension, const int *sizes,
+	const int *radii);
+
+/**
+ * Get one half of the symmetric discrete gaussian kernel generated by
+ * itk::GaussianOperator, from the centre coefficient outwards and normalised
+ * so the full kernel sums to 1.
+ * @param variance  Variance in pixels squared.
+ * @param maximum_error  Fraction of the gaussian allowed outside the kernel.
+ * @param maximum_kernel_width  Coefficients are added until the error is
+ * reached or there are more than this number.
+ */
+void image_kernel_gaussian_coefficients(double variance, double maximum_error,
+	int maximum_kernel_width, std::vector<ZnReal>& coefficients);
+
+/**
+ * Convolve values with a discrete gaussian along each axis in turn, as
+ * itk::DiscreteGaussianImageFilter on an image with unit spacing. Values
+ * beyond the image boundary repeat the nearest value in the image.
+ * @param dimension  Number of image dimensions 1 to 3.
+ * @param sizes  Number of pixels in each dimension.
+ * @return  True on success, false if invalid arguments.
+ */
+bool image_kernel_discrete_gaussian(ZnReal *values, int dimension,
+	const int *sizes, double variance, int maximum_kernel_width,
+	double maximum_error = 0.01);
+
+} // namespace CMZN
+
+#endif /* !defined (__IMAGE_FILTER_KERNELS_HPP__) */
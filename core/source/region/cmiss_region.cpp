@@ -33,6 +33,7 @@
 #include "finite_element/finite_element_region_private.h"
 #include "general/message.h"
 #include <algorithm>
+#include <climits>
 #include <vector>
 
 /*
@@ -913,6 +914,52 @@ int cmzn_fieldmodule_define_all_faces(cmzn_fieldmodule_id field_module)
 		cmzn_fieldmodule_get_region_internal(field_module)->get_FE_region());
 }
 
+int cmzn_fieldmodule_get_element_evaluation_cache_budget(
+	cmzn_fieldmodule_id fieldmodule)
+{
+	if (fieldmodule)
+		return cmzn_fieldmodule_get_region_internal(fieldmodule)->get_FE_region()->getElementEvaluationCacheBudget();
+	return 0;
+}
+
+int cmzn_fieldmodule_set_element_evaluation_cache_budget(
+	cmzn_fieldmodule_id fieldmodule, int budget_bytes)
+{
+	if ((fieldmodule) && (budget_bytes >= 0))
+		return cmzn_fieldmodule_get_region_internal(fieldmodule)->get_FE_region()->setElementEvaluationCacheBudget(budget_bytes);
+	display_message(ERROR_MESSAGE, "cmzn_fieldmodule_set_element_evaluation_cache_budget.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_fieldmodule_get_element_evaluation_cache_statistics(
+	cmzn_fieldmodule_id fieldmodule, int *hits_out, int *misses_out)
+{
+	if ((fieldmodule) && (hits_out) && (misses_out))
+	{
+		const FE_region *fe_region = cmzn_fieldmodule_get_region_internal(fieldmodule)->get_FE_region();
+		const unsigned long long maximumInt = static_cast<unsigned long long>(INT_MAX);
+		const unsigned long long hits = fe_region->getElementEvaluationCacheHits();
+		const unsigned long long misses = fe_region->getElementEvaluationCacheMisses();
+		*hits_out = static_cast<int>((hits < maximumInt) ? hits : maximumInt);
+		*misses_out = static_cast<int>((misses < maximumInt) ? misses : maximumInt);
+		return CMZN_OK;
+	}
+	display_message(ERROR_MESSAGE, "cmzn_fieldmodule_get_element_evaluation_cache_statistics.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
+
+int cmzn_fieldmodule_reset_element_evaluation_cache_statistics(
+	cmzn_fieldmodule_id fieldmodule)
+{
+	if (fieldmodule)
+	{
+		cmzn_fieldmodule_get_region_internal(fieldmodule)->get_FE_region()->resetElementEvaluationCacheStatistics();
+		return CMZN_OK;
+	}
+	display_message(ERROR_MESSAGE, "cmzn_fieldmodule_reset_element_evaluation_cache_statistics.  Invalid argument(s)");
+	return CMZN_ERROR_ARGUMENT;
+}
+
 int cmzn_region_begin_change(struct cmzn_region *region)
 {
 	if (region)
@@ -17,12 +17,208 @@
 #include "general/mystring.h"
 #include "general/image_utilities.h"
 #include "graphics/texture.h"
+#include "graphics/texture.hpp"
+#include "graphics/texture_brick_store.hpp"
 #include "general/message.h"
+#include "general/parallel.hpp"
 #include "general/enumerator_conversion.hpp"
 #include "stream/field_image_stream.hpp"
 #include "image_io/analyze.h"
 #include "image_io/analyze_object_map.hpp"
+#include "image_io/volume_reader.hpp"
 
+#include <atomic>
+#include <vector>
+
+namespace {
+
+/**
+ * Replace texture of image field with new texture, keeping display attributes
+ * of the old texture.
+ * @return  1 on success, 0 on failure.
+ */
+int cmzn_field_image_replace_texture(cmzn_field_image_id image_field, Texture *texture)
+{
+	Texture *old_texture = cmzn_field_image_get_texture(image_field);
+	if (old_texture)
+	{
+		Texture_set_combine_mode(texture, Texture_get_combine_mode(old_texture));
+		Texture_set_filter_mode(texture, Texture_get_filter_mode(old_texture));
+		Texture_set_compression_mode(texture, Texture_get_compression_mode(old_texture));
+		Texture_set_wrap_mode(texture, Texture_get_wrap_mode(old_texture));
+		double sizes[3];
+		cmzn_texture_get_texture_coordinate_sizes(old_texture, 3, sizes);
+		cmzn_texture_set_texture_coordinate_sizes(texture, 3, sizes);
+	}
+	return cmzn_field_image_set_texture(image_field, texture);
+}
+
+/** Read image in format of image information. */
+struct Cmgui_image *cmzn_field_image_read_cmgui_image(
+	struct Cmgui_image_information *image_information,
+	enum cmzn_streaminformation_data_compression_type data_compression_type)
+{
+	if (Cmgui_image_information_get_image_file_format(image_information) == ANALYZE_FILE_FORMAT)
+	{
+		return Cmgui_image_read_analyze(image_information, data_compression_type);
+	}
+	else if (Cmgui_image_information_get_image_file_format(image_information) == ANALYZE_OBJECT_MAP_FORMAT)
+	{
+		return Cmgui_image_read_analyze_object_map(image_information, data_compression_type);
+	}
+	return Cmgui_image_read(image_information);
+}
+
+/**
+ * Read uncompressed Analyze or raw volume files directly into texture,
+ * bypassing ImageMagick and Cmgui_image.
+ * @return  CMZN_OK on success, CMZN_ERROR_NOT_IMPLEMENTED if the image must be
+ * read through Cmgui_image instead, otherwise any other error code.
+ */
+int cmzn_field_image_read_texture_direct(Texture *texture,
+	struct Cmgui_image_information *image_information,
+	enum cmzn_streaminformation_data_compression_type data_compression_type,
+	const char *texture_file_name)
+{
+	if (Cmgui_image_information_get_image_file_format(image_information) == ANALYZE_FILE_FORMAT)
+	{
+		return Texture_read_analyze_volume(texture, image_information,
+			data_compression_type, texture_file_name);
+	}
+	if ((data_compression_type != CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_GZIP) &&
+		(data_compression_type != CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_BZIP2))
+	{
+		return Texture_read_raw_volume(texture, image_information, texture_file_name);
+	}
+	return CMZN_ERROR_NOT_IMPLEMENTED;
+}
+
+/**
+ * Read series of image files or memory blocks into texture, decoding them on
+ * a pool of threads. The texture is allocated from the size and format of the
+ * first image, and each decoded image is copied straight into its planes
+ * then released, so at most one decoded image per thread is held in memory.
+ * Every file must hold the same number of images of the same size and format.
+ * @return  CMZN_OK on success, CMZN_ERROR_NOT_IMPLEMENTED if there is only
+ * one file or memory block, otherwise any other error code.
+ */
+int cmzn_field_image_read_texture_series(Texture *texture,
+	struct Cmgui_image_information *image_information,
+	enum cmzn_streaminformation_data_compression_type data_compression_type,
+	const char *texture_file_name)
+{
+	const bool memory = (0 != image_information->memory_blocks);
+	const int number_of_files = (memory) ? image_information->number_of_memory_blocks :
+		image_information->number_of_file_names;
+	if (number_of_files < 2)
+		return CMZN_ERROR_NOT_IMPLEMENTED;
+	auto read_file = [&](int f)
+	{
+		// shallow copy sharing all settings with only file f; not destroyed
+		struct Cmgui_image_information file_information = *image_information;
+		if (memory)
+		{
+			file_information.memory_blocks = image_information->memory_blocks + f;
+			file_information.number_of_memory_blocks = 1;
+		}
+		else
+		{
+			file_information.file_names = image_information->file_names + f;
+			file_information.number_of_file_names = 1;
+		}
+		return cmzn_field_image_read_cmgui_image(&file_information, data_compression_type);
+	};
+	struct Cmgui_image *first_image = read_file(0);
+	if (!first_image)
+		return CMZN_ERROR_GENERAL;
+	const int width = Cmgui_image_get_width(first_image);
+	const int height = Cmgui_image_get_height(first_image);
+	const int number_of_components = Cmgui_image_get_number_of_components(first_image);
+	const int number_of_bytes_per_component = Cmgui_image_get_number_of_bytes_per_component(first_image);
+	const int images_per_file = Cmgui_image_get_number_of_images(first_image);
+	int padded_width_bytes = 0;
+	unsigned char *texels = 0;
+	if (!(Texture_allocate_image(texture, width, height, number_of_files*images_per_file,
+			Texture_storage_type_from_number_of_components(number_of_components),
+			number_of_bytes_per_component, texture_file_name) &&
+		(texels = Texture_access_image_texels(texture, &padded_width_bytes))))
+	{
+		DESTROY(Cmgui_image)(&first_image);
+		return CMZN_ERROR_MEMORY;
+	}
+	char *property, *value;
+	Cmgui_image_get_property(first_image, "exif:*");
+	Cmgui_image_reset_property_iterator(first_image);
+	while ((property = Cmgui_image_get_next_property(first_image)) &&
+		(value = Cmgui_image_get_property(first_image, property)))
+	{
+		Texture_set_property(texture, property, value);
+		DEALLOCATE(property);
+		DEALLOCATE(value);
+	}
+	const size_t plane_bytes = static_cast<size_t>(padded_width_bytes)*height;
+	auto copy_images = [&](struct Cmgui_image *cmgui_image, int f)
+	{
+		const unsigned char fill_byte = 0;
+		for (int i = 0; i < images_per_file; ++i)
+		{
+			/* fill image from bottom to top */
+			if (!Cmgui_image_dispatch(cmgui_image, /*image_number*/i, /*left*/0, /*bottom*/0,
+				width, height, padded_width_bytes, /*number_of_fill_bytes*/1, &fill_byte,
+				/*components*/0, texels + (f*images_per_file + i)*plane_bytes))
+				return false;
+		}
+		return true;
+	};
+	const bool first_copied = copy_images(first_image, 0);
+	DESTROY(Cmgui_image)(&first_image);
+	if (!first_copied)
+		return CMZN_ERROR_GENERAL;
+	std::atomic<int> failed_file(number_of_files);
+	std::atomic<int> mismatched_file(number_of_files);
+	CMZN::parallel_for(1, static_cast<size_t>(number_of_files),
+		CMZN::parallel_get_thread_count(static_cast<size_t>(number_of_files - 1)),
+		[&](int, size_t index)
+		{
+			// skip remaining files once any has failed
+			if (failed_file < number_of_files)
+				return;
+			const int f = static_cast<int>(index);
+			struct Cmgui_image *cmgui_image = read_file(f);
+			if (!cmgui_image)
+			{
+				failed_file = f;
+				return;
+			}
+			if ((Cmgui_image_get_width(cmgui_image) != width) ||
+				(Cmgui_image_get_height(cmgui_image) != height) ||
+				(Cmgui_image_get_number_of_components(cmgui_image) != number_of_components) ||
+				(Cmgui_image_get_number_of_bytes_per_component(cmgui_image) != number_of_bytes_per_component) ||
+				(Cmgui_image_get_number_of_images(cmgui_image) != images_per_file))
+			{
+				mismatched_file = f;
+				failed_file = f;
+			}
+			else if (!copy_images(cmgui_image, f))
+			{
+				failed_file = f;
+			}
+			DESTROY(Cmgui_image)(&cmgui_image);
+		});
+	if (mismatched_file < number_of_files)
+	{
+		display_message(ERROR_MESSAGE, "cmzn_field_image_read.  "
+			"Image %d of series does not match size or format of first image",
+			static_cast<int>(mismatched_file) + 1);
+		return CMZN_ERROR_ARGUMENT;
+	}
+	if (failed_file < number_of_files)
+		return CMZN_ERROR_GENERAL;
+	return CMZN_OK;
+}
+
+}
+
 int cmzn_field_image_read(cmzn_field_image_id image_field,
 	cmzn_streaminformation_image_id streaminformation_image)
 {
@@ -108,21 +304,35 @@ int cmzn_field_image_read(cmzn_field_image_id image_field,
 				if (!return_code)
 					break;
 			}
+			bool read_direct = false;
 			if (return_code)
 			{
-				struct Cmgui_image *cmgui_image = 0;
-				if (Cmgui_image_information_get_image_file_format(image_information) == ANALYZE_FILE_FORMAT)
+				Texture *texture = CREATE(Texture)(field_name);
+				int result = (texture) ? cmzn_field_image_read_texture_direct(texture,
+					image_information, data_compression_type, texture_file_name) : CMZN_ERROR_MEMORY;
+				if (CMZN_ERROR_NOT_IMPLEMENTED == result)
 				{
-					cmgui_image = Cmgui_image_read_analyze(image_information, data_compression_type);
+					result = cmzn_field_image_read_texture_series(texture,
+						image_information, data_compression_type, texture_file_name);
 				}
-				else if (Cmgui_image_information_get_image_file_format(image_information) == ANALYZE_OBJECT_MAP_FORMAT)
+				if (CMZN_OK == result)
 				{
-					cmgui_image = Cmgui_image_read_analyze_object_map(image_information, data_compression_type);
+					read_direct = true;
+					return_code = cmzn_field_image_replace_texture(image_field, texture);
 				}
-				else
+				else if (CMZN_ERROR_NOT_IMPLEMENTED != result)
 				{
-					cmgui_image = Cmgui_image_read(image_information);
+					display_message(ERROR_MESSAGE,
+						"cmzn_field_image_read.  Could not read image file");
+					return_code = 0;
 				}
+				if (texture)
+					DESTROY(Texture)(&texture);
+			}
+			if (return_code && !read_direct)
+			{
+				struct Cmgui_image *cmgui_image =
+					cmzn_field_image_read_cmgui_image(image_information, data_compression_type);
 				if (cmgui_image != NULL)
 				{
 					char *property, *value;
@@ -161,19 +371,7 @@ int cmzn_field_image_read(cmzn_field_image_id image_field,
 					}
 					if (return_code)
 					{
-						// copy attributes from old texture
-						Texture *old_texture = cmzn_field_image_get_texture(image_field);
-						if (old_texture)
-						{
-							Texture_set_combine_mode(texture, Texture_get_combine_mode(old_texture));
-							Texture_set_filter_mode(texture, Texture_get_filter_mode(old_texture));
-							Texture_set_compression_mode(texture, Texture_get_compression_mode(old_texture));
-							Texture_set_wrap_mode(texture, Texture_get_wrap_mode(old_texture));
-							double sizes[3];
-							cmzn_texture_get_texture_coordinate_sizes(old_texture, 3, sizes);
-							cmzn_texture_set_texture_coordinate_sizes(texture, 3, sizes);
-						}
-						return_code = cmzn_field_image_set_texture(image_field, texture);
+						return_code = cmzn_field_image_replace_texture(image_field, texture);
 						DESTROY(Texture)(&texture);
 					}
 				}
@@ -226,6 +424,174 @@ int cmzn_field_image_read_file(cmzn_field_image_id image_field, const char *file
 	return return_code;
 }
 
+int cmzn_field_image_read_bricked(cmzn_field_image_id image_field,
+	cmzn_streaminformation_image_id streaminformation_image,
+	const char *brick_file_name)
+{
+	struct Cmgui_image_information *image_information = 0;
+	if (!((image_field) && (streaminformation_image) && (brick_file_name) &&
+		(0 != (image_information = streaminformation_image->getImageInformation()))))
+	{
+		display_message(ERROR_MESSAGE, "cmzn_field_image_read_bricked.  Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	// only file resources can be bricked; each is read and discarded in turn
+	std::vector<char *> file_names;
+	const cmzn_stream_properties_list streams_list = streaminformation_image->getResourcesList();
+	int return_code = CMZN_OK;
+	for (cmzn_stream_properties_list_const_iterator iter = streams_list.begin();
+		iter != streams_list.end(); ++iter)
+	{
+		cmzn_streamresource_file_id file_resource = cmzn_streamresource_cast_file((*iter)->getResource());
+		char *file_name = (file_resource) ? file_resource->getFileName() : 0;
+		if (file_name)
+		{
+			file_names.push_back(file_name);
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE, "cmzn_field_image_read_bricked.  "
+				"Only file resources can be read into a bricked image");
+			return_code = CMZN_ERROR_ARGUMENT;
+		}
+		cmzn_streamresource_file_destroy(&file_resource);
+	}
+	if (file_names.empty())
+	{
+		display_message(ERROR_MESSAGE,
+			"cmzn_field_image_read_bricked.  streaminformation does not contain any files");
+		return_code = CMZN_ERROR_ARGUMENT;
+	}
+	const enum cmzn_streaminformation_data_compression_type data_compression_type =
+		cmzn_streaminformation_get_data_compression_type(
+			cmzn_streaminformation_image_base_cast(streaminformation_image));
+	TextureBrickStore *brick_store = 0;
+	Texture *texture = 0;
+	int sizes[3] = { 0, 0, 0 };
+	int number_of_components = 0, number_of_bytes_per_component = 0;
+	size_t row_bytes = 0;
+	std::vector<unsigned char> plane;
+	const int number_of_files = static_cast<int>(file_names.size());
+	int z = 0;
+	for (int f = 0; (f < number_of_files) && (CMZN_OK == return_code); ++f)
+	{
+		Cmgui_image_information_clear_file_names(image_information);
+		Cmgui_image_information_add_file_name(image_information, file_names[f]);
+		struct Cmgui_image *cmgui_image =
+			cmzn_field_image_read_cmgui_image(image_information, data_compression_type);
+		if (!cmgui_image)
+		{
+			display_message(ERROR_MESSAGE,
+				"cmzn_field_image_read_bricked.  Could not read image file %s", file_names[f]);
+			return_code = CMZN_ERROR_GENERAL;
+			break;
+		}
+		const int number_of_images = Cmgui_image_get_number_of_images(cmgui_image);
+		if (0 == f)
+		{
+			// size of volume is assumed from first file
+			sizes[0] = Cmgui_image_get_width(cmgui_image);
+			sizes[1] = Cmgui_image_get_height(cmgui_image);
+			sizes[2] = number_of_files*number_of_images;
+			number_of_components = Cmgui_image_get_number_of_components(cmgui_image);
+			number_of_bytes_per_component = Cmgui_image_get_number_of_bytes_per_component(cmgui_image);
+			const int bytes_per_pixel = number_of_components*number_of_bytes_per_component;
+			row_bytes = 4*((static_cast<size_t>(sizes[0])*bytes_per_pixel + 3)/4);
+			plane.resize(row_bytes*sizes[1]);
+			char *field_name = cmzn_field_get_name(cmzn_field_image_base_cast(image_field));
+			texture = CREATE(Texture)(field_name);
+			DEALLOCATE(field_name);
+			if ((0 == texture) || (0 == (brick_store = TextureBrickStore::create(brick_file_name,
+				sizes, number_of_components, number_of_bytes_per_component))))
+			{
+				display_message(ERROR_MESSAGE,
+					"cmzn_field_image_read_bricked.  Could not create bricked image");
+				return_code = CMZN_ERROR_GENERAL;
+			}
+			else
+			{
+				char *property, *value;
+				Cmgui_image_get_property(cmgui_image, "exif:*");
+				Cmgui_image_reset_property_iterator(cmgui_image);
+				while ((property = Cmgui_image_get_next_property(cmgui_image)) &&
+					(value = Cmgui_image_get_property(cmgui_image, property)))
+				{
+					Texture_set_property(texture, property, value);
+					DEALLOCATE(property);
+					DEALLOCATE(value);
+				}
+			}
+		}
+		else if ((Cmgui_image_get_width(cmgui_image) != sizes[0]) ||
+			(Cmgui_image_get_height(cmgui_image) != sizes[1]) ||
+			(number_of_images*number_of_files != sizes[2]) ||
+			(Cmgui_image_get_number_of_components(cmgui_image) != number_of_components) ||
+			(Cmgui_image_get_number_of_bytes_per_component(cmgui_image) != number_of_bytes_per_component))
+		{
+			display_message(ERROR_MESSAGE, "cmzn_field_image_read_bricked.  "
+				"Image file %s does not match size or format of first file", file_names[f]);
+			return_code = CMZN_ERROR_ARGUMENT;
+		}
+		const unsigned char fill_byte = 0;
+		for (int i = 0; (i < number_of_images) && (CMZN_OK == return_code); ++i)
+		{
+			if (!(Cmgui_image_dispatch(cmgui_image, /*image_number*/i,
+					/*left*/0, /*bottom*/0, sizes[0], sizes[1], static_cast<int>(row_bytes),
+					/*number_of_fill_bytes*/1, &fill_byte, /*components*/0, plane.data()) &&
+				brick_store->writePlane(z, plane.data(), row_bytes)))
+			{
+				display_message(ERROR_MESSAGE,
+					"cmzn_field_image_read_bricked.  Could not write image bricks");
+				return_code = CMZN_ERROR_GENERAL;
+			}
+			++z;
+		}
+		DESTROY(Cmgui_image)(&cmgui_image);
+	}
+	Cmgui_image_information_clear_file_names(image_information);
+	for (int f = 0; f < number_of_files; ++f)
+	{
+		DEALLOCATE(file_names[f]);
+	}
+	if (CMZN_OK == return_code)
+	{
+		return_code = Texture_set_brick_store(texture, brick_store, brick_file_name);
+		if ((CMZN_OK == return_code) && (!cmzn_field_image_replace_texture(image_field, texture)))
+			return_code = CMZN_ERROR_GENERAL;
+	}
+	TextureBrickStore::deaccess(brick_store);
+	if (texture)
+		DESTROY(Texture)(&texture);
+	return return_code;
+}
+
+int cmzn_field_image_read_brick_file(cmzn_field_image_id image_field,
+	const char *brick_file_name)
+{
+	if (!((image_field) && (brick_file_name)))
+	{
+		display_message(ERROR_MESSAGE, "cmzn_field_image_read_brick_file.  Invalid argument(s)");
+		return CMZN_ERROR_ARGUMENT;
+	}
+	TextureBrickStore *brick_store = TextureBrickStore::open(brick_file_name);
+	if (!brick_store)
+		return CMZN_ERROR_GENERAL;
+	int return_code = CMZN_ERROR_MEMORY;
+	char *field_name = cmzn_field_get_name(cmzn_field_image_base_cast(image_field));
+	Texture *texture = CREATE(Texture)(field_name);
+	DEALLOCATE(field_name);
+	if (texture)
+	{
+		return_code = Texture_set_brick_store(texture, brick_store, brick_file_name);
+		if ((CMZN_OK == return_code) && (!cmzn_field_image_replace_texture(image_field, texture)))
+			return_code = CMZN_ERROR_GENERAL;
+	}
+	TextureBrickStore::deaccess(brick_store);
+	if (texture)
+		DESTROY(Texture)(&texture);
+	return return_code;
+}
+
 int cmzn_field_image_write(cmzn_field_image_id image_field,
 	cmzn_streaminformation_image_id streaminformation_image)
 {
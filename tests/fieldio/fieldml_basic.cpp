@@ -10,6 +10,7 @@
 #include <cmath>
 
 #include <opencmiss/zinc/core.h>
+#include <opencmiss/zinc/differentialoperator.hpp>
 #include <opencmiss/zinc/field.hpp>
 #include <opencmiss/zinc/fieldarithmeticoperators.hpp>
 #include <opencmiss/zinc/fieldcache.hpp>
@@ -902,6 +903,8 @@ void check_ex_element_grid_constant_indexed_fields(Fieldmodule& fm)
 
 	Mesh mesh3d = fm.findMeshByDimension(3);
 	EXPECT_TRUE(mesh3d.isValid());
+	Differentialoperator d_dxi = mesh3d.getChartDifferentialoperator(/*order*/1, /*term*/-1);
+	EXPECT_TRUE(d_dxi.isValid());
 	Fieldcache cache = fm.createFieldcache();
 	EXPECT_TRUE(cache.isValid());
 
@@ -922,6 +925,17 @@ void check_ex_element_grid_constant_indexed_fields(Fieldmodule& fm)
 
 		EXPECT_EQ(RESULT_OK, result = conductivity.evaluateReal(cache, 1, &conductivityOut));
 		EXPECT_DOUBLE_EQ(expectedConductivityOut[e], conductivityOut);
+		// derivatives of indexed and constant fields are zero
+		double conductivityDerivativesOut[3] = { 1.0, 1.0, 1.0 };
+		EXPECT_EQ(RESULT_OK, result = conductivity.evaluateDerivative(d_dxi, cache, 3, conductivityDerivativesOut));
+		for (int d = 0; d < 3; ++d)
+			EXPECT_EQ(0.0, conductivityDerivativesOut[d]);
+		double magneticFieldVectorDerivativesOut[9];
+		for (int i = 0; i < 9; ++i)
+			magneticFieldVectorDerivativesOut[i] = 1.0;
+		EXPECT_EQ(RESULT_OK, result = magneticFieldVector.evaluateDerivative(d_dxi, cache, 9, magneticFieldVectorDerivativesOut));
+		for (int i = 0; i < 9; ++i)
+			EXPECT_EQ(0.0, magneticFieldVectorDerivativesOut[i]);
 
 		EXPECT_EQ(RESULT_OK, result = coordinates.evaluateReal(cache, 3, coordinatesOut));
 		for (int c = 0; c < 3; ++c)
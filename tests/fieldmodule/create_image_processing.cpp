@@ -8,6 +8,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <opencmiss/zinc/core.h>
 #include <opencmiss/zinc/field.h>
 #include <opencmiss/zinc/fieldcache.h>
@@ -21,6 +24,7 @@
 #include <opencmiss/zinc/streamimage.h>
 
 #include <opencmiss/zinc/field.hpp>
+#include <opencmiss/zinc/fieldcache.hpp>
 #include <opencmiss/zinc/fieldimage.hpp>
 #include <opencmiss/zinc/fieldimageprocessing.hpp>
 #include <opencmiss/zinc/fieldmodule.hpp>
@@ -209,3 +213,222 @@ TEST(ZincFieldImagefilterThreshold, api)
 	EXPECT_EQ(CMZN_OK, result = th.setUpperThreshold(0.8));
 	ASSERT_DOUBLE_EQ(0.8, value = th.getUpperThreshold());
 }
+
+// image filter input is converted directly from the image texture when
+// sampled at pixel centres; check it matches the image, also through a chain
+TEST(ZincFieldImagefilterThreshold, imageInput)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	FieldImage im = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im.isValid());
+	EXPECT_EQ(CMZN_OK, result = im.readFile(TestResources::getLocation(TestResources::TESTIMAGE_GRAY_JPG_RESOURCE)));
+	int sizes[2];
+	EXPECT_EQ(2, result = im.getSizeInPixels(2, sizes));
+	Field xi = im.getDomainField();
+	EXPECT_TRUE(xi.isValid());
+
+	// all values are inside the threshold range so are passed through unchanged
+	FieldImagefilterThreshold th1 = zinc.fm.createFieldImagefilterThreshold(im);
+	EXPECT_TRUE(th1.isValid());
+	EXPECT_EQ(CMZN_OK, result = th1.setCondition(FieldImagefilterThreshold::CONDITION_OUTSIDE));
+	EXPECT_EQ(CMZN_OK, result = th1.setLowerThreshold(-1.0));
+	EXPECT_EQ(CMZN_OK, result = th1.setUpperThreshold(2.0));
+	FieldImagefilterThreshold th2 = zinc.fm.createFieldImagefilterThreshold(th1);
+	EXPECT_TRUE(th2.isValid());
+	EXPECT_EQ(CMZN_OK, result = th2.setCondition(FieldImagefilterThreshold::CONDITION_OUTSIDE));
+	EXPECT_EQ(CMZN_OK, result = th2.setLowerThreshold(-1.0));
+	EXPECT_EQ(CMZN_OK, result = th2.setUpperThreshold(2.0));
+
+	// same image stretched over twice the domain so pixel centres are not
+	// texel centres: input must be evaluated per pixel, not copied from texels
+	FieldImage scaledIm = zinc.fm.createFieldImage();
+	EXPECT_TRUE(scaledIm.isValid());
+	EXPECT_EQ(CMZN_OK, result = scaledIm.readFile(TestResources::getLocation(TestResources::TESTIMAGE_GRAY_JPG_RESOURCE)));
+	EXPECT_EQ(CMZN_OK, result = scaledIm.setDomainField(xi));
+	const double textureCoordinateSizes[2] = { 2.0, 2.0 };
+	EXPECT_EQ(CMZN_OK, result = scaledIm.setTextureCoordinateSizes(2, textureCoordinateSizes));
+	FieldImagefilterThreshold scaledTh = zinc.fm.createFieldImagefilterThreshold(scaledIm);
+	EXPECT_TRUE(scaledTh.isValid());
+	EXPECT_EQ(CMZN_OK, result = scaledTh.setCondition(FieldImagefilterThreshold::CONDITION_OUTSIDE));
+	EXPECT_EQ(CMZN_OK, result = scaledTh.setLowerThreshold(-1.0));
+	EXPECT_EQ(CMZN_OK, result = scaledTh.setUpperThreshold(2.0));
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	const int pixels[4][2] = { { 0, 0 }, { 1, 2 }, { sizes[0]/2, sizes[1]/3 }, { sizes[0] - 1, sizes[1] - 1 } };
+	double maximumScaledDifference = 0.0;
+	for (int p = 0; p < 4; ++p)
+	{
+		const double location[2] = {
+			(pixels[p][0] + 0.5)/static_cast<double>(sizes[0]),
+			(pixels[p][1] + 0.5)/static_cast<double>(sizes[1]) };
+		EXPECT_EQ(CMZN_OK, result = cache.setFieldReal(xi, 2, location));
+		double imageValue, value1, value2, scaledImageValue, scaledValue;
+		EXPECT_EQ(CMZN_OK, result = im.evaluateReal(cache, 1, &imageValue));
+		EXPECT_EQ(CMZN_OK, result = th1.evaluateReal(cache, 1, &value1));
+		EXPECT_EQ(CMZN_OK, result = th2.evaluateReal(cache, 1, &value2));
+		EXPECT_NEAR(imageValue, value1, 1.0E-12);
+		EXPECT_NEAR(imageValue, value2, 1.0E-12);
+		EXPECT_EQ(CMZN_OK, result = scaledIm.evaluateReal(cache, 1, &scaledImageValue));
+		EXPECT_EQ(CMZN_OK, result = scaledTh.evaluateReal(cache, 1, &scaledValue));
+		EXPECT_NEAR(scaledImageValue, scaledValue, 1.0E-12);
+		maximumScaledDifference = std::max(maximumScaledDifference, fabs(scaledValue - imageValue));
+	}
+	// copying texels would give the unscaled image values
+	EXPECT_LT(1.0E-3, maximumScaledDifference);
+}
+
+// thresholds of an image field are applied directly to its texels, skipping
+// bricks of the image outside or inside the threshold range; check every pixel
+TEST(ZincFieldImagefilterBinaryThreshold, imageBricks)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	// two blocks of high values in a low background, one with a lower voxel
+	const int size = 20;
+	unsigned char buffer[size*size*size];
+	for (int k = 0; k < size; ++k)
+		for (int j = 0; j < size; ++j)
+			for (int i = 0; i < size; ++i)
+			{
+				const bool blockA = (2 <= i) && (i <= 7) && (2 <= j) && (j <= 7) && (2 <= k) && (k <= 7);
+				const bool blockB = (12 <= i) && (i <= 17) && (12 <= j) && (j <= 17) && (12 <= k) && (k <= 17);
+				buffer[(k*size + j)*size + i] = (blockA || blockB) ? 200 : 10;
+			}
+	buffer[(5*size + 5)*size + 5] = 120;
+	FieldImage im = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im.isValid());
+	const int sizes[3] = { size, size, size };
+	EXPECT_EQ(CMZN_OK, result = im.setSizeInPixels(3, sizes));
+	EXPECT_EQ(CMZN_OK, result = im.setPixelFormat(FieldImage::PIXEL_FORMAT_LUMINANCE));
+	EXPECT_EQ(CMZN_OK, result = im.setBuffer(buffer, size*size*size));
+	Field xi = im.getDomainField();
+	EXPECT_TRUE(xi.isValid());
+
+	FieldImagefilterBinaryThreshold bt = zinc.fm.createFieldImagefilterBinaryThreshold(im);
+	EXPECT_TRUE(bt.isValid());
+	EXPECT_EQ(CMZN_OK, result = bt.setLowerThreshold(0.4));
+	EXPECT_EQ(CMZN_OK, result = bt.setUpperThreshold(1.0));
+	const double seed[3] = { 0.25, 0.25, 0.25 };
+	FieldImagefilterConnectedThreshold ct = zinc.fm.createFieldImagefilterConnectedThreshold(
+		im, 0.4, 1.0, 1.0, 3, 1, seed);
+	EXPECT_TRUE(ct.isValid());
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	for (int k = 0; k < size; ++k)
+		for (int j = 0; j < size; ++j)
+			for (int i = 0; i < size; ++i)
+			{
+				const double location[3] = { (i + 0.5)/size, (j + 0.5)/size, (k + 0.5)/size };
+				EXPECT_EQ(CMZN_OK, result = cache.setFieldReal(xi, 3, location));
+				const unsigned char pixel = buffer[(k*size + j)*size + i];
+				const bool inRange = (pixel >= 0.4*255.0);
+				double value;
+				EXPECT_EQ(CMZN_OK, result = bt.evaluateReal(cache, 1, &value));
+				if (inRange)
+					EXPECT_LT(0.0, value);
+				else
+					EXPECT_EQ(0.0, value);
+				EXPECT_EQ(CMZN_OK, result = ct.evaluateReal(cache, 1, &value));
+				EXPECT_EQ((inRange && (i < 10)) ? 1.0 : 0.0, value);
+			}
+}
+
+// pointwise and separable filters are evaluated with native kernels on the
+// image values; compare with values calculated directly from the pixels
+TEST(ZincFieldImagefilterNative, pointwiseAndSeparable)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	const int sizes[3] = { 12, 10, 6 };
+	const int count = sizes[0]*sizes[1]*sizes[2];
+	unsigned char buffer[12*10*6];
+	unsigned char rampBuffer[12*10*6];
+	for (int k = 0; k < sizes[2]; ++k)
+		for (int j = 0; j < sizes[1]; ++j)
+			for (int i = 0; i < sizes[0]; ++i)
+			{
+				const int index = (k*sizes[1] + j)*sizes[0] + i;
+				buffer[index] = static_cast<unsigned char>((i*37 + j*101 + k*53) % 256);
+				rampBuffer[index] = static_cast<unsigned char>(20*i);
+			}
+	FieldImage im = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im.isValid());
+	EXPECT_EQ(CMZN_OK, result = im.setSizeInPixels(3, sizes));
+	EXPECT_EQ(CMZN_OK, result = im.setPixelFormat(FieldImage::PIXEL_FORMAT_LUMINANCE));
+	EXPECT_EQ(CMZN_OK, result = im.setBuffer(buffer, count));
+	Field xi = im.getDomainField();
+	EXPECT_TRUE(xi.isValid());
+	FieldImage ramp = zinc.fm.createFieldImage();
+	EXPECT_TRUE(ramp.isValid());
+	EXPECT_EQ(CMZN_OK, result = ramp.setSizeInPixels(3, sizes));
+	EXPECT_EQ(CMZN_OK, result = ramp.setPixelFormat(FieldImage::PIXEL_FORMAT_LUMINANCE));
+	EXPECT_EQ(CMZN_OK, result = ramp.setBuffer(rampBuffer, count));
+
+	FieldImagefilterSigmoid sigmoid = zinc.fm.createFieldImagefilterSigmoid(im, 0.0, 1.0, 0.1, 0.5);
+	EXPECT_TRUE(sigmoid.isValid());
+	FieldImagefilterRescaleIntensity rescale = zinc.fm.createFieldImagefilterRescaleIntensity(im, 0.0, 2.0);
+	EXPECT_TRUE(rescale.isValid());
+	FieldImagefilterThreshold threshold = zinc.fm.createFieldImagefilterThreshold(im);
+	EXPECT_TRUE(threshold.isValid());
+	EXPECT_EQ(CMZN_OK, result = threshold.setLowerThreshold(0.4));
+	const int radii[3] = { 1, 2, 1 };
+	FieldImagefilterMean mean = zinc.fm.createFieldImagefilterMean(im, 3, radii);
+	EXPECT_TRUE(mean.isValid());
+	// the output of the sigmoid filter is copied, not modified
+	FieldImagefilterMean sigmoidMean = zinc.fm.createFieldImagefilterMean(sigmoid, 3, radii);
+	EXPECT_TRUE(sigmoidMean.isValid());
+	FieldImagefilterDiscreteGaussian gaussian = zinc.fm.createFieldImagefilterDiscreteGaussian(ramp);
+	EXPECT_TRUE(gaussian.isValid());
+	EXPECT_EQ(CMZN_OK, result = gaussian.setVariance(1.0));
+	EXPECT_EQ(CMZN_OK, result = gaussian.setMaxKernelWidth(4));
+
+	int minimum = 255, maximum = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		minimum = std::min(minimum, static_cast<int>(buffer[i]));
+		maximum = std::max(maximum, static_cast<int>(buffer[i]));
+	}
+	Fieldcache cache = zinc.fm.createFieldcache();
+	double value;
+	const double centre[3] = { 0.5, 0.5, 0.5 };
+	EXPECT_EQ(CMZN_OK, result = cache.setFieldReal(xi, 3, centre));
+	EXPECT_EQ(CMZN_OK, result = sigmoidMean.evaluateReal(cache, 1, &value));
+	for (int k = 0; k < sizes[2]; ++k)
+		for (int j = 0; j < sizes[1]; ++j)
+			for (int i = 0; i < sizes[0]; ++i)
+			{
+				const double location[3] = { (i + 0.5)/sizes[0], (j + 0.5)/sizes[1], (k + 0.5)/sizes[2] };
+				EXPECT_EQ(CMZN_OK, result = cache.setFieldReal(xi, 3, location));
+				const double pixel = buffer[(k*sizes[1] + j)*sizes[0] + i]/255.0;
+				EXPECT_EQ(CMZN_OK, result = sigmoid.evaluateReal(cache, 1, &value));
+				EXPECT_NEAR(1.0/(1.0 + exp(-(pixel - 0.5)/0.1)), value, 1.0E-12);
+				EXPECT_EQ(CMZN_OK, result = rescale.evaluateReal(cache, 1, &value));
+				EXPECT_NEAR(2.0*(pixel*255.0 - minimum)/(maximum - minimum), value, 1.0E-12);
+				EXPECT_EQ(CMZN_OK, result = threshold.evaluateReal(cache, 1, &value));
+				EXPECT_NEAR((pixel >= 0.4) ? pixel : 0.0, value, 1.0E-12);
+				// mean over box with indexes clamped to image
+				double sum = 0.0;
+				int boxCount = 0;
+				for (int c = k - radii[2]; c <= k + radii[2]; ++c)
+					for (int b = j - radii[1]; b <= j + radii[1]; ++b)
+						for (int a = i - radii[0]; a <= i + radii[0]; ++a)
+						{
+							sum += buffer[(std::min(std::max(c, 0), sizes[2] - 1)*sizes[1] +
+								std::min(std::max(b, 0), sizes[1] - 1))*sizes[0] +
+								std::min(std::max(a, 0), sizes[0] - 1)]/255.0;
+							++boxCount;
+						}
+				EXPECT_EQ(CMZN_OK, result = mean.evaluateReal(cache, 1, &value));
+				EXPECT_NEAR(sum/boxCount, value, 1.0E-12);
+				// symmetric normalised kernel keeps linear ramp away from boundary
+				EXPECT_EQ(CMZN_OK, result = gaussian.evaluateReal(cache, 1, &value));
+				if ((3 <= i) && (i < sizes[0] - 3))
+				{
+					EXPECT_NEAR(20.0*i/255.0, value, 1.0E-12);
+				}
+			}
+}
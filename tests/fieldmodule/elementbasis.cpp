@@ -12,6 +12,7 @@
 #include <opencmiss/zinc/field.hpp>
 #include <opencmiss/zinc/fieldcache.hpp>
 #include <opencmiss/zinc/fieldconstant.hpp>
+#include <opencmiss/zinc/fieldderivatives.hpp>
 #include <opencmiss/zinc/fieldfiniteelement.hpp>
 #include <opencmiss/zinc/fieldgroup.hpp>
 #include <opencmiss/zinc/fieldmeshoperators.hpp>
@@ -587,3 +588,70 @@ TEST(ZincElementbasis, quadratic_hermite_lagrange_3d)
 			EXPECT_EQ(RESULT_OK, zinc.root_region.write(sir));
 	}
 }
+
+// Test specialised tricubic Hermite and triquadratic Lagrange basis evaluation
+// gives first derivatives consistent with values, and second derivatives from
+// the general path consistent with first derivatives
+TEST(ZincElementbasis, specialised_kernel_derivatives)
+{
+	struct
+	{
+		TestResources::ResourcesName resourceName;
+		const char *fieldName;
+	} tests[2] =
+	{
+		{ TestResources::FIELDMODULE_EX2_TWO_CUBES_HERMITE_NOCROSS_RESOURCE, "coordinates" },
+		{ TestResources::FIELDMODULE_CUBE_TRIQUADRATIC_DELTA_RESOURCE, "delta" }
+	};
+	const double xi[3] = { 0.3, 0.65, 0.45 };
+	const double h = 1.0E-5;
+	const double TOL = 1.0E-5;
+	for (int t = 0; t < 2; ++t)
+	{
+		ZincTestSetupCpp zinc;
+		EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(TestResources::getLocation(tests[t].resourceName)));
+		Field field = zinc.fm.findFieldByName(tests[t].fieldName);
+		EXPECT_TRUE(field.isValid());
+		Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+		Element element = mesh3d.findElementByIdentifier(1);
+		EXPECT_TRUE(element.isValid());
+		Field derivatives[3];
+		for (int d = 0; d < 3; ++d)
+		{
+			derivatives[d] = zinc.fm.createFieldDerivative(field, d + 1);
+			EXPECT_TRUE(derivatives[d].isValid());
+		}
+		FieldDerivative d2_dxi1dxi3 = zinc.fm.createFieldDerivative(derivatives[0], 3);
+		EXPECT_TRUE(d2_dxi1dxi3.isValid());
+		Fieldcache fieldcache = zinc.fm.createFieldcache();
+		double dx[3][3], d2x[3];
+		EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi));
+		for (int d = 0; d < 3; ++d)
+			EXPECT_EQ(RESULT_OK, derivatives[d].evaluateReal(fieldcache, 3, dx[d]));
+		EXPECT_EQ(RESULT_OK, d2_dxi1dxi3.evaluateReal(fieldcache, 3, d2x));
+		for (int d = 0; d < 3; ++d)
+		{
+			double xi_plus[3] = { xi[0], xi[1], xi[2] };
+			double xi_minus[3] = { xi[0], xi[1], xi[2] };
+			xi_plus[d] += h;
+			xi_minus[d] -= h;
+			double x_plus[3], x_minus[3];
+			EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi_plus));
+			EXPECT_EQ(RESULT_OK, field.evaluateReal(fieldcache, 3, x_plus));
+			EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi_minus));
+			EXPECT_EQ(RESULT_OK, field.evaluateReal(fieldcache, 3, x_minus));
+			for (int c = 0; c < 3; ++c)
+				EXPECT_NEAR((x_plus[c] - x_minus[c])/(2.0*h), dx[d][c], TOL);
+			if (d == 2)
+			{
+				double dx1_plus[3], dx1_minus[3];
+				EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi_plus));
+				EXPECT_EQ(RESULT_OK, derivatives[0].evaluateReal(fieldcache, 3, dx1_plus));
+				EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi_minus));
+				EXPECT_EQ(RESULT_OK, derivatives[0].evaluateReal(fieldcache, 3, dx1_minus));
+				for (int c = 0; c < 3; ++c)
+					EXPECT_NEAR((dx1_plus[c] - dx1_minus[c])/(2.0*h), d2x[c], TOL);
+			}
+		}
+	}
+}
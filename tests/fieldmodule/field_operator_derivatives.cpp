@@ -13,19 +13,24 @@
 #include <opencmiss/zinc/fieldassignment.hpp>
 #include <opencmiss/zinc/fieldcache.hpp>
 #include <opencmiss/zinc/fieldcomposite.hpp>
+#include <opencmiss/zinc/fieldconditional.hpp>
 #include <opencmiss/zinc/fieldconstant.hpp>
+#include <opencmiss/zinc/fieldcoordinatetransformation.hpp>
 #include <opencmiss/zinc/fieldderivatives.hpp>
 #include <opencmiss/zinc/fieldfiniteelement.hpp>
 #include <opencmiss/zinc/fieldlogicaloperators.hpp>
 #include <opencmiss/zinc/fieldmatrixoperators.hpp>
+#include <opencmiss/zinc/fieldtrigonometry.hpp>
 #include <opencmiss/zinc/fieldvectoroperators.hpp>
 
 #include "zinctestsetupcpp.hpp"
 
 #include "test_resources.h"
 
+#include <cmath>
 #include <limits>
 #include <sstream>
+#include <vector>
 
 // Class comparing double arrays that can be set to generate expected values from current values as C++ code
 class CompareDoubleArrays
@@ -830,3 +835,133 @@ TEST(ZincFieldGradient, evaluateAtNodeFiniteDifference)
 		}
 	}
 }
+
+namespace {
+
+/** Operator fields with analytic derivatives built on the tricubic deformed
+ * cube, for comparing with finite differences */
+struct AnalyticDerivativeFields
+{
+	std::vector<Field> fields;
+	std::vector<const char *> names;
+
+	void add(const char *name, const Field& field)
+	{
+		EXPECT_TRUE(field.isValid()) << name;
+		this->fields.push_back(field);
+		this->names.push_back(name);
+	}
+
+	AnalyticDerivativeFields(Fieldmodule& fm)
+	{
+		Field coordinates = fm.findFieldByName("coordinates");
+		EXPECT_TRUE(coordinates.isValid());
+		Field deformed = fm.findFieldByName("deformed");
+		EXPECT_TRUE(deformed.isValid());
+		Field temperature = fm.findFieldByName("temperature");
+		EXPECT_TRUE(temperature.isValid());
+		const double half = 0.5;
+		Field halfField = fm.createFieldConstant(1, &half);
+		Field halfSinTemperature = fm.createFieldMultiply(halfField, fm.createFieldSin(temperature));
+		Field halfDeformed = fm.createFieldMultiply(deformed, fm.createFieldConcatenate(3,
+			std::vector<Field>(3, halfField).data()));
+
+		this->add("sin", fm.createFieldSin(deformed));
+		this->add("cos", fm.createFieldCos(deformed));
+		this->add("tan", fm.createFieldTan(halfDeformed));
+		this->add("asin", fm.createFieldAsin(halfSinTemperature));
+		this->add("acos", fm.createFieldAcos(halfSinTemperature));
+		this->add("atan", fm.createFieldAtan(deformed));
+
+		this->add("normalise", fm.createFieldNormalise(deformed));
+		this->add("cross_product", fm.createFieldCrossProduct(coordinates, deformed));
+		this->add("magnitude", fm.createFieldMagnitude(deformed));
+
+		// diagonally dominant matrix so well conditioned for all xi
+		const double diagonalValues[9] = { 3.0, 0.0, 0.0, 0.0, 4.0, 0.0, 0.0, 0.0, 5.0 };
+		Field diagonal = fm.createFieldConstant(9, diagonalValues);
+		Field rows[3] = { deformed, coordinates, fm.createFieldMultiply(coordinates, deformed) };
+		Field matrix = fm.createFieldAdd(fm.createFieldConcatenate(3, rows), diagonal);
+		this->add("determinant", fm.createFieldDeterminant(matrix));
+		this->add("matrix_invert", fm.createFieldMatrixInvert(matrix));
+		Field symmetricMatrix = fm.createFieldMatrixMultiply(3, fm.createFieldTranspose(3, matrix), matrix);
+		FieldEigenvalues eigenvalues = fm.createFieldEigenvalues(symmetricMatrix);
+		this->add("eigenvalues", eigenvalues);
+		this->add("eigenvectors", fm.createFieldEigenvectors(eigenvalues));
+
+		Field cylindrical = fm.createFieldCoordinateTransformation(deformed);
+		EXPECT_EQ(RESULT_OK, cylindrical.setCoordinateSystemType(Field::COORDINATE_SYSTEM_TYPE_CYLINDRICAL_POLAR));
+		this->add("coordinate_transformation", cylindrical);
+
+		const double one = 1.0;
+		this->add("if", fm.createFieldIf(fm.createFieldConstant(1, &one), fm.createFieldSin(deformed), fm.createFieldCos(deformed)));
+		Field concatenateFields[2] = { fm.createFieldSin(temperature), fm.createFieldNormalise(deformed) };
+		this->add("concatenate", fm.createFieldConcatenate(2, concatenateFields));
+	}
+};
+
+}
+
+// Check first and second derivatives w.r.t. xi of operators with analytic
+// derivatives against central finite differences of lower derivatives
+TEST(ZincFieldDerivative, analyticMatchesFiniteDifference)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_CUBE_TRICUBIC_DEFORMED_RESOURCE)));
+	AnalyticDerivativeFields testFields(zinc.fm);
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	EXPECT_TRUE(mesh3d.isValid());
+	Element element = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element.isValid());
+	Differentialoperator derivative1 = mesh3d.getChartDifferentialoperator(1, -1);
+	EXPECT_TRUE(derivative1.isValid());
+	Differentialoperator derivative2 = mesh3d.getChartDifferentialoperator(2, -1);
+	EXPECT_TRUE(derivative2.isValid());
+	Fieldcache cache = zinc.fm.createFieldcache();
+	EXPECT_TRUE(cache.isValid());
+
+	const double xiPoints[3][3] = { { 0.5, 0.5, 0.5 }, { 0.2, 0.1, 0.4 }, { 0.7, 0.35, 0.85 } };
+	const double h = 1.0E-6;
+	const size_t fieldsCount = testFields.fields.size();
+	for (size_t f = 0; f < fieldsCount; ++f)
+	{
+		Field& field = testFields.fields[f];
+		const int componentsCount = field.getNumberOfComponents();
+		std::vector<double> values(componentsCount), valuesPlus(componentsCount), valuesMinus(componentsCount);
+		std::vector<double> derivatives1(componentsCount*3), derivatives2(componentsCount*9);
+		std::vector<double> derivatives1Plus(componentsCount*3), derivatives1Minus(componentsCount*3);
+		for (int p = 0; p < 3; ++p)
+		{
+			EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xiPoints[p]));
+			EXPECT_EQ(RESULT_OK, field.evaluateDerivative(derivative1, cache, componentsCount*3, derivatives1.data())) << testFields.names[f];
+			EXPECT_EQ(RESULT_OK, field.evaluateDerivative(derivative2, cache, componentsCount*9, derivatives2.data())) << testFields.names[f];
+			for (int d = 0; d < 3; ++d)
+			{
+				double xi[3] = { xiPoints[p][0], xiPoints[p][1], xiPoints[p][2] };
+				xi[d] = xiPoints[p][d] + h;
+				EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xi));
+				EXPECT_EQ(RESULT_OK, field.evaluateReal(cache, componentsCount, valuesPlus.data()));
+				EXPECT_EQ(RESULT_OK, field.evaluateDerivative(derivative1, cache, componentsCount*3, derivatives1Plus.data()));
+				xi[d] = xiPoints[p][d] - h;
+				EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xi));
+				EXPECT_EQ(RESULT_OK, field.evaluateReal(cache, componentsCount, valuesMinus.data()));
+				EXPECT_EQ(RESULT_OK, field.evaluateDerivative(derivative1, cache, componentsCount*3, derivatives1Minus.data()));
+				for (int c = 0; c < componentsCount; ++c)
+				{
+					const double finiteDifference1 = (valuesPlus[c] - valuesMinus[c])/(2.0*h);
+					EXPECT_NEAR(finiteDifference1, derivatives1[c*3 + d], 1.0E-6*(1.0 + fabs(finiteDifference1)))
+						<< testFields.names[f] << " component " << c + 1 << " d/dxi" << d + 1;
+					for (int e = 0; e < 3; ++e)
+					{
+						const double finiteDifference2 = (derivatives1Plus[c*3 + e] - derivatives1Minus[c*3 + e])/(2.0*h);
+						EXPECT_NEAR(finiteDifference2, derivatives2[c*9 + d*3 + e], 1.0E-4*(1.0 + fabs(finiteDifference2)))
+							<< testFields.names[f] << " component " << c + 1 << " d2/dxi" << d + 1 << "dxi" << e + 1;
+					}
+				}
+			}
+		}
+	}
+}
@@ -8,13 +8,24 @@
 
 #include <gtest/gtest.h>
 
+#include <opencmiss/zinc/differentialoperator.hpp>
+#include <opencmiss/zinc/element.hpp>
 #include <opencmiss/zinc/field.hpp>
 #include <opencmiss/zinc/fieldarithmeticoperators.hpp>
 #include <opencmiss/zinc/fieldcache.hpp>
+#include <opencmiss/zinc/fieldcomposite.hpp>
 #include <opencmiss/zinc/fieldconstant.hpp>
+#include <opencmiss/zinc/fieldtrigonometry.hpp>
+#include <opencmiss/zinc/fieldvectoroperators.hpp>
+#include <opencmiss/zinc/mesh.hpp>
 
 #include "zinctestsetupcpp.hpp"
 
+#include "test_resources.h"
+
+#include <cmath>
+#include <vector>
+
 TEST(ZincFieldAdd, scalar_broadcast)
 {
 	ZincTestSetupCpp zinc;
@@ -39,3 +50,146 @@ TEST(ZincFieldAdd, scalar_broadcast)
 	for (int c = 0; c < 3; ++c)
 		EXPECT_DOUBLE_EQ(values_in[c] + scalar_in, values_out[c]);
 }
+
+// Test compiled evaluation plan gives same results as normal evaluation for
+// expression with repeated structurally identical subexpressions
+TEST(ZincFieldcache, compileField)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_CUBE_TRICUBIC_DEFORMED_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("deformed");
+	EXPECT_TRUE(coordinates.isValid());
+	const double centre[3] = { 0.5, 0.25, 0.125 };
+	// separately created but identical subexpressions
+	Field distance1 = zinc.fm.createFieldMagnitude(coordinates - zinc.fm.createFieldConstant(3, centre));
+	Field distance2 = zinc.fm.createFieldMagnitude(coordinates - zinc.fm.createFieldConstant(3, centre));
+	Field offset = coordinates - zinc.fm.createFieldConstant(3, centre);
+	const double one = 1.0;
+	Field expression = distance1*distance2
+		+ zinc.fm.createFieldSqrt(distance1 + zinc.fm.createFieldDotProduct(offset, offset))/(distance2 + zinc.fm.createFieldConstant(1, &one))
+		+ zinc.fm.createFieldSin(distance1);
+	EXPECT_TRUE(expression.isValid());
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	Fieldcache compiledCache = zinc.fm.createFieldcache();
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, compiledCache.compileField(Field()));
+	EXPECT_EQ(RESULT_OK, compiledCache.compileField(expression));
+	EXPECT_EQ(RESULT_OK, compiledCache.compileField(expression));
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	Element element = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element.isValid());
+	const double xiPoints[4][3] = { { 0.5, 0.5, 0.5 }, { 0.2, 0.1, 0.4 }, { 0.7, 0.35, 0.85 }, { 0.0, 1.0, 0.0 } };
+	double value, compiledValue, distance;
+	for (int p = 0; p < 4; ++p)
+	{
+		EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xiPoints[p]));
+		EXPECT_EQ(RESULT_OK, compiledCache.setMeshLocation(element, 3, xiPoints[p]));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(cache, 1, &value));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(compiledCache, 1, &compiledValue));
+		EXPECT_DOUBLE_EQ(value, compiledValue);
+		// merged subexpression values are also available
+		EXPECT_EQ(RESULT_OK, distance2.evaluateReal(compiledCache, 1, &distance));
+		EXPECT_EQ(RESULT_OK, distance1.evaluateReal(cache, 1, &value));
+		EXPECT_DOUBLE_EQ(value, distance);
+	}
+
+	// plan is not used when field values are prescribed
+	const double position[3] = { 1.5, 0.5, -0.5 };
+	EXPECT_EQ(RESULT_OK, cache.setFieldReal(coordinates, 3, position));
+	EXPECT_EQ(RESULT_OK, compiledCache.setFieldReal(coordinates, 3, position));
+	EXPECT_EQ(RESULT_OK, expression.evaluateReal(cache, 1, &value));
+	EXPECT_EQ(RESULT_OK, expression.evaluateReal(compiledCache, 1, &compiledValue));
+	EXPECT_DOUBLE_EQ(value, compiledValue);
+}
+
+// Test compiled evaluation of a sum of products of distances from 3 centres,
+// sharing 3 magnitude subexpressions, matches normal evaluation along a line
+TEST(ZincFieldcache, compileFieldSharedSubexpressions)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_CUBE_TRICUBIC_DEFORMED_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("deformed");
+	EXPECT_TRUE(coordinates.isValid());
+	const double centres[3][3] = { { 0.5, 0.25, 0.125 }, { 0.0, 1.0, 0.5 }, { 1.0, 0.0, 1.0 } };
+	Field expression;
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+		{
+			Field term = zinc.fm.createFieldMagnitude(coordinates - zinc.fm.createFieldConstant(3, centres[i]))*
+				zinc.fm.createFieldMagnitude(coordinates - zinc.fm.createFieldConstant(3, centres[j]));
+			expression = (expression.isValid()) ? expression + term : term;
+		}
+	EXPECT_TRUE(expression.isValid());
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	Element element = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element.isValid());
+	Fieldcache cache = zinc.fm.createFieldcache();
+	Fieldcache compiledCache = zinc.fm.createFieldcache();
+	EXPECT_EQ(RESULT_OK, compiledCache.compileField(expression));
+	double xi[3] = { 0.0, 0.5, 0.5 };
+	double value, compiledValue;
+	for (int n = 0; n <= 10; ++n)
+	{
+		xi[0] = 0.1*n;
+		EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xi));
+		EXPECT_EQ(RESULT_OK, compiledCache.setMeshLocation(element, 3, xi));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(cache, 1, &value));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(compiledCache, 1, &compiledValue));
+		EXPECT_DOUBLE_EQ(value, compiledValue);
+	}
+}
+
+// Test values and first derivatives of compiled field with arithmetic,
+// trigonometric and component operators match normal evaluation, whether
+// evaluated by the plan or a compiled kernel if enabled
+TEST(ZincFieldcache, compileFieldDerivatives)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_CUBE_TRICUBIC_DEFORMED_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("deformed");
+	EXPECT_TRUE(coordinates.isValid());
+	const double centre[3] = { -0.5, 0.25, 0.125 };
+	Field offset = coordinates - zinc.fm.createFieldConstant(3, centre);
+	Field x = zinc.fm.createFieldComponent(offset, 1);
+	Field y = zinc.fm.createFieldComponent(offset, 2);
+	Field z = zinc.fm.createFieldComponent(offset, 3);
+	const double two = 2.0;
+	Field expression = zinc.fm.createFieldConcatenate(3, std::vector<Field>({
+		zinc.fm.createFieldAtan2(y, x)*zinc.fm.createFieldMagnitude(offset),
+		zinc.fm.createFieldPower(zinc.fm.createFieldExp(z*x), zinc.fm.createFieldConstant(1, &two)) - zinc.fm.createFieldLog(zinc.fm.createFieldAbs(x) + y*y),
+		zinc.fm.createFieldCos(x)/zinc.fm.createFieldSqrt(zinc.fm.createFieldDotProduct(offset, offset)) }).data());
+	EXPECT_TRUE(expression.isValid());
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	Fieldcache compiledCache = zinc.fm.createFieldcache();
+	EXPECT_EQ(RESULT_OK, compiledCache.compileField(expression));
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	Element element = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element.isValid());
+	Differentialoperator derivative1 = mesh3d.getChartDifferentialoperator(1, -1);
+	EXPECT_TRUE(derivative1.isValid());
+	const double xiPoints[3][3] = { { 0.5, 0.5, 0.5 }, { 0.2, 0.1, 0.4 }, { 0.7, 0.35, 0.85 } };
+	double values[3], compiledValues[3], derivatives[9], compiledDerivatives[9];
+	for (int p = 0; p < 3; ++p)
+	{
+		EXPECT_EQ(RESULT_OK, cache.setMeshLocation(element, 3, xiPoints[p]));
+		EXPECT_EQ(RESULT_OK, compiledCache.setMeshLocation(element, 3, xiPoints[p]));
+		EXPECT_EQ(RESULT_OK, expression.evaluateDerivative(derivative1, compiledCache, 9, compiledDerivatives));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(compiledCache, 3, compiledValues));
+		EXPECT_EQ(RESULT_OK, expression.evaluateReal(cache, 3, values));
+		EXPECT_EQ(RESULT_OK, expression.evaluateDerivative(derivative1, cache, 9, derivatives));
+		for (int c = 0; c < 3; ++c)
+			EXPECT_NEAR(values[c], compiledValues[c], 1.0E-12*(1.0 + fabs(values[c])));
+		for (int d = 0; d < 9; ++d)
+			EXPECT_NEAR(derivatives[d], compiledDerivatives[d], 1.0E-10*(1.0 + fabs(derivatives[d])));
+	}
+}
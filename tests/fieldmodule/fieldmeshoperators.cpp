@@ -328,6 +328,104 @@ TEST(ZincFieldMeshIntegral, midpoint_quadrature_large_numbers)
 	}
 }
 
+// Mesh integrals with coordinates directly a finite element field are evaluated
+// on the Gauss point grid by sum factorisation; compare with a coordinate field
+// which is not, and so is evaluated point by point.
+TEST(ZincFieldMeshIntegral, gridEvaluation)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	EXPECT_EQ(OK, result = zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_EX2_TWO_CUBES_HERMITE_NOCROSS_RESOURCE)));
+	EXPECT_EQ(OK, result = zinc.fm.defineAllFaces());
+
+	const double one = 1.0;
+	Field integrandField = zinc.fm.createFieldConstant(1, &one);
+	EXPECT_TRUE(integrandField.isValid());
+	Field coordinateField = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinateField.isValid());
+	const double unitScale[3] = { 1.0, 1.0, 1.0 };
+	Field unitScaleField = zinc.fm.createFieldConstant(3, unitScale);
+	EXPECT_TRUE(unitScaleField.isValid());
+	Field pointCoordinateField = zinc.fm.createFieldMultiply(coordinateField, unitScaleField);
+	EXPECT_TRUE(pointCoordinateField.isValid());
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	EXPECT_TRUE(cache.isValid());
+	const double tolerance = 1.0E-12;
+	for (int dimension = 3; dimension > 0; --dimension)
+	{
+		Mesh mesh = zinc.fm.findMeshByDimension(dimension);
+		EXPECT_TRUE(mesh.isValid());
+		EXPECT_LT(0, mesh.getSize());
+		FieldMeshIntegral gridIntegralField = zinc.fm.createFieldMeshIntegral(integrandField, coordinateField, mesh);
+		EXPECT_TRUE(gridIntegralField.isValid());
+		FieldMeshIntegral pointIntegralField = zinc.fm.createFieldMeshIntegral(integrandField, pointCoordinateField, mesh);
+		EXPECT_TRUE(pointIntegralField.isValid());
+		const int numbersOfPoints[3][3] = { { 1, 1, 1 }, { 2, 3, 4 }, { 4, 4, 4 } };
+		for (int n = 0; n < 3; ++n)
+		{
+			EXPECT_EQ(OK, result = gridIntegralField.setNumbersOfPoints(3, numbersOfPoints[n]));
+			EXPECT_EQ(OK, result = pointIntegralField.setNumbersOfPoints(3, numbersOfPoints[n]));
+			double gridValue = 0.0, pointValue = 0.0;
+			EXPECT_EQ(OK, result = gridIntegralField.evaluateReal(cache, 1, &gridValue));
+			EXPECT_EQ(OK, result = pointIntegralField.evaluateReal(cache, 1, &pointValue));
+			EXPECT_LT(0.0, pointValue);
+			EXPECT_NEAR(pointValue, gridValue, tolerance*pointValue);
+		}
+	}
+}
+
+// test integrals over simplex and mixed shape elements using shared basis
+// tables equal those evaluated point by point
+TEST(ZincFieldMeshIntegral, basisTableEvaluation)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	EXPECT_EQ(OK, result = zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_ALLSHAPES_RESOURCE)));
+	EXPECT_EQ(OK, result = zinc.fm.defineAllFaces());
+
+	const double one = 1.0;
+	Field integrandField = zinc.fm.createFieldConstant(1, &one);
+	EXPECT_TRUE(integrandField.isValid());
+	Field coordinateField = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinateField.isValid());
+	const double unitScale[3] = { 1.0, 1.0, 1.0 };
+	Field unitScaleField = zinc.fm.createFieldConstant(3, unitScale);
+	EXPECT_TRUE(unitScaleField.isValid());
+	Field pointCoordinateField = zinc.fm.createFieldMultiply(coordinateField, unitScaleField);
+	EXPECT_TRUE(pointCoordinateField.isValid());
+
+	Fieldcache cache = zinc.fm.createFieldcache();
+	EXPECT_TRUE(cache.isValid());
+	const double tolerance = 1.0E-12;
+	for (int dimension = 3; dimension > 1; --dimension)
+	{
+		Mesh mesh = zinc.fm.findMeshByDimension(dimension);
+		EXPECT_TRUE(mesh.isValid());
+		EXPECT_LT(0, mesh.getSize());
+		FieldMeshIntegral tableIntegralField = zinc.fm.createFieldMeshIntegral(integrandField, coordinateField, mesh);
+		EXPECT_TRUE(tableIntegralField.isValid());
+		FieldMeshIntegral pointIntegralField = zinc.fm.createFieldMeshIntegral(integrandField, pointCoordinateField, mesh);
+		EXPECT_TRUE(pointIntegralField.isValid());
+		// repeat first number of points to reuse cached tables
+		const int numbersOfPoints[4] = { 1, 3, 4, 1 };
+		for (int n = 0; n < 4; ++n)
+		{
+			EXPECT_EQ(OK, result = tableIntegralField.setNumbersOfPoints(1, &numbersOfPoints[n]));
+			EXPECT_EQ(OK, result = pointIntegralField.setNumbersOfPoints(1, &numbersOfPoints[n]));
+			double tableValue = 0.0, pointValue = 0.0;
+			EXPECT_EQ(OK, result = tableIntegralField.evaluateReal(cache, 1, &tableValue));
+			EXPECT_EQ(OK, result = pointIntegralField.evaluateReal(cache, 1, &pointValue));
+			EXPECT_LT(0.0, pointValue);
+			EXPECT_NEAR(pointValue, tableValue, tolerance*pointValue);
+		}
+	}
+}
+
 TEST(ZincFieldMeshIntegralSquares, quadrature)
 {
 	ZincTestSetupCpp zinc;
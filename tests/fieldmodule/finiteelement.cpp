@@ -1592,6 +1592,102 @@ TEST(ZincFieldFindMeshLocation, searchMesh)
 	EXPECT_NEAR(0.0, xi[2], TOL);
 }
 
+// test exact search walking from the previously found element to its
+// neighbours in both directions, including across face 0
+TEST(ZincFieldFindMeshLocation, walkNeighbours)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	EXPECT_EQ(RESULT_OK, result = zinc.root_region.readFile(TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	EXPECT_EQ(2, mesh3d.getSize());
+	Element element1 = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element1.isValid());
+	Element element2 = mesh3d.findElementByIdentifier(2);
+	EXPECT_TRUE(element2.isValid());
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	const double zero[3] = { 0.0, 0.0, 0.0 };
+	FieldConstant constCoordinates = zinc.fm.createFieldConstant(3, zero);
+	EXPECT_TRUE(constCoordinates.isValid());
+	FieldFindMeshLocation findMeshLocation = zinc.fm.createFieldFindMeshLocation(constCoordinates, coordinates, mesh3d);
+	EXPECT_TRUE(findMeshLocation.isValid());
+	EXPECT_EQ(FieldFindMeshLocation::SEARCH_MODE_EXACT, findMeshLocation.getSearchMode());
+
+	Fieldcache fieldcache = zinc.fm.createFieldcache();
+	const double xValues[5][3] = {
+		{  2.5, 5.0, 7.5 },
+		{ 17.5, 2.5, 5.0 },
+		{  7.5, 7.5, 2.5 },
+		{ 12.5, 1.0, 9.0 },
+		{  1.0, 9.0, 1.0 } };
+	const double TOL = 1.0E-10;
+	for (int i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(RESULT_OK, result = constCoordinates.assignReal(fieldcache, 3, xValues[i]));
+		double xi[3];
+		Element element = findMeshLocation.evaluateMeshLocation(fieldcache, 3, xi);
+		const bool inElement1 = xValues[i][0] < 10.0;
+		EXPECT_EQ(inElement1 ? element1 : element2, element);
+		EXPECT_NEAR((inElement1 ? xValues[i][0] : xValues[i][0] - 10.0)*0.1, xi[0], TOL);
+		EXPECT_NEAR(xValues[i][1]*0.1, xi[1], TOL);
+		EXPECT_NEAR(xValues[i][2]*0.1, xi[2], TOL);
+	}
+
+	// outside the mesh is not found
+	const double outside[3] = { 25.0, 5.0, 5.0 };
+	EXPECT_EQ(RESULT_OK, result = constCoordinates.assignReal(fieldcache, 3, outside));
+	double xi[3];
+	Element element = findMeshLocation.evaluateMeshLocation(fieldcache, 3, xi);
+	EXPECT_FALSE(element.isValid());
+}
+
+// test nearest search on curved Hermite elements, which starts from the
+// nearest of several sample points evaluated together in each element
+TEST(ZincFieldFindMeshLocation, nearestHermite)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	EXPECT_EQ(OK, result = zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_EX2_TWO_CUBES_HERMITE_NOCROSS_RESOURCE)));
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	EXPECT_EQ(2, mesh3d.getSize());
+	Element element2 = mesh3d.findElementByIdentifier(2);
+	EXPECT_TRUE(element2.isValid());
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	Fieldcache fieldcache = zinc.fm.createFieldcache();
+	const double sampleXi[4][3] = {
+		{ 0.1, 0.2, 0.3 },
+		{ 0.9, 0.05, 0.6 },
+		{ 0.45, 0.95, 0.15 },
+		{ 0.7, 0.4, 0.85 } };
+	const double TOL = 1.0E-8;
+	for (int s = 0; s < 4; ++s)
+	{
+		double xValues[3];
+		EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element2, 3, sampleXi[s]));
+		EXPECT_EQ(RESULT_OK, coordinates.evaluateReal(fieldcache, 3, xValues));
+		FieldConstant constCoordinates = zinc.fm.createFieldConstant(3, xValues);
+		EXPECT_TRUE(constCoordinates.isValid());
+		FieldFindMeshLocation findMeshLocation = zinc.fm.createFieldFindMeshLocation(constCoordinates, coordinates, mesh3d);
+		EXPECT_TRUE(findMeshLocation.isValid());
+		EXPECT_EQ(RESULT_OK, findMeshLocation.setSearchMode(FieldFindMeshLocation::SEARCH_MODE_NEAREST));
+		double xi[3];
+		Element element = findMeshLocation.evaluateMeshLocation(fieldcache, 3, xi);
+		EXPECT_EQ(element2, element);
+		EXPECT_EQ(RESULT_OK, fieldcache.setMeshLocation(element, 3, xi));
+		double foundXValues[3];
+		EXPECT_EQ(RESULT_OK, coordinates.evaluateReal(fieldcache, 3, foundXValues));
+		for (int c = 0; c < 3; ++c)
+			EXPECT_NEAR(xValues[c], foundXValues[c], TOL);
+	}
+}
+
 TEST(ZincFieldStoredMeshLocation, valid_arguments)
 {
 	ZincTestSetupCpp zinc;
@@ -2421,3 +2517,76 @@ TEST(ZincFieldFiniteElement, linear_node_element_grid_mixed)
 		}
 	}
 }
+
+// Test element field evaluations are reused from cache for recently used
+// elements, and only latest element is kept with zero budget
+TEST(ZincFieldFiniteElement, elementEvaluationCache)
+{
+	ZincTestSetupCpp zinc;
+	int result;
+
+	EXPECT_EQ(OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	Element element1 = mesh3d.findElementByIdentifier(1);
+	EXPECT_TRUE(element1.isValid());
+	Element element2 = mesh3d.findElementByIdentifier(2);
+	EXPECT_TRUE(element2.isValid());
+
+	EXPECT_EQ(8*1024*1024, zinc.fm.getElementEvaluationCacheBudget());
+	int hits, misses;
+	EXPECT_EQ(ERROR_ARGUMENT, zinc.fm.getElementEvaluationCacheStatistics(nullptr, &misses));
+	EXPECT_EQ(ERROR_ARGUMENT, zinc.fm.getElementEvaluationCacheStatistics(&hits, nullptr));
+	EXPECT_EQ(ERROR_ARGUMENT, zinc.fm.setElementEvaluationCacheBudget(-1));
+	EXPECT_EQ(OK, result = zinc.fm.resetElementEvaluationCacheStatistics());
+	EXPECT_EQ(OK, result = zinc.fm.getElementEvaluationCacheStatistics(&hits, &misses));
+	EXPECT_EQ(0, hits);
+	EXPECT_EQ(0, misses);
+
+	const double xiA[3] = { 0.25, 0.5, 0.75 };
+	const double xiB[3] = { 0.5, 0.5, 0.5 };
+	const double xiC[3] = { 0.75, 0.5, 0.25 };
+	double x[3];
+	{
+		Fieldcache fieldcache = zinc.fm.createFieldcache();
+		EXPECT_EQ(OK, fieldcache.setMeshLocation(element1, 3, xiA));
+		EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+		EXPECT_GT(10.0, x[0]);
+		EXPECT_EQ(OK, fieldcache.setMeshLocation(element2, 3, xiA));
+		EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+		EXPECT_LT(10.0, x[0]);
+		EXPECT_EQ(OK, fieldcache.setMeshLocation(element1, 3, xiB));
+		EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+		EXPECT_GT(10.0, x[0]);
+		EXPECT_EQ(OK, fieldcache.setMeshLocation(element2, 3, xiB));
+		EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+		EXPECT_LT(10.0, x[0]);
+		EXPECT_EQ(OK, fieldcache.setMeshLocation(element2, 3, xiC));
+		EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+		EXPECT_LT(10.0, x[0]);
+	}
+	EXPECT_EQ(OK, result = zinc.fm.getElementEvaluationCacheStatistics(&hits, &misses));
+	EXPECT_EQ(3, hits);
+	EXPECT_EQ(2, misses);
+
+	EXPECT_EQ(OK, result = zinc.fm.setElementEvaluationCacheBudget(0));
+	EXPECT_EQ(0, zinc.fm.getElementEvaluationCacheBudget());
+	EXPECT_EQ(OK, result = zinc.fm.resetElementEvaluationCacheStatistics());
+	{
+		Fieldcache fieldcache = zinc.fm.createFieldcache();
+		for (int i = 0; i < 2; ++i)
+		{
+			EXPECT_EQ(OK, fieldcache.setMeshLocation(element1, 3, xiA));
+			EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+			EXPECT_GT(10.0, x[0]);
+			EXPECT_EQ(OK, fieldcache.setMeshLocation(element2, 3, xiB));
+			EXPECT_EQ(OK, coordinates.evaluateReal(fieldcache, 3, x));
+			EXPECT_LT(10.0, x[0]);
+		}
+	}
+	EXPECT_EQ(OK, result = zinc.fm.getElementEvaluationCacheStatistics(&hits, &misses));
+	EXPECT_EQ(0, hits);
+	EXPECT_EQ(4, misses);
+}
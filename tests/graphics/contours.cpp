@@ -8,6 +8,10 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+#include <string>
+#include <vector>
+
 #include <opencmiss/zinc/status.h>
 #include <opencmiss/zinc/result.hpp>
 #include <opencmiss/zinc/core.h>
@@ -17,10 +21,18 @@
 #include <opencmiss/zinc/field.h>
 #include <opencmiss/zinc/fieldconstant.h>
 #include <opencmiss/zinc/graphics.h>
+#include <opencmiss/zinc/fieldarithmeticoperators.hpp>
 #include <opencmiss/zinc/fieldconstant.hpp>
+#include <opencmiss/zinc/fieldimage.hpp>
+#include <opencmiss/zinc/fieldvectoroperators.hpp>
+#include <opencmiss/zinc/graphics.hpp>
+#include <opencmiss/zinc/streamscene.hpp>
+#include <opencmiss/zinc/tessellation.hpp>
 
 #include "zinctestsetup.hpp"
 #include "zinctestsetupcpp.hpp"
+#include "test_resources.h"
+#include "utilities/threejsio.hpp"
 
 TEST(cmzn_graphics_contours, create_cast)
 {
@@ -223,3 +235,87 @@ TEST(cmzn_graphics_contours, description_io)
 	cmzn_deallocate(return_string);
 }
 
+
+// test iso-surface of image field extracted on grid with parallel marching
+// cubes has the same vertices and triangles as from the same values in a
+// non-image field extracted cell by cell
+TEST(ZincGraphicsContours, imageIsosurface)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_CUBE_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	// image has a pixel centred on each point of the grid of divisions^3 cells
+	// with integer value of square distance from the centre in grid units
+	const int divisions = 16;
+	const int size = divisions + 1;
+	const double centre = 0.5*divisions;
+	FieldImage image = zinc.fm.createFieldImage();
+	EXPECT_TRUE(image.isValid());
+	const double halfPixel = 0.5/divisions;
+	const double offsetValues[3] = { halfPixel, halfPixel, halfPixel };
+	EXPECT_EQ(RESULT_OK, image.setDomainField(coordinates + zinc.fm.createFieldConstant(3, offsetValues)));
+	EXPECT_EQ(RESULT_OK, image.setPixelFormat(FieldImage::PIXEL_FORMAT_LUMINANCE));
+	const int sizes[3] = { size, size, size };
+	EXPECT_EQ(RESULT_OK, image.setSizeInPixels(3, sizes));
+	const double textureCoordinateSize = static_cast<double>(size)/divisions;
+	const double textureCoordinateSizes[3] = { textureCoordinateSize, textureCoordinateSize, textureCoordinateSize };
+	EXPECT_EQ(RESULT_OK, image.setTextureCoordinateSizes(3, textureCoordinateSizes));
+	std::vector<unsigned char> buffer(size*size*size);
+	for (int k = 0; k < size; ++k)
+		for (int j = 0; j < size; ++j)
+			for (int i = 0; i < size; ++i)
+				buffer[(k*size + j)*size + i] = static_cast<unsigned char>(
+					(i - centre)*(i - centre) + (j - centre)*(j - centre) + (k - centre)*(k - centre));
+	EXPECT_EQ(RESULT_OK, image.setBuffer(buffer.data(), static_cast<unsigned int>(buffer.size())));
+
+	// same values from coordinates, normalised as for the image
+	const double scaleValue = divisions;
+	const double centreValues[3] = { centre, centre, centre };
+	const double normaliseValue = 1.0/255.0;
+	Field offset = coordinates*zinc.fm.createFieldConstant(1, &scaleValue) - zinc.fm.createFieldConstant(3, centreValues);
+	Field squareDistance = zinc.fm.createFieldDotProduct(offset, offset)*zinc.fm.createFieldConstant(1, &normaliseValue);
+	EXPECT_TRUE(squareDistance.isValid());
+
+	Tessellation tessellation = zinc.context.getTessellationmodule().createTessellation();
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(1, &divisions));
+
+	GraphicsContours contours = zinc.scene.createGraphicsContours();
+	EXPECT_TRUE(contours.isValid());
+	EXPECT_EQ(RESULT_OK, contours.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, contours.setTessellation(tessellation));
+	// between integer values so no grid point is on the surface
+	const double isovalue = 40.5/255.0;
+	EXPECT_EQ(RESULT_OK, contours.setListIsovalues(1, &isovalue));
+
+	int vertexCounts[2], triangleCounts[2];
+	Field isoscalarFields[2] = { image, squareDistance };
+	for (int f = 0; f < 2; ++f)
+	{
+		EXPECT_EQ(RESULT_OK, contours.setIsoscalarField(isoscalarFields[f]));
+		std::vector<double> vertices;
+		getSceneThreejsVertices(zinc.scene, vertices);
+		ASSERT_EQ(0u, vertices.size() % 9);
+		triangleCounts[f] = static_cast<int>(vertices.size()/9);
+		std::set< std::vector<double> > uniqueVertices;
+		for (size_t v = 0; v < vertices.size(); v += 3)
+			uniqueVertices.insert(std::vector<double>(vertices.begin() + v, vertices.begin() + v + 3));
+		vertexCounts[f] = static_cast<int>(uniqueVertices.size());
+		// closed surface around the centre: Euler characteristic of a sphere
+		EXPECT_LT(100, triangleCounts[f]);
+		EXPECT_EQ(2, vertexCounts[f] - triangleCounts[f]/2);
+	}
+	EXPECT_EQ(vertexCounts[1], vertexCounts[0]);
+	EXPECT_EQ(triangleCounts[1], triangleCounts[0]);
+
+	// no surface outside range of image values
+	EXPECT_EQ(RESULT_OK, contours.setIsoscalarField(image));
+	const double highIsovalue = 1.5;
+	EXPECT_EQ(RESULT_OK, contours.setListIsovalues(1, &highIsovalue));
+	Scenefilter noFilter;
+	double minimums[3], maximums[3];
+	EXPECT_EQ(RESULT_ERROR_NOT_FOUND, zinc.scene.getCoordinatesRange(noFilter, minimums, maximums));
+}
@@ -8,6 +8,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
 #include <opencmiss/zinc/core.h>
 #include <opencmiss/zinc/context.h>
 #include <opencmiss/zinc/region.h>
@@ -20,13 +26,17 @@
 
 #include "zinctestsetup.hpp"
 #include "zinctestsetupcpp.hpp"
+#include "opencmiss/zinc/fieldarithmeticoperators.hpp"
 #include "opencmiss/zinc/fieldconstant.hpp"
 #include "opencmiss/zinc/fieldfiniteelement.hpp"
 #include "opencmiss/zinc/font.hpp"
 #include "opencmiss/zinc/graphics.hpp"
 #include "opencmiss/zinc/result.hpp"
+#include "opencmiss/zinc/streamregion.hpp"
+#include "opencmiss/zinc/streamscene.hpp"
 
 #include "test_resources.h"
+#include "utilities/threejsio.hpp"
 
 TEST(cmzn_graphics, create_type)
 {
@@ -1187,6 +1197,579 @@ TEST(ZincGraphics, RenderPolygonMode)
 	ASSERT_EQ(Graphics::RENDER_POLYGON_MODE_WIREFRAME, renderPolygonMode = gr.getRenderPolygonMode());
 }
 
+TEST(cmzn_graphics_api, surfaces_shared_vertices)
+{
+	ZincTestSetup zinc;
+
+	cmzn_graphics_id gr = cmzn_scene_create_graphics(zinc.scene, CMZN_GRAPHICS_TYPE_SURFACES);
+	EXPECT_NE(static_cast<cmzn_graphics *>(0), gr);
+	cmzn_graphics_surfaces_id surfaces = cmzn_graphics_cast_surfaces(gr);
+	EXPECT_NE(static_cast<cmzn_graphics_surfaces *>(0), surfaces);
+
+	EXPECT_FALSE(cmzn_graphics_surfaces_is_shared_vertices(surfaces));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_surfaces_set_shared_vertices(static_cast<cmzn_graphics_surfaces_id>(0), true));
+	EXPECT_FALSE(cmzn_graphics_surfaces_is_shared_vertices(static_cast<cmzn_graphics_surfaces_id>(0)));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_surfaces_set_shared_vertices(surfaces, true));
+	EXPECT_TRUE(cmzn_graphics_surfaces_is_shared_vertices(surfaces));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_surfaces_set_shared_vertices(surfaces, false));
+	EXPECT_FALSE(cmzn_graphics_surfaces_is_shared_vertices(surfaces));
+
+	cmzn_graphics_surfaces_destroy(&surfaces);
+	cmzn_graphics_destroy(&gr);
+}
+
+namespace {
+
+/**
+ * Create 2 square linear Lagrange elements in 3-D, with faces, folded along
+ * their common line at x = 1 so their normals differ by 53 degrees there.
+ */
+void createFoldedSquares(ZincTestSetupCpp& zinc, Field& coordinates)
+{
+	coordinates = zinc.fm.createFieldFiniteElement(3);
+	EXPECT_TRUE(coordinates.isValid());
+	EXPECT_EQ(RESULT_OK, coordinates.setName("coordinates"));
+	EXPECT_EQ(RESULT_OK, coordinates.setTypeCoordinate(true));
+	EXPECT_EQ(RESULT_OK, coordinates.setManaged(true));
+
+	Nodeset nodes = zinc.fm.findNodesetByFieldDomainType(Field::DOMAIN_TYPE_NODES);
+	Nodetemplate nodetemplate = nodes.createNodetemplate();
+	EXPECT_EQ(RESULT_OK, nodetemplate.defineField(coordinates));
+	Fieldcache cache = zinc.fm.createFieldcache();
+	const double nodeCoordinates[6][3] =
+	{
+		{ 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.5 }, { 2.0, 0.0, 0.0 },
+		{ 0.0, 1.0, 0.0 }, { 1.0, 1.0, 0.5 }, { 2.0, 1.0, 0.0 }
+	};
+	for (int n = 0; n < 6; ++n)
+	{
+		Node node = nodes.createNode(n + 1, nodetemplate);
+		EXPECT_TRUE(node.isValid());
+		EXPECT_EQ(RESULT_OK, cache.setNode(node));
+		EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, nodeCoordinates[n]));
+	}
+
+	Mesh mesh = zinc.fm.findMeshByDimension(2);
+	Elementtemplate elementtemplate = mesh.createElementtemplate();
+	EXPECT_EQ(RESULT_OK, elementtemplate.setElementShapeType(Element::SHAPE_TYPE_SQUARE));
+	EXPECT_EQ(RESULT_OK, elementtemplate.setNumberOfNodes(4));
+	Elementbasis basis = zinc.fm.createElementbasis(2, Elementbasis::FUNCTION_TYPE_LINEAR_LAGRANGE);
+	const int localNodeIndexes[4] = { 1, 2, 3, 4 };
+	EXPECT_EQ(RESULT_OK, elementtemplate.defineFieldSimpleNodal(coordinates, -1, basis, 4, localNodeIndexes));
+	for (int e = 0; e < 2; ++e)
+	{
+		const int nodeIdentifiers[4] = { e + 1, e + 2, e + 4, e + 5 };
+		for (int n = 0; n < 4; ++n)
+			EXPECT_EQ(RESULT_OK, elementtemplate.setNode(n + 1, nodes.findNodeByIdentifier(nodeIdentifiers[n])));
+		EXPECT_TRUE(mesh.createElement(e + 1, elementtemplate).isValid());
+	}
+	EXPECT_EQ(RESULT_OK, zinc.fm.defineAllFaces());
+}
+
+/**
+ * Create 2 square biquadratic Lagrange elements in 3-D side by side in x,
+ * with faces. The first is curved in both xi directions, the second is flat,
+ * and their common line at x = 1 is straight.
+ */
+void createCurvedAndFlatSquares(ZincTestSetupCpp& zinc, Field& coordinates)
+{
+	coordinates = zinc.fm.createFieldFiniteElement(3);
+	EXPECT_TRUE(coordinates.isValid());
+	EXPECT_EQ(RESULT_OK, coordinates.setName("coordinates"));
+	EXPECT_EQ(RESULT_OK, coordinates.setTypeCoordinate(true));
+	EXPECT_EQ(RESULT_OK, coordinates.setManaged(true));
+
+	// 5 x 3 grid of nodes with x varying fastest; bump at x < 1, y = 0.5
+	Nodeset nodes = zinc.fm.findNodesetByFieldDomainType(Field::DOMAIN_TYPE_NODES);
+	Nodetemplate nodetemplate = nodes.createNodetemplate();
+	EXPECT_EQ(RESULT_OK, nodetemplate.defineField(coordinates));
+	Fieldcache cache = zinc.fm.createFieldcache();
+	for (int j = 0; j < 3; ++j)
+		for (int i = 0; i < 5; ++i)
+		{
+			Node node = nodes.createNode(j*5 + i + 1, nodetemplate);
+			EXPECT_TRUE(node.isValid());
+			EXPECT_EQ(RESULT_OK, cache.setNode(node));
+			const double x[3] = { 0.5*i, 0.5*j, ((i < 2) && (j == 1)) ? 0.25 : 0.0 };
+			EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, x));
+		}
+
+	Mesh mesh = zinc.fm.findMeshByDimension(2);
+	Elementtemplate elementtemplate = mesh.createElementtemplate();
+	EXPECT_EQ(RESULT_OK, elementtemplate.setElementShapeType(Element::SHAPE_TYPE_SQUARE));
+	EXPECT_EQ(RESULT_OK, elementtemplate.setNumberOfNodes(9));
+	Elementbasis basis = zinc.fm.createElementbasis(2, Elementbasis::FUNCTION_TYPE_QUADRATIC_LAGRANGE);
+	const int localNodeIndexes[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	EXPECT_EQ(RESULT_OK, elementtemplate.defineFieldSimpleNodal(coordinates, -1, basis, 9, localNodeIndexes));
+	for (int e = 0; e < 2; ++e)
+	{
+		for (int n = 0; n < 9; ++n)
+			EXPECT_EQ(RESULT_OK, elementtemplate.setNode(n + 1,
+				nodes.findNodeByIdentifier((n / 3)*5 + 2*e + (n % 3) + 1)));
+		EXPECT_TRUE(mesh.createElement(e + 1, elementtemplate).isValid());
+	}
+	EXPECT_EQ(RESULT_OK, zinc.fm.defineAllFaces());
+}
+
+/**
+ * Get positions, normals and triangle vertex indices of the surfaces in scene
+ * from their export to threejs, which writes vertices once with triangles
+ * indexing them.
+ */
+void getSceneSurfaceTriangles(Scene& scene, std::vector<double>& positions,
+	std::vector<double>& normals, std::vector<int>& triangles)
+{
+	StreaminformationScene si = scene.createStreaminformationScene();
+	EXPECT_EQ(RESULT_OK, si.setIOFormat(si.IO_FORMAT_THREEJS));
+	const int resourcesCount = si.getNumberOfResourcesRequired();
+	ASSERT_EQ(2, resourcesCount);
+	StreamresourceMemory metadata = si.createStreamresourceMemory();
+	StreamresourceMemory surfaces = si.createStreamresourceMemory();
+	EXPECT_EQ(RESULT_OK, scene.write(si));
+	const char *memoryBuffer = 0;
+	unsigned int size = 0;
+	EXPECT_EQ(RESULT_OK, surfaces.getBuffer((const void**)&memoryBuffer, &size));
+	const std::string buffer(memoryBuffer, size);
+	getThreejsArray(buffer, "vertices", positions);
+	getThreejsArray(buffer, "normals", normals);
+	// each face is a line: type, 3 vertex indices, then 3 normal indices
+	triangles.clear();
+	size_t position = buffer.find("\"faces\"");
+	ASSERT_NE(std::string::npos, position);
+	position = buffer.find('\n', position);
+	while (std::string::npos != position)
+	{
+		int type, indexes[3];
+		if (4 != sscanf(buffer.c_str() + position + 1, "%d ,%d,%d,%d", &type, indexes, indexes + 1, indexes + 2))
+			break;
+		triangles.insert(triangles.end(), indexes, indexes + 3);
+		position = buffer.find('\n', position + 1);
+	}
+}
+
+/**
+ * Read a single pentagon element with a polygon basis: node 1 at the centre
+ * and nodes 2-6 on the unit circle. Polygon elements cannot be made with the
+ * element template API.
+ */
+void readPentagon(ZincTestSetupCpp& zinc)
+{
+	const char *exText =
+		" Region: /\n"
+		" #Fields=1\n"
+		" 1) coordinates, coordinate, rectangular cartesian, #Components=2\n"
+		"  x.  Value index=1, #Derivatives=0\n"
+		"  y.  Value index=2, #Derivatives=0\n"
+		" Node: 1\n"
+		"  0.0 0.0\n"
+		" Node: 2\n"
+		"  1.0 0.0\n"
+		" Node: 3\n"
+		"  0.3090169943749474 0.9510565162951535\n"
+		" Node: 4\n"
+		"  -0.8090169943749474 0.5877852522924731\n"
+		" Node: 5\n"
+		"  -0.8090169943749474 -0.5877852522924731\n"
+		" Node: 6\n"
+		"  0.3090169943749474 -0.9510565162951535\n"
+		" Shape. Dimension=2, polygon(5;2)*polygon\n"
+		" #Scale factor sets=0\n"
+		" #Nodes=6\n"
+		" #Fields=1\n"
+		" 1) coordinates, coordinate, rectangular cartesian, #Components=2\n";
+	std::string buffer(exText);
+	const char *componentNames[2] = { "x", "y" };
+	for (int c = 0; c < 2; ++c)
+	{
+		buffer += std::string(" ") + componentNames[c] + ". polygon(5;2)*polygon, no modify, standard node based.\n"
+			"   #Nodes=6\n";
+		for (int n = 1; n <= 6; ++n)
+			buffer += "   " + std::to_string(n) + ". #Values=1\n"
+				"     Value labels: value\n"
+				"     Scale factor indices: 0\n";
+	}
+	buffer +=
+		" Element: 1 0 0\n"
+		" Nodes:\n"
+		" 1 2 3 4 5 6\n";
+	StreaminformationRegion si = zinc.root_region.createStreaminformationRegion();
+	EXPECT_EQ(RESULT_OK, si.setFileFormat(StreaminformationRegion::FILE_FORMAT_EX));
+	StreamresourceMemory resource = si.createStreamresourceMemoryBuffer(buffer.c_str(),
+		static_cast<unsigned int>(buffer.size()));
+	EXPECT_TRUE(resource.isValid());
+	EXPECT_EQ(RESULT_OK, zinc.root_region.read(si));
+	EXPECT_EQ(1, zinc.fm.findMeshByDimension(2).getSize());
+}
+
+}
+
+TEST(ZincGraphicsSurfaces, SharedVertices)
+{
+	ZincTestSetupCpp zinc;
+
+	Field coordinates;
+	createFoldedSquares(zinc, coordinates);
+	Tessellation tessellation = zinc.context.getTessellationmodule().createTessellation();
+	const int divisions = 4;
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(1, &divisions));
+
+	GraphicsSurfaces surfaces = zinc.scene.createGraphicsSurfaces();
+	EXPECT_TRUE(surfaces.isValid());
+	EXPECT_EQ(RESULT_OK, surfaces.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, surfaces.setTessellation(tessellation));
+	EXPECT_FALSE(surfaces.isSharedVertices());
+
+	std::vector<double> positions, normals;
+	std::vector<int> triangles;
+	getSceneSurfaceTriangles(zinc.scene, positions, normals, triangles);
+	const size_t separateVertexCount = positions.size()/3;
+	const size_t triangleCount = triangles.size()/3;
+	EXPECT_EQ(2*5*5u, separateVertexCount);
+	EXPECT_EQ(2*4*4*2u, triangleCount);
+
+	EXPECT_EQ(RESULT_OK, surfaces.setSharedVertices(true));
+	EXPECT_TRUE(surfaces.isSharedVertices());
+	getSceneSurfaceTriangles(zinc.scene, positions, normals, triangles);
+	const size_t vertexCount = positions.size()/3;
+	ASSERT_EQ(3*vertexCount, normals.size());
+	EXPECT_EQ(triangleCount, triangles.size()/3);
+	// the 5 vertices on the fold are shared
+	EXPECT_EQ(separateVertexCount - 5u, vertexCount);
+	EXPECT_LT(vertexCount, 3*triangleCount);
+
+	// triangles either side of the fold use the same vertices on it
+	std::vector<int> vertexElementMask(vertexCount, 0);
+	for (size_t t = 0; t < triangles.size(); t += 3)
+	{
+		const double centreX = (positions[3*triangles[t]] + positions[3*triangles[t + 1]] +
+			positions[3*triangles[t + 2]])/3.0;
+		for (int v = 0; v < 3; ++v)
+		{
+			ASSERT_LT(static_cast<size_t>(triangles[t + v]), vertexCount);
+			vertexElementMask[triangles[t + v]] |= (centreX < 1.0) ? 1 : 2;
+		}
+	}
+	int foldVertexCount = 0;
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		const double *normal = normals.data() + 3*v;
+		if (3 == vertexElementMask[v])
+		{
+			++foldVertexCount;
+			EXPECT_NEAR(1.0, positions[3*v], 1.0E-6);
+			// normals of the two elements are averaged on the fold
+			EXPECT_NEAR(0.0, normal[0], 1.0E-6);
+			EXPECT_NEAR(0.0, normal[1], 1.0E-6);
+			EXPECT_NEAR(1.0, fabs(normal[2]), 1.0E-6);
+		}
+		else
+		{
+			EXPECT_NEAR(1.0/sqrt(5.0), fabs(normal[0]), 1.0E-6);
+			EXPECT_NEAR(2.0/sqrt(5.0), fabs(normal[2]), 1.0E-6);
+		}
+	}
+	EXPECT_EQ(5, foldVertexCount);
+
+	// shared vertices are exported and serialised
+	char *description = zinc.scene.writeDescription();
+	EXPECT_NE(static_cast<char *>(0), description);
+	EXPECT_NE(static_cast<char *>(0), strstr(description, "\"SharedVertices\" : true"));
+	cmzn_deallocate(description);
+
+	EXPECT_EQ(RESULT_OK, surfaces.setSharedVertices(false));
+	EXPECT_FALSE(surfaces.isSharedVertices());
+}
+
+namespace {
+
+/**
+ * Get sorted y coordinates of vertices at x = 1 used by triangles with
+ * centres on either side of it.
+ */
+void getSurfaceLineVertexY(const std::vector<double>& positions, const std::vector<int>& triangles,
+	std::vector<double>& leftY, std::vector<double>& rightY)
+{
+	std::vector<int> vertexSideMask(positions.size()/3, 0);
+	for (size_t t = 0; t < triangles.size(); t += 3)
+	{
+		const double centreX = (positions[3*triangles[t]] + positions[3*triangles[t + 1]] +
+			positions[3*triangles[t + 2]])/3.0;
+		for (int v = 0; v < 3; ++v)
+			if (fabs(positions[3*triangles[t + v]] - 1.0) < 1.0E-6)
+				vertexSideMask[triangles[t + v]] |= (centreX < 1.0) ? 1 : 2;
+	}
+	leftY.clear();
+	rightY.clear();
+	for (size_t v = 0; v < vertexSideMask.size(); ++v)
+	{
+		if (vertexSideMask[v] & 1)
+			leftY.push_back(positions[3*v + 1]);
+		if (vertexSideMask[v] & 2)
+			rightY.push_back(positions[3*v + 1]);
+	}
+	std::sort(leftY.begin(), leftY.end());
+	std::sort(rightY.begin(), rightY.end());
+}
+
+}
+
+TEST(ZincGraphicsSurfaces, AdaptiveTessellation)
+{
+	ZincTestSetupCpp zinc;
+
+	Field coordinates;
+	createCurvedAndFlatSquares(zinc, coordinates);
+
+	Tessellationmodule tm = zinc.context.getTessellationmodule();
+	Tessellation tessellation = tm.createTessellation();
+	EXPECT_TRUE(tessellation.isValid());
+	const int minimumDivisions = 1;
+	const int refinementFactors = 8;
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(1, &minimumDivisions));
+	EXPECT_EQ(RESULT_OK, tessellation.setRefinementFactors(1, &refinementFactors));
+
+	GraphicsSurfaces surfaces = zinc.scene.createGraphicsSurfaces();
+	EXPECT_TRUE(surfaces.isValid());
+	EXPECT_EQ(RESULT_OK, surfaces.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, surfaces.setTessellation(tessellation));
+
+	std::vector<double> positions, normals, leftY, rightY;
+	std::vector<int> triangles;
+	getSceneSurfaceTriangles(zinc.scene, positions, normals, triangles);
+	const size_t fullTriangleCount = triangles.size()/3;
+	EXPECT_EQ(2*8*8*2u, fullTriangleCount);
+
+	// flat second element needs fewer divisions
+	EXPECT_EQ(RESULT_OK, tessellation.setAdaptiveTolerance(0.01));
+	EXPECT_EQ(0.01, tessellation.getAdaptiveTolerance());
+	getSceneSurfaceTriangles(zinc.scene, positions, normals, triangles);
+	const size_t triangleCount = triangles.size()/3;
+	EXPECT_LT(triangleCount, fullTriangleCount);
+	EXPECT_GT(triangleCount, fullTriangleCount/4);
+
+	// but has the divisions of the curved element along their common line
+	getSurfaceLineVertexY(positions, triangles, leftY, rightY);
+	ASSERT_EQ(9u, leftY.size());
+	ASSERT_EQ(leftY.size(), rightY.size());
+	for (size_t i = 0; i < leftY.size(); ++i)
+	{
+		EXPECT_NEAR(0.125*i, leftY[i], 1.0E-6);
+		EXPECT_NEAR(leftY[i], rightY[i], 1.0E-6);
+	}
+
+	// so vertices on it can be shared
+	const size_t vertexCount = positions.size()/3;
+	EXPECT_EQ(RESULT_OK, surfaces.setSharedVertices(true));
+	getSceneSurfaceTriangles(zinc.scene, positions, normals, triangles);
+	EXPECT_EQ(triangleCount, triangles.size()/3);
+	EXPECT_EQ(vertexCount - 9u, positions.size()/3);
+	getSurfaceLineVertexY(positions, triangles, leftY, rightY);
+	EXPECT_EQ(9u, leftY.size());
+	EXPECT_EQ(leftY, rightY);
+}
+
+TEST(ZincGraphicsSurfaces, LevelOfDetailCache)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	Tessellationmodule tm = zinc.context.getTessellationmodule();
+	Tessellation coarseTessellation = tm.createTessellation();
+	EXPECT_TRUE(coarseTessellation.isValid());
+	Tessellation fineTessellation = tm.createTessellation();
+	EXPECT_TRUE(fineTessellation.isValid());
+	const int coarseDivisions = 1;
+	const int fineDivisions = 6;
+	EXPECT_EQ(RESULT_OK, coarseTessellation.setMinimumDivisions(1, &coarseDivisions));
+	EXPECT_EQ(RESULT_OK, fineTessellation.setMinimumDivisions(1, &fineDivisions));
+
+	GraphicsSurfaces surfaces = zinc.scene.createGraphicsSurfaces();
+	EXPECT_TRUE(surfaces.isValid());
+	EXPECT_EQ(RESULT_OK, surfaces.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, surfaces.setTessellation(coarseTessellation));
+
+	EXPECT_EQ(64, zinc.scene.getLevelOfDetailCacheBudget());
+	EXPECT_EQ(4, zinc.scene.getLevelOfDetailCacheMaximumLevels());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, zinc.scene.setLevelOfDetailCacheBudget(-1));
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, zinc.scene.setLevelOfDetailCacheBudget(0));
+	EXPECT_EQ(64, zinc.scene.getLevelOfDetailCacheBudget());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, zinc.scene.setLevelOfDetailCacheMaximumLevels(-1));
+	EXPECT_EQ(RESULT_OK, zinc.scene.setLevelOfDetailCacheBudget(1));
+	EXPECT_EQ(1, zinc.scene.getLevelOfDetailCacheBudget());
+	EXPECT_EQ(RESULT_OK, zinc.scene.setLevelOfDetailCacheMaximumLevels(2));
+	EXPECT_EQ(2, zinc.scene.getLevelOfDetailCacheMaximumLevels());
+
+	Scenefilter noFilter;
+	double minimums1[3], maximums1[3];
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums1, maximums1));
+
+	// switch levels back and forth, reusing graphics previously built
+	double minimums2[3], maximums2[3];
+	for (int j = 0; j < 4; ++j)
+	{
+		EXPECT_EQ(RESULT_OK, surfaces.setTessellation((j % 2) ? coarseTessellation : fineTessellation));
+		EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+		for (int i = 0; i < 3; ++i)
+		{
+			EXPECT_DOUBLE_EQ(minimums1[i], minimums2[i]);
+			EXPECT_DOUBLE_EQ(maximums1[i], maximums2[i]);
+		}
+	}
+
+	// with caching disabled, switching levels rebuilds with the same result
+	EXPECT_EQ(RESULT_OK, zinc.scene.setLevelOfDetailCacheMaximumLevels(0));
+	for (int j = 0; j < 2; ++j)
+	{
+		EXPECT_EQ(RESULT_OK, surfaces.setTessellation((j % 2) ? coarseTessellation : fineTessellation));
+		EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+		for (int i = 0; i < 3; ++i)
+		{
+			EXPECT_DOUBLE_EQ(minimums1[i], minimums2[i]);
+			EXPECT_DOUBLE_EQ(maximums1[i], maximums2[i]);
+		}
+	}
+	EXPECT_EQ(RESULT_OK, zinc.scene.setLevelOfDetailCacheMaximumLevels(4));
+
+	// changing divisions of the current tessellation also switches level
+	EXPECT_EQ(RESULT_OK, coarseTessellation.setMinimumDivisions(1, &fineDivisions));
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_DOUBLE_EQ(minimums1[i], minimums2[i]);
+		EXPECT_DOUBLE_EQ(maximums1[i], maximums2[i]);
+	}
+
+	// cached levels must not survive a change to the coordinate field
+	Fieldcache cache = zinc.fm.createFieldcache();
+	Nodeset nodes = zinc.fm.findNodesetByFieldDomainType(Field::DOMAIN_TYPE_NODES);
+	Node node = nodes.findNodeByIdentifier(1);
+	EXPECT_TRUE(node.isValid());
+	EXPECT_EQ(RESULT_OK, cache.setNode(node));
+	double x[3];
+	EXPECT_EQ(RESULT_OK, coordinates.evaluateReal(cache, 3, x));
+	const double newX[3] = { x[0] - 1.0, x[1], x[2] };
+	EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, newX));
+	EXPECT_EQ(RESULT_OK, surfaces.setTessellation(fineTessellation));
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+	EXPECT_DOUBLE_EQ(newX[0], minimums2[0]);
+}
+
+TEST(ZincGraphicsSurfaces, PartialRebuild)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	GraphicsSurfaces surfaces = zinc.scene.createGraphicsSurfaces();
+	EXPECT_TRUE(surfaces.isValid());
+	EXPECT_EQ(RESULT_OK, surfaces.setCoordinateField(coordinates));
+	GraphicsLines lines = zinc.scene.createGraphicsLines();
+	EXPECT_TRUE(lines.isValid());
+	EXPECT_EQ(RESULT_OK, lines.setCoordinateField(coordinates));
+
+	// element field evaluation cache misses count the elements each build
+	// evaluates the coordinate field in, since builds use a new field cache
+	int hits, fullMisses, partialMisses;
+	EXPECT_EQ(RESULT_OK, zinc.fm.resetElementEvaluationCacheStatistics());
+	Scenefilter noFilter;
+	double minimums1[3], maximums1[3];
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums1, maximums1));
+	EXPECT_EQ(RESULT_OK, zinc.fm.getElementEvaluationCacheStatistics(&hits, &fullMisses));
+	EXPECT_GT(fullMisses, 0);
+
+	// moving one node rebuilds only the elements using it, leaving faces and
+	// lines of the second cube which do not use it unevaluated
+	Fieldcache cache = zinc.fm.createFieldcache();
+	Nodeset nodes = zinc.fm.findNodesetByFieldDomainType(Field::DOMAIN_TYPE_NODES);
+	Node node = nodes.findNodeByIdentifier(1);
+	EXPECT_TRUE(node.isValid());
+	EXPECT_EQ(RESULT_OK, cache.setNode(node));
+	double x[3];
+	EXPECT_EQ(RESULT_OK, coordinates.evaluateReal(cache, 3, x));
+	const double newX[3] = { x[0] - 1.0, x[1] - 2.0, x[2] };
+	EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, newX));
+	EXPECT_EQ(RESULT_OK, zinc.fm.resetElementEvaluationCacheStatistics());
+	double minimums2[3], maximums2[3];
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+	EXPECT_EQ(RESULT_OK, zinc.fm.getElementEvaluationCacheStatistics(&hits, &partialMisses));
+	EXPECT_GT(partialMisses, 0);
+	EXPECT_LT(partialMisses, fullMisses);
+	EXPECT_DOUBLE_EQ(newX[0], minimums2[0]);
+	EXPECT_DOUBLE_EQ(newX[1], minimums2[1]);
+	EXPECT_DOUBLE_EQ(minimums1[2], minimums2[2]);
+	for (int i = 0; i < 3; ++i)
+		EXPECT_DOUBLE_EQ(maximums1[i], maximums2[i]);
+
+	// successive partial changes before rebuilding
+	EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, x));
+	node = nodes.findNodeByIdentifier(2);
+	EXPECT_TRUE(node.isValid());
+	EXPECT_EQ(RESULT_OK, cache.setNode(node));
+	double y[3];
+	EXPECT_EQ(RESULT_OK, coordinates.evaluateReal(cache, 3, y));
+	const double newY[3] = { y[0], y[1], y[2] - 3.0 };
+	EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, newY));
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+	EXPECT_DOUBLE_EQ(minimums1[0], minimums2[0]);
+	EXPECT_DOUBLE_EQ(minimums1[1], minimums2[1]);
+	EXPECT_DOUBLE_EQ(newY[2], minimums2[2]);
+
+	// restoring gives the original graphics
+	EXPECT_EQ(RESULT_OK, coordinates.assignReal(cache, 3, y));
+	EXPECT_EQ(RESULT_OK, zinc.scene.getCoordinatesRange(noFilter, minimums2, maximums2));
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_DOUBLE_EQ(minimums1[i], minimums2[i]);
+		EXPECT_DOUBLE_EQ(maximums1[i], maximums2[i]);
+	}
+}
+
+// The polygon basis is not a monomial so all element points of a direct finite
+// element coordinate field are evaluated one at a time in a fallback. Compare
+// with a field which is not directly finite element so goes through the field
+// cache at each point.
+TEST(ZincGraphicsPoints, PolygonElementPoints)
+{
+	ZincTestSetupCpp zinc;
+
+	readPentagon(zinc);
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+	const double unitScale[2] = { 1.0, 1.0 };
+	Field pointCoordinates = zinc.fm.createFieldMultiply(coordinates, zinc.fm.createFieldConstant(2, unitScale));
+	EXPECT_TRUE(pointCoordinates.isValid());
+	Tessellation tessellation = zinc.context.getTessellationmodule().createTessellation();
+	const int divisions[2] = { 5, 2 };
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(2, divisions));
+
+	GraphicsPoints points = zinc.scene.createGraphicsPoints();
+	EXPECT_TRUE(points.isValid());
+	EXPECT_EQ(RESULT_OK, points.setFieldDomainType(Field::DOMAIN_TYPE_MESH_HIGHEST_DIMENSION));
+	EXPECT_EQ(RESULT_OK, points.setTessellation(tessellation));
+	Graphicssamplingattributes sampling = points.getGraphicssamplingattributes();
+	EXPECT_EQ(RESULT_OK, sampling.setElementPointSamplingMode(Element::POINT_SAMPLING_MODE_CELL_CENTRES));
+
+	std::vector<double> directPositions, cachePositions;
+	EXPECT_EQ(RESULT_OK, points.setCoordinateField(coordinates));
+	getSceneThreejsVertices(zinc.scene, directPositions);
+	EXPECT_EQ(RESULT_OK, points.setCoordinateField(pointCoordinates));
+	getSceneThreejsVertices(zinc.scene, cachePositions);
+	ASSERT_LT(3u, cachePositions.size());
+	ASSERT_EQ(cachePositions.size(), directPositions.size());
+	const double tolerance = 1.0E-6;
+	for (size_t i = 0; i < cachePositions.size(); ++i)
+		EXPECT_NEAR(cachePositions[i], directPositions[i], tolerance);
+	// points differ so each must have had its own basis evaluated
+	EXPECT_GT(fabs(directPositions[0] - directPositions[3]) + fabs(directPositions[1] - directPositions[4]), tolerance);
+}
+
 TEST(cmzn_graphics_api, line_attributes)
 {
 	ZincTestSetup zinc;
@@ -1538,6 +2121,10 @@ TEST(cmzn_graphics_api, sampling_attributes_description_io)
 	EXPECT_EQ(2.0, streamlines.getTrackLength());
 	EXPECT_EQ(GraphicsStreamlines::COLOUR_DATA_TYPE_MAGNITUDE, streamlines.getColourDataType());
 	EXPECT_EQ(GraphicsStreamlines::TRACK_DIRECTION_REVERSE, streamlines.getTrackDirection());
+	EXPECT_EQ(0.001, streamlines.getTolerance());
+	EXPECT_EQ(500, streamlines.getMaximumNumberOfSteps());
+	EXPECT_EQ(GraphicsStreamlines::TRACE_MODE_PATHLINE, streamlines.getTraceMode());
+	EXPECT_EQ(0.25, streamlines.getPathTimeStep());
 
 	char *return_string = zinc.scene.writeDescription();
 	EXPECT_TRUE(return_string != 0);
@@ -13,7 +13,13 @@
 #include <opencmiss/zinc/sceneviewer.h>
 
 #include <opencmiss/zinc/context.hpp>
+#include <opencmiss/zinc/field.hpp>
+#include <opencmiss/zinc/fieldmodule.hpp>
+#include <opencmiss/zinc/graphics.hpp>
 #include <opencmiss/zinc/light.hpp>
+#include <opencmiss/zinc/material.hpp>
+#include <opencmiss/zinc/region.hpp>
+#include <opencmiss/zinc/scene.hpp>
 #include <opencmiss/zinc/sceneviewer.hpp>
 
 #include "zinctestsetup.hpp"
@@ -718,3 +724,59 @@ TEST(ZincSceneviewermodule, defaultBackgroundColour)
 	EXPECT_DOUBLE_EQ(newColour4[2], colour4[2]);
 	EXPECT_DOUBLE_EQ(newColour4[3], colour4[3]);
 }
+
+TEST(ZincSceneviewer, renderSoftware)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+	Materialmodule materialmodule = zinc.context.getMaterialmodule();
+	EXPECT_EQ(RESULT_OK, materialmodule.defineStandardMaterials());
+	Material red = materialmodule.findMaterialByName("red");
+	EXPECT_TRUE(red.isValid());
+
+	GraphicsSurfaces surfaces = zinc.scene.createGraphicsSurfaces();
+	EXPECT_TRUE(surfaces.isValid());
+	EXPECT_EQ(RESULT_OK, surfaces.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, surfaces.setMaterial(red));
+
+	Sceneviewermodule svm = zinc.context.getSceneviewermodule();
+	Sceneviewer sv = svm.createSceneviewer(Sceneviewer::BUFFERING_MODE_DEFAULT, Sceneviewer::STEREO_MODE_DEFAULT);
+	EXPECT_TRUE(sv.isValid());
+	EXPECT_EQ(RESULT_OK, sv.setScene(zinc.scene));
+	const double black[4] = { 0.0, 0.0, 0.0, 1.0 };
+	EXPECT_EQ(RESULT_OK, sv.setBackgroundColourRGBA(black));
+	EXPECT_EQ(RESULT_OK, sv.viewAll());
+
+	const int width = 64, height = 48;
+	unsigned char *pixels = new unsigned char[4*width*height];
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, sv.renderSoftwarePixels(0, height, pixels));
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, sv.renderSoftwarePixels(width, height, 0));
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, sv.writeImageToFileSoftware(0, width, height));
+	EXPECT_EQ(RESULT_OK, sv.renderSoftwarePixels(width, height, pixels));
+	// cubes are shaded red in centre of view
+	const unsigned char *centre = pixels + 4*((height/2)*width + width/2);
+	EXPECT_LT(0, centre[0]);
+	EXPECT_EQ(0, centre[1]);
+	EXPECT_EQ(0, centre[2]);
+	EXPECT_EQ(255, centre[3]);
+	// corners show background
+	const int corners[4] = { 0, width - 1, (height - 1)*width, height*width - 1 };
+	for (int c = 0; c < 4; ++c)
+	{
+		const unsigned char *corner = pixels + 4*corners[c];
+		EXPECT_EQ(0, corner[0]);
+		EXPECT_EQ(0, corner[1]);
+		EXPECT_EQ(0, corner[2]);
+		EXPECT_EQ(255, corner[3]);
+	}
+
+	// hidden graphics are not drawn
+	EXPECT_EQ(RESULT_OK, surfaces.setVisibilityFlag(false));
+	EXPECT_EQ(RESULT_OK, sv.renderSoftwarePixels(width, height, pixels));
+	EXPECT_EQ(0, centre[0]);
+	delete[] pixels;
+}
@@ -8,6 +8,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include <opencmiss/zinc/status.h>
 #include <opencmiss/zinc/core.h>
 #include <opencmiss/zinc/context.h>
@@ -20,8 +24,25 @@
 
 #include "zinctestsetup.hpp"
 #include "zinctestsetupcpp.hpp"
+#include "opencmiss/zinc/fieldarithmeticoperators.hpp"
+#include "opencmiss/zinc/fieldcache.hpp"
 #include "opencmiss/zinc/fieldconstant.hpp"
+#include "opencmiss/zinc/fieldfiniteelement.hpp"
+#include "opencmiss/zinc/fieldgroup.hpp"
+#include "opencmiss/zinc/fieldsubobjectgroup.hpp"
+#include "opencmiss/zinc/fieldvectoroperators.hpp"
 #include "opencmiss/zinc/graphics.hpp"
+#include "opencmiss/zinc/node.hpp"
+#include "opencmiss/zinc/nodeset.hpp"
+#include "opencmiss/zinc/nodetemplate.hpp"
+#include "opencmiss/zinc/result.hpp"
+#include "opencmiss/zinc/streamscene.hpp"
+#include "opencmiss/zinc/tessellation.hpp"
+#include "opencmiss/zinc/timekeeper.hpp"
+#include "opencmiss/zinc/timesequence.hpp"
+
+#include "test_resources.h"
+#include "utilities/threejsio.hpp"
 
 TEST(cmzn_graphics_streamlines, create_cast)
 {
@@ -210,3 +231,361 @@ TEST(cmzn_graphics_streamlines, track_length_cpp)
 	EXPECT_EQ(CMZN_OK, st.setTrackLength(trackLength));
 	EXPECT_DOUBLE_EQ(trackLength, st.getTrackLength());
 }
+
+TEST(cmzn_graphics_streamlines, tolerance)
+{
+	ZincTestSetup zinc;
+
+	cmzn_graphics_id gr = cmzn_scene_create_graphics_streamlines(zinc.scene);
+	cmzn_graphics_streamlines_id st = cmzn_graphics_cast_streamlines(gr);
+	cmzn_graphics_destroy(&gr);
+	EXPECT_NE(static_cast<cmzn_graphics_streamlines *>(0), st);
+
+	const double tolerance = 1.0E-6;
+	EXPECT_DOUBLE_EQ(1.0E-4, cmzn_graphics_streamlines_get_tolerance(st));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_streamlines_set_tolerance(st, tolerance));
+	EXPECT_DOUBLE_EQ(tolerance, cmzn_graphics_streamlines_get_tolerance(st));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_tolerance(st, 0.0));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_tolerance(st, -1.0));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_tolerance(0, tolerance));
+	EXPECT_DOUBLE_EQ(tolerance, cmzn_graphics_streamlines_get_tolerance(st));
+
+	cmzn_graphics_streamlines_destroy(&st);
+}
+
+TEST(cmzn_graphics_streamlines, tolerance_cpp)
+{
+	ZincTestSetupCpp zinc;
+
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+
+	const double tolerance = 1.0E-6;
+	EXPECT_DOUBLE_EQ(1.0E-4, st.getTolerance());
+	EXPECT_EQ(CMZN_OK, st.setTolerance(tolerance));
+	EXPECT_DOUBLE_EQ(tolerance, st.getTolerance());
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, st.setTolerance(0.0));
+	EXPECT_DOUBLE_EQ(tolerance, st.getTolerance());
+}
+
+TEST(cmzn_graphics_streamlines, maximum_number_of_steps)
+{
+	ZincTestSetup zinc;
+
+	cmzn_graphics_id gr = cmzn_scene_create_graphics_streamlines(zinc.scene);
+	cmzn_graphics_streamlines_id st = cmzn_graphics_cast_streamlines(gr);
+	cmzn_graphics_destroy(&gr);
+	EXPECT_NE(static_cast<cmzn_graphics_streamlines *>(0), st);
+
+	EXPECT_EQ(100000, cmzn_graphics_streamlines_get_maximum_number_of_steps(st));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_streamlines_set_maximum_number_of_steps(st, 250));
+	EXPECT_EQ(250, cmzn_graphics_streamlines_get_maximum_number_of_steps(st));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_maximum_number_of_steps(st, 0));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_maximum_number_of_steps(0, 250));
+	EXPECT_EQ(250, cmzn_graphics_streamlines_get_maximum_number_of_steps(st));
+
+	cmzn_graphics_streamlines_destroy(&st);
+}
+
+TEST(cmzn_graphics_streamlines, maximum_number_of_steps_cpp)
+{
+	ZincTestSetupCpp zinc;
+
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+
+	EXPECT_EQ(100000, st.getMaximumNumberOfSteps());
+	EXPECT_EQ(CMZN_OK, st.setMaximumNumberOfSteps(250));
+	EXPECT_EQ(250, st.getMaximumNumberOfSteps());
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, st.setMaximumNumberOfSteps(-1));
+	EXPECT_EQ(250, st.getMaximumNumberOfSteps());
+}
+
+// test streamline seeded in one element is tracked across the face into its
+// neighbour along the analytic helix of a rotating stream vector
+TEST(ZincGraphicsStreamlines, trackAcrossElements)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+	// (1, -0.1*(z - 5), 0.1*(y - 5)) turns 0.1 radians about y = z = 5 per
+	// unit advance in x
+	const double axialValues[3] = { 1.0, 0.0, 0.0 };
+	const double rateValues[3] = { 0.1, 0.0, 0.0 };
+	const double axisValues[3] = { 0.0, 5.0, 5.0 };
+	Field streamVector = zinc.fm.createFieldConstant(3, axialValues) +
+		zinc.fm.createFieldCrossProduct(zinc.fm.createFieldConstant(3, rateValues),
+			coordinates - zinc.fm.createFieldConstant(3, axisValues));
+	EXPECT_TRUE(streamVector.isValid());
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	FieldGroup group = zinc.fm.createFieldGroup();
+	FieldElementGroup elementGroup = group.createFieldElementGroup(mesh3d);
+	MeshGroup meshGroup = elementGroup.getMeshGroup();
+	EXPECT_EQ(RESULT_OK, meshGroup.addElement(mesh3d.findElementByIdentifier(1)));
+
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+	EXPECT_EQ(RESULT_OK, st.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, st.setStreamVectorField(streamVector));
+	EXPECT_EQ(RESULT_OK, st.setSubgroupField(group));
+	Graphicssamplingattributes sampling = st.getGraphicssamplingattributes();
+	EXPECT_EQ(RESULT_OK, sampling.setElementPointSamplingMode(Element::POINT_SAMPLING_MODE_SET_LOCATION));
+	const double seedXi[3] = { 0.5, 0.25, 0.75 };
+	EXPECT_EQ(RESULT_OK, sampling.setLocation(3, seedXi));
+	EXPECT_EQ(RESULT_OK, st.setTolerance(1.0E-6));
+	EXPECT_EQ(RESULT_OK, st.setTrackLength(8.0));
+
+	// x advances at unit speed from x = 5 in element 1 to x = 13 in element 2
+	std::vector<double> vertices;
+	getSceneThreejsVertices(zinc.scene, vertices);
+	const size_t vertexCount = vertices.size()/3;
+	ASSERT_LT(2u, vertexCount);
+	const double x0 = vertices[0];
+	const double y0 = vertices[1] - 5.0;
+	const double z0 = vertices[2] - 5.0;
+	EXPECT_NEAR(5.0, x0, 1.0E-5);
+	EXPECT_NEAR(13.0, vertices[3*vertexCount - 3], 1.0E-4);
+	const double radius = sqrt(y0*y0 + z0*z0);
+	const double angle0 = atan2(z0, y0);
+	EXPECT_LT(1.0, radius);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		const double *vertex = vertices.data() + 3*v;
+		const double angle = angle0 + 0.1*(vertex[0] - x0);
+		EXPECT_NEAR(5.0 + radius*cos(angle), vertex[1], 1.0E-4);
+		EXPECT_NEAR(5.0 + radius*sin(angle), vertex[2], 1.0E-4);
+		if (v > 0)
+		{
+			EXPECT_LE(vertex[-3], vertex[0]);
+		}
+	}
+
+	// limiting number of steps stops the track early
+	EXPECT_EQ(RESULT_OK, st.setMaximumNumberOfSteps(1));
+	getSceneThreejsVertices(zinc.scene, vertices);
+	ASSERT_LE(6u, vertices.size());
+	EXPECT_GT(3*vertexCount, vertices.size());
+	EXPECT_NEAR(x0, vertices[0], 1.0E-5);
+	EXPECT_LT(x0, vertices[vertices.size() - 3]);
+	EXPECT_GT(13.0, vertices[vertices.size() - 3]);
+}
+
+// test streamlines from many seeds tracked in parallel are identical to and
+// in the same order as each seed tracked alone on one thread
+TEST(ZincGraphicsStreamlines, trackSeedsInParallel)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+	const double axialValues[3] = { 1.0, 0.0, 0.0 };
+	const double rateValues[3] = { 0.1, 0.0, 0.0 };
+	const double axisValues[3] = { 0.0, 5.0, 5.0 };
+	Field streamVector = zinc.fm.createFieldConstant(3, axialValues) +
+		zinc.fm.createFieldCrossProduct(zinc.fm.createFieldConstant(3, rateValues),
+			coordinates - zinc.fm.createFieldConstant(3, axisValues));
+	EXPECT_TRUE(streamVector.isValid());
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	FieldGroup group = zinc.fm.createFieldGroup();
+	FieldElementGroup elementGroup = group.createFieldElementGroup(mesh3d);
+	MeshGroup meshGroup = elementGroup.getMeshGroup();
+	EXPECT_EQ(RESULT_OK, meshGroup.addElement(mesh3d.findElementByIdentifier(1)));
+
+	Tessellation tessellation = zinc.context.getTessellationmodule().createTessellation();
+	const int divisions = 3;
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(1, &divisions));
+
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+	EXPECT_EQ(RESULT_OK, st.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, st.setStreamVectorField(streamVector));
+	EXPECT_EQ(RESULT_OK, st.setSubgroupField(group));
+	EXPECT_EQ(RESULT_OK, st.setTessellation(tessellation));
+	EXPECT_EQ(RESULT_OK, st.setTrackLength(4.0));
+
+	// 27 seeds at cell centres, xi1 varying fastest
+	std::vector<double> parallelVertices;
+	getSceneThreejsVertices(zinc.scene, parallelVertices);
+
+	Graphicssamplingattributes sampling = st.getGraphicssamplingattributes();
+	EXPECT_EQ(RESULT_OK, sampling.setElementPointSamplingMode(Element::POINT_SAMPLING_MODE_SET_LOCATION));
+	std::vector<double> serialVertices, seedVertices;
+	for (int k = 0; k < divisions; ++k)
+		for (int j = 0; j < divisions; ++j)
+			for (int i = 0; i < divisions; ++i)
+			{
+				const double xi[3] = { (i + 0.5)/divisions, (j + 0.5)/divisions, (k + 0.5)/divisions };
+				EXPECT_EQ(RESULT_OK, sampling.setLocation(3, xi));
+				getSceneThreejsVertices(zinc.scene, seedVertices);
+				EXPECT_LT(0u, seedVertices.size());
+				serialVertices.insert(serialVertices.end(), seedVertices.begin(), seedVertices.end());
+			}
+	ASSERT_EQ(serialVertices.size(), parallelVertices.size());
+	for (size_t i = 0; i < serialVertices.size(); ++i)
+		EXPECT_EQ(serialVertices[i], parallelVertices[i]);
+}
+
+TEST(cmzn_graphics_streamlines, trace_mode)
+{
+	ZincTestSetup zinc;
+
+	cmzn_graphics_id gr = cmzn_scene_create_graphics_streamlines(zinc.scene);
+	cmzn_graphics_streamlines_id st = cmzn_graphics_cast_streamlines(gr);
+	cmzn_graphics_destroy(&gr);
+	EXPECT_NE(static_cast<cmzn_graphics_streamlines *>(0), st);
+
+	EXPECT_EQ(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAMLINE, cmzn_graphics_streamlines_get_trace_mode(st));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_streamlines_set_trace_mode(st, CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE));
+	EXPECT_EQ(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE, cmzn_graphics_streamlines_get_trace_mode(st));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_trace_mode(st, CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_INVALID));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_trace_mode(0, CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_PATHLINE));
+	EXPECT_EQ(CMZN_GRAPHICS_STREAMLINES_TRACE_MODE_STREAKLINE, cmzn_graphics_streamlines_get_trace_mode(st));
+
+	EXPECT_EQ(0.0, cmzn_graphics_streamlines_get_path_time_step(st));
+	EXPECT_EQ(CMZN_OK, cmzn_graphics_streamlines_set_path_time_step(st, 0.5));
+	EXPECT_EQ(0.5, cmzn_graphics_streamlines_get_path_time_step(st));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_path_time_step(st, -1.0));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_graphics_streamlines_set_path_time_step(0, 0.5));
+	EXPECT_EQ(0.5, cmzn_graphics_streamlines_get_path_time_step(st));
+
+	cmzn_graphics_streamlines_destroy(&st);
+}
+
+TEST(cmzn_graphics_streamlines, trace_mode_cpp)
+{
+	ZincTestSetupCpp zinc;
+
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+
+	EXPECT_EQ(GraphicsStreamlines::TRACE_MODE_STREAMLINE, st.getTraceMode());
+	EXPECT_EQ(RESULT_OK, st.setTraceMode(GraphicsStreamlines::TRACE_MODE_PATHLINE));
+	EXPECT_EQ(GraphicsStreamlines::TRACE_MODE_PATHLINE, st.getTraceMode());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, st.setTraceMode(GraphicsStreamlines::TRACE_MODE_INVALID));
+	EXPECT_EQ(GraphicsStreamlines::TRACE_MODE_PATHLINE, st.getTraceMode());
+
+	EXPECT_EQ(0.0, st.getPathTimeStep());
+	EXPECT_EQ(RESULT_OK, st.setPathTimeStep(0.25));
+	EXPECT_EQ(0.25, st.getPathTimeStep());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, st.setPathTimeStep(-0.25));
+	EXPECT_EQ(0.25, st.getPathTimeStep());
+}
+
+// test pathlines and streaklines follow particles released from seed through
+// time-varying velocity (1, t/8, 0): a particle released from (5,5,5) at time
+// t0 is at x = 5 + (t - t0), y = 5 + (t*t - t0*t0)/16 at time t
+TEST(ZincGraphicsStreamlines, tracePaths)
+{
+	ZincTestSetupCpp zinc;
+
+	EXPECT_EQ(RESULT_OK, zinc.root_region.readFile(
+		TestResources::getLocation(TestResources::FIELDMODULE_TWO_CUBES_RESOURCE)));
+	Field coordinates = zinc.fm.findFieldByName("coordinates");
+	EXPECT_TRUE(coordinates.isValid());
+
+	// velocity stored at a node with values at times 0 and 8, linearly
+	// interpolated in time and looked up at every location
+	FieldFiniteElement velocity = zinc.fm.createFieldFiniteElement(3);
+	EXPECT_TRUE(velocity.isValid());
+	EXPECT_EQ(RESULT_OK, velocity.setName("velocity"));
+	Nodeset nodes = zinc.fm.findNodesetByFieldDomainType(Field::DOMAIN_TYPE_NODES);
+	const double times[2] = { 0.0, 8.0 };
+	Timesequence timesequence = zinc.fm.getMatchingTimesequence(2, times);
+	EXPECT_TRUE(timesequence.isValid());
+	Nodetemplate nodetemplate = nodes.createNodetemplate();
+	EXPECT_EQ(RESULT_OK, nodetemplate.defineField(velocity));
+	EXPECT_EQ(RESULT_OK, nodetemplate.setTimesequence(velocity, timesequence));
+	Node node = nodes.createNode(100, nodetemplate);
+	EXPECT_TRUE(node.isValid());
+	Fieldcache fieldcache = zinc.fm.createFieldcache();
+	EXPECT_EQ(RESULT_OK, fieldcache.setNode(node));
+	const double velocity0[3] = { 1.0, 0.0, 0.0 };
+	const double velocity8[3] = { 1.0, 1.0, 0.0 };
+	EXPECT_EQ(RESULT_OK, fieldcache.setTime(0.0));
+	EXPECT_EQ(RESULT_OK, velocity.assignReal(fieldcache, 3, velocity0));
+	EXPECT_EQ(RESULT_OK, fieldcache.setTime(8.0));
+	EXPECT_EQ(RESULT_OK, velocity.assignReal(fieldcache, 3, velocity8));
+	Field streamVector = zinc.fm.createFieldNodeLookup(velocity, node);
+	EXPECT_TRUE(streamVector.isValid());
+
+	Mesh mesh3d = zinc.fm.findMeshByDimension(3);
+	FieldGroup group = zinc.fm.createFieldGroup();
+	FieldElementGroup elementGroup = group.createFieldElementGroup(mesh3d);
+	MeshGroup meshGroup = elementGroup.getMeshGroup();
+	EXPECT_EQ(RESULT_OK, meshGroup.addElement(mesh3d.findElementByIdentifier(1)));
+
+	Tessellation tessellation = zinc.context.getTessellationmodule().createTessellation();
+	const int one = 1;
+	EXPECT_EQ(RESULT_OK, tessellation.setMinimumDivisions(1, &one));
+	EXPECT_EQ(RESULT_OK, tessellation.setRefinementFactors(1, &one));
+
+	Timekeeper timekeeper = zinc.context.getTimekeepermodule().getDefaultTimekeeper();
+	EXPECT_EQ(RESULT_OK, timekeeper.setMinimumTime(0.0));
+	EXPECT_EQ(RESULT_OK, timekeeper.setMaximumTime(8.0));
+	EXPECT_EQ(RESULT_OK, timekeeper.setTime(8.0));
+
+	// seeded at centre of element 1 (5,5,5) at minimum time
+	GraphicsStreamlines st = zinc.scene.createGraphicsStreamlines();
+	EXPECT_TRUE(st.isValid());
+	EXPECT_EQ(RESULT_OK, st.setCoordinateField(coordinates));
+	EXPECT_EQ(RESULT_OK, st.setStreamVectorField(streamVector));
+	EXPECT_EQ(RESULT_OK, st.setSubgroupField(group));
+	EXPECT_EQ(RESULT_OK, st.setTessellation(tessellation));
+	EXPECT_EQ(RESULT_OK, st.setTolerance(1.0E-6));
+	EXPECT_EQ(RESULT_OK, st.setTraceMode(GraphicsStreamlines::TRACE_MODE_PATHLINE));
+
+	// pathline at time T is y - 5 = d*d/16 for d = x - 5 from 0 to T, passing
+	// into element 2 at T = 8; scrubbing back to T = 4 draws the cached path
+	std::vector<double> vertices;
+	const double pathTimes[2] = { 8.0, 4.0 };
+	for (int p = 0; p < 2; ++p)
+	{
+		const double T = pathTimes[p];
+		EXPECT_EQ(RESULT_OK, timekeeper.setTime(T));
+		getSceneThreejsVertices(zinc.scene, vertices);
+		const size_t vertexCount = vertices.size()/3;
+		ASSERT_LT(2u, vertexCount);
+		EXPECT_NEAR(5.0, vertices[0], 1.0E-4);
+		EXPECT_NEAR(5.0 + T, vertices[3*vertexCount - 3], 1.0E-4);
+		EXPECT_NEAR(5.0 + T*T/16.0, vertices[3*vertexCount - 2], 1.0E-4);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			const double *vertex = vertices.data() + 3*v;
+			const double d = vertex[0] - 5.0;
+			EXPECT_NEAR(5.0 + d*d/16.0, vertex[1], 1.0E-4);
+			EXPECT_NEAR(5.0, vertex[2], 1.0E-4);
+		}
+	}
+
+	// streakline at time T joins particles released from the seed every 0.5
+	// from d = x - 5 = 0 at the seed to T for the first particle released:
+	// y - 5 = (2*T*d - d*d)/16
+	EXPECT_EQ(RESULT_OK, st.setTraceMode(GraphicsStreamlines::TRACE_MODE_STREAKLINE));
+	EXPECT_EQ(RESULT_OK, st.setPathTimeStep(0.5));
+	const double streakTimes[2] = { 4.0, 6.0 };
+	for (int p = 0; p < 2; ++p)
+	{
+		const double T = streakTimes[p];
+		EXPECT_EQ(RESULT_OK, timekeeper.setTime(T));
+		getSceneThreejsVertices(zinc.scene, vertices);
+		const size_t vertexCount = vertices.size()/3;
+		ASSERT_LT(2u, vertexCount);
+		EXPECT_NEAR(5.0, vertices[0], 1.0E-4);
+		EXPECT_NEAR(5.0 + T, vertices[3*vertexCount - 3], 1.0E-4);
+		EXPECT_NEAR(5.0 + T*T/16.0, vertices[3*vertexCount - 2], 1.0E-4);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			const double *vertex = vertices.data() + 3*v;
+			const double d = vertex[0] - 5.0;
+			EXPECT_NEAR(5.0 + (2.0*T*d - d*d)/16.0, vertex[1], 1.0E-4);
+			EXPECT_NEAR(5.0, vertex[2], 1.0E-4);
+		}
+	}
+}
@@ -178,6 +178,13 @@ TEST(cmzn_tessellation_api, valid_args)
 	result = cmzn_tessellation_get_circle_divisions(tessellation);
 	EXPECT_EQ(10, result);
 
+	EXPECT_EQ(0.0, cmzn_tessellation_get_adaptive_tolerance(tessellation));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_tessellation_set_adaptive_tolerance(tessellation, -0.01));
+	EXPECT_EQ(CMZN_OK, cmzn_tessellation_set_adaptive_tolerance(tessellation, 0.01));
+	EXPECT_EQ(0.01, cmzn_tessellation_get_adaptive_tolerance(tessellation));
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, cmzn_tessellation_set_adaptive_tolerance(0, 0.01));
+	EXPECT_EQ(0.0, cmzn_tessellation_get_adaptive_tolerance(0));
+
 	result = cmzn_tessellation_set_managed(tessellation, 1);
 	EXPECT_EQ(CMZN_OK, result);
 
@@ -232,6 +239,11 @@ TEST(cmzn_tessellation_api, valid_args_cpp)
 	result = tessellation.getCircleDivisions();
 	EXPECT_EQ(10, result);
 
+	EXPECT_EQ(0.0, tessellation.getAdaptiveTolerance());
+	EXPECT_EQ(CMZN_ERROR_ARGUMENT, tessellation.setAdaptiveTolerance(-0.01));
+	EXPECT_EQ(CMZN_OK, tessellation.setAdaptiveTolerance(0.01));
+	EXPECT_EQ(0.01, tessellation.getAdaptiveTolerance());
+
 	result = tessellation.setManaged(true);
 	EXPECT_EQ(CMZN_OK, result);
 
@@ -307,6 +319,7 @@ TEST(cmzn_tessellation_api, description_io_cpp)
 	cmzn_deallocate(name);
 
 	EXPECT_EQ(10, tessellation.getCircleDivisions());
+	EXPECT_EQ(0.005, tessellation.getAdaptiveTolerance());
 
 	int intValues[3];
 	int returnedValue = 0;
@@ -324,6 +337,13 @@ TEST(cmzn_tessellation_api, description_io_cpp)
 
 	char *return_string = tm.writeDescription();
 	EXPECT_TRUE(return_string != 0);
+	// adaptive tolerance is only written for new_default where it is non-zero
+	const char *adaptiveTolerance = strstr(return_string, "\"AdaptiveTolerance\"");
+	EXPECT_TRUE(adaptiveTolerance != 0);
+	if (adaptiveTolerance)
+	{
+		EXPECT_TRUE(0 == strstr(adaptiveTolerance + 1, "\"AdaptiveTolerance\""));
+	}
 	cmzn_deallocate(return_string);
 }
 
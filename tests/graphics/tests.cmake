@@ -18,6 +18,7 @@ SET(${CURRENT_TEST}_SRC
     ${CURRENT_TEST}/sceneviewer.cpp
     ${CURRENT_TEST}/streamlines.cpp
     ${CURRENT_TEST}/tessellation.cpp
+    utilities/threejsio.cpp
     )
 
 SET(SCENEVIEWER_DESCRIPTION_JSON_RESOURCE "${CMAKE_CURRENT_LIST_DIR}/sceneviewer_description.json")
@@ -7,6 +7,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 #include "zinctestsetup.hpp"
 #include <opencmiss/zinc/zincconfigure.h>
@@ -33,8 +36,16 @@
 #include <opencmiss/zinc/stream.hpp>
 #include <opencmiss/zinc/streamimage.hpp>
 
+#include "utilities/fileio.hpp"
+
 #include "test_resources.h"
 
+#define IMAGE_OUTPUT_FOLDER "imagetest"
+
+namespace {
+ManageOutputFolder manageOutputFolderImage(IMAGE_OUTPUT_FOLDER);
+}
+
 TEST(cmzn_fieldmodule_create_image, invalid_args)
 {
 	ZincTestSetup zinc;
@@ -181,6 +192,264 @@ TEST(ZincFieldImage, issue_3707_keep_attributes_after_read_image)
 	ASSERT_DOUBLE_EQ(2.2, depth = im.getTextureCoordinateDepth());
 }
 
+// Reading an image series into a brick file must give the same image as
+// reading it into memory, with bricks paged in through a cache smaller than
+// the image
+TEST(ZincFieldImage, readBricked)
+{
+	ZincTestSetupCpp zinc;
+	const char *brickFileName = IMAGE_OUTPUT_FOLDER "/read_bricked.zbrick";
+
+	FieldImage im1 = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im1.isValid());
+	StreaminformationImage si1 = im1.createStreaminformationImage();
+	EXPECT_TRUE(si1.createStreamresourceFile(TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE)).isValid());
+	EXPECT_TRUE(si1.createStreamresourceFile(TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE)).isValid());
+	EXPECT_EQ(RESULT_OK, im1.read(si1));
+	EXPECT_FALSE(im1.isBricked());
+
+	FieldImage im2 = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im2.isValid());
+	EXPECT_EQ(256, im2.getBrickCacheSize());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im2.setBrickCacheSize(0));
+	EXPECT_EQ(RESULT_OK, im2.setBrickCacheSize(1));
+	EXPECT_EQ(1, im2.getBrickCacheSize());
+	StreaminformationImage si2 = im2.createStreaminformationImage();
+	EXPECT_TRUE(si2.createStreamresourceFile(TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE)).isValid());
+	EXPECT_TRUE(si2.createStreamresourceFile(TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE)).isValid());
+	EXPECT_EQ(RESULT_OK, im2.readBricked(si2, brickFileName));
+	EXPECT_TRUE(im2.isBricked());
+	int hits, misses, evictions;
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im1.getBrickCacheStatistics(&hits, &misses, &evictions));
+	EXPECT_EQ(RESULT_OK, im2.getBrickCacheStatistics(&hits, &misses, &evictions));
+	EXPECT_EQ(0, hits);
+	EXPECT_EQ(0, misses);
+	EXPECT_EQ(0, evictions);
+
+	FieldImage im3 = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im3.isValid());
+	EXPECT_EQ(RESULT_OK, im3.readBrickFile(brickFileName));
+	EXPECT_TRUE(im3.isBricked());
+	const void *buffer = 0;
+	unsigned int bufferLength = 0;
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im3.getBuffer(&buffer, &bufferLength));
+
+	int size1[3], size2[3], size3[3];
+	EXPECT_EQ(3, im1.getSizeInPixels(3, size1));
+	EXPECT_EQ(3, im2.getSizeInPixels(3, size2));
+	EXPECT_EQ(3, im3.getSizeInPixels(3, size3));
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_EQ(size1[i], size2[i]);
+		EXPECT_EQ(size1[i], size3[i]);
+	}
+	EXPECT_EQ(2, size1[2]);
+	const int componentsCount = im1.getNumberOfComponents();
+	EXPECT_EQ(componentsCount, im2.getNumberOfComponents());
+	EXPECT_EQ(componentsCount, im3.getNumberOfComponents());
+	// 8-bit image is over 1 MB, and 1 MB cache holds this many 64x64x2 bricks
+	const int imageBytes = size1[0]*size1[1]*size1[2]*componentsCount;
+	EXPECT_LT(1024*1024, imageBytes);
+	const int cacheBrickCount = 1024*1024/(64*64*size1[2]*componentsCount);
+	const int brickCount = ((size1[0] + 63)/64)*((size1[1] + 63)/64);
+	EXPECT_GT(brickCount, cacheBrickCount);
+
+	Field xi = im1.getDomainField();
+	Fieldcache cache = zinc.fm.createFieldcache();
+	double values1[4], values2[4], values3[4];
+	for (int f = 0; f < 2; ++f)
+	{
+		const FieldImage::FilterMode filterMode = (f == 0) ?
+			FieldImage::FILTER_MODE_NEAREST : FieldImage::FILTER_MODE_LINEAR;
+		EXPECT_EQ(RESULT_OK, im1.setFilterMode(filterMode));
+		EXPECT_EQ(RESULT_OK, im2.setFilterMode(filterMode));
+		EXPECT_EQ(RESULT_OK, im3.setFilterMode(filterMode));
+		for (int k = 0; k < 3; ++k)
+			for (int j = 0; j < 7; ++j)
+				for (int i = 0; i < 7; ++i)
+				{
+					const double xiValues[3] = { 0.05 + 0.15*i, 0.02 + 0.16*j, 0.25 + 0.25*k };
+					EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+					EXPECT_EQ(RESULT_OK, im1.evaluateReal(cache, componentsCount, values1));
+					EXPECT_EQ(RESULT_OK, im2.evaluateReal(cache, componentsCount, values2));
+					EXPECT_EQ(RESULT_OK, im3.evaluateReal(cache, componentsCount, values3));
+					for (int c = 0; c < componentsCount; ++c)
+					{
+						EXPECT_DOUBLE_EQ(values1[c], values2[c]);
+						EXPECT_DOUBLE_EQ(values1[c], values3[c]);
+					}
+				}
+	}
+	// samples are in 49 bricks, more than fit in the small cache, so once it is
+	// full every miss evicts a brick
+	EXPECT_EQ(RESULT_OK, im2.getBrickCacheStatistics(&hits, &misses, &evictions));
+	EXPECT_LE(49, misses);
+	EXPECT_EQ(misses - cacheBrickCount, evictions);
+	// default cache holds the whole image so bricks are read once and reused
+	EXPECT_EQ(RESULT_OK, im3.getBrickCacheStatistics(&hits, &misses, &evictions));
+	EXPECT_LE(49, misses);
+	EXPECT_GE(brickCount, misses);
+	EXPECT_EQ(0, evictions);
+	EXPECT_LT(0, hits);
+	// release bricked images to close brick file before removing it
+	im2 = FieldImage();
+	im3 = FieldImage();
+	std::remove(brickFileName);
+}
+
+// series of files or memory blocks are decoded in parallel into their planes
+TEST(ZincFieldImage, readSeries)
+{
+	ZincTestSetupCpp zinc;
+
+	const char *fileName = TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE);
+	FieldImage im1 = zinc.fm.createFieldImage();
+	EXPECT_EQ(RESULT_OK, im1.readFile(fileName));
+	int size1[3];
+	EXPECT_EQ(3, im1.getSizeInPixels(3, size1));
+	EXPECT_EQ(1, size1[2]);
+	const int componentsCount = im1.getNumberOfComponents();
+
+	FieldImage im2 = zinc.fm.createFieldImage();
+	StreaminformationImage si2 = im2.createStreaminformationImage();
+	const int seriesCount = 5;
+	for (int f = 0; f < seriesCount; ++f)
+		EXPECT_TRUE(si2.createStreamresourceFile(fileName).isValid());
+	EXPECT_EQ(RESULT_OK, im2.read(si2));
+
+	std::vector<char> buffer;
+	FILE *file = fopen(fileName, "rb");
+	EXPECT_NE(static_cast<FILE *>(0), file);
+	int c;
+	while (EOF != (c = fgetc(file)))
+		buffer.push_back(static_cast<char>(c));
+	fclose(file);
+	FieldImage im3 = zinc.fm.createFieldImage();
+	StreaminformationImage si3 = im3.createStreaminformationImage();
+	for (int f = 0; f < seriesCount; ++f)
+		EXPECT_TRUE(si3.createStreamresourceMemoryBuffer(buffer.data(),
+			static_cast<unsigned int>(buffer.size())).isValid());
+	EXPECT_EQ(RESULT_OK, im3.read(si3));
+
+	int size2[3], size3[3];
+	EXPECT_EQ(3, im2.getSizeInPixels(3, size2));
+	EXPECT_EQ(3, im3.getSizeInPixels(3, size3));
+	EXPECT_EQ(size1[0], size2[0]);
+	EXPECT_EQ(size1[1], size2[1]);
+	EXPECT_EQ(seriesCount, size2[2]);
+	for (int i = 0; i < 3; ++i)
+		EXPECT_EQ(size2[i], size3[i]);
+	EXPECT_EQ(componentsCount, im2.getNumberOfComponents());
+	EXPECT_EQ(componentsCount, im3.getNumberOfComponents());
+
+	EXPECT_EQ(RESULT_OK, im1.setFilterMode(FieldImage::FILTER_MODE_NEAREST));
+	EXPECT_EQ(RESULT_OK, im2.setFilterMode(FieldImage::FILTER_MODE_NEAREST));
+	EXPECT_EQ(RESULT_OK, im3.setFilterMode(FieldImage::FILTER_MODE_NEAREST));
+	Field xi = im1.getDomainField();
+	Fieldcache cache = zinc.fm.createFieldcache();
+	double values1[4], values2[4], values3[4];
+	for (int k = 0; k < seriesCount; ++k)
+		for (int j = 0; j < 7; ++j)
+			for (int i = 0; i < 7; ++i)
+			{
+				const double xiValues[3] = { 0.05 + 0.15*i, 0.02 + 0.16*j, (k + 0.5)/seriesCount };
+				EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+				EXPECT_EQ(RESULT_OK, im1.evaluateReal(cache, componentsCount, values1));
+				EXPECT_EQ(RESULT_OK, im2.evaluateReal(cache, componentsCount, values2));
+				EXPECT_EQ(RESULT_OK, im3.evaluateReal(cache, componentsCount, values3));
+				for (int c = 0; c < componentsCount; ++c)
+				{
+					EXPECT_DOUBLE_EQ(values1[c], values2[c]);
+					EXPECT_DOUBLE_EQ(values1[c], values3[c]);
+				}
+			}
+
+	// files of different sizes fail
+	FieldImage im4 = zinc.fm.createFieldImage();
+	StreaminformationImage si4 = im4.createStreaminformationImage();
+	EXPECT_TRUE(si4.createStreamresourceFile(fileName).isValid());
+	EXPECT_TRUE(si4.createStreamresourceFile(
+		TestResources::getLocation(TestResources::TESTIMAGE_GRAY_JPG_RESOURCE)).isValid());
+	EXPECT_NE(RESULT_OK, im4.read(si4));
+}
+
+TEST(ZincFieldImage, levelOfDetail)
+{
+	ZincTestSetupCpp zinc;
+
+	FieldImage im = zinc.fm.createFieldImage();
+	EXPECT_TRUE(im.isValid());
+	EXPECT_EQ(RESULT_OK, im.readFile(TestResources::getLocation(TestResources::IMAGE_PNG_RESOURCE)));
+	const int componentsCount = im.getNumberOfComponents();
+	EXPECT_GE(4, componentsCount);
+
+	EXPECT_DOUBLE_EQ(0.0, im.getLevelOfDetail());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im.setLevelOfDetail(-1.0));
+	EXPECT_EQ(RESULT_OK, im.setLevelOfDetail(1.5));
+	EXPECT_DOUBLE_EQ(1.5, im.getLevelOfDetail());
+	EXPECT_DOUBLE_EQ(0.0, im.getSamplingFootprint());
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im.setSamplingFootprint(-0.1));
+	EXPECT_EQ(RESULT_OK, im.setSamplingFootprint(0.25));
+	EXPECT_DOUBLE_EQ(0.25, im.getSamplingFootprint());
+	EXPECT_EQ(RESULT_OK, im.setSamplingFootprint(0.0));
+
+	const int pointCount = 49;
+	double textureCoordinates[2*pointCount];
+	for (int j = 0; j < 7; ++j)
+		for (int i = 0; i < 7; ++i)
+		{
+			textureCoordinates[2*(j*7 + i)] = 0.05 + 0.15*i;
+			textureCoordinates[2*(j*7 + i) + 1] = 0.02 + 0.16*j;
+		}
+	double values[4*pointCount], samples[4*pointCount];
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im.evaluateSamples(pointCount, 4, textureCoordinates, 4*pointCount, samples));
+	EXPECT_EQ(RESULT_ERROR_ARGUMENT, im.evaluateSamples(pointCount, 2, textureCoordinates, pointCount*componentsCount - 1, samples));
+
+	// level of detail has no effect without mipmap filter modes; samples match evaluation
+	Field xi = im.getDomainField();
+	Fieldcache cache = zinc.fm.createFieldcache();
+	for (int f = 0; f < 2; ++f)
+	{
+		EXPECT_EQ(RESULT_OK, im.setFilterMode((f == 0) ?
+			FieldImage::FILTER_MODE_NEAREST : FieldImage::FILTER_MODE_LINEAR));
+		EXPECT_EQ(RESULT_OK, im.evaluateSamples(pointCount, 2, textureCoordinates, 4*pointCount, samples));
+		for (int p = 0; p < pointCount; ++p)
+		{
+			const double xiValues[3] = { textureCoordinates[2*p], textureCoordinates[2*p + 1], 0.0 };
+			EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+			EXPECT_EQ(RESULT_OK, im.evaluateReal(cache, componentsCount, values + p*componentsCount));
+		}
+		for (int v = 0; v < pointCount*componentsCount; ++v)
+			EXPECT_DOUBLE_EQ(values[v], samples[v]);
+	}
+
+	// blending between mip levels lies between values at the levels either side
+	double samples1[4*pointCount], samples2[4*pointCount];
+	EXPECT_EQ(RESULT_OK, im.setFilterMode(FieldImage::FILTER_MODE_LINEAR_MIPMAP_LINEAR));
+	EXPECT_EQ(RESULT_OK, im.setLevelOfDetail(1.0));
+	EXPECT_EQ(RESULT_OK, im.evaluateSamples(pointCount, 2, textureCoordinates, 4*pointCount, samples1));
+	EXPECT_EQ(RESULT_OK, im.setLevelOfDetail(2.0));
+	EXPECT_EQ(RESULT_OK, im.evaluateSamples(pointCount, 2, textureCoordinates, 4*pointCount, samples2));
+	EXPECT_EQ(RESULT_OK, im.setLevelOfDetail(1.25));
+	EXPECT_EQ(RESULT_OK, im.evaluateSamples(pointCount, 2, textureCoordinates, 4*pointCount, samples));
+	for (int v = 0; v < pointCount*componentsCount; ++v)
+		EXPECT_NEAR(0.75*samples1[v] + 0.25*samples2[v], samples[v], 1.0E-12);
+
+	// coarsest level is a single texel, chosen automatically from a large footprint
+	EXPECT_EQ(RESULT_OK, im.setLevelOfDetail(0.0));
+	EXPECT_EQ(RESULT_OK, im.setSamplingFootprint(100.0));
+	EXPECT_EQ(RESULT_OK, im.setFilterMode(FieldImage::FILTER_MODE_NEAREST_MIPMAP_NEAREST));
+	EXPECT_EQ(RESULT_OK, im.evaluateSamples(pointCount, 2, textureCoordinates, 4*pointCount, samples));
+	for (int p = 1; p < pointCount; ++p)
+		for (int c = 0; c < componentsCount; ++c)
+			EXPECT_DOUBLE_EQ(samples[c], samples[p*componentsCount + c]);
+	const double xiValues[3] = { 0.5, 0.5, 0.0 };
+	EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+	EXPECT_EQ(RESULT_OK, im.evaluateReal(cache, componentsCount, values));
+	for (int c = 0; c < componentsCount; ++c)
+		EXPECT_DOUBLE_EQ(samples[c], values[c]);
+}
+
 TEST(cmzn_fieldmodule_create_image, analyze_bigendian)
 {
 	ZincTestSetup zinc;
@@ -235,6 +504,139 @@ TEST(cmzn_fieldmodule_create_image, analyze_lung)
 
 }
 
+namespace {
+
+void writeShort(FILE *file, int value, bool bigEndian)
+{
+	const unsigned char bytes[2] = {
+		static_cast<unsigned char>(bigEndian ? (value >> 8) : value),
+		static_cast<unsigned char>(bigEndian ? value : (value >> 8)) };
+	fwrite(bytes, 1, 2, file);
+}
+
+void writeInt(FILE *file, int value, bool bigEndian)
+{
+	for (int i = 0; i < 4; ++i)
+		fputc((value >> (bigEndian ? (24 - 8*i) : 8*i)) & 0xff, file);
+}
+
+/** Write signed short Analyze volume with columns, rows, planes sizes and
+ * value 100*plane + 10*row + column - 300 at each voxel. */
+void writeAnalyzeSignedShort(const char *stem, bool bigEndian, int columns, int rows, int planes)
+{
+	std::string fileName = std::string(stem) + ".hdr";
+	FILE *file = fopen(fileName.c_str(), "wb");
+	unsigned char header[348] = { 0 };
+	fwrite(header, 1, sizeof(header), file);
+	fseek(file, 0, SEEK_SET);
+	writeInt(file, 348, bigEndian);
+	fseek(file, 40, SEEK_SET);
+	const int dims[5] = { 3, rows, columns, planes, 1 };
+	for (int i = 0; i < 5; ++i)
+		writeShort(file, dims[i], bigEndian);
+	fseek(file, 70, SEEK_SET);
+	writeShort(file, /*ANALYZE_DT_SIGNED_SHORT*/4, bigEndian);
+	writeShort(file, /*bitpix*/16, bigEndian);
+	fclose(file);
+	fileName = std::string(stem) + ".img";
+	file = fopen(fileName.c_str(), "wb");
+	for (int k = 0; k < planes; ++k)
+		for (int j = 0; j < rows; ++j)
+			for (int i = 0; i < columns; ++i)
+				writeShort(file, 100*k + 10*j + i - 300, bigEndian);
+	fclose(file);
+}
+
+}
+
+// Analyze and raw volumes are read straight into the texture
+TEST(ZincFieldImage, readVolumeDirect)
+{
+	ZincTestSetupCpp zinc;
+
+	for (int e = 0; e < 2; ++e)
+	{
+		const bool bigEndian = (0 == e);
+		writeAnalyzeSignedShort("zinc_test_direct", bigEndian, 4, 3, 2);
+		FieldImage im = zinc.fm.createFieldImage();
+		EXPECT_TRUE(im.isValid());
+		StreaminformationImage si = im.createStreaminformationImage();
+		EXPECT_EQ(RESULT_OK, si.setFileFormat(StreaminformationImage::FILE_FORMAT_ANALYZE));
+		EXPECT_TRUE(si.createStreamresourceFile("zinc_test_direct.hdr").isValid());
+		EXPECT_EQ(RESULT_OK, im.read(si));
+		int sizes[3];
+		EXPECT_EQ(3, im.getSizeInPixels(3, sizes));
+		EXPECT_EQ(4, sizes[0]);
+		EXPECT_EQ(3, sizes[1]);
+		EXPECT_EQ(2, sizes[2]);
+		EXPECT_EQ(1, im.getNumberOfComponents());
+		EXPECT_EQ(RESULT_OK, im.setFilterMode(FieldImage::FILTER_MODE_NEAREST));
+		Field xi = im.getDomainField();
+		Fieldcache cache = zinc.fm.createFieldcache();
+		double value;
+		for (int k = 0; k < 2; ++k)
+			for (int j = 0; j < 3; ++j)
+				for (int i = 0; i < 4; ++i)
+				{
+					const double xiValues[3] = { (i + 0.5)/4.0, (j + 0.5)/3.0, (k + 0.5)/2.0 };
+					EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+					EXPECT_EQ(RESULT_OK, im.evaluateReal(cache, 1, &value));
+					// signed values are offset by 32768; file rows are top to bottom
+					const int texel = 100*k + 10*(2 - j) + i - 300 + 32768;
+					EXPECT_DOUBLE_EQ(texel/65535.0, value);
+				}
+		std::remove("zinc_test_direct.hdr");
+		std::remove("zinc_test_direct.img");
+	}
+
+	// 3 planes of 2 x 2 RGB pixels
+	const char *rawFileName = "zinc_test_direct.raw";
+	FILE *file = fopen(rawFileName, "wb");
+	for (int v = 0; v < 36; ++v)
+		fputc(7*v, file);
+	fclose(file);
+	FieldImage im = zinc.fm.createFieldImage();
+	StreaminformationImage si = im.createStreaminformationImage();
+	EXPECT_EQ(RESULT_OK, si.setAttributeInteger(StreaminformationImage::ATTRIBUTE_RAW_WIDTH_PIXELS, 2));
+	EXPECT_EQ(RESULT_OK, si.setAttributeInteger(StreaminformationImage::ATTRIBUTE_RAW_HEIGHT_PIXELS, 2));
+	EXPECT_EQ(RESULT_OK, si.setAttributeInteger(StreaminformationImage::ATTRIBUTE_BITS_PER_COMPONENT, 8));
+	EXPECT_EQ(RESULT_OK, si.setPixelFormat(StreaminformationImage::PIXEL_FORMAT_RGB));
+	EXPECT_TRUE(si.createStreamresourceFile(rawFileName).isValid());
+	EXPECT_EQ(RESULT_OK, im.read(si));
+	int sizes[3];
+	EXPECT_EQ(3, im.getSizeInPixels(3, sizes));
+	EXPECT_EQ(2, sizes[0]);
+	EXPECT_EQ(2, sizes[1]);
+	EXPECT_EQ(3, sizes[2]);
+	EXPECT_EQ(3, im.getNumberOfComponents());
+	EXPECT_EQ(RESULT_OK, im.setFilterMode(FieldImage::FILTER_MODE_NEAREST));
+	Field xi = im.getDomainField();
+	Fieldcache cache = zinc.fm.createFieldcache();
+	// bottom right pixel of middle plane is in last row of plane 1 in file
+	const double xiValues[3] = { 0.75, 0.25, 0.5 };
+	EXPECT_EQ(RESULT_OK, cache.setFieldReal(xi, 3, xiValues));
+	double values[3];
+	EXPECT_EQ(RESULT_OK, im.evaluateReal(cache, 3, values));
+	for (int c = 0; c < 3; ++c)
+		EXPECT_DOUBLE_EQ(7*(12 + 9 + c)/255.0, values[c]);
+	im = FieldImage();
+	std::remove(rawFileName);
+
+	// raw file not holding whole planes
+	im = zinc.fm.createFieldImage();
+	file = fopen(rawFileName, "wb");
+	for (int v = 0; v < 13; ++v)
+		fputc(v, file);
+	fclose(file);
+	si = im.createStreaminformationImage();
+	EXPECT_EQ(RESULT_OK, si.setAttributeInteger(StreaminformationImage::ATTRIBUTE_RAW_WIDTH_PIXELS, 2));
+	EXPECT_EQ(RESULT_OK, si.setAttributeInteger(StreaminformationImage::ATTRIBUTE_RAW_HEIGHT_PIXELS, 2));
+	EXPECT_EQ(RESULT_OK, si.setPixelFormat(StreaminformationImage::PIXEL_FORMAT_RGB));
+	EXPECT_TRUE(si.createStreamresourceFile(rawFileName).isValid());
+	EXPECT_NE(RESULT_OK, im.read(si));
+	std::remove(rawFileName);
+}
+
 #include <stdint.h>
 
 namespace test
@@ -8,6 +8,7 @@ SET(CURRENT_TEST image)
 LIST(APPEND API_TESTS ${CURRENT_TEST})
 SET(${CURRENT_TEST}_SRC
 	${CURRENT_TEST}/image.cpp
+	utilities/fileio.cpp
 	)
 
 SET(IMAGE_PNG_RESOURCE "${CMAKE_CURRENT_SOURCE_DIR}/resources/image-1.png")
@@ -0,0 +1,53 @@
+/*
+ * OpenCMISS-Zinc Library Unit Tests
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "threejsio.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <cstdlib>
+
+#include <opencmiss/zinc/result.hpp>
+#include <opencmiss/zinc/streamscene.hpp>
+
+using namespace OpenCMISS::Zinc;
+
+void getThreejsArray(const std::string& buffer, const char *name, std::vector<double>& values)
+{
+	values.clear();
+	const size_t namePosition = buffer.find(std::string("\"") + name + "\"");
+	ASSERT_NE(std::string::npos, namePosition);
+	const char *text = buffer.c_str() + buffer.find('[', namePosition) + 1;
+	while (true)
+	{
+		while ((*text == ',') || isspace(*text))
+			++text;
+		if ((*text == ']') || (*text == '\0'))
+			break;
+		char *end;
+		values.push_back(strtod(text, &end));
+		ASSERT_NE(text, end);
+		text = end;
+	}
+}
+
+void getSceneThreejsVertices(Scene& scene, std::vector<double>& vertices)
+{
+	vertices.clear();
+	StreaminformationScene si = scene.createStreaminformationScene();
+	EXPECT_EQ(RESULT_OK, si.setIOFormat(si.IO_FORMAT_THREEJS));
+	ASSERT_EQ(2, si.getNumberOfResourcesRequired());
+	StreamresourceMemory metadata = si.createStreamresourceMemory();
+	StreamresourceMemory graphicsResource = si.createStreamresourceMemory();
+	EXPECT_EQ(RESULT_OK, scene.write(si));
+	const char *memoryBuffer = 0;
+	unsigned int size = 0;
+	EXPECT_EQ(RESULT_OK, graphicsResource.getBuffer((const void**)&memoryBuffer, &size));
+	getThreejsArray(std::string(memoryBuffer, size), "vertices", vertices);
+}
@@ -0,0 +1,24 @@
+/*
+ * OpenCMISS-Zinc Library Unit Tests
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ZINCTEST_UTILITIES_THREEJSIO_HPP__
+#define __ZINCTEST_UTILITIES_THREEJSIO_HPP__
+
+#include <string>
+#include <vector>
+
+#include <opencmiss/zinc/scene.hpp>
+
+// Read the JSON array of numbers named name in threejs export buffer.
+void getThreejsArray(const std::string& buffer, const char *name, std::vector<double>& values);
+
+// Get the "vertices" array from the threejs export of a scene containing
+// a single graphics.
+void getSceneThreejsVertices(OpenCMISS::Zinc::Scene& scene, std::vector<double>& vertices);
+
+#endif // __ZINCTEST_UTILITIES_THREEJSIO_HPP__